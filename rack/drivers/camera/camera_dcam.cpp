@@ -35,6 +35,21 @@ arg_table_t argTab[] = {
     { ARGOPT_OPT, "lossrate", ARGOPT_REQVAL, ARGOPT_VAL_INT,
       "lossrate", { 1 } },
 
+    { ARGOPT_OPT, "lossMode", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "lossMode 0=subsample pixel pairs, 1=area average (default=0)", { 0 } },
+
+    { ARGOPT_OPT, "roiX", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "left border of the region of interest in sensor pixels (default=0)", { 0 } },
+
+    { ARGOPT_OPT, "roiY", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "upper border of the region of interest in sensor pixels (default=0)", { 0 } },
+
+    { ARGOPT_OPT, "roiWidth", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "width of the region of interest, 0=up to the image border (default=0)", { 0 } },
+
+    { ARGOPT_OPT, "roiHeight", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "height of the region of interest, 0=up to the image border (default=0)", { 0 } },
+
     { ARGOPT_OPT, "uValue", ARGOPT_REQVAL, ARGOPT_VAL_INT,
       "uValue", { 150 } },
 
@@ -75,47 +90,25 @@ arg_table_t argTab[] = {
 };
 
 //*** Method for automatic adaption of the lumination color****//
-int CameraDcam::autoWhitebalance(camera_data_msg *dataPackage)
+int CameraDcam::autoWhitebalance(camera_dcam_stats *stats)
 {
-    int minRow, maxRow, minCol, maxCol, rowNum, colNum;
-    int i, j, sourceIndex;
-    double uDiff, vDiff, diffPoints;
+    double uDiff, vDiff;
     uint32_t uvValue, uuValue;
 
-    minCol = (dataPackage->data.width / 2) - whitebalanceCols;
-    maxCol = (dataPackage->data.width / 2) + whitebalanceCols;
-    minRow = 1;
-    maxRow = 1 + whitebalanceRows;
-
-    colNum = maxCol - minCol;
-    rowNum = maxRow - minRow;
-    uDiff = 0;
-    vDiff = 0;
-    diffPoints = (colNum*rowNum);// / 2;//for real size /2 would fit the additional /2 is for controller speed up
-
-    switch(dataPackage->data.mode) {
+    switch(mode) {
     case CAMERA_MODE_YUV422:
-        //UYVY
-        for(i=0; i < rowNum; i++) {
-            for (j=0; j < colNum; j++) {
-                //2 bytes pro pixel
-                //take 0.th byte from pixel
-                sourceIndex = ((i+minRow)*dataPackage->data.width+j+minCol);
-
-                if (sourceIndex%2 == 0)
-                {
-                    uDiff += (dataPackage->byteStream[sourceIndex*2]-128);
-                }else
-                {
-                    vDiff += (dataPackage->byteStream[sourceIndex*2]-128);
-                }
-            }
+        if (stats->uvCount <= 0)
+        {
+            break;
         }
 
-        //GDOS_DBG_INFO("auto white balance uDiff:%i vDiff:%i points:%i!\n", (int)uDiff, (int)vDiff, (int)diffPoints);
+        uDiff = stats->uSum;
+        vDiff = stats->vSum;
+
+        //GDOS_DBG_INFO("auto white balance uDiff:%i vDiff:%i points:%i!\n", (int)uDiff, (int)vDiff, stats->uvCount);
 
-        uDiff = round(uDiff / diffPoints);
-        vDiff = round(vDiff / diffPoints);
+        uDiff = round(uDiff / stats->uvCount);
+        vDiff = round(vDiff / stats->uvCount);
 
         if ((uDiff < 2) && (vDiff < 2) && (whitebalanceMode == 2))
             whitebalanceMode = 0;
@@ -154,37 +147,21 @@ int CameraDcam::autoWhitebalance(camera_data_msg *dataPackage)
 
 
 //*** Method for automatic adaption of the lumination parameter****//
-int CameraDcam::autoBrightness(camera_data_msg *dataPackage)
+int CameraDcam::autoBrightness(camera_dcam_stats *stats)
 {
-    int i, count, minCount, maxCount, bytesPerPixel, gain, shutter;
+    int count, minCount, maxCount, gain, shutter;
     double unclearPixel;
     unsigned int ubrightness;
     unsigned int ushutter;
     unsigned int ugain;
-    int start;
-
-    minCount = 0;
-    maxCount = 0;
-//    third = dataPackage->data.width * dataPackage->data.height
 
-    bytesPerPixel = dataPackage->data.depth / 8;
+    minCount = stats->brightnessMin;
+    maxCount = stats->brightnessMax;
+    count    = stats->brightnessCount;
 
-    count = dataPackage->data.width * dataPackage->data.height * bytesPerPixel;
-    start = (int)(count * (((double ) 1) - ((double) 1) / autoBrightnessSize));
-
-    start += start % bytesPerPixel;
-    start++;
-
-    for(i = start; i < count; i += bytesPerPixel)
+    if (count <= 0)
     {
-       if((unsigned char)dataPackage->byteStream[i] <= minHue)
-        {
-            minCount++;
-        }
-        else if((unsigned char)dataPackage->byteStream[i] >= maxHue)
-        {
-            maxCount++;
-        }
+        return DC1394_SUCCESS;
     }
 
     if (dc1394_feature_get_value(camera, DC1394_FEATURE_SHUTTER, &ushutter))
@@ -264,6 +241,325 @@ int CameraDcam::autoBrightness(camera_data_msg *dataPackage)
 }
 
 
+//
+// Image pipeline
+//
+// The dequeued frame is read once: every output row is cropped, subsampled
+// or area averaged straight into the data buffer and the statistics of the
+// brightness and white balance control are taken while the row is in the
+// cache. Only the source rows of the output image are touched.
+//
+
+int CameraDcam::setupImagePipeline(void)
+{
+    switch (mode)
+    {
+    case CAMERA_MODE_YUV422:    // u y v y
+        sampleCols  = 4;
+        sampleRows  = 1;
+        sampleBytes = 1;
+        pairPixels  = 2;
+        break;
+    case CAMERA_MODE_MONO8:
+        sampleCols  = 1;
+        sampleRows  = 1;
+        sampleBytes = 1;
+        pairPixels  = 1;
+        break;
+    case CAMERA_MODE_MONO12:
+        sampleCols  = 1;
+        sampleRows  = 1;
+        sampleBytes = 2;
+        pairPixels  = 1;
+        break;
+    case CAMERA_MODE_RAW8:      // keep the bayer pattern
+        sampleCols  = 2;
+        sampleRows  = 2;
+        sampleBytes = 1;
+        pairPixels  = 2;
+        break;
+    case CAMERA_MODE_RAW12:
+        sampleCols  = 2;
+        sampleRows  = 2;
+        sampleBytes = 2;
+        pairPixels  = 2;
+        break;
+    default:
+        GDOS_ERROR("Unknown mode %i\n", mode);
+        return -EINVAL;
+    }
+
+    // align the source window to pixel pairs and the bayer pattern
+    imageX      = roiX / pairPixels * pairPixels;
+    imageY      = roiY / sampleRows * sampleRows;
+    imageWidth  = roiWidth  > 0 ? roiWidth  : (int)width  - imageX;
+    imageHeight = roiHeight > 0 ? roiHeight : (int)height - imageY;
+    imageWidth  = imageWidth  / pairPixels * pairPixels;
+    imageHeight = imageHeight / sampleRows * sampleRows;
+
+    if ((imageX < 0) || (imageY < 0) || (imageWidth <= 0) || (imageHeight <= 0) ||
+        (imageX + imageWidth  > (int)width) ||
+        (imageY + imageHeight > (int)height))
+    {
+        GDOS_ERROR("Region of interest x %i y %i width %i height %i exceeds "
+                   "the image %i x %i\n", roiX, roiY, roiWidth, roiHeight,
+                   width, height);
+        return -EINVAL;
+    }
+
+    outWidth  = imageWidth  / lossRate / pairPixels * pairPixels;
+    outHeight = imageHeight / lossRate / sampleRows * sampleRows;
+
+    if ((outWidth <= 0) || (outHeight <= 0))
+    {
+        GDOS_ERROR("Lossrate %i is too big for the region of interest\n", lossRate);
+        return -EINVAL;
+    }
+
+    if (autoBrightnessSize < 1)
+    {
+        autoBrightnessSize = 1;
+    }
+    brightnessRowFirst = outHeight - outHeight / autoBrightnessSize;
+
+    GDOS_DBG_INFO("Image pipeline: source x %i y %i width %i height %i, "
+                  "output width %i height %i, lossrate %i mode %i\n",
+                  imageX, imageY, imageWidth, imageHeight, outWidth, outHeight,
+                  lossRate, lossMode);
+    return 0;
+}
+
+// takes the first pixel (pair) of every lossRate pixels (pairs)
+void CameraDcam::imageRowSubsample(uint8_t *out, const uint8_t *in)
+{
+    int blockBytes = sampleCols * sampleBytes;
+    int step       = blockBytes * lossRate;
+    int blocks     = outWidth * bytesPerPixel / blockBytes;
+    int k, b;
+
+    for (k = 0; k < blocks; k++)
+    {
+        for (b = 0; b < blockBytes; b++)
+        {
+            out[b] = in[b];
+        }
+        out += blockBytes;
+        in  += step;
+    }
+}
+
+// averages the samples of the same phase (pixel, bayer color) in every
+// block of lossRate x lossRate sample periods
+void CameraDcam::imageRowAverage(uint8_t *out, const uint8_t *in, int stride)
+{
+    int             samples = outWidth * bytesPerPixel / sampleBytes;
+    int             blocks  = samples / sampleCols;
+    int             div     = lossRate * lossRate;
+    int             i, j, k, ph, value;
+    uint32_t        sum, *acc;
+    const uint8_t   *row, *s;
+
+    memset(accBuffer, 0, samples * sizeof(uint32_t));
+
+    for (i = 0; i < (int)lossRate; i++)
+    {
+        row = in + i * sampleRows * stride;
+        acc = accBuffer;
+
+        for (k = 0; k < blocks; k++)
+        {
+            s = row + k * sampleCols * lossRate * sampleBytes;
+
+            for (ph = 0; ph < sampleCols; ph++)
+            {
+                sum = 0;
+                if (sampleBytes == 1)
+                {
+                    for (j = 0; j < (int)lossRate; j++)
+                    {
+                        sum += s[ph + j * sampleCols];
+                    }
+                }
+                else    // 16 bit big endian
+                {
+                    for (j = 0; j < (int)lossRate; j++)
+                    {
+                        sum += (s[2 * (ph + j * sampleCols)] << 8) |
+                                s[2 * (ph + j * sampleCols) + 1];
+                    }
+                }
+                acc[ph] += sum;
+            }
+            acc += sampleCols;
+        }
+    }
+
+    for (k = 0; k < samples; k++)
+    {
+        value = (accBuffer[k] + div / 2) / div;
+
+        if (sampleBytes == 1)
+        {
+            out[k] = (uint8_t)value;
+        }
+        else
+        {
+            out[2 * k]     = (uint8_t)(value >> 8);
+            out[2 * k + 1] = (uint8_t)value;
+        }
+    }
+}
+
+// every output pixel pair (u y0 v y1) covers 2 * lossRate source pixels,
+// u and v are averaged over all of them, y0 and y1 over their half
+void CameraDcam::imageRowAverageYuv(uint8_t *out, const uint8_t *in, int stride)
+{
+    int             pairs = outWidth / 2;
+    int             div   = lossRate * lossRate;
+    int             i, j, k;
+    uint32_t        *acc;
+    const uint8_t   *row, *s;
+
+    memset(accBuffer, 0, pairs * 4 * sizeof(uint32_t));
+
+    for (i = 0; i < (int)lossRate; i++)
+    {
+        row = in + i * stride;
+        acc = accBuffer;
+
+        for (k = 0; k < pairs; k++)
+        {
+            s = row + 4 * k * lossRate;
+
+            for (j = 0; j < (int)lossRate; j++)
+            {
+                acc[0] += s[4 * j];
+                acc[2] += s[4 * j + 2];
+                acc[1] += s[2 * j + 1];
+                acc[3] += s[2 * (j + lossRate) + 1];
+            }
+            acc += 4;
+        }
+    }
+
+    for (k = 0; k < 4 * pairs; k++)
+    {
+        out[k] = (uint8_t)((accBuffer[k] + div / 2) / div);
+    }
+}
+
+void CameraDcam::imageRowStats(const uint8_t *row, int r, camera_dcam_stats *stats)
+{
+    int x, value, minCol, maxCol;
+
+    if (r >= brightnessRowFirst)
+    {
+        for (x = 0; x < outWidth; x++)
+        {
+            if (mode == CAMERA_MODE_YUV422)
+            {
+                value = row[2 * x + 1];
+            }
+            else if (sampleBytes == 1)
+            {
+                value = row[x];
+            }
+            else
+            {
+                value = ((row[2 * x] << 8) | row[2 * x + 1]) >> 4;
+            }
+
+            if (value <= minHue)
+            {
+                stats->brightnessMin++;
+            }
+            else if (value >= maxHue)
+            {
+                stats->brightnessMax++;
+            }
+        }
+    }
+
+    if ((mode == CAMERA_MODE_YUV422) && (whitebalanceMode > 0) &&
+        (r >= 1) && (r < 1 + whitebalanceRows))
+    {
+        minCol = outWidth / 2 - whitebalanceCols;
+        maxCol = outWidth / 2 + whitebalanceCols;
+        if (minCol < 0)
+        {
+            minCol = 0;
+        }
+        if (maxCol > outWidth)
+        {
+            maxCol = outWidth;
+        }
+
+        // 2 bytes per pixel, the first byte is u (even) or v (odd pixel)
+        for (x = minCol; x < maxCol; x++)
+        {
+            if (x % 2 == 0)
+            {
+                stats->uSum += row[2 * x] - 128;
+            }
+            else
+            {
+                stats->vSum += row[2 * x] - 128;
+            }
+        }
+        stats->uvCount += maxCol - minCol;
+    }
+}
+
+int CameraDcam::imageProcess(dc1394video_frame_t *frame, uint8_t *out, camera_dcam_stats *stats)
+{
+    const uint8_t   *in, *src;
+    int             stride, outStride, r, row;
+
+    if (((int)frame->size[0] < imageX + imageWidth) ||
+        ((int)frame->size[1] < imageY + imageHeight))
+    {
+        GDOS_ERROR("Frame size %i x %i doesn't fit the region of interest\n",
+                   frame->size[0], frame->size[1]);
+        return -EINVAL;
+    }
+
+    stride    = frame->stride ? (int)frame->stride : (int)frame->size[0] * bytesPerPixel;
+    outStride = outWidth * bytesPerPixel;
+    in        = frame->image + imageY * stride + imageX * bytesPerPixel;
+
+    memset(stats, 0, sizeof(camera_dcam_stats));
+    stats->brightnessCount = outStride * outHeight;
+
+    for (r = 0; r < outHeight; r++)
+    {
+        // first source row of this output row (keeps the bayer row parity)
+        row = (r / sampleRows) * sampleRows * lossRate + r % sampleRows;
+        src = in + row * stride;
+
+        if (lossRate == 1)
+        {
+            memcpy(out, src, outStride);
+        }
+        else if (lossMode == CAMERA_DCAM_LOSS_SUBSAMPLE)
+        {
+            imageRowSubsample(out, src);
+        }
+        else if (mode == CAMERA_MODE_YUV422)
+        {
+            imageRowAverageYuv(out, src, stride);
+        }
+        else
+        {
+            imageRowAverage(out, src, stride);
+        }
+
+        imageRowStats(out, r, stats);
+        out += outStride;
+    }
+    return 0;
+}
+
+
 /******************/
 int CameraDcam::findCameraByGuid(void)
 {
@@ -451,6 +747,7 @@ int CameraDcam::setupCaptureFormat7()
     whitebalanceMode    = getInt32Param("whitebalanceMode");
     whitebalanceRows    = getInt32Param("whitebalanceRows");
     whitebalanceCols    = getInt32Param("whitebalanceCols");
+    lossMode            = getInt32Param("lossMode");
 //    intrParFile         = getStringParam("intrParFile");
 //    extrParFile         = getStringParam("extrParFile");
     intrParFile         = "ww_b4_intrinsic_calibration_parameter";
@@ -519,22 +816,33 @@ int CameraDcam::setupCaptureFormat7()
         return -EINVAL;
     }
 
+    ret = setupImagePipeline();
+    if (ret)
+    {
+        dc1394_camera_free(camera);
+        return ret;
+    }
+
     //need to get max size of image from this camera and also set dataBuffer according
-    if (CAMERA_MAX_WIDTH   < (width  / lossRate) ||
-        CAMERA_MAX_HEIGHT  < (height / lossRate))
+    if (CAMERA_MAX_WIDTH   < outWidth ||
+        CAMERA_MAX_HEIGHT  < outHeight)
     {
         GDOS_ERROR("Size parameter set too small in camera.h!! EXITING!\n");
         dc1394_camera_free(camera);
         return -ENOMEM;
     }
 
-    if (param.calibration_width     != (int)(width  / lossRate) ||
-        param.calibration_height    != (int)(height / lossRate))
+    if ((imageWidth != (int)width) || (imageHeight != (int)height))
+    {
+        GDOS_WARNING("Intrinsic parameter refer to the uncropped image\n");
+    }
+    else if (param.calibration_width     != outWidth ||
+             param.calibration_height    != outHeight)
     {
         GDOS_ERROR("Size parameter of intrinsic parameter file (%i, %i) and "
                    "camera (%i, %i) doesn't fit together!\n",
                     param.calibration_width, param.calibration_height,
-                    width / lossRate, height / lossRate);
+                    outWidth, outHeight);
         dc1394_camera_free(camera);
         return -EAGAIN;
     }
@@ -592,9 +900,9 @@ int CameraDcam::moduleLoop(void)
 {
     dc1394video_frame_t *frame     = NULL;
     camera_data_msg     *p_data    = NULL;
+    camera_dcam_stats   stats;
     ssize_t             datalength = 0;
     rack_time_t         starttime;
-    int h=0,w=0,p=0;
     int ret;
 
     starttime = rackTime.get();
@@ -611,6 +919,7 @@ int CameraDcam::moduleLoop(void)
     case CAMERA_MODE_RAW8:
         p_data->data.depth = 8;
         break;
+    case CAMERA_MODE_MONO12:
     case CAMERA_MODE_RAW12:
     case CAMERA_MODE_YUV422:
         p_data->data.depth = 16;
@@ -628,58 +937,24 @@ int CameraDcam::moduleLoop(void)
         GDOS_WARNING("Unable to capture a frame. ret = %i\n", ret);
     else
     {
-        p_data->data.width  = frame->size[0] / lossRate;
-        p_data->data.height = frame->size[1] / lossRate;
+        p_data->data.width  = outWidth;
+        p_data->data.height = outHeight;
 
-        //shrink data if set to.
-        if (lossRate == 1)
-            memcpy(p_data->byteStream, frame->image, frame->total_bytes);
-        else
+        // crop and shrink the frame straight into the data buffer
+        ret = imageProcess(frame, p_data->byteStream, &stats);
+
+        dc1394_capture_enqueue(camera, frame);
+
+        if (ret)
         {
-            /*lossRate != 1 so we need to throw some pixel away. -> iterate over array.
-             *The loss in YUV422 format must lose pairs of pixel! as UYVY pairs cannot be divided up!!
-             * ->from 4 pixel in the original only one pixelPair! is transmitted.
-             * eg. lossrate of 2 in yuv -> take 4 byte, leave 4 byte, take 4 byte.... leave a row...
-             *
-             *The loss in RAW format must also lose pairs of pixel! ohterwise only one color may result.
-             */
-            int pairfactor = 2; //depending on colorMode (Yuv=Raw=2, mono=1)
-            int bytesPerPixelPair = 0;
-
-            if (p_data->data.mode == CAMERA_MODE_MONO8 ||
-                p_data->data.mode == CAMERA_MODE_RGB24 ||
-                p_data->data.mode == CAMERA_MODE_MONO12)
-                pairfactor = 1;
-
-            bytesPerPixelPair = bytesPerPixel * pairfactor;//to save multiplications
-
-            //copy needed to change datatypes
-            memcpy(dataBuffer, frame->image, frame->total_bytes);
-
-            for (h=0; h < p_data->data.height; h++)
-            { //for every line in the smaller image
-                for(w=0; w < p_data->data.width / pairfactor; w++)
-                { //for every pixelPair in the smaller image
-                    for (p=0; p<bytesPerPixelPair; p++)
-                    { //for every byte per pixelPair
-                        p_data->byteStream[(h * bytesPerPixel *
-                                           p_data->data.width) +
-                                           (w * bytesPerPixelPair) + p] =
-                        dataBuffer[(h * bytesPerPixel * frame->size[0] *
-                                   lossRate) + (w * bytesPerPixelPair *
-                                   lossRate) + p];
-                    }
-                }
-            }
-            GDOS_DBG_DETAIL("Data width %i pixelPairs to be send height %i "
-                            "pixel(!) bppp %i\n", w, h, p);
-        } //end of lossRate calculation
+            return ret;
+        }
 
         //doing auto shutter / gain / brightness control
-        autoBrightness(p_data);
+        autoBrightness(&stats);
 
         if (whitebalanceMode > 0)
-            autoWhitebalance(p_data);
+            autoWhitebalance(&stats);
 
         GDOS_DBG_DETAIL("Data recordingtime %i width %i height %i depth %i "
                         "mode %i\n", p_data->data.recordingTime,
@@ -689,8 +964,6 @@ int CameraDcam::moduleLoop(void)
         datalength = p_data->data.width * p_data->data.height * bytesPerPixel +
                      sizeof(camera_data);
         putDataBufferWorkSpace(datalength);
-
-        dc1394_capture_enqueue(camera, frame);
     }
 
     RackTask::sleep((1000000000llu/fps) - rackTime.toNano(rackTime.get() - starttime));
@@ -771,9 +1044,10 @@ int CameraDcam::moduleInit(void)
     }
     initBits.setBit(INIT_BIT_DATA_MODULE);
 
-    if((dataBuffer = (char *)malloc( CAMERA_MAX_WIDTH * CAMERA_MAX_WIDTH * 2)) == NULL)
+    // row accumulator of the image pipeline (u y v y -> 2 samples per pixel)
+    if((accBuffer = (uint32_t *)malloc(CAMERA_MAX_WIDTH * 2 * sizeof(uint32_t))) == NULL)
     {
-        GDOS_ERROR("Can't allocate output data buffer\n");
+        GDOS_ERROR("Can't allocate row accumulator\n");
         return -ENOMEM;
     }
 
@@ -788,6 +1062,12 @@ void CameraDcam::moduleCleanup(void)
 {
     dc1394_free(dc1394_context);
 
+    if (accBuffer)
+    {
+        free(accBuffer);
+        accBuffer = NULL;
+    }
+
     // call RackDataModule cleanup function (last command in cleanup)
     if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
     {
@@ -814,6 +1094,11 @@ CameraDcam::CameraDcam()
                         //bytesPerPixel[i]    included in mode
     fps                 = getIntArg("fps", argTab);
     lossRate            = getIntArg("lossrate", argTab);
+    roiX                = getIntArg("roiX", argTab);
+    roiY                = getIntArg("roiY", argTab);
+    roiWidth            = getIntArg("roiWidth", argTab);
+    roiHeight           = getIntArg("roiHeight", argTab);
+    accBuffer           = NULL;
 
     if (fps > 10)
         fps = 10;
@@ -37,9 +37,22 @@ typedef struct {
     dc1394color_coding_t colorCodingId; // rggb=0; gbrg=1; grbg=2; bggr=3;
 } camera_dcam_format7;
 
+// image statistics for the brightness and white balance control
+typedef struct {
+    int brightnessMin;          // samples <= minHue
+    int brightnessMax;          // samples >= maxHue
+    int brightnessCount;
+    int uSum;                   // sum of (u - 128) in the white balance window
+    int vSum;                   // sum of (v - 128) in the white balance window
+    int uvCount;
+} camera_dcam_stats;
+
 // define module class
 #define MODULE_CLASS_ID     CAMERA
 
+#define CAMERA_DCAM_LOSS_SUBSAMPLE  0
+#define CAMERA_DCAM_LOSS_AVERAGE    1
+
 /**
  * Sensor driver for FireWire (IEEE1394) cameras with DCAM standard.
  *
@@ -55,13 +68,26 @@ class CameraDcam : public RackDataModule {
     int      whitebalanceMode;
     int      whitebalanceCols;
     int      whitebalanceRows;
-    char     *dataBuffer;
     int      fps;
 
+    //variables for the image pipeline (crop and downscale)
+    int      imageX, imageY;            // source window in sensor pixels
+    int      imageWidth, imageHeight;
+    int      outWidth, outHeight;       // size of the published image
+    int      sampleCols;                // horizontal period of the samples (pixel pair, bayer)
+    int      sampleRows;                // vertical period of the samples (bayer)
+    int      sampleBytes;               // bytes per sample
+    int      pairPixels;                // pixels that must not be divided
+    int      brightnessRowFirst;
+    uint32_t *accBuffer;
+
     //variables for parameter
     uint64_t cameraGuid;
     int      mode;
     unsigned int lossRate;
+    int      lossMode;
+    int      roiX, roiY;
+    int      roiWidth, roiHeight;
     int      vValueSet;
     int      uValueSet;
     int      minHue;
@@ -84,8 +110,14 @@ class CameraDcam : public RackDataModule {
     camera_param_data       param;
 
 
-    int autoBrightness(camera_data_msg *dataPackage);
-    int autoWhitebalance(camera_data_msg *dataPackage);
+    int autoBrightness(camera_dcam_stats *stats);
+    int autoWhitebalance(camera_dcam_stats *stats);
+    int setupImagePipeline(void);
+    int imageProcess(dc1394video_frame_t *frame, uint8_t *out, camera_dcam_stats *stats);
+    void imageRowSubsample(uint8_t *out, const uint8_t *in);
+    void imageRowAverage(uint8_t *out, const uint8_t *in, int stride);
+    void imageRowAverageYuv(uint8_t *out, const uint8_t *in, int stride);
+    void imageRowStats(const uint8_t *row, int r, camera_dcam_stats *stats);
     int findCameraByGuid(void);
     int setupCaptureFormat2(void);
     int setupCaptureFormat7(void);
@@ -21,7 +21,8 @@
 #define INIT_BIT_MBX_CAMERA   2
 #define INIT_BIT_PROXY_CAMERA 3
 #define INIT_BIT_RGBARRAY     4
-#define INIT_BIT_JPEGBUFFER   5
+#define INIT_BIT_STRIPEBUFFER 5
+#define INIT_BIT_PLANEBUFFER  6
 
 arg_table_t argTab[] = {
 
@@ -34,9 +35,130 @@ arg_table_t argTab[] = {
     { ARGOPT_OPT, "quality", ARGOPT_REQVAL, ARGOPT_VAL_INT,
       "quality", { 50 } },
 
+    { ARGOPT_OPT, "subsampling", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "chroma subsampling of color images, 422 or 420, default 422", { 422 } },
+
+    { ARGOPT_OPT, "threads", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "number of stripes encoded in parallel, default 1", { 1 } },
+
     { 0, "", 0, 0, "", { 0 } } // last entry
 };
 
+#define CAMERA_JPEG_CLIP(x)   ((x) < 0 ? 0 : ((x) > 255 ? 255 : (x)))
+
+#define JPEG_MARKER_SOF0      0xc0
+#define JPEG_MARKER_SOF1      0xc1
+#define JPEG_MARKER_RST0      0xd0
+#define JPEG_MARKER_EOI       0xd9
+#define JPEG_MARKER_SOS       0xda
+
+// libjpeg calls exit() on errors by default
+METHODDEF(void) jpegErrorExit(j_common_ptr cinfo)
+{
+    camera_jpeg_error_mgr *jerr = (camera_jpeg_error_mgr *)cinfo->err;
+
+    longjmp(jerr->setjmpBuffer, 1);
+}
+
+// luma of one UYVY row, padded to yWidth by repeating the last pixel
+static void uyvyLuma(uint8_t *y, const uint8_t *in, int width, int yWidth,
+                     const uint8_t *range)
+{
+    int x;
+
+    for (x = 0; x < width; x++)
+    {
+        y[x] = range[in[2 * x + 1]];
+    }
+    for (; x < yWidth; x++)
+    {
+        y[x] = y[width - 1];
+    }
+}
+
+// chroma of two UYVY rows (the same row for 4:2:2), padded to cWidth
+static void uyvyChroma(uint8_t *cb, uint8_t *cr, const uint8_t *in0, const uint8_t *in1,
+                       int width, int cWidth, const uint8_t *range)
+{
+    int x, pairs = width / 2;
+
+    if (in0 == in1)
+    {
+        for (x = 0; x < pairs; x++)
+        {
+            cb[x] = range[in0[4 * x]];
+            cr[x] = range[in0[4 * x + 2]];
+        }
+    }
+    else
+    {
+        for (x = 0; x < pairs; x++)
+        {
+            cb[x] = range[(in0[4 * x]     + in1[4 * x]     + 1) >> 1];
+            cr[x] = range[(in0[4 * x + 2] + in1[4 * x + 2] + 1) >> 1];
+        }
+    }
+    for (; x < cWidth; x++)
+    {
+        cb[x] = cb[pairs - 1];
+        cr[x] = cr[pairs - 1];
+    }
+}
+
+// offset of the entropy coded data behind the SOS header of a jpeg stream
+static int jpegScanOffset(const uint8_t *data, int length, int *sofOffset)
+{
+    int offset = 2;     // SOI
+    int marker;
+
+    while (offset + 4 <= length)
+    {
+        if (data[offset] != 0xff)
+        {
+            return -EINVAL;
+        }
+
+        marker = data[offset + 1];
+        if ((sofOffset) &&
+            ((marker == JPEG_MARKER_SOF0) || (marker == JPEG_MARKER_SOF1)))
+        {
+            *sofOffset = offset;
+        }
+
+        offset += 2 + ((data[offset + 2] << 8) | data[offset + 3]);
+
+        if (marker == JPEG_MARKER_SOS)
+        {
+            return offset;
+        }
+    }
+    return -EINVAL;
+}
+
+// copy entropy coded data and add restartBase to its restart marker numbers
+static void jpegCopyScan(uint8_t *dest, const uint8_t *src, int length, int restartBase)
+{
+    int i;
+
+    for (i = 0; i < length; i++)
+    {
+        dest[i] = src[i];
+
+        if ((src[i] == 0xff) && (i + 1 < length))
+        {
+            i++;
+            if ((src[i] & 0xf8) == JPEG_MARKER_RST0)
+            {
+                dest[i] = JPEG_MARKER_RST0 + ((src[i] + restartBase) & 7);
+            }
+            else
+            {
+                dest[i] = src[i];
+            }
+        }
+    }
+}
+
 
 /*******************************************************************************
  *   !!! REALTIME CONTEXT !!!
@@ -51,19 +173,36 @@ arg_table_t argTab[] = {
 
  int CameraJpeg::moduleOn(void)
 {
-    int ret;
+    int ret, i;
 
     // get dynamic module parameter
     quality       = getInt32Param("quality");
+    subsampling   = getInt32Param("subsampling");
+    threads       = getInt32Param("threads");
+
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+    if (threads > CAMERA_JPEG_STRIPE_MAX)
+    {
+        GDOS_WARNING("Limit threads to %d\n", CAMERA_JPEG_STRIPE_MAX);
+        threads = CAMERA_JPEG_STRIPE_MAX;
+    }
 
     GDOS_DBG_DETAIL("Initialising static compression structs \n");
 
     RackTask::disableRealtimeMode();
 
-    cinfo.err = jpeg_std_error(&jerr);
-    jpeg_create_compress(&cinfo);
-
-    jpeg_stdmem_dest( &cinfo, jpegBuffer );
+    for (i = 0; i < threads; i++)
+    {
+        stripe[i].module = this;
+        stripe[i].plane  = planeBuffer + i * CAMERA_JPEG_PLANE_BYTES;
+        stripe[i].cinfo.err = jpeg_std_error(&stripe[i].jerr.pub);
+        jpeg_create_compress(&stripe[i].cinfo);
+        stripe[i].jerr.pub.error_exit = jpegErrorExit;
+    }
+    stripeNum = threads;
 
     GDOS_DBG_DETAIL("Turn on Camera(%d/%d) \n", cameraSys, cameraInst);
 
@@ -85,14 +224,25 @@ arg_table_t argTab[] = {
         return ret;
     }
 
-    cinfo.image_width      = cameraInputMsg.data.width;
-    cinfo.image_height     = cameraInputMsg.data.height;
-    cinfo.input_components = (cameraInputMsg.data.depth / 8) > 1 ? 3 : 1; //16 bit werte sind yuv und werden zu rgb24 aufskaliert
-    cinfo.in_color_space   = (cameraInputMsg.data.depth / 8) > 1 ? JCS_RGB : JCS_GRAYSCALE;
-
-    jpeg_set_defaults( &cinfo );
-    jpeg_set_quality( &cinfo, quality, TRUE /* limit to baseline-JPEG values */ );
+    switch (cameraInputMsg.data.mode)
+    {
+        case CAMERA_MODE_YUV422:
+        case CAMERA_MODE_MONO8:
+        case CAMERA_MODE_RGB24:
+            break;
+        default:
+            GDOS_ERROR("Unkown image mode %i for camera_jpeg\n", cameraInputMsg.data.mode);
+            return -EINVAL;
+    }
 
+    if ((cameraInputMsg.data.width  > CAMERA_MAX_WIDTH) ||
+        (cameraInputMsg.data.height > CAMERA_MAX_HEIGHT))
+    {
+        GDOS_ERROR("Image size %ix%i exceeds %ix%i\n",
+                   cameraInputMsg.data.width, cameraInputMsg.data.height,
+                   CAMERA_MAX_WIDTH, CAMERA_MAX_HEIGHT);
+        return -EINVAL;
+    }
 
     GDOS_DBG_DETAIL("Request continuous data from Camera(%d/%d)\n", cameraSys, cameraInst);
     ret = camera->getContData(dataBufferPeriodTime, &cameraMbx, &dataBufferPeriodTime);
@@ -109,9 +259,15 @@ arg_table_t argTab[] = {
 
 void CameraJpeg::moduleOff(void)
 {
+   int i;
+
    RackDataModule::moduleOff();        // has to be first command in moduleOff();
 
-   jpeg_destroy_compress(&cinfo);
+   for (i = 0; i < stripeNum; i++)
+   {
+       jpeg_destroy_compress(&stripe[i].cinfo);
+   }
+   stripeNum = 0;
 
    camera->stopContData(&cameraMbx);
 
@@ -122,7 +278,6 @@ int CameraJpeg::moduleLoop(void)
     camera_data_msg*   p_data = NULL;
     camera_data_msg*   dataCameraInput = NULL;
     ssize_t            datalength = 0;
-//    rack_time_t          starttime;
     RackMessage        msgInfo;
     int                ret;
 
@@ -157,52 +312,31 @@ int CameraJpeg::moduleLoop(void)
 
     dataCameraInput = (camera_data_msg *) CameraData::parse(&msgInfo);
 
-    GDOS_DBG_INFO("converting camera data \n");
-
-    //convert camera_bytestream (may be yuv/raw mode) to rgb mode
-    switch(dataCameraInput->data.mode) {
-        case CAMERA_MODE_YUV422:
-            cameraTool.convertCharUYVY2BGR(rgbByteArray,
-                                           dataCameraInput->byteStream,
-                                           dataCameraInput->data.width,
-                                           dataCameraInput->data.height);
-            break;
-        case CAMERA_MODE_MONO8:
-        case CAMERA_MODE_RGB24:
-            cameraTool.convertCharBGR2RGB(rgbByteArray,
-                                           dataCameraInput->byteStream,
-                                           dataCameraInput->data.width,
-                                           dataCameraInput->data.height);
-//memcpy(rgbByteArray, dataCameraInput->byteStream, sizeof(dataCameraInput->byteStream));
-            break;
-        default:
-            GDOS_ERROR( "Unkown image mode %i for camera_jpeg\n", dataCameraInput->data.mode);
-    }
-    GDOS_DBG_INFO("starting compress \n");
-
-    jpeg_start_compress(&cinfo, TRUE);//true for outputting all tables
+    // quality and subsampling may have been changed by a set parameter command
+    quality     = getInt32Param("quality");
+    subsampling = getInt32Param("subsampling");
 
     GDOS_DBG_INFO("compressing\n");
 
-    compressByteStream2JpegStream(rgbByteArray, &cinfo);
-
-    GDOS_DBG_INFO("finishing compress\n");
-
-    jpeg_finish_compress(&cinfo);
+    ret = compressImage(dataCameraInput, p_data);
+    if (ret < 0)
+    {
+        GDOS_WARNING("Can't compress image of Camera(%d/%d), code = %d\n",
+                     cameraSys, cameraInst, ret);
+        cameraMbx.peekEnd();
+        return 0;
+    }
 
-    GDOS_DBG_INFO("sending data with jpeg size %i\n", ((jpeg_data_dst_ptr)cinfo.dest)->outstreamOffset);
+    GDOS_DBG_INFO("sending data with jpeg size %i\n", ret);
 
     p_data->data.recordingTime = dataCameraInput->data.recordingTime;
     p_data->data.width         = dataCameraInput->data.width;
     p_data->data.height        = dataCameraInput->data.height;
-    p_data->data.depth         = cinfo.input_components * 8;
+    p_data->data.depth         = stripe[0].cinfo.input_components * 8;
     p_data->data.mode          = CAMERA_MODE_JPEG;
-    p_data->data.colorFilterId = ((jpeg_data_dst_ptr)cinfo.dest)->outstreamOffset; //missused as array length here
-
-    memcpy(&(p_data->byteStream), jpegBuffer, ((jpeg_data_dst_ptr)cinfo.dest)->outstreamOffset);
+    p_data->data.colorFilterId = ret; //missused as array length here
 
-    datalength = sizeof(camera_data) +
-                 ((jpeg_data_dst_ptr)cinfo.dest)->outstreamOffset; //special in jdatadstmem.c!!
+    datalength = sizeof(camera_data) + ret;
 
     cameraMbx.peekEnd();
     putDataBufferWorkSpace(datalength);
@@ -237,6 +371,323 @@ int CameraJpeg::moduleCommand(RackMessage *msgInfo)
 }
 
 
+int CameraJpeg::compressImage(camera_data_msg *input, camera_data_msg *output)
+{
+    int         width  = input->data.width;
+    int         height = input->data.height;
+    int         mcuHeight, mcuRows, stripeRows, num;
+    int         length, offset, sofOffset, restartBase, ret, i;
+    uint8_t     *out = output->byteStream;
+
+    if ((width  < 2) || (width  > CAMERA_MAX_WIDTH) ||
+        (height < 1) || (height > CAMERA_MAX_HEIGHT))
+    {
+        return -EINVAL;
+    }
+
+    inputMsg  = input;
+    inputMode = input->data.mode;
+
+    switch (inputMode)
+    {
+        case CAMERA_MODE_YUV422:
+        case CAMERA_MODE_RGB24:
+            mcuHeight = (subsampling == CAMERA_JPEG_SUBSAMPLING_420) ? 2 * DCTSIZE : DCTSIZE;
+            break;
+        case CAMERA_MODE_MONO8:
+            mcuHeight = DCTSIZE;
+            break;
+        default:
+            return -EINVAL;
+    }
+
+#ifndef JCS_EXTENSIONS
+    if (inputMode == CAMERA_MODE_RGB24)
+    {
+        CameraTool::convertCharBGR2RGB(rgbByteArray, input->byteStream, width, height,
+                                       stripeNum);
+    }
+#endif
+
+    // split into stripes of whole MCU rows
+    mcuRows    = (height + mcuHeight - 1) / mcuHeight;
+    num        = (stripeNum < mcuRows) ? stripeNum : mcuRows;
+    stripeRows = ((mcuRows + num - 1) / num) * mcuHeight;
+    num        = (height + stripeRows - 1) / stripeRows;
+
+    restartInterval = (num > 1) ? 1 : 0;
+
+    for (i = 0; i < num; i++)
+    {
+        stripe[i].rowFirst = i * stripeRows;
+        stripe[i].rowNum   = height - stripe[i].rowFirst;
+        if (stripe[i].rowNum > stripeRows)
+        {
+            stripe[i].rowNum = stripeRows;
+        }
+
+        if (i == 0)
+        {
+            // the first stripe writes straight into the data buffer slot
+            stripe[i].out     = (char *)out;
+            stripe[i].outSize = CAMERA_MAX_BYTES;
+        }
+        else
+        {
+            stripe[i].out     = stripeBuffer + i * (CAMERA_MAX_BYTES / num);
+            stripe[i].outSize = CAMERA_MAX_BYTES / num;
+        }
+    }
+
+    for (i = 1; i < num; i++)
+    {
+        if (pthread_create(&stripe[i].thread, NULL, stripeThread, &stripe[i]))
+        {
+            stripe[i].thread = 0;
+            stripe[i].ret    = compressStripe(&stripe[i]);
+        }
+    }
+
+    stripe[0].ret = compressStripe(&stripe[0]);
+
+    ret = stripe[0].ret;
+    for (i = 1; i < num; i++)
+    {
+        if (stripe[i].thread)
+        {
+            pthread_join(stripe[i].thread, NULL);
+        }
+        if (stripe[i].ret)
+        {
+            ret = stripe[i].ret;
+        }
+    }
+    if (ret)
+    {
+        return ret;
+    }
+
+    if (num == 1)
+    {
+        return stripe[0].outLength;
+    }
+
+    // join the entropy coded segments behind the headers of the first stripe
+    sofOffset = -1;
+    if ((jpegScanOffset(out, stripe[0].outLength, &sofOffset) < 0) || (sofOffset < 0))
+    {
+        return -EINVAL;
+    }
+
+    length = stripe[0].outLength - 2;   // EOI
+
+    for (i = 1; i < num; i++)
+    {
+        offset = jpegScanOffset((uint8_t *)stripe[i].out, stripe[i].outLength, NULL);
+        if (offset < 0)
+        {
+            return -EINVAL;
+        }
+
+        if (length + 2 + stripe[i].outLength - 2 - offset + 2 > CAMERA_MAX_BYTES)
+        {
+            return -ENOSPC;
+        }
+
+        // restart interval is one MCU row
+        restartBase    = stripe[i].rowFirst / mcuHeight;
+        out[length]     = 0xff;
+        out[length + 1] = JPEG_MARKER_RST0 + ((restartBase - 1) & 7);
+        length += 2;
+
+        jpegCopyScan(out + length, (uint8_t *)stripe[i].out + offset,
+                     stripe[i].outLength - 2 - offset, restartBase);
+        length += stripe[i].outLength - 2 - offset;
+    }
+
+    out[length]     = 0xff;
+    out[length + 1] = JPEG_MARKER_EOI;
+    length += 2;
+
+    // image height of the SOF header
+    out[sofOffset + 5] = (height >> 8) & 0xff;
+    out[sofOffset + 6] = height & 0xff;
+
+    return length;
+}
+
+int CameraJpeg::compressStripe(camera_jpeg_stripe *stripe)
+{
+    j_compress_ptr cinfo = &stripe->cinfo;
+
+    if (setjmp(stripe->jerr.setjmpBuffer))
+    {
+        jpeg_abort_compress(cinfo);
+
+        if (stripe->jerr.pub.msg_code == JERR_BUFFER_SIZE)
+        {
+            return -ENOSPC;
+        }
+        return -EIO;
+    }
+
+    cinfo->image_width  = inputMsg->data.width;
+    cinfo->image_height = stripe->rowNum;
+
+    switch (inputMode)
+    {
+        case CAMERA_MODE_YUV422:
+            cinfo->input_components = 3;
+            cinfo->in_color_space   = JCS_YCbCr;
+            break;
+        case CAMERA_MODE_RGB24:
+            cinfo->input_components = 3;
+#ifdef JCS_EXTENSIONS
+            cinfo->in_color_space   = JCS_EXT_BGR;
+#else
+            cinfo->in_color_space   = JCS_RGB;
+#endif
+            break;
+        default:
+            cinfo->input_components = 1;
+            cinfo->in_color_space   = JCS_GRAYSCALE;
+            break;
+    }
+
+    jpeg_set_defaults(cinfo);
+    jpeg_set_quality(cinfo, quality, TRUE /* limit to baseline-JPEG values */ );
+
+    if (cinfo->input_components == 3)
+    {
+        cinfo->comp_info[0].h_samp_factor = 2;
+        cinfo->comp_info[0].v_samp_factor =
+            (subsampling == CAMERA_JPEG_SUBSAMPLING_420) ? 2 : 1;
+        cinfo->comp_info[1].h_samp_factor = 1;
+        cinfo->comp_info[1].v_samp_factor = 1;
+        cinfo->comp_info[2].h_samp_factor = 1;
+        cinfo->comp_info[2].v_samp_factor = 1;
+    }
+
+    cinfo->raw_data_in     = (inputMode == CAMERA_MODE_YUV422) ? TRUE : FALSE;
+    cinfo->restart_in_rows = restartInterval;
+
+    jpeg_direct_mem_dest(cinfo, stripe->out, stripe->outSize);
+
+    jpeg_start_compress(cinfo, TRUE);//true for outputting all tables
+
+    if (cinfo->raw_data_in)
+    {
+        compressRawData(stripe);
+    }
+    else
+    {
+        compressScanlines(stripe);
+    }
+
+    jpeg_finish_compress(cinfo);
+
+    stripe->outLength = ((jpeg_direct_dst_ptr)cinfo->dest)->outstreamOffset;
+    return 0;
+}
+
+void CameraJpeg::compressRawData(camera_jpeg_stripe *stripe)
+{
+    j_compress_ptr  cinfo  = &stripe->cinfo;
+    int             width  = cinfo->image_width;
+    int             lines  = cinfo->max_v_samp_factor * DCTSIZE;
+    int             yWidth = ((width + 2 * DCTSIZE - 1) / (2 * DCTSIZE)) * 2 * DCTSIZE;
+    int             cWidth = yWidth / 2;
+    int             rowBytes = 2 * width;
+    int             row, line, src0, src1;
+    uint8_t         *in = inputMsg->byteStream + stripe->rowFirst * rowBytes;
+    JSAMPROW        yRow[2 * DCTSIZE], cbRow[DCTSIZE], crRow[DCTSIZE];
+    JSAMPARRAY      planes[3] = { yRow, cbRow, crRow };
+
+    for (line = 0; line < 2 * DCTSIZE; line++)
+    {
+        yRow[line] = stripe->plane + line * CAMERA_JPEG_PLANE_WIDTH;
+    }
+    for (line = 0; line < DCTSIZE; line++)
+    {
+        cbRow[line] = stripe->plane + 2 * DCTSIZE * CAMERA_JPEG_PLANE_WIDTH +
+                      line * CAMERA_JPEG_PLANE_WIDTH / 2;
+        crRow[line] = cbRow[line] + DCTSIZE * CAMERA_JPEG_PLANE_WIDTH / 2;
+    }
+
+    // deinterleave one MCU row at a time, the rows below the stripe repeat
+    // the last row
+    for (row = 0; row < stripe->rowNum; row += lines)
+    {
+        for (line = 0; line < lines; line++)
+        {
+            src0 = row + line;
+            if (src0 >= stripe->rowNum)
+            {
+                src0 = stripe->rowNum - 1;
+            }
+            uyvyLuma(yRow[line], in + src0 * rowBytes, width, yWidth, rangeY);
+        }
+
+        for (line = 0; line < DCTSIZE; line++)
+        {
+            src0 = row + line * lines / DCTSIZE;
+            src1 = src0 + lines / DCTSIZE - 1;
+            if (src0 >= stripe->rowNum)
+            {
+                src0 = stripe->rowNum - 1;
+            }
+            if (src1 >= stripe->rowNum)
+            {
+                src1 = stripe->rowNum - 1;
+            }
+            uyvyChroma(cbRow[line], crRow[line], in + src0 * rowBytes, in + src1 * rowBytes,
+                       width, cWidth, rangeC);
+        }
+
+        jpeg_write_raw_data(cinfo, planes, lines);
+    }
+}
+
+void CameraJpeg::compressScanlines(camera_jpeg_stripe *stripe)
+{
+    j_compress_ptr  cinfo    = &stripe->cinfo;
+    int             rowBytes = cinfo->image_width * cinfo->input_components;
+    uint8_t         *in      = inputMsg->byteStream;
+    JSAMPROW        rowPointer[2 * DCTSIZE];
+    int             lines, i;
+
+#ifndef JCS_EXTENSIONS
+    if (inputMode == CAMERA_MODE_RGB24)
+    {
+        in = rgbByteArray;
+    }
+#endif
+    in += stripe->rowFirst * rowBytes;
+
+    while (cinfo->next_scanline < cinfo->image_height)
+    {
+        lines = cinfo->image_height - cinfo->next_scanline;
+        if (lines > 2 * DCTSIZE)
+        {
+            lines = 2 * DCTSIZE;
+        }
+
+        for (i = 0; i < lines; i++)
+        {
+            rowPointer[i] = in + (cinfo->next_scanline + i) * rowBytes;
+        }
+        jpeg_write_scanlines(cinfo, rowPointer, lines);
+    }
+}
+
+void *CameraJpeg::stripeThread(void *arg)
+{
+    camera_jpeg_stripe *stripe = (camera_jpeg_stripe *)arg;
+
+    stripe->ret = stripe->module->compressStripe(stripe);
+    return NULL;
+}
+
 /*******************************************************************************
  *   !!! NON REALTIME CONTEXT !!!
  *
@@ -287,19 +738,29 @@ int CameraJpeg::moduleInit(void)
     }
     initBits.setBit(INIT_BIT_PROXY_CAMERA);
 
-    if((rgbByteArray = (uint8_t *) malloc(CAMERA_MAX_WIDTH*CAMERA_MAX_HEIGHT*CAMERA_MAX_DEPTH/8)) == NULL)
+    if((rgbByteArray = (uint8_t *) malloc(CAMERA_MAX_BYTES)) == NULL)
     {
         GDOS_ERROR("Can't allocate rgbByteArray buffer\n");
-        return -ENOMEM;
+        ret = -ENOMEM;
+        goto init_error;
     }
     initBits.setBit(INIT_BIT_RGBARRAY);
 
-    if((jpegBuffer = (char *) malloc(CAMERA_MAX_WIDTH*CAMERA_MAX_HEIGHT*CAMERA_MAX_DEPTH/8)) == NULL)
+    if((stripeBuffer = (char *) malloc(CAMERA_MAX_BYTES)) == NULL)
     {
-        GDOS_ERROR("Can't allocate jpegBuffer\n");
-        return -ENOMEM;
+        GDOS_ERROR("Can't allocate stripeBuffer\n");
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_STRIPEBUFFER);
+
+    if((planeBuffer = (uint8_t *) malloc(CAMERA_JPEG_STRIPE_MAX * CAMERA_JPEG_PLANE_BYTES)) == NULL)
+    {
+        GDOS_ERROR("Can't allocate planeBuffer\n");
+        ret = -ENOMEM;
+        goto init_error;
     }
-    initBits.setBit(INIT_BIT_JPEGBUFFER);
+    initBits.setBit(INIT_BIT_PLANEBUFFER);
 
     return 0;
 
@@ -317,9 +778,14 @@ void CameraJpeg::moduleCleanup(void)
         RackDataModule::moduleCleanup();
     }
 
-    if (initBits.testAndClearBit(INIT_BIT_JPEGBUFFER))
+    if (initBits.testAndClearBit(INIT_BIT_PLANEBUFFER))
     {
-        free(jpegBuffer);
+        free(planeBuffer);
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_STRIPEBUFFER))
+    {
+        free(stripeBuffer);
     }
 
     if (initBits.testAndClearBit(INIT_BIT_RGBARRAY))
@@ -359,6 +825,15 @@ CameraJpeg::CameraJpeg()
     cameraInst    = getIntArg("cameraInst", argTab);
 
     dataBufferMaxDataSize = sizeof(camera_data_msg);
+
+    stripeNum = 0;
+
+    // ITU-R BT.601 video range to the full range of JFIF
+    for (int i = 0; i < 256; i++)
+    {
+        rangeY[i] = (uint8_t)CAMERA_JPEG_CLIP(((i - 16) * 255 + 109) / 219);
+        rangeC[i] = (uint8_t)CAMERA_JPEG_CLIP(128 + ((i - 128) * 255 + ((i < 128) ? -112 : 112)) / 224);
+    }
 }
 
 int main(int argc, char *argv[])
@@ -402,17 +877,3 @@ exit_error:
     return ret;
 }
 
-void CameraJpeg::compressByteStream2JpegStream(uint8_t* byteStream, j_compress_ptr cinfo)
-{
-    JSAMPLE* image_buffer = (JSAMPLE*) byteStream;
-    JSAMPROW row_pointer[1];   /* pointer to a single row */
-    int row_stride;            /* physical row width in buffer */
-
-    row_stride = cinfo->image_width * cinfo->input_components;    /* JSAMPLEs per row in image_buffer */
-
-    while (cinfo->next_scanline < cinfo->image_height) {
-        row_pointer[0] = &(image_buffer[cinfo->next_scanline * row_stride]);
-        jpeg_write_scanlines(cinfo, row_pointer, 1);
-    }
-        GDOS_DBG_INFO("end while\n");
-}
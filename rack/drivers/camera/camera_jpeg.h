@@ -22,15 +22,57 @@
 
 #include <main/jpeg_tool.h> //destination manager for memory destination
 
+#include <setjmp.h>
+#include <pthread.h>
+
 // define module class
 #define MODULE_CLASS_ID     CAMERA
 
+// chroma subsampling of color images
+#define CAMERA_JPEG_SUBSAMPLING_422     422
+#define CAMERA_JPEG_SUBSAMPLING_420     420
+
+#define CAMERA_JPEG_STRIPE_MAX          CAMERA_TOOL_THREAD_MAX
+
+// planar Y/Cb/Cr rows of one MCU row
+#define CAMERA_JPEG_PLANE_WIDTH         (CAMERA_MAX_WIDTH + 2 * DCTSIZE)
+#define CAMERA_JPEG_PLANE_BYTES         (3 * DCTSIZE * CAMERA_JPEG_PLANE_WIDTH)
 
+typedef struct
+{
+    struct jpeg_error_mgr       pub;
+    jmp_buf                     setjmpBuffer;
+} camera_jpeg_error_mgr;
+
+class CameraJpeg;
+
+typedef struct
+{
+    CameraJpeg                  *module;
+    struct jpeg_compress_struct cinfo;
+    camera_jpeg_error_mgr       jerr;
+    pthread_t                   thread;
+    int                         rowFirst;
+    int                         rowNum;
+    char                        *out;
+    int                         outSize;
+    int                         outLength;
+    uint8_t                     *plane;
+    int                         ret;
+} camera_jpeg_stripe;
 
 /**
  * Compression of raw camera images.
  *
- * Uses libjpeg.
+ * Uses libjpeg. YUV422 images are passed to the encoder in raw data mode,
+ * so there is no color conversion. The image is split into horizontal
+ * stripes of whole MCU rows that are encoded in parallel by pthreads. All
+ * stripes use a restart interval of one MCU row, so their entropy coded
+ * segments are joined into one baseline JPEG with renumbered restart
+ * markers. The first stripe is written straight into the data buffer slot.
+ *
+ * The parameters quality and subsampling can be changed while the module
+ * is running.
  *
  * @ingroup modules_camera
  */
@@ -41,14 +83,26 @@ class CameraJpeg : public RackDataModule {
     //variables for common control
     rack_time_t                 timeCount1s;
     uint8_t*                    rgbByteArray; //converted to char later on
-    char*                       jpegBuffer;//char enforced by jpegLib
-    struct jpeg_compress_struct cinfo;
-    struct jpeg_error_mgr       jerr;
+    char*                       stripeBuffer; //output of the stripes > 0
+    uint8_t*                    planeBuffer;
+
+    camera_jpeg_stripe          stripe[CAMERA_JPEG_STRIPE_MAX];
+    int                         stripeNum;
+    int                         restartInterval;
+
+    // video range to full range JFIF samples
+    uint8_t                     rangeY[256];
+    uint8_t                     rangeC[256];
+
+    camera_data_msg*            inputMsg;
+    int                         inputMode;
 
     //variables for parameter
     int cameraSys;
     int cameraInst;
     int quality;
+    int subsampling;
+    int threads;
 
     // additional mailboxes
     RackMailbox cameraMbx;
@@ -61,7 +115,12 @@ class CameraJpeg : public RackDataModule {
 
     CameraTool      cameraTool;
 
-    void compressByteStream2JpegStream(uint8_t* byteStream, j_compress_ptr cinfo);
+    int  compressImage(camera_data_msg *input, camera_data_msg *output);
+    int  compressStripe(camera_jpeg_stripe *stripe);
+    void compressRawData(camera_jpeg_stripe *stripe);
+    void compressScanlines(camera_jpeg_stripe *stripe);
+
+    static void *stripeThread(void *arg);
 
   protected:
 
@@ -0,0 +1,792 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#include "camera_v4l2.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+#define INIT_BIT_DATA_MODULE 0
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "width", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "width", { 640 } },
+
+    { ARGOPT_OPT, "height", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "height", { 480 } },
+
+    { ARGOPT_OPT, "mode", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "mode", { CAMERA_MODE_YUV422 } },
+
+    { ARGOPT_OPT, "videoId", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "videoId", { 0 } },
+
+    { ARGOPT_OPT, "fps", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Frame rate of the camera (0 = driver default), default 15", { 15 } },
+
+    { ARGOPT_OPT, "bufferNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of driver buffers in the capture queue, default 4", { 4 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+camera_param_data param = {
+        calibration_width  : CALIBRATION_WIDTH,
+        calibration_height : CALIBRATION_HEIGHT,
+        f   : F,
+        fx  : F_x,
+        fy  : F_y,
+        sx  : S_x,
+        sy  : S_y,
+        dx  : D_x,
+        dy  : D_y,
+        k1  : K1,
+        k2  : K2,
+        p1  : P1,
+        p2  : P2,
+        e0  : E0,
+        n0  : N0,
+};
+
+// supported pixel formats of every camera mode, in order of preference
+typedef struct
+{
+    int         mode;
+    uint32_t    pixelFormat;
+    int         depth;
+    uint32_t    colorFilterId;
+} camera_v4l2_format;
+
+static const camera_v4l2_format formatTab[] = {
+    { CAMERA_MODE_MONO8,  V4L2_PIX_FMT_GREY,    8,  0 },
+    { CAMERA_MODE_RGB24,  V4L2_PIX_FMT_RGB24,   24, 0 },
+    { CAMERA_MODE_RGB24,  V4L2_PIX_FMT_BGR24,   24, 0 },
+    { CAMERA_MODE_RGB565, V4L2_PIX_FMT_RGB565,  16, 0 },
+    { CAMERA_MODE_YUV422, V4L2_PIX_FMT_UYVY,    16, 0 },
+    { CAMERA_MODE_YUV422, V4L2_PIX_FMT_YUYV,    16, 0 },
+    { CAMERA_MODE_RAW8,   V4L2_PIX_FMT_SRGGB8,  8,  COLORFILTER_RGGB },
+    { CAMERA_MODE_RAW8,   V4L2_PIX_FMT_SGBRG8,  8,  COLORFILTER_GBRG },
+    { CAMERA_MODE_RAW8,   V4L2_PIX_FMT_SGRBG8,  8,  COLORFILTER_GRBG },
+    { CAMERA_MODE_RAW8,   V4L2_PIX_FMT_SBGGR8,  8,  COLORFILTER_BGGR },
+    { CAMERA_MODE_JPEG,   V4L2_PIX_FMT_MJPEG,   24, 0 },
+    { CAMERA_MODE_JPEG,   V4L2_PIX_FMT_JPEG,    24, 0 },
+    { 0,                  0,                    0,  0 }  // last entry
+};
+
+int CameraV4L2::xioctl(unsigned long request, void *arg)
+{
+    int ret;
+
+    do
+    {
+        ret = ioctl(dev, request, arg);
+    }
+    while ((ret == -1) && (errno == EINTR));
+
+    if (ret == -1)
+    {
+        return -errno;
+    }
+    return ret;
+}
+
+int CameraV4L2::setFormat(void)
+{
+    int                 i, ret;
+    struct v4l2_format  fmt;
+
+    for (i = 0; formatTab[i].mode; i++)
+    {
+        if (formatTab[i].mode != mode)
+            continue;
+
+        memset(&fmt, 0, sizeof(fmt));
+        fmt.type                = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        fmt.fmt.pix.width       = width;
+        fmt.fmt.pix.height      = height;
+        fmt.fmt.pix.pixelformat = formatTab[i].pixelFormat;
+        fmt.fmt.pix.field       = V4L2_FIELD_NONE;
+
+        ret = xioctl(VIDIOC_S_FMT, &fmt);
+        if (ret)
+        {
+            GDOS_ERROR("Can't set video format, code = %d\n", ret);
+            return ret;
+        }
+
+        // the driver replaces unsupported formats
+        if (fmt.fmt.pix.pixelformat != formatTab[i].pixelFormat)
+            continue;
+
+        if ((fmt.fmt.pix.width > CAMERA_MAX_WIDTH) ||
+            (fmt.fmt.pix.height > CAMERA_MAX_HEIGHT))
+        {
+            GDOS_ERROR("Image size %dx%d exceeds max size %dx%d\n",
+                       fmt.fmt.pix.width, fmt.fmt.pix.height,
+                       CAMERA_MAX_WIDTH, CAMERA_MAX_HEIGHT);
+            return -EINVAL;
+        }
+
+        width         = fmt.fmt.pix.width;
+        height        = fmt.fmt.pix.height;
+        depth         = formatTab[i].depth;
+        colorFilterId = formatTab[i].colorFilterId;
+        pixelFormat   = fmt.fmt.pix.pixelformat;
+        bytesPerLine  = fmt.fmt.pix.bytesperline;
+        imageSize     = fmt.fmt.pix.sizeimage;
+        swapYuyv      = (pixelFormat == V4L2_PIX_FMT_YUYV);
+        swapBgr       = (pixelFormat == V4L2_PIX_FMT_BGR24);
+
+        if (bytesPerLine < (uint32_t)(width * depth / 8))
+        {
+            bytesPerLine = width * depth / 8;
+        }
+
+        GDOS_DBG_INFO("Video format %c%c%c%c width %d height %d bytesPerLine %d imageSize %d\n",
+                      pixelFormat & 0xff, (pixelFormat >> 8) & 0xff,
+                      (pixelFormat >> 16) & 0xff, (pixelFormat >> 24) & 0xff,
+                      width, height, bytesPerLine, imageSize);
+        return 0;
+    }
+
+    GDOS_ERROR("Camera mode %d is not supported by %s\n", mode, devName);
+    return -EINVAL;
+}
+
+int CameraV4L2::setFrameRate(void)
+{
+    int                     ret;
+    struct v4l2_streamparm  parm;
+
+    memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    if (fps > 0)
+    {
+        parm.parm.capture.timeperframe.numerator   = 1;
+        parm.parm.capture.timeperframe.denominator = fps;
+
+        ret = xioctl(VIDIOC_S_PARM, &parm);
+        if (ret)
+        {
+            GDOS_WARNING("Can't set frame rate %d fps, code = %d\n", fps, ret);
+        }
+    }
+
+    ret = xioctl(VIDIOC_G_PARM, &parm);
+    if (!ret && parm.parm.capture.timeperframe.denominator)
+    {
+        dataBufferPeriodTime = 1000 * parm.parm.capture.timeperframe.numerator /
+                               parm.parm.capture.timeperframe.denominator;
+    }
+    else if (fps > 0)
+    {
+        dataBufferPeriodTime = 1000 / fps;
+    }
+
+    if (dataBufferPeriodTime == 0)
+    {
+        dataBufferPeriodTime = 1;
+    }
+
+    GDOS_DBG_INFO("Period time %d ms\n", dataBufferPeriodTime);
+    return 0;
+}
+
+int CameraV4L2::initBuffers(void)
+{
+    int                         i, ret;
+    struct v4l2_requestbuffers  req;
+    struct v4l2_buffer          buf;
+
+    memset(&req, 0, sizeof(req));
+    req.count  = bufferReq;
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    ret = xioctl(VIDIOC_REQBUFS, &req);
+    if (ret)
+    {
+        GDOS_ERROR("%s doesn't support memory mapped streaming, code = %d\n",
+                   devName, ret);
+        return ret;
+    }
+
+    if (req.count < 2)
+    {
+        GDOS_ERROR("Not enough driver buffers %d < 2\n", req.count);
+        return -ENOMEM;
+    }
+
+    // the driver may grant more buffers than requested, reduce its allocation
+    // to the buffers that are mapped and queued
+    if (req.count > CAMERA_V4L2_BUFFER_MAX)
+    {
+        req.count = CAMERA_V4L2_BUFFER_MAX;
+
+        ret = xioctl(VIDIOC_REQBUFS, &req);
+        if (ret)
+        {
+            GDOS_ERROR("Can't reduce driver buffers to %d, code = %d\n",
+                       CAMERA_V4L2_BUFFER_MAX, ret);
+            return ret;
+        }
+
+        if ((req.count < 2) || (req.count > CAMERA_V4L2_BUFFER_MAX))
+        {
+            GDOS_ERROR("Driver grants %d buffers, 2 .. %d needed\n", req.count,
+                       CAMERA_V4L2_BUFFER_MAX);
+            return -ENOMEM;
+        }
+    }
+
+    for (bufferNum = 0; bufferNum < (int)req.count; bufferNum++)
+    {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index  = bufferNum;
+
+        ret = xioctl(VIDIOC_QUERYBUF, &buf);
+        if (ret)
+        {
+            GDOS_ERROR("Can't query buffer %d, code = %d\n", bufferNum, ret);
+            return ret;
+        }
+
+        buffer[bufferNum].length = buf.length;
+        buffer[bufferNum].start  = mmap(NULL, buf.length, PROT_READ | PROT_WRITE,
+                                        MAP_SHARED, dev, buf.m.offset);
+        if (buffer[bufferNum].start == MAP_FAILED)
+        {
+            GDOS_ERROR("Can't map buffer %d\n", bufferNum);
+            return -ENOMEM;
+        }
+    }
+
+    for (i = 0; i < bufferNum; i++)
+    {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index  = i;
+
+        ret = xioctl(VIDIOC_QBUF, &buf);
+        if (ret)
+        {
+            GDOS_ERROR("Can't queue buffer %d, code = %d\n", i, ret);
+            return ret;
+        }
+    }
+
+    GDOS_DBG_INFO("%d buffers of %d bytes queued\n", bufferNum, buffer[0].length);
+    return 0;
+}
+
+void CameraV4L2::freeBuffers(void)
+{
+    int                         i;
+    struct v4l2_requestbuffers  req;
+
+    for (i = 0; i < bufferNum; i++)
+    {
+        munmap(buffer[i].start, buffer[i].length);
+    }
+    bufferNum = 0;
+
+    memset(&req, 0, sizeof(req));
+    req.count  = 0;
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    xioctl(VIDIOC_REQBUFS, &req);
+}
+
+int CameraV4L2::startStreaming(void)
+{
+    int                 ret;
+    enum v4l2_buf_type  type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    ret = xioctl(VIDIOC_STREAMON, &type);
+    if (ret)
+    {
+        GDOS_ERROR("Can't start streaming, code = %d\n", ret);
+        return ret;
+    }
+    streaming = 1;
+    return 0;
+}
+
+void CameraV4L2::stopStreaming(void)
+{
+    enum v4l2_buf_type  type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    if (streaming)
+    {
+        xioctl(VIDIOC_STREAMOFF, &type);
+        streaming = 0;
+    }
+}
+
+// The driver stamps every frame with CLOCK_MONOTONIC. The age of the frame
+// is subtracted from the current rack time.
+rack_time_t CameraV4L2::getRecordingTime(struct v4l2_buffer *buf)
+{
+    struct timespec now;
+    int64_t         age;
+    rack_time_t     time = rackTime.get();
+
+    if ((buf->flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) != V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC)
+    {
+        return time;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    age = ((int64_t)now.tv_sec - (int64_t)buf->timestamp.tv_sec) * 1000 +
+          ((int64_t)now.tv_nsec / 1000 - (int64_t)buf->timestamp.tv_usec) / 1000;
+
+    if ((age < 0) || (age > 10 * (int64_t)dataBufferPeriodTime + 1000))
+    {
+        return time;
+    }
+
+    return time - (rack_time_t)age;
+}
+
+void CameraV4L2::copyFrame(uint8_t *dest, const uint8_t *src, uint32_t bytesUsed)
+{
+    int             x, y;
+    uint32_t        lineSize = width * depth / 8;
+    const uint8_t   *s;
+    uint8_t         *d;
+
+    // compressed frames have a variable size
+    if (mode == CAMERA_MODE_JPEG)
+    {
+        memcpy(dest, src, bytesUsed);
+        return;
+    }
+
+    // plain copy
+    if (!swapYuyv && !swapBgr)
+    {
+        if (bytesPerLine == lineSize)
+        {
+            memcpy(dest, src, lineSize * height);
+        }
+        else
+        {
+            for (y = 0; y < height; y++)
+            {
+                memcpy(dest + y * lineSize, src + y * bytesPerLine, lineSize);
+            }
+        }
+        return;
+    }
+
+    // byte order conversion while copying
+    for (y = 0; y < height; y++)
+    {
+        s = src + y * bytesPerLine;
+        d = dest + y * lineSize;
+
+        if (swapYuyv)       // YUYV -> UYVY
+        {
+            for (x = 0; x < width; x += 2)
+            {
+                d[0] = s[1];
+                d[1] = s[0];
+                d[2] = s[3];
+                d[3] = s[2];
+                s += 4;
+                d += 4;
+            }
+        }
+        else                // BGR -> RGB
+        {
+            for (x = 0; x < width; x++)
+            {
+                d[0] = s[2];
+                d[1] = s[1];
+                d[2] = s[0];
+                s += 3;
+                d += 3;
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+
+int CameraV4L2::moduleOn(void)
+{
+    int                     ret;
+    struct v4l2_capability  cap;
+
+    // get dynamic module parameter
+    fps        = getInt32Param("fps");
+    bufferReq  = getInt32Param("bufferNum");
+
+    GDOS_DBG_INFO("Open %s\n", devName);
+
+    // v4l2 ioctls are linux syscalls
+    RackTask::disableRealtimeMode();
+
+    dev = open(devName, O_RDWR | O_NONBLOCK);
+    if (dev < 0)
+    {
+        GDOS_ERROR("Can't open %s, code = %d\n", devName, -errno);
+        return -errno;
+    }
+
+    ret = xioctl(VIDIOC_QUERYCAP, &cap);
+    if (ret)
+    {
+        GDOS_ERROR("%s is no V4L2 device, code = %d\n", devName, ret);
+        goto on_error;
+    }
+
+    if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) ||
+        !(cap.capabilities & V4L2_CAP_STREAMING))
+    {
+        GDOS_ERROR("%s (%s) is no streaming capture device\n", devName, cap.card);
+        ret = -EINVAL;
+        goto on_error;
+    }
+
+    GDOS_DBG_INFO("Device %s driver %s\n", cap.card, cap.driver);
+
+    ret = setFormat();
+    if (ret)
+    {
+        goto on_error;
+    }
+
+    setFrameRate();
+
+    ret = initBuffers();
+    if (ret)
+    {
+        goto on_error;
+    }
+
+    ret = startStreaming();
+    if (ret)
+    {
+        goto on_error;
+    }
+
+    lastSequence = 0;
+
+    GDOS_DBG_INFO("Camera on with parameter: width %i height %i depth %i mode %i\n",
+                  width, height, depth, mode);
+
+    return RackDataModule::moduleOn();  // has to be last command in moduleOn();
+
+on_error:
+    freeBuffers();
+    close(dev);
+    dev = -1;
+    return ret;
+}
+
+void CameraV4L2::moduleOff(void)
+{
+    RackDataModule::moduleOff();        // has to be first command in moduleOff();
+
+    GDOS_DBG_INFO("Close %s\n", devName);
+
+    if (dev >= 0)
+    {
+        stopStreaming();
+        freeBuffers();
+        close(dev);
+        dev = -1;
+    }
+}
+
+int CameraV4L2::moduleLoop(void)
+{
+    camera_data_msg     *p_data = NULL;
+    struct v4l2_buffer  buf, nextBuf;
+    struct pollfd       pfd;
+    uint32_t            datalength;
+    int                 ret;
+
+    // get datapointer from databuffer
+    p_data = (camera_data_msg *)getDataBufferWorkSpace();
+
+    // wait for the next frame
+    pfd.fd      = dev;
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+
+    ret = poll(&pfd, 1, 2 * dataBufferPeriodTime + 100);
+    if (ret < 0)
+    {
+        if (errno == EINTR)
+            return 0;
+
+        GDOS_ERROR("Can't poll %s, code = %d\n", devName, -errno);
+        return -errno;
+    }
+    if (ret == 0)
+    {
+        GDOS_ERROR("Timeout, no frame within %d ms\n", 2 * dataBufferPeriodTime + 100);
+        return -ETIMEDOUT;
+    }
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+
+    ret = xioctl(VIDIOC_DQBUF, &buf);
+    if (ret == -EAGAIN)
+    {
+        return 0;
+    }
+    if (ret)
+    {
+        GDOS_ERROR("Can't dequeue buffer, code = %d\n", ret);
+        return ret;
+    }
+
+    // the data task fell behind -> skip to the newest frame
+    while (1)
+    {
+        memset(&nextBuf, 0, sizeof(nextBuf));
+        nextBuf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        nextBuf.memory = V4L2_MEMORY_MMAP;
+
+        if (xioctl(VIDIOC_DQBUF, &nextBuf))
+            break;
+
+        xioctl(VIDIOC_QBUF, &buf);
+        buf = nextBuf;
+    }
+
+    if ((buf.flags & V4L2_BUF_FLAG_ERROR) || (buf.index >= (uint32_t)bufferNum))
+    {
+        GDOS_WARNING("Corrupt frame %d\n", buf.sequence);
+        xioctl(VIDIOC_QBUF, &buf);
+        return 0;
+    }
+
+    if (lastSequence && (buf.sequence != lastSequence + 1))
+    {
+        GDOS_DBG_DETAIL("Dropped %d frames\n", buf.sequence - lastSequence - 1);
+    }
+    lastSequence = buf.sequence;
+
+    if (mode == CAMERA_MODE_JPEG)
+    {
+        datalength = buf.bytesused;
+    }
+    else
+    {
+        datalength = width * height * depth / 8;
+    }
+
+    if (datalength > CAMERA_MAX_BYTES)
+    {
+        GDOS_ERROR("Frame size %d exceeds max size %d\n", datalength, CAMERA_MAX_BYTES);
+        xioctl(VIDIOC_QBUF, &buf);
+        return -EINVAL;
+    }
+
+    p_data->data.recordingTime  = getRecordingTime(&buf);
+    p_data->data.width          = width;
+    p_data->data.height         = height;
+    p_data->data.depth          = depth;
+    p_data->data.mode           = mode;
+    p_data->data.colorFilterId  = colorFilterId;
+
+    copyFrame(p_data->byteStream, (uint8_t *)buffer[buf.index].start, buf.bytesused);
+
+    // give the buffer back to the driver
+    ret = xioctl(VIDIOC_QBUF, &buf);
+    if (ret)
+    {
+        GDOS_ERROR("Can't queue buffer %d, code = %d\n", buf.index, ret);
+        return ret;
+    }
+
+    GDOS_DBG_DETAIL("Data recordingtime %i sequence %i width %i height %i depth %i mode %i\n",
+                    p_data->data.recordingTime, buf.sequence, p_data->data.width,
+                    p_data->data.height, p_data->data.depth, p_data->data.mode);
+
+    putDataBufferWorkSpace(sizeof(camera_data) + datalength);
+    return 0;
+}
+
+//
+// Command handling
+//
+int CameraV4L2::moduleCommand(RackMessage *msgInfo)
+{
+    camera_format_data      *p_format;
+
+    switch (msgInfo->getType())
+    {
+    case MSG_CAMERA_GET_PARAMETER:
+        cmdMbx.sendDataMsgReply(MSG_CAMERA_PARAMETER, msgInfo, 1, &param,
+                                sizeof(camera_param_data));
+        break;
+
+    case MSG_CAMERA_SET_FORMAT:
+        if(status == MODULE_STATE_DISABLED)
+        {
+            p_format = CameraFormatData::parse(msgInfo);
+
+            GDOS_DBG_INFO( "set format width=%i height=%i depth=%i mode=%i\n", p_format->width, p_format->height, p_format->depth, p_format->mode);
+
+            if(p_format->width >= 0)
+                width    = p_format->width;
+            if(p_format->height >= 0)
+                height   = p_format->height;
+            if(p_format->mode >= 0)
+                mode     = p_format->mode;
+
+            cmdMbx.sendMsgReply(MSG_OK, msgInfo);
+        }
+        else
+        {
+            GDOS_WARNING("Camera needs to be turned off to set format\n");
+
+            cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+            break;
+        }
+        break;
+
+    default:
+        // not for me -> ask RackDataModule
+        return RackDataModule::moduleCommand(msgInfo);
+    }
+    return 0;
+}
+
+
+/*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+
+int CameraV4L2::moduleInit(void)
+{
+    int ret;
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    snprintf(devName, sizeof(devName), "/dev/video%i", videoId);
+    return 0;
+}
+
+void CameraV4L2::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+}
+
+CameraV4L2::CameraV4L2()
+        : RackDataModule( MODULE_CLASS_ID,
+                      5000000000llu,        // 5s datatask error sleep time
+                      16,                   // command mailbox slots
+                      48,                   // command mailbox data size per slot
+                      MBX_IN_KERNELSPACE | MBX_SLOT, // command mailbox flags
+                      20,                   // max buffer entries
+                      10)                   // data buffer listener
+{
+    // get static module parameter
+    width               = getIntArg("width", argTab);
+    height              = getIntArg("height", argTab);
+    mode                = getIntArg("mode", argTab);
+    videoId             = getIntArg("videoId", argTab);
+
+    dev                 = -1;
+    streaming           = 0;
+    bufferNum           = 0;
+    depth               = 0;
+    colorFilterId       = 0;
+
+    dataBufferMaxDataSize   = sizeof(camera_data_msg);
+    dataBufferPeriodTime    = 66;   // updated by the driver frame rate
+}
+
+int main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "CameraV4L2");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    // create new CameraV4L2
+
+    CameraV4L2 *pInst;
+
+    pInst = new CameraV4L2();
+    if (!pInst)
+    {
+        printf("Can't create new CameraV4L2 -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // init
+
+    ret = pInst->moduleInit();
+    if (ret)
+        goto exit_error;
+
+    pInst->run();
+
+    return 0;
+
+exit_error:
+
+    delete (pInst);
+
+    return ret;
+}
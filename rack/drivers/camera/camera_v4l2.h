@@ -0,0 +1,106 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __CAMERA_V4L2_H__
+#define __CAMERA_V4L2_H__
+
+#include <main/rack_data_module.h>
+
+#include <drivers/camera_proxy.h>
+
+#include <linux/videodev2.h>
+
+#include "creative_calibration_parameter_lr0.h"
+
+// define module class
+#define MODULE_CLASS_ID             CAMERA
+
+#define CAMERA_V4L2_BUFFER_MAX      16
+
+typedef struct
+{
+    void        *start;
+    size_t      length;
+} camera_v4l2_buffer;
+
+/**
+ * Video for Linux 2
+ *
+ * Streaming capture with a queue of memory mapped driver buffers. The data
+ * task waits in poll() for the next filled buffer, copies it into the data
+ * buffer and requeues it at once. The recording time is taken from the
+ * driver timestamp of the frame.
+ *
+ * @ingroup modules_camera
+ */
+class CameraV4L2 : public RackDataModule {
+  private:
+
+    // device
+    int                 dev;
+    char                devName[256];
+    int                 streaming;
+
+    camera_v4l2_buffer  buffer[CAMERA_V4L2_BUFFER_MAX];
+    int                 bufferNum;
+
+    uint32_t            pixelFormat;
+    uint32_t            bytesPerLine;
+    uint32_t            imageSize;
+    int                 swapYuyv;           // convert YUYV to UYVY while copying
+    int                 swapBgr;            // convert BGR24 to RGB24 while copying
+    uint32_t            lastSequence;
+
+    // camera format
+    int                 width;
+    int                 height;
+    int                 depth;
+    int                 mode;
+    uint32_t            colorFilterId;
+
+    // parameter
+    int                 videoId;
+    int                 fps;
+    int                 bufferReq;
+
+    int                 xioctl(unsigned long request, void *arg);
+    int                 setFormat(void);
+    int                 setFrameRate(void);
+    int                 initBuffers(void);
+    void                freeBuffers(void);
+    int                 startStreaming(void);
+    void                stopStreaming(void);
+    rack_time_t         getRecordingTime(struct v4l2_buffer *buf);
+    void                copyFrame(uint8_t *dest, const uint8_t *src, uint32_t bytesUsed);
+
+  protected:
+
+    // -> realtime context
+    int  moduleOn(void);
+    void moduleOff(void);
+    int  moduleLoop(void);
+    int  moduleCommand(RackMessage *msgInfo);
+
+    // -> non realtime context
+    void moduleCleanup(void);
+
+  public:
+
+    // constructor und destructor
+    CameraV4L2();
+    ~CameraV4L2() {};
+
+    // -> non realtime context
+    int  moduleInit(void);
+};
+
+#endif // __CAMERA_V4L2_H__
@@ -137,6 +137,47 @@ const struct rtser_config pioneer_serial_config = {
     event_mask        : RTSER_EVENT_RXPEND
 };
 
+// SIP: 0xFA 0xFB, byte count, data, checksum (big endian)
+static int sipCheck(const uint8_t *frame, int frameLen, void *arg)
+{
+    const uint8_t   *ptr = &frame[3];
+    int             n = frame[2] - 2;
+    int             c = 0;
+
+    if (n < 0)
+        return -EINVAL;
+
+    while (n > 1)
+    {
+        c += (ptr[0] << 8) | ptr[1];
+        c = c & 0xffff;
+        n -= 2;
+        ptr += 2;
+    }
+    if (n > 0)
+        c = c ^ (int)*(ptr++);
+
+    return (c == ((ptr[0] << 8) | ptr[1])) ? 0 : -EINVAL;
+}
+
+serial_frame_format pioneer_sip_format = {
+    sync              : { 0xFA, 0xFB },
+    syncMask          : { 0xFF, 0xFF },
+    syncLen           : 2,
+    lenOffset         : 2,
+    lenSize           : 1,
+    lenBigEndian      : 0,
+    lenScale          : 1,
+    lenAdd            : 3,
+    terminator        : -1,
+    frameLen          : 0,
+    maxLen            : MAX_SIP_PACKAGE_SIZE,
+    maxSkip           : MAX_SIP_PACKAGE_SIZE,
+    getLength         : NULL,
+    check             : sipCheck,
+    arg               : NULL
+};
+
 // vehicle parameter
 
 chassis_param_data param = {
@@ -183,7 +224,7 @@ chassis_param_data param = {
 
  int ChassisPioneer::moduleOn(void)
 {
-    unsigned char buffer[MAX_SIP_PACKAGE_SIZE];
+    unsigned char *buffer;
     int totalCount;
     int ret;
 
@@ -210,11 +251,11 @@ chassis_param_data param = {
     param.pilotParameterB   = (float)getInt32Param("pilotParameterB") / 100.0f;
     param.pilotVTransMax    = getInt32Param("pilotVTransMax");
 
-    serialPort.clean();
+    serialFramer.clean();
     serialPort.setRecvTimeout(200000000llu);
 
     // check if server connection is already open
-    if (receivePackage(buffer, NULL) == 0)
+    if (receivePackage(&buffer, NULL) == 0)
     {
         // check if received package id standard SIP or encoder SIP
         if (((buffer[3] & 0xF0) == 0x30) | (buffer[3] == 0x90))
@@ -246,7 +287,7 @@ chassis_param_data param = {
         totalCount = 0;
         do
         {
-            ret = receivePackage(buffer, NULL);
+            ret = receivePackage(&buffer, NULL);
             if (ret)
             {
                 GDOS_WARNING("No response on sync0\n");
@@ -273,7 +314,7 @@ chassis_param_data param = {
         totalCount = 0;
         do
         {
-            ret = receivePackage(buffer, NULL);
+            ret = receivePackage(&buffer, NULL);
             if (ret)
             {
                 GDOS_WARNING("No response on sync1\n");
@@ -300,7 +341,7 @@ chassis_param_data param = {
         totalCount = 0;
         do
         {
-            ret = receivePackage(buffer, NULL);
+            ret = receivePackage(&buffer, NULL);
             if (ret)
             {
                 GDOS_WARNING("No response on sync2\n");
@@ -422,7 +463,7 @@ int ChassisPioneer::moduleLoop(void)
 {
     chassis_data*   p_data = NULL;
     ssize_t         datalength = 0;
-    unsigned char   buffer[MAX_SIP_PACKAGE_SIZE];
+    unsigned char   *buffer;
     rack_time_t     time;
     float           deltaT, vL, vR;
     int             ret, i;
@@ -433,7 +474,7 @@ int ChassisPioneer::moduleLoop(void)
     // get datapointer from rackdatabuffer
     p_data = (chassis_data *)getDataBufferWorkSpace();
 
-    ret = receivePackage(buffer, &time);
+    ret = receivePackage(&buffer, &time);
     if (ret)
     {
         GDOS_ERROR("Can't receive SIP package\n");
@@ -699,41 +740,26 @@ int ChassisPioneer::calculate_checksum(unsigned char *ptr)
     return c;
 }
 
-int ChassisPioneer::receivePackage(unsigned char *sipBuffer, rack_time_t *timestamp)
+// the package stays valid until the next call
+int ChassisPioneer::receivePackage(unsigned char **pp_sip, rack_time_t *timestamp)
 {
-    int totalCount = 0;
+    unsigned char *sipBuffer;
     int ret;
 
-    do
-    {
-        ret = serialPort.recv(sipBuffer, 1, timestamp);
-        if (ret)
-        {
-            GDOS_ERROR("Receive package timeout on serial dev %i\n", serialDev);
-            return ret;
-        }
-        if (++totalCount > MAX_SIP_PACKAGE_SIZE)
-        {
-            GDOS_ERROR("Can't synchronize on package head\n");
-            return -ETIME;
-        }
-    }
-    while (sipBuffer[0] != 0xFA);
-
-    ret = serialPort.recv(&sipBuffer[1], 2, NULL);
-    if (ret)
+    ret = serialFramer.readFrame(&sipBuffer, timestamp, NULL);
+    if (ret == -ETIME)
     {
-        GDOS_ERROR("Can't read package head\n");
+        GDOS_ERROR("Can't synchronize on package head\n");
         return ret;
     }
-
-    ret = serialPort.recv(&sipBuffer[3], sipBuffer[2], NULL);
-    if (ret)
+    else if (ret < 0)
     {
-        GDOS_ERROR("Can't read package body\n");
+        GDOS_ERROR("Receive package timeout on serial dev %i\n", serialDev);
         return ret;
     }
 
+    *pp_sip = sipBuffer;
+
     GDOS_DBG_DETAIL("Received SIP: [0]=%x [1]=%x [2]=%x [3]=%x ...\n",
                     sipBuffer[0], sipBuffer[1], sipBuffer[2], sipBuffer[3]);
 
@@ -849,6 +875,7 @@ int ChassisPioneer::sendMovePackage(int vx, float omega)
 #define INIT_BIT_MTX_CREATED                2
 #define INIT_BIT_MBX_WORK                   3
 #define INIT_BIT_PROXY_SONAR                4
+#define INIT_BIT_SERIAL_FRAMER              5
 
 int ChassisPioneer::moduleInit(void)
 {
@@ -871,6 +898,14 @@ int ChassisPioneer::moduleInit(void)
     }
     initBits.setBit(INIT_BIT_RTSERIAL_OPENED);
 
+    // SIP parser
+    ret = serialFramer.init(&serialPort, &pioneer_sip_format, 4 * MAX_SIP_PACKAGE_SIZE);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_SERIAL_FRAMER);
+
     // create hardware mutex
     ret = hwMtx.create();
     if (ret)
@@ -936,6 +971,11 @@ void ChassisPioneer::moduleCleanup(void)
         hwMtx.destroy();
     }
 
+    if (initBits.testAndClearBit(INIT_BIT_SERIAL_FRAMER))
+    {
+        serialFramer.cleanup();
+    }
+
     // close serial port
     if (initBits.testAndClearBit(INIT_BIT_RTSERIAL_OPENED))
     {
@@ -19,6 +19,7 @@
 #include <main/rack_data_module.h>
 
 #include <main/serial_port.h>
+#include <main/serial_framer.h>
 #include <drivers/chassis_proxy.h>
 #include <drivers/ladar_proxy.h>
 
@@ -52,6 +53,7 @@ class ChassisPioneer : public RackDataModule {
     // your values
     int             serialDev;
     SerialPort      serialPort;
+    SerialFramer    serialFramer;
     int             ladarSonarSys;
     int             ladarSonarInst;
 
@@ -79,7 +81,7 @@ class ChassisPioneer : public RackDataModule {
     LadarProxy      *ladarSonar;
 
     int  calculate_checksum(unsigned char *ptr);
-    int  receivePackage(unsigned char *sipBuffer, rack_time_t *timestamp);
+    int  receivePackage(unsigned char **pp_sip, rack_time_t *timestamp);
     int  sendPackage(const unsigned char *package, int packageSize);
     int  sendMovePackage(int vx, float omega);
 
@@ -234,31 +234,19 @@ int ChassisUsarsim::moduleOn(void)
     commandData.omega = 0;  // in mm
     activePilot = CHASSIS_INVAL_PILOT;
     
-    //preparing tcp Socket
-    inet_pton(AF_INET, usarsimIp, &(tcpAddr.sin_addr));
-    tcpAddr.sin_port = htons((unsigned short)usarsimPort);
-    tcpAddr.sin_family = AF_INET;
-    bzero(&(tcpAddr.sin_zero), 8);
-
     RackTask::disableRealtimeMode();
-    
-    //openning tcp Socket
-    GDOS_DBG_INFO("open network socket...\n");
-    tcpSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (tcpSocket == -1)
-    {
-            GDOS_ERROR("Can't create tcp Socket, (%d)\n",errno);
-            return -errno;
-    }
 
-    //connect to tcp Socket
-    GDOS_DBG_INFO("Connect to network socket\n");
-    ret = connect(tcpSocket, (struct sockaddr *)&tcpAddr, sizeof(tcpAddr));
-    if(ret)
+    // connect to USARSim server, reconnects are handled by the net port
+    GDOS_DBG_INFO("Connect to USARSim server %s:%d\n", usarsimIp, usarsimPort);
+    ret = netPort.open(usarsimIp, usarsimPort, NET_PORT_TCP, &netFraming,
+                       4 * USARSIM_MAX_MSG_SIZE, USARSIM_CONNECT_TIMEOUT, this);
+    if (ret)
     {
-           GDOS_ERROR("Can't connect to tcp Socket, (%d)\n",errno);
-           return    errno;
+        GDOS_ERROR("Can't connect to USARSim server, code = %d\n", ret);
+        RackTask::enableRealtimeMode();
+        return ret;
     }
+    netConnectCount = netPort.getConnectCount();
 
     ret = chassisInit(usarsimChassis, chassisInitPos);
     if(ret)
@@ -381,11 +369,7 @@ void ChassisUsarsim::moduleOff(void)
     // closing tcp Socket
     RackTask::disableRealtimeMode();
 
-    if(tcpSocket !=-1)
-    {
-        close(tcpSocket);
-        tcpSocket = -1;
-    }
+    netPort.close();
 
     RackTask::enableRealtimeMode();
 }
@@ -398,23 +382,44 @@ int ChassisUsarsim::moduleLoop(void)
     int currentBatteryState;
     rack_time_t currentTime;
 
+    net_port_frame frame;
+
     RackTask::disableRealtimeMode();
-    
-    ret = recv(tcpSocket, messageData, USARSIM_MAX_MSG_SIZE, 0);
+    ret = netPort.recvFrame(&frame, USARSIM_RECV_TIMEOUT);
     RackTask::enableRealtimeMode();
-    if (ret <= 0)
+    if (ret)
     {
-        GDOS_ERROR("Can't get data from USARSIM server\n");
+        if (netPort.getState() != NET_PORT_CONNECTED)
+        {
+            GDOS_WARNING("No connection to USARSim server, code = %d\n",
+                         netPort.getError());
+            return 0;
+        }
+        if (ret == -ETIMEDOUT)
+        {
+            return 0;
+        }
+        GDOS_ERROR("Can't get data from USARSim server, code = %d\n", ret);
         return ret;
     }
-    else if (ret >= USARSIM_MAX_MSG_SIZE)
+
+    // the server lost the robot after a reconnect
+    if (netPort.getConnectCount() != netConnectCount)
     {
-        GDOS_ERROR("USARSim message exceeds buffer size !\n");
+        netConnectCount = netPort.getConnectCount();
+        GDOS_WARNING("Reconnected to USARSim server, spawn chassis again\n");
+
+        ret = chassisInit(usarsimChassis, chassisInitPos);
+        if (ret)
+        {
+            return ret;
+        }
+        controlTrace(controlTraceState, 0.0f, controlTraceColor);
     }
-	
-	currentTime = rackTime.get();
-    
-    messageStr = messageData;
+
+    currentTime = frame.recordingTime;
+
+    messageStr.assign((const char *)frame.data, frame.len);
 
     if (messageStr.find("SEN") != string::npos)
     {
@@ -591,7 +596,7 @@ int ChassisUsarsim::chassisInit(char *usarsimChassis, position_3d chassisInitPos
         return -1;
     }
     
-    ret = send(tcpSocket, buffer, strLen, 0);
+    ret = netPort.send(buffer, strLen);
     if (ret < 0)
     {
         GDOS_ERROR("Error sending data, (%ret)",ret);
@@ -635,7 +640,7 @@ int ChassisUsarsim::sendMoveCommand(int speed, float omega, int type)
         return -1;
     }
 
-    ret = send(tcpSocket, buffer, strLen, 0);
+    ret = netPort.send(buffer, strLen);
     if (ret < 0)
     {
         GDOS_ERROR("Error sending data, (%ret)",ret);
@@ -656,7 +661,7 @@ int ChassisUsarsim::controlTrace(int state, float interval, int color)
         return -1;
     }
 
-    ret = send(tcpSocket, buffer, strLen, 0);
+    ret = netPort.send(buffer, strLen);
     if (ret < 0)
     {
         GDOS_ERROR("Error sending data, (%ret)",ret);
@@ -1194,6 +1199,15 @@ ChassisUsarsim::ChassisUsarsim()
     param.pilotParameterB   = (float)getIntArg("pilotParameterB", argTab) / 100.0f;
     param.pilotVTransMax    = getIntArg("pilotVTransMax", argTab);
     dataBufferMaxDataSize   = sizeof(chassis_data);
+
+    // one message per line
+    memset(&netFraming, 0, sizeof(netFraming));
+    netFraming.type         = NET_PORT_FRAME_DELIMITER;
+    netFraming.end[0]       = '\r';
+    netFraming.end[1]       = '\n';
+    netFraming.endLen       = 2;
+    netFraming.frameMax     = USARSIM_MAX_MSG_SIZE;
+    netConnectCount         = 0;
 }
 
 int main(int argc, char *argv[])
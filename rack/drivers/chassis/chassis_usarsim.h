@@ -22,9 +22,7 @@
 #include <drivers/ladar_proxy.h>
 #include <navigation/odometry_proxy.h>
 #include <navigation/position_proxy.h>
-#include <netinet/in.h>
-#include <sys/socket.h>
-#include <arpa/inet.h>
+#include <main/net_port.h>
 #include <string>
 
 using namespace std;
@@ -36,6 +34,8 @@ using namespace std;
 
 #define USARSIM_BUFFER      200
 #define USARSIM_MAX_MSG_SIZE    18432
+#define USARSIM_CONNECT_TIMEOUT 2000000000ll    // 2s
+#define USARSIM_RECV_TIMEOUT    1000000000ll    // 1s
 
 typedef struct
 {
@@ -68,15 +68,14 @@ class ChassisUsarsim : public RackDataModule
     int                 controlTraceState;
     int                 controlTraceColor;
 
-    int                  tcpSocket;
-    struct               sockaddr_in tcpAddr;
+    NetPort             netPort;
+    net_port_framing    netFraming;
+    int                 netConnectCount;
     char                 *usarsimIp;
     char                 *usarsimChassis;
     int                  usarsimPort;
     int                 maxBatteryState;
 
-    char                messageData[USARSIM_MAX_MSG_SIZE];
-
     rack_time_t         statusMsgTime;
 
     string              messageStr;
@@ -18,15 +18,18 @@
 
 #include <main/rack_data_module.h>
 #include <main/serial_port.h>
+#include <main/serial_framer.h>
 #include <drivers/clock_proxy.h>
 
 // define module class
 #define MODULE_CLASS_ID                     CLOCK
 
+#define CLOCK_SERIAL_MESSAGE_MAX            1024
+
 typedef struct
 {
     rack_time_t        recordingTime;
-    char               data[1024];
+    char               data[CLOCK_SERIAL_MESSAGE_MAX];
 } clock_serial_data;
 
 
@@ -48,6 +51,7 @@ class ClockDcf77EmcPro : public RackDataModule {
         rack_time_t         lastUpdateTime;
 
         SerialPort          serialPort;
+        SerialFramer        serialFramer;
 
         // additional mailboxes
         RackMailbox         workMbx;
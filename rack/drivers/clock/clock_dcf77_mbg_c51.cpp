@@ -56,6 +56,25 @@ struct rtser_config clock_serial_config = {
     event_mask        : RTSER_EVENT_RXPEND
 };
 
+// message from STX to ETX
+serial_frame_format clock_serial_format = {
+    sync              : { 0x02 },
+    syncMask          : { 0xFF },
+    syncLen           : 1,
+    lenOffset         : -1,
+    lenSize           : 0,
+    lenBigEndian      : 0,
+    lenScale          : 0,
+    lenAdd            : 0,
+    terminator        : 0x03,
+    frameLen          : 0,
+    maxLen            : CLOCK_SERIAL_MESSAGE_MAX,
+    maxSkip           : 200,
+    getLength         : NULL,
+    check             : NULL,
+    arg               : NULL
+};
+
 /*******************************************************************************
  *   !!! REALTIME CONTEXT !!!
  *
@@ -73,7 +92,7 @@ int ClockDcf77MbgC51::moduleOn(void)
     realtimeClockUpdate     = getInt32Param("realtimeClockUpdate");
     realtimeClockUpdateTime = getInt32Param("realtimeClockUpdateTime");
 
-    serialPort.clean();
+    serialFramer.clean();
 
     // set rx timeout 2 * periodTime
     serialPort.setRecvTimeout(rackTime.toNano(2 * dataBufferPeriodTime));
@@ -147,75 +166,26 @@ int ClockDcf77MbgC51::moduleCommand(RackMessage *msgInfo)
 
 int ClockDcf77MbgC51::readSerialMessage(clock_serial_data *serialData)
 {
-    int             i, ret;
-    int             msgSize;
-    unsigned char   currChar;
-    rack_time_t     recordingTime;
-
-    // init local variables
-    recordingTime   = 0;
-    currChar        = 0;
-    i               = 0;
-    msgSize         = sizeof(serialData->data);
-
-    // synchronize to message head, timeout after 200 attempts
-    while ((i < 200) && (currChar != 0x02))
+    uint8_t         *frame;
+    int             ret;
+
+    // recordingtime of the last character
+    ret = serialFramer.readFrame(&frame, NULL, &serialData->recordingTime);
+    if (ret < 0)
     {
-        // read next character
-        ret = serialPort.recv(&currChar, 1, &recordingTime);
-        if (ret)
+        if (ret == -ETIME)
         {
-            GDOS_ERROR("Can't read message head from serial device %i, code = %d\n",
-                       serialDev, ret);
-            return ret;
+            GDOS_ERROR("Can't synchronize on message head\n");
         }
-        i++;
-    }
-
-
-    // check for timeout
-    if (i >= 200)
-    {
-        GDOS_ERROR("Can't synchronize on message head\n");
-        return -ETIME;
-    }
-    // store first character
-    else
-    {
-        serialData->data[0]       = currChar;
-        i = 1;
-    }
-
-
-    // read serial message until currChar == "0x03",
-    // timout if msgSize is reached
-    while ((i < msgSize) && (currChar != 0x03))
-    {
-        // read next character
-        ret = serialPort.recv(&currChar, 1, &recordingTime);
-        if (ret)
+        else
         {
             GDOS_ERROR("Can't read data from serial device %i, code = %d\n",
                        serialDev, ret);
-            return ret;
         }
-
-        // store character
-        serialData->data[i] = currChar;
-        i++;
+        return ret;
     }
 
-    // if last read character != "0x03" an error occured
-    if (currChar != 0x03)
-    {
-        GDOS_ERROR("Can't read end of serial message\n");
-        return -EINVAL;
-    }
-    // store recordingtime of last character
-    else
-    {
-        serialData->recordingTime = recordingTime;
-    }
+    memcpy(serialData->data, frame, ret);
 
     return 0;
 }
@@ -341,6 +311,7 @@ int ClockDcf77MbgC51::analyseSerialMessage(clock_serial_data *serialData, clock_
 #define INIT_BIT_SERIALPORT_OPEN            1
 #define INIT_BIT_MBX_WORK                   2
 #define INIT_BIT_PROXY_POSITION             3
+#define INIT_BIT_SERIAL_FRAMER              4
 
 int ClockDcf77MbgC51::moduleInit(void)
 {
@@ -363,6 +334,14 @@ int ClockDcf77MbgC51::moduleInit(void)
     GDOS_DBG_INFO("serialDev %d has been opened \n", serialDev);
     initBits.setBit(INIT_BIT_SERIALPORT_OPEN);
 
+    ret = serialFramer.init(&serialPort, &clock_serial_format, 2 * CLOCK_SERIAL_MESSAGE_MAX);
+    if (ret)
+    {
+        GDOS_ERROR("Can't init serial framer, code=%d\n", ret);
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_SERIAL_FRAMER);
+
     //
     // create mailboxes
     //
@@ -397,6 +376,11 @@ void ClockDcf77MbgC51::moduleCleanup(void)
         destroyMbx(&workMbx);
     }
 
+    if (initBits.testAndClearBit(INIT_BIT_SERIAL_FRAMER))
+    {
+        serialFramer.cleanup();
+    }
+
     if (initBits.testAndClearBit(INIT_BIT_SERIALPORT_OPEN))
     {
         serialPort.close();
@@ -64,6 +64,25 @@ struct rtser_config serial_config = {
     event_mask        : RTSER_EVENT_RXPEND
 };
 
+// message from '$' to "Line Feed"
+serial_frame_format compass_serial_format = {
+    sync              : { '$' },
+    syncMask          : { 0xFF },
+    syncLen           : 1,
+    lenOffset         : -1,
+    lenSize           : 0,
+    lenBigEndian      : 0,
+    lenScale          : 0,
+    lenAdd            : 0,
+    terminator        : 10,
+    frameLen          : 0,
+    maxLen            : COMPASS_SERIAL_MESSAGE_MAX,
+    maxSkip           : 200,
+    getLength         : NULL,
+    check             : NULL,
+    arg               : NULL
+};
+
 /*******************************************************************************
  *   !!! REALTIME CONTEXT !!!
  *
@@ -80,7 +99,7 @@ int CompassCmps03::moduleOn(void)
     dataBufferPeriodTime    = getInt32Param("periodTime");
     compassOffset           = getInt32Param("compassOffset");
 
-    serialPort.clean();
+    serialFramer.clean();
 
     // set rx timeout 2 * periodTime
     serialPort.setRecvTimeout(rackTime.toNano(2 * dataBufferPeriodTime));
@@ -165,76 +184,26 @@ int CompassCmps03::moduleCommand(RackMessage *msgInfo)
 
 int CompassCmps03::readSerialMessage(compass_serial_data *serialData)
 {
-    int             i, ret;
-    int             msgSize;
-    unsigned char   currChar;
-    rack_time_t     recordingTime;
-
+    uint8_t         *frame;
+    int             ret;
 
-    // init local variables
-    recordingTime   = 0;
-    currChar        = 0;
-    i               = 0;
-    msgSize         = sizeof(serialData->data);
-
-    // synchronize to message head, timeout after 200 attempts
-    while ((i < 200) && (currChar != 36))
+    // recordingtime of the last character
+    ret = serialFramer.readFrame(&frame, NULL, &serialData->recordingTime);
+    if (ret < 0)
     {
-        // read next character
-        ret = serialPort.recv(&currChar, 1, &recordingTime);
-        if (ret)
+        if (ret == -ETIME)
         {
-            GDOS_ERROR("Can't read message head from serial device %i, code = %d\n",
-                       serialDev, ret);
-            return ret;
+            GDOS_ERROR("Can't synchronize on message head\n");
         }
-        i++;
-    }
-
-
-    // check for timeout
-    if (i >= 200)
-    {
-        GDOS_ERROR("Can't synchronize on message head\n");
-        return -ETIME;
-    }
-    // store first character
-    else
-    {
-        serialData->data[0] = currChar;
-        i = 1;
-    }
-
-
-    // read serial message until currChar == "0x03",
-    // timout if msgSize is reached
-    while ((i < msgSize) && (currChar != 10))
-    {
-        // read next character
-        ret = serialPort.recv(&currChar, 1, &recordingTime);
-        if (ret)
+        else
         {
             GDOS_ERROR("Can't read data from serial device %i, code = %d\n",
                        serialDev, ret);
-            return ret;
         }
-
-        // store character
-        serialData->data[i] = currChar;
-        i++;
+        return ret;
     }
 
-    // if last read character != "0x0a" an error occured
-    if (currChar != 10)
-    {
-        GDOS_ERROR("Can't read end of serial message\n");
-        return -EINVAL;
-    }
-    // store recordingtime of last character
-    else
-    {
-        serialData->recordingTime = recordingTime;
-    }
+    memcpy(serialData->data, frame, ret);
 
     return 0;
 }
@@ -363,6 +332,7 @@ int CompassCmps03::calibrateCompass()
 #define INIT_BIT_DATA_MODULE                0
 #define INIT_BIT_SERIALPORT_OPEN            1
 #define INIT_BIT_MBX_WORK                   2
+#define INIT_BIT_SERIAL_FRAMER              3
 
 int CompassCmps03::moduleInit(void)
 {
@@ -385,6 +355,14 @@ int CompassCmps03::moduleInit(void)
     GDOS_DBG_INFO("serialDev %d has been opened \n", serialDev);
     initBits.setBit(INIT_BIT_SERIALPORT_OPEN);
 
+    ret = serialFramer.init(&serialPort, &compass_serial_format, 2 * COMPASS_SERIAL_MESSAGE_MAX);
+    if (ret)
+    {
+        GDOS_ERROR("Can't init serial framer, code=%d\n", ret);
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_SERIAL_FRAMER);
+
     //
     // create mailboxes
     //
@@ -419,6 +397,11 @@ void CompassCmps03::moduleCleanup(void)
         destroyMbx(&workMbx);
     }
 
+    if (initBits.testAndClearBit(INIT_BIT_SERIAL_FRAMER))
+    {
+        serialFramer.cleanup();
+    }
+
     if (initBits.testAndClearBit(INIT_BIT_SERIALPORT_OPEN))
     {
         serialPort.close();
@@ -19,16 +19,19 @@
 #include <main/rack_data_module.h>
 #include <drivers/compass_proxy.h>
 #include <main/serial_port.h>
+#include <main/serial_framer.h>
 #include <main/angle_tool.h>
 
 
 // define module class
 #define MODULE_CLASS_ID                     COMPASS
 
+#define COMPASS_SERIAL_MESSAGE_MAX          1024
+
 typedef struct
 {
     rack_time_t        recordingTime;
-    char               data[1024];
+    char               data[COMPASS_SERIAL_MESSAGE_MAX];
 } compass_serial_data;
 
 
@@ -53,6 +56,7 @@ class CompassCmps03 : public RackDataModule {
               
 
         SerialPort          serialPort;
+        SerialFramer        serialFramer;
         compass_serial_data serialData;
 
         // additional mailboxes
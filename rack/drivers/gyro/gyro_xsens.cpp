@@ -46,6 +46,56 @@ struct rtser_config serialConfig = {
     event_mask        : RTSER_EVENT_RXPEND
 };
 
+// MT message: preamble, bus id, message id, length (0xFF: extended length),
+// data, checksum
+static int xsensGetLength(const uint8_t *data, int dataLen, void *arg)
+{
+    if (dataLen < 4)
+    {
+        return 0;
+    }
+    if (data[3] != 0xff)
+    {
+        return 4 + data[3] + 1;
+    }
+    if (dataLen < 6)
+    {
+        return 0;
+    }
+    return 6 + ((data[4] << 8) | data[5]) + 1;
+}
+
+// the sum of all bytes behind the preamble is 0
+static int xsensCheck(const uint8_t *frame, int frameLen, void *arg)
+{
+    uint8_t checksum = 0;
+    int     i;
+
+    for (i = 1; i < frameLen; i++)
+    {
+        checksum += frame[i];
+    }
+    return checksum ? -EINVAL : 0;
+}
+
+serial_frame_format xsensFormat = {
+    sync              : { GYRO_XSENS_MESSAGE_PREAMBLE },
+    syncMask          : { 0xFF },
+    syncLen           : 1,
+    lenOffset         : -1,
+    lenSize           : 0,
+    lenBigEndian      : 0,
+    lenScale          : 0,
+    lenAdd            : 0,
+    terminator        : -1,
+    frameLen          : 0,
+    maxLen            : GYRO_XSENS_MESSAGE_MAX,
+    maxSkip           : GYRO_XSENS_MESSAGE_MAX,
+    getLength         : xsensGetLength,
+    check             : xsensCheck,
+    arg               : NULL
+};
+
 /*******************************************************************************
  *   !!! REALTIME CONTEXT !!!
  *
@@ -61,7 +111,7 @@ int  GyroXsens::moduleOn(void)
     int            ret;
 
     // cleaning of serialport
-    ret = serialPort.clean();
+    ret = serialFramer.clean();
     if (ret)
     {
         GDOS_ERROR("Can't clean serial port, code = %d \n", ret);
@@ -127,101 +177,38 @@ int  GyroXsens::moduleCommand(RackMessage *msgInfo)
 }
 
 
+// the message data stays valid until the next call
 int  GyroXsens::readMessage(gyro_xsens_message *message, rack_time_t *recordingTime)
 {
-    int     i;
+    uint8_t *frame;
     int     ret;
-    int     messageSize;
-    uint8_t checksum;
-
-    // init variables
-    i                   = 0;
-    messageSize         = sizeof(gyro_xsens_message);
-    message->preamble   = 0;
-
-    // synchronize to preamble, timeout after 200 attempts
-    while ((i < messageSize) && (message->preamble != GYRO_XSENS_MESSAGE_PREAMBLE))
-    {
-        // wait for next event on serial port
-        ret = serialPort.recv(&message->preamble, 1, recordingTime);
-        if (ret)
-        {
-            GDOS_ERROR("Can't read message preamble on serial dev %i, code %d\n",
-                       serialDev, ret);
-            return ret;
-        }
-        i ++;
-    }
 
-    // check for timeout
-    if (i >= messageSize)
+    ret = serialFramer.readFrame(&frame, recordingTime, NULL);
+    if (ret == -ETIME)
     {
         GDOS_ERROR("Can't synchronize on message head\n");
-        return -ETIME;
-    }
-
-    // read message header
-    ret = serialPort.recv(&message->bid, 3);
-    if (ret)
-    {
-        GDOS_ERROR("Can't read message header on serial dev %i, code %d\n",
-                   serialDev, ret);
         return ret;
     }
-
-    // check if extended length message is given
-    if (message->len == 0xff)
-    {
-        message->len = 0;
-        ret = serialPort.recv(&message->extLen, 2);
-        if (ret)
-        {
-            GDOS_ERROR("Can't read extended length on serial dev %i, code %d\n",
-                       serialDev, ret);
-            return ret;
-        }
-    }
-    else
-    {
-        message->extLen = 0;
-    }
-
-    // read message data
-    ret = serialPort.recv(&message->data, (message->len + message->extLen));
-    if (ret)
-    {
-        GDOS_ERROR("Can't read message data on serial dev %i, code %d\n",
-                   serialDev, ret);
-        return ret;
-    }
-
-    // read message checksum
-    ret = serialPort.recv(&message->checksum, 1);
-    if (ret)
+    else if (ret < 0)
     {
-        GDOS_ERROR("Can't read message checksum on serial dev %i, code %d\n",
+        GDOS_ERROR("Can't read message on serial dev %i, code %d\n",
                    serialDev, ret);
         return ret;
     }
 
-    // calculate checksum
-    checksum  = 0;
-    checksum += message->bid;
-    checksum += message->mid;
-    checksum += message->len;
-    checksum += message->extLen;
+    message->bid = frame[1];
+    message->mid = frame[2];
 
-    for (i = 0; i < (message->len + message->extLen); i++)
+    // check if extended length message is given
+    if (frame[3] == 0xff)
     {
-        checksum += message->data[i];
+        message->len  = (frame[4] << 8) | frame[5];
+        message->data = &frame[6];
     }
-    checksum += message->checksum;
-
-    // valudate checksum
-    if (checksum != 0)
+    else
     {
-        GDOS_ERROR("Wrong checksum in message\n");
-        //return -EINVAL;
+        message->len  = frame[3];
+        message->data = &frame[4];
     }
 
     return 0;
@@ -232,6 +219,11 @@ int  GyroXsens::parseMTDataMessage(gyro_xsens_message *message, gyro_data *data)
     uint16_t sampleCount;
     float    magX, magY, magZ;
 
+    if (message->len < 50)
+    {
+        return -EINVAL;
+    }
+
     // read calibrated data output
     data->aX     = -getDataFloat(message->data, 0) * 1000.0f;
     data->aY     = -getDataFloat(message->data, 4) * 1000.0f;
@@ -299,6 +291,7 @@ float GyroXsens::getDataFloat(uint8_t *data, uint16_t offset)
 // init_flags
 #define INIT_BIT_DATA_MODULE            0
 #define INIT_BIT_SERIALPORT_OPEN        1
+#define INIT_BIT_SERIAL_FRAMER          2
 
 int  GyroXsens::moduleInit(void)
 {
@@ -321,6 +314,13 @@ int  GyroXsens::moduleInit(void)
     GDOS_DBG_INFO("serialDev %d has been opened \n", serialDev);
     initBits.setBit(INIT_BIT_SERIALPORT_OPEN);
 
+    ret = serialFramer.init(&serialPort, &xsensFormat, 2 * GYRO_XSENS_MESSAGE_MAX);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_SERIAL_FRAMER);
+
     return 0;
 
 init_error:
@@ -337,6 +337,11 @@ void GyroXsens::moduleCleanup(void)
         RackDataModule::moduleCleanup();
     }
 
+    if (initBits.testAndClearBit(INIT_BIT_SERIAL_FRAMER))
+    {
+        serialFramer.cleanup();
+    }
+
     // close serial port
     if (initBits.testAndClearBit(INIT_BIT_SERIALPORT_OPEN))
     {
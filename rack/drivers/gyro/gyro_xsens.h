@@ -20,6 +20,7 @@
 #include <main/rack_data_module.h>
 #include <main/angle_tool.h>
 #include <main/serial_port.h>
+#include <main/serial_framer.h>
 //#include "main/linux/serial_port_linux.cpp"
 #include <drivers/gyro_proxy.h>
 
@@ -30,16 +31,15 @@
 
 #define GYRO_XSENS_MESSAGE_MTDATA   0x32
 
+#define GYRO_XSENS_MESSAGE_MAX      (6 + 2048 + 1)
+
 
 typedef struct
 {
-    uint8_t         preamble;
     uint8_t         bid;
     uint8_t         mid;
-    uint8_t         len;
-    uint16_t        extLen;
-    uint8_t         data[2048];
-    uint8_t         checksum;
+    uint16_t        len;            // data bytes
+    uint8_t         *data;          // in the receive buffer of the framer
 } gyro_xsens_message;
 
 
@@ -56,6 +56,7 @@ class GyroXsens : public RackDataModule
 
         // global variables
         SerialPort          serialPort;
+        SerialFramer        serialFramer;
         gyro_xsens_message  gyroMessage;
 
         // own functions
@@ -43,6 +43,25 @@ arg_table_t argTab[] = {
 
 };
 
+// reply of the G-Command, the length depends on the requested points
+serial_frame_format urgFormat = {
+    sync              : { 'G' },
+    syncMask          : { 0xFF },
+    syncLen           : 1,
+    lenOffset         : -1,
+    lenSize           : 0,
+    lenBigEndian      : 0,
+    lenScale          : 0,
+    lenAdd            : 0,
+    terminator        : -1,
+    frameLen          : 0,
+    maxLen            : URG_FRAME_MAX,
+    maxSkip           : 2000,
+    getLength         : NULL,
+    check             : NULL,
+    arg               : NULL
+};
+
 /*******************************************************************************
  *   !!! REALTIME CONTEXT !!!
  *
@@ -111,7 +130,7 @@ int  LadarHokuyoUrg::moduleOn(void)
 
     RackTask::sleep(200000000); // 200 ms
 
-    ret = serialPort.clean();
+    ret = serialFramer.clean();
     if (ret)
     {
         GDOS_ERROR("Can't clean serial port\n", ret);
@@ -137,6 +156,7 @@ void LadarHokuyoUrg::moduleOff(void)
 int  LadarHokuyoUrg::moduleLoop(void)
 {
     ladar_data  *p_data;
+    uint8_t     *frame, *scan;
     int         serialDataLen;
     int         i, j, ret;
     float       angleResolution;
@@ -167,28 +187,6 @@ int  LadarHokuyoUrg::moduleLoop(void)
 
     // receive G-Command (Distance Data Acquisition)
 
-    // synchronize on message head, timeout after 200 attempts *****
-    i = 0;
-    serialBuffer[0] = 0;
-
-    while((i < 2000) && (serialBuffer[0] != 'G'))
-    {
-        // Read next character
-        ret = serialPort.recv(serialBuffer, 1, &(p_data->recordingTime));
-        if (ret)
-        {
-            GDOS_ERROR("Can't read data from serial dev, code=%d\n", ret);
-            return ret;
-        }
-        i++;
-    }
-
-    if(i == 2000)
-    {
-        GDOS_ERROR("Can't read data 2 from serial dev\n");
-        return -1;
-    }
-
     angleResolution         = (float)cluster * -0.3515625 * M_PI/180.0;
     p_data->pointNum        = (int32_t)((end - start)/cluster);     //max 681
     p_data->startAngle      = (float)startAngle * M_PI/180.0;
@@ -199,13 +197,23 @@ int  LadarHokuyoUrg::moduleLoop(void)
 
     serialDataLen = 15 + p_data->pointNum * 2 + p_data->pointNum / 32;
 
-    ret = serialPort.recv(serialBuffer, serialDataLen, NULL);
-    if (ret)
+    // synchronize on message head 'G', timeout after 2000 attempts
+    urgFormat.frameLen = 1 + serialDataLen;
+
+    ret = serialFramer.readFrame(&frame, &(p_data->recordingTime), NULL);
+    if (ret == -ETIME)
+    {
+        GDOS_ERROR("Can't read data 2 from serial dev\n");
+        return -1;
+    }
+    else if (ret < 0)
     {
-        GDOS_ERROR("Can't read data 3 from serial dev, code=%d\n",ret);
+        GDOS_ERROR("Can't read data from serial dev, code=%d\n", ret);
         return ret;
     }
 
+    scan = &frame[1];
+
     j = 10;
     for (i = 0; i < p_data->pointNum; i++)
     {
@@ -214,8 +222,8 @@ int  LadarHokuyoUrg::moduleLoop(void)
             j += 1;  // first j = 11
         }
 
-        p_data->point[i].distance = ((int32_t)(serialBuffer[j] - 0x30) << 6) |
-                                     (int32_t)(serialBuffer[j + 1] - 0x30);
+        p_data->point[i].distance = ((int32_t)(scan[j] - 0x30) << 6) |
+                                     (int32_t)(scan[j + 1] - 0x30);
 
         p_data->point[i].angle     = normaliseAngleSym0(p_data->startAngle + angleResolution * i);
         p_data->point[i].type      = LADAR_POINT_TYPE_UNKNOWN;
@@ -256,6 +264,7 @@ int  LadarHokuyoUrg::moduleCommand(RackMessage *msgInfo)
 // init_flags (for init and cleanup)
 #define INIT_BIT_DATA_MODULE                0
 #define INIT_BIT_SERIALPORT_OPEN            1
+#define INIT_BIT_SERIAL_FRAMER              2
 
 int  LadarHokuyoUrg::moduleInit(void)
 {
@@ -285,6 +294,14 @@ int  LadarHokuyoUrg::moduleInit(void)
     }*/
 
     initBits.setBit(INIT_BIT_SERIALPORT_OPEN);
+
+    ret = serialFramer.init(&serialPort, &urgFormat, 2 * URG_FRAME_MAX);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_SERIAL_FRAMER);
+
     return 0;
 
 init_error:
@@ -303,6 +320,11 @@ void LadarHokuyoUrg::moduleCleanup(void)
         RackDataModule::moduleCleanup();
     }
 
+    if (initBits.testAndClearBit(INIT_BIT_SERIAL_FRAMER))
+    {
+        serialFramer.cleanup();
+    }
+
     if (initBits.testAndClearBit(INIT_BIT_SERIALPORT_OPEN))
     {
         serialPort.close();
@@ -19,6 +19,7 @@
 
 #include <main/rack_data_module.h>
 #include <main/serial_port.h>
+#include <main/serial_framer.h>
 #include <main/angle_tool.h>
 
 #include <drivers/ladar_proxy.h>
@@ -50,6 +51,9 @@ static char sCommand19200[]  = {'S','0','1','9','2','0','0','5','5','5','5','5',
 static char sCommand115200[] = {'S','1','1','5','2','0','0','5','5','5','5','5','5','5',10};
 static unsigned char serialBuffer[2048];
 
+// 'G', G-Command echo and status, 681 points with a line feed every 32 points
+#define URG_FRAME_MAX           (1 + 15 + 681 * 2 + 681 / 32)
+
 
 
 /**
@@ -60,6 +64,7 @@ static unsigned char serialBuffer[2048];
 class LadarHokuyoUrg : public RackDataModule {
   private:
     SerialPort  serialPort;
+    SerialFramer serialFramer;
     int serialDev;
     int start;
     int end;
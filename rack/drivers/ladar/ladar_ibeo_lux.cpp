@@ -16,6 +16,7 @@
  */
 
 #include <iostream>
+#include <stddef.h>
 
 #include "ladar_ibeo_lux.h"
 
@@ -72,7 +73,6 @@ arg_table_t argTab[] = {
 int LadarIbeoLux::moduleOn(void)
 {
     int             ret;
-    struct timeval  recvTimeout;
 
     // read dynamic module parameter
     ladarIp           = getStringParam("ladarIp");
@@ -156,44 +156,14 @@ int LadarIbeoLux::moduleOn(void)
     RackTask::disableRealtimeMode();
 
 
-    // prepare tcp-socket
-    GDOS_DBG_INFO("open network socket...\n");
-    if ((tcpAddr.sin_addr.s_addr = inet_addr(ladarIp)) == INADDR_NONE)
-    {
-        GDOS_ERROR("Ip adress is not valid\n");
-        return -1;
-    }
-
-    tcpAddr.sin_port   = htons((unsigned short)ladarPort);
-    tcpAddr.sin_family = AF_INET;
-    bzero(&(tcpAddr.sin_zero), 8);
-
-    // open tcp-socket
-    tcpSocket = -1;
-    tcpSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (tcpSocket == -1)
-    {
-        GDOS_ERROR("Can't create tcp socket, (%d)\n", errno);
-        return -errno;
-    }
-
-    // set tcp-socket timeout
-    recvTimeout.tv_sec  = 0;
-    recvTimeout.tv_usec = 500000;   // 500ms
-    ret = setsockopt(tcpSocket, SOL_SOCKET, SO_RCVTIMEO, &recvTimeout, sizeof(struct timeval));
-    if (ret == -1)
-    {
-        GDOS_ERROR("Can't set timeout of tcp socket, (%d)\n", errno);
-        return -errno;
-    }
-
-    // connect
-    GDOS_DBG_INFO("Connect to network socket\n");
-    ret = connect(tcpSocket, (struct sockaddr *)&tcpAddr, sizeof(tcpAddr));
+    // connect to ladar, the messages start with the magic word
+    GDOS_DBG_INFO("Connect to ladar\n");
+    ret = netPort.open(ladarIp, ladarPort, NET_PORT_TCP, &netFraming,
+                       LADAR_IBEO_LUX_BUFFER_SIZE, LADAR_IBEO_LUX_CONNECT_TIMEOUT, this);
     if (ret)
     {
-        GDOS_ERROR("Can't connect to tcp socket, (%d)\n", errno);
-        return -errno;
+        GDOS_ERROR("Can't connect to ladar, code = %d\n", ret);
+        return ret;
     }
 
     GDOS_DBG_INFO("Turn on ladar\n");
@@ -239,15 +209,11 @@ void LadarIbeoLux::moduleOff(void)
         objRecogContour->off();
     }
 
-    // close tcp socket
+    // close connection
     RackTask::disableRealtimeMode();
-    if (tcpSocket != -1)
-    {
-        close(tcpSocket);
-        tcpSocket = -1;
-    }
+    netPort.close();
 
-    GDOS_DBG_INFO("Closed tcp socket\n");
+    GDOS_DBG_INFO("Closed connection to ladar\n");
     RackTask::enableRealtimeMode();
 }
 
@@ -305,13 +271,31 @@ int  LadarIbeoLux::moduleLoop(void)
 
     RackTask::disableRealtimeMode();
 
-    // read ladar header
-    ret = recvLadarHeader(&ladarHeader, &recordingTime);
+    // receive next ladar message, the port reconnects after errors
+    ret = netPort.recvFrame(&ladarFrame, LADAR_IBEO_LUX_RECV_TIMEOUT);
+
+    RackTask::enableRealtimeMode();
+
     if (ret)
     {
+        if (netPort.getState() != NET_PORT_CONNECTED)
+        {
+            GDOS_WARNING("Lost connection to ladar, code = %d, reconnecting\n",
+                         netPort.getError());
+            return 0;
+        }
+
+        GDOS_ERROR("Can't receive ladar message, code = %d\n", ret);
         return ret;
     }
 
+    // header behind the magic word, body behind the header
+    memcpy(&ladarHeader, ladarFrame.data + sizeof(uint32_t), sizeof(ladar_ibeo_lux_header));
+    parseLadarIbeoLuxHeader(&ladarHeader);
+
+    ladarData     = ladarFrame.data + sizeof(uint32_t) + sizeof(ladar_ibeo_lux_header);
+    recordingTime = ladarFrame.recordingTime;
+
     // calc current data rate
     dataRateCounter += ladarHeader.messageSize + 24;
     dT               = (int)recordingTime - (int)dataRateStartTime;
@@ -325,17 +309,12 @@ int  LadarIbeoLux::moduleLoop(void)
     GDOS_DBG_DETAIL("time %d, ladar dataType %x, messageSize %d, dataRate %d bytes/s\n",
                     recordingTime, ladarHeader.dataType, ladarHeader.messageSize, dataRate);
 
-    // read ladar data body
-    ret = recvLadarData(&ladarData, ladarHeader.messageSize);
-
-   RackTask::enableRealtimeMode();
-
     // parse ladar data body
     switch (ladarHeader.dataType)
     {
         // scan data
         case LADAR_IBEO_LUX_SCAN_DATA:
-            ladarScanData = (ladar_ibeo_lux_scan_data *)&ladarData;
+            ladarScanData = (ladar_ibeo_lux_scan_data *)ladarData;
 
             // calculate ladar timestamps (unit seconds)
             scanStartTime = (double)ladarScanData->scanStartTime.secondsFrac +
@@ -457,7 +436,7 @@ int  LadarIbeoLux::moduleLoop(void)
 
         // object data
         case LADAR_IBEO_LUX_OBJ_DATA:
-            ladarObjData = (ladar_ibeo_lux_obj_data *)&ladarData;
+            ladarObjData = (ladar_ibeo_lux_obj_data *)ladarData;
             l            = sizeof(ladar_ibeo_lux_obj_data);
 
             // calculate ladar timestamps (unit seconds)
@@ -677,141 +656,6 @@ int  LadarIbeoLux::moduleCommand(RackMessage *msgInfo)
 }
 
 
-int LadarIbeoLux::recvLadarHeader(ladar_ibeo_lux_header *data, rack_time_t *recordingTime)
-{
-    int             ret;
-    unsigned int    len, i;
-    uint32_t        retryNumMax = LADAR_IBEO_LUX_MESSAGE_SIZE_MAX;
-    uint32_t        magicWord = 0;
-    char            *magicWordBuf = (char *)&magicWord;
-
-    // synchronize to header by reading the magic word (4 bytes)
-    len = 0;
-    while (len < sizeof(magicWord))
-    {
-        ret = recv(tcpSocket, magicWordBuf + len, sizeof(magicWord) - len, 0);
-        if (ret == -1)          // error
-        {
-            if (errno == EAGAIN)
-            {
-                GDOS_ERROR("Timeout on receiving ladar header, (%d)\n", errno);
-            }
-            else
-            {
-                GDOS_ERROR("Can't receive header magic word, (%d)\n", errno);
-            }
-            return -errno;
-        }
-        if (ret == 0)           // socket closed
-        {
-            GDOS_ERROR("Tcp socket closed\n");
-            return -1;
-        }
-        len += ret;
-    }
-
-    for (i = 0; i < retryNumMax; i++)
-    {
-        // search for magic word
-        if (magicWord == LADAR_IBEO_LUX_MAGIC_WORD)
-        {
-            *recordingTime = rackTime.get();
-            break;
-        }
-        magicWordBuf[0] = magicWordBuf[1];
-        magicWordBuf[1] = magicWordBuf[2];
-        magicWordBuf[2] = magicWordBuf[3];
-        ret = recv(tcpSocket, magicWordBuf + 3, 1, 0);
-        if (ret == -1)          // error
-        {
-            if (errno == EAGAIN)
-            {
-                GDOS_ERROR("Timeout on receiving ladar header, (%d)\n", errno);
-            }
-            else
-            {
-                GDOS_ERROR("Can't receive header magic word, (%d)\n", errno);
-            }
-            return -errno;
-        }
-        if (ret == 0)           // socket closed
-        {
-            GDOS_ERROR("Tcp socket closed\n");
-            return -1;
-        }
-    }
-
-    // synchronization timeout
-    if (i == retryNumMax)
-    {
-        GDOS_ERROR("Can't synchronize to ladar header, timeout after %d attempts\n", i);
-        return -ETIMEDOUT;
-    }
-
-    // receive header data
-    len = 0;
-    while (len < sizeof(ladar_ibeo_lux_header))
-    {
-        ret = recv(tcpSocket, (char*)data + len, sizeof(ladar_ibeo_lux_header) - len, 0);
-        if (ret == -1)              // error
-        {
-            if (errno == EAGAIN)
-            {
-                GDOS_ERROR("Timeout on receiving ladar header, (%d)\n", errno);
-            }
-            else
-            {
-                GDOS_ERROR("Can't receive ladar header, (%d)\n", errno);
-            }
-            return -errno;
-        }
-        if (ret == 0)               // socket closed
-        {
-            GDOS_ERROR("Tcp socket closed\n");
-            return -1;
-        }
-        len += ret;
-    }
-
-    // adjust byte order
-    parseLadarIbeoLuxHeader(data);
-
-    return 0;
-}
-
-int LadarIbeoLux::recvLadarData(void *data, unsigned int messageSize)
-{
-    int          ret;
-    unsigned int len;
-
-    // receive ladar data
-    len = 0;
-    while (len < messageSize)
-    {
-        ret = recv(tcpSocket, (char*)data + len, messageSize - len, 0);
-        if (ret == -1)              // error
-        {
-            if (errno == EAGAIN)
-            {
-                GDOS_ERROR("Timeout on receiving ladar data, (%d)\n", errno);
-            }
-            else
-            {
-                GDOS_ERROR("Can't receive ladar data, (%d)\n", errno);
-            }
-            return -errno;
-        }
-        if (ret == 0)               // socket closed
-        {
-            GDOS_ERROR("Tcp socket closed\n");
-            return -1;
-        }
-        len += ret;
-    }
-
-    return 0;
-}
-
 /*****************************************************************************
  *   !!! NON REALTIME CONTEXT !!!
  *
@@ -963,6 +807,20 @@ LadarIbeoLux::LadarIbeoLux()
 
     objRecogBoundMbxAdr = RackName::create(objRecogBoundSys, OBJ_RECOG, objRecogBoundInst);
 
+    // message: magic word, header with the big endian body size, body
+    memset(&netFraming, 0, sizeof(netFraming));
+    netFraming.type            = NET_PORT_FRAME_LENGTH;
+    netFraming.start[0]        = 0xaf;
+    netFraming.start[1]        = 0xfe;
+    netFraming.start[2]        = 0xc0;
+    netFraming.start[3]        = 0xc2;
+    netFraming.startLen        = 4;
+    netFraming.lengthOffset    = sizeof(uint32_t) + offsetof(ladar_ibeo_lux_header, messageSize);
+    netFraming.lengthSize      = 4;
+    netFraming.lengthBigEndian = 1;
+    netFraming.lengthAdd       = sizeof(uint32_t) + sizeof(ladar_ibeo_lux_header);
+    netFraming.frameMax        = netFraming.lengthAdd + LADAR_IBEO_LUX_MESSAGE_SIZE_MAX;
+
     dataBufferMaxDataSize   = sizeof(ladar_data_msg);
     dataBufferPeriodTime    = 80; // 80 ms (12.5 per sec)
 }
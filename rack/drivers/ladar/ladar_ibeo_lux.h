@@ -18,9 +18,7 @@
 #define __LADAR_IBEO_LUX_H__
 
 #include <main/rack_data_module.h>
-#include <netinet/in.h>
-#include <sys/socket.h>
-#include <arpa/inet.h>
+#include <main/net_port.h>
 
 #include <drivers/ladar_proxy.h>
 #include <navigation/position_proxy.h>
@@ -31,6 +29,9 @@
 
 #define LADAR_IBEO_LUX_CMD_MAX              100
 #define LADAR_IBEO_LUX_MESSAGE_SIZE_MAX     51000
+#define LADAR_IBEO_LUX_BUFFER_SIZE          (4 * LADAR_IBEO_LUX_MESSAGE_SIZE_MAX)
+#define LADAR_IBEO_LUX_CONNECT_TIMEOUT      2000000000ll    // 2s
+#define LADAR_IBEO_LUX_RECV_TIMEOUT          500000000ll    // 500ms
 
 #define LADAR_IBEO_LUX_SCAN_POINT_MAX       10000
 #define LADAR_IBEO_LUX_LAYER_MAX            4
@@ -223,8 +224,9 @@ class LadarIbeoLux : public RackDataModule {
         int                         distanceFilter;
         int                         velocityMode;
 
-        int                         tcpSocket;
-        struct sockaddr_in          tcpAddr;
+        NetPort                     netPort;
+        net_port_framing            netFraming;
+        net_port_frame              ladarFrame;
 
         double                      fracFactor;
         int                         dataRate;
@@ -232,7 +234,7 @@ class LadarIbeoLux : public RackDataModule {
         rack_time_t                 dataRateStartTime;
 
         ladar_ibeo_lux_header       ladarHeader;
-        uint8_t                     ladarData[LADAR_IBEO_LUX_MESSAGE_SIZE_MAX];
+        uint8_t                     *ladarData;         // message body in the NetPort buffer
 
         ladar_ibeo_lux_command      ladarCommand;
         ladar_ibeo_lux_command      ladarCommandReply;
@@ -271,9 +273,6 @@ class LadarIbeoLux : public RackDataModule {
         // -> non realtime context
         void moduleCleanup(void);
 
-        int  recvLadarHeader(ladar_ibeo_lux_header *data, rack_time_t *recordingTime);
-        int  recvLadarData(void *data, unsigned int messageSize);
-
     public:
 
         // constructor und destructor
@@ -15,8 +15,6 @@
  *
  */
 
-#include <iostream>
-
 #include "ladar_sick_lms100.h"
 
 //
@@ -61,28 +59,14 @@ int  LadarSickLms100::moduleOn(void)
     lmsPort            = getInt32Param("lmsPort");
     reflectorRemission = getInt32Param("reflectorRemission");
 
-    //preparing tcp Socket
-    inet_pton(AF_INET, lmsIp, &(tcpAddr.sin_addr));
-    tcpAddr.sin_port   = htons((unsigned short)lmsPort);
-    tcpAddr.sin_family = AF_INET;
-    bzero(&(tcpAddr.sin_zero), 8);
-
-    //openning tcp Socket
-    GDOS_DBG_INFO("open network socket...\n");
-    tcpSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (tcpSocket == -1)
-    {
-        GDOS_ERROR("Can't create tcp Socket, (%d)\n",errno);
-        return -errno;
-    }
-
-    //connect to tcp Socket
-    GDOS_DBG_INFO("Connect to network socket\n");
-    ret = connect(tcpSocket, (struct sockaddr *)&tcpAddr, sizeof(tcpAddr));
-    if(ret)
+    // connect to the ladar, telegrams are framed by STX and ETX
+    GDOS_DBG_INFO("Connect to ladar\n");
+    ret = netPort.open(lmsIp, lmsPort, NET_PORT_TCP, &netFraming,
+                       4 * LADAR_LMS100_TELEGRAM_MAX, LADAR_LMS100_CONNECT_TIMEOUT, this);
+    if (ret)
     {
-       GDOS_ERROR("Can't connect to tcp Socket, (%d)\n",errno);
-       return errno;
+       GDOS_ERROR("Can't connect to ladar, code = %d\n", ret);
+       return ret;
     }
     GDOS_DBG_INFO("Turn on ladar\n");
     RackTask::enableRealtimeMode();
@@ -94,206 +78,100 @@ void LadarSickLms100::moduleOff(void)
 {
     RackDataModule::moduleOff();         // has to be first command in moduleOff();
 
-    // closing tcp Socket
+    // close connection
     RackTask::disableRealtimeMode();
-
-    if(tcpSocket !=-1)
-    {
-        close(tcpSocket);
-        tcpSocket = -1;
-    }
+    netPort.close();
     RackTask::enableRealtimeMode();
 }
 
 int  LadarSickLms100::moduleLoop(void)
 {
-    ladar_data    *pData = NULL;
-    uint32_t      datalength;
-    int           len;
-    int           ret=0;
-    int           n=0;
-    int           i=0;
-    int           j=0;
-    char          tmpbuff[10];
-    char          buff[1460];
-    rack_time_t   scanTime;
+    ladar_data      *pData = NULL;
+    uint32_t        datalength;
+    net_port_frame  frame;
+    int             ret;
+    int             i, n, c, d, r;
+    int             startAngle, angleStep, remission;
 
     // get datapointer from rackDataBuffer
     pData = (ladar_data*)getDataBufferWorkSpace();
 
     RackTask::disableRealtimeMode();
 
-    memset(buff, '\0', sizeof(buff));
-    memset(&(ladarHeader),0, sizeof(ladarHeader));
-
-
-    ret = send(tcpSocket,START_MEAS,strlen(START_MEAS),0);
+    // request one scan, older telegrams are dropped
+    netPort.clean();
 
-    scanTime = rackTime.get();
-    if (ret < 0)
+    ret = netPort.send(START_MEAS, strlen(START_MEAS));
+    if (!ret)
     {
-        GDOS_ERROR("Error receiving data, (%d)",errno);
-        return -errno;
+        ret = netPort.recvFrame(&frame, LADAR_LMS100_RECV_TIMEOUT);
     }
 
-    //EXTRACTING FIRST PART OF HEADER (ALWAYS CONSTANT AMOUNT OF BYTES)
-    ret=recv(tcpSocket,&ladarHeader, 32*sizeof(char),0);
-    if (ret < 1)
-    {
-        ret= recvfail(ret,errno);
-        return ret;
-    }
-
-
-    //EXTRACTING THE NON CONSTANT COUNTERS
-    ret = extractHeader( ladarHeader.messagecounter, tcpSocket);
-    if (ret < 1)
-    {
-        ret= recvfail(ret,errno);
-        return ret;
-    }
-    ladarHeader.white8 = ' ';
-
-    ret = extractHeader( ladarHeader.scancounter, tcpSocket);
-    if (ret < 1)
-    {
-        ret= recvfail(ret,errno);
-        return ret;
-    }
-    ladarHeader.white9 = ' ';
-
-    ret = extractHeader( ladarHeader.powerupduration, tcpSocket);
-    if (ret < 1)
-    {
-        ret= recvfail(ret,errno);
-        return ret;
-    }
-    ladarHeader.white10 = ' ';
-
-    ret = extractHeader( ladarHeader.transduration, tcpSocket);
-    if (ret < 1)
-    {
-        ret= recvfail(ret,errno);
-        return ret;
-    }
-    ladarHeader.white11 = ' ';
+    RackTask::enableRealtimeMode();
 
-    //EXTRACTING THE REST OF THE CONSTANT PART OF HEADER
-    ret = recv(tcpSocket,&(ladarHeader.inputstatus), 10*sizeof(char),0);
-    if (ret < 1)
-    {
-        ret= recvfail(ret,errno);
-        return ret;
-    }
-    ret = extractHeader( ladarHeader.scanfreq, tcpSocket);
-    if (ret < 1)
+    if (ret)
     {
-        ret= recvfail(ret,errno);
-        return ret;
-    }
-    ladarHeader.white16 = ' ';
+        if (netPort.getState() != NET_PORT_CONNECTED)
+        {
+            GDOS_WARNING("Lost connection to ladar, code = %d, reconnecting\n",
+                         netPort.getError());
+            return 0;
+        }
 
-    ret = recv(tcpSocket,&(ladarHeader.measfreq), 41*sizeof(char),0);
-    if (ret < 1)
-    {
-        ret= recvfail(ret,errno);
+        GDOS_ERROR("Can't receive scan telegram, code = %d\n", ret);
         return ret;
     }
 
-    ret = extractHeader( ladarHeader.angstep, tcpSocket);
-    if (ret < 1)
-    {
-        ret= recvfail(ret,errno);
-        return ret;
-    }
-    ladarHeader.white23 = ' ';
+    // split the telegram without STX and ETX into its fields
+    splitTelegram((char *)frame.data + 1, frame.len - 2);
 
-    ret = recv(tcpSocket,&(ladarHeader.numdata), 4*sizeof(char),0);
-    if (ret < 1)
+    c = findToken("LMDscandata", 0);
+    d = findToken("DIST1", 0);
+    if ((c < 0) || (c + 15 >= tokenNum) || (d < 0) || (d + 5 >= tokenNum))
     {
-        ret= recvfail(ret,errno);
-        return ret;
+        GDOS_WARNING("Received unexpected telegram of %d bytes\n", frame.len);
+        return 0;
     }
 
-    memcpy(tmpbuff, &(ladarHeader.numdata),3);
-    n=hextodec(tmpbuff,3);
-    //EXTRACTING DATA POINTS
-
-
-    for (i=0; i < n; i++)
+    n = hextodec(token[d + 5], tokenLen[d + 5]);
+    if ((n > LADAR_DATA_MAX_POINT_NUM) || (d + 6 + n > tokenNum))
     {
-        do
-        {
-            len= recv(tcpSocket,&(tmpbuff[j]),1*sizeof(char), 0);
-            if (ret < 1)
-            {
-                ret= recvfail(ret,errno);
-                return ret;
-            }
-            j++;
-        }
-        while (tmpbuff[j-1] != ' ');
-        j--;
-        ladarHeader.dataPoints[i]= hextodec(tmpbuff,j );
-        j=0;
+        GDOS_ERROR("Invalid number of scan points %d\n", n);
+        return -EINVAL;
     }
 
-    ret = recv(tcpSocket, buff, sizeof(char), 0);
-
-    if (buff[0] == 'R')
+    // remission channel is optional
+    r = findToken("RSSI1", d + 6 + n);
+    if ((r >= 0) && (r + 6 + n > tokenNum))
     {
-        //Extracting Remission header (no important data)
-        ret = recv(tcpSocket, buff, 43*sizeof(char), 0);
-
-        //Extracting remission values for the points
-
-        for (i=0; i < n; i++)
-        {
-            do
-            {
-                len= recv(tcpSocket,&(tmpbuff[j]),1*sizeof(char), 0);
-                if (ret < 1)
-                {
-                    ret= recvfail(ret,errno);
-                    return ret;
-                }
-                j++;
-            }
-            while (tmpbuff[j-1] != ' ');
-            j--;
-            ladarHeader.dataRemission[i]= hextodec(tmpbuff,j );
-            j=0;
-        }
+        r = -1;
     }
-    //FlUSHING REST OF DATA PACKAGE IN BUFER
-    ret = recv(tcpSocket, buff, sizeof(buff), 0);
 
-    if (n == 1082)
-    {
-        j=3;
-    }
-    else
-    {
-        j=4;
-    }
-    RackTask::enableRealtimeMode();
+    startAngle = hextodec(token[d + 3], tokenLen[d + 3]);
+    angleStep  = hextodec(token[d + 4], tokenLen[d + 4]);
 
      // create ladar data message
-     pData->recordingTime = scanTime;
-     pData->duration      = hextodec(ladarHeader.measfreq,3)*1000;
+     pData->recordingTime = frame.recordingTime;
+     pData->duration      = hextodec(token[c + 15], tokenLen[c + 15]) * 1000;
      pData->maxRange      = LADAR_MAX_RANGE;
-     pData->startAngle    = M_PI * (hextodec(ladarHeader.startangle,8)-900000)/ 1800000;
-     pData->endAngle      = M_PI * hextodec(ladarHeader.angstep,j) * n / 1800000;
+     pData->startAngle    = M_PI * (startAngle - 900000) / 1800000;
+     pData->endAngle      = M_PI * angleStep * n / 1800000;
      pData->pointNum      = n;
 
      for (i = 0; i < n; i++)
      {
-        pData->point[i].angle    = pData->startAngle + (i * M_PI * hextodec(ladarHeader.angstep,j)/ 1800000);
-        pData->point[i].distance = ladarHeader.dataPoints[n-i];
+        pData->point[i].angle    = pData->startAngle + (i * M_PI * angleStep / 1800000);
+        pData->point[i].distance = hextodec(token[d + 5 + n - i], tokenLen[d + 5 + n - i]);
+
+        remission = 0;
+        if (r >= 0)
+        {
+            remission = hextodec(token[r + 5 + n - i], tokenLen[r + 5 + n - i]);
+        }
 
         pData->point[i].type = 0;
 
-        if (ladarHeader.dataRemission[n-i] < reflectorRemission)
+        if (remission < reflectorRemission)
         {
             pData->point[i].type |= LADAR_POINT_TYPE_UNKNOWN;
         }
@@ -301,7 +179,7 @@ int  LadarSickLms100::moduleLoop(void)
         {
             pData->point[i].type |= LADAR_POINT_TYPE_REFLECTOR;
         }
-        pData->point[i].intensity = ladarHeader.dataRemission[n-i];
+        pData->point[i].intensity = remission;
 
         // classify scan points that are too close to the ladar as invalid
         if (pData->point[i].distance <= 30)
@@ -319,21 +197,6 @@ int  LadarSickLms100::moduleLoop(void)
     return 0;
 }
 
-
-int LadarSickLms100::recvfail (int ret, int error)
-{
-    if (ret==-1)
-    {
-        GDOS_ERROR("Error receiving data, (%d)",errno);
-    }
-    else if (ret==0)
-    {
-        GDOS_ERROR("Session closed");
-    }
-    return -1;
-}
-
-
 int  LadarSickLms100::moduleCommand(RackMessage *msgInfo)
 {
     switch (msgInfo->getType())
@@ -345,29 +208,46 @@ int  LadarSickLms100::moduleCommand(RackMessage *msgInfo)
     return 0;
 }
 
-int LadarSickLms100::extractHeader(char *header, int Socket )
+int LadarSickLms100::splitTelegram(char *telegram, int len)
 {
+    int i;
 
-    int i=0;
-    int a;
-    char j;
+    tokenNum = 0;
 
-    do
+    for (i = 0; i < len; i++)
     {
-        a=recv(Socket,(void *) &j, sizeof(char),0);
-        if (a < 0)
+        if (telegram[i] == ' ')
         {
-            a = recvfail (a,errno);
-            return -1;
+            continue;
         }
-        if ( j != ' ')
+        if (tokenNum == LADAR_LMS100_TOKEN_MAX)
+        {
+            break;
+        }
+
+        token[tokenNum] = telegram + i;
+        while ((i < len) && (telegram[i] != ' '))
         {
-            header[i]=j;
             i++;
         }
+        tokenLen[tokenNum] = telegram + i - token[tokenNum];
+        tokenNum++;
     }
-    while (j != ' ');
-    return i;
+    return tokenNum;
+}
+
+int LadarSickLms100::findToken(const char *name, int first)
+{
+    int i, len = strlen(name);
+
+    for (i = first; i < tokenNum; i++)
+    {
+        if ((tokenLen[i] == len) && (strncmp(token[i], name, len) == 0))
+        {
+            return i;
+        }
+    }
+    return -1;
 }
 
 int LadarSickLms100::hextodec (char tmpbuff[], int n)
@@ -454,6 +334,15 @@ LadarSickLms100::LadarSickLms100()
 {
     dataBufferMaxDataSize   = sizeof(ladar_data_msg);
     dataBufferPeriodTime    = 20; // 20 ms (50 per sec)
+
+    // telegrams start with STX and end with ETX
+    memset(&netFraming, 0, sizeof(netFraming));
+    netFraming.type     = NET_PORT_FRAME_DELIMITER;
+    netFraming.start[0] = 0x02;
+    netFraming.startLen = 1;
+    netFraming.end[0]   = 0x03;
+    netFraming.endLen   = 1;
+    netFraming.frameMax = LADAR_LMS100_TELEGRAM_MAX;
 }
 
 int  main(int argc, char *argv[])
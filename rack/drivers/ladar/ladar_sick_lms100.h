@@ -19,9 +19,7 @@
 #include <main/rack_data_module.h>
 #include <drivers/ladar_proxy.h>
 
-#include <netinet/in.h>
-#include <sys/socket.h>
-#include <arpa/inet.h>
+#include <main/net_port.h>
 
 // define module class
 #define MODULE_CLASS_ID     LADAR
@@ -29,66 +27,17 @@
 #define START_MEAS                          "\02sRN LMDscandata\03"
 #define LADAR_MAX_RANGE                      20000
 
+#define LADAR_LMS100_TELEGRAM_MAX            16384
+#define LADAR_LMS100_TOKEN_MAX               (2 * 1082 + 64)
+#define LADAR_LMS100_CONNECT_TIMEOUT         2000000000ll   // 2s
+#define LADAR_LMS100_RECV_TIMEOUT             500000000ll   // 500ms
+
 typedef struct
 {
     ladar_data          data;
     ladar_point         point[LADAR_DATA_MAX_POINT_NUM];
 } __attribute__((packed)) ladar_data_msg;
 
-typedef struct
-{
-    char                 answer[4];
-    char                 white1;
-    char                 command[11];
-    char                 white2;
-    char                 versioninfo;
-    char                 white3;
-    char                 deviceid;
-    char                 white4;
-    char                 factoryserialnum[6];
-    char                 white5;
-    char                 status;
-    char                 white6;
-    char                 status2;
-    char                 white7;
-    char                 messagecounter[4];
-    char                 white8;
-    char                 scancounter[4];
-    char                 white9;
-    char                 powerupduration[8];
-    char                 white10;
-    char                 transduration[8];
-    char                 white11;
-    char                 inputstatus;
-    char                 white12;
-    char                 noidea;
-    char                 white13;
-    char                 outputstatus;
-    char                 white14;
-    char                 noidea2[3];
-    char                 white15;
-    char                 scanfreq[4];
-    char                 white16;
-    char                 measfreq[3];
-    char                 white17;
-    char                 noidea3[3];
-    char                 white18;
-    char                 measdatacontent[5];
-    char                 white19;
-    char                 scalingfactor[8];
-    char                 white20;
-    char                 scalingoffset[8];
-    char                 white21;
-    char                 startangle[8];
-    char                 white22;
-    char                 angstep[4];
-    char                 white23;
-    char                 numdata[3];
-    char                 white24;
-    int                  dataPoints[1082];
-    int                  dataRemission[1082];
-}__attribute__((packed)) ladar_lms100_header;
-
 //######################################################################
 //# class NewRackDataModule
 //######################################################################
@@ -96,9 +45,11 @@ typedef struct
 class LadarSickLms100 : public RackDataModule {
     private:
 
-        int                  tcpSocket;
-        struct               sockaddr_in tcpAddr;
-        ladar_lms100_header  ladarHeader;
+        NetPort              netPort;
+        net_port_framing     netFraming;
+        char                 *token[LADAR_LMS100_TOKEN_MAX];
+        int                  tokenLen[LADAR_LMS100_TOKEN_MAX];
+        int                  tokenNum;
         char                 *lmsIp;
         int                  lmsPort;
         int                  reflectorRemission;
@@ -114,9 +65,9 @@ class LadarSickLms100 : public RackDataModule {
         // -> non realtime context
         void moduleCleanup(void);
 
-        int extractHeader(char *, int );
+        int splitTelegram(char *telegram, int len);
+        int findToken(const char *name, int first);
         int hextodec(char tmpbuff[], int n);
-        int recvfail(int , int );
 
     public:
 
@@ -73,7 +73,27 @@ typedef struct {
     ladar_point   point[LADAR_DATA_MAX_POINT_NUM];
 } __attribute__((packed)) ladar_data_msg;
 
-static unsigned char serialBuffer[4 * 1024];
+#define SICK_S_FRAME_MAX  (4 * 1024)
+
+// continuous data telegram: 4 zero bytes, 0x0000, size in words (big endian),
+// 0xFF, EFI device (set in moduleInit()), ..., CRC
+serial_frame_format sickSFormat = {
+    sync              : { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x07 },
+    syncMask          : { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0xFF, 0xFF },
+    syncLen           : 10,
+    lenOffset         : 6,
+    lenSize           : 2,
+    lenBigEndian      : 1,
+    lenScale          : 2,
+    lenAdd            : 4,
+    terminator        : -1,
+    frameLen          : 0,
+    maxLen            : SICK_S_FRAME_MAX,
+    maxSkip           : 4 * 1024,
+    getLength         : NULL,
+    check             : LadarSickS::frameCheck,
+    arg               : NULL
+};
 
 static unsigned short crcTable[256] = {
     0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
@@ -125,7 +145,7 @@ int  LadarSickS::moduleOn(void)
 {
     int ret;
 
-    ret = serialPort.clean();
+    ret = serialFramer.clean();
     if (ret)
     {
         GDOS_ERROR("Can't clean serial port,code=%d\n", ret);
@@ -161,10 +181,10 @@ void LadarSickS::moduleOff(void)
 int  LadarSickS::moduleLoop(void)
 {
     ladar_data *p_data;
+    uint8_t     *serialBuffer;
     rack_time_t time;
     int         ret;
     int         i;
-    int         totalCount = 0;
     int         size;
     int         distance;
     float       angleResolution;
@@ -172,69 +192,21 @@ int  LadarSickS::moduleLoop(void)
     // get datapointer from databuffer
     p_data = (ladar_data *)getDataBufferWorkSpace();
 
-    for(i = 0; i < 10; i++)
+    ret = serialFramer.readFrame(&serialBuffer, &time, NULL);
+    if (ret == -ETIME)
     {
-        ret = serialPort.recv(&serialBuffer[i], 1, &time);
-        if (ret)
-        {
-            GDOS_ERROR("Can't read from serial dev %i\n", serialDev);
-            return ret;
-        }
-        if(totalCount > 4 * 1024)
-        {
-            GDOS_ERROR("Cant synchronise on package head\n");
-            return EAGAIN;
-        }
-
-        switch(i)
-        {
-        case 0:
-            p_data->recordingTime = time;
-        case 1:
-        case 2:
-        case 3:
-        case 4:
-        case 5:
-            if(serialBuffer[i] != 0x00)
-                i = -1;
-            break;
-        case 6:
-        case 7:
-            break;
-        case 8:
-            if(serialBuffer[i] != 0xff)
-                i = -1;
-            break;
-        case 9:
-            if (EFIdev == 0) // EFI master
-            {
-              if(serialBuffer[i] != 0x07)
-                i = -1;
-            }
-            else // EFI slave
-            {
-              if(serialBuffer[i] != 0x08)
-                i = -1;
-            }
-            break;
-        }
-        totalCount++;
+        GDOS_ERROR("Cant synchronise on package head\n");
+        return EAGAIN;
     }
-
-    size = MKSHORT(serialBuffer[7], serialBuffer[6]);
-
-    ret = serialPort.recv(&serialBuffer[i], (size-3)*2);
-    if (ret)
+    else if (ret < 0)
     {
-        GDOS_ERROR("Can't read data body from serial dev %i\n", serialDev);
+        GDOS_ERROR("Can't read from serial dev %i\n", serialDev);
         return ret;
     }
 
-    if(crc_check((unsigned char*)&serialBuffer[4], (size-1)*2) != MKSHORT(serialBuffer[size*2+2], serialBuffer[size*2+3]))
-    {
-        GDOS_ERROR("CRC check wrong\n");
-        return -1;
-    }
+    p_data->recordingTime = time;
+
+    size = MKSHORT(serialBuffer[7], serialBuffer[6]);
 
     switch(devNumber)
     {
@@ -305,7 +277,18 @@ int  LadarSickS::moduleCommand(RackMessage *msgInfo)
   return RackDataModule::moduleCommand(msgInfo);
 }
 
-unsigned short LadarSickS::crc_check(unsigned char* data, int len)
+int LadarSickS::frameCheck(const uint8_t *frame, int frameLen, void *arg)
+{
+    int size = MKSHORT(frame[7], frame[6]);
+
+    if (crc_check(&frame[4], (size-1)*2) != MKSHORT(frame[size*2+2], frame[size*2+3]))
+    {
+        return -EINVAL;
+    }
+    return 0;
+}
+
+unsigned short LadarSickS::crc_check(const unsigned char* data, int len)
 {
     unsigned short crc16 = 0xFFFF;
     int i;
@@ -331,6 +314,7 @@ unsigned short LadarSickS::crc_check(unsigned char* data, int len)
 // init_flags
 #define INIT_BIT_DATA_MODULE            0
 #define INIT_BIT_RTSERIAL_OPENED        1
+#define INIT_BIT_SERIAL_FRAMER          2
 
 int  LadarSickS::moduleInit(void)
 {
@@ -362,6 +346,17 @@ int  LadarSickS::moduleInit(void)
         GDOS_ERROR("Can't set baudrate to %i Baud, code = %d\n",baudrate, ret);
         goto init_error;
     }
+
+    // EFI master or slave
+    sickSFormat.sync[9] = (EFIdev == 0) ? 0x07 : 0x08;
+
+    ret = serialFramer.init(&serialPort, &sickSFormat, 2 * SICK_S_FRAME_MAX);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_SERIAL_FRAMER);
+
     return 0;
 
 init_error:
@@ -378,6 +373,11 @@ void LadarSickS::moduleCleanup(void)
         RackDataModule::moduleCleanup();
     }
 
+    if (initBits.testAndClearBit(INIT_BIT_SERIAL_FRAMER))
+    {
+        serialFramer.cleanup();
+    }
+
     // close rtserial port
     if (initBits.testAndClearBit(INIT_BIT_RTSERIAL_OPENED))
     {
@@ -19,6 +19,7 @@
 
 #include <main/rack_data_module.h>
 #include <main/serial_port.h>
+#include <main/serial_framer.h>
 #include <main/angle_tool.h>
 
 #include <drivers/ladar_proxy.h>
@@ -36,13 +37,17 @@ class LadarSickS : public RackDataModule {
     private:
 
         SerialPort  serialPort;
+        SerialFramer serialFramer;
         int devNumber;
         int EFIdev;
         int serialDev;
         int baudrate;
         double scanningAngle;
 
-        unsigned short crc_check(unsigned char* data, int len);
+        static unsigned short crc_check(const unsigned char* data, int len);
+
+    public:
+        static int frameCheck(const uint8_t *frame, int frameLen, void *arg);
 
     protected:
         // -> realtime context
@@ -46,6 +46,8 @@ class LadarSim : public RackDataModule {
         char         *dxfMapFile;
         int          angleRes;
         int          mapScaleFactor;
+        double       beamAngle[LADAR_DATA_MAX_POINT_NUM];
+        double       beamDistance[LADAR_DATA_MAX_POINT_NUM];
         float        angleMin;
         float        angleMax;
 
@@ -31,6 +31,7 @@ public abstract class RackProxy
     public static final byte MSG_GET_NEXT_DATA = 8;
     public static final byte MSG_GET_PARAM = 9;
     public static final byte MSG_SET_PARAM = 10;
+    public static final byte MSG_GET_MULTI_DATA = 11;
 
     // global returns (negative)
     public static final byte MSG_OK = Tims.MSG_OK;
@@ -42,6 +43,7 @@ public abstract class RackProxy
     public static final byte MSG_DATA = -6;
     public static final byte MSG_CONT_DATA = -7;
     public static final byte MSG_PARAM = -9;
+    public static final byte MSG_MULTI_DATA = -10;
 
     public static final byte MSG_POS_OFFSET = 20;
     public static final byte MSG_NEG_OFFSET = -20;
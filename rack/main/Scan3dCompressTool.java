@@ -26,12 +26,17 @@ public class Scan3dCompressTool {
     public final int COMPR_S1_REDUCE_BYTES_222110 = 0x00000003;
     public final int COMPR_S1_REDUCE_BYTES_RESORT = 0x00000004;
     public final int COMPR_S1_DELTA_RLE           = 0x00000005;
+    public final int COMPR_S1_RANGE_PRED          = 0x00000006;
     public final int COMPR_S1_REMOVE_INVALID      = 0x01000000;
     public final int SCAN_POINT_TYPE_INVALID      = 0x00000010;
+    public final int RANS_SCALE_BITS              = 12;
+    public final int RANS_SCALE                   = 1 << RANS_SCALE_BITS;
+    public final int RANS_L                       = 1 << 23;
 
     CompressTool decompressor = new CompressTool();
     MinMax       minMax       = new MinMax();      //----- statistics on input data
     ScanPoint[]  output;
+    boolean      rangePredError;                 //----- set by range_pred_getVarint()
 
     public Scan3dCompressTool() {
     }
@@ -90,6 +95,12 @@ public class Scan3dCompressTool {
     case COMPR_S1_DELTA_RLE:
         uncompr_step1_delta_rle(inStream1, nP);
         break;
+    case COMPR_S1_RANGE_PRED:
+        if (uncompr_step1_range_pred(inStream1, nPoints, lenIn) == 0) {
+            System.out.println("Error: corrupt range prediction data\n");
+            return -1;
+        }
+        break;
     case COMPR_S1_NONE:
         for (int i=0; i<lenOut/ScanPoint.getDataLen(); i++) {
             output[i].x         =        decompressor.compr_readByteStream(inStream1, 4);
@@ -282,6 +293,154 @@ public class Scan3dCompressTool {
         return n * ScanPoint.getDataLen();
     }
 
+    //----- Expand data that was compressed with compr_step1_range_pred(), size is the length of the
+    //----- step 1 data. Returns 0 if a block is corrupt or doesn't fit into size bytes
+    int uncompr_step1_range_pred(CompressTool.Compr_bitStream in, int nPoints, int size) {
+        int width, blockLines, blockPoints, first, n, rawLen, codedLen, end;
+
+        if ((size > in.data.length) || (size - in.aByte < 12) || (nPoints > output.length)) return 0;
+        width      = decompressor.compr_readByteStream(in, 4);
+        blockLines = decompressor.compr_readByteStream(in, 4);
+        decompressor.compr_readByteStream(in, 4);    //----- number of blocks
+        if ((width <= 0) || (blockLines <= 0) || (blockLines > output.length / width)) return 0;
+        blockPoints = width * blockLines;
+
+        CompressTool.Compr_bitStream raw = decompressor.new Compr_bitStream();
+        for (first = 0; first < nPoints; first += blockPoints) {
+            n = Math.min(nPoints - first, blockPoints);
+            if (size - in.aByte < 8) return 0;
+            rawLen   = decompressor.compr_readByteStream(in, 4);
+            codedLen = decompressor.compr_readByteStream(in, 4);
+            if (codedLen == 0) {
+                if ((rawLen < 0) || (rawLen > size - in.aByte)) return 0;
+                end = in.aByte + rawLen;
+                if (uncompr_step1_range_pred_block(in, end, first, n, width) == 0) return 0;
+            } else {
+                //----- a point has at most 26 varint bytes
+                if ((codedLen < 0) || (codedLen > size - in.aByte) ||
+                    (rawLen < 0) || (rawLen > n * 26)) return 0;
+                if ((raw.data == null) || (raw.data.length < rawLen)) raw.data = new byte[rawLen];
+                end = in.aByte + codedLen;
+                if (uncompr_step1_rans(in, end, raw.data, rawLen) == 0) return 0;
+                in.aByte  = end;
+                raw.aByte = 0;
+                raw.aBit  = 0;
+                if (uncompr_step1_range_pred_block(raw, rawLen, first, n, width) == 0) return 0;
+            }
+        }
+        return nPoints * ScanPoint.getDataLen();
+    }
+
+    //----- Reverses compr_step1_range_pred_block() with the bytes up to end,
+    //----- returns n or 0 if they are corrupt
+    int uncompr_step1_range_pred_block(CompressTool.Compr_bitStream in, int end, int first, int n, int width) {
+        int[] a = new int[n];
+        int f, k, col, pred;
+
+        rangePredError = false;
+        //----- x, y and z
+        for (f = 0; f < 3; f++) {
+            col = 0;
+            for (k = 0; k < n; k++) {
+                if (k >= width) {
+                    pred = a[k - width];
+                    if (col > 0) pred = range_pred_med(a[k - 1], pred, a[k - width - 1]);
+                } else pred = (k > 0) ? a[k - 1] : 0;
+                a[k] = pred + range_pred_unzigzag(range_pred_getVarint(in, end));
+                if (++col == width) col = 0;
+            }
+            for (k = 0; k < n; k++) {
+                if (f == 0)      output[first + k].x = a[k];
+                else if (f == 1) output[first + k].y = a[k];
+                else             output[first + k].z = a[k];
+            }
+        }
+        //----- type, segment and intensity
+        pred = 0;
+        for (k = 0; k < n; k++) {
+            pred += range_pred_unzigzag(range_pred_getVarint(in, end));
+            output[first + k].type = pred;
+        }
+        pred = 0;
+        for (k = 0; k < n; k++) {
+            pred += range_pred_unzigzag(range_pred_getVarint(in, end));
+            output[first + k].segment = (short)pred;
+        }
+        pred = 0;
+        for (k = 0; k < n; k++) {
+            pred += range_pred_unzigzag(range_pred_getVarint(in, end));
+            output[first + k].intensity = (short)pred;
+        }
+        return (rangePredError || (in.aByte != end)) ? 0 : n;
+    }
+
+    //----- Expand data that was coded with compr_step1_rans() from the bytes up to end to size bytes.
+    //----- Returns 0 if the frequency table is corrupt or the coded bytes don't fit
+    int uncompr_step1_rans(CompressTool.Compr_bitStream in, int end, byte[] out, int size) {
+        int[]  freq    = new int[256];
+        int[]  cum     = new int[257];
+        byte[] cum2sym = new byte[RANS_SCALE];
+        int    i, j, s, slot, sum;
+        int    symNum;
+
+        if (end - in.aByte < 2) return 0;
+        symNum = decompressor.compr_readByteStream(in, 2);
+        if ((symNum == 0) || (symNum > 256) || (end - in.aByte < symNum * 3 + 4)) return 0;
+
+        sum = 0;
+        for (i = 0; i < symNum; i++) {
+            s = decompressor.compr_readByteStream(in, 1);
+            if (freq[s] != 0) return 0;
+            freq[s] = decompressor.compr_readByteStream(in, 2);
+            if (freq[s] == 0) return 0;
+            sum += freq[s];
+        }
+        if (sum != RANS_SCALE) return 0;
+        for (s = 0; s < 256; s++) {
+            cum[s + 1] = cum[s] + freq[s];
+            for (j = cum[s]; j < cum[s + 1]; j++) cum2sym[j] = (byte)s;
+        }
+
+        //----- the state is stored little endian, an unsigned 32 bit value is kept in a long
+        long state = Integer.reverseBytes(decompressor.compr_readByteStream(in, 4)) & 0xFFFFFFFFL;
+        for (i = 0; i < size; i++) {
+            slot   = (int)(state & (RANS_SCALE - 1));
+            s      = cum2sym[slot] & 0xFF;
+            out[i] = (byte)s;
+            state  = (freq[s] * (state >>> RANS_SCALE_BITS) + slot - cum[s]) & 0xFFFFFFFFL;
+            while (state < RANS_L) {
+                if (in.aByte >= end) return 0;
+                state = (state << 8) | decompressor.compr_readByteStream(in, 1);
+            }
+        }
+        return size;
+    }
+
+    static int range_pred_med(int a, int b, int c) {
+        int mx = Math.max(a, b);
+        int mn = Math.min(a, b);
+        if (c >= mx) return mn;
+        if (c <= mn) return mx;
+        return a + b - c;
+    }
+
+    //----- reads one varint before end, sets rangePredError if it is truncated or longer than 5 bytes
+    int range_pred_getVarint(CompressTool.Compr_bitStream in, int end) {
+        int v = 0, b, sh = 0;
+        while ((in.aByte < end) && (sh < 35)) {
+            b   = decompressor.compr_readByteStream(in, 1);
+            v  |= (b & 0x7F) << sh;
+            sh += 7;
+            if ((b & 0x80) == 0) return v;
+        }
+        rangePredError = true;
+        return 0;
+    }
+
+    static int range_pred_unzigzag(int z) {
+        return (z >>> 1) ^ -(z & 1);
+    }
+
     //----- Expand data that was compressed with compr_step1_remove_invalid()
     //----- Invalid points are filled with zeros, and SCAN_POINT_TYPE_INVALID in the type-field
     int uncompr_step1_remove_invalid(int nIn, int nOut) {
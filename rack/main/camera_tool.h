@@ -22,7 +22,22 @@
 #include <math.h>
 #include <string.h>
 
+// demosaic methods of convertCharBayer2RGB()
+#define CAMERA_TOOL_DEMOSAIC_BILINEAR   0
+#define CAMERA_TOOL_DEMOSAIC_EDGE       1
+
+// instruction sets of the conversion functions
+#define CAMERA_TOOL_SIMD_NONE           0
+#define CAMERA_TOOL_SIMD_SSE2           1
+#define CAMERA_TOOL_SIMD_AVX2           2
+
+#define CAMERA_TOOL_THREAD_MAX          16
+
 /**
+ * The color conversion and demosaic functions use SSE2 or AVX2 if the cpu
+ * supports it (see setSimd()). The last parameter splits the image rows
+ * into blocks that are converted by additional threads. Threads are plain
+ * pthreads, so only use more than one thread outside of realtime tasks.
  *
  * @ingroup main_tools
  */
@@ -34,18 +49,36 @@ class CameraTool {
 
     int32_t         colorLookuptableThermalRed12[4096];
 
+    uint8_t         toneLookuptable12[4096];
+    int             toneBlackLevel;
+    int             toneWhiteLevel;
+    float           toneGamma;
+
   public:
 
     CameraTool();
     CameraTool(RackMailbox *p_mbx, int gdos_level);
     void initColorTables();
 
+    static int setSimd(int simd);
+    static int getSimd(void);
+
     static inline int clip(int in);
-    static int convertCharUYVY2RGB(uint8_t* outputData, uint8_t* inputData, int width, int height);
-    static int convertCharUYVY2BGR(uint8_t* outputData, uint8_t* inputData, int width, int height);
-    static int convertCharUYVY2Gray(uint8_t* outputData, uint8_t* inputData, int width, int height);
-    static int convertCharBGR2RGB(uint8_t* outputData, uint8_t* inputData, int width, int height);
-    static int convertCharRGB2MONO8(uint8_t* outputData, uint8_t* inputData,int width, int height);
+    static int convertCharUYVY2RGB(uint8_t* outputData, uint8_t* inputData, int width, int height,
+                                   int threads = 1);
+    static int convertCharUYVY2BGR(uint8_t* outputData, uint8_t* inputData, int width, int height,
+                                   int threads = 1);
+    static int convertCharUYVY2Gray(uint8_t* outputData, uint8_t* inputData, int width, int height,
+                                    int threads = 1);
+    static int convertCharBGR2RGB(uint8_t* outputData, uint8_t* inputData, int width, int height,
+                                  int threads = 1);
+    static int convertCharRGB2MONO8(uint8_t* outputData, uint8_t* inputData,int width, int height,
+                                    int threads = 1);
+    static int convertCharBayer2RGB(uint8_t* outputData, uint8_t* inputData, int width, int height,
+                                    int colorFilterId, int method = CAMERA_TOOL_DEMOSAIC_BILINEAR,
+                                    int threads = 1);
+    int convertCharMono122Mono8(uint8_t* outputData, uint8_t* inputData, int width, int height,
+                                int blackLevel, int whiteLevel, float gamma, int threads = 1);
     int convertCharMono82RGBThermalRed(uint8_t* outputData, uint8_t* inputData, int width, int height);
     int convertCharMono122RGBThermalRed(uint8_t* outputData, uint8_t* inputData, int width, int height);
     
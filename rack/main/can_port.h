@@ -20,6 +20,7 @@
 
 #include <main/rack_time.h>
 #include <main/rack_module.h>
+#include <main/port_capture.h>
 
 #if defined (__XENO__) || defined (__KERNEL__)
 
@@ -40,6 +41,9 @@ typedef struct can_filter can_filter_t;
  * This is the CAN Port interface of RACK provided to application programs
  * in userspace.
  *
+ * The linux implementation records or replays the received frames with
+ * PortCapture, the port name of the capture is "can<dev>".
+ *
  * @ingroup main_device_driver
  */
 class CanPort
@@ -50,9 +54,12 @@ class CanPort
 
         int fd;
         RackModule *module;
+        int64_t rxTimeout;
 
     public:
 
+        PortCapture capture;
+
         CanPort();
         ~CanPort();
 
@@ -46,6 +46,7 @@ RackDataModule::RackDataModule( uint32_t class_id,                // class ID
 {
     dataBufferMaxEntries    = maxDataBufferEntries;
     dataBufferMaxListener   = maxDataBufferListener;
+    dataBufferMaxReduction  = 16;
     dataBufferSendMbx       = 0;
 
     dataBufferMaxDataSize   = 0;
@@ -116,6 +117,9 @@ int         RackDataModule::addListener(rack_time_t periodTime, uint32_t getNext
         listenerNum++;
     }
 
+    listener[idx].overflowCount = RackMailbox::getDestOverflowCount(destMbxAdr);
+    listener[idx].lostCount     = 0;
+
     if(getNextData)
     {
         listener[idx].reduction     = 1;
@@ -145,6 +149,29 @@ int         RackDataModule::addListener(rack_time_t periodTime, uint32_t getNext
     return 0;
 }
 
+// realtime context (dataTask)
+uint32_t    RackDataModule::dataBufferOverflow(uint32_t destMbxAdr, uint32_t reduction)
+{
+    uint32_t newReduction;
+
+    if (reduction >= dataBufferMaxReduction)
+    {
+        return reduction;
+    }
+
+    newReduction = reduction * 2;
+    if (newReduction > dataBufferMaxReduction)
+    {
+        newReduction = dataBufferMaxReduction;
+    }
+
+    GDOS_WARNING("Listener %n (datambx: %x) is too slow, period %d ms -> %d ms\n",
+                 destMbxAdr, destMbxAdr, reduction * dataBufferPeriodTime,
+                 newReduction * dataBufferPeriodTime);
+
+    return newReduction;
+}
+
 // realtime context (cmdTask)
 void        RackDataModule::removeListener(uint32_t destMbxAdr)
 {
@@ -201,6 +228,20 @@ rack_time_t   RackDataModule::getListenerPeriodTime(uint32_t dataMbx)
     return 0;
 }
 
+// realtime context (cmdTask)
+int         RackDataModule::getDataBufferOldestIndex(void)
+{
+    if ((index == globalDataCount) &&
+        (globalDataCount < (dataBufferMaxEntries -1)))
+    {
+        return 1; // in slot 1 are the oldest data
+    }
+    else
+    {
+        return (index+2) % dataBufferMaxEntries;
+    }
+}
+
 // realtime context (cmdTask)
 int         RackDataModule::getDataBufferIndex(rack_time_t time)
 {
@@ -230,16 +271,7 @@ int         RackDataModule::getDataBufferIndex(rack_time_t time)
     {
         // globalDataCount > 0
 
-        if ((index == globalDataCount) &&
-            (globalDataCount < (dataBufferMaxEntries -1)))
-        {
-            old_index = 1; // in slot 1 are the oldest data
-        }
-        else
-        {
-            old_index = (index+2) % dataBufferMaxEntries;
-        }
-
+        old_index   = getDataBufferOldestIndex();
         old_rectime = getRecordingTime(dataBuffer[old_index].pData);
 
         if (time > ( new_rectime + 2 * dataBufferPeriodTime))
@@ -325,6 +357,96 @@ int         RackDataModule::sendDataReply(rack_time_t time, RackMessage *msgInfo
     return ret;
 }
 
+// realtime context (cmdTask)
+int         RackDataModule::sendMultiDataReply(rack_get_multi_data *p_get,
+                                               RackMessage *msgInfo)
+{
+    rack_multi_data_table   reply;
+    struct iovec            iov[1 + 2 * RACK_MULTI_DATA_TIME_MAX];
+    rack_time_t             time, rectime;
+    uint32_t                msglen, maxlen;
+    int                     entry[2];
+    int                     i, j, n, ret;
+
+    if (!p_get || !msgInfo || (p_get->timeNum <= 0) ||
+        (p_get->timeNum > RACK_MULTI_DATA_TIME_MAX) ||
+        ((p_get->mode != RACK_MULTI_DATA_NEAREST) &&
+         (p_get->mode != RACK_MULTI_DATA_INTERPOL)))
+    {
+        return -EINVAL;
+    }
+
+    n = (p_get->mode == RACK_MULTI_DATA_INTERPOL) ? 2 : 1;
+    reply.entryNum = 0;
+
+    // the reply has to fit the buffer of the receiver and the TIMS router
+    maxlen = p_get->maxDatalen;
+    if (maxlen > RACK_MULTI_DATA_MSG_MAX)
+    {
+        maxlen = RACK_MULTI_DATA_MSG_MAX;
+    }
+    msglen = sizeof(rack_multi_data) + p_get->timeNum * n * sizeof(uint32_t);
+
+    bufferMtx.lock(RACK_INFINITE);
+
+    for (i = 0; i < p_get->timeNum; i++)
+    {
+        time = p_get->recordingTime[i];
+
+        ret = getDataBufferIndex(time);
+        if (ret < 0)
+        {
+            bufferMtx.unlock();
+            return ret;
+        }
+        entry[0] = ret;
+        entry[1] = ret;
+
+        // the entries around the time, both are the same at the ends
+        rectime = getRecordingTime(dataBuffer[ret].pData);
+        if ((n == 2) && time && (rectime < time) && (ret != (int)index))
+        {
+            entry[1] = (ret + 1) % dataBufferMaxEntries;
+        }
+        else if ((n == 2) && time && (rectime > time) &&
+                 (ret != getDataBufferOldestIndex()))
+        {
+            entry[0] = (ret + dataBufferMaxEntries - 1) % dataBufferMaxEntries;
+        }
+
+        for (j = 0; j < n; j++)
+        {
+            reply.entrySize[reply.entryNum]  = dataBuffer[entry[j]].dataSize;
+            iov[1 + reply.entryNum].iov_base = dataBuffer[entry[j]].pData;
+            iov[1 + reply.entryNum].iov_len  = dataBuffer[entry[j]].dataSize;
+            msglen += dataBuffer[entry[j]].dataSize;
+            reply.entryNum++;
+        }
+    }
+
+    if (msglen > maxlen)
+    {
+        GDOS_ERROR("DataBuffer: Multi data msg of %u bytes exceeds %u bytes\n",
+                   msglen, maxlen);
+        bufferMtx.unlock();
+        return -EMSGSIZE;
+    }
+
+    iov[0].iov_base = &reply;
+    iov[0].iov_len  = sizeof(rack_multi_data) + reply.entryNum * sizeof(uint32_t);
+
+    // the entries are sent straight from the data buffer
+    ret = dataBufferSendMbx->sendIovMsgReply(MSG_MULTI_DATA, msgInfo, iov,
+                                             1 + reply.entryNum);
+    if (ret)
+    {
+        GDOS_ERROR("DataBuffer: Can't send multi data msg (code %d)\n", ret);
+    }
+
+    bufferMtx.unlock();
+    return ret;
+}
+
 //
 // public RackDataModule functions
 //
@@ -338,7 +460,8 @@ void*       RackDataModule::getDataBufferWorkSpace(void)
 // realtime context (dataTask)
 void        RackDataModule::putDataBufferWorkSpace(uint32_t datalength)
 {
-    uint32_t        i;
+    uint32_t        i, overflowCount;
+    int             overflow;
     int             ret;
 
     if ((datalength < 0) || (datalength > dataBufferMaxDataSize))
@@ -364,6 +487,14 @@ void        RackDataModule::putDataBufferWorkSpace(uint32_t datalength)
 
     dataBuffer[index].dataSize = datalength;
 
+#ifdef __RACK_TRACE__
+    if (RackTrace::isEnabled())
+    {
+        RackTrace::put(dataBufferSendMbx->getAdr(),
+                       getRecordingTime(dataBuffer[index].pData));
+    }
+#endif
+
     for (i=0; i<listenerNum; i++)
     {
         if ((globalDataCount % listener[i].reduction) == 0)
@@ -378,7 +509,38 @@ void        RackDataModule::putDataBufferWorkSpace(uint32_t datalength)
                                                       1,
                                                       dataBuffer[index].pData,
                                                       dataBuffer[index].dataSize);
-            if (ret)
+
+            // backpressure of a slow listener, its in-process mailbox
+            // overflowed or its TIMS mailbox had no free slot
+            overflow      = 0;
+            overflowCount = RackMailbox::getDestOverflowCount(listener[i].msgInfo.getSrc());
+            if (overflowCount != listener[i].overflowCount)
+            {
+                listener[i].overflowCount = overflowCount;
+                overflow = 1;
+            }
+            if ((ret == -ENOSPC) || (ret == -ETIMEDOUT))
+            {
+                listener[i].lostCount++;
+                overflow = 1;
+            }
+
+            if (overflow && !listener[i].getNextData)
+            {
+                listener[i].reduction = dataBufferOverflow(listener[i].msgInfo.getSrc(),
+                                                           listener[i].reduction);
+                if (!listener[i].reduction)
+                {
+                    removeListener(listener[i].msgInfo.getSrc());
+                    continue;
+                }
+            }
+
+            if ((ret == -ENOSPC) || (ret == -ETIMEDOUT))
+            {
+                // the data is lost, the listener stays
+            }
+            else if (ret)
             {
                 GDOS_ERROR("DataBuffer: Can't send continuous data "
                            "to listener %n, code = %d\n",
@@ -399,6 +561,11 @@ void        RackDataModule::putDataBufferWorkSpace(uint32_t datalength)
 
     listenerMtx.unlock();
     bufferMtx.unlock();
+
+#ifdef __RACK_TRACE__
+    // the next data has a new cause
+    RackTrace::end();
+#endif
 }
 
 void        RackDataModule::sleepDataBufferPeriodTime(void)
@@ -658,6 +825,26 @@ int         RackDataModule::moduleCommand(RackMessage *msgInfo)
             return 0;
         }
 
+        case MSG_GET_MULTI_DATA:
+        {
+            rack_get_multi_data *p_data = RackGetMultiData::parse(msgInfo);
+
+            if ((status != MODULE_STATE_ENABLED) ||
+                (msgInfo->datalen < sizeof(rack_get_multi_data)) ||
+                (msgInfo->datalen < RackGetMultiData::getDatalen(p_data->timeNum)) ||
+                sendMultiDataReply(p_data, msgInfo))
+            {
+                ret = cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+                if (ret)
+                {
+                    GDOS_ERROR("CmdTask: Can't send error reply, "
+                               "code = %d\n", ret);
+                    return ret;
+                }
+            }
+            return 0;
+        }
+
         case MSG_GET_CONT_DATA:
         {
             rack_get_cont_data *p_data = RackGetContData::parse(msgInfo);
@@ -0,0 +1,118 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#include <main/rack_host.h>
+#include <main/rack_module.h>
+#include <main/rack_mailbox.h>
+
+#include <pthread.h>
+
+static int              hosted = 0;
+static RackModule       *runningModule = NULL;
+static pthread_mutex_t  hostMtx  = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   hostCond = PTHREAD_COND_INITIALIZER;
+
+// default values of module_argTab, argScan() only writes given arguments
+static arg_table_t      *defaultArgTab = NULL;
+static int              defaultArgNum  = 0;
+
+void RackHost::enable(int localDelivery)
+{
+    int i;
+
+    if (!defaultArgTab)
+    {
+        while (module_argTab[defaultArgNum].name != "")
+        {
+            defaultArgNum++;
+        }
+
+        defaultArgTab = new arg_table_t[defaultArgNum];
+        for (i = 0; i < defaultArgNum; i++)
+        {
+            defaultArgTab[i] = module_argTab[i];
+        }
+    }
+
+    RackMailbox::setLocalDelivery(localDelivery);
+    hosted = 1;
+}
+
+int RackHost::isEnabled(void)
+{
+    return hosted;
+}
+
+void RackHost::resetArgs(void)
+{
+    int i;
+
+    for (i = 0; i < defaultArgNum; i++)
+    {
+        module_argTab[i] = defaultArgTab[i];
+    }
+}
+
+void RackHost::moduleRun(RackModule *p_mod)
+{
+    pthread_mutex_lock(&hostMtx);
+
+    runningModule = p_mod;
+    pthread_cond_broadcast(&hostCond);
+
+    while (!p_mod->isTerminated())
+    {
+        pthread_cond_wait(&hostCond, &hostMtx);
+    }
+
+    pthread_mutex_unlock(&hostMtx);
+}
+
+RackModule* RackHost::waitRunning(volatile int *p_exited)
+{
+    RackModule *p_mod;
+
+    pthread_mutex_lock(&hostMtx);
+
+    while (!runningModule && !*p_exited)
+    {
+        pthread_cond_wait(&hostCond, &hostMtx);
+    }
+
+    p_mod         = runningModule;
+    runningModule = NULL;
+
+    pthread_mutex_unlock(&hostMtx);
+
+    return p_mod;
+}
+
+void RackHost::moduleExited(volatile int *p_exited)
+{
+    pthread_mutex_lock(&hostMtx);
+
+    *p_exited = 1;
+    pthread_cond_broadcast(&hostCond);
+
+    pthread_mutex_unlock(&hostMtx);
+}
+
+void RackHost::moduleStop(RackModule *p_mod)
+{
+    pthread_mutex_lock(&hostMtx);
+
+    p_mod->moduleTerminate();
+    pthread_cond_broadcast(&hostCond);
+
+    pthread_mutex_unlock(&hostMtx);
+}
@@ -18,13 +18,862 @@
 #include <main/rack_mailbox.h>
 
 #include <stdarg.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <sys/uio.h>
 
+#ifndef __XENO__
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <main/rack_sim_clock.h>
+#endif
+
 // init bits
 #define     INIT_BIT_TIMS_MBX_CREATED       0
 
+//
+// in-process delivery
+//
+
+#ifndef __XENO__
+
+#define LOCAL_HASH_SIZE                     256
+
+typedef struct rack_mbx_buf
+{
+    struct rack_mbx_buf *next;
+    uint64_t            size;               // 64 bit keeps the message data aligned
+    tims_msg_head       head;
+} rack_mbx_buf;
+
+struct rack_mbx_local
+{
+    uint32_t                addr;
+    int                     efd;            // readable while messages are queued
+    pthread_mutex_t         mtx;
+    rack_mbx_buf            *first;
+    rack_mbx_buf            *last;
+    rack_mbx_buf            *free;          // pool of message slots
+    uint32_t                slotSize;
+    rack_mbx_buf            *peekBuf;       // message handed out by peek()
+    int                     queued;         // messages in the queue
+    int                     maxQueued;      // message slots
+    int                     policy;         // RACK_MBX_OVERFLOW_*
+    int64_t                 timeout_ns;     // of RACK_MBX_OVERFLOW_BLOCK
+    int                     waiting;        // senders that wait for a slot
+    pthread_cond_t          cond;           // a queued message was taken
+    uint32_t                overflowCount;
+    struct rack_mbx_local   *hashNext;
+};
+
+static int                      localDelivery = 0;
+static struct rack_mbx_local    *localHash[LOCAL_HASH_SIZE];
+static pthread_rwlock_t         localHashLock = PTHREAD_RWLOCK_INITIALIZER;
+
+static inline unsigned int localHashIndex(uint32_t address)
+{
+    return (address ^ (address >> 8) ^ (address >> 16) ^ (address >> 24)) &
+           (LOCAL_HASH_SIZE - 1);
+}
+
+static uint64_t localGetMonoNano(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000llu + ts.tv_nsec;
+}
+
+// takes a slot of the pool, messages that don't fit into a slot get an own buffer
+static rack_mbx_buf* localBufAlloc(struct rack_mbx_local *p_local, uint32_t msglen)
+{
+    rack_mbx_buf *p_buf = NULL;
+
+    if (msglen <= p_local->slotSize)
+    {
+        pthread_mutex_lock(&p_local->mtx);
+        p_buf = p_local->free;
+        if (p_buf)
+        {
+            p_local->free = p_buf->next;
+        }
+        pthread_mutex_unlock(&p_local->mtx);
+
+        if (p_buf)
+        {
+            return p_buf;
+        }
+        msglen = p_local->slotSize;
+    }
+
+    p_buf = (rack_mbx_buf *)malloc(sizeof(rack_mbx_buf) + msglen - TIMS_HEADLEN);
+    if (p_buf)
+    {
+        p_buf->size = msglen;
+    }
+    return p_buf;
+}
+
+// p_local->mtx has to be locked
+static void localBufFree(struct rack_mbx_local *p_local, rack_mbx_buf *p_buf)
+{
+    if (p_buf->size == p_local->slotSize)
+    {
+        p_buf->next   = p_local->free;
+        p_local->free = p_buf;
+    }
+    else
+    {
+        free(p_buf);
+    }
+}
+
+// p_local->mtx has to be locked
+static void localTaken(struct rack_mbx_local *p_local)
+{
+    p_local->queued--;
+    if (p_local->waiting)
+    {
+        pthread_cond_signal(&p_local->cond);
+    }
+}
+
+/*
+ * Makes room for a new message according to the overflow policy of the
+ * mailbox. Returns 0 if the message can be queued, otherwise -ENOSPC or
+ * -ETIMEDOUT.
+ */
+static int localReserve(struct rack_mbx_local *p_local)
+{
+    rack_mbx_buf    *p_buf;
+    struct timespec ts;
+    uint64_t        deadline;
+    int             ret = 0;
+
+    pthread_mutex_lock(&p_local->mtx);
+
+    if ((p_local->policy != RACK_MBX_OVERFLOW_GROW) &&
+        (p_local->queued >= p_local->maxQueued))
+    {
+        p_local->overflowCount++;
+
+        switch (p_local->policy)
+        {
+            case RACK_MBX_OVERFLOW_DROP_OLDEST:
+                // reserved messages of other senders may not be linked yet
+                p_buf = p_local->first;
+                if (!p_buf)
+                {
+                    ret = -ENOSPC;
+                    break;
+                }
+                p_local->first = p_buf->next;
+                p_local->queued--;
+                localBufFree(p_local, p_buf);
+                if (RackSimClock::isEnabled())
+                {
+                    RackSimClock::msgReceive(p_local->addr);
+                }
+                break;
+
+            case RACK_MBX_OVERFLOW_DROP_NEWEST:
+                ret = -ENOSPC;
+                break;
+
+            case RACK_MBX_OVERFLOW_BLOCK:
+                deadline   = localGetMonoNano() + p_local->timeout_ns;
+                ts.tv_sec  = deadline / 1000000000llu;
+                ts.tv_nsec = deadline % 1000000000llu;
+
+                p_local->waiting++;
+                while ((p_local->policy == RACK_MBX_OVERFLOW_BLOCK) &&
+                       (p_local->queued >= p_local->maxQueued))
+                {
+                    if (pthread_cond_timedwait(&p_local->cond, &p_local->mtx,
+                                               &ts) == ETIMEDOUT)
+                    {
+                        ret = -ETIMEDOUT;
+                        break;
+                    }
+                }
+                p_local->waiting--;
+                break;
+        }
+    }
+
+    if (!ret)
+    {
+        p_local->queued++;
+    }
+
+    pthread_mutex_unlock(&p_local->mtx);
+    return ret;
+}
+
+static rack_mbx_buf* localPop(struct rack_mbx_local *p_local)
+{
+    rack_mbx_buf *p_buf;
+
+    pthread_mutex_lock(&p_local->mtx);
+    p_buf = p_local->first;
+    if (p_buf)
+    {
+        p_local->first = p_buf->next;
+        localTaken(p_local);
+    }
+    pthread_mutex_unlock(&p_local->mtx);
+
+    return p_buf;
+}
+
+static void localRelease(struct rack_mbx_local *p_local, rack_mbx_buf *p_buf)
+{
+    pthread_mutex_lock(&p_local->mtx);
+    localBufFree(p_local, p_buf);
+    pthread_mutex_unlock(&p_local->mtx);
+}
+
+static void localFreeList(rack_mbx_buf *p_buf)
+{
+    rack_mbx_buf *p_next;
+
+    while (p_buf)
+    {
+        p_next = p_buf->next;
+        free(p_buf);
+        p_buf = p_next;
+    }
+}
+
+static struct rack_mbx_local* localCreate(uint32_t address, int messageSlots,
+                                          uint32_t maxMsglen)
+{
+    struct rack_mbx_local   *p_local;
+    rack_mbx_buf            *p_buf;
+    pthread_condattr_t      attr;
+    unsigned int            index;
+    int                     i;
+
+    p_local = (struct rack_mbx_local *)calloc(1, sizeof(struct rack_mbx_local));
+    if (!p_local)
+    {
+        return NULL;
+    }
+
+    p_local->efd = eventfd(0, EFD_NONBLOCK);
+    if (p_local->efd < 0)
+    {
+        free(p_local);
+        return NULL;
+    }
+
+    pthread_mutex_init(&p_local->mtx, NULL);
+
+    // the timeout of a blocked sender is a real time
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&p_local->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    p_local->addr      = address;
+    p_local->slotSize  = maxMsglen;
+    p_local->maxQueued = messageSlots;
+
+    // like the TIMS mailbox the queue keeps its slots and drops the oldest message
+    if (messageSlots > 0)
+    {
+        p_local->policy = RACK_MBX_OVERFLOW_DROP_OLDEST;
+    }
+    else
+    {
+        p_local->policy = RACK_MBX_OVERFLOW_GROW;
+    }
+
+    // the slots are allocated in advance, only RACK_MBX_OVERFLOW_GROW lets the
+    // pool grow beyond one further slot for the peeked message
+    for (i = 0; i < messageSlots; i++)
+    {
+        p_buf = (rack_mbx_buf *)malloc(sizeof(rack_mbx_buf) + maxMsglen - TIMS_HEADLEN);
+        if (!p_buf)
+        {
+            break;
+        }
+        p_buf->size   = maxMsglen;
+        p_buf->next   = p_local->free;
+        p_local->free = p_buf;
+    }
+
+    index = localHashIndex(address);
+
+    pthread_rwlock_wrlock(&localHashLock);
+    p_local->hashNext = localHash[index];
+    localHash[index]  = p_local;
+    pthread_rwlock_unlock(&localHashLock);
+
+    return p_local;
+}
+
+static void localRemove(struct rack_mbx_local *p_local)
+{
+    struct rack_mbx_local   **pp_local;
+
+    // senders hold the read lock while they access the queue,
+    // blocked senders until their timeout
+    pthread_rwlock_wrlock(&localHashLock);
+    pp_local = &localHash[localHashIndex(p_local->addr)];
+    while (*pp_local)
+    {
+        if (*pp_local == p_local)
+        {
+            *pp_local = p_local->hashNext;
+            break;
+        }
+        pp_local = &(*pp_local)->hashNext;
+    }
+    pthread_rwlock_unlock(&localHashLock);
+
+    localFreeList(p_local->first);
+    localFreeList(p_local->free);
+    if (p_local->peekBuf)
+    {
+        free(p_local->peekBuf);
+    }
+
+    close(p_local->efd);
+    pthread_cond_destroy(&p_local->cond);
+    pthread_mutex_destroy(&p_local->mtx);
+    free(p_local);
+}
+
+/*
+ * Waits for a local message or for a message on the TIMS socket.
+ * Returns 1 if the socket is readable, 0 after a local event and
+ * -EWOULDBLOCK on timeout.
+ */
+static int localWait(struct rack_mbx_local *p_local, int fd, int64_t timeout_ns,
+                     uint64_t deadline)
+{
+    struct pollfd   pfd[2];
+    struct timespec ts, *p_ts = NULL;
+    uint64_t        now, value;
+    int             ret;
+
+    if (timeout_ns == TIMS_NONBLOCK)
+    {
+        ts.tv_sec  = 0;
+        ts.tv_nsec = 0;
+        p_ts       = &ts;
+    }
+    else if (timeout_ns != TIMS_INFINITE)
+    {
+        now = localGetMonoNano();
+        if (now >= deadline)
+        {
+            return -EWOULDBLOCK;
+        }
+        ts.tv_sec  = (deadline - now) / 1000000000llu;
+        ts.tv_nsec = (deadline - now) % 1000000000llu;
+        p_ts       = &ts;
+    }
+
+    pfd[0].fd      = fd;
+    pfd[0].events  = POLLIN;
+    pfd[0].revents = 0;
+    pfd[1].fd      = p_local->efd;
+    pfd[1].events  = POLLIN;
+    pfd[1].revents = 0;
+
+    ret = ppoll(pfd, 2, p_ts, NULL);
+    if (ret < 0)
+    {
+        return (errno == EINTR) ? 0 : -errno;
+    }
+    if (ret == 0)
+    {
+        return -EWOULDBLOCK;
+    }
+
+    if (pfd[1].revents & POLLIN)
+    {
+        if (read(p_local->efd, &value, sizeof(value)) < 0)
+        {
+            // EAGAIN, the event was already consumed
+        }
+    }
+    if (pfd[0].revents)
+    {
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Waits up to RACK_SIM_CLOCK_POLL_NS real time for a message. The virtual
+ * timeout of a mailbox wait is checked between the polls.
+ */
+static void simPoll(struct rack_mbx_local *p_local, int fd)
+{
+    struct pollfd pfd;
+
+    if (p_local)
+    {
+        localWait(p_local, fd, RACK_SIM_CLOCK_POLL_NS,
+                  localGetMonoNano() + RACK_SIM_CLOCK_POLL_NS);
+        return;
+    }
+
+    pfd.fd      = fd;
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+    poll(&pfd, 1, RACK_SIM_CLOCK_POLL_NS / 1000000);
+}
+
+// a message was taken out of the mailbox, @a ret is the result of the receive
+static void simReceived(uint32_t address, int ret)
+{
+    if (((ret >= 0) || (ret == -EMSGSIZE)) && RackSimClock::isEnabled())
+    {
+        RackSimClock::msgReceive(address);
+    }
+}
+
+#endif // __XENO__
+
+#ifdef __RACK_TRACE__
+
+// removes the trace context behind the data
+static void traceStrip(tims_msg_head *p_head, void *p_data)
+{
+    rack_trace_ctx ctx;
+
+    if (!(p_head->flags & TIMS_HEAD_TRACE) ||
+        (p_head->msglen < TIMS_HEADLEN + RACK_TRACE_CTX_LEN))
+    {
+        return;
+    }
+
+    p_head->msglen -= RACK_TRACE_CTX_LEN;
+    p_head->flags  &= ~TIMS_HEAD_TRACE;
+
+    // the context follows the data at any byte offset, copy it out for
+    // targets without unaligned access
+    memcpy(&ctx, (uint8_t *)p_data + p_head->msglen - TIMS_HEADLEN, RACK_TRACE_CTX_LEN);
+
+    if (RackTrace::isEnabled())
+    {
+        RackTrace::recv(p_head, &ctx);
+    }
+}
+
+#endif // __RACK_TRACE__
+
+/**
+ * @brief Enable the in-process delivery
+ */
+void RackMailbox::setLocalDelivery(int enable)
+{
+#ifndef __XENO__
+    localDelivery = enable;
+#endif
+}
+
+int RackMailbox::getLocalDelivery(void)
+{
+#ifndef __XENO__
+    return localDelivery;
+#else
+    return 0;
+#endif
+}
+
+uint32_t RackMailbox::getDestOverflowCount(uint32_t address)
+{
+#ifndef __XENO__
+    struct rack_mbx_local   *p_local;
+    uint32_t                count = 0;
+
+    if (!localDelivery)
+    {
+        return 0;
+    }
+
+    pthread_rwlock_rdlock(&localHashLock);
+
+    p_local = localHash[localHashIndex(address)];
+    while (p_local && (p_local->addr != address))
+    {
+        p_local = p_local->hashNext;
+    }
+    if (p_local)
+    {
+        count = p_local->overflowCount;
+    }
+
+    pthread_rwlock_unlock(&localHashLock);
+
+    return count;
+#else
+    return 0;
+#endif
+}
+
+ssize_t RackMailbox::deliver(tims_msg_head *p_head, struct iovec *iov, int iovNum,
+                             int trace)
+{
+#ifdef __RACK_TRACE__
+    rack_trace_ctx          ctx;
+    struct iovec            traceIov[iovNum + 1];
+    ssize_t                 ret;
+
+    // the trace context is sent as an additional data pointer
+    if (trace && RackTrace::isEnabled() && RackTrace::send(p_head, &ctx))
+    {
+        if (iovNum)
+        {
+            memcpy(traceIov, iov, iovNum * sizeof(struct iovec));
+        }
+        traceIov[iovNum].iov_base = &ctx;
+        traceIov[iovNum].iov_len  = RACK_TRACE_CTX_LEN;
+        p_head->msglen           += RACK_TRACE_CTX_LEN;
+
+        ret = deliver(p_head, traceIov, iovNum + 1, 0);
+
+        p_head->msglen -= RACK_TRACE_CTX_LEN;
+        p_head->flags  &= ~TIMS_HEAD_TRACE;
+        if (ret > 0)
+        {
+            ret -= RACK_TRACE_CTX_LEN;
+        }
+        return ret;
+    }
+#endif
+
+#ifndef __XENO__
+    struct rack_mbx_local   *p_dest;
+    rack_mbx_buf            *p_buf;
+    uint8_t                 *p_pos;
+    uint64_t                value = 1;
+    ssize_t                 sent;
+    int                     i, wake, err;
+
+    if (localDelivery)
+    {
+        pthread_rwlock_rdlock(&localHashLock);
+
+        p_dest = localHash[localHashIndex(p_head->dest)];
+        while (p_dest && (p_dest->addr != p_head->dest))
+        {
+            p_dest = p_dest->hashNext;
+        }
+
+        if (p_dest)
+        {
+            err = localReserve(p_dest);
+            if (err)
+            {
+                pthread_rwlock_unlock(&localHashLock);
+                return err;
+            }
+
+            p_buf = localBufAlloc(p_dest, p_head->msglen);
+            if (!p_buf)
+            {
+                pthread_mutex_lock(&p_dest->mtx);
+                localTaken(p_dest);
+                pthread_mutex_unlock(&p_dest->mtx);
+
+                pthread_rwlock_unlock(&localHashLock);
+                return -ENOMEM;
+            }
+
+            // counted before the receiver can take it
+            if (RackSimClock::isEnabled())
+            {
+                RackSimClock::msgSend(p_head->dest);
+            }
+
+            // the only copy of the message
+            memcpy(&p_buf->head, p_head, TIMS_HEADLEN);
+            p_pos = p_buf->head.data;
+            for (i = 0; i < iovNum; i++)
+            {
+                memcpy(p_pos, iov[i].iov_base, iov[i].iov_len);
+                p_pos += iov[i].iov_len;
+            }
+            p_buf->next = NULL;
+
+            pthread_mutex_lock(&p_dest->mtx);
+            wake = (p_dest->first == NULL);
+            if (wake)
+            {
+                p_dest->first = p_buf;
+            }
+            else
+            {
+                p_dest->last->next = p_buf;
+            }
+            p_dest->last = p_buf;
+            pthread_mutex_unlock(&p_dest->mtx);
+
+            if (wake)
+            {
+                if (write(p_dest->efd, &value, sizeof(value)) < 0)
+                {
+                    // only fails on a counter overflow, the receiver wakes up anyway
+                }
+            }
+
+            pthread_rwlock_unlock(&localHashLock);
+            return p_head->msglen;
+        }
+
+        pthread_rwlock_unlock(&localHashLock);
+    }
+
+    if (RackSimClock::isEnabled())
+    {
+        RackSimClock::msgSend(p_head->dest);
+
+        sent = tims_sendmsg(fd, p_head, iov, iovNum, 0);
+        if (sent < 0)
+        {
+            RackSimClock::msgReceive(p_head->dest);
+        }
+        return sent;
+    }
+#endif
+
+    return tims_sendmsg(fd, p_head, iov, iovNum, 0);
+}
+
+int RackMailbox::timsReceive(tims_msg_head *p_head, void *p_data, uint32_t maxDatalen,
+                             int64_t timeout_ns)
+{
+#ifdef __RACK_TRACE__
+    int ret;
+
+    // the trace context behind the data may not fit into the buffer of the caller
+    ret = tims_recvmsg_timed(fd, p_head, traceBuf, traceBufSize, timeout_ns, 0);
+    if (ret < 0)
+    {
+        return ret;
+    }
+
+    traceStrip(p_head, traceBuf);
+
+    if (p_head->msglen > maxDatalen + TIMS_HEADLEN)
+    {
+        return -EMSGSIZE;
+    }
+    if (p_head->msglen > TIMS_HEADLEN)
+    {
+        memcpy(p_data, traceBuf, p_head->msglen - TIMS_HEADLEN);
+    }
+    return p_head->msglen;
+#else
+    return tims_recvmsg_timed(fd, p_head, p_data, maxDatalen, timeout_ns, 0);
+#endif
+}
+
+int RackMailbox::receive(tims_msg_head *p_head, void *p_data, uint32_t maxDatalen,
+                         int64_t timeout_ns)
+{
+#ifndef __XENO__
+    rack_mbx_buf    *p_buf;
+    uint64_t        deadline = 0;
+    int             ret;
+
+    // lockstep simulation, the timeout is virtual time
+    if ((timeout_ns != TIMS_NONBLOCK) && RackSimClock::isEnabled())
+    {
+        if (timeout_ns != TIMS_INFINITE)
+        {
+            deadline = RackSimClock::getNano() + timeout_ns;
+        }
+
+        RackSimClock::waitBegin(deadline);
+        while (1)
+        {
+            ret = receive(p_head, p_data, maxDatalen, TIMS_NONBLOCK);
+            if ((ret != -EWOULDBLOCK) || (deadline && (RackSimClock::getNano() >= deadline)))
+            {
+                break;
+            }
+            simPoll(local, fd);
+        }
+        RackSimClock::waitEnd();
+        return ret;
+    }
+
+    if (local)
+    {
+        if ((timeout_ns != TIMS_INFINITE) && (timeout_ns != TIMS_NONBLOCK))
+        {
+            deadline = localGetMonoNano() + timeout_ns;
+        }
+
+        while (1)
+        {
+            p_buf = localPop(local);
+            if (p_buf)
+            {
+#ifdef __RACK_TRACE__
+                traceStrip(&p_buf->head, p_buf->head.data);
+#endif
+                ret = p_buf->head.msglen;
+                if (p_buf->head.msglen > maxDatalen + TIMS_HEADLEN)
+                {
+                    // dropped, TIMS would close the mailbox
+                    ret = -EMSGSIZE;
+                }
+                else
+                {
+                    memcpy(p_head, &p_buf->head, TIMS_HEADLEN);
+                    if (p_buf->head.msglen > TIMS_HEADLEN)
+                    {
+                        memcpy(p_data, p_buf->head.data, p_buf->head.msglen - TIMS_HEADLEN);
+                    }
+                }
+
+                localRelease(local, p_buf);
+                simReceived(addr, ret);
+                return ret;
+            }
+
+            ret = localWait(local, fd, timeout_ns, deadline);
+            if (ret < 0)
+            {
+                return ret;
+            }
+            if (ret == 1)
+            {
+                ret = timsReceive(p_head, p_data, maxDatalen, TIMS_NONBLOCK);
+                if (ret != -EWOULDBLOCK)
+                {
+                    simReceived(addr, ret);
+                    return ret;
+                }
+                // it was only the watchdog of the router
+            }
+        }
+    }
+
+    ret = timsReceive(p_head, p_data, maxDatalen, timeout_ns);
+    simReceived(addr, ret);
+    return ret;
+#else
+    return timsReceive(p_head, p_data, maxDatalen, timeout_ns);
+#endif
+}
+
+int RackMailbox::peekBegin(tims_msg_head **pp_head, int64_t timeout_ns)
+{
+    int             ret;
+
+#ifndef __XENO__
+    rack_mbx_buf    *p_buf;
+    uint64_t        deadline = 0;
+
+    // lockstep simulation, the timeout is virtual time
+    if ((timeout_ns != TIMS_NONBLOCK) && RackSimClock::isEnabled())
+    {
+        if (timeout_ns != TIMS_INFINITE)
+        {
+            deadline = RackSimClock::getNano() + timeout_ns;
+        }
+
+        RackSimClock::waitBegin(deadline);
+        while (1)
+        {
+            ret = peekBegin(pp_head, TIMS_NONBLOCK);
+            if ((ret != -EWOULDBLOCK) || (deadline && (RackSimClock::getNano() >= deadline)))
+            {
+                break;
+            }
+            simPoll(local, fd);
+        }
+        RackSimClock::waitEnd();
+        return ret;
+    }
+
+    if (local)
+    {
+        if ((timeout_ns != TIMS_INFINITE) && (timeout_ns != TIMS_NONBLOCK))
+        {
+            deadline = localGetMonoNano() + timeout_ns;
+        }
+
+        while (1)
+        {
+            // the message stays in its slot until peekEnd()
+            p_buf = localPop(local);
+            if (p_buf)
+            {
+#ifdef __RACK_TRACE__
+                traceStrip(&p_buf->head, p_buf->head.data);
+#endif
+                local->peekBuf = p_buf;
+                *pp_head       = &p_buf->head;
+                simReceived(addr, p_buf->head.msglen);
+                return p_buf->head.msglen;
+            }
+
+            ret = localWait(local, fd, timeout_ns, deadline);
+            if (ret < 0)
+            {
+                return ret;
+            }
+            if (ret == 1)
+            {
+                p_buf = localBufAlloc(local, local->slotSize);
+                if (!p_buf)
+                {
+                    return -ENOMEM;
+                }
+
+                ret = tims_recvmsg_timed(fd, &p_buf->head, p_buf->head.data,
+                                         p_buf->size - TIMS_HEADLEN, TIMS_NONBLOCK, 0);
+                if (ret < 0)
+                {
+                    localRelease(local, p_buf);
+                    if (ret != -EWOULDBLOCK)
+                    {
+                        return ret;
+                    }
+                    continue;
+                }
+
+#ifdef __RACK_TRACE__
+                traceStrip(&p_buf->head, p_buf->head.data);
+                ret = p_buf->head.msglen;
+#endif
+                local->peekBuf = p_buf;
+                *pp_head       = &p_buf->head;
+                simReceived(addr, ret);
+                return ret;
+            }
+        }
+    }
+#endif
+
+    ret = tims_peek_timed(fd, pp_head, timeout_ns);
+#ifndef __XENO__
+    simReceived(addr, ret);
+#endif
+#ifdef __RACK_TRACE__
+    if (ret >= 0)
+    {
+        // the message is changed in its slot
+        traceStrip(*pp_head, (*pp_head)->data);
+    }
+#endif
+    return ret;
+}
+
  /*!
  * @ingroup mailbox
  *
@@ -50,6 +899,9 @@ RackMailbox::RackMailbox()
     fd          = -1;
     addr         = 0;
     sendPrio    = 0;
+    local       = NULL;
+    traceBuf    = NULL;
+    traceBufSize = 0;
 }
 
 /**
@@ -87,6 +939,11 @@ int RackMailbox::create(uint32_t address, int messageSlots,
 {
     ssize_t maxMsglen = maxDatalen + TIMS_HEADLEN;
 
+#ifdef __RACK_TRACE__
+    // space for the trace context
+    maxMsglen += RACK_TRACE_CTX_LEN;
+#endif
+
     sendMtx.create();
     recvMtx.create();
 
@@ -103,9 +960,55 @@ int RackMailbox::create(uint32_t address, int messageSlots,
         return fd;
     }
 
+#ifndef __XENO__
+    if (localDelivery)
+    {
+        local = localCreate(address, messageSlots, maxMsglen);
+        if (!local)
+        {
+            tims_mbx_remove(fd);
+            fd = -1;
+
+            sendMtx.destroy();
+            recvMtx.destroy();
+
+            return -ENOMEM;
+        }
+    }
+#endif
+
+#ifdef __RACK_TRACE__
+    traceBufSize = maxMsglen - TIMS_HEADLEN;
+    traceBuf     = malloc(traceBufSize);
+    if (!traceBuf)
+    {
+#ifndef __XENO__
+        if (local)
+        {
+            localRemove(local);
+            local = NULL;
+        }
+#endif
+        tims_mbx_remove(fd);
+        fd = -1;
+
+        sendMtx.destroy();
+        recvMtx.destroy();
+
+        return -ENOMEM;
+    }
+#endif
+
     addr         = address;
     sendPrio    = sendPriority;
 
+#ifndef __XENO__
+    if (RackSimClock::isEnabled())
+    {
+        RackSimClock::mbxCreate(address);
+    }
+#endif
+
     return 0;
 }
 
@@ -129,8 +1032,28 @@ int RackMailbox::remove(void)
 {
     int ret;
 
+#ifndef __XENO__
+    if (local)
+    {
+        localRemove(local);
+        local = NULL;
+    }
+
+    if (RackSimClock::isEnabled())
+    {
+        RackSimClock::mbxRemove(addr);
+    }
+#endif
+
     ret = tims_mbx_remove(fd);
 
+    if (traceBuf)
+    {
+        free(traceBuf);
+        traceBuf     = NULL;
+        traceBufSize = 0;
+    }
+
     fd          = -1;
     addr         = 0;
     sendPrio    = 0;
@@ -162,13 +1085,139 @@ int RackMailbox::clean(void)
 
     recvMtx.lock();
 
+#ifndef __XENO__
+    if (local)
+    {
+        uint64_t value;
+
+        pthread_mutex_lock(&local->mtx);
+        while (local->first)
+        {
+            rack_mbx_buf *p_buf = local->first;
+
+            local->first = p_buf->next;
+            localBufFree(local, p_buf);
+            localTaken(local);
+        }
+        pthread_mutex_unlock(&local->mtx);
+
+        if (read(local->efd, &value, sizeof(value)) < 0)
+        {
+            // EAGAIN, no event pending
+        }
+    }
+#endif
+
     ret = tims_mbx_clean(fd, addr);
 
+#ifndef __XENO__
+    if (RackSimClock::isEnabled())
+    {
+        RackSimClock::mbxClean(addr);
+    }
+#endif
+
     recvMtx.unlock();
 
     return ret;
 }
 
+/**
+ * @brief Set the overflow policy of the mailbox
+ *
+ * A mailbox with an in-process queue (see setLocalDelivery()) keeps at most
+ * the number of message slots of the mailbox. A further message is handled
+ * as follows:
+ *
+ * - RACK_MBX_OVERFLOW_DROP_OLDEST (default): the oldest queued message is
+ *   dropped, the send succeeds. If the queued slots are still being filled
+ *   by other senders the send fails with -ENOSPC
+ * - RACK_MBX_OVERFLOW_DROP_NEWEST: the new message is dropped, the send
+ *   fails with -ENOSPC
+ * - RACK_MBX_OVERFLOW_BLOCK: the sender waits up to @a timeout_ns for a
+ *   free slot, otherwise the send fails with -ETIMEDOUT
+ * - RACK_MBX_OVERFLOW_GROW: the queue grows without a limit, the send
+ *   only fails if no memory is left
+ *
+ * Each overflow increments the overflow count of the mailbox.
+ * Mailboxes without an in-process queue keep the TIMS behaviour, the
+ * Xenomai driver drops the oldest message with the lowest priority.
+ *
+ * @param policy RACK_MBX_OVERFLOW_*
+ * @param timeout_ns Timeout of RACK_MBX_OVERFLOW_BLOCK, not infinite
+ *
+ * @return 0 on success, -EOPNOTSUPP if the mailbox has no in-process
+ *         queue, otherwise negative error code
+ *
+ * Environments:
+ *
+ * This service can be called from:
+ *
+ * - User-space task
+ *
+ * Rescheduling: never
+ */
+int RackMailbox::setOverflowPolicy(int policy, int64_t timeout_ns)
+{
+#ifndef __XENO__
+    if (!local)
+    {
+        return -EOPNOTSUPP;
+    }
+
+    switch (policy)
+    {
+        case RACK_MBX_OVERFLOW_GROW:
+            break;
+
+        case RACK_MBX_OVERFLOW_BLOCK:
+            if (timeout_ns <= 0)
+            {
+                return -EINVAL;
+            }
+            // fall through
+
+        case RACK_MBX_OVERFLOW_DROP_OLDEST:
+        case RACK_MBX_OVERFLOW_DROP_NEWEST:
+            if (local->maxQueued <= 0)
+            {
+                return -EINVAL;
+            }
+            break;
+
+        default:
+            return -EINVAL;
+    }
+
+    pthread_mutex_lock(&local->mtx);
+    local->policy     = policy;
+    local->timeout_ns = timeout_ns;
+
+    // blocked senders check the new policy
+    pthread_cond_broadcast(&local->cond);
+    pthread_mutex_unlock(&local->mtx);
+
+    return 0;
+#else
+    return -EOPNOTSUPP;
+#endif
+}
+
+/**
+ * @brief Number of messages this mailbox has lost or delayed because its
+ *        queue was full, see setOverflowPolicy()
+ */
+uint32_t RackMailbox::getOverflowCount(void)
+{
+#ifndef __XENO__
+    if (local)
+    {
+        return local->overflowCount;
+    }
+#endif
+    return 0;
+}
+
 //
 // send
 //
@@ -201,7 +1250,7 @@ int RackMailbox::sendMsg(int8_t type, uint32_t dest, uint8_t seqNr)
 
     tims_fill_head(&head, type, dest, addr, sendPrio, seqNr, 0, TIMS_HEADLEN);
 
-    ret = tims_sendmsg(fd, &head, NULL, 0, 0);
+    ret = deliver(&head, NULL, 0, 1);
 
     sendMtx.unlock();
 
@@ -241,7 +1290,7 @@ int RackMailbox::sendMsgReply(int8_t type, RackMessage* msgInfo)
 
     tims_fill_head(&head, type, msgInfo->getSrc(), addr, msgInfo->getPriority(), msgInfo->getSeqNr(), 0, TIMS_HEADLEN);
 
-    ret = tims_sendmsg(fd, &head, NULL, 0, 0);
+    ret = deliver(&head, NULL, 0, 1);
 
     sendMtx.unlock();
 
@@ -307,7 +1356,7 @@ int RackMailbox::sendDataMsg(int8_t type, uint32_t dest, uint8_t seqNr,
 
     tims_fill_head(&head, type, dest, addr, sendPrio, seqNr, 0, msglen);
 
-    ret = tims_sendmsg(fd, &head, iov, dataPointers, 0);
+    ret = deliver(&head, iov, dataPointers, 1);
 
     sendMtx.unlock();
 
@@ -324,6 +1373,7 @@ int RackMailbox::sendDataMsg(int8_t type, uint32_t dest, uint8_t seqNr,
  * @brief Send a data message (using tims_msg_head)
  *
  * This function sends a data message (using tims_msg_head).
+ * The head is sent as it is, without a trace context.
  *
  * @param p_head Pointer to a filled struct tims_msg_head.
  * @param dataPointers Number of data pointers to data buffers which
@@ -369,7 +1419,7 @@ int RackMailbox::sendDataMsg(tims_msg_head *p_head, int dataPointers, void* data
 
     p_head->msglen = msglen;
 
-    ret = tims_sendmsg(fd, p_head, iov, dataPointers, 0);
+    ret = deliver(p_head, iov, dataPointers, 0);
 
     sendMtx.unlock();
 
@@ -434,7 +1484,63 @@ int RackMailbox::sendDataMsgReply(int8_t type, RackMessage* msgInfo,
 
     tims_fill_head(&head, type, msgInfo->getSrc(), addr, msgInfo->getPriority(), msgInfo->getSeqNr(), 0, msglen);
 
-    ret = tims_sendmsg(fd, &head, iov, dataPointers, 0);
+    ret = deliver(&head, iov, dataPointers, 1);
+
+    sendMtx.unlock();
+
+    if (ret < 0)
+        return ret;
+
+    if (ret != (int)msglen)
+       return -EFAULT;
+
+    return 0;
+}
+
+/**
+ * @brief Send a reply data message from an array of data buffers
+ *
+ * Like sendDataMsgReply(), for a number of data buffers that is only known
+ * at runtime.
+ *
+ * @param type Message type
+ * @param msgInfo Message info of the previously received message
+ * @param iov Data buffers, sent one after the other
+ * @param iovNum Number of data buffers, at most 254
+ *
+ * @return 0 on success, otherwise negative error code
+ *
+ * Environments:
+ *
+ * This service can be called from:
+ *
+ * - User-space task (non-RT, RT)
+ *
+ * Rescheduling: possible
+ */
+int RackMailbox::sendIovMsgReply(int8_t type, RackMessage *msgInfo,
+                                 struct iovec *iov, int iovNum)
+{
+    int             i;
+    uint32_t        msglen;
+    int32_t         ret;
+    tims_msg_head   head;
+
+    // TIMS sends up to 255 data buffers, one is kept for the trace context
+    if ((iovNum < 0) || (iovNum > 254))
+        return -EINVAL;
+
+    msglen = TIMS_HEADLEN;
+    for (i = 0; i < iovNum; i++)
+    {
+        msglen += iov[i].iov_len;
+    }
+
+    sendMtx.lock();
+
+    tims_fill_head(&head, type, msgInfo->getSrc(), addr, msgInfo->getPriority(), msgInfo->getSeqNr(), 0, msglen);
+
+    ret = deliver(&head, iov, iovNum, 1);
 
     sendMtx.unlock();
 
@@ -491,7 +1597,7 @@ int RackMailbox::sendDataMsgReply(int8_t type, RackMessage* msgInfo,
 
     recvMtx.lock();
 
-    ret = tims_peek_timed(fd, &p_peek_head, TIMS_INFINITE);
+    ret = peekBegin(&p_peek_head, TIMS_INFINITE);
 
     if (ret < 0)
     {
@@ -546,7 +1652,7 @@ int RackMailbox::peekTimed(uint64_t timeout_ns, RackMessage *msgInfo)
 
     recvMtx.lock();
 
-    ret = tims_peek_timed(fd, &p_peek_head, timeout_ns);
+    ret = peekBegin(&p_peek_head, timeout_ns);
 
     if (ret < 0)
     {
@@ -600,7 +1706,7 @@ int RackMailbox::peekIf(RackMessage *msgInfo)
 
     recvMtx.lock();
 
-    ret = tims_peek_timed(fd, &p_peek_head, TIMS_NONBLOCK);
+    ret = peekBegin(&p_peek_head, TIMS_NONBLOCK);
 
     if (ret < 0)
     {
@@ -635,6 +1741,17 @@ int RackMailbox::peekEnd(void)
 {
     int ret;
 
+#ifndef __XENO__
+    if (local && local->peekBuf)
+    {
+        localRelease(local, local->peekBuf);
+        local->peekBuf = NULL;
+
+        recvMtx.unlock();
+        return 0;
+    }
+#endif
+
     ret = tims_peek_end(fd);
 
     recvMtx.unlock();
@@ -677,7 +1794,7 @@ int RackMailbox::recvMsg(RackMessage *msgInfo)
 
     recvMtx.lock();
 
-    ret = tims_recvmsg_timed(fd, msgInfo->getHead(), NULL, 0, TIMS_INFINITE, 0);
+    ret = receive(msgInfo->getHead(), NULL, 0, TIMS_INFINITE);
 
     recvMtx.unlock();
 
@@ -722,7 +1839,7 @@ int RackMailbox::recvMsgTimed(uint64_t timeout_ns, RackMessage *msgInfo)
 
     recvMtx.lock();
 
-    ret = tims_recvmsg_timed(fd, msgInfo->getHead(), NULL, 0, timeout_ns, 0);
+    ret = receive(msgInfo->getHead(), NULL, 0, timeout_ns);
 
     recvMtx.unlock();
 
@@ -766,7 +1883,7 @@ int     RackMailbox::recvMsgIf(RackMessage *msgInfo)
 
     recvMtx.lock();
 
-    ret = tims_recvmsg_timed(fd, msgInfo->getHead(), NULL, 0, TIMS_NONBLOCK, 0);
+    ret = receive(msgInfo->getHead(), NULL, 0, TIMS_NONBLOCK);
 
     recvMtx.unlock();
 
@@ -812,7 +1929,7 @@ int     RackMailbox::recvDataMsg(void *p_data, uint32_t maxDatalen, RackMessage
 
     recvMtx.lock();
 
-    ret = tims_recvmsg_timed(fd, msgInfo->getHead(), p_data, maxDatalen, TIMS_INFINITE, 0);
+    ret = receive(msgInfo->getHead(), p_data, maxDatalen, TIMS_INFINITE);
 
     recvMtx.unlock();
 
@@ -859,7 +1976,7 @@ int     RackMailbox::recvDataMsgTimed(uint64_t timeout_ns, void *p_data, uint32_
 
     recvMtx.lock();
 
-    ret = tims_recvmsg_timed(fd, msgInfo->getHead(), p_data, maxDatalen, timeout_ns, 0);
+    ret = receive(msgInfo->getHead(), p_data, maxDatalen, timeout_ns);
 
     recvMtx.unlock();
 
@@ -905,7 +2022,7 @@ int     RackMailbox::recvDataMsgIf(void *p_data, uint32_t maxDatalen, RackMessag
 
     recvMtx.lock();
 
-    ret = tims_recvmsg_timed(fd, msgInfo->getHead(), p_data, maxDatalen, TIMS_NONBLOCK, 0);
+    ret = receive(msgInfo->getHead(), p_data, maxDatalen, TIMS_NONBLOCK);
 
     recvMtx.unlock();
 
@@ -24,6 +24,7 @@
 #endif
 
 #include <main/rack_module.h>
+#include <main/rack_host.h>
 #include <main/rack_proxy.h>
 #include <main/rack_list_head.h>
 
@@ -142,6 +143,10 @@ void cmd_task_proc(void *arg)
             {
                 p_mod->cmdMbx.sendMsgReply(MSG_ERROR, &msgInfo);
             }
+
+#ifdef __RACK_TRACE__
+            RackTrace::end();
+#endif
         }
     } // while()
 
@@ -716,11 +721,14 @@ int       RackModule::moduleInit(void)
     mlockall(MCL_CURRENT | MCL_FUTURE);
 #endif
 
-    // init signal handler
-    ret = init_signal_handler(this);
-    if (ret)
+    // init signal handler, a RackHost handles the signals of all modules
+    if (!RackHost::isEnabled())
     {
-        goto exit_error;
+        ret = init_signal_handler(this);
+        if (ret)
+        {
+            goto exit_error;
+        }
     }
 
     // create command mailbox
@@ -995,7 +1003,14 @@ void  RackModule::run(void)
     }
     moduleInitBits.setBit(INIT_BIT_DATATSK_STARTED);
 
-    pause();
+    if (RackHost::isEnabled())
+    {
+        RackHost::moduleRun(this);
+    }
+    else
+    {
+        pause();
+    }
 
 exit_error:
     // call top level cleanup function
@@ -66,6 +66,10 @@ int RackProxy::proxySendCmd(int8_t send_msgtype, uint64_t timeout)
         return -EINVAL;
     }
 
+#ifdef __RACK_TRACE__
+    RackTraceCall traceCall(destMbxAdr, send_msgtype);
+#endif
+
     ret = workMbx->sendMsg(send_msgtype, destMbxAdr, 0);
     if (ret)
     {
@@ -129,6 +133,10 @@ int RackProxy::proxySendDataCmd(int8_t send_msgtype, void *send_data,
         return -EINVAL;
     }
 
+#ifdef __RACK_TRACE__
+    RackTraceCall traceCall(destMbxAdr, send_msgtype);
+#endif
+
     ret = workMbx->sendDataMsg(send_msgtype, destMbxAdr, 0, 1, send_data, send_datalen);
     if (ret)
     {
@@ -189,6 +197,10 @@ int RackProxy::proxyRecvDataCmd(int8_t send_msgtype, const int8_t recv_msgtype,
         return -EINVAL;
     }
 
+#ifdef __RACK_TRACE__
+    RackTraceCall traceCall(destMbxAdr, send_msgtype);
+#endif
+
     ret = workMbx->sendMsg(send_msgtype, destMbxAdr, 0);
     if (ret)
     {
@@ -252,6 +264,10 @@ int RackProxy::proxySendRecvDataCmd(int8_t send_msgtype, void *send_data,
         return -EINVAL;
     }
 
+#ifdef __RACK_TRACE__
+    RackTraceCall traceCall(destMbxAdr, send_msgtype);
+#endif
+
     ret = workMbx->sendDataMsg(send_msgtype, destMbxAdr, 0, 1, send_data, send_datalen);
     if (ret)
     {
@@ -416,6 +432,34 @@ int RackDataProxy::getNextData(void *recv_data, ssize_t recv_datalen,
                                 reply_timeout_ns, msgInfo);
 }
 
+//
+// get multi data
+//
+
+int RackDataProxy::getMultiData(void *recv_data, ssize_t recv_datalen,
+                                rack_time_t *timeStamp, int timeNum, int mode,
+                                uint64_t reply_timeout_ns, RackMessage *msgInfo)
+{
+    uint8_t             buffer[sizeof(rack_get_multi_data) +
+                               RACK_MULTI_DATA_TIME_MAX * sizeof(rack_time_t)];
+    rack_get_multi_data *send_data = (rack_get_multi_data *)buffer;
+
+    if ((timeNum <= 0) || (timeNum > RACK_MULTI_DATA_TIME_MAX))
+    {
+        return -EINVAL;
+    }
+
+    send_data->mode       = mode;
+    send_data->timeNum    = timeNum;
+    send_data->maxDatalen = recv_datalen;
+    memcpy(send_data->recordingTime, timeStamp, timeNum * sizeof(rack_time_t));
+
+    return proxySendRecvDataCmd(MSG_GET_MULTI_DATA, send_data,
+                                RackGetMultiData::getDatalen(timeNum),
+                                MSG_MULTI_DATA, recv_data, recv_datalen,
+                                reply_timeout_ns, msgInfo);
+}
+
 //
 // get continuous data
 //
@@ -0,0 +1,249 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#include <main/rack_trace.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+int                         RackTrace::state = -1;
+
+static rack_trace_head      *traceHead      = NULL;
+static rack_trace_event     *traceEvent     = NULL;
+static int                  traceEnabled    = 0;
+static pthread_once_t       traceOnce       = PTHREAD_ONCE_INIT;
+static uint32_t             traceIdSeed     = 0;
+static uint32_t             traceIdCount    = 0;
+
+// trace context of the task
+static __thread uint32_t    traceTid        = 0;
+static __thread uint32_t    traceId         = 0;
+static __thread uint32_t    traceSpan       = 0;
+static __thread uint32_t    traceCallId     = 0;    // context before a proxy call
+static __thread uint32_t    traceCallSpan   = 0;
+static __thread uint32_t    traceCallTrace  = 0;    // trace of the proxy call
+
+static uint64_t traceGetNano(void)
+{
+    struct timespec ts;
+
+    // system time, the files of several computers are merged
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000llu + (uint64_t)ts.tv_nsec;
+}
+
+// unique within the process, the seed separates the processes
+static uint32_t traceNewId(void)
+{
+    uint32_t id;
+
+    do
+    {
+        id = (__sync_add_and_fetch(&traceIdCount, 1) * 2654435761u) ^ traceIdSeed;
+    }
+    while (id == 0);
+
+    return id;
+}
+
+static void traceRecord(uint8_t kind, int8_t type, uint32_t id, uint32_t span,
+                        uint32_t parent, uint32_t src, uint32_t dest, int32_t value)
+{
+    rack_trace_event    *p_event;
+    uint32_t            count;
+
+    if (!traceTid)
+    {
+        traceTid = (uint32_t)syscall(SYS_gettid);
+    }
+
+    count   = __sync_fetch_and_add(&traceHead->writeCount, 1);
+    p_event = &traceEvent[count & (RACK_TRACE_EVENT_NUM - 1)];
+
+    // a reader skips the event while it is written
+    p_event->seq = 0;
+    __sync_synchronize();
+
+    p_event->time      = traceGetNano();
+    p_event->kind      = kind;
+    p_event->type      = type;
+    p_event->reserved  = 0;
+    p_event->tid       = traceTid;
+    p_event->trace_id  = id;
+    p_event->span_id   = span;
+    p_event->parent_id = parent;
+    p_event->src       = src;
+    p_event->dest      = dest;
+    p_event->value     = value;
+
+    __sync_synchronize();
+    p_event->seq = count + 1;
+}
+
+static void traceOpen(void)
+{
+    char    *dir;
+    char    path[256];
+    size_t  size;
+    void    *p_map;
+    int     fd;
+
+    dir = getenv(RACK_TRACE_ENV);
+    if (!dir || !dir[0])
+    {
+        return;
+    }
+
+    snprintf(path, sizeof(path), "%s/%s%d", dir, RACK_TRACE_FILE_PREFIX, getpid());
+
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        printf("RackTrace: can't create \"%s\" (%s), tracing is disabled\n",
+               path, strerror(errno));
+        return;
+    }
+
+    size = sizeof(rack_trace_head) + RACK_TRACE_EVENT_NUM * sizeof(rack_trace_event);
+
+    if (ftruncate(fd, size) < 0)
+    {
+        printf("RackTrace: can't resize \"%s\" (%s), tracing is disabled\n",
+               path, strerror(errno));
+        close(fd);
+        return;
+    }
+
+    p_map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p_map == MAP_FAILED)
+    {
+        printf("RackTrace: can't map \"%s\" (%s), tracing is disabled\n",
+               path, strerror(errno));
+        return;
+    }
+
+    // no page faults while the tasks record
+    memset(p_map, 0, size);
+
+    traceHead  = (rack_trace_head *)p_map;
+    traceEvent = (rack_trace_event *)(traceHead + 1);
+
+    traceHead->version  = RACK_TRACE_VERSION;
+    traceHead->eventNum = RACK_TRACE_EVENT_NUM;
+    traceHead->pid      = getpid();
+    strncpy(traceHead->name, program_invocation_short_name, sizeof(traceHead->name) - 1);
+    __sync_synchronize();
+    traceHead->magic    = RACK_TRACE_MAGIC;
+
+    traceIdSeed  = (uint32_t)getpid() * 0x9e3779b9u ^ (uint32_t)traceGetNano();
+    traceEnabled = 1;
+
+    printf("RackTrace: recording to \"%s\"\n", path);
+}
+
+void RackTrace::open(void)
+{
+    pthread_once(&traceOnce, traceOpen);
+    state = traceEnabled;
+}
+
+int RackTrace::send(tims_msg_head *p_head, rack_trace_ctx *p_ctx)
+{
+    uint32_t span;
+
+    if (!traceId)
+    {
+        return 0;
+    }
+
+    span = traceNewId();
+    traceRecord(RACK_TRACE_SEND, p_head->type, traceId, span, traceSpan,
+                p_head->src, p_head->dest, p_head->msglen);
+
+    // host byteorder like the body
+    p_ctx->trace_id = traceId;
+    p_ctx->span_id  = span;
+    p_head->flags  |= TIMS_HEAD_TRACE;
+    return 1;
+}
+
+void RackTrace::recv(tims_msg_head *p_head, rack_trace_ctx *p_ctx)
+{
+    if (p_head->flags & TIMS_BODY_BYTEORDER_LE)
+    {
+        traceId   = __le32_to_cpu(p_ctx->trace_id);
+        traceSpan = __le32_to_cpu(p_ctx->span_id);
+    }
+    else
+    {
+        traceId   = __be32_to_cpu(p_ctx->trace_id);
+        traceSpan = __be32_to_cpu(p_ctx->span_id);
+    }
+
+    traceRecord(RACK_TRACE_RECV, p_head->type, traceId, traceSpan, 0,
+                p_head->src, p_head->dest, p_head->msglen);
+}
+
+void RackTrace::put(uint32_t src, uint32_t recordingTime)
+{
+    // new data without a cause, e.g. of a driver
+    if (!traceId)
+    {
+        traceId   = traceNewId();
+        traceSpan = 0;
+    }
+
+    traceRecord(RACK_TRACE_PUT, 0, traceId, traceSpan, traceSpan, src, 0,
+                (int32_t)recordingTime);
+}
+
+void RackTrace::end(void)
+{
+    traceId   = 0;
+    traceSpan = 0;
+}
+
+void RackTrace::callBegin(uint32_t dest, int8_t type)
+{
+    traceCallId   = traceId;
+    traceCallSpan = traceSpan;
+
+    // each call of a task without trace is a trace on its own
+    if (!traceId)
+    {
+        traceId   = traceNewId();
+        traceSpan = 0;
+    }
+
+    traceCallTrace = traceId;
+    traceRecord(RACK_TRACE_CALL_BEGIN, type, traceId, traceSpan, traceSpan, 0, dest, 0);
+}
+
+void RackTrace::callEnd(uint32_t dest, int8_t type)
+{
+    traceRecord(RACK_TRACE_CALL_END, type, traceCallTrace, traceCallSpan, traceCallSpan,
+                0, dest, 0);
+
+    // the reply doesn't change the context of the caller
+    traceId   = traceCallId;
+    traceSpan = traceCallSpan;
+}
@@ -40,10 +40,9 @@
 //----- COMPR_USE_LZW includes the LZW & LZWV algorithms. Turn it off, if you don't want to use them.
 //#define COMPR_USE_LZW
 
-//----- COMPR_USE_LZSS includes the Burrows Wheeler Transform (BWT).
-//----- The BWT is very slow and does not work properlay, so it has not been optimised.
-//----- So this section of the code ist EXPERIMENTAL.
-//----- Turn it off, if you don't want to use it.
+//----- COMPR_USE_BWT includes the Burrows Wheeler Transform (BWT).
+//----- The suffix array is built in linear time (SA-IS), the work buffer grows by
+//----- about 9 bytes per byte of BWT_MAX_BLOCKSIZE. Turn it off, if you don't want to use it.
 //#define COMPR_USE_BWT
 
 //----- COMPR_USE_ADHUFF includes the adaptive Huffmann algorithm. Turn it off, if you don't want to use it.
@@ -62,10 +61,10 @@
 #define COMPR_S3_HUFFMANN     0x31
 #define COMPR_S3_AD_HUFFMANN  0x32
 
-#define COMPR_S2_LZSS_PARAM(INDEX_BITS, LEN_BITS) (((INDEX_BITS)<<24)|((LEN_BITS)<<16)|S2_LZSS)
-#define COMPR_S2_LZW_PARAM(BITS) (((BITS)<<24)|S2_LZW)
-#define COMPR_S2_LZWV_PARAM(MAX_BITS) (((MAX_BITS)<<24)|S2_LZWV)
-#define COMPR_S2_BWT_PARAM(BLOCK_SIZE) (((BLOCK_SIZE)<<8)|S2_BWT)
+#define COMPR_S2_LZSS_PARAM(INDEX_BITS, LEN_BITS) (((INDEX_BITS)<<24)|((LEN_BITS)<<16)|COMPR_S2_LZSS)
+#define COMPR_S2_LZW_PARAM(BITS) (((BITS)<<24)|COMPR_S2_LZW)
+#define COMPR_S2_LZWV_PARAM(MAX_BITS) (((MAX_BITS)<<24)|COMPR_S2_LZWV)
+#define COMPR_S2_BWT_PARAM(BLOCK_SIZE) (((BLOCK_SIZE)<<8)|COMPR_S2_BWT)
 
 #define GET_TIME rackTime->get()
 #define timestamp rack_time_t
@@ -97,6 +96,7 @@
 #define LZWV_MAX_BITS       11
 
 #define HUFF_EOS            256
+#define HUFF_LUT_BITS       10          //----- decoding table covers codes up to this length
 #define AD_HUFF_EOS         256
 #define AD_HUFF_ESCAPE      257
 #define AD_HUFF_N_SYMBOLS   258
@@ -105,7 +105,17 @@
 #define AD_HUFF_MAX_WEIGHT  0x8000
 #define AD_HUFF_UNUSED      -1
 
-#define BWT_BLOCKSIZE       11
+#define BWT_BLOCKSIZE       (1<<16)     //----- used, if no parameter or 0 is given
+#define BWT_MAX_BLOCKSIZE   (1<<18)
+
+//----- work buffer of CompressTool (step 2/3 buffer, BWT suffix array and SA-IS workspace)
+#define COMPR_ALIGN(SIZE)   (((SIZE)+7)&~7)
+#ifdef COMPR_USE_BWT
+#define COMPR_BWT_N         ((BWT_MAX_BLOCKSIZE < COMPR_MAX_INPUT_SIZE) ? BWT_MAX_BLOCKSIZE+1 : COMPR_MAX_INPUT_SIZE+1)
+#define COMPR_WORKBUF_SIZE  (COMPR_ALIGN(COMPR_MAX_INPUT_SIZE) + 9*COMPR_BWT_N + 64*1024)
+#else
+#define COMPR_WORKBUF_SIZE  (COMPR_ALIGN(COMPR_MAX_INPUT_SIZE))
+#endif
 
 
 #include <main/rack_gdos.h>
@@ -130,6 +140,13 @@ typedef struct compr_bitStream {
     uint32_t aBit;      //----- actual bit in actual byte
 } compr_bitStream;
 
+//----- compr_arena: linear allocator on the work buffer, reset with every (de)compression
+typedef struct compr_arena {
+    uint8_t  *data;     //----- pointer to the work buffer
+    uint32_t size;      //----- size of the work buffer
+    uint32_t used;      //----- allocated bytes
+} compr_arena;
+
 //----- compr_byteStream
 typedef struct compr_byteStream {
     uint8_t  *data;     //----- pointer to data
@@ -148,6 +165,12 @@ typedef struct huff_code {
     uint32_t len;
 } huff_code;
 
+//----- huffmann decoding table entry, len == 0: code is longer, continue at tree node
+typedef struct huff_lut_entry {
+    uint16_t node;
+    uint16_t len;
+} huff_lut_entry;
+
 #ifdef COMPR_USE_ADHUFF
 //----- for adaptive Huffmann coding
 typedef struct adhuff_node {
@@ -190,7 +213,8 @@ class CompressTool {
     RackGdos            *gdos; //----- only for debugging
 
     uint8_t             *pbuf23;
-    uint8_t             buf23[COMPR_MAX_INPUT_SIZE];
+    compr_arena         arena;                          //----- work buffer, see COMPR_WORKBUF_SIZE
+    bool                arenaOwned;
 #ifdef COMPR_DEBUG
     int8_t              statStr[350];                   //----- for statistic output
 #endif
@@ -199,17 +223,13 @@ class CompressTool {
     uint32_t            huff_counters[256];
     huff_node           huff_nodes[514];
     huff_code           huff_codes[257];
+    huff_lut_entry      huff_lut[1<<HUFF_LUT_BITS];
 #ifdef COMPR_USE_ADHUFF
     //----- fr adaptive Huffmann-Komprimierung
     adhuff_tree_t       adhuff_tree;
-#endif
-#ifdef COMPR_USE_BWT
-    //----- for BWT
-    uint8_t             bwt_buf[COMPR_MAX_INPUT_SIZE*2];
-    uint8_t*            bwt_index[COMPR_MAX_INPUT_SIZE];
 #endif
     //----- for MTF
-    uint8_t             mtf_alphabet[255];
+    uint8_t             mtf_alphabet[256];
 #ifdef COMPR_USE_LZSS
     //----- for LZSS
     uint32_t            lzss_cost_benefit;
@@ -237,7 +257,11 @@ class CompressTool {
 //----- ----------------------------------------------------------------------------------------------------
     CompressTool();
     CompressTool(RackMailbox * p_mbx, int32_t gdos_level);
+    CompressTool(uint8_t *workBuf, uint32_t workBufSize);
     ~CompressTool();
+    void     setWorkBuf(uint8_t *workBuf, uint32_t workBufSize);
+    static uint32_t getWorkBufSize(void) { return COMPR_WORKBUF_SIZE; }
+    void*    compr_arenaAlloc(uint32_t size);
     int8_t*  compr_getStatisticsStr();
     int8_t*  compr_getStatisticsTable();
     void     compr_writeStatistics(uint32_t step, uint32_t size);
@@ -262,8 +286,6 @@ class CompressTool {
     void     compr_step2_lzwv_init_table();
     uint32_t compr_step2_mtf(compr_bitStream *in, compr_bitStream *out, uint32_t size);
     uint32_t compr_step2_bwt(compr_bitStream *in, compr_bitStream *out, uint32_t size, uint32_t blocksize);
-    int32_t  compr_step2_bwt_strcmpn(uint8_t *a, uint8_t *b, int32_t size);
-    void     compr_step2_bwt_quicksort(int32_t n, int32_t l, int32_t r);
 
     uint32_t compr_step3_huffmann(compr_bitStream *in, compr_bitStream *out, uint32_t size);
     uint32_t compr_step3_adhuff(compr_bitStream *in, compr_bitStream *out, uint32_t size);
@@ -289,11 +311,16 @@ class CompressTool {
     uint32_t uncompr_step2_lzwv(compr_bitStream *in, compr_bitStream *out, uint32_t max_bits);
     uint32_t uncompr_step2_mtf(compr_bitStream *in, compr_bitStream *out, uint32_t size);
     uint32_t uncompr_step2_bwt(compr_bitStream *in, compr_bitStream *out, uint32_t size, uint32_t blocksize);
-    void     uncompr_step2_bwt_mergesort(uint8_t *in, int32_t left, int32_t right);
     uint32_t uncompr_step3_huffmann(compr_bitStream *in, compr_bitStream *out, uint32_t size);
+    void     uncompr_step3_huffmann_build_lut(uint32_t code, uint32_t len, int32_t node);
     uint32_t uncompr_step3_adhuff(compr_bitStream *in, compr_bitStream *out, uint32_t size);
     uint32_t uncompr_step3_adhuff_decode_symbol(compr_bitStream *in);
 #endif
+
+  private:
+    void     compr_initWorkBuf(uint8_t *workBuf, uint32_t workBufSize);
+    CompressTool(const CompressTool&);              //----- owns the work buffer, no copies
+    CompressTool& operator=(const CompressTool&);
 };
 
 #endif // __COMPRESS_TOOL_H__
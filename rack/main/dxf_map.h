@@ -16,6 +16,9 @@
 #ifndef __DXF_MAP_H__
 #define __DXF_MAP_H__
 
+#include <stdio.h>
+#include <stdint.h>
+
 typedef struct {
     double x;
     double y;
@@ -28,7 +31,66 @@ typedef struct {
     int layer;
 } dxf_map_feature;
 
+#define DXF_MAP_INDEX_CELL_MAX     (1 << 20)
+
+#define DXF_MAP_CACHE_SUFFIX       ".cache"
+#define DXF_MAP_CACHE_MAGIC        0x43465844      // "DXFC"
+#define DXF_MAP_CACHE_VERSION      1
+#define DXF_MAP_CACHE_ALIGN        65536           // multiple of the page size
+
+/**
+ * head of a binary map cache file
+ *
+ * The head is followed by the features, the cell starts and the feature
+ * references of the grid index. The features start at a multiple of
+ * DXF_MAP_CACHE_ALIGN and are padded to it, so they can be mapped on their
+ * own.
+ */
+typedef struct {
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    featureSize;        // sizeof(dxf_map_feature)
+    int32_t     parseMax;           // maxFeatureNum of the DXF parser
+
+    // key
+    uint64_t    fileHash;           // of the DXF file
+    uint64_t    fileSize;
+    double      mapOffsetX;
+    double      mapOffsetY;
+    double      scaleFactor;
+
+    int32_t     featureNum;
+    int32_t     indexNumX;          // 0: no index
+    int32_t     indexNumY;
+    int32_t     indexRefNum;
+    double      indexCellSize;
+    double      xMin;
+    double      xMax;
+    double      yMin;
+    double      yMax;
+
+    uint64_t    featureOffset;
+    uint64_t    cellOffset;
+    uint64_t    refOffset;
+    uint64_t    size;
+} dxf_map_cache_head;
+
 /**
+ * DXF map of line and point features.
+ *
+ * load() builds a uniform grid index over the line features. raycast()
+ * walks the grid cells along each beam (DDA) and only intersects the
+ * features of the visited cells, so the cost of a beam depends on the
+ * features near the beam and not on the size of the map. After the
+ * features are changed by hand, buildIndex() has to be called again,
+ * otherwise raycast() rebuilds the index if featureNum has changed.
+ *
+ * load() keeps a binary cache of the parsed features and the index in
+ * @<filename@>.cache. The cache is used as long as the DXF file and the
+ * load parameters are the same. It is mapped into memory, so all processes
+ * of a host share its pages. The features are mapped copy on write, they
+ * can still be changed, and the @a feature pointer changes with each
+ * load() from the cache.
  *
  * @ingroup main_tools
  */
@@ -38,6 +100,34 @@ class DxfMap
 
         int maxFeatureNum;
 
+        // grid index of the line features
+        int     indexFeatureNum;
+        int     indexNumX;
+        int     indexNumY;
+        double  indexCellSize;
+        int     *indexCellStart;        // features of cell i: indexCellStart[i] .. [i + 1]
+        int     *indexFeature;
+        int     *indexStamp;            // last ray that tested a feature
+        int     indexRay;
+
+        // directions of the last beam angles of raycast()
+        double  *rayAngle;
+        double  *rayCos;
+        double  *raySin;
+        int     rayNum;
+
+        // binary cache of load()
+        int     cacheEnabled;
+        void    *cacheMap;              // cache file, the index points into it
+        size_t  cacheMapSize;
+        size_t  featureMapSize;         // > 0 if the features are mapped
+
+        void freeIndex(void);
+        int  loadCache(const char *filename, dxf_map_cache_head *key);
+        int  saveCache(const char *filename, dxf_map_cache_head *key);
+        double intersect(int i, double x, double y, double dx, double dy, double distance);
+        double raycastBeam(double x, double y, double dx, double dy, double maxRange);
+
     protected:
 
         int read_group(FILE *fp, char *string, int *number, double *real, int *line, int *level, int *vertices);
@@ -83,6 +173,39 @@ class DxfMap
         {
             return load(filename, 0.0, 0.0, 1000.0);
         }
+
+        /**
+         * @brief Use the binary cache in load(), default on
+         */
+        void setCache(int enable)
+        {
+            cacheEnabled = enable;
+        }
+
+        /**
+         * @brief Build the grid index of the line features, called by load()
+         */
+        int buildIndex(void);
+
+        /**
+         * @brief Distances of a fan of beams to the next line feature
+         *
+         * The beam directions of @a angle are computed once and reused as
+         * long as the angles don't change.
+         *
+         * @param x Beam origin
+         * @param y Beam origin
+         * @param rho Orientation of the sensor, added to each angle
+         * @param angle Beam angles relative to @a rho
+         * @param angleNum Number of beams
+         * @param maxRange Range of the beams
+         * @param distance Returns the distance of each beam, maxRange if
+         *                 the beam hits no feature
+         *
+         * @return 0 on success, otherwise negative error code
+         */
+        int raycast(double x, double y, double rho, const double *angle, int angleNum,
+                    double maxRange, double *distance);
 };
 
 #endif // __DXF_MAP_H__
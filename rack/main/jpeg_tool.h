@@ -159,6 +159,79 @@ inline GLOBAL(void) jpeg_stdmem_dest (j_compress_ptr cinfo, char * outstream)
     dest->outstreamOffset         = 0;
 }
 
+/* Data destination object for output straight into a bounded memory block */
+
+typedef struct {
+    struct jpeg_destination_mgr pub; /* public fields */
+
+    char * outstream;          /* target stream */
+    int    outstreamSize;      /* size of the target stream */
+    int    outstreamOffset;    /* bytes written, valid after term_destination */
+} jpeg_direct_dst_mgr;
+
+typedef jpeg_direct_dst_mgr * jpeg_direct_dst_ptr;
+
+/**
+ * Initialize direct destination --- the encoder writes into outstream
+ * without a staging buffer.
+ */
+inline METHODDEF(void) direct_init_destination (j_compress_ptr cinfo)
+{
+    jpeg_direct_dst_ptr dest = (jpeg_direct_dst_ptr) cinfo->dest;
+
+    dest->pub.next_output_byte = (JOCTET *)dest->outstream;
+    dest->pub.free_in_buffer   = dest->outstreamSize;
+    dest->outstreamOffset      = 0;
+}
+
+/**
+ * The whole outstream is full --- there is nothing to flush, so the
+ * image does not fit. Fails with JERR_BUFFER_SIZE.
+ */
+inline METHODDEF(boolean) direct_empty_output_buffer (j_compress_ptr cinfo)
+{
+    ERREXIT(cinfo, JERR_BUFFER_SIZE);
+
+    return FALSE;
+}
+
+/**
+ * Terminate direct destination --- only the length is left to compute.
+ */
+inline METHODDEF(void) direct_term_destination (j_compress_ptr cinfo)
+{
+    jpeg_direct_dst_ptr dest = (jpeg_direct_dst_ptr) cinfo->dest;
+
+    dest->outstreamOffset = dest->outstreamSize - dest->pub.free_in_buffer;
+}
+
+/**
+ * Prepare for output into a memory block of outstreamSize bytes, e.g. a
+ * data buffer slot. Unlike jpeg_stdmem_dest() the data is not copied a
+ * second time, but an image that does not fit aborts the compression.
+ * The same caveat about mixing destination managers applies.
+ */
+inline GLOBAL(void) jpeg_direct_mem_dest (j_compress_ptr cinfo, char * outstream,
+                                          int outstreamSize)
+{
+    jpeg_direct_dst_ptr dest;
+
+    if (cinfo->dest == NULL)
+    {    /* first time for this JPEG object? */
+        cinfo->dest = (struct jpeg_destination_mgr *)
+              (*cinfo->mem->alloc_small) ((j_common_ptr) cinfo, JPOOL_PERMANENT,
+              sizeof(jpeg_direct_dst_mgr));
+    }
+
+    dest = (jpeg_direct_dst_ptr) cinfo->dest;
+    dest->pub.init_destination    = direct_init_destination;
+    dest->pub.empty_output_buffer = direct_empty_output_buffer;
+    dest->pub.term_destination    = direct_term_destination;
+    dest->outstream               = outstream;
+    dest->outstreamSize           = outstreamSize;
+    dest->outstreamOffset         = 0;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,6 +37,7 @@ int close_can_dev(int filedes)
 CanPort::CanPort()
 {
     fd = -1;
+    rxTimeout = PORT_CAPTURE_TIMEOUT_INFINITE;
 }
 
 CanPort::~CanPort()
@@ -55,13 +56,31 @@ int CanPort::open(int dev, can_filter_t *filter_list, int nr_filters, RackModule
     struct ifreq        ifr;
     struct sockaddr_can scan;
 
-    if (fd != -1) // file is open
+    char                name[20];
+
+    if ((fd != -1) || (capture.isReplay())) // file is open
         return -EBUSY;
 
+    snprintf(name, 20, "can%d", dev);
+
+    ret = capture.init(name, module);
+    if (ret < 0)
+        return ret;
+
+    // replay, the device is not needed
+    if (ret == PORT_CAPTURE_REPLAY)
+    {
+        this->module = module;
+        return 0;
+    }
+
     // Prepare CAN socket and controller
     fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
     if (fd < 0)
+    {
+        capture.close();
         return fd;
+    }
 
     // get interface index
     sprintf(ifr.ifr_name, "can%d", dev);
@@ -100,6 +119,11 @@ int CanPort::close(void)
     int i = 5;
     int ret;
 
+    capture.close();
+
+    if (fd == -1)
+        return 0;
+
     do
     {
         ret = close_can_dev(fd);
@@ -120,6 +144,9 @@ int CanPort::setTxTimeout(int64_t timeout)
 {
     struct timeval tv;
 
+    if (capture.isReplay())
+        return 0;
+
     timeout += 1000;        // add 1 usec to make sure that the result is > 0 after rounding
 
     // convert from nsec to sec and usec
@@ -133,6 +160,11 @@ int CanPort::setRxTimeout(int64_t timeout)
 {
     struct timeval tv;
 
+    rxTimeout = timeout;
+
+    if (capture.isReplay())
+        return 0;
+
     timeout += 1000;        // add 1 usec to make sure that the result is > 0 after rounding
 
     // convert from nsec to sec and usec
@@ -151,24 +183,53 @@ int CanPort::send(can_frame_t* frame)
 {
     int ret;
 
+    // the replayed device does not get the commands
+    if (capture.isReplay())
+        return 0;
+
     ret = write(fd, frame, sizeof(can_frame_t));
     if (ret < 0)
         return ret;
 
+    capture.write(PORT_CAPTURE_TX, frame, sizeof(can_frame_t),
+                  module ? module->rackTime.get() : 0);
     return 0;
 }
 
 int CanPort::recv(can_frame_t *recv_frame, rack_time_t *timestamp)
 {
     int ret;
+    rack_time_t time;
+
+    // one capture record per frame
+    if (capture.isReplay())
+    {
+        ret = capture.read(recv_frame, sizeof(can_frame_t), &time, rxTimeout);
+        if (ret < 0)
+            return ret;
+
+        if (ret != sizeof(can_frame_t))
+        {
+            capture.clean();
+            return -EIO;
+        }
+
+        if (timestamp)
+            *timestamp = time;
+
+        return 0;
+    }
 
     ret = read(fd, recv_frame, sizeof(can_frame_t));
     if (ret < 0)
         return ret;
 
+    time = module->rackTime.get();
+    capture.write(PORT_CAPTURE_RX, recv_frame, sizeof(can_frame_t), time);
+
     if (timestamp)
     {
-        *timestamp = module->rackTime.get();
+        *timestamp = time;
     }
 
     return 0;
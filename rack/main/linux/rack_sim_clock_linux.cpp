@@ -0,0 +1,612 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#include <main/rack_sim_clock.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+typedef struct
+{
+    int32_t             pid;                // 0: free slot
+    int32_t             waiting;
+    uint64_t            deadline;           // virtual wakeup time, 0: none
+} rack_sim_clock_task;
+
+typedef struct
+{
+    int32_t             pid;                // 0: free slot
+    uint32_t            addr;
+    int32_t             msgNum;             // messages on their way
+} rack_sim_clock_mbx;
+
+typedef struct
+{
+    uint32_t            magic;
+    int32_t             stopped;
+    pthread_mutex_t     mtx;
+    pthread_cond_t      cond;
+    uint64_t            time;               // virtual time in ns
+    uint64_t            generation;         // counts the task state changes
+    int32_t             taskNum;
+    int32_t             waitNum;
+    int32_t             msgNum;             // messages on their way to all mailboxes
+    int32_t             mbxTop;             // mailbox slots in use are below
+    rack_sim_clock_task task[RACK_SIM_CLOCK_TASK_MAX];
+    rack_sim_clock_mbx  mbx[RACK_SIM_CLOCK_MBX_MAX];
+} rack_sim_clock_shm;
+
+static rack_sim_clock_shm   *simShm     = NULL;
+static int                  simEnabled  = 0;
+static pthread_once_t       simOnce     = PTHREAD_ONCE_INIT;
+static pthread_key_t        simKey;
+static __thread int         simSlot     = -1;
+static uint64_t             simCleanupTime = 0;
+
+static uint64_t simGetRealNano(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000llu + (uint64_t)ts.tv_nsec;
+}
+
+static void simLock(void)
+{
+    // a task that died while holding the lock leaves a consistent state
+    if (pthread_mutex_lock(&simShm->mtx) == EOWNERDEAD)
+    {
+        pthread_mutex_consistent(&simShm->mtx);
+    }
+}
+
+static void simUnlock(void)
+{
+    pthread_mutex_unlock(&simShm->mtx);
+}
+
+// lock held
+static void simFreeSlot(int slot)
+{
+    rack_sim_clock_task *p_task = &simShm->task[slot];
+
+    if (p_task->waiting)
+    {
+        simShm->waitNum--;
+    }
+    p_task->pid      = 0;
+    p_task->waiting  = 0;
+    p_task->deadline = 0;
+    simShm->taskNum--;
+    simShm->generation++;
+}
+
+// lock held
+static void simFreeMbx(int slot)
+{
+    rack_sim_clock_mbx *p_mbx = &simShm->mbx[slot];
+
+    simShm->msgNum -= p_mbx->msgNum;
+    p_mbx->pid      = 0;
+    p_mbx->addr     = 0;
+    p_mbx->msgNum   = 0;
+    simShm->generation++;
+}
+
+// lock held
+static int simFindMbx(uint32_t address)
+{
+    int i;
+
+    for (i = 0; i < simShm->mbxTop; i++)
+    {
+        if (simShm->mbx[i].pid && (simShm->mbx[i].addr == address))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// destructor of the thread specific slot
+static void simTaskExit(void *arg)
+{
+    int slot = (int)(long)arg - 1;
+
+    simLock();
+    if (simShm->task[slot].pid == getpid())
+    {
+        simFreeSlot(slot);
+    }
+    simUnlock();
+}
+
+// frees the slots of all tasks of the process, the clock would wait for them
+static void simProcessExit(void)
+{
+    int i;
+
+    simLock();
+    for (i = 0; i < RACK_SIM_CLOCK_TASK_MAX; i++)
+    {
+        if (simShm->task[i].pid == getpid())
+        {
+            simFreeSlot(i);
+        }
+    }
+    for (i = 0; i < simShm->mbxTop; i++)
+    {
+        if (simShm->mbx[i].pid == getpid())
+        {
+            simFreeMbx(i);
+        }
+    }
+    simUnlock();
+}
+
+static void simAttach(void)
+{
+    rack_sim_clock_shm  *p_shm;
+    char                *name;
+    int                 fd;
+
+    name = getenv(RACK_SIM_CLOCK_ENV);
+    if (!name || !name[0])
+    {
+        return;
+    }
+
+    fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+    {
+        printf("RackSimClock: can't open clock \"%s\" (%s), using the system clock\n",
+               name, strerror(errno));
+        return;
+    }
+
+    p_shm = (rack_sim_clock_shm *)mmap(NULL, sizeof(rack_sim_clock_shm),
+                                       PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if ((p_shm == MAP_FAILED) || (p_shm->magic != RACK_SIM_CLOCK_MAGIC))
+    {
+        printf("RackSimClock: \"%s\" is no clock, using the system clock\n", name);
+        if (p_shm != MAP_FAILED)
+        {
+            munmap(p_shm, sizeof(rack_sim_clock_shm));
+        }
+        return;
+    }
+
+    if (pthread_key_create(&simKey, simTaskExit))
+    {
+        munmap(p_shm, sizeof(rack_sim_clock_shm));
+        return;
+    }
+
+    simShm     = p_shm;
+    simEnabled = 1;
+
+    atexit(simProcessExit);
+}
+
+// lock held
+static void simRegister(void)
+{
+    int i;
+
+    for (i = 0; i < RACK_SIM_CLOCK_TASK_MAX; i++)
+    {
+        if (simShm->task[i].pid == 0)
+        {
+            simShm->task[i].pid      = getpid();
+            simShm->task[i].waiting  = 0;
+            simShm->task[i].deadline = 0;
+            simShm->taskNum++;
+            simShm->generation++;
+
+            simSlot = i;
+            pthread_setspecific(simKey, (void *)(long)(i + 1));
+            return;
+        }
+    }
+
+    printf("RackSimClock: more than %d tasks, the task runs without lockstep\n",
+           RACK_SIM_CLOCK_TASK_MAX);
+    simSlot = RACK_SIM_CLOCK_TASK_MAX;
+}
+
+int RackSimClock::isEnabled(void)
+{
+    pthread_once(&simOnce, simAttach);
+    return simEnabled;
+}
+
+uint64_t RackSimClock::getNano(void)
+{
+    return __atomic_load_n(&simShm->time, __ATOMIC_ACQUIRE);
+}
+
+void RackSimClock::waitBegin(uint64_t deadline)
+{
+    rack_sim_clock_task *p_task;
+
+    simLock();
+
+    if (simSlot < 0)
+    {
+        simRegister();
+    }
+
+    if (simSlot < RACK_SIM_CLOCK_TASK_MAX)
+    {
+        p_task = &simShm->task[simSlot];
+        if (!p_task->waiting)
+        {
+            p_task->waiting  = 1;
+            p_task->deadline = deadline;
+            simShm->waitNum++;
+            simShm->generation++;
+        }
+    }
+
+    simUnlock();
+}
+
+void RackSimClock::waitEnd(void)
+{
+    rack_sim_clock_task *p_task;
+
+    if ((simSlot < 0) || (simSlot >= RACK_SIM_CLOCK_TASK_MAX))
+    {
+        return;
+    }
+
+    simLock();
+
+    p_task = &simShm->task[simSlot];
+    if (p_task->waiting)
+    {
+        p_task->waiting  = 0;
+        p_task->deadline = 0;
+        simShm->waitNum--;
+        simShm->generation++;
+    }
+
+    simUnlock();
+}
+
+void RackSimClock::mbxCreate(uint32_t address)
+{
+    int i;
+
+    simLock();
+
+    i = simFindMbx(address);
+    if (i >= 0)
+    {
+        simFreeMbx(i);
+    }
+
+    for (i = 0; i < RACK_SIM_CLOCK_MBX_MAX; i++)
+    {
+        if (simShm->mbx[i].pid == 0)
+        {
+            simShm->mbx[i].pid    = getpid();
+            simShm->mbx[i].addr   = address;
+            simShm->mbx[i].msgNum = 0;
+            if (i >= simShm->mbxTop)
+            {
+                simShm->mbxTop = i + 1;
+            }
+            break;
+        }
+    }
+
+    simUnlock();
+
+    if (i == RACK_SIM_CLOCK_MBX_MAX)
+    {
+        printf("RackSimClock: more than %d mailboxes, the messages of %x are not counted\n",
+               RACK_SIM_CLOCK_MBX_MAX, address);
+    }
+}
+
+void RackSimClock::mbxRemove(uint32_t address)
+{
+    int i;
+
+    simLock();
+    i = simFindMbx(address);
+    if (i >= 0)
+    {
+        simFreeMbx(i);
+    }
+    simUnlock();
+}
+
+void RackSimClock::mbxClean(uint32_t address)
+{
+    int i;
+
+    simLock();
+    i = simFindMbx(address);
+    if (i >= 0)
+    {
+        simShm->msgNum          -= simShm->mbx[i].msgNum;
+        simShm->mbx[i].msgNum    = 0;
+        simShm->generation++;
+    }
+    simUnlock();
+}
+
+void RackSimClock::msgSend(uint32_t dest)
+{
+    int i;
+
+    simLock();
+    i = simFindMbx(dest);
+    if (i >= 0)
+    {
+        simShm->mbx[i].msgNum++;
+        simShm->msgNum++;
+        simShm->generation++;
+    }
+    simUnlock();
+}
+
+void RackSimClock::msgReceive(uint32_t address)
+{
+    rack_sim_clock_task *p_task;
+    int                 i;
+
+    simLock();
+
+    // a message that was sent before the mailbox was cleaned isn't counted
+    i = simFindMbx(address);
+    if ((i >= 0) && (simShm->mbx[i].msgNum > 0))
+    {
+        simShm->mbx[i].msgNum--;
+        simShm->msgNum--;
+        simShm->generation++;
+    }
+
+    // the task runs before the message is no longer counted
+    if ((simSlot >= 0) && (simSlot < RACK_SIM_CLOCK_TASK_MAX))
+    {
+        p_task = &simShm->task[simSlot];
+        if (p_task->waiting)
+        {
+            p_task->waiting  = 0;
+            p_task->deadline = 0;
+            simShm->waitNum--;
+            simShm->generation++;
+        }
+    }
+
+    simUnlock();
+}
+
+int RackSimClock::sleepUntil(uint64_t date)
+{
+    int ret = 0;
+
+    if (getNano() >= date)
+    {
+        return 0;
+    }
+
+    waitBegin(date);
+
+    simLock();
+    while ((simShm->time < date) && !simShm->stopped)
+    {
+        pthread_cond_wait(&simShm->cond, &simShm->mtx);
+    }
+    if (simShm->stopped)
+    {
+        ret = -EINTR;
+    }
+    simUnlock();
+
+    waitEnd();
+    return ret;
+}
+
+//
+// clock master
+//
+
+int RackSimClock::create(const char *name, uint64_t time)
+{
+    rack_sim_clock_shm  *p_shm;
+    pthread_mutexattr_t mattr;
+    pthread_condattr_t  cattr;
+    int                 fd;
+
+    shm_unlink(name);
+
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+
+    if (ftruncate(fd, sizeof(rack_sim_clock_shm)))
+    {
+        close(fd);
+        shm_unlink(name);
+        return -errno;
+    }
+
+    p_shm = (rack_sim_clock_shm *)mmap(NULL, sizeof(rack_sim_clock_shm),
+                                       PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p_shm == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return -ENOMEM;
+    }
+
+    memset(p_shm, 0, sizeof(rack_sim_clock_shm));
+
+    pthread_mutexattr_init(&mattr);
+    pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&mattr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&p_shm->mtx, &mattr);
+    pthread_mutexattr_destroy(&mattr);
+
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&p_shm->cond, &cattr);
+    pthread_condattr_destroy(&cattr);
+
+    p_shm->time = time;
+    __atomic_store_n(&p_shm->magic, RACK_SIM_CLOCK_MAGIC, __ATOMIC_RELEASE);
+
+    simShm = p_shm;
+    return 0;
+}
+
+void RackSimClock::destroy(const char *name)
+{
+    if (!simShm)
+    {
+        return;
+    }
+
+    simLock();
+    simShm->stopped = 1;
+    pthread_cond_broadcast(&simShm->cond);
+    simUnlock();
+
+    shm_unlink(name);
+}
+
+int RackSimClock::advance(int taskMin, uint64_t settle_ns)
+{
+    struct timespec ts;
+    uint64_t        generation, next, now;
+    int             i;
+
+    if (!simShm)
+    {
+        return -EINVAL;
+    }
+
+    simLock();
+
+    // free the slots of dead processes, they would stop the clock
+    now = simGetRealNano();
+    if ((simShm->waitNum < simShm->taskNum) && (now - simCleanupTime > 100000000llu))
+    {
+        simCleanupTime = now;
+        for (i = 0; i < RACK_SIM_CLOCK_TASK_MAX; i++)
+        {
+            if ((simShm->task[i].pid != 0) &&
+                (kill(simShm->task[i].pid, 0) < 0) && (errno == ESRCH))
+            {
+                simFreeSlot(i);
+            }
+        }
+        for (i = 0; i < simShm->mbxTop; i++)
+        {
+            if ((simShm->mbx[i].pid != 0) &&
+                (kill(simShm->mbx[i].pid, 0) < 0) && (errno == ESRCH))
+            {
+                simFreeMbx(i);
+            }
+        }
+    }
+
+    if ((simShm->taskNum == 0) || (simShm->taskNum < taskMin) ||
+        (simShm->waitNum < simShm->taskNum) || (simShm->msgNum > 0))
+    {
+        simUnlock();
+        return 0;
+    }
+    generation = simShm->generation;
+
+    simUnlock();
+
+    // messages from outside of the simulation wake up their receivers
+    // within the settle time
+    ts.tv_sec  = settle_ns / 1000000000llu;
+    ts.tv_nsec = settle_ns % 1000000000llu;
+    nanosleep(&ts, NULL);
+
+    simLock();
+
+    if ((simShm->generation != generation) || (simShm->waitNum < simShm->taskNum) ||
+        (simShm->msgNum > 0))
+    {
+        simUnlock();
+        return 0;
+    }
+
+    next = 0;
+    for (i = 0; i < RACK_SIM_CLOCK_TASK_MAX; i++)
+    {
+        if (simShm->task[i].pid && simShm->task[i].waiting && simShm->task[i].deadline &&
+            ((next == 0) || (simShm->task[i].deadline < next)))
+        {
+            next = simShm->task[i].deadline;
+        }
+    }
+
+    if (next == 0)
+    {
+        simUnlock();
+        return -EDEADLK;
+    }
+
+    // a mailbox wait has not noticed its timeout yet
+    if (next <= simShm->time)
+    {
+        simUnlock();
+        return 0;
+    }
+
+    __atomic_store_n(&simShm->time, next, __ATOMIC_RELEASE);
+    simShm->generation++;
+    pthread_cond_broadcast(&simShm->cond);
+
+    simUnlock();
+    return 1;
+}
+
+void RackSimClock::getTaskNum(int *taskNum, int *waitNum)
+{
+    simLock();
+    *taskNum = simShm->taskNum;
+    *waitNum = simShm->waitNum;
+    simUnlock();
+}
+
+int RackSimClock::getMsgNum(void)
+{
+    int msgNum;
+
+    simLock();
+    msgNum = simShm->msgNum;
+    simUnlock();
+    return msgNum;
+}
@@ -16,10 +16,13 @@
  */
 
 #include <main/rack_task.h>
+#include <main/rack_sim_clock.h>
 
 #include <errno.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <time.h>
+#include <sys/time.h>
 
 RackTask::RackTask()
 {
@@ -60,14 +63,42 @@ int RackTask::setMode(int clrmask, int setmask, int *mode_r)
 
 int RackTask::sleep(uint64_t delay)
 {
+    if (RackSimClock::isEnabled())
+    {
+        return RackSimClock::sleepUntil(RackSimClock::getNano() + delay);
+    }
+
     // convert delay in nano seconds to usleep in micro seconds
     return usleep(delay / (uint64_t)1000);
 }
 
 int RackTask::sleepUntil(int64_t date)
 {
-    printf("Function RackTask::sleepUnitl() is not jet implemented\n");
-    return -1;
+    struct timeval  now;
+    struct timespec ts;
+    int             ret;
+
+    if (RackSimClock::isEnabled())
+    {
+        if ((uint64_t)date < RackSimClock::getNano())
+        {
+            return -ETIMEDOUT;
+        }
+        return RackSimClock::sleepUntil(date);
+    }
+
+    // the RACK time of linux is the system time
+    gettimeofday(&now, NULL);
+    if (date < (int64_t)now.tv_sec * 1000000000ll + (int64_t)now.tv_usec * 1000ll)
+    {
+        return -ETIMEDOUT;
+    }
+
+    ts.tv_sec  = date / 1000000000ll;
+    ts.tv_nsec = date % 1000000000ll;
+
+    ret = clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &ts, NULL);
+    return -ret;
 }
 
 int RackTask::enableRealtimeMode()
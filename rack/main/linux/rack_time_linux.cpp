@@ -19,6 +19,7 @@
  */
 
 #include <main/rack_time.h>
+#include <main/rack_sim_clock.h>
 
 #include <sys/time.h>
 #include <stdio.h>
@@ -57,6 +58,12 @@ uint64_t RackTime::getNano(void)
     struct timeval time;
     uint64_t nanoTime;
 
+    // virtual time of a lockstep simulation
+    if (RackSimClock::isEnabled())
+    {
+        return RackSimClock::getNano();
+    }
+
     gettimeofday(&time, NULL);
 
     nanoTime = (uint64_t) time.tv_sec * 1000000000llu + (uint64_t) time.tv_usec * 1000llu;
@@ -77,6 +77,8 @@ SerialPort::SerialPort()
 {
     module = NULL;
     fd = -1;
+    rxTimeout = RTSER_DEF_TIMEOUT;
+    replayTime = 0;
 }
 
 SerialPort::~SerialPort()
@@ -96,15 +98,34 @@ int SerialPort::open(int dev, const rtser_config *config, RackModule *module)
 {
     int ret;
 
-    if (fd != -1)
+    char name[20];
+
+    if ((fd != -1) || (capture.isReplay()))
     {
         // file is open
         return -EBUSY;
     }
 
+    snprintf(name, 20, "serial%i", dev);
+
+    ret = capture.init(name, module);
+    if (ret < 0)
+    {
+        return ret;
+    }
+
+    // replay, the device is not needed
+    if (ret == PORT_CAPTURE_REPLAY)
+    {
+        this->module = module;
+        rxTimeout    = config->rx_timeout;
+        return 0;
+    }
+
     ret = open_serial_dev(dev);
     if (ret < 0)
     {
+        capture.close();
         return ret;
     }
 
@@ -118,6 +139,8 @@ int SerialPort::open(int dev, const rtser_config *config, RackModule *module)
 
 int SerialPort::close(void)
 {
+    capture.close();
+
     if(fd != -1)
         close_serial_dev(fd);
 
@@ -131,6 +154,12 @@ int SerialPort::setConfig(const rtser_config *config)
 {
 	struct termios options;
 
+    if (capture.isReplay())
+    {
+        rxTimeout = config->rx_timeout;
+        return 0;
+    }
+
 	// Get the current options for the port...
 	tcgetattr(fd, &options);
 
@@ -168,6 +197,11 @@ int SerialPort::setBaudrate(int baudrate)
 {
 	struct termios options;
 
+    if (capture.isReplay())
+    {
+        return 0;
+    }
+
 	// Get the current options for the port...
 	tcgetattr(fd, &options);
 
@@ -228,6 +262,13 @@ int SerialPort::setRecvTimeout(int64_t timeout)
 {
 	struct termios options;
 
+    rxTimeout = timeout;
+
+    if (capture.isReplay())
+    {
+        return 0;
+    }
+
 	// Get the current options for the port...
 	tcgetattr(fd, &options);
 
@@ -278,8 +319,19 @@ int SerialPort::send(const void* data, int dataLen)
 {
     int ret;
 
+    // the replayed device does not get the commands
+    if (capture.isReplay())
+    {
+        return 0;
+    }
+
     ret = write(fd, data, dataLen);
 
+    if (ret > 0)
+    {
+        capture.write(PORT_CAPTURE_TX, data, ret, module ? module->rackTime.get() : 0);
+    }
+
     if (ret != dataLen)
     {
         return -EFAULT;
@@ -294,10 +346,34 @@ int SerialPort::recv(void *data, int dataLen)
     int ret;
     int dataRead = 0;
 
+    if (capture.isReplay())
+    {
+        do
+        {
+            ret = capture.read((char*)data + dataRead, (dataLen - dataRead), &replayTime,
+                               rxTimeout);
+            if (ret < 0)
+            {
+                return ret;
+            }
+
+            dataRead += ret;
+        }
+        while(dataRead < dataLen);
+
+        return 0;
+    }
+
     do
     {
         ret = read(fd, (char*)data + dataRead, (dataLen - dataRead));
 
+        if (ret > 0)
+        {
+            capture.write(PORT_CAPTURE_RX, (char*)data + dataRead, ret,
+                          module ? module->rackTime.get() : 0);
+        }
+
         if (ret == 0)
         {
             return -ETIMEDOUT;      // timeout
@@ -323,7 +399,8 @@ int SerialPort::recv(void *data, int dataLen, rack_time_t *timestamp)
 
     if (timestamp)
     {
-        *timestamp = module->rackTime.get();
+        // replay: timestamp of the last received byte
+        *timestamp = capture.isReplay() ? replayTime : module->rackTime.get();
     }
 
     return ret;
@@ -343,11 +420,73 @@ int SerialPort::recv(void *data, int dataLen, rack_time_t *timestamp, int64_t ti
     return recv(data, dataLen, timestamp);
 }
 
+// receive the available data with the default timeout
+int SerialPort::recvChunk(void *data, int maxLen, rack_time_t *timestamp)
+{
+    rack_time_t time;
+    int         ret;
+
+    if (capture.isReplay())
+    {
+        ret = capture.read(data, maxLen, &replayTime, rxTimeout);
+        if ((ret > 0) && timestamp)
+        {
+            *timestamp = replayTime;
+        }
+        return ret;
+    }
+
+    // returns what is received up to the timeout
+    ret = read(fd, data, maxLen);
+
+    if (ret == 0)
+    {
+        return -ETIMEDOUT;          // timeout
+    }
+    else if (ret < 0)
+    {
+        return ret;                 // IO error
+    }
+
+    time = module ? module->rackTime.get() : 0;
+
+    capture.write(PORT_CAPTURE_RX, data, ret, time);
+
+    if (timestamp)
+    {
+        *timestamp = time;
+    }
+
+    return ret;
+}
+
 int SerialPort::waitEvent(struct rtser_event *event)
 {
     int ret;
     int count = 0;
 
+    if (capture.isReplay())
+    {
+        while((ret = capture.pending()) == 0)
+        {
+            if(count > 100)
+            {
+                event->events = 0;
+                event->rx_pending = 0;
+
+                return -ETIMEDOUT;
+            }
+
+            usleep(10000);  // 10ms
+            count++;
+        }
+
+        event->events = RTSER_EVENT_RXPEND;
+        event->rx_pending = ret;
+
+        return 0;
+    }
+
     while((ret = read(fd, NULL, 0)) == 0)
     {
         if(count > 100)
@@ -382,6 +521,12 @@ int SerialPort::clean(void)
 {
 	struct termios options;
 
+    if (capture.isReplay())
+    {
+        capture.clean();
+        return 0;
+    }
+
 	// flush port
     tcgetattr(fd, &options);
     tcsetattr(fd, TCSAFLUSH, &options);
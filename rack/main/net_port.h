@@ -0,0 +1,281 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __NET_PORT_H__
+#define __NET_PORT_H__
+
+#include <main/rack_time.h>
+#include <main/rack_module.h>
+#include <main/port_capture.h>
+
+#include <netinet/in.h>
+
+// connection types
+#define NET_PORT_TCP                    0
+#define NET_PORT_UDP                    1
+
+// framing types
+#define NET_PORT_FRAME_RAW              0   // data of one receive call
+#define NET_PORT_FRAME_LENGTH           1   // start pattern and length field
+#define NET_PORT_FRAME_DELIMITER        2   // start and end pattern
+
+#define NET_PORT_PATTERN_MAX            8
+#define NET_PORT_MARK_MAX               64
+#define NET_REACTOR_PORT_MAX            8
+
+// connection states
+#define NET_PORT_CLOSED                 0
+#define NET_PORT_CONNECTING             1
+#define NET_PORT_CONNECTED              2
+#define NET_PORT_WAIT_RECONNECT         3
+
+/**
+ * Frame format of a network stream.
+ *
+ * NET_PORT_FRAME_LENGTH: the frame starts with @a start (may be empty). The
+ * frame length is lengthAdd plus the value of the length field at
+ * lengthOffset from the frame start.
+ *
+ * NET_PORT_FRAME_DELIMITER: the frame starts with @a start (may be empty)
+ * and ends with @a end.
+ *
+ * Frames that exceed frameMax are dropped and the extractor searches for
+ * the next start pattern.
+ */
+typedef struct
+{
+    int         type;
+    uint8_t     start[NET_PORT_PATTERN_MAX];
+    int         startLen;
+    uint8_t     end[NET_PORT_PATTERN_MAX];
+    int         endLen;
+    int         lengthOffset;
+    int         lengthSize;                 // 1, 2 or 4 bytes
+    int         lengthBigEndian;
+    int         lengthAdd;
+    int         frameMax;
+} net_port_framing;
+
+/**
+ * A received frame. @a data points into the ring buffer of the port and is
+ * valid until NetPort::releaseFrame() or the next NetPort::recvFrame().
+ */
+typedef struct
+{
+    uint8_t     *data;
+    int         len;
+    rack_time_t recordingTime;              // receive time of the first byte
+} net_port_frame;
+
+typedef struct
+{
+    uint64_t    pos;
+    rack_time_t time;
+} net_port_mark;
+
+class NetReactor;
+
+/**
+ * TCP or UDP connection of a network sensor.
+ *
+ * Received data is read into a ring buffer by a NetReactor and cut into
+ * frames (see net_port_framing). Frames are handed out without copying, only
+ * a frame that wraps around the end of the ring buffer is completed in a
+ * spare area behind it. The receive time of each frame is taken from the
+ * kernel receive timestamp (SO_TIMESTAMPNS) if the socket provides one.
+ *
+ * A TCP connection that is closed by the peer or fails is reopened
+ * automatically. The delay between the attempts doubles from reconnectMin
+ * up to reconnectMax. getConnectCount() tells the driver when it has to
+ * send its initialisation commands again.
+ *
+ * @ingroup main_device_driver
+ */
+class NetPort
+{
+    friend class NetReactor;
+
+    private:
+
+        int                 fd;
+        int                 type;
+        int                 state;
+        int                 error;
+        uint32_t            events;         // registered epoll events
+        int                 registered;
+        struct sockaddr_in  addr;
+        RackModule          *module;
+
+        net_port_framing    framing;
+
+        uint8_t             *buffer;
+        int                 bufferSize;
+        uint64_t            head;           // bytes written into the ring
+        uint64_t            tail;           // bytes released from the ring
+        uint64_t            frameEnd;       // end of the frame handed out
+
+        net_port_mark       mark[NET_PORT_MARK_MAX];
+        int                 markFirst;
+        int                 markNum;
+
+        int64_t             reconnectMin;
+        int64_t             reconnectMax;
+        int64_t             reconnectDelay;
+        uint64_t            reconnectTime;
+        int                 connectCount;
+        uint32_t            dropCount;
+
+        NetReactor          *reactor;
+        NetReactor          *ownReactor;
+
+        int                 connectSocket(void);
+        void                closeSocket(void);
+        void                disconnect(int error);
+        int                 recvData(void);
+        int                 connectDone(void);
+
+        void                addMark(rack_time_t time);
+        rack_time_t         getMarkTime(uint64_t pos, uint64_t *next);
+        int                 getByte(uint64_t pos);
+        int64_t             findPattern(uint64_t pos, const uint8_t *pattern, int len);
+        uint8_t             *getContiguous(uint64_t pos, int len);
+        void                drop(uint64_t pos);
+        int                 extractFrame(net_port_frame *frame);
+        int                 replayData(int64_t timeout_ns);
+
+    public:
+
+        /** capture of the received data, the port name is "net_<ip>_<port>" */
+        PortCapture         capture;
+
+        NetPort();
+        ~NetPort();
+
+        /**
+         * @brief Open a network connection
+         *
+         * TCP connects to @a ip : @a port and waits up to connectTimeout_ns
+         * for the connection. UDP binds to the local @a port and, if @a ip is
+         * not NULL, only accepts datagrams of that sender.
+         *
+         * @param ip IPv4 address of the sensor
+         * @param port Port number
+         * @param type NET_PORT_TCP or NET_PORT_UDP
+         * @param framing Frame format, NULL for NET_PORT_FRAME_RAW
+         * @param bufferSize Size of the ring buffer, at least twice the
+         *                   maximum frame size is recommended
+         * @param connectTimeout_ns Timeout of the first TCP connect
+         * @param module Pointer to the RACK module for the timestamps
+         *
+         * @return 0 on success, otherwise negative error code
+         *
+         * Environments:
+         *
+         * This service can be called from:
+         *
+         * - User-space task (non-RT)
+         *
+         * Rescheduling: possible.
+         */
+        int open(const char *ip, int port, int type, const net_port_framing *framing,
+                 int bufferSize, int64_t connectTimeout_ns, RackModule *module);
+        int close(void);
+
+        int setReconnect(int64_t reconnectMin_ns, int64_t reconnectMax_ns);
+
+        /**
+         * @brief Send data, TCP waits until all data is sent
+         *
+         * May be called from another task than recvFrame().
+         */
+        int send(const void *data, int dataLen);
+
+        /**
+         * @brief Receive the next complete frame
+         *
+         * Releases the previous frame and waits up to timeout_ns for the next
+         * one. Connection errors are handled internally, the port keeps
+         * reconnecting until the timeout expires.
+         *
+         * @return 0 on success, -ETIMEDOUT or another negative error code
+         */
+        int recvFrame(net_port_frame *frame, int64_t timeout_ns);
+
+        /** Release the last frame, the ring buffer space is reused */
+        void releaseFrame(void);
+
+        /** Drop all buffered data, e.g. after a request was repeated */
+        void clean(void);
+
+        int getState(void)
+        {
+            return state;
+        }
+
+        int getConnectCount(void)
+        {
+            return connectCount;
+        }
+
+        uint32_t getDropCount(void)
+        {
+            return dropCount;
+        }
+
+        /** last connection error, negative error code */
+        int getError(void)
+        {
+            return error;
+        }
+};
+
+/**
+ * Epoll reactor of one or more NetPorts.
+ *
+ * poll() waits for the sockets of all ports, reads the received data into
+ * their ring buffers and runs the reconnect timers. A NetPort that is not
+ * added to a reactor uses a private one.
+ *
+ * @ingroup main_device_driver
+ */
+class NetReactor
+{
+    private:
+
+        int         epollFd;
+        NetPort     *port[NET_REACTOR_PORT_MAX];
+        int         portNum;
+
+    public:
+
+        NetReactor();
+        ~NetReactor();
+
+        int  open(void);
+        int  close(void);
+
+        int  add(NetPort *netPort);
+        int  remove(NetPort *netPort);
+
+        /** update the epoll events of a port after a state change */
+        int  update(NetPort *netPort);
+
+        /**
+         * @brief Wait for network events
+         *
+         * @return Number of ports that received data, 0 on timeout or
+         *         negative error code
+         */
+        int  poll(int64_t timeout_ns);
+};
+
+#endif // __NET_PORT_H__
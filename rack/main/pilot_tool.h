@@ -16,15 +16,228 @@
 #ifndef __PILOT_TOOL_H__
 #define __PILOT_TOOL_H__
 
-#include <main/defines/scan_point.h>
 #include <perception/scan2d_proxy.h>
 #include <drivers/chassis_proxy.h>
+#include <main/defines/scan_point.h>
+#include <main/defines/point2d.h>
 
 #define MOVING    0
 #define HOLD      1
 
 #define PILOT_TOOL_REVERSE_SPEED_MAX  -500
 
+#define PILOT_GRID_RANGE_DEFAULT      8000      // mm
+#define PILOT_GRID_CELL_SIZE_DEFAULT  50        // mm
+#define PILOT_GRID_CLEARANCE_MAX      1000000   // mm, no obstacle
+#define PILOT_GRID_ARC_STEP_MIN       10        // mm
+
+/**
+ * Obstacle lookup structure of one scan for the pilot safety checks.
+ *
+ * build() sorts the obstacle points of a scan (all valid points except
+ * landmarks) into a robot centred grid and computes the euclidean distance
+ * transform of the grid. Afterwards the queries don't loop over the scan:
+ *
+ * - getClearance() returns the distance of a position to the next obstacle
+ *   point. The distance transform gives a lower bound in O(1), only
+ *   positions near an obstacle look at the points of the neighbouring cells.
+ * - testRect() tests a rectangle for obstacle points. The inner cells are
+ *   tested with a summed area table in O(1), only the points of the border
+ *   cells are tested one by one. The result equals a loop over all obstacle
+ *   points. The former loop of PilotWallFollowing only tested every second
+ *   point, so testRect() also finds obstacles that loop has skipped.
+ * - testArc() returns the free length of a circular arc (or a line) of a
+ *   given half width and the minimum clearance along it. It steps along the
+ *   arc by the clearance of each position (sphere tracing), so free space is
+ *   crossed in a few steps. The step is at least PILOT_GRID_ARC_STEP_MIN.
+ *
+ * Points outside of the grid range are kept in a list and are only tested
+ * if a query reaches the grid border.
+ *
+ * The coordinates are robot coordinates (x forward, y right, mm), a
+ * positive curve turns right like the radius of the chassis.
+ *
+ * @ingroup main_tools
+ */
+class PilotCollisionGrid
+{
+    private:
+
+        int         range;
+        int         cellSize;
+        int         cellNum;            // cells per axis
+        float       cellDiag;
+        int         pointMax;
+
+        int         *cellStart;         // points of cell i: cellStart[i] .. cellStart[i + 1]
+        point_2d    *cellPoint;
+        int         *occSum;            // summed area table of the occupied cells
+        float       *cellDist;          // distance between cell centres, mm
+
+        point_2d    *outPoint;          // points outside of the grid
+        int         outPointNum;
+        int         pointNum;
+
+        float       *edtF;
+        float       *edtD;
+        float       *edtZ;
+        int         *edtV;
+
+        int         getCell(int x, int y, int *ix, int *iy);
+        int         getBorderDistance(int x, int y);
+        int         getOccupied(int ix0, int iy0, int ix1, int iy1);
+        void        edt(float *f, int n);
+
+    public:
+
+        PilotCollisionGrid();
+        ~PilotCollisionGrid();
+
+        /**
+         * @brief Allocate a grid that covers -range .. range in x and y
+         */
+        int     init(int range, int cellSize);
+        void    cleanup(void);
+
+        /** sort the obstacle points of @a scan into the grid, once per scan */
+        int     build(scan2d_data *scan);
+
+        int     getPointNum(void)
+        {
+            return pointNum;
+        }
+
+        /**
+         * @brief Distance of (x, y) to the next obstacle point
+         *
+         * @return Exact distance if it is less than maxDist, otherwise a
+         *         value >= maxDist (PILOT_GRID_CLEARANCE_MAX without points)
+         */
+        int     getClearance(int x, int y, int maxDist);
+
+        /**
+         * @brief Test the rectangle (x, y) .. (x + xSize, y + ySize)
+         *
+         * The sizes may be negative.
+         *
+         * @return 1 if an obstacle point is inside, otherwise 0
+         */
+        int     testRect(int x, int y, int xSize, int ySize);
+
+        /**
+         * @brief Free length of an arc
+         *
+         * Follows the arc with curve @a curve from the robot position up to
+         * @a length and stops at the first position closer than
+         * @a halfWidth to an obstacle point.
+         *
+         * @param minClearance Returns the minimum clearance along the free
+         *                     part of the arc, may be NULL
+         *
+         * @return Free length in mm, @a length if the arc is free
+         */
+        int     testArc(float curve, int length, int halfWidth, int *minClearance);
+};
+
+#define PILOT_WINDOW_SPEED_NUM_DEFAULT    7
+#define PILOT_WINDOW_OMEGA_NUM_DEFAULT    15
+#define PILOT_WINDOW_CANDIDATE_MAX        1024
+
+/**
+ * Parameter of the dynamic window search, see PilotDynamicWindow.
+ * PilotDynamicWindow::init() sets the defaults.
+ */
+typedef struct
+{
+    int         speedNum;               // speed samples in the window
+    int         omegaNum;               // omega samples in the window
+    int         arcMax;                 // arc tests per cycle (time budget)
+    int         lookahead;              // [mm] tested arc length
+    int         clearanceMax;           // [mm] larger side clearance isn't rewarded
+    float       omegaAcc;               // [rad/s^2] 0: accMax / minTurningRadius
+    float       predictTime;            // [s] heading prediction
+    float       weightClearance;
+    float       weightHeading;
+    float       weightProgress;
+} pilot_window_param;
+
+/**
+ * Dynamic window search in the velocity space.
+ *
+ * evaluate() samples forward speeds and angular velocities that the chassis
+ * can reach within the next cycle (accMax, omegaAcc, speed and omega limits,
+ * minTurningRadius) and scores each circular trajectory by
+ *
+ * - clearance: free length along the arc and side clearance to the next
+ *   obstacle point (PilotCollisionGrid::testArc())
+ * - heading:   angle between the goal direction and the predicted heading
+ *   after predictTime
+ * - progress:  speed
+ *
+ * A candidate is only admissible if the chassis can stop within the free
+ * length of its arc. The candidates are kept in plain arrays and the heading
+ * and progress scores of all candidates are computed in one pass. The arc
+ * tests are the expensive part, they run in the order of the best possible
+ * score and stop as soon as no remaining candidate can win or arcMax arcs
+ * are tested. So the time of one cycle is bounded and the result is
+ * deterministic.
+ *
+ * Coordinates and signs are those of the chassis: positive omega and curve
+ * turn clockwise (to the right), the goal angle is positive to the right.
+ *
+ * @ingroup main_tools
+ */
+class PilotDynamicWindow
+{
+    private:
+
+        int         candidateNum;
+
+        float       *candSpeed;         // [mm/s]
+        float       *candOmega;         // [rad/s]
+        float       *candBound;         // heading + progress + max. clearance score
+        float       *candScore;
+        int         *candFree;          // [mm] free arc length
+        int         *candOrder;
+
+        int         arcNum;
+
+    public:
+
+        pilot_window_param  param;
+
+        PilotDynamicWindow();
+        ~PilotDynamicWindow();
+
+        int     init(void);
+        void    cleanup(void);
+
+        /**
+         * @brief Choose the velocity of the next cycle
+         *
+         * @param grid Collision grid of the current scan
+         * @param chasParam Chassis parameter
+         * @param speed Current speed (in) and new speed (out) [mm/s]
+         * @param omega Current angular velocity (in) and new one (out) [rad/s]
+         * @param speedMax Speed limit of the pilot [mm/s]
+         * @param omegaMax Angular velocity limit of the pilot [rad/s]
+         * @param goalAngle Goal direction in robot coordinates [rad]
+         * @param cycleTime Time until the next command [s]
+         *
+         * @return 0 on success, -EAGAIN if no trajectory is admissible and
+         *         the robot has to stop (@a speed and @a omega are 0)
+         */
+        int     evaluate(PilotCollisionGrid *grid, chassis_param_data *chasParam,
+                         int *speed, float *omega, int speedMax, float omegaMax,
+                         float goalAngle, float cycleTime);
+
+        /** number of arcs tested by the last evaluate() */
+        int     getArcNum(void)
+        {
+            return arcNum;
+        }
+};
+
 /**
  * Converts radius to curviness
  * @ingroup main_tools
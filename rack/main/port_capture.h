@@ -0,0 +1,203 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __PORT_CAPTURE_H__
+#define __PORT_CAPTURE_H__
+
+#include <stdio.h>
+#include <sys/uio.h>
+
+#include <main/rack_time.h>
+#include <main/rack_module.h>
+
+// capture modes
+#define PORT_CAPTURE_OFF            0
+#define PORT_CAPTURE_RECORD         1
+#define PORT_CAPTURE_REPLAY         2
+
+// record directions
+#define PORT_CAPTURE_RX             0
+#define PORT_CAPTURE_TX             1
+
+#define PORT_CAPTURE_MAGIC          0x50414352      // "RCAP"
+#define PORT_CAPTURE_VERSION        1
+#define PORT_CAPTURE_RECORD_MAX     65536
+
+// timeouts of PortCapture::read(), same as the serial port timeouts
+#define PORT_CAPTURE_TIMEOUT_INFINITE   0
+#define PORT_CAPTURE_TIMEOUT_NONE       (-1)
+
+// environment variables, see PortCapture::init()
+#define PORT_CAPTURE_ENV_RECORD     "RACK_CAPTURE"
+#define PORT_CAPTURE_ENV_REPLAY     "RACK_REPLAY"
+#define PORT_CAPTURE_ENV_SPEED      "RACK_REPLAY_SPEED"
+#define PORT_CAPTURE_ENV_LOOP       "RACK_REPLAY_LOOP"
+
+typedef struct
+{
+    uint32_t    magic;
+    uint32_t    version;
+    char        name[64];                   // port name, e.g. "serial0"
+} __attribute__((packed)) port_capture_header;
+
+typedef struct
+{
+    uint64_t    time;                       // monotonic receive time in ns
+    rack_time_t recordingTime;              // timestamp handed to the driver
+    uint16_t    dir;                        // PORT_CAPTURE_RX or PORT_CAPTURE_TX
+    uint16_t    reserved;
+    uint32_t    len;                        // data bytes behind the record
+} __attribute__((packed)) port_capture_record;
+
+typedef struct
+{
+    uint32_t    recordNum;                  // received records handed out
+    uint64_t    byteNum;
+    uint64_t    duration;                   // ns from the first to the last record
+    uint64_t    latencySum;                 // ns from due time to consumed
+    uint64_t    latencyMax;
+    uint32_t    loopNum;
+} port_capture_stats;
+
+/**
+ * Raw byte capture and replay of a device port.
+ *
+ * In record mode the port writes every received chunk (and every sent
+ * command) with its monotonic arrival time and its RACK timestamp into a
+ * capture file. In replay mode the port does not touch the device. The
+ * received chunks of the capture file are handed to the driver through the
+ * same interface, at recorded speed (scaled by @a speed) or as fast as
+ * possible (@a speed = 0). Sent data is discarded. So the parser of a
+ * driver can be benchmarked, regression tested and fuzzed without the
+ * sensor.
+ *
+ * The replayed timestamps keep the recorded distances and start at the
+ * RACK time of the replay start. At the end of the file the replay prints
+ * the parse statistics (throughput and latency from the due time of a
+ * record until the driver consumed it) to stdout.
+ *
+ * SerialPort, CanPort and NetPort call init() in their open() function.
+ * It switches the port into record or replay mode if the environment
+ * variable RACK_CAPTURE or RACK_REPLAY names a directory; the capture file
+ * is @<directory@>/@<port name@>.cap. RACK_REPLAY_SPEED sets the replay
+ * speed (default 1.0) and RACK_REPLAY_LOOP=1 restarts the replay at the end
+ * of the file.
+ *
+ * @ingroup main_device_driver
+ */
+class PortCapture
+{
+    private:
+
+        FILE                *file;
+        int                 mode;
+        int                 modeReq;        // set by record() / replay() before open
+        char                fileName[256];
+        float               speed;
+        int                 loop;
+        RackModule          *module;
+
+        // replay
+        uint8_t             *data;
+        port_capture_record rec;
+        uint32_t            recPos;
+        int                 recValid;
+        long                dataStart;      // file position of the first record
+        uint64_t            firstTime;
+        rack_time_t         firstRecordingTime;
+        uint64_t            startTime;
+        uint64_t            recDue;
+        rack_time_t         timeOffset;
+        int                 eof;
+
+        port_capture_stats  stats;
+        uint64_t            statsStart;
+
+        int                 openFile(const char *name);
+        int                 readRecord(void);
+        void                printStats(void);
+
+    public:
+
+        PortCapture();
+        ~PortCapture();
+
+        /**
+         * @brief Record the port into @a fileName, call before open()
+         */
+        int record(const char *fileName);
+
+        /**
+         * @brief Replay the capture file @a fileName, call before open()
+         *
+         * @param speed Replay speed relative to the recording, 0 replays
+         *              as fast as possible
+         * @param loop Restart at the end of the file
+         */
+        int replay(const char *fileName, float speed, int loop);
+
+        /**
+         * @brief Open the capture file of the port @a name
+         *
+         * Uses the file set by record() or replay() or the environment
+         * variables. Called by the port in its open() function.
+         *
+         * @return PORT_CAPTURE_OFF, PORT_CAPTURE_RECORD, PORT_CAPTURE_REPLAY
+         *         or negative error code
+         */
+        int init(const char *name, RackModule *module);
+        int close(void);
+
+        int getMode(void)
+        {
+            return mode;
+        }
+
+        int isReplay(void)
+        {
+            return (mode == PORT_CAPTURE_REPLAY);
+        }
+
+        /** record mode: write received or sent data */
+        void write(int dir, const void *data, int dataLen, rack_time_t recordingTime);
+
+        /** record mode: write one record that is split into several buffers */
+        void write(int dir, const struct iovec *iov, int iovNum, rack_time_t recordingTime);
+
+        /**
+         * @brief Replay mode: read received data
+         *
+         * Copies up to @a dataLen bytes of the current received record and
+         * waits until the record is due. A record that is longer than
+         * @a dataLen is continued by the next call.
+         *
+         * @param timeout_ns Receive timeout, PORT_CAPTURE_TIMEOUT_INFINITE or
+         *                   PORT_CAPTURE_TIMEOUT_NONE
+         *
+         * @return Number of bytes, -ETIMEDOUT if no record is due within
+         *         the timeout or at the end of the file
+         */
+        int read(void *data, int dataLen, rack_time_t *recordingTime, int64_t timeout_ns);
+
+        /** replay mode: bytes of the current record that are due */
+        int pending(void);
+
+        /** replay mode: bytes left of a record that is partly read */
+        int remaining(void);
+
+        /** replay mode: drop the rest of the current record */
+        void clean(void);
+
+        void getStats(port_capture_stats *stats);
+};
+
+#endif // __PORT_CAPTURE_H__
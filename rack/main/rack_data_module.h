@@ -53,12 +53,16 @@ class ListenerEntry {
         uint32_t        reduction;
         RackMessage     msgInfo;
         uint32_t        getNextData;
+        uint32_t        overflowCount;  // of the listener mailbox, last seen
+        uint32_t        lostCount;      // sends failed with -ENOSPC or -ETIMEDOUT
 
         // Konstruktor
         ListenerEntry()
         {
             reduction = 0;
             getNextData = 0;
+            overflowCount = 0;
+            lostCount = 0;
         };
 
         // Destruktor
@@ -92,21 +96,47 @@ class RackDataModule : public RackModule
         uint32_t            dataBufferMaxEntries;
         uint32_t            dataBufferMaxDataSize;  // per slot !!!
         uint32_t            dataBufferMaxListener;
+        uint32_t            dataBufferMaxReduction; // limit of dataBufferOverflow()
         int16_t             dataBufferSendType;
         RackMailbox*        dataBufferSendMbx;
         rack_time_t         dataBufferPeriodTime;
         rack_time_t         dataBufferSleepTime;
 
         rack_time_t         getRecordingTime(void *pData);
+        int                 getDataBufferOldestIndex(void);
         int                 getDataBufferIndex(rack_time_t time);
         virtual int         sendDataReply(rack_time_t time, RackMessage *msgInfo);
 
+        /**
+         * @brief Reply to MSG_GET_MULTI_DATA
+         *
+         * Sends the entries of all timestamps of @a p_get in one
+         * MSG_MULTI_DATA reply (see rack_multi_data). Fails as a whole if
+         * one timestamp is out of the data buffer or with -EMSGSIZE if the
+         * reply exceeds the buffer of the receiver or RACK_MULTI_DATA_MSG_MAX.
+         */
+        virtual int         sendMultiDataReply(rack_get_multi_data *p_get,
+                                               RackMessage *msgInfo);
+
         int                 addListener(rack_time_t periodTime, uint32_t getNextData, uint32_t destMbxAdr,
                                         RackMessage *msgInfo);
         void                removeListener(uint32_t destMbxAdr);
         void                removeAllListener(void);
         rack_time_t         getListenerPeriodTime(uint32_t dataMbx);
 
+        /**
+         * @brief A listener can't keep up with the continuous data
+         *
+         * Called by putDataBufferWorkSpace() if the in-process mailbox of
+         * the listener @a destMbxAdr overflowed (see
+         * RackMailbox::setOverflowPolicy()) or a send to it failed with
+         * -ENOSPC or -ETIMEDOUT because its TIMS mailbox is full. The
+         * default doubles the reduction up to dataBufferMaxReduction.
+         *
+         * @return new reduction of the listener, 0 removes the listener
+         */
+        virtual uint32_t    dataBufferOverflow(uint32_t destMbxAdr, uint32_t reduction);
+
         friend void         cmd_task_proc(void* arg);
 
   public:
@@ -0,0 +1,73 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __RACK_HOST_H__
+#define __RACK_HOST_H__
+
+class RackModule;
+
+/**
+ * Hosted mode of RACK modules.
+ *
+ * The RackHost program (tools/rack_host) loads several modules into one
+ * process. Each module is built as a plugin and its main() function runs in
+ * an own thread of the host, the module creates its command and data task as
+ * usual. In hosted mode
+ *
+ * - RackModule::moduleInit() does not install the signal handlers, the host
+ *   handles SIGINT and SIGTERM and stops the modules one by one,
+ * - RackModule::run() reports the started module to the host and waits until
+ *   the host stops it instead of waiting for a signal,
+ * - messages between mailboxes of the process bypass TIMS
+ *   (see RackMailbox::setLocalDelivery()).
+ *
+ * The host starts the modules one after the other. The argument tables, the
+ * mailbox list and the module name are process global and are only used
+ * during the start and the cleanup of a module.
+ *
+ * Linux only.
+ *
+ * @ingroup main_common
+ */
+class RackHost
+{
+    public:
+
+        /** enable the hosted mode, before the first module is loaded */
+        static void enable(int localDelivery);
+
+        static int  isEnabled(void);
+
+        /** restore the default values of the module arguments */
+        static void resetArgs(void);
+
+        /** called by RackModule::run(), returns after moduleStop() */
+        static void moduleRun(RackModule *p_mod);
+
+        /**
+         * @brief Wait until the started module is running
+         *
+         * @param p_exited Set by moduleExited() if the main function of the
+         *                 module returned before
+         *
+         * @return The running module or NULL if the main function returned
+         */
+        static RackModule* waitRunning(volatile int *p_exited);
+
+        /** the main function of a module returned */
+        static void moduleExited(volatile int *p_exited);
+
+        /** terminate a running module, its main function returns afterwards */
+        static void moduleStop(RackModule *p_mod);
+};
+
+#endif // __RACK_HOST_H__
@@ -20,6 +20,17 @@
 #include <main/tims/tims.h>
 #include <main/tims/tims_api.h>
 #include <main/rack_mutex.h>
+#include <main/rack_trace.h>
+
+#include <sys/uio.h>
+
+// overflow policies of an in-process mailbox, see setOverflowPolicy()
+#define RACK_MBX_OVERFLOW_GROW          0   // the queue grows without a limit
+#define RACK_MBX_OVERFLOW_DROP_OLDEST   1   // the oldest queued message is dropped (default)
+#define RACK_MBX_OVERFLOW_DROP_NEWEST   2   // the new message is dropped (-ENOSPC)
+#define RACK_MBX_OVERFLOW_BLOCK         3   // the sender waits (-ETIMEDOUT)
+
+struct rack_mbx_local;
 
 /**
  * This is the mailbox interface of RACK provided to application programs
@@ -192,11 +203,56 @@ class RackMailbox
         RackMutex       sendMtx;
         RackMutex       recvMtx;
 
+        struct rack_mbx_local *local;       // in-process queue, see setLocalDelivery()
+
+        void            *traceBuf;          // receive buffer of a trace build
+        uint32_t        traceBufSize;
+
+        ssize_t deliver(tims_msg_head *p_head, struct iovec *iov, int iovNum, int trace);
+        int     timsReceive(tims_msg_head *p_head, void *p_data, uint32_t maxDatalen,
+                            int64_t timeout_ns);
+        int     receive(tims_msg_head *p_head, void *p_data, uint32_t maxDatalen,
+                        int64_t timeout_ns);
+        int     peekBegin(tims_msg_head **pp_head, int64_t timeout_ns);
+
     public:
         RackMailbox();
 
+        /**
+         * @brief Deliver messages between mailboxes of the same process directly
+         *
+         * All mailboxes that are created after this call get an in-process
+         * message queue. A message to such a mailbox is copied once into a
+         * preallocated slot of the queue and bypasses the TIMS router.
+         * peek() hands out a pointer to the queued message without a further
+         * copy. Messages from and to other processes still use TIMS.
+         *
+         * Used by the RackHost program (see main/rack_host.h), Linux only.
+         */
+        static void     setLocalDelivery(int enable);
+
+        static int      getLocalDelivery(void);
+
+        /**
+         * @brief Number of messages the in-process mailbox @a address has
+         *        lost or delayed because it was full
+         *
+         * Lets a sender notice a slow receiver that drops the oldest
+         * messages, the send itself succeeds in this case.
+         *
+         * @return overflow count, 0 if @a address has no in-process queue
+         */
+        static uint32_t getDestOverflowCount(uint32_t address);
+
         /** Get length of message overhead */
-        static uint32_t getMsgOverhead(void)  { return TIMS_HEADLEN; }
+        static uint32_t getMsgOverhead(void)
+        {
+#ifdef __RACK_TRACE__
+            return TIMS_HEADLEN + RACK_TRACE_CTX_LEN;
+#else
+            return TIMS_HEADLEN;
+#endif
+        }
 
         /** Get address of the mailbox */
         uint32_t        getAdr(void)          { return addr; }
@@ -219,6 +275,10 @@ class RackMailbox
 
         int     clean(void);
 
+        int     setOverflowPolicy(int policy, int64_t timeout_ns);
+
+        uint32_t getOverflowCount(void);
+
         //
         // send
         //
@@ -233,6 +293,8 @@ class RackMailbox
 
         int     sendDataMsgReply(int8_t type, RackMessage *msgInfo, int dataPointers, void* data1, uint32_t datalen1, ...);
 
+        int     sendIovMsgReply(int8_t type, RackMessage *msgInfo, struct iovec *iov, int iovNum);
+
         //
         // peek
         //
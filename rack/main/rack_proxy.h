@@ -39,6 +39,7 @@
 #define MSG_GET_NEXT_DATA              8
 #define MSG_GET_PARAM                  9
 #define MSG_SET_PARAM                  10
+#define MSG_GET_MULTI_DATA             11
 
 // global message returns (negative)
 #define MSG_OK                         TIMS_MSG_OK
@@ -50,6 +51,7 @@
 #define MSG_DATA                      -6
 #define MSG_CONT_DATA                 -7
 #define MSG_PARAM                     -9
+#define MSG_MULTI_DATA                -10
 
 #define RACK_PROXY_MSG_POS_OFFSET      20
 #define RACK_PROXY_MSG_NEG_OFFSET     -20
@@ -97,6 +99,182 @@ class RackGetData
 
 };
 
+//######################################################################
+//# Rack get multi data (dynamic size)
+//######################################################################
+
+// the request fits the smallest command mailbox (240 bytes)
+#define RACK_MULTI_DATA_TIME_MAX       32
+
+// entries of the reply per timestamp
+#define RACK_MULTI_DATA_NEAREST        0    // the entry next to the timestamp
+#define RACK_MULTI_DATA_INTERPOL       1    // the entries before and after it
+
+// the Linux TIMS router passes messages up to 256 kB by default
+#define RACK_MULTI_DATA_MSG_MAX        (256 * 1024 - TIMS_HEADLEN)
+
+typedef struct rack_get_multi_data_s
+{
+    int32_t       mode;
+    int32_t       timeNum;
+    uint32_t      maxDatalen;           // reply buffer of the receiver
+    rack_time_t   recordingTime[0];
+} __attribute__((packed)) rack_get_multi_data;
+
+class RackGetMultiData
+{
+    public:
+        static size_t getDatalen(int timeNum)
+        {
+            return sizeof(rack_get_multi_data) + timeNum * sizeof(rack_time_t);
+        }
+
+        static void le_to_cpu(rack_get_multi_data *data)
+        {
+            int i;
+            data->mode       = __le32_to_cpu(data->mode);
+            data->timeNum    = __le32_to_cpu(data->timeNum);
+            data->maxDatalen = __le32_to_cpu(data->maxDatalen);
+            for (i = 0; (i < data->timeNum) && (i < RACK_MULTI_DATA_TIME_MAX); i++)
+            {
+                data->recordingTime[i] = __le32_to_cpu(data->recordingTime[i]);
+            }
+        }
+
+        static void be_to_cpu(rack_get_multi_data *data)
+        {
+            int i;
+            data->mode       = __be32_to_cpu(data->mode);
+            data->timeNum    = __be32_to_cpu(data->timeNum);
+            data->maxDatalen = __be32_to_cpu(data->maxDatalen);
+            for (i = 0; (i < data->timeNum) && (i < RACK_MULTI_DATA_TIME_MAX); i++)
+            {
+                data->recordingTime[i] = __be32_to_cpu(data->recordingTime[i]);
+            }
+        }
+
+        static rack_get_multi_data* parse(RackMessage *msgInfo)
+        {
+            if (!msgInfo->p_data)
+                return NULL;
+
+            rack_get_multi_data *p_data = (rack_get_multi_data *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+};
+
+/**
+ * reply of MSG_GET_MULTI_DATA
+ *
+ * The size table is followed by the entries of the data buffer, one per
+ * timestamp or two with RACK_MULTI_DATA_INTERPOL. parse() only converts the
+ * table, the entries are converted by the data class of the module.
+ * parse() returns NULL if the table or the entries exceed the message.
+ */
+typedef struct rack_multi_data_s
+{
+    int32_t       entryNum;
+    uint32_t      entrySize[0];
+} __attribute__((packed)) rack_multi_data;
+
+// rack_multi_data with the largest size table, used by the sender
+typedef struct rack_multi_data_table_s
+{
+    int32_t       entryNum;
+    uint32_t      entrySize[2 * RACK_MULTI_DATA_TIME_MAX];
+} __attribute__((packed)) rack_multi_data_table;
+
+class RackMultiData
+{
+    public:
+        static void le_to_cpu(rack_multi_data *data)
+        {
+            int i;
+            data->entryNum = __le32_to_cpu(data->entryNum);
+            for (i = 0; (i < data->entryNum) && (i < 2 * RACK_MULTI_DATA_TIME_MAX); i++)
+            {
+                data->entrySize[i] = __le32_to_cpu(data->entrySize[i]);
+            }
+        }
+
+        static void be_to_cpu(rack_multi_data *data)
+        {
+            int i;
+            data->entryNum = __be32_to_cpu(data->entryNum);
+            for (i = 0; (i < data->entryNum) && (i < 2 * RACK_MULTI_DATA_TIME_MAX); i++)
+            {
+                data->entrySize[i] = __be32_to_cpu(data->entrySize[i]);
+            }
+        }
+
+        static rack_multi_data* parse(RackMessage *msgInfo)
+        {
+            if (!msgInfo->p_data || (msgInfo->datalen < sizeof(rack_multi_data)))
+                return NULL;
+
+            rack_multi_data *p_data = (rack_multi_data *)msgInfo->p_data;
+            uint64_t        len;
+            int32_t         num;
+            int             i;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                num = __le32_to_cpu(p_data->entryNum);
+            }
+            else // data in big endian
+            {
+                num = __be32_to_cpu(p_data->entryNum);
+            }
+
+            // the size table has to be complete before it is converted
+            len = sizeof(rack_multi_data) + (uint64_t)num * sizeof(uint32_t);
+            if ((num < 0) || (num > 2 * RACK_MULTI_DATA_TIME_MAX) ||
+                (len > msgInfo->datalen))
+                return NULL;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+
+            for (i = 0; i < num; i++)
+            {
+                len += p_data->entrySize[i];
+            }
+            if (len > msgInfo->datalen)
+                return NULL;
+
+            return p_data;
+        }
+
+        /** entry @a i of a parsed reply */
+        static void* getEntry(rack_multi_data *data, int i)
+        {
+            uint8_t *p_entry = (uint8_t *)&data->entrySize[data->entryNum];
+            int     j;
+
+            for (j = 0; j < i; j++)
+            {
+                p_entry += data->entrySize[j];
+            }
+            return p_entry;
+        }
+};
+
 //######################################################################
 //# Rack get continuous data (static size)
 //######################################################################
@@ -483,6 +661,14 @@ class RackDataProxy : public RackProxy {
     int getNextData(void *recv_data, ssize_t recv_max_len,
                     uint64_t reply_timeout_ns, RackMessage *msgInfo);
 
+//
+// get multi data
+//
+
+    int getMultiData(void *recv_data, ssize_t recv_max_len, rack_time_t *timeStamp,
+                     int timeNum, int mode, uint64_t reply_timeout_ns,
+                     RackMessage *msgInfo);
+
     public:
 
 //
@@ -0,0 +1,134 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __RACK_SIM_CLOCK_H__
+#define __RACK_SIM_CLOCK_H__
+
+#include <inttypes.h>
+
+#define RACK_SIM_CLOCK_ENV              "RACK_SIM_CLOCK"
+#define RACK_SIM_CLOCK_NAME_DEFAULT     "/rack_sim_clock"
+#define RACK_SIM_CLOCK_MAGIC            0x4b4c4352      // "RCLK"
+#define RACK_SIM_CLOCK_TASK_MAX         256
+#define RACK_SIM_CLOCK_MBX_MAX          1024
+
+// real time between two checks of a mailbox wait for the virtual timeout
+#define RACK_SIM_CLOCK_POLL_NS          1000000llu
+
+/**
+ * Virtual time of a lockstep simulation.
+ *
+ * The clock master (tools/rack_sim_clock) creates a shared memory segment
+ * with the virtual time. A module that is started with the environment
+ * variable RACK_SIM_CLOCK=@<segment name@> uses this time instead of the
+ * system clock:
+ *
+ * - RackTime::get() and RackTime::getNano() return the virtual time,
+ * - RackTask::sleep() and RackTask::sleepUntil() wait for the virtual time,
+ * - the timeouts of the RackMailbox receive functions are virtual.
+ *
+ * Each task registers itself at its first wait point, each mailbox of the
+ * simulation at its creation. A message to such a mailbox is counted when it
+ * is sent and when it is received. The master advances the time to the next
+ * wakeup time of the waiting tasks as soon as all registered tasks have
+ * waited for the settle time without a change and no counted message is on
+ * its way. Each task runs until its next wait point, so a simulation runs as
+ * fast as the modules can compute and its result doesn't depend on the load
+ * of the computer. The settle time only covers messages from processes
+ * outside of the simulation, e.g. the GUI.
+ *
+ * Linux only.
+ *
+ * @ingroup main_os_abstraction
+ */
+class RackSimClock
+{
+    public:
+
+        /**
+         * @brief Attach to the clock of RACK_SIM_CLOCK, once per process
+         *
+         * @return 1 if the virtual time is used, otherwise 0
+         */
+        static int      isEnabled(void);
+
+        /** virtual time in nanoseconds */
+        static uint64_t getNano(void);
+
+        /**
+         * @brief Wait until the virtual time reaches @a date
+         *
+         * @return 0 on success, -EINTR if the master has stopped
+         */
+        static int      sleepUntil(uint64_t date);
+
+        /**
+         * @brief The calling task starts to wait
+         *
+         * @param deadline Virtual wakeup time, 0 if the task waits for an
+         *                 event only
+         */
+        static void     waitBegin(uint64_t deadline);
+
+        /** the calling task runs again */
+        static void     waitEnd(void);
+
+        /** messages to mailbox @a address are counted from now on */
+        static void     mbxCreate(uint32_t address);
+
+        /** mailbox @a address is removed, its messages are no longer counted */
+        static void     mbxRemove(uint32_t address);
+
+        /** the messages on their way to mailbox @a address are discarded */
+        static void     mbxClean(uint32_t address);
+
+        /** a message to mailbox @a dest is sent */
+        static void     msgSend(uint32_t dest);
+
+        /**
+         * @brief A message of mailbox @a address is received or dropped
+         *
+         * A waiting calling task runs again, the time can't advance before
+         * it has processed the message.
+         */
+        static void     msgReceive(uint32_t address);
+
+        //
+        // clock master
+        //
+
+        /** create the shared memory segment @a name, starting at @a time */
+        static int      create(const char *name, uint64_t time);
+
+        /** stop the clock, waiting tasks return with -EINTR */
+        static void     destroy(const char *name);
+
+        /**
+         * @brief Advance the virtual time by one step
+         *
+         * Returns without a change if less than @a taskMin tasks are
+         * registered, a task is running, a message is on its way or a task
+         * state changes within @a settle_ns.
+         *
+         * @return 1 if the time was advanced, 0 if not, -EDEADLK if all
+         *         tasks wait without a wakeup time
+         */
+        static int      advance(int taskMin, uint64_t settle_ns);
+
+        /** number of registered and waiting tasks */
+        static void     getTaskNum(int *taskNum, int *waitNum);
+
+        /** number of messages on their way */
+        static int      getMsgNum(void);
+};
+
+#endif // __RACK_SIM_CLOCK_H__
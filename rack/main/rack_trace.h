@@ -0,0 +1,185 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __RACK_TRACE_H__
+#define __RACK_TRACE_H__
+
+#include <main/tims/tims.h>
+
+#define RACK_TRACE_ENV                  "RACK_TRACE"
+#define RACK_TRACE_FILE_PREFIX          "rack_trace_"
+#define RACK_TRACE_MAGIC                0x43525452      // "RTRC"
+#define RACK_TRACE_VERSION              1
+#define RACK_TRACE_EVENT_NUM            65536           // power of 2
+
+// event kinds
+#define RACK_TRACE_SEND                 1
+#define RACK_TRACE_RECV                 2
+#define RACK_TRACE_PUT                  3
+#define RACK_TRACE_CALL_BEGIN           4
+#define RACK_TRACE_CALL_END             5
+
+/**
+ * trace context, sent behind the data of a message with TIMS_HEAD_TRACE
+ *
+ * @ingroup main_common
+ */
+typedef struct
+{
+    uint32_t    trace_id;
+    uint32_t    span_id;
+} __attribute__((packed)) rack_trace_ctx;
+
+#define RACK_TRACE_CTX_LEN              sizeof(rack_trace_ctx)
+
+/**
+ * event of the trace ring
+ */
+typedef struct
+{
+    uint64_t    time;               // ns, system time
+    uint32_t    seq;                // ring position + 1, written last, 0: invalid
+    uint8_t     kind;
+    int8_t      type;               // message type
+    uint16_t    reserved;
+    uint32_t    tid;
+    uint32_t    trace_id;
+    uint32_t    span_id;
+    uint32_t    parent_id;
+    uint32_t    src;
+    uint32_t    dest;
+    int32_t     value;              // message length or recording time
+} rack_trace_event;
+
+/**
+ * head of a trace file, followed by RACK_TRACE_EVENT_NUM events
+ */
+typedef struct
+{
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    eventNum;
+    int32_t     pid;
+    uint32_t    writeCount;         // events written so far
+    uint32_t    reserved;
+    char        name[64];           // program name
+} rack_trace_head;
+
+/**
+ * Message flow tracing.
+ *
+ * A program that is started with the environment variable
+ * RACK_TRACE=@<directory@> records the message flow of all its tasks into
+ * the file @<directory@>/rack_trace_@<pid@>. The file is a ring of
+ * RACK_TRACE_EVENT_NUM events, the oldest events are overwritten. The
+ * tasks write without a lock, the ring can be read while it is written.
+ * The RackTraceCollector tool (tools/rack_trace) merges the files of all
+ * processes into a Chrome trace.
+ *
+ * Each task has a trace context. A message that is sent while the context
+ * is set gets a new span and carries the trace and span id behind its data
+ * (TIMS_HEAD_TRACE). The receiving mailbox removes them again and sets the
+ * context of the receiving task, so a chain of modules shares one trace.
+ * RackDataModule::putDataBufferWorkSpace() starts a trace if the data task
+ * has none and ends it after the listeners got the data, the command task
+ * ends the trace after each command.
+ *
+ * The hooks are only built with CONFIG_RACK_TRACE (-D__RACK_TRACE__). All
+ * programs of a traced system have to be built with it, because their
+ * mailboxes need the space for the trace context.
+ *
+ * @ingroup main_common
+ */
+class RackTrace
+{
+    private:
+        static int      state;              // -1: not opened yet
+
+        static void     open(void);
+
+    public:
+
+        /**
+         * @brief Open the trace file of RACK_TRACE, once per process
+         *
+         * @return 1 if the events are recorded, otherwise 0
+         */
+        static int      isEnabled(void)
+        {
+            if (state < 0)
+            {
+                open();
+            }
+            return state;
+        }
+
+        /**
+         * @brief A message is sent
+         *
+         * Starts a new span if the task has a trace context. Sets
+         * TIMS_HEAD_TRACE in @a p_head and fills @a p_ctx.
+         *
+         * @return 1 if @a p_ctx has to be sent behind the data, otherwise 0
+         */
+        static int      send(tims_msg_head *p_head, rack_trace_ctx *p_ctx);
+
+        /**
+         * @brief A message with TIMS_HEAD_TRACE is received
+         *
+         * Sets the context of the task to the span of the message.
+         */
+        static void     recv(tims_msg_head *p_head, rack_trace_ctx *p_ctx);
+
+        /** new data in a data buffer, starts a trace if the task has none */
+        static void     put(uint32_t src, uint32_t recordingTime);
+
+        /** clear the trace context of the task */
+        static void     end(void);
+
+        /** a proxy call starts */
+        static void     callBegin(uint32_t dest, int8_t type);
+
+        /** a proxy call ends */
+        static void     callEnd(uint32_t dest, int8_t type);
+};
+
+/**
+ * Records a proxy call from the construction to the end of the scope.
+ */
+class RackTraceCall
+{
+    private:
+        uint32_t    dest;
+        int8_t      type;
+
+    public:
+        RackTraceCall(uint32_t dest, int8_t type)
+        {
+            this->dest = dest;
+            this->type = type;
+
+            if (RackTrace::isEnabled())
+            {
+                RackTrace::callBegin(dest, type);
+            }
+        }
+
+        ~RackTraceCall()
+        {
+            if (RackTrace::isEnabled())
+            {
+                RackTrace::callEnd(dest, type);
+            }
+        }
+};
+
+#endif // __RACK_TRACE_H__
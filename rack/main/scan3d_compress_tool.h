@@ -22,8 +22,24 @@
 #define COMPR_S1_REDUCE_BYTES_222110  0x00000003
 #define COMPR_S1_REDUCE_BYTES_RESORT  0x00000004
 #define COMPR_S1_DELTA_RLE            0x00000005
+#define COMPR_S1_RANGE_PRED           0x00000006
 #define COMPR_S1_REMOVE_INVALID       0x01000000
 
+#define COMPR_S1_RANGE_PRED_PARAM(BLOCK_LINES) ((((BLOCK_LINES)&0xFFFF)<<8)|COMPR_S1_RANGE_PRED)
+
+//----- range prediction: scanlines per independent block (if no parameter or 0 is given)
+#define RANGE_PRED_BLOCK_LINES      16
+//----- range prediction: max varint bytes of one point (4 x 5 bytes + 2 x 3 bytes)
+#define RANGE_PRED_MAX_POINT_BYTES  26
+
+//----- static rANS coder of the range prediction residuals
+#define RANS_SCALE_BITS             12
+#define RANS_SCALE                  (1<<RANS_SCALE_BITS)
+#define RANS_L                      (1u<<23)
+
+//----- range prediction: max threads of Compress()
+#define SCAN3D_COMPRESS_THREAD_MAX  16
+
 
 #include <main/rack_gdos.h>
 #include <main/compress_tool.h>
@@ -44,6 +60,21 @@ typedef struct scanPoint {
     int16_t s, i;
 } scanPoint;
 
+class Scan3dCompressTool;
+
+//----- range prediction: consecutive blocks coded by one thread
+typedef struct rangePredJob {
+    Scan3dCompressTool *tool;
+    uint32_t nPoints, width, blockPoints;       //----- geometry of the whole scan
+    uint32_t blockFirst, blockLast;             //----- blocks of this job
+    uint8_t  *out;                              //----- coded blocks
+    uint32_t outSize;
+    uint8_t  *work;                             //----- varint bytes (first 2/5) and rANS coder (rest)
+    uint32_t workSize;
+    uint32_t len;                               //----- coded bytes
+    int      ret;                               //----- 0 or -ENOSPC if the blocks don't fit into out
+} rangePredJob;
+
 
 
 //----- ----------------------------------------------------------------------------------------------------
@@ -66,14 +97,23 @@ class Scan3dCompressTool {
     uint8_t         buf1[COMPR_MAX_INPUT_SIZE];
     scan_point      s3d_buf1[SCAN3D_POINT_MAX];
 
+    //----- for range prediction (rANS tables of the decoder)
+    uint32_t        rans_freq[256];
+    uint32_t        rans_cum[257];
+    uint8_t         rans_cum2sym[RANS_SCALE];
+
   public:
 //----- ----------------------------------------------------------------------------------------------------
 //----- prototypes
+//----- COMPR_S1_RANGE_PRED splits the blocks of a scan into groups that are coded by
+//----- additional threads (last parameter of Compress()). Threads are plain pthreads,
+//----- so only use more than one thread outside of realtime tasks.
 //----- ----------------------------------------------------------------------------------------------------
     Scan3dCompressTool();
     Scan3dCompressTool(RackMailbox * p_mbx, int32_t gdos_level, RackTime *rt);
     ~Scan3dCompressTool();
-    uint32_t Compress(scan3d_data *s3d_in_out, uint32_t flags_s1, uint32_t flags_s2, uint32_t flags_s3);
+    uint32_t Compress(scan3d_data *s3d_in_out, uint32_t flags_s1, uint32_t flags_s2, uint32_t flags_s3,
+                      int threads = 1);
     void     compr_step1_searchMinMaxValues(uint32_t nPoints);
     void     compr_step1_reduceBitsPerSymbol(compr_bitStream *out, uint32_t nPoints);
     void     compr_step1_reduceBytesPerSymbol(compr_bitStream *out, uint32_t nPoints);
@@ -81,6 +121,11 @@ class Scan3dCompressTool {
     void     compr_step1_resortBytesByColumns(compr_bitStream *in, compr_bitStream *out, uint32_t columns, uint32_t nPoints);
     uint32_t compr_step1_delta_rle(compr_bitStream *out, uint32_t n);
     uint32_t compr_step1_remove_invalid(uint32_t nPoints);
+    uint32_t compr_step1_range_pred(compr_bitStream *out, uint32_t nPoints, uint32_t maxSize, uint32_t blockLines,
+                                    int threads);
+    void     compr_step1_range_pred_blocks(rangePredJob *job);
+    uint32_t compr_step1_range_pred_block(uint8_t *out, uint32_t first, uint32_t n, uint32_t width);
+    uint32_t compr_step1_rans(uint8_t *in, uint32_t size, uint8_t *out, uint32_t maxSize, uint8_t *workEnd);
 
 #ifdef COMPR_UNCOMPR
     uint32_t Decompress(scan3d_data *s3d_in_out);
@@ -90,6 +135,9 @@ class Scan3dCompressTool {
     void     uncompr_step1_resortBytesByColumns(compr_bitStream *in, compr_bitStream *out, uint32_t n, uint32_t columns);
     uint32_t uncompr_step1_delta_rle(compr_bitStream *in, uint32_t n);
     uint32_t uncompr_step1_remove_invalid(uint32_t nIn, uint32_t nOut);
+    uint32_t uncompr_step1_range_pred(compr_bitStream *in, uint32_t nPoints, uint32_t size);
+    uint32_t uncompr_step1_range_pred_block(uint8_t *in, uint32_t size, uint32_t first, uint32_t n, uint32_t width);
+    uint32_t uncompr_step1_rans(uint8_t *in, uint32_t inSize, uint8_t *out, uint32_t size);
 #endif
 
 };
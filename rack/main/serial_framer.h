@@ -0,0 +1,154 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __SERIAL_FRAMER_H__
+#define __SERIAL_FRAMER_H__
+
+#include <main/serial_port.h>
+
+#define SERIAL_FRAME_SYNC_MAX       16
+#define SERIAL_FRAMER_CHUNK_MAX     64      // chunk timestamps of the buffer
+
+/**
+ * Frame format of a SerialFramer.
+ *
+ * A frame starts with @a syncLen sync bytes, sync bytes with a @a syncMask
+ * of 0 match any value. The frame length is taken from the first hook that
+ * is set:
+ *
+ * - @a getLength(data, dataLen, arg): frame length from the first
+ *   @a dataLen received bytes of the frame, 0 if more bytes are needed,
+ *   negative if the head is invalid
+ * - a length field of @a lenSize bytes at @a lenOffset (@a lenOffset >= 0):
+ *   field * @a lenScale + @a lenAdd
+ * - a @a terminator byte (>= 0) behind the sync bytes
+ * - the fixed @a frameLen
+ *
+ * A frame with a length above @a maxLen is invalid. @a check(frame, len, arg)
+ * returns 0 if the checksum of a complete frame is right. On an invalid head
+ * or a wrong checksum the framer searches the next sync bytes behind the
+ * first byte of the frame.
+ *
+ * @ingroup main_device_driver
+ */
+typedef struct
+{
+    uint8_t     sync[SERIAL_FRAME_SYNC_MAX];
+    uint8_t     syncMask[SERIAL_FRAME_SYNC_MAX];
+    int         syncLen;
+
+    int         lenOffset;          // -1: no length field
+    int         lenSize;            // 1 or 2
+    int         lenBigEndian;
+    int         lenScale;
+    int         lenAdd;
+    int         terminator;         // -1: no terminator
+    int         frameLen;
+    int         maxLen;
+
+    int         maxSkip;            // bytes skipped while searching, then -ETIME
+
+    int         (*getLength)(const uint8_t *data, int dataLen, void *arg);
+    int         (*check)(const uint8_t *frame, int frameLen, void *arg);
+    void        *arg;
+} serial_frame_format;
+
+/**
+ * Frame parser on top of a SerialPort.
+ *
+ * The framer reads the port in large chunks (SerialPort::recvChunk()) into
+ * its receive buffer and hands out each frame as a pointer into this buffer,
+ * without a further copy. The frame stays valid until the next call of
+ * readFrame() or clean(). So a driver needs one system call per chunk instead
+ * of one per sync byte, head and body, and the sync search is a loop over the
+ * buffer.
+ *
+ * The start time of a frame is the receive time of the chunk with the first
+ * byte of the frame, the end time the one of the chunk with the last byte.
+ * Timeouts are the receive timeout of the port.
+ *
+ * @ingroup main_device_driver
+ */
+class SerialFramer
+{
+    private:
+
+        SerialPort              *port;
+        serial_frame_format     *format;
+
+        uint8_t                 *buf;
+        int                     bufSize;
+        int                     head;           // first byte not parsed yet
+        int                     tail;           // end of the received bytes
+        int                     frameLen;       // frame handed out by readFrame()
+
+        int                     chunkPos[SERIAL_FRAMER_CHUNK_MAX];
+        rack_time_t             chunkTime[SERIAL_FRAMER_CHUNK_MAX];
+        int                     chunkNum;
+
+        uint32_t                skipNum;
+        uint32_t                checkErrorNum;
+
+        int                     syncMatch(const uint8_t *data, int dataLen);
+        int                     getLength(const uint8_t *data, int dataLen);
+        rack_time_t             getTime(int pos);
+        int                     fill(void);
+
+    public:
+
+        SerialFramer();
+        ~SerialFramer();
+
+        /**
+         * @brief Allocate the receive buffer
+         *
+         * @param port Opened serial port
+         * @param format Frame format, may be changed between two
+         *               readFrame() calls (e.g. the fixed @a frameLen)
+         * @param bufSize Size of the receive buffer, at least twice the
+         *                @a maxLen of the format
+         *
+         * @return 0 on success, otherwise negative error code
+         */
+        int     init(SerialPort *port, serial_frame_format *format, int bufSize);
+        void    cleanup(void);
+
+        /**
+         * @brief Read the next frame
+         *
+         * @param pp_frame Gets the frame in the receive buffer
+         * @param startTime Gets the receive time of the first byte, may be NULL
+         * @param endTime Gets the receive time of the last byte, may be NULL
+         *
+         * @return Frame length, -ETIME if no frame was found within
+         *         @a maxSkip bytes, otherwise negative error code of the port
+         */
+        int     readFrame(uint8_t **pp_frame, rack_time_t *startTime,
+                          rack_time_t *endTime);
+
+        /** drop the received bytes and clean the port */
+        int     clean(void);
+
+        /** bytes skipped while searching a frame */
+        uint32_t getSkipNum(void)
+        {
+            return skipNum;
+        }
+
+        /** frames with a wrong checksum */
+        uint32_t getCheckErrorNum(void)
+        {
+            return checkErrorNum;
+        }
+};
+
+#endif // __SERIAL_FRAMER_H__
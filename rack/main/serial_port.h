@@ -18,6 +18,7 @@
 #define __SERIAL_PORT_H__
 
 #include <main/rack_module.h>
+#include <main/port_capture.h>
 
 #if defined (__XENO__) || defined (__KERNEL__)
 
@@ -35,6 +36,9 @@
  * This is the Serial Port interface of RACK provided to application programs
  * in userspace.
  *
+ * The linux implementation records or replays the received bytes with
+ * PortCapture, the port name of the capture is "serial<dev>".
+ *
  * @ingroup main_device_driver
  */
 class SerialPort
@@ -45,9 +49,13 @@ class SerialPort
 
         int fd;
         RackModule *module;
+        int64_t rxTimeout;
+        rack_time_t replayTime;
 
     public:
 
+        PortCapture capture;
+
         SerialPort();
         ~SerialPort();
 
@@ -73,6 +81,17 @@ class SerialPort
         int recv(void *data, int dataLen, rack_time_t *timestamp,
                  int64_t timeout_ns);
 
+        /**
+         * @brief receive the available data, at most @a maxLen bytes
+         *
+         * Waits with the default timeout for the first byte. The timestamp
+         * is the receive time of the first byte (Xenomai) or of the chunk
+         * (Linux). Used by the SerialFramer.
+         *
+         * @return Number of bytes, otherwise negative error code
+         */
+        int recvChunk(void *data, int maxLen, rack_time_t *timestamp);
+
         int waitEvent(struct rtser_event *event);
 
         int clean(void);
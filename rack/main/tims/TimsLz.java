@@ -0,0 +1,115 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+package rack.main.tims;
+
+import java.io.*;
+
+/**
+ * Decoder of the LZ codec used by the TimsRouterTcp on remote links
+ * (see main/tims/router/tims_router_lz.h).
+ */
+public class TimsLz
+{
+    public static final int MIN_MATCH = 4;
+
+    /**
+     * Uncompresses a compressed message body. The body starts with the
+     * uncompressed length (big endian) followed by the LZ sequences.
+     */
+    public static byte[] uncompressBody(byte[] in) throws IOException
+    {
+        if (in.length < 4)
+        {
+            throw new IOException("Compressed body is too small");
+        }
+
+        int outLen = ((in[0] & 0xff) << 24) | ((in[1] & 0xff) << 16) |
+                     ((in[2] & 0xff) << 8)  |  (in[3] & 0xff);
+        if (outLen < 0)
+        {
+            throw new IOException("Invalid uncompressed length " + outLen);
+        }
+
+        byte[] out = new byte[outLen];
+        int ip = 4;
+        int op = 0;
+
+        try
+        {
+            while (ip < in.length)
+            {
+                int token = in[ip++] & 0xff;
+
+                // literals
+                int len = token >> 4;
+                if (len == 15)
+                {
+                    int b;
+                    do
+                    {
+                        b = in[ip++] & 0xff;
+                        len += b;
+                    }
+                    while (b == 255);
+                }
+                System.arraycopy(in, ip, out, op, len);
+                ip += len;
+                op += len;
+
+                // last sequence
+                if (ip == in.length)
+                {
+                    break;
+                }
+
+                // match
+                int offset = ((in[ip] & 0xff) << 8) | (in[ip + 1] & 0xff);
+                ip += 2;
+                if ((offset == 0) || (offset > op))
+                {
+                    throw new IOException("Invalid match offset " + offset);
+                }
+
+                len = token & 0x0f;
+                if (len == 15)
+                {
+                    int b;
+                    do
+                    {
+                        b = in[ip++] & 0xff;
+                        len += b;
+                    }
+                    while (b == 255);
+                }
+                len += MIN_MATCH;
+
+                // byte copy, source and destination may overlap
+                int ref = op - offset;
+                for (int i = 0; i < len; i++)
+                {
+                    out[op++] = out[ref++];
+                }
+            }
+        }
+        catch (IndexOutOfBoundsException e)
+        {
+            throw new IOException("Corrupt compressed body");
+        }
+
+        if (op != outLen)
+        {
+            throw new IOException("Uncompressed length mismatch " + op + " != " + outLen);
+        }
+        return out;
+    }
+}
@@ -36,8 +36,11 @@ public abstract class TimsMsg
 
     public static final int    HEAD_LEN      = 16;        // length of message-head
 
+    public static final int    BODY_COMPRESSED = 0x20;    // flag of compressed bodies
+
     public int                 headByteorder = BIG_ENDIAN;
     public int                 bodyByteorder = BIG_ENDIAN;
+    public boolean             bodyCompressed = false;
 
     public byte                type          = 0;
     public byte                priority      = 0;         // 0 = less important message
@@ -116,6 +119,7 @@ public abstract class TimsMsg
 
         headByteorder = (flags) & 0x01;
         bodyByteorder = (flags >> 1) & 0x01;
+        bodyCompressed = (flags & BODY_COMPRESSED) != 0;
 
         EndianDataInputStream dataIn;
 
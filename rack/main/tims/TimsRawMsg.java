@@ -70,6 +70,14 @@ public class TimsRawMsg extends TimsMsg
         {
             body = new byte[0];
         }
+
+        // compressed by the TimsRouterTcp
+        if (bodyCompressed)
+        {
+            body = TimsLz.uncompressBody(body);
+            msglen = HEAD_LEN + body.length;
+            bodyCompressed = false;
+        }
     }
 
     public void writeTimsMsgBody(OutputStream out) throws IOException
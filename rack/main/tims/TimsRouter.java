@@ -26,4 +26,10 @@ public class TimsRouter
     public static final byte GET_STATUS            = 17;
     public static final byte ENABLE_WATCHDOG       = 18;
     public static final byte DISABLE_WATCHDOG      = 19;
+    public static final byte ENABLE_COMPRESSION    = 20;
+    public static final byte COMPRESSION           = -12;
+
+    // compression codecs (bit mask)
+    public static final int  COMPR_NONE            = 0x00;
+    public static final int  COMPR_LZ              = 0x01;
 }
@@ -0,0 +1,71 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+package rack.main.tims;
+
+import java.io.*;
+
+public class TimsRouterComprMsg extends TimsMsg
+{
+    public int codec     = 0; // 4 Bytes
+    public int threshold = 0; // 4 Bytes
+
+    public int getDataLen()
+    {
+        return 8;
+    }
+
+    public TimsRouterComprMsg()
+    {
+        msglen = HEAD_LEN + getDataLen();
+    }
+
+    public TimsRouterComprMsg(TimsRawMsg m) throws TimsException
+    {
+        readTimsRawMsg(m);
+    }
+
+    public boolean checkTimsMsgHead()
+    {
+        if ((msglen == (HEAD_LEN + getDataLen())) &&
+                ((type == TimsRouter.ENABLE_COMPRESSION) |
+                 (type == TimsRouter.COMPRESSION)))
+        {
+            return true;
+        }
+        else
+            return false;
+    }
+
+    public void readTimsMsgBody(InputStream in) throws IOException
+    {
+        EndianDataInputStream dataIn;
+        if (bodyByteorder == BIG_ENDIAN)
+        {
+            dataIn = new BigEndianDataInputStream(in);
+        }
+        else
+        {
+            dataIn = new LittleEndianDataInputStream(in);
+        }
+        codec     = dataIn.readInt();
+        threshold = dataIn.readInt();
+        bodyByteorder = BIG_ENDIAN;
+    }
+
+    public void writeTimsMsgBody(OutputStream out) throws IOException
+    {
+        DataOutputStream dataOut = new DataOutputStream(out);
+        dataOut.writeInt(codec);
+        dataOut.writeInt(threshold);
+    }
+}
@@ -58,6 +58,8 @@ public class TimsTcp extends Tims
             routerMbx = new TimsMbx(0, this);
             mbxList.addElement(routerMbx);
 
+            enableCompression();
+
             start();
 
         }
@@ -160,7 +162,22 @@ public class TimsTcp extends Tims
                         dataRate.receivedMessages++;
                     }
 
-                    if ((m.dest == 0) && (m.src == 0) && (m.type == TimsRouter.GET_STATUS))
+                    if ((m.dest == 0) && (m.src == 0) && (m.type == TimsRouter.COMPRESSION))
+                    {
+                        // reply to enableCompression()
+                        try
+                        {
+                            TimsRouterComprMsg cm = new TimsRouterComprMsg(m);
+                            if (cm.codec != TimsRouter.COMPR_NONE)
+                            {
+                                System.out.println("Tims compression enabled (codec " + cm.codec +
+                                                   ", threshold " + cm.threshold + " bytes)");
+                            }
+                        }
+                        catch (TimsException e1)
+                        {}
+                    }
+                    else if ((m.dest == 0) && (m.src == 0) && (m.type == TimsRouter.GET_STATUS))
                     {
                         // reply to lifesign
                         try
@@ -249,6 +266,8 @@ public class TimsTcp extends Tims
                             send(initMbxM);
                         }
 
+                        enableCompression();
+
                         System.out.println("Tims reconnected to " + addr.getHostAddress() + ":" + port);
                     }
                     catch (Exception e)
@@ -408,6 +427,21 @@ public class TimsTcp extends Tims
         return null;
     }
 
+    // offers the codecs this client can decode, the TimsRouterTcp
+    // only compresses messages on remote links
+    protected void enableCompression() throws TimsException
+    {
+        TimsRouterComprMsg m = new TimsRouterComprMsg();
+
+        m.type = TimsRouter.ENABLE_COMPRESSION;
+        m.dest = 0;
+        m.src = 0;
+        m.codec = TimsRouter.COMPR_LZ;
+        m.threshold = 0;
+
+        send(m);
+    }
+
     public boolean connectionAlive()
     {
         return (tcpIn != null) && (tcpOut != null);
@@ -0,0 +1,218 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#include <string.h>
+#include <errno.h>
+
+#include "tims_router_lz.h"
+
+#define TIMS_LZ_HASH_SIZE   (1 << TIMS_LZ_HASH_BITS)
+
+// no match may start in the last bytes of the input
+#define TIMS_LZ_TAIL        (TIMS_LZ_MIN_MATCH + 4)
+
+static inline uint32_t tims_lz_read32(const uint8_t *p)
+{
+    uint32_t val;
+    memcpy(&val, p, sizeof(val));
+    return val;
+}
+
+static inline uint32_t tims_lz_hash(uint32_t val)
+{
+    return (val * 2654435761u) >> (32 - TIMS_LZ_HASH_BITS);
+}
+
+static inline uint8_t* tims_lz_write_len(uint8_t *op, uint32_t len)
+{
+    while (len >= 255)
+    {
+        *op++ = 255;
+        len  -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+int tims_lz_compress(const uint8_t *in, uint32_t inLen,
+                     uint8_t *out, uint32_t outMax)
+{
+    uint32_t       hashTab[TIMS_LZ_HASH_SIZE];
+    const uint8_t *ip     = in;
+    const uint8_t *anchor = in;
+    const uint8_t *inEnd  = in + inLen;
+    const uint8_t *mLimit = inEnd - TIMS_LZ_TAIL;
+    const uint8_t *ref;
+    uint8_t       *op     = out;
+    uint8_t       *outEnd = out + outMax;
+    uint8_t       *token;
+    uint32_t       litLen, matchLen, h;
+
+    memset(hashTab, 0, sizeof(hashTab));
+
+    if (inLen > TIMS_LZ_TAIL)
+    {
+        while (ip < mLimit)
+        {
+            h          = tims_lz_hash(tims_lz_read32(ip));
+            ref        = in + hashTab[h];
+            hashTab[h] = (uint32_t)(ip - in);
+
+            if ((ref >= ip) || (ip - ref > TIMS_LZ_MAX_OFFSET) ||
+                (tims_lz_read32(ref) != tims_lz_read32(ip)))
+            {
+                ip++;
+                continue;
+            }
+
+            // extend the match
+            matchLen = TIMS_LZ_MIN_MATCH;
+            while ((ip + matchLen < mLimit) && (ref[matchLen] == ip[matchLen]))
+                matchLen++;
+
+            // worst case space for this sequence
+            litLen = (uint32_t)(ip - anchor);
+            if (op + 1 + litLen + litLen / 255 + 1 + 2 + matchLen / 255 + 1 > outEnd)
+                return -ENOSPC;
+
+            // token and literals
+            token = op++;
+            if (litLen >= 15)
+            {
+                *token = 15 << 4;
+                op     = tims_lz_write_len(op, litLen - 15);
+            }
+            else
+            {
+                *token = (uint8_t)(litLen << 4);
+            }
+            memcpy(op, anchor, litLen);
+            op += litLen;
+
+            // offset and match length
+            *op++ = (uint8_t)((ip - ref) >> 8);
+            *op++ = (uint8_t)(ip - ref);
+
+            if (matchLen - TIMS_LZ_MIN_MATCH >= 15)
+            {
+                *token |= 15;
+                op      = tims_lz_write_len(op, matchLen - TIMS_LZ_MIN_MATCH - 15);
+            }
+            else
+            {
+                *token |= (uint8_t)(matchLen - TIMS_LZ_MIN_MATCH);
+            }
+
+            ip    += matchLen;
+            anchor = ip;
+
+            // reference the position right before the next search start
+            if (ip < mLimit)
+            {
+                hashTab[tims_lz_hash(tims_lz_read32(ip - 2))] = (uint32_t)(ip - 2 - in);
+            }
+        }
+    }
+
+    // last literals
+    litLen = (uint32_t)(inEnd - anchor);
+    if (op + 1 + litLen + litLen / 255 + 1 > outEnd)
+        return -ENOSPC;
+
+    token = op++;
+    if (litLen >= 15)
+    {
+        *token = 15 << 4;
+        op     = tims_lz_write_len(op, litLen - 15);
+    }
+    else
+    {
+        *token = (uint8_t)(litLen << 4);
+    }
+    memcpy(op, anchor, litLen);
+    op += litLen;
+
+    return (int)(op - out);
+}
+
+int tims_lz_uncompress(const uint8_t *in, uint32_t inLen,
+                       uint8_t *out, uint32_t outMax)
+{
+    const uint8_t *ip     = in;
+    const uint8_t *inEnd  = in + inLen;
+    uint8_t       *op     = out;
+    uint8_t       *outEnd = out + outMax;
+    const uint8_t *ref;
+    uint32_t       token, len, offset;
+
+    while (ip < inEnd)
+    {
+        token = *ip++;
+
+        // literals
+        len = token >> 4;
+        if (len == 15)
+        {
+            do
+            {
+                if (ip >= inEnd)
+                    return -EINVAL;
+                len += *ip;
+            }
+            while (*ip++ == 255);
+        }
+
+        if ((len > (uint32_t)(inEnd - ip)) || (len > (uint32_t)(outEnd - op)))
+            return -EINVAL;
+
+        memcpy(op, ip, len);
+        ip += len;
+        op += len;
+
+        // last sequence
+        if (ip == inEnd)
+            break;
+
+        // match
+        if (inEnd - ip < 2)
+            return -EINVAL;
+
+        offset = ((uint32_t)ip[0] << 8) | ip[1];
+        ip    += 2;
+
+        if ((offset == 0) || (offset > (uint32_t)(op - out)))
+            return -EINVAL;
+
+        len = token & 0x0f;
+        if (len == 15)
+        {
+            do
+            {
+                if (ip >= inEnd)
+                    return -EINVAL;
+                len += *ip;
+            }
+            while (*ip++ == 255);
+        }
+        len += TIMS_LZ_MIN_MATCH;
+
+        if (len > (uint32_t)(outEnd - op))
+            return -EINVAL;
+
+        // byte copy, source and destination may overlap
+        ref = op - offset;
+        while (len--)
+            *op++ = *ref++;
+    }
+
+    return (int)(op - out);
+}
@@ -0,0 +1,53 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __TIMS_ROUTER_LZ_H__
+#define __TIMS_ROUTER_LZ_H__
+
+#include <main/tims/tims_types.h>
+
+//
+// Fast byte oriented LZ77 codec for TiMS message bodies
+//
+// The compressed stream is a sequence of
+//   token     (1 byte)  : high nibble literal length, low nibble match length - 4
+//   [litLen]  (n bytes) : 255 .. 255 x, only if the literal nibble is 15
+//   literals
+//   offset    (2 bytes) : big endian match distance (1 .. 65535)
+//   [matchLen](n bytes) : 255 .. 255 x, only if the match nibble is 15
+// The last sequence only contains literals and ends with the input.
+//
+
+#define TIMS_LZ_MIN_MATCH       4
+#define TIMS_LZ_MAX_OFFSET      65535
+#define TIMS_LZ_HASH_BITS       12
+
+// worst case size of the compressed data
+#define TIMS_LZ_BOUND(len)      ((len) + (len) / 255 + 16)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// returns the compressed length or -ENOSPC if the output doesn't fit
+int tims_lz_compress(const uint8_t *in, uint32_t inLen,
+                     uint8_t *out, uint32_t outMax);
+
+// returns the uncompressed length or -EINVAL on corrupt input
+int tims_lz_uncompress(const uint8_t *in, uint32_t inLen,
+                       uint8_t *out, uint32_t outMax);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TIMS_ROUTER_LZ_H__
@@ -37,6 +37,8 @@
 
 #include <main/tims/tims_router.h>
 
+#include "tims_router_lz.h"
+
 #define TIMS_LEVEL_PRINT          0
 #define TIMS_LEVEL_DBG            1
 #define TIMS_LEVEL_DBG_DETAIL     2
@@ -73,8 +75,10 @@
 
 #define DEFAULT_PORT        2000
 #define DEFAULT_MAX         256
+#define DEFAULT_COMPR       1024
 
 static unsigned int         maxMsgSize;
+static unsigned int         comprThreshold;
 static unsigned int         init_flags;
 static unsigned int         sem_flags;
 static int                  terminate;
@@ -94,6 +98,10 @@ typedef struct {
     int                 watchdogEnabled;
     int                 watchdog;
     sem_t               sendSem;
+    int                 loopback;        // client runs on the router host
+    uint32_t            comprCodec;      // negotiated codec (TIMS_ROUTER_COMPR_...)
+    uint32_t            comprThreshold;  // min body size to compress
+    tims_msg_head*      comprMsg;        // compression buffer, protected by sendSem
 } connection_t;
 
 // if MAX_CONNECTIONS > 32 -> look @ sem_flags
@@ -136,6 +144,10 @@ connection_t* connection_getFree(connection_t* newCon)
             conList[i].index            = i;
             conList[i].watchdogEnabled  = 1;
             conList[i].watchdog         = 0;
+            conList[i].loopback         = 0;
+            conList[i].comprCodec       = TIMS_ROUTER_COMPR_NONE;
+            conList[i].comprThreshold   = 0;
+            conList[i].comprMsg         = NULL;
             return &conList[i];
         }
     }
@@ -153,6 +165,106 @@ void connection_delete(connection_t* con)
     tims_dbgdetail("connection[%i] closed\n", con->index);
 }
 
+//
+// compression functions
+//
+
+// Compresses the body of sndMsg into con->comprMsg. Returns the compressed
+// message or sndMsg if compression is disabled or doesn't save any bytes.
+// Has to be called with con->sendSem held.
+tims_msg_head* compressTcpTimsMsg(connection_t *con, tims_msg_head* sndMsg)
+{
+    tims_msg_head *comprMsg = con->comprMsg;
+    uint32_t       bodyLen  = sndMsg->msglen - TIMS_HEADLEN;
+    int            ret;
+
+    if (!(con->comprCodec & TIMS_ROUTER_COMPR_LZ) ||
+        !comprMsg ||
+        (bodyLen < con->comprThreshold) ||
+        (bodyLen <= 4) ||
+        (sndMsg->flags & TIMS_BODY_COMPRESSED))
+    {
+        return sndMsg;
+    }
+
+    // the compressed body has to be smaller than the original one
+    ret = tims_lz_compress(sndMsg->data, bodyLen, comprMsg->data + 4, bodyLen - 5);
+    if (ret < 0)
+    {
+        return sndMsg;
+    }
+
+    memcpy(comprMsg, sndMsg, TIMS_HEADLEN);
+    comprMsg->flags  |= TIMS_BODY_COMPRESSED;
+    comprMsg->msglen  = TIMS_HEADLEN + 4 + ret;
+    comprMsg->data[0] = (uint8_t)(bodyLen >> 24);
+    comprMsg->data[1] = (uint8_t)(bodyLen >> 16);
+    comprMsg->data[2] = (uint8_t)(bodyLen >> 8);
+    comprMsg->data[3] = (uint8_t)(bodyLen);
+
+    tims_dbgdetail("con[%02d]: Compressed %8x --(%4d)--> %8x, body %u -> %u bytes\n",
+                   con->index, sndMsg->src, sndMsg->type, sndMsg->dest, bodyLen,
+                   (unsigned int)(comprMsg->msglen - TIMS_HEADLEN));
+    return comprMsg;
+}
+
+// Uncompresses the body of comprMsg into rawMsg (buffer of maxMsgSize bytes)
+int uncompressTcpTimsMsg(connection_t *con, tims_msg_head* comprMsg,
+                         tims_msg_head* rawMsg)
+{
+    uint32_t bodyLen;
+    int      ret;
+
+    if (comprMsg->msglen < TIMS_HEADLEN + 4)
+    {
+        tims_print("con[%02d] ERROR: Recv %8x --(%4d)--> %8x, compressed message (%u bytes) is too small\n",
+                   con->index, comprMsg->src, comprMsg->type, comprMsg->dest, comprMsg->msglen);
+        return -EINVAL;
+    }
+
+    bodyLen = ((uint32_t)comprMsg->data[0] << 24) | ((uint32_t)comprMsg->data[1] << 16) |
+              ((uint32_t)comprMsg->data[2] << 8)  |  (uint32_t)comprMsg->data[3];
+
+    if (bodyLen > maxMsgSize - TIMS_HEADLEN)
+    {
+        tims_print("con[%02d] ERROR: Recv %8x --(%4d)--> %8x, uncompressed message (%u bytes) is too big for buffer (%u bytes)\n",
+                   con->index, comprMsg->src, comprMsg->type, comprMsg->dest,
+                   (unsigned int)(bodyLen + TIMS_HEADLEN), maxMsgSize);
+        return -EINVAL;
+    }
+
+    ret = tims_lz_uncompress(comprMsg->data + 4, comprMsg->msglen - TIMS_HEADLEN - 4,
+                             rawMsg->data, bodyLen);
+    if (ret != (int)bodyLen)
+    {
+        tims_print("con[%02d] ERROR: Recv %8x --(%4d)--> %8x, invalid compressed body\n",
+                   con->index, comprMsg->src, comprMsg->type, comprMsg->dest);
+        return -EINVAL;
+    }
+
+    memcpy(rawMsg, comprMsg, TIMS_HEADLEN);
+    rawMsg->flags  &= ~TIMS_BODY_COMPRESSED;
+    rawMsg->msglen  = TIMS_HEADLEN + bodyLen;
+    return 0;
+}
+
+// Compression is only used on links to other hosts. Local clients read
+// the messages from the loopback device, where compression doesn't pay off.
+int connection_isLoopback(connection_t *con)
+{
+    struct sockaddr_in localAddr;
+    socklen_t          localAddrLen = sizeof(localAddr);
+
+    if ((ntohl(con->addr.sin_addr.s_addr) >> 24) == 127)
+        return 1;
+
+    if (!getsockname(con->socket, (struct sockaddr *)&localAddr, &localAddrLen) &&
+        (localAddr.sin_addr.s_addr == con->addr.sin_addr.s_addr))
+        return 1;
+
+    return 0;
+}
+
 //
 // TCP send / receive functions
 //
@@ -163,6 +275,9 @@ int sndTcpTimsMsg(connection_t *con, tims_msg_head* sndMsg)
     int ret;
 
     sem_wait(&con->sendSem);
+
+    sndMsg = compressTcpTimsMsg(con, sndMsg);
+
     tims_dbgdetail("con[%02d]: %8x --(%4d)--> %8x, sending %u bytes\n", idx,
                    sndMsg->src, sndMsg->type, sndMsg->dest, sndMsg->msglen);
 
@@ -455,6 +570,47 @@ void mailbox_cleanup(connection_t *con, tims_msg_head* tcpMsg,
 
 }
 
+void compression_init(connection_t *con, tims_msg_head* tcpMsg)
+{
+    tims_router_compr_msg* comprMsg = NULL;
+    tims_router_compr_msg  replyMsg;
+    uint32_t               codec = TIMS_ROUTER_COMPR_NONE;
+    uint32_t               threshold = 0;
+
+    if (tcpMsg->msglen < sizeof(tims_router_compr_msg))
+    {
+        tims_print("con[%02d] ERROR: Invalid message length, is: %u bytes, must be at least %u bytes\n",
+                   con->index, tcpMsg->msglen, (unsigned int)sizeof(tims_router_compr_msg));
+        return;
+    }
+
+    comprMsg = tims_router_parse_compr_msg(tcpMsg);
+
+    // select codec
+    if (comprThreshold && !con->loopback)
+    {
+        codec     = comprMsg->codec & TIMS_ROUTER_COMPR_LZ;
+        threshold = comprMsg->threshold > comprThreshold ?
+                    comprMsg->threshold : comprThreshold;
+    }
+
+    sem_wait(&con->sendSem);
+    con->comprCodec     = codec;
+    con->comprThreshold = threshold;
+    sem_post(&con->sendSem);
+
+    tims_print("con[%02d]: Compression codec %x threshold %u bytes%s\n",
+               con->index, codec, threshold, con->loopback ? " (loopback)" : "");
+
+    tims_fill_head(&replyMsg.head, TIMS_MSG_ROUTER_COMPRESSION, tcpMsg->src,
+                   tcpMsg->dest, tcpMsg->priority, tcpMsg->seq_nr, 0,
+                   sizeof(replyMsg));
+    replyMsg.codec     = codec;
+    replyMsg.threshold = threshold;
+
+    sndTcpTimsMsg(con, &replyMsg.head);
+}
+
 void mailbox_purge(connection_t *con)
 {
     tims_print("con[%02d]: Purge\n", con->index);
@@ -556,6 +712,9 @@ void signal_handler(int arg)
 void tcpConnection_task_proc(void *arg)
 {
     tims_msg_head*        tcpMsg;
+    tims_msg_head*        rawMsg;
+    tims_msg_head*        comprMsg;
+    tims_msg_head*        swapMsg;
     connection_t*         con = (connection_t*)arg;
     tims_msg_head         replyMsg;
     int                   forwardConIndex;
@@ -575,14 +734,26 @@ void tcpConnection_task_proc(void *arg)
     int flags = 1;
     setsockopt(con->socket, IPPROTO_TCP, TCP_NODELAY, (char*)&flags, sizeof(flags));
 
-    tcpMsg = malloc(maxMsgSize);
-    if (!tcpMsg)
+    con->loopback = connection_isLoopback(con);
+
+    tcpMsg   = malloc(maxMsgSize);
+    rawMsg   = malloc(maxMsgSize);
+    comprMsg = malloc(maxMsgSize);
+    if (!tcpMsg || !rawMsg || !comprMsg)
     {
         tims_print("con[%02d] ERROR: Can't allocate memory for tcpTimsMsg\n", idx);
+        free(tcpMsg);
+        free(rawMsg);
+        free(comprMsg);
         connection_close(con);
+        con->index = -1;
         return;
     }
 
+    sem_wait(&con->sendSem);
+    con->comprMsg = comprMsg;
+    sem_post(&con->sendSem);
+
     while (!terminate)
     {
         if (con->socket < 0)    // invalid socket
@@ -592,6 +763,17 @@ void tcpConnection_task_proc(void *arg)
         if (ret < 0)
             break;
 
+        // local receivers always get uncompressed messages
+        if (tcpMsg->flags & TIMS_BODY_COMPRESSED)
+        {
+            if (uncompressTcpTimsMsg(con, tcpMsg, rawMsg))
+                continue;
+
+            swapMsg = tcpMsg;
+            tcpMsg  = rawMsg;
+            rawMsg  = swapMsg;
+        }
+
         if ( !tcpMsg->dest &&
              !tcpMsg->src )  // handle TiMS command (internal)
         {
@@ -634,6 +816,10 @@ void tcpConnection_task_proc(void *arg)
                     con->watchdog        = 0;
                     break;
 
+                case TIMS_MSG_ROUTER_ENABLE_COMPRESSION:
+                    compression_init(con, tcpMsg);
+                    break;
+
                 default:
                     tims_print("con[%02d]: Received unexpected TiMS message %x -> %x type %i msglen %i\n",
                                idx, tcpMsg->src, tcpMsg->dest, tcpMsg->type, tcpMsg->msglen);
@@ -668,6 +854,14 @@ void tcpConnection_task_proc(void *arg)
     if (con->socket != -1)
         connection_close(con);
 
+    sem_wait(&con->sendSem);
+    con->comprCodec = TIMS_ROUTER_COMPR_NONE;
+    con->comprMsg   = NULL;
+    sem_post(&con->sendSem);
+
+    free(comprMsg);
+    free(rawMsg);
+
     if (tcpMsg)
     {
         free(tcpMsg);
@@ -883,8 +1077,9 @@ int main(int argc, char* argv[])
     tcpServerAddr.sin_addr.s_addr = INADDR_ANY;
     port = DEFAULT_PORT;
     maxMsgSize = DEFAULT_MAX * 1024;
+    comprThreshold = DEFAULT_COMPR;
 
-    while ((opt = getopt(argc, argv, "i:p:m:h:l:P:")) != -1)
+    while ((opt = getopt(argc, argv, "i:p:m:c:h:l:P:")) != -1)
     {
         switch (opt)
         {
@@ -910,6 +1105,11 @@ int main(int argc, char* argv[])
                 maxMsgSize *= 1024;
                 break;
 
+            case 'c':
+                sscanf(optarg, "%u", &comprThreshold);
+                tims_dbgdetail("opt -c compression threshold: %u bytes\n", comprThreshold);
+                break;
+
             case 'P':
                 sscanf(optarg, "%i", &sched_param.sched_priority);
                 tims_dbgdetail("opt -P priority: %i\n", sched_param.sched_priority);
@@ -927,6 +1127,8 @@ int main(int argc, char* argv[])
                 "   (default: 2000)\n"
                 "-m maxMessageSize in kBytes\n"
                 "   (default: 256 kByte)\n"
+                "-c min message body size in bytes to compress on remote links\n"
+                "   (default: 1024, 0 = compression disabled)\n"
                 "-l log level\n"
                 "   debug log level, 0 = silent, 1 = some important messages, 2 = verbose\n"
                 "-P RT-priority of the TimsClient\n"
@@ -55,9 +55,13 @@ typedef struct
 
 #define TIMS_HEADLEN        sizeof(tims_msg_head)       /**< @ingroup main_tims */
 
-/* TiMS flags (first byte of the head) */
+/* TiMS flags (first byte of the head), RTnet uses 0x04 and 0x08 */
 #define TIMS_HEAD_BYTEORDER_LE  0x01                    /**< @ingroup main_tims */
 #define TIMS_BODY_BYTEORDER_LE  0x02                    /**< @ingroup main_tims */
+/* trace context behind the data (main/rack_trace.h) */
+#define TIMS_HEAD_TRACE         0x10                    /**< @ingroup main_tims */
+/* body compressed by the TCP router (main/tims/tims_router.h) */
+#define TIMS_BODY_COMPRESSED    0x20                    /**< @ingroup main_tims */
 
 #define TIMS_INFINITE               (0)                 /**< @ingroup main_tims */
 #define TIMS_NONBLOCK               ((int64_t)-1)       /**< @ingroup main_tims */
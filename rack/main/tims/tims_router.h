@@ -40,6 +40,8 @@
 #define TIMS_MSG_ROUTER_ENABLE_WATCHDOG        18 // use router watchdog for this connection (default)
 #define TIMS_MSG_ROUTER_DISABLE_WATCHDOG       19 // don't use router watchdog
 
+#define TIMS_MSG_ROUTER_ENABLE_COMPRESSION     20 // offers codecs, replies TIMS_MSG_ROUTER_COMPRESSION
+
 //
 //  return / reply message types ( <=0 )
 //
@@ -48,6 +50,16 @@
 #define TIMS_MSG_ROUTER_CONFIG                -10
 #define TIMS_MSG_ROUTER_CONNECTED             -11
 
+// TcpRouter -> TimsClient
+#define TIMS_MSG_ROUTER_COMPRESSION           -12 // selected codec of this connection
+
+//
+// compression codecs (bit mask)
+//
+
+#define TIMS_ROUTER_COMPR_NONE                 0x00
+#define TIMS_ROUTER_COMPR_LZ                   0x01
+
 //######################################################################
 //# tims_router_mbx_msg
 //######################################################################
@@ -58,6 +70,21 @@ typedef struct
     uint32_t        mbx;
 } __attribute__((packed)) tims_router_mbx_msg;
 
+//######################################################################
+//# tims_router_compr_msg
+//######################################################################
+
+// Body of TIMS_MSG_ROUTER_ENABLE_COMPRESSION and TIMS_MSG_ROUTER_COMPRESSION.
+// Compressed messages are marked with TIMS_BODY_COMPRESSED. Their body starts
+// with the uncompressed body length (uint32_t, big endian) followed by the
+// compressed data.
+typedef struct
+{
+    tims_msg_head   head;
+    uint32_t        codec;          // TIMS_ROUTER_COMPR_... bit mask
+    uint32_t        threshold;      // min body size to compress (bytes)
+} __attribute__((packed)) tims_router_compr_msg;
+
 //######################################################################
 //# tims_router_mbx_msg parsing function
 //######################################################################
@@ -79,4 +106,27 @@ static inline tims_router_mbx_msg* tims_router_parse_mbx_msg(tims_msg_head* p)
     return returnP;
 }
 
+//######################################################################
+//# tims_router_compr_msg parsing function
+//######################################################################
+
+static inline tims_router_compr_msg* tims_router_parse_compr_msg(tims_msg_head* p)
+{
+    tims_router_compr_msg *returnP = (tims_router_compr_msg*)p;
+
+    if (returnP->head.flags & TIMS_BODY_BYTEORDER_LE)  // body is little endian
+    {
+        returnP->codec     = __le32_to_cpu(returnP->codec);
+        returnP->threshold = __le32_to_cpu(returnP->threshold);
+    }
+    else // body is big endian
+    {
+        returnP->codec     = __be32_to_cpu(returnP->codec);
+        returnP->threshold = __be32_to_cpu(returnP->threshold);
+    }
+
+    tims_set_body_byteorder(p);
+    return returnP;
+}
+
 #endif // __TIMS_ROUTER_H_
@@ -15,17 +15,36 @@
  */
 
 #include <main/camera_tool.h>
+#include <drivers/camera_proxy.h>
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
 
 CameraTool::CameraTool()
 {
     gdos = NULL;
     initColorTables();
+
+    toneBlackLevel = -1;
+    toneWhiteLevel = -1;
+    toneGamma      = 0.0f;
 }
 
 CameraTool::CameraTool(RackMailbox *p_mbx, int gdos_level)
 {
     gdos = new RackGdos(p_mbx, gdos_level);
     initColorTables();
+
+    toneBlackLevel = -1;
+    toneWhiteLevel = -1;
+    toneGamma      = 0.0f;
 }
 
 CameraTool::~CameraTool()
@@ -91,112 +110,1072 @@ int CameraTool::clip(int in)
     return in;
 }
 
-int CameraTool::convertCharUYVY2RGB(uint8_t* outputData, uint8_t* inputData,
-                        int width, int height)
+/*******************************************************************************
+ *   instruction set selection
+ ******************************************************************************/
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+#define CAMERA_TOOL_USE_AVX2
+#define CAMERA_TOOL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+static int cameraToolSimdMax = -1;
+static int cameraToolSimd    = -1;
+
+static int simdGet(void)
 {
-    int i,j;
-    int u,y0,v,y1;
+    if (cameraToolSimdMax < 0)
+    {
+        cameraToolSimdMax = CAMERA_TOOL_SIMD_NONE;
+#ifdef __SSE2__
+        cameraToolSimdMax = CAMERA_TOOL_SIMD_SSE2;
+#endif
+#ifdef CAMERA_TOOL_USE_AVX2
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            cameraToolSimdMax = CAMERA_TOOL_SIMD_AVX2;
+        }
+#endif
+    }
+    if (cameraToolSimd < 0)
+    {
+        cameraToolSimd = cameraToolSimdMax;
+    }
+    return cameraToolSimd;
+}
 
-    for (i = 0; i < height; i++)
+// limits the instruction set (e.g. for benchmarks), returns the used one
+int CameraTool::setSimd(int simd)
+{
+    simdGet();
+
+    if ((simd < CAMERA_TOOL_SIMD_NONE) || (simd > cameraToolSimdMax))
     {
-        for (j = 0; j < width; j += 2) //step = 2
-        {//handling 4 byte <=> 2 pixel each turn
-            u  = (int) (0xff & inputData[2 * (i * width + j) + 0]);
-            y0 = (int) (0xff & inputData[2 * (i * width + j) + 1]);
-            v  = (int) (0xff & inputData[2 * (i * width + j) + 2]);
-            y1 = (int) (0xff & inputData[2 * (i * width + j) + 3]);
+        simd = cameraToolSimdMax;
+    }
+    cameraToolSimd = simd;
+    return simd;
+}
+
+int CameraTool::getSimd(void)
+{
+    return simdGet();
+}
 
-            outputData[3 * (i * width + j) + 2] = (uint8_t) clip(( 298 * (y0-16)                 + 409 * (v-128) + 128) >> 8);//bo
-            outputData[3 * (i * width + j) + 1] = (uint8_t) clip(( 298 * (y0-16) - 100 * (u-128) - 208 * (v-128) + 128) >> 8);//g0
-            outputData[3 * (i * width + j) + 0] = (uint8_t) clip(( 298 * (y0-16) + 516 * (u-128)                 + 128) >> 8);//r0
+/*******************************************************************************
+ *   row parallel execution
+ ******************************************************************************/
 
-            outputData[3 * (i * width + j) + 5] = (uint8_t) clip(( 298 * (y1-16)                 + 409 * (v-128) + 128) >> 8);
-            outputData[3 * (i * width + j) + 4] = (uint8_t) clip(( 298 * (y1-16) - 100 * (u-128) - 208 * (v-128) + 128) >> 8);
-            outputData[3 * (i * width + j) + 3] = (uint8_t) clip(( 298 * (y1-16) + 516 * (u-128)                 + 128) >> 8);
+typedef struct camera_tool_job camera_tool_job;
+
+typedef void (*camera_tool_row_func)(camera_tool_job *job, int row);
+
+struct camera_tool_job
+{
+    camera_tool_row_func    rowFunc;
+    uint8_t                 *out;
+    const uint8_t           *in;
+    int                     width;
+    int                     height;
+    int                     simd;
+    int                     param;          // function specific
+    const uint8_t           *table;         // function specific
+};
+
+typedef struct
+{
+    camera_tool_job         *job;
+    int                     rowFirst;
+    int                     rowLast;
+} camera_tool_block;
+
+static void *rowBlockRun(void *arg)
+{
+    camera_tool_block   *block = (camera_tool_block *)arg;
+    int                 row;
+
+    for (row = block->rowFirst; row < block->rowLast; row++)
+    {
+        block->job->rowFunc(block->job, row);
+    }
+    return NULL;
+}
+
+// runs job->rowFunc for all rows, split into blocks of threads
+static void rowsRun(camera_tool_job *job, int threads)
+{
+    camera_tool_block   block[CAMERA_TOOL_THREAD_MAX];
+    pthread_t           thread[CAMERA_TOOL_THREAD_MAX];
+    int                 started[CAMERA_TOOL_THREAD_MAX];
+    int                 i;
+
+    job->simd = simdGet();
+
+    if (threads > CAMERA_TOOL_THREAD_MAX)
+    {
+        threads = CAMERA_TOOL_THREAD_MAX;
+    }
+    if (threads > job->height / 16)
+    {
+        threads = job->height / 16;
+    }
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+
+    for (i = 0; i < threads; i++)
+    {
+        block[i].job      = job;
+        block[i].rowFirst = job->height * i / threads;
+        block[i].rowLast  = job->height * (i + 1) / threads;
+        started[i]        = 0;
+    }
+
+    // the calling thread converts the first block
+    for (i = 1; i < threads; i++)
+    {
+        started[i] = !pthread_create(&thread[i], NULL, rowBlockRun, &block[i]);
+    }
+
+    rowBlockRun(&block[0]);
+
+    for (i = 1; i < threads; i++)
+    {
+        if (started[i])
+        {
+            pthread_join(thread[i], NULL);
+        }
+        else
+        {
+            rowBlockRun(&block[i]);
         }
     }
-    return 0;
 }
 
+// mirrors an index at the image border (keeps the bayer pattern parity)
+static inline int mirror(int i, int n)
+{
+    if (i < 0)
+    {
+        return -i;
+    }
+    if (i >= n)
+    {
+        return 2 * n - 2 - i;
+    }
+    return i;
+}
 
-int CameraTool::convertCharUYVY2BGR(uint8_t* outputData, uint8_t* inputData,
-                               int width, int height)
+/*******************************************************************************
+ *   UYVY -> RGB / BGR
+ *
+ *   R = (298 * (Y - 16)                 + 409 * (V - 128) + 128) >> 8
+ *   G = (298 * (Y - 16) - 100 * (U - 128) - 208 * (V - 128) + 128) >> 8
+ *   B = (298 * (Y - 16) + 516 * (U - 128)                 + 128) >> 8
+ *
+ *   job->param is the byte index of red (0 = RGB, 2 = BGR)
+ ******************************************************************************/
+
+static void uyvyRowScalar(uint8_t *out, const uint8_t *in, int x, int width, int rIdx)
 {
-    int i,j;
-    int u,y0,v,y1;
+    int u, v, y0, y1, rr, gg, bb;
 
-    for (i = 0; i < height; i++)
+    out += 3 * x;
+    in  += 2 * x;
+
+    for (; x < width; x += 2)
     {
-        for (j = 0; j < width; j += 2) //step = 2
-        {//handling 4 byte <=> 2 pixel each turn
-            u  = (int) (0xff & inputData[2 * (i * width + j) + 0]);
-            y0 = (int) (0xff & inputData[2 * (i * width + j) + 1]);
-            v  = (int) (0xff & inputData[2 * (i * width + j) + 2]);
-            y1 = (int) (0xff & inputData[2 * (i * width + j) + 3]);
-            outputData[3 * (i * width + j) + 0] = (uint8_t) clip(( 298 * (y0-16)                 + 409 * (v-128) + 128) >> 8);//bo
-            outputData[3 * (i * width + j) + 1] = (uint8_t) clip(( 298 * (y0-16) - 100 * (u-128) - 208 * (v-128) + 128) >> 8);//g0
-            outputData[3 * (i * width + j) + 2] = (uint8_t) clip(( 298 * (y0-16) + 516 * (u-128)                 + 128) >> 8);//r0
+        u  = in[0] - 128;
+        y0 = 298 * (in[1] - 16);
+        v  = in[2] - 128;
+        y1 = 298 * (in[3] - 16);
+
+        rr = 409 * v + 128;
+        gg = -100 * u - 208 * v + 128;
+        bb = 516 * u + 128;
+
+        out[rIdx]     = (uint8_t)CameraTool::clip((y0 + rr) >> 8);
+        out[1]        = (uint8_t)CameraTool::clip((y0 + gg) >> 8);
+        out[2 - rIdx] = (uint8_t)CameraTool::clip((y0 + bb) >> 8);
 
-            outputData[3 * (i * width + j) + 3] = (uint8_t) clip(( 298 * (y1-16)                 + 409 * (v-128) + 128) >> 8);
-            outputData[3 * (i * width + j) + 4] = (uint8_t) clip(( 298 * (y1-16) - 100 * (u-128) - 208 * (v-128) + 128) >> 8);
-            outputData[3 * (i * width + j) + 5] = (uint8_t) clip(( 298 * (y1-16) + 516 * (u-128)                 + 128) >> 8);
+        if (x + 1 < width)
+        {
+            out[3 + rIdx] = (uint8_t)CameraTool::clip((y1 + rr) >> 8);
+            out[4]        = (uint8_t)CameraTool::clip((y1 + gg) >> 8);
+            out[5 - rIdx] = (uint8_t)CameraTool::clip((y1 + bb) >> 8);
         }
+
+        out += 6;
+        in  += 4;
     }
+}
+
+#ifdef __SSE2__
+
+// stores 8 pixels of three 8 bit channels (low 8 bytes) as 24 bit pixels,
+// writes one byte beyond the last pixel
+static inline void rgbStoreSse2(uint8_t *out, __m128i c0, __m128i c1, __m128i c2)
+{
+    __m128i     c01, c2z, px;
+    uint32_t    pixel[8];
+    int         i;
+
+    c01 = _mm_unpacklo_epi8(c0, c1);
+    c2z = _mm_unpacklo_epi8(c2, _mm_setzero_si128());
+
+    px  = _mm_unpacklo_epi16(c01, c2z);
+    _mm_storeu_si128((__m128i *)&pixel[0], px);
+    px  = _mm_unpackhi_epi16(c01, c2z);
+    _mm_storeu_si128((__m128i *)&pixel[4], px);
+
+    for (i = 0; i < 8; i++)
+    {
+        memcpy(out + 3 * i, &pixel[i], 4);
+    }
+}
+
+// converts 8 pixels into 16 bit words of the three channels
+static inline void uyvyToRgb16Sse2(const uint8_t *in, __m128i *r, __m128i *g, __m128i *b)
+{
+    const __m128i   mask  = _mm_set1_epi16(0x00ff);
+    const __m128i   round = _mm_set1_epi32(128);
+    const __m128i   kR    = _mm_set_epi16(409, 298, 409, 298, 409, 298, 409, 298);
+    const __m128i   kG    = _mm_set_epi16(-100, 298, -100, 298, -100, 298, -100, 298);
+    const __m128i   kG2   = _mm_set_epi16(128, -208, 128, -208, 128, -208, 128, -208);
+    const __m128i   kB    = _mm_set_epi16(516, 298, 516, 298, 516, 298, 516, 298);
+    const __m128i   one   = _mm_set1_epi16(1);
+    __m128i         x, y, uv, u, v, lo, hi;
+
+    x  = _mm_loadu_si128((const __m128i *)in);
+    y  = _mm_sub_epi16(_mm_srli_epi16(x, 8), _mm_set1_epi16(16));
+    uv = _mm_sub_epi16(_mm_and_si128(x, mask), _mm_set1_epi16(128));
+
+    // u0 u0 u1 u1 ... and v0 v0 v1 v1 ...
+    u  = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, 0xa0), 0xa0);
+    v  = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, 0xf5), 0xf5);
+
+    lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(y, v), kR), round);
+    hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(y, v), kR), round);
+    *r = _mm_packs_epi32(_mm_srai_epi32(lo, 8), _mm_srai_epi32(hi, 8));
+
+    lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(y, u), kG),
+                       _mm_madd_epi16(_mm_unpacklo_epi16(v, one), kG2));
+    hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(y, u), kG),
+                       _mm_madd_epi16(_mm_unpackhi_epi16(v, one), kG2));
+    *g = _mm_packs_epi32(_mm_srai_epi32(lo, 8), _mm_srai_epi32(hi, 8));
+
+    lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(y, u), kB), round);
+    hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(y, u), kB), round);
+    *b = _mm_packs_epi32(_mm_srai_epi32(lo, 8), _mm_srai_epi32(hi, 8));
+}
+
+static int uyvyRowSse2(uint8_t *out, const uint8_t *in, int width, int rIdx)
+{
+    __m128i r, g, b, zero = _mm_setzero_si128();
+    int     x;
+
+    for (x = 0; x + 9 <= width; x += 8)
+    {
+        uyvyToRgb16Sse2(in + 2 * x, &r, &g, &b);
+
+        r = _mm_packus_epi16(r, zero);
+        g = _mm_packus_epi16(g, zero);
+        b = _mm_packus_epi16(b, zero);
+
+        if (rIdx == 0)
+        {
+            rgbStoreSse2(out + 3 * x, r, g, b);
+        }
+        else
+        {
+            rgbStoreSse2(out + 3 * x, b, g, r);
+        }
+    }
+    return x;
+}
+
+#endif // __SSE2__
+
+#ifdef CAMERA_TOOL_USE_AVX2
+
+// stores 16 pixels of three 8 bit channels (per lane low 8 bytes) as 24 bit
+// pixels, writes 4 bytes beyond the last pixel
+CAMERA_TOOL_TARGET_AVX2
+static inline void rgbStoreAvx2(uint8_t *out, __m256i c0, __m256i c1, __m256i c2)
+{
+    const __m256i   compact = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+                                               -1, -1, -1, -1,
+                                               0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+                                               -1, -1, -1, -1);
+    __m256i         c01, c2z, lo, hi;
+
+    c01 = _mm256_unpacklo_epi8(c0, c1);
+    c2z = _mm256_unpacklo_epi8(c2, _mm256_setzero_si256());
+
+    // lane 0: pixel 0-3 and 4-7, lane 1: pixel 8-11 and 12-15
+    lo  = _mm256_shuffle_epi8(_mm256_unpacklo_epi16(c01, c2z), compact);
+    hi  = _mm256_shuffle_epi8(_mm256_unpackhi_epi16(c01, c2z), compact);
+
+    _mm_storeu_si128((__m128i *)(out +  0), _mm256_castsi256_si128(lo));
+    _mm_storeu_si128((__m128i *)(out + 12), _mm256_castsi256_si128(hi));
+    _mm_storeu_si128((__m128i *)(out + 24), _mm256_extracti128_si256(lo, 1));
+    _mm_storeu_si128((__m128i *)(out + 36), _mm256_extracti128_si256(hi, 1));
+}
+
+CAMERA_TOOL_TARGET_AVX2
+static int uyvyRowAvx2(uint8_t *out, const uint8_t *in, int width, int rIdx)
+{
+    const __m256i   mask  = _mm256_set1_epi16(0x00ff);
+    const __m256i   round = _mm256_set1_epi32(128);
+    const __m256i   kR    = _mm256_broadcastsi128_si256(_mm_set_epi16(409, 298, 409, 298,
+                                                                       409, 298, 409, 298));
+    const __m256i   kG    = _mm256_broadcastsi128_si256(_mm_set_epi16(-100, 298, -100, 298,
+                                                                       -100, 298, -100, 298));
+    const __m256i   kG2   = _mm256_broadcastsi128_si256(_mm_set_epi16(128, -208, 128, -208,
+                                                                       128, -208, 128, -208));
+    const __m256i   kB    = _mm256_broadcastsi128_si256(_mm_set_epi16(516, 298, 516, 298,
+                                                                       516, 298, 516, 298));
+    const __m256i   one   = _mm256_set1_epi16(1);
+    const __m256i   zero  = _mm256_setzero_si256();
+    __m256i         x8, y, uv, u, v, lo, hi, r, g, b;
+    int             x;
+
+    for (x = 0; x + 18 <= width; x += 16)
+    {
+        x8 = _mm256_loadu_si256((const __m256i *)(in + 2 * x));
+        y  = _mm256_sub_epi16(_mm256_srli_epi16(x8, 8), _mm256_set1_epi16(16));
+        uv = _mm256_sub_epi16(_mm256_and_si256(x8, mask), _mm256_set1_epi16(128));
+
+        u  = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(uv, 0xa0), 0xa0);
+        v  = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(uv, 0xf5), 0xf5);
+
+        lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(y, v), kR), round);
+        hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(y, v), kR), round);
+        r  = _mm256_packs_epi32(_mm256_srai_epi32(lo, 8), _mm256_srai_epi32(hi, 8));
+
+        lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(y, u), kG),
+                              _mm256_madd_epi16(_mm256_unpacklo_epi16(v, one), kG2));
+        hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(y, u), kG),
+                              _mm256_madd_epi16(_mm256_unpackhi_epi16(v, one), kG2));
+        g  = _mm256_packs_epi32(_mm256_srai_epi32(lo, 8), _mm256_srai_epi32(hi, 8));
+
+        lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(y, u), kB), round);
+        hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(y, u), kB), round);
+        b  = _mm256_packs_epi32(_mm256_srai_epi32(lo, 8), _mm256_srai_epi32(hi, 8));
+
+        r  = _mm256_packus_epi16(r, zero);
+        g  = _mm256_packus_epi16(g, zero);
+        b  = _mm256_packus_epi16(b, zero);
+
+        if (rIdx == 0)
+        {
+            rgbStoreAvx2(out + 3 * x, r, g, b);
+        }
+        else
+        {
+            rgbStoreAvx2(out + 3 * x, b, g, r);
+        }
+    }
+    return x;
+}
+
+CAMERA_TOOL_TARGET_AVX2
+static int uyvyGrayRowAvx2(uint8_t *out, const uint8_t *in, int width)
+{
+    __m256i a, b;
+    int     x;
+
+    for (x = 0; x + 32 <= width; x += 32)
+    {
+        a = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i *)(in + 2 * x)), 8);
+        b = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i *)(in + 2 * x + 32)), 8);
+
+        // packus works per lane -> restore the pixel order
+        a = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+        _mm256_storeu_si256((__m256i *)(out + x), a);
+    }
+    return x;
+}
+
+// 5 pixels per shuffle, the 16th byte is written unchanged (in place safe)
+CAMERA_TOOL_TARGET_AVX2
+static int bgrRowAvx2(uint8_t *out, const uint8_t *in, int width)
+{
+    const __m128i   swap = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+    __m128i         v;
+    int             x;
+
+    for (x = 0; x + 6 <= width; x += 5)
+    {
+        v = _mm_loadu_si128((const __m128i *)(in + 3 * x));
+        _mm_storeu_si128((__m128i *)(out + 3 * x), _mm_shuffle_epi8(v, swap));
+    }
+    return x;
+}
+
+CAMERA_TOOL_TARGET_AVX2
+static int rgbMonoRowAvx2(uint8_t *out, const uint8_t *in, int width)
+{
+    const __m256i   rg   = _mm256_setr_epi8(0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1,
+                                            0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1);
+    const __m256i   bz   = _mm256_setr_epi8(2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1,
+                                            2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1);
+    const __m256i   kRG  = _mm256_set1_epi32((6 << 16) | 3);
+    const __m256i   kB   = _mm256_set1_epi32(1);
+    const __m256i   kDiv = _mm256_set1_epi32(52429);
+    __m256i         v, sum;
+    uint32_t        pixel;
+    int             x;
+
+    for (x = 0; x + 10 <= width; x += 8)
+    {
+        // lane 0: pixel 0-3, lane 1: pixel 4-7
+        v   = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(in + 3 * x)));
+        v   = _mm256_inserti128_si256(v, _mm_loadu_si128((const __m128i *)(in + 3 * x + 12)), 1);
+
+        sum = _mm256_add_epi32(_mm256_madd_epi16(_mm256_shuffle_epi8(v, rg), kRG),
+                               _mm256_madd_epi16(_mm256_shuffle_epi8(v, bz), kB));
+        sum = _mm256_srli_epi32(_mm256_mullo_epi32(sum, kDiv), 19);
+        sum = _mm256_packus_epi16(_mm256_packs_epi32(sum, sum), sum);
+
+        pixel = _mm_cvtsi128_si32(_mm256_castsi256_si128(sum));
+        memcpy(out + x, &pixel, 4);
+        pixel = _mm_cvtsi128_si32(_mm256_extracti128_si256(sum, 1));
+        memcpy(out + x + 4, &pixel, 4);
+    }
+    return x;
+}
+
+#endif // CAMERA_TOOL_USE_AVX2
+
+static void uyvyRow(camera_tool_job *job, int row)
+{
+    uint8_t         *out = job->out + 3 * row * job->width;
+    const uint8_t   *in  = job->in  + 2 * row * job->width;
+    int             x    = 0;
+
+#ifdef CAMERA_TOOL_USE_AVX2
+    if (job->simd >= CAMERA_TOOL_SIMD_AVX2)
+    {
+        x = uyvyRowAvx2(out, in, job->width, job->param);
+    }
+#endif
+#ifdef __SSE2__
+    if (job->simd >= CAMERA_TOOL_SIMD_SSE2)
+    {
+        x += uyvyRowSse2(out + 3 * x, in + 2 * x, job->width - x, job->param);
+    }
+#endif
+    uyvyRowScalar(out, in, x, job->width, job->param);
+}
+
+int CameraTool::convertCharUYVY2RGB(uint8_t* outputData, uint8_t* inputData,
+                        int width, int height, int threads)
+{
+    camera_tool_job job;
+
+    job.rowFunc = uyvyRow;
+    job.out     = outputData;
+    job.in      = inputData;
+    job.width   = width;
+    job.height  = height;
+    job.param   = 0;
+
+    rowsRun(&job, threads);
     return 0;
 }
 
 
-int CameraTool::convertCharUYVY2Gray(uint8_t* outputData, uint8_t* inputData,
-                                int width, int height)
+int CameraTool::convertCharUYVY2BGR(uint8_t* outputData, uint8_t* inputData,
+                               int width, int height, int threads)
 {
-    int i,j;
+    camera_tool_job job;
 
-    for (i = 0; i < height; i++)
+    job.rowFunc = uyvyRow;
+    job.out     = outputData;
+    job.in      = inputData;
+    job.width   = width;
+    job.height  = height;
+    job.param   = 2;
+
+    rowsRun(&job, threads);
+    return 0;
+}
+
+/*******************************************************************************
+ *   UYVY -> Gray
+ ******************************************************************************/
+
+static void uyvyGrayRow(camera_tool_job *job, int row)
+{
+    uint8_t         *out = job->out + row * job->width;
+    const uint8_t   *in  = job->in  + 2 * row * job->width;
+    int             x    = 0;
+
+#ifdef CAMERA_TOOL_USE_AVX2
+    if (job->simd >= CAMERA_TOOL_SIMD_AVX2)
     {
-        for (j = 0; j < width; j++ )
+        x = uyvyGrayRowAvx2(out, in, job->width);
+    }
+#endif
+#ifdef __SSE2__
+    if (job->simd >= CAMERA_TOOL_SIMD_SSE2)
+    {
+        for (; x + 16 <= job->width; x += 16)
         {
-            outputData[i * width + j] = inputData[(2 * (i * width + j)) + 1];
+            __m128i a = _mm_srli_epi16(_mm_loadu_si128((const __m128i *)(in + 2 * x)), 8);
+            __m128i b = _mm_srli_epi16(_mm_loadu_si128((const __m128i *)(in + 2 * x + 16)), 8);
+
+            _mm_storeu_si128((__m128i *)(out + x), _mm_packus_epi16(a, b));
         }
     }
+#endif
+    for (; x < job->width; x++)
+    {
+        out[x] = in[2 * x + 1];
+    }
+}
+
+int CameraTool::convertCharUYVY2Gray(uint8_t* outputData, uint8_t* inputData,
+                                int width, int height, int threads)
+{
+    camera_tool_job job;
+
+    job.rowFunc = uyvyGrayRow;
+    job.out     = outputData;
+    job.in      = inputData;
+    job.width   = width;
+    job.height  = height;
+
+    rowsRun(&job, threads);
     return 0;
 }
 
+/*******************************************************************************
+ *   BGR -> RGB (may be done in place)
+ ******************************************************************************/
+
+static void bgrRow(camera_tool_job *job, int row)
+{
+    uint8_t         *out = job->out + 3 * row * job->width;
+    const uint8_t   *in  = job->in  + 3 * row * job->width;
+    uint8_t         swap;
+    int             x    = 0;
+
+#ifdef CAMERA_TOOL_USE_AVX2
+    if (job->simd >= CAMERA_TOOL_SIMD_AVX2)
+    {
+        x = bgrRowAvx2(out, in, job->width);
+    }
+#endif
+    for (; x < job->width; x++)
+    {
+        swap           = in[3 * x];
+        out[3 * x]     = in[3 * x + 2];
+        out[3 * x + 1] = in[3 * x + 1];
+        out[3 * x + 2] = swap;
+    }
+}
+
 int CameraTool::convertCharBGR2RGB(uint8_t* outputData, uint8_t* inputData,
-                                int width, int height)
+                                int width, int height, int threads)
 {
-    int i,j;
-    uint8_t swap;
+    camera_tool_job job;
 
-    for (i = 0; i < height; i++)
+    job.rowFunc = bgrRow;
+    job.out     = outputData;
+    job.in      = inputData;
+    job.width   = width;
+    job.height  = height;
+
+    rowsRun(&job, threads);
+    return 0;
+}
+
+/*******************************************************************************
+ *   RGB -> MONO8
+ *
+ *   Y = (3 * R + 6 * G + B) / 10, the division is done by a multiplication
+ *   with 52429 / 2^19 (exact for the whole input range)
+ ******************************************************************************/
+
+static void rgbMonoRow(camera_tool_job *job, int row)
+{
+    uint8_t         *out = job->out + row * job->width;
+    const uint8_t   *in  = job->in  + 3 * row * job->width;
+    uint32_t        sum;
+    int             x    = 0;
+
+#ifdef CAMERA_TOOL_USE_AVX2
+    if (job->simd >= CAMERA_TOOL_SIMD_AVX2)
     {
-        for (j = 0; j < width; j++ )
+        x = rgbMonoRowAvx2(out, in, job->width);
+    }
+#endif
+    for (; x < job->width; x++)
+    {
+        sum    = 3 * in[3 * x] + 6 * in[3 * x + 1] + in[3 * x + 2];
+        out[x] = (uint8_t)((sum * 52429) >> 19);
+    }
+}
+
+int CameraTool::convertCharRGB2MONO8(uint8_t* outputData, uint8_t* inputData,
+                                int width, int height, int threads)
+{
+    camera_tool_job job;
+
+    job.rowFunc = rgbMonoRow;
+    job.out     = outputData;
+    job.in      = inputData;
+    job.width   = width;
+    job.height  = height;
+
+    rowsRun(&job, threads);
+    return 0;
+}
+
+/*******************************************************************************
+ *   Bayer -> RGB
+ *
+ *   Bilinear: every missing color is the mean of the nearest two or four
+ *   neighbours of this color (with rounding).
+ *
+ *   Edge aware: green is interpolated along the direction of the smaller
+ *   gradient (Hamilton-Adams, with laplacian correction), red and blue are
+ *   interpolated from the color differences to green. The green plane is
+ *   written first, so the red / blue pass can use the green values of the
+ *   neighbour rows.
+ ******************************************************************************/
+
+#define BAYER_R     0
+#define BAYER_G     1
+#define BAYER_B     2
+
+// source of an output channel
+#define BAYER_SRC_C     0       // center
+#define BAYER_SRC_HZ    1       // left and right
+#define BAYER_SRC_VT    2       // up and down
+#define BAYER_SRC_CROSS 3       // left, right, up and down
+#define BAYER_SRC_DIAG  4       // diagonal neighbours
+
+// color of the pixel at (row, col), rows and cols are taken modulo 2
+static inline int bayerColor(int colorFilterId, int row, int col)
+{
+    static const uint8_t pattern[4][4] = {
+        { BAYER_R, BAYER_G, BAYER_G, BAYER_B },     // RGGB
+        { BAYER_G, BAYER_B, BAYER_R, BAYER_G },     // GBRG
+        { BAYER_G, BAYER_R, BAYER_B, BAYER_G },     // GRBG
+        { BAYER_B, BAYER_G, BAYER_G, BAYER_R },     // BGGR
+    };
+
+    return pattern[colorFilterId - COLORFILTER_RGGB][((row & 1) << 1) | (col & 1)];
+}
+
+// source of channel ch for the even (index 0) and odd (index 1) pixels of a row
+static void bayerRowSources(int colorFilterId, int row, int src[3][2])
+{
+    int ch, p, site, hzColor;
+
+    for (p = 0; p < 2; p++)
+    {
+        site    = bayerColor(colorFilterId, row, p);
+        hzColor = bayerColor(colorFilterId, row, p + 1);
+
+        for (ch = 0; ch < 3; ch++)
+        {
+            if (ch == site)
+            {
+                src[ch][p] = BAYER_SRC_C;
+            }
+            else if (ch == BAYER_G)
+            {
+                src[ch][p] = BAYER_SRC_CROSS;
+            }
+            else if (site == BAYER_G)
+            {
+                src[ch][p] = (ch == hzColor) ? BAYER_SRC_HZ : BAYER_SRC_VT;
+            }
+            else
+            {
+                src[ch][p] = BAYER_SRC_DIAG;
+            }
+        }
+    }
+}
+
+static void bayerPixelBilinear(uint8_t *out, const uint8_t *up, const uint8_t *cur,
+                               const uint8_t *dn, int xl, int x, int xr, int src[3][2])
+{
+    int val[5], ch;
+
+    val[BAYER_SRC_C]     = cur[x];
+    val[BAYER_SRC_HZ]    = (cur[xl] + cur[xr] + 1) >> 1;
+    val[BAYER_SRC_VT]    = (up[x] + dn[x] + 1) >> 1;
+    val[BAYER_SRC_CROSS] = (cur[xl] + cur[xr] + up[x] + dn[x] + 2) >> 2;
+    val[BAYER_SRC_DIAG]  = (up[xl] + up[xr] + dn[xl] + dn[xr] + 2) >> 2;
+
+    for (ch = 0; ch < 3; ch++)
+    {
+        out[3 * x + ch] = (uint8_t)val[src[ch][x & 1]];
+    }
+}
+
+#ifdef __SSE2__
+
+static inline __m128i selectSse2(__m128i mask, __m128i even, __m128i odd)
+{
+    return _mm_or_si128(_mm_and_si128(mask, even), _mm_andnot_si128(mask, odd));
+}
+
+// x has to be even, returns the first pixel that is not converted
+static int bayerRowBilinearSse2(uint8_t *out, const uint8_t *up, const uint8_t *cur,
+                                const uint8_t *dn, int x, int width, int src[3][2])
+{
+    const __m128i   zero = _mm_setzero_si128();
+    const __m128i   two  = _mm_set1_epi16(2);
+    const __m128i   even = _mm_set1_epi32(0x0000ffff);
+    __m128i         val[5], ch[3], c, l, r, u, d, ul, ur, dl, dr;
+    int             i;
+
+    for (; x + 9 <= width; x += 8)
+    {
+        c  = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(cur + x)), zero);
+        l  = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(cur + x - 1)), zero);
+        r  = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(cur + x + 1)), zero);
+        u  = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(up  + x)), zero);
+        d  = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(dn  + x)), zero);
+        ul = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(up  + x - 1)), zero);
+        ur = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(up  + x + 1)), zero);
+        dl = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(dn  + x - 1)), zero);
+        dr = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(dn  + x + 1)), zero);
+
+        val[BAYER_SRC_C]     = c;
+        val[BAYER_SRC_HZ]    = _mm_avg_epu16(l, r);
+        val[BAYER_SRC_VT]    = _mm_avg_epu16(u, d);
+        val[BAYER_SRC_CROSS] = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(l, r),
+                                              _mm_add_epi16(_mm_add_epi16(u, d), two)), 2);
+        val[BAYER_SRC_DIAG]  = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(ul, ur),
+                                              _mm_add_epi16(_mm_add_epi16(dl, dr), two)), 2);
+
+        for (i = 0; i < 3; i++)
+        {
+            ch[i] = _mm_packus_epi16(selectSse2(even, val[src[i][0]], val[src[i][1]]), zero);
+        }
+
+        rgbStoreSse2(out + 3 * x, ch[0], ch[1], ch[2]);
+    }
+    return x;
+}
+
+#endif // __SSE2__
+
+#ifdef CAMERA_TOOL_USE_AVX2
+
+CAMERA_TOOL_TARGET_AVX2
+static inline __m256i loadAvx2(const uint8_t *p)
+{
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)p));
+}
+
+// x has to be even, returns the first pixel that is not converted
+CAMERA_TOOL_TARGET_AVX2
+static int bayerRowBilinearAvx2(uint8_t *out, const uint8_t *up, const uint8_t *cur,
+                                const uint8_t *dn, int x, int width, int src[3][2])
+{
+    const __m256i   zero = _mm256_setzero_si256();
+    const __m256i   two  = _mm256_set1_epi16(2);
+    const __m256i   even = _mm256_set1_epi32(0x0000ffff);
+    __m256i         val[5], ch[3], c, l, r, u, d, ul, ur, dl, dr, odd;
+    int             i;
+
+    for (; x + 18 <= width; x += 16)
+    {
+        c  = loadAvx2(cur + x);
+        l  = loadAvx2(cur + x - 1);
+        r  = loadAvx2(cur + x + 1);
+        u  = loadAvx2(up  + x);
+        d  = loadAvx2(dn  + x);
+        ul = loadAvx2(up  + x - 1);
+        ur = loadAvx2(up  + x + 1);
+        dl = loadAvx2(dn  + x - 1);
+        dr = loadAvx2(dn  + x + 1);
+
+        val[BAYER_SRC_C]     = c;
+        val[BAYER_SRC_HZ]    = _mm256_avg_epu16(l, r);
+        val[BAYER_SRC_VT]    = _mm256_avg_epu16(u, d);
+        val[BAYER_SRC_CROSS] = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(l, r),
+                                                 _mm256_add_epi16(_mm256_add_epi16(u, d), two)), 2);
+        val[BAYER_SRC_DIAG]  = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(ul, ur),
+                                                 _mm256_add_epi16(_mm256_add_epi16(dl, dr), two)), 2);
+
+        for (i = 0; i < 3; i++)
+        {
+            odd   = _mm256_andnot_si256(even, val[src[i][1]]);
+            ch[i] = _mm256_or_si256(_mm256_and_si256(even, val[src[i][0]]), odd);
+            ch[i] = _mm256_packus_epi16(ch[i], zero);
+        }
+
+        rgbStoreAvx2(out + 3 * x, ch[0], ch[1], ch[2]);
+    }
+    return x;
+}
+
+#endif // CAMERA_TOOL_USE_AVX2
+
+static void bayerRowBilinear(camera_tool_job *job, int row)
+{
+    int             width = job->width;
+    uint8_t         *out  = job->out + 3 * row * width;
+    const uint8_t   *cur  = job->in + row * width;
+    const uint8_t   *up   = job->in + mirror(row - 1, job->height) * width;
+    const uint8_t   *dn   = job->in + mirror(row + 1, job->height) * width;
+    int             src[3][2];
+    int             x;
+
+    bayerRowSources(job->param, row, src);
+
+    // first pixels with mirrored left neighbour
+    bayerPixelBilinear(out, up, cur, dn, 1, 0, 1, src);
+    bayerPixelBilinear(out, up, cur, dn, 0, 1, mirror(2, width), src);
+    x = 2;
+
+#ifdef CAMERA_TOOL_USE_AVX2
+    if (job->simd >= CAMERA_TOOL_SIMD_AVX2)
+    {
+        x = bayerRowBilinearAvx2(out, up, cur, dn, x, width, src);
+    }
+#endif
+#ifdef __SSE2__
+    if (job->simd >= CAMERA_TOOL_SIMD_SSE2)
+    {
+        x = bayerRowBilinearSse2(out, up, cur, dn, x, width, src);
+    }
+#endif
+    for (; x < width; x++)
+    {
+        bayerPixelBilinear(out, up, cur, dn, x - 1, x, mirror(x + 1, width), src);
+    }
+}
+
+// pass 1 of the edge aware demosaic, writes the green channel
+static void bayerRowEdgeGreen(camera_tool_job *job, int row)
+{
+    int             width  = job->width;
+    int             height = job->height;
+    uint8_t         *out   = job->out + 3 * row * width;
+    const uint8_t   *in    = job->in;
+    const uint8_t   *cur   = in + row * width;
+    const uint8_t   *up    = in + mirror(row - 1, height) * width;
+    const uint8_t   *dn    = in + mirror(row + 1, height) * width;
+    const uint8_t   *up2   = in + mirror(row - 2, height) * width;
+    const uint8_t   *dn2   = in + mirror(row + 2, height) * width;
+    int             x, xl, xr, xl2, xr2, c, lapH, lapV, gradH, gradV, gH, gV, g;
+
+    for (x = 0; x < width; x++)
+    {
+        c = cur[x];
+
+        if (bayerColor(job->param, row, x) == BAYER_G)
+        {
+            out[3 * x + 1] = (uint8_t)c;
+            continue;
+        }
+
+        xl    = mirror(x - 1, width);
+        xr    = mirror(x + 1, width);
+        xl2   = mirror(x - 2, width);
+        xr2   = mirror(x + 2, width);
+
+        lapH  = 2 * c - cur[xl2] - cur[xr2];
+        lapV  = 2 * c - up2[x] - dn2[x];
+        gradH = abs(cur[xl] - cur[xr]) + abs(lapH);
+        gradV = abs(up[x] - dn[x]) + abs(lapV);
+
+        // 4 times the horizontal and vertical estimation
+        gH = 2 * (cur[xl] + cur[xr]) + lapH;
+        gV = 2 * (up[x] + dn[x]) + lapV;
+
+        if (gradH < gradV)
+        {
+            g = (gH + 2) >> 2;
+        }
+        else if (gradV < gradH)
+        {
+            g = (gV + 2) >> 2;
+        }
+        else
+        {
+            g = (gH + gV + 4) >> 3;
+        }
+
+        out[3 * x + 1] = (uint8_t)CameraTool::clip(g);
+    }
+}
+
+// pass 2 of the edge aware demosaic, writes red and blue
+static void bayerRowEdgeColor(camera_tool_job *job, int row)
+{
+    int             width  = job->width;
+    int             height = job->height;
+    const uint8_t   *cur   = job->in + row * width;
+    const uint8_t   *up    = job->in + mirror(row - 1, height) * width;
+    const uint8_t   *dn    = job->in + mirror(row + 1, height) * width;
+    uint8_t         *out   = job->out + 3 * row * width;
+    const uint8_t   *gUp   = job->out + 3 * mirror(row - 1, height) * width + 1;
+    const uint8_t   *gDn   = job->out + 3 * mirror(row + 1, height) * width + 1;
+    const uint8_t   *gCur  = out + 1;
+    int             src[3][2];
+    int             x, xl, xr, ch, g, diff;
+
+    bayerRowSources(job->param, row, src);
+
+    for (x = 0; x < width; x++)
+    {
+        xl = mirror(x - 1, width);
+        xr = mirror(x + 1, width);
+        g  = gCur[3 * x];
+
+        for (ch = 0; ch < 3; ch += 2)
         {
-            swap                                = inputData[(i * width + j) * 3];//swap = input_B
-            outputData[(i * width + j) * 3]     = inputData[(i * width + j) * 3 + 2];
-            outputData[(i * width + j) * 3 +1 ] = inputData[(i * width + j) * 3 + 1];
-            outputData[(i * width + j) * 3 + 2] = swap;
+            switch (src[ch][x & 1])
+            {
+            case BAYER_SRC_C:
+                out[3 * x + ch] = cur[x];
+                continue;
+
+            case BAYER_SRC_HZ:
+                diff = cur[xl] - gCur[3 * xl] + cur[xr] - gCur[3 * xr];
+                diff = (diff + 1) >> 1;
+                break;
+
+            case BAYER_SRC_VT:
+                diff = up[x] - gUp[3 * x] + dn[x] - gDn[3 * x];
+                diff = (diff + 1) >> 1;
+                break;
+
+            default:    // BAYER_SRC_DIAG
+                diff = up[xl] - gUp[3 * xl] + up[xr] - gUp[3 * xr] +
+                       dn[xl] - gDn[3 * xl] + dn[xr] - gDn[3 * xr];
+                diff = (diff + 2) >> 2;
+                break;
+            }
+
+            out[3 * x + ch] = (uint8_t)CameraTool::clip(g + diff);
         }
     }
+}
+
+int CameraTool::convertCharBayer2RGB(uint8_t* outputData, uint8_t* inputData,
+                                     int width, int height, int colorFilterId,
+                                     int method, int threads)
+{
+    camera_tool_job job;
+
+    if ((colorFilterId < COLORFILTER_RGGB) || (colorFilterId > COLORFILTER_BGGR) ||
+        (width < 3) || (height < 3))
+    {
+        return -EINVAL;
+    }
+
+    job.out     = outputData;
+    job.in      = inputData;
+    job.width   = width;
+    job.height  = height;
+    job.param   = colorFilterId;
+
+    switch (method)
+    {
+    case CAMERA_TOOL_DEMOSAIC_BILINEAR:
+        job.rowFunc = bayerRowBilinear;
+        rowsRun(&job, threads);
+        break;
+
+    case CAMERA_TOOL_DEMOSAIC_EDGE:
+        job.rowFunc = bayerRowEdgeGreen;
+        rowsRun(&job, threads);
+        job.rowFunc = bayerRowEdgeColor;
+        rowsRun(&job, threads);
+        break;
+
+    default:
+        return -EINVAL;
+    }
     return 0;
 }
 
-int CameraTool::convertCharRGB2MONO8(uint8_t* outputData, uint8_t* inputData,
-                                int width, int height)
+/*******************************************************************************
+ *   MONO12 -> MONO8
+ *
+ *   The 12 bit values (big endian words as delivered by the cameras) between
+ *   blackLevel and whiteLevel are mapped to 0 - 255 with a gamma curve.
+ ******************************************************************************/
+
+static void mono12Row(camera_tool_job *job, int row)
 {
-    int i,j;
+    uint8_t         *out = job->out + row * job->width;
+    const uint8_t   *in  = job->in  + 2 * row * job->width;
+    int             x, value;
 
-    for (i = 0; i < height; i++)
+    for (x = 0; x < job->width; x++)
     {
-        for (j = 0; j < width; j++ )
+        value = ((in[2 * x] << 8) | in[2 * x + 1]) & 0x0fff;
+        out[x] = job->table[value];
+    }
+}
+
+int CameraTool::convertCharMono122Mono8(uint8_t* outputData, uint8_t* inputData,
+                                        int width, int height, int blackLevel,
+                                        int whiteLevel, float gamma, int threads)
+{
+    camera_tool_job job;
+    int             i;
+    float           value;
+
+    if ((blackLevel < 0) || (whiteLevel > 4095) || (blackLevel >= whiteLevel) ||
+        (gamma <= 0.0f))
+    {
+        return -EINVAL;
+    }
+
+    if ((blackLevel != toneBlackLevel) || (whiteLevel != toneWhiteLevel) ||
+        (gamma != toneGamma))
+    {
+        for (i = 0; i < 4096; i++)
         {
-            //Y = 0.3*R + 0.59*G + 0.11*B
-            outputData[i * width + j] = (3 * inputData[(i * width + j) * 3]     +
-                                         6 * inputData[(i * width + j) * 3 + 1] +
-                                         1 * inputData[(i * width + j) * 3 + 2] )/10;
+            value = (float)(i - blackLevel) / (float)(whiteLevel - blackLevel);
+
+            if (value <= 0.0f)
+            {
+                toneLookuptable12[i] = 0;
+            }
+            else if (value >= 1.0f)
+            {
+                toneLookuptable12[i] = 255;
+            }
+            else
+            {
+                toneLookuptable12[i] = (uint8_t)(255.0f * powf(value, 1.0f / gamma) + 0.5f);
+            }
         }
+        toneBlackLevel = blackLevel;
+        toneWhiteLevel = whiteLevel;
+        toneGamma      = gamma;
     }
+
+    job.rowFunc = mono12Row;
+    job.out     = outputData;
+    job.in      = inputData;
+    job.width   = width;
+    job.height  = height;
+    job.table   = toneLookuptable12;
+
+    rowsRun(&job, threads);
     return 0;
 }
+
 int CameraTool::convertCharMono82RGBThermalRed(uint8_t* outputData, uint8_t* inputData,
                                 int width, int height)
 {
@@ -42,18 +42,58 @@
 
 #include <main/compress_tool.h>
 
+#include <stdlib.h>
 #include <string.h>
 
 CompressTool::CompressTool()  {
     gdos = NULL;
+    compr_initWorkBuf(NULL, 0);
 }
 
 CompressTool::CompressTool(RackMailbox * p_mbx, int32_t gdos_level)  {
     gdos = new RackGdos(p_mbx, gdos_level);
+    compr_initWorkBuf(NULL, 0);
+}
+
+//----- The caller provides the work buffer (getWorkBufSize() bytes), so several
+//----- compressors can run concurrently without any shared or static memory
+CompressTool::CompressTool(uint8_t *workBuf, uint32_t workBufSize)  {
+    gdos = NULL;
+    compr_initWorkBuf(workBuf, workBufSize);
 }
 
 CompressTool::~CompressTool()  {
     if (gdos) delete gdos;
+    if (arenaOwned) free(arena.data);
+}
+
+void CompressTool::compr_initWorkBuf(uint8_t *workBuf, uint32_t workBufSize) {
+    arenaOwned = false;
+    arena.used = 0;
+    if (workBuf) {
+        arena.data = workBuf;
+        arena.size = workBufSize;
+    } else {
+        //----- allocated once in the non realtime context
+        arena.data = (uint8_t*)malloc(COMPR_WORKBUF_SIZE);
+        arena.size = arena.data ? COMPR_WORKBUF_SIZE : 0;
+        arenaOwned = (arena.data != NULL);
+    }
+}
+
+//----- replaces the work buffer (not during a running (de)compression)
+void CompressTool::setWorkBuf(uint8_t *workBuf, uint32_t workBufSize) {
+    if (arenaOwned) free(arena.data);
+    compr_initWorkBuf(workBuf, workBufSize);
+}
+
+//----- allocates size bytes of the work buffer, returns NULL if it is too small
+void* CompressTool::compr_arenaAlloc(uint32_t size) {
+    size = COMPR_ALIGN(size);
+    if ((arena.data == NULL) || (size > arena.size - arena.used)) return NULL;
+    void *p = arena.data + arena.used;
+    arena.used += size;
+    return p;
 }
 
 //----- ----------------------------------------------------------------------------------------------------
@@ -68,7 +108,15 @@ uint32_t CompressTool::Compress(uint8_t *in_out, uint32_t flags_s2, uint32_t fla
     inStream2.aByte     = 0;
     inStream2.aBit      = 0;
     //----- prepare output stream
-    pbuf23              = (uint8_t*)&buf23;
+    arena.used          = 0;
+    pbuf23              = (uint8_t*)compr_arenaAlloc(COMPR_MAX_INPUT_SIZE);
+    if (pbuf23 == NULL) {
+        //----- work buffer too small, leave the data of step 1 untouched
+        GDOS_PRINT("Error: CompressTool work buffer too small (%d bytes needed)\n", COMPR_WORKBUF_SIZE);
+        compr_writeStatistics(2, stats.s_step1);
+        compr_writeStatistics(3, stats.s_step1);
+        return stats.s_step3;
+    }
 
     pbuf23[0]           = 0x4D;             //----- "Magic value"
     pbuf23[1]           = 0x32;
@@ -82,7 +130,7 @@ uint32_t CompressTool::Compress(uint8_t *in_out, uint32_t flags_s2, uint32_t fla
     outStream2.aByte    = 14;
     uint32_t size2      = 0;
 
-#ifdef COMPR_USE_LZSS
+#if defined(COMPR_USE_LZSS) || defined(COMPR_USE_BWT) || defined(COMPR_USE_LZW)
     uint32_t size2a, par1, par2;
 #endif
 
@@ -126,14 +174,15 @@ uint32_t CompressTool::Compress(uint8_t *in_out, uint32_t flags_s2, uint32_t fla
         par1 = ((flags_s2 & 0xFFFFFF00) >> 8);
         if (par1 == 0) par1 = BWT_BLOCKSIZE;
         size2a = compr_step2_bwt(&inStream2, &outStream2, stats.s_step1, par1);
+        if (size2a == 0) break;
         inStream2.data   = pbuf23;
         inStream2.aByte  = 14;
         inStream2.aBit   = 0;
         outStream2.data  = in_out;
         outStream2.aByte = 0;
         outStream2.aBit  = 0;
-        size2 = compr_step2_mtf(&inStream2, &outStream2, size2a);
-        memcpy(&pbuf23[14], in_out, stats.s_step1);
+        size2 = compr_step2_mtf(&inStream2, &outStream2, size2a-14) + 14;
+        memcpy(&pbuf23[14], in_out, size2-14);
         outStream2.data  = pbuf23;
         break;
 #endif
@@ -155,6 +204,16 @@ uint32_t CompressTool::Compress(uint8_t *in_out, uint32_t flags_s2, uint32_t fla
         break;
     }
 
+    //----- transform failed (work buffer too small), store data of step 1
+    if (size2 == 0) {
+        flags_s2 = COMPR_S2_NONE;
+        outStream2.data  = pbuf23;
+        outStream2.aByte = 2; outStream2.aBit = 0;
+        compr_writeByteStream(&outStream2, flags_s2, sizeof(flags_s2));
+        memcpy(&pbuf23[14], in_out, stats.s_step1);
+        size2 = stats.s_step1+14;
+    }
+
     outStream2.aByte = 10; outStream2.aBit = 0;
     compr_writeByteStream(&outStream2, size2, sizeof(size2));
     compr_writeStatistics(2, size2);
@@ -435,92 +494,155 @@ uint32_t CompressTool::compr_step2_mtf(compr_bitStream *in, compr_bitStream *out
 #ifdef COMPR_USE_BWT
 //----- ----------------------------------------------------------------------------------------------------
 //----- Burrows Wheeler Transform (BWT)
-//----- The BWT is very slow and does not work properlay, so it has not been optimised.
-//----- So this section of the code ist EXPERIMENTAL
+//----- The suffix array of every block is built with SA-IS (induced sorting, Nong/Zhang/Chan),
+//----- which works in linear time and without recursion on the data. All memory is taken
+//----- from the work buffer.
+//-----
+//----- stream:   original size (4), per block: primary index (4), block bytes
 //----- ----------------------------------------------------------------------------------------------------
 
-//----- Compares two uint8_t strings a and b up to length size lexicographically.
-//----- returns 1 if a>b, -1 if a<b, 0 if a=b
-int32_t CompressTool::compr_step2_bwt_strcmpn(uint8_t *a, uint8_t *b, int32_t size) {
-    uint32_t i=0;
-    while ((a[i] == b[i]) && (size > 0) ) { i++; size--; }
-    if (size == 0) return 0;
-    if (a[i] > b[i]) return 1; else return -1;
+//----- text access: level 0 is the byte block with a virtual sentinel (0) at the end,
+//----- all other symbols are shifted by 1. Deeper levels work on int32_t names.
+#define SAIS_CHR(i)     ((cs == 4) ? ((int32_t*)s)[i] : (((i) == n-1) ? 0 : ((uint8_t*)s)[i]+1))
+#define SAIS_TGET(i)    ((t[(i)>>3] >> ((i)&7)) & 1)
+#define SAIS_TSET(i, b) t[(i)>>3] = (b) ? (t[(i)>>3] | (1<<((i)&7))) : (t[(i)>>3] & ~(1<<((i)&7)))
+#define SAIS_ISLMS(i)   (((i) > 0) && SAIS_TGET(i) && !SAIS_TGET((i)-1))
+
+static void sais_getBuckets(const void *s, int32_t *bkt, int32_t n, int32_t K, int32_t cs, bool end) {
+    int32_t i, sum = 0;
+    for (i=0; i<=K; i++) bkt[i] = 0;
+    for (i=0; i<n; i++) bkt[SAIS_CHR(i)]++;
+    for (i=0; i<=K; i++) {
+        sum += bkt[i];
+        bkt[i] = end ? sum : sum-bkt[i];
+    }
 }
 
-//----- Sorts an array of uint8_t strings [bwt_buf], that all have the size n
-//----- in ascending order using the quicksort algorithm. Input data is not changed.
-//----- Output is the uint8_t* array [bwt_index] containing pointers to the input data.
-//----- This array needs to be initialized with pointers to each position in the input data.
-//----- The parameters l and r point to the left and right borders of the array
-
-void CompressTool::compr_step2_bwt_quicksort(int32_t n, int32_t left, int32_t right) {
-    int32_t l, r;
-    uint8_t *tmp, *pivot;
-    if (right > left){                          //----- as long as the subsequence has more than one element
-        pivot = bwt_index[right];
-        l = left; r = right;                    //----- initialize l and r with the borders
-        do {                                    //----- increment, until higher element is found
-            while (compr_step2_bwt_strcmpn(bwt_index[l], pivot, n) == -1) l++;
-                                                //----- decrement, until lower element is found
-            while (compr_step2_bwt_strcmpn(bwt_index[r], pivot, n) ==  1) r--;
-            if (l <= r) {
-                tmp=bwt_index[l];               //----- swap lower and higer element (Indices)
-                bwt_index[l]=bwt_index[r];
-                bwt_index[r]=tmp;
-                l++;
-                r--;
-            }
-        } while (l <= r);
-        compr_step2_bwt_quicksort(n, left, r);  //----- recursive call for left subset
-        compr_step2_bwt_quicksort(n, l, right); //----- recursive call for left subset
+static void sais_induceL(const uint8_t *t, int32_t *SA, const void *s, int32_t *bkt, int32_t n, int32_t K, int32_t cs) {
+    int32_t i, j;
+    sais_getBuckets(s, bkt, n, K, cs, false);
+    for (i=0; i<n; i++) {
+        j = SA[i]-1;
+        if ((j >= 0) && !SAIS_TGET(j)) SA[bkt[SAIS_CHR(j)]++] = j;
     }
 }
 
-uint32_t CompressTool::compr_step2_bwt(compr_bitStream *in, compr_bitStream *out, uint32_t size, uint32_t blocksize) {
-    uint32_t i;
-    //----- copy input data twice in a row
-    memcpy(&bwt_buf, &in->data[in->aByte], size);
-    memcpy((void*)((int32_t)&bwt_buf+size), &in->data[in->aByte], size);
-    //----- Create an array with pointers to every position in the input data
-    bwt_index[0] = &bwt_buf[0];
-    for (i = 1; i<size; i++) bwt_index[i] = bwt_index[i-1]+1;
-
-    //----- transform input data block-by-block
-    uint32_t block = 0;
-    uint32_t index;
-    while (in->aByte < size) {
-        //(block = 0; block <= (int32_t)(size/blocksize); block++) {
-        if ((block*(blocksize+1))>size) blocksize = size % block;
-
-        memcpy(&bwt_buf, &in->data[in->aByte], blocksize);
-        memcpy((void*)((int32_t)&bwt_buf+blocksize), &in->data[in->aByte], blocksize);
-        in->aByte += blocksize;
-        //----- Create an array with pointers to every position in the input data
-        bwt_index[0] = &bwt_buf[0];
-        for (i = 1; i<blocksize; i++) bwt_index[i] = bwt_index[i-1]+1;
-
-        compr_step2_bwt_quicksort(blocksize, 0, blocksize-1);
-        index = 0;
-        while (bwt_index[index] != &bwt_buf[0]) index++; //----- find index
-        compr_writeByteStream(out, index, 4);
-        for (i=0; i<blocksize; i++)
-            out->data[out->aByte++] = bwt_index[i][blocksize-1];
-        block++;
+static void sais_induceS(const uint8_t *t, int32_t *SA, const void *s, int32_t *bkt, int32_t n, int32_t K, int32_t cs) {
+    int32_t i, j;
+    sais_getBuckets(s, bkt, n, K, cs, true);
+    for (i=n-1; i>=0; i--) {
+        j = SA[i]-1;
+        if ((j >= 0) && SAIS_TGET(j)) SA[--bkt[SAIS_CHR(j)]] = j;
     }
-    //----- transform the last block
-
-    //----- Create an array with pointers to every position in the input data
-    bwt_index[0] = &bwt_buf[0];
-    for (i = 1; i<blocksize; i++) bwt_index[i] = bwt_index[i-1]+1;
+}
 
-    compr_step2_bwt_quicksort(size-block*BWT_BLOCKSIZE, block*BWT_BLOCKSIZE, size-1);
-    index = block*BWT_BLOCKSIZE;
-    while (bwt_index[index] != &bwt_buf[block*BWT_BLOCKSIZE]) index++; //----- find index
-    compr_writeByteStream(out, (index%BWT_BLOCKSIZE), 4);
-    for (i=block*BWT_BLOCKSIZE; i<size; i++)
-        out->data[out->aByte++] = bwt_index[i][size-1];
+//----- Builds the suffix array SA of s (n symbols incl. sentinel, alphabet 0..K).
+//----- returns -1 if the work buffer is too small
+static int32_t sais(CompressTool *ct, compr_arena *arena, const void *s, int32_t *SA, int32_t n, int32_t K, int32_t cs) {
+    int32_t  i, j, d, pos, prev, name, n1;
+    int32_t  *bkt, *s1;
+    bool     diff;
+    uint32_t mark0 = arena->used;
+    uint8_t  *t    = (uint8_t*)ct->compr_arenaAlloc(n/8+1);
+    if (t == NULL) return -1;
+
+    //----- classify the suffixes into S- (1) and L-type (0)
+    SAIS_TSET(n-2, 0);
+    SAIS_TSET(n-1, 1);
+    for (i=n-3; i>=0; i--)
+        SAIS_TSET(i, (SAIS_CHR(i) < SAIS_CHR(i+1)) || ((SAIS_CHR(i) == SAIS_CHR(i+1)) && SAIS_TGET(i+1)));
+
+    //----- stage 1: sort the LMS substrings
+    uint32_t mark1 = arena->used;
+    bkt = (int32_t*)ct->compr_arenaAlloc((K+1)*sizeof(int32_t));
+    if (bkt == NULL) { arena->used = mark0; return -1; }
+    sais_getBuckets(s, bkt, n, K, cs, true);
+    for (i=0; i<n; i++) SA[i] = -1;
+    for (i=1; i<n; i++) if (SAIS_ISLMS(i)) SA[--bkt[SAIS_CHR(i)]] = i;
+    sais_induceL(t, SA, s, bkt, n, K, cs);
+    sais_induceS(t, SA, s, bkt, n, K, cs);
+    arena->used = mark1;
+
+    //----- compact the sorted LMS substrings into the first n1 items of SA
+    n1 = 0;
+    for (i=0; i<n; i++) if (SAIS_ISLMS(SA[i])) SA[n1++] = SA[i];
+
+    //----- name the LMS substrings
+    for (i=n1; i<n; i++) SA[i] = -1;
+    name = 0;
+    prev = -1;
+    for (i=0; i<n1; i++) {
+        pos  = SA[i];
+        diff = false;
+        for (d=0; d<n; d++) {
+            if ((prev == -1) || (SAIS_CHR(pos+d) != SAIS_CHR(prev+d)) || (SAIS_TGET(pos+d) != SAIS_TGET(prev+d))) {
+                diff = true;
+                break;
+            } else if ((d > 0) && (SAIS_ISLMS(pos+d) || SAIS_ISLMS(prev+d))) break;
+        }
+        if (diff) { name++; prev = pos; }
+        SA[n1+(pos>>1)] = name-1;
+    }
+    for (i=n-1, j=n-1; i>=n1; i--) if (SA[i] >= 0) SA[j--] = SA[i];
+
+    //----- stage 2: solve the reduced problem, recurse if names are not yet unique
+    s1 = SA+n-n1;
+    if (name < n1) {
+        if (sais(ct, arena, s1, SA, n1, name-1, 4) < 0) { arena->used = mark0; return -1; }
+    } else
+        for (i=0; i<n1; i++) SA[s1[i]] = i;
+
+    //----- stage 3: induce the result for the original problem
+    bkt = (int32_t*)ct->compr_arenaAlloc((K+1)*sizeof(int32_t));
+    if (bkt == NULL) { arena->used = mark0; return -1; }
+    sais_getBuckets(s, bkt, n, K, cs, true);
+    for (i=1, j=0; i<n; i++) if (SAIS_ISLMS(i)) s1[j++] = i;
+    for (i=0; i<n1; i++) SA[i] = s1[SA[i]];
+    for (i=n1; i<n; i++) SA[i] = -1;
+    for (i=n1-1; i>=0; i--) {
+        j = SA[i];
+        SA[i] = -1;
+        SA[--bkt[SAIS_CHR(j)]] = j;
+    }
+    sais_induceL(t, SA, s, bkt, n, K, cs);
+    sais_induceS(t, SA, s, bkt, n, K, cs);
+    arena->used = mark0;
+    return 0;
+}
 
+//----- Transforms the input block by block, returns 0 if the work buffer is too small
+uint32_t CompressTool::compr_step2_bwt(compr_bitStream *in, compr_bitStream *out, uint32_t size, uint32_t blocksize) {
+    uint32_t i, n, primary;
+    uint8_t  *block;
+    uint8_t  *pOut;
+    if (blocksize > BWT_MAX_BLOCKSIZE) blocksize = BWT_MAX_BLOCKSIZE;
+
+    uint32_t mark = arena.used;
+    int32_t  *SA  = (int32_t*)compr_arenaAlloc((blocksize+1)*sizeof(int32_t));
+    if (SA == NULL) return 0;
+
+    compr_writeByteStream(out, size, 4);
+    while (size > 0) {
+        n       = (size < blocksize) ? size : blocksize;
+        block   = &in->data[in->aByte];
+        primary = 0;
+        if (n > 1) {
+            if (sais(this, &arena, block, SA, n+1, 256, 1) < 0) { arena.used = mark; return 0; }
+        } else {
+            SA[0] = n; SA[1] = 0;
+        }
+        //----- row 0 is the sentinel suffix, the row of suffix 0 is not stored (primary index)
+        pOut = &out->data[out->aByte+4];
+        for (i=0; i<=n; i++) {
+            if (SA[i] == 0) primary = i;
+            else *pOut++ = block[SA[i]-1];
+        }
+        compr_writeByteStream(out, primary, 4);
+        out->aByte += n;
+        in->aByte  += n;
+        size       -= n;
+    }
+    arena.used = mark;
     return out->aByte;
 }
 #endif
@@ -563,13 +685,22 @@ uint32_t CompressTool::compr_step3_huffmann(compr_bitStream *in, compr_bitStream
     //----- create codes from tree
     compr_step3_huffmann_tree2codes(0, 0, root);
 
-    //----- code data using the created model
-    for (i = 0; i<size; i++)
-        compr_writeBitStream(out, huff_codes[pIn[i]].code, huff_codes[pIn[i]].len);
-    compr_writeBitStream(out, huff_codes[HUFF_EOS].code, huff_codes[HUFF_EOS].len);
-
-
-    if (out->aBit > 0) out->aByte++;  //----- round up bytes
+    //----- code data using the created model, bits are collected in a 64 bit word
+    uint8_t  *pOut   = &out->data[out->aByte];
+    uint64_t acc     = 0;
+    uint32_t accBits = 0;
+    for (i = 0; i<=size; i++) {
+        huff_code *hc = (i < size) ? &huff_codes[pIn[i]] : &huff_codes[HUFF_EOS];
+        acc      = (acc << hc->len) | hc->code;
+        accBits += hc->len;
+        while (accBits >= 8) {
+            accBits -= 8;
+            *pOut++ = (uint8_t)(acc >> accBits);
+        }
+    }
+    if (accBits > 0) *pOut++ = (uint8_t)(acc << (8-accBits));  //----- round up bytes
+    out->aByte = (uint32_t)(pOut - out->data);
+    out->aBit  = 0;
     return out->aByte;
 }
 
@@ -779,7 +910,12 @@ uint32_t CompressTool::Decompress(uint8_t *in_out) {
     inStream3.aByte     = 0;
     inStream3.aBit      = 0;
     //----- prepare output stream
-    pbuf23              = (uint8_t*)&buf23;
+    arena.used          = 0;
+    pbuf23              = (uint8_t*)compr_arenaAlloc(COMPR_MAX_INPUT_SIZE);
+    if (pbuf23 == NULL) {
+        GDOS_PRINT("Error: CompressTool work buffer too small (%d bytes needed)\n", COMPR_WORKBUF_SIZE);
+        return 1;
+    }
     compr_bitStream     outStream3;
     outStream3.data     = pbuf23;
     outStream3.aByte    = 0;
@@ -875,7 +1011,7 @@ uint32_t CompressTool::Decompress(uint8_t *in_out) {
         aLen = uncompr_step2_bwt(&inStream2, &outStream2, size2, par1);
         break;
     case COMPR_S2_BWT_MTF:
-        aLen1 = uncompr_step2_mtf(&inStream2, &outStream2, size2);
+        aLen1 = uncompr_step2_mtf(&inStream2, &outStream2, size2-14);
         inStream2.data   = in_out;
         inStream2.aByte  = 0;
         inStream2.aBit   = 0;
@@ -885,7 +1021,7 @@ uint32_t CompressTool::Decompress(uint8_t *in_out) {
         par1 = ((flags_s2 & 0xFFFFFF00) >> 8);
         if (par1 == 0) par1 = BWT_BLOCKSIZE;
         aLen = uncompr_step2_bwt(&inStream2, &outStream2, aLen1, par1);
-        memcpy(in_out, &pbuf23[14], aLen);
+        memcpy(in_out, &pbuf23[14], aLen-14);
         break;
 #endif
 #ifdef COMPR_USE_LZW
@@ -1022,56 +1158,47 @@ uint32_t CompressTool::uncompr_step2_mtf(compr_bitStream *in, compr_bitStream *o
 
 #ifdef COMPR_USE_BWT
 //----- Expand data that was compressed with compr_step2_bwt()
-//----- The BWT is very slow and does not work properlay, so it has not been optimised.
-//----- So this section of the code ist EXPERIMENTAL
+//----- The inverse transform follows the LF mapping, which is built with one counting pass
 uint32_t CompressTool::uncompr_step2_bwt(compr_bitStream *in, compr_bitStream *out, uint32_t size, uint32_t blocksize) {
-    int32_t index, i;
-    uint32_t bytesdone = 0;
-    while (bytesdone < size) {
-        if (bytesdone > size-blocksize) blocksize = size - bytesdone;
-        index = compr_readByteStream(in, 4);
-        for (i = 0; i<blocksize; i++) bwt_index[i] = (uint8_t*)i;
-        uncompr_step2_bwt_mergesort(&in->data[in->aByte], 0, blocksize-1);
-        for (i = 0; i<blocksize; i++) {
-            out->data[out->aByte++] = in->data[index+in->aByte];
-            index = (int32_t)bwt_index[index];
-        }
-        in->aByte += blocksize;
-        bytesdone += blocksize+sizeof(int32_t);
-        if (bytesdone+blocksize < size) blocksize = size - bytesdone;
-    }
-    return out->aByte;
-}
-
-
-void CompressTool::uncompr_step2_bwt_mergesort(uint8_t *in, int32_t left, int32_t right) {
-    if (right>left){
-        int32_t i, j, k, m;
-        m=(right + left)/2;                                    //----- determine middle
-        uncompr_step2_bwt_mergesort(in, left, m);              //----- left subsequence
-        uncompr_step2_bwt_mergesort(in, m+1, right);           //----- right subsequence
-        for (i=m+1; i>left; i--) {
-            bwt_buf[i-1]=in[i-1];          //----- left subsequence in auxilliary array
-            bwt_index[BWT_BLOCKSIZE+i-1]=bwt_index[i-1];
+    uint32_t i, n, r, primary, c;
+    uint32_t count[257];
+    uint8_t  *block, *pOut;
+    if (blocksize > BWT_MAX_BLOCKSIZE) blocksize = BWT_MAX_BLOCKSIZE;
+
+    uint32_t mark = arena.used;
+    uint32_t *LF  = (uint32_t*)compr_arenaAlloc((blocksize+1)*sizeof(uint32_t));
+    if (LF == NULL) return out->aByte;
+
+    uint32_t total = compr_readByteStream(in, 4);
+    while (total > 0) {
+        n       = (total < blocksize) ? total : blocksize;
+        primary = compr_readByteStream(in, 4);
+        block   = &in->data[in->aByte];
+        if ((primary == 0) || (primary > n)) break;     //----- corrupted data
+
+        //----- count[c]: first row starting with symbol c (row 0 is the sentinel)
+        memset(count, 0, sizeof(count));
+        for (i=0; i<n; i++) count[block[i]+1]++;
+        count[0] = 1;
+        for (c=1; c<257; c++) count[c] += count[c-1];
+        //----- LF mapping of every row, the primary row holds the sentinel
+        for (r=0, i=0; r<=n; r++) {
+            if (r == primary) { LF[r] = 0; continue; }
+            LF[r] = count[block[i++]]++;
         }
-        for (j=m; j<right; j++) {
-            bwt_buf[right+m-j]=in[j+1];    //----- left subsequence reversed in auxilliary array
-            bwt_index[BWT_BLOCKSIZE+right+m-j]=bwt_index[j+1];
-        }
-        for (k=left; k<=right; k++) {
-//            in[k]=(bwt_buf[i]<bwt_buf[j])?bwt_buf[i++]:bwt_buf[j--]; //----- sorted insertion
-//          in[k]=(bwt_buf[i]<bwt_buf[j])?bwt_buf[i++]:bwt_buf[j--];
-            if (bwt_buf[i]<bwt_buf[j]) {
-                bwt_index[k] = bwt_index[BWT_BLOCKSIZE+i];
-                in[k] = bwt_buf[i++];
-            } else {
-                bwt_index[k] = bwt_index[BWT_BLOCKSIZE+j];
-                in[k] = bwt_buf[j--];
-            }
+        //----- walk backwards from the sentinel row
+        pOut = &out->data[out->aByte+n];
+        for (r=0, i=0; i<n; i++) {
+            *--pOut = block[(r < primary) ? r : r-1];
+            r = LF[r];
         }
+        out->aByte += n;
+        in->aByte  += n;
+        total      -= n;
     }
+    arena.used = mark;
+    return out->aByte;
 }
-
 #endif
 
 
@@ -1085,22 +1212,73 @@ uint32_t CompressTool::uncompr_step3_huffmann(compr_bitStream *in, compr_bitStre
     //----- read counters
     for (i=0; i<256; i++) huff_nodes[i].count = in->data[in->aByte++];
     huff_nodes[HUFF_EOS].count = 1;
-    //----- create huffmann tree
+    //----- create huffmann tree and decoding table
     int32_t root = compr_step3_huffmann_build_tree();
-    //----- decode data using the created model
-    int32_t node;
+    uncompr_step3_huffmann_build_lut(0, 0, root);
+
+    //----- decode data using the created model, HUFF_LUT_BITS are decoded per table lookup.
+    //----- The bit buffer is left aligned and refilled bytewise up to 57 bits,
+    //----- bytes behind the end of the input [size] are read as 0.
+    uint8_t  *pIn     = in->data;
+    uint32_t pos      = in->aByte;
+    uint64_t bitBuf   = 0;
+    uint32_t bitCnt   = 0;
+    int32_t  node;
+    huff_lut_entry *e;
+    if (in->aBit > 0) {
+        bitBuf = (uint64_t)((uint8_t)(pIn[pos++] << in->aBit)) << 56;
+        bitCnt = 8-in->aBit;
+    }
     for (;;) {
-        node = root;
-        do {
-            if (compr_readBit(in)) node = huff_nodes[node].child2;
-            else node = huff_nodes[node].child1;
-        } while (node > HUFF_EOS);
+        while (bitCnt <= 56) {
+            bitBuf |= (uint64_t)((pos < size) ? pIn[pos] : 0) << (56-bitCnt);
+            pos++;
+            bitCnt += 8;
+        }
+        e = &huff_lut[bitBuf >> (64-HUFF_LUT_BITS)];
+        if (e->len > 0) {
+            node    = e->node;
+            bitBuf <<= e->len;
+            bitCnt  -= e->len;
+        } else {
+            //----- long code: continue in the tree
+            node    = e->node;
+            bitBuf <<= HUFF_LUT_BITS;
+            bitCnt  -= HUFF_LUT_BITS;
+            do {
+                node = (bitBuf >> 63) ? huff_nodes[node].child2 : huff_nodes[node].child1;
+                bitBuf <<= 1;
+                bitCnt--;
+            } while (node > HUFF_EOS);
+        }
         if (node == HUFF_EOS) break;
         out->data[out->aByte++] = node;
     }
+    in->aByte = (pos*8 - bitCnt)/8;
+    in->aBit  = (pos*8 - bitCnt)%8;
     return out->aByte;
 }
 
+//----- fills the decoding table: codes up to HUFF_LUT_BITS are decoded directly,
+//----- longer codes point to their tree node at depth HUFF_LUT_BITS
+void CompressTool::uncompr_step3_huffmann_build_lut(uint32_t code, uint32_t len, int32_t node) {
+    uint32_t i, first, num;
+    if (node <= HUFF_EOS) {
+        first = code << (HUFF_LUT_BITS-len);
+        num   = 1 << (HUFF_LUT_BITS-len);
+        for (i = 0; i < num; i++) {
+            huff_lut[first+i].node = node;
+            huff_lut[first+i].len  = len;
+        }
+    } else if (len == HUFF_LUT_BITS) {
+        huff_lut[code].node = node;
+        huff_lut[code].len  = 0;
+    } else {
+        uncompr_step3_huffmann_build_lut(code << 1,       len+1, huff_nodes[node].child1);
+        uncompr_step3_huffmann_build_lut((code << 1) | 1, len+1, huff_nodes[node].child2);
+    }
+}
+
 #ifdef COMPR_USE_ADHUFF
 //----- Expand data that was compressed with compr_step3_ad_huffmann()
 uint32_t CompressTool::uncompr_step3_adhuff(compr_bitStream *in, compr_bitStream *out, uint32_t size) {
@@ -1222,80 +1400,50 @@ int8_t* CompressTool::uncompr_getStatisticsTable() {
 
 //----- reads one bit from the bitstream [bs]
 bool CompressTool::compr_readBit(compr_bitStream *bs) {
-    uint32_t output = bs->data[bs->aByte];
-    output >>= (7-bs->aBit++);
-    output &= 1;
-    if (bs->aBit >= 8) { bs->aBit = 0; bs->aByte++; }
+    bool output = (bs->data[bs->aByte] >> (7-bs->aBit)) & 1;
+    if (++bs->aBit == 8) { bs->aBit = 0; bs->aByte++; }
     return output;
 }
 
 //----- writes the lowest bit from [value] into the bitstream [bs]
 void CompressTool::compr_writeBit(compr_bitStream *bs, bool value) {
     if (bs->aBit == 0) bs->data[bs->aByte] = 0;
-    bs->data[bs->aByte] |= (value<<(7-bs->aBit++));
-    if (bs->aBit >= 8) { bs->aBit = 0; bs->aByte++; }
+    bs->data[bs->aByte] |= (value<<(7-bs->aBit));
+    if (++bs->aBit == 8) { bs->aBit = 0; bs->aByte++; }
 }
 
 //----- writes the [bits] lowest bit from [value] into the bitstream [bs] (max 32)
+//----- The open byte and the new bits are merged in a 64 bit word and written bytewise.
 void CompressTool::compr_writeBitStream(compr_bitStream *bs, uint32_t value, uint32_t bits) {
-    if (bs->aBit == 0) bs->data[bs->aByte] = 0;
-    uint32_t nBits = 8-bs->aBit;
-    if (nBits >= bits) {
-        bs->data[bs->aByte] = ((bs->data[bs->aByte]) | (value << (nBits-bits)));
-        bs->aBit += bits;
-        bits = 0;
-    } else  {
-        bs->data[bs->aByte] = ((bs->data[bs->aByte]) | (value >> (bits-nBits)));
-        bits-=nBits;
-        bs->aBit = 8;
-    }
-    if (bs->aBit == 8) { bs->aByte++; bs->data[bs->aByte] = 0; bs->aBit = 0; }
-    while (bits >= 8) {
-        bits-=8;
-        bs->data[bs->aByte] = (uint8_t) ((value >> bits)  & 0x000000FF);
-        bs->aByte++; bs->data[bs->aByte] = 0;
+    if (bits == 0) {
+        if (bs->aBit == 0) bs->data[bs->aByte] = 0;
+        return;
     }
-    if (bits > 0) {
-        bs->data[bs->aByte] = (uint8_t) ((value << (8-bits)) & 0x000000FF);
-        bs->aBit += bits;
+    uint64_t acc   = (bs->aBit == 0) ? 0 : (bs->data[bs->aByte] >> (8-bs->aBit));
+    uint32_t nBits = bs->aBit + bits;
+    uint8_t  *p    = &bs->data[bs->aByte];
+    acc = (acc << bits) | (value & (0xFFFFFFFFu >> (32-bits)));
+    while (nBits >= 8) {
+        nBits -= 8;
+        *p++ = (uint8_t)(acc >> nBits);
     }
-    if (bs->aBit == 8) { bs->aByte++; bs->data[bs->aByte] = 0; bs->aBit = 0; }
+    *p = (nBits > 0) ? (uint8_t)(acc << (8-nBits)) : 0;
+    bs->aByte = (uint32_t)(p - bs->data);
+    bs->aBit  = nBits;
 }
 
 //----- returns [bits] bits from the bitstream [bs] (max 32)
+//----- Only the needed bytes (max 5) are loaded into a 64 bit word.
 uint32_t CompressTool::compr_readBitStream(compr_bitStream *bs, uint32_t bits) {
     if (bits == 0) return 0;
-    uint32_t output = 0;
-    uint8_t tmp = 0;
-    uint32_t nBits = 8-bits-bs->aBit;
-    if (bits <= (8-bs->aBit)) { //----- all bits in actual byte
-        output = bs->data[bs->aByte];
-        if (nBits > 0) output >>= nBits;
-        output <<= 32-bits;
-        output >>= 32-bits;
-        if ((bs->aBit + bits) == 8) { bs->aByte++; bs->aBit = 0; }
-        else bs->aBit += bits;
-        bits = 0;
-    } else {                    //----- read bits from first byte
-        output = bs->data[bs->aByte];
-        output <<= 24+bs->aBit;
-        output >>= 24+bs->aBit;
-        bits -= (8-bs->aBit);
-        bs->aByte++; bs->aBit = 0;
-    }
-    while (bits >= 8) {         //----- read full bytes
-        tmp = bs->data[bs->aByte++];
-        bits -= 8;
-        output <<= 8;
-        output += tmp;
-    }
-    if (bits > 0) {             //----- read remaining bits
-        tmp = bs->data[bs->aByte];
-        output <<= bits;
-        tmp >>= 8-bits;
-        output += tmp;
-        bs->aBit=bits;
-    }
+    uint32_t nBits  = bs->aBit + bits;
+    uint32_t nBytes = (nBits + 7) >> 3;
+    uint8_t  *p     = &bs->data[bs->aByte];
+    uint64_t acc    = 0;
+    for (uint32_t i = 0; i < nBytes; i++) acc = (acc << 8) | p[i];
+    uint32_t output = (uint32_t)(acc >> ((nBytes << 3) - nBits)) & (0xFFFFFFFFu >> (32-bits));
+    bs->aByte += nBits >> 3;
+    bs->aBit   = nBits & 7;
     return output;
 }
 
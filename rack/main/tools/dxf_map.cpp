@@ -19,6 +19,9 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <main/dxf_map.h>
 
@@ -46,14 +49,307 @@ DxfMap::DxfMap(int maxFeatureNum)
     xMax = 0.0;
     yMin = 0.0;
     yMax = 0.0;
+
+    indexFeatureNum = 0;
+    indexNumX       = 0;
+    indexNumY       = 0;
+    indexCellSize   = 0.0;
+    indexCellStart  = NULL;
+    indexFeature    = NULL;
+    indexStamp      = NULL;
+    indexRay        = 0;
+
+    rayAngle        = NULL;
+    rayCos          = NULL;
+    raySin          = NULL;
+    rayNum          = 0;
+
+    cacheEnabled    = 1;
+    cacheMap        = NULL;
+    cacheMapSize    = 0;
+    featureMapSize  = 0;
 }
 
 DxfMap::~DxfMap()
 {
-    if (feature != NULL)
+    if (featureMapSize > 0)
+    {
+        munmap(feature, featureMapSize);
+    }
+    else if (feature != NULL)
     {
         free(feature);
     }
+
+    freeIndex();
+
+    free(rayAngle);
+    free(rayCos);
+    free(raySin);
+}
+
+//
+// dxf_map_cache
+//
+
+static uint64_t cacheAlign(uint64_t size)
+{
+    return (size + DXF_MAP_CACHE_ALIGN - 1) & ~(uint64_t)(DXF_MAP_CACHE_ALIGN - 1);
+}
+
+// FNV-1a over 64 bit words of the mapped file
+static int hashFile(const char *filename, uint64_t *hash, uint64_t *size)
+{
+    struct stat     st;
+    const uint8_t   *p_data;
+    uint64_t        h, word;
+    size_t          i, len;
+    int             fd;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+
+    if ((fstat(fd, &st) < 0) || (st.st_size <= 0))
+    {
+        close(fd);
+        return -EINVAL;
+    }
+    len = st.st_size;
+
+    p_data = (const uint8_t *)mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p_data == MAP_FAILED)
+    {
+        return -ENOMEM;
+    }
+
+    h = 14695981039346656037llu;
+    for (i = 0; i + sizeof(word) <= len; i += sizeof(word))
+    {
+        memcpy(&word, &p_data[i], sizeof(word));
+        h  = (h ^ word) * 1099511628211llu;
+        h ^= h >> 32;
+    }
+    for (; i < len; i++)
+    {
+        h = (h ^ p_data[i]) * 1099511628211llu;
+    }
+
+    munmap((void *)p_data, len);
+
+    *hash = h;
+    *size = len;
+    return 0;
+}
+
+int DxfMap::loadCache(const char *filename, dxf_map_cache_head *key)
+{
+    dxf_map_cache_head  *head;
+    dxf_map_feature     *p_feature;
+    struct stat         st;
+    uint8_t             *p_map;
+    uint64_t            featureSize, cellSize, refSize;
+    size_t              mapSize;
+    int                 *stamp;
+    int64_t             cells;
+    int                 fd;
+
+    if (maxFeatureNum <= 0)
+    {
+        return -ENOMEM;
+    }
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+
+    if ((fstat(fd, &st) < 0) || (st.st_size < (off_t)sizeof(dxf_map_cache_head)))
+    {
+        close(fd);
+        return -EINVAL;
+    }
+
+    p_map = (uint8_t *)mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p_map == MAP_FAILED)
+    {
+        close(fd);
+        return -ENOMEM;
+    }
+    head = (dxf_map_cache_head *)p_map;
+
+    cells       = (int64_t)head->indexNumX * (int64_t)head->indexNumY;
+    featureSize = (uint64_t)head->featureNum * sizeof(dxf_map_feature);
+    cellSize    = (cells > 0) ? (cells + 1) * sizeof(int) : 0;
+    refSize     = (uint64_t)head->indexRefNum * sizeof(int);
+
+    // a full parser may have dropped features, so the cache of a full parser
+    // is only valid for the same maxFeatureNum
+    if ((head->magic != DXF_MAP_CACHE_MAGIC) ||
+        (head->version != DXF_MAP_CACHE_VERSION) ||
+        (head->featureSize != sizeof(dxf_map_feature)) ||
+        (head->fileHash != key->fileHash) ||
+        (head->fileSize != key->fileSize) ||
+        (head->mapOffsetX != key->mapOffsetX) ||
+        (head->mapOffsetY != key->mapOffsetY) ||
+        (head->scaleFactor != key->scaleFactor) ||
+        (head->featureNum < 0) || (head->featureNum > maxFeatureNum) ||
+        ((head->featureNum >= head->parseMax) && (head->parseMax != key->parseMax)) ||
+        (head->indexNumX < 0) || (head->indexNumY < 0) || (head->indexRefNum < 0) ||
+        (cells > DXF_MAP_INDEX_CELL_MAX) ||
+        (head->size != (uint64_t)st.st_size) ||
+        (head->featureOffset % DXF_MAP_CACHE_ALIGN) ||
+        (head->cellOffset < head->featureOffset + cacheAlign(featureSize)) ||
+        (head->refOffset < head->cellOffset + cellSize) ||
+        (head->size < head->refOffset + refSize) ||
+        ((cells > 0) &&
+         (((int *)(p_map + head->cellOffset))[cells] != head->indexRefNum)))
+    {
+        munmap(p_map, st.st_size);
+        close(fd);
+        return -EINVAL;
+    }
+
+    // the features are mapped copy on write in front of zeroed memory for
+    // the rest of maxFeatureNum features
+    mapSize   = cacheAlign((uint64_t)maxFeatureNum * sizeof(dxf_map_feature));
+    p_feature = (dxf_map_feature *)mmap(NULL, mapSize, PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p_feature == MAP_FAILED)
+    {
+        munmap(p_map, st.st_size);
+        close(fd);
+        return -ENOMEM;
+    }
+
+    if ((featureSize > 0) &&
+        (mmap(p_feature, cacheAlign(featureSize), PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_FIXED, fd, head->featureOffset) == MAP_FAILED))
+    {
+        munmap(p_feature, mapSize);
+        munmap(p_map, st.st_size);
+        close(fd);
+        return -ENOMEM;
+    }
+    close(fd);
+
+    stamp = (int *)calloc(head->featureNum > 0 ? head->featureNum : 1, sizeof(int));
+    if (!stamp)
+    {
+        munmap(p_feature, mapSize);
+        munmap(p_map, st.st_size);
+        return -ENOMEM;
+    }
+
+    freeIndex();
+
+    if (featureMapSize > 0)
+    {
+        munmap(feature, featureMapSize);
+    }
+    else
+    {
+        free(feature);
+    }
+    feature        = p_feature;
+    featureMapSize = mapSize;
+    featureNum     = head->featureNum;
+
+    xMin = head->xMin;
+    xMax = head->xMax;
+    yMin = head->yMin;
+    yMax = head->yMax;
+
+    cacheMap     = p_map;
+    cacheMapSize = st.st_size;
+
+    if (cells > 0)
+    {
+        indexNumX      = head->indexNumX;
+        indexNumY      = head->indexNumY;
+        indexCellSize  = head->indexCellSize;
+        indexCellStart = (int *)(p_map + head->cellOffset);
+        indexFeature   = (int *)(p_map + head->refOffset);
+        indexStamp     = stamp;
+    }
+    else
+    {
+        free(stamp);
+    }
+    indexFeatureNum = featureNum;
+
+    return 0;
+}
+
+int DxfMap::saveCache(const char *filename, dxf_map_cache_head *key)
+{
+    dxf_map_cache_head  head;
+    char                tmpFile[272];
+    size_t              featureSize, cellSize, refSize;
+    int                 cells, fd;
+
+    cells = indexCellStart ? indexNumX * indexNumY : 0;
+
+    memcpy(&head, key, sizeof(head));
+    head.magic         = DXF_MAP_CACHE_MAGIC;
+    head.version       = DXF_MAP_CACHE_VERSION;
+    head.featureSize   = sizeof(dxf_map_feature);
+    head.featureNum    = featureNum;
+    head.indexNumX     = cells ? indexNumX : 0;
+    head.indexNumY     = cells ? indexNumY : 0;
+    head.indexRefNum   = cells ? indexCellStart[cells] : 0;
+    head.indexCellSize = indexCellSize;
+    head.xMin          = xMin;
+    head.xMax          = xMax;
+    head.yMin          = yMin;
+    head.yMax          = yMax;
+
+    featureSize = featureNum * sizeof(dxf_map_feature);
+    cellSize    = cells ? (cells + 1) * sizeof(int) : 0;
+    refSize     = head.indexRefNum * sizeof(int);
+
+    head.featureOffset = DXF_MAP_CACHE_ALIGN;
+    head.cellOffset    = head.featureOffset + cacheAlign(featureSize);
+    head.refOffset     = head.cellOffset + cellSize;
+    head.size          = head.refOffset + refSize;
+
+    // a new file is renamed to the cache, so a process that has mapped the
+    // old cache keeps its pages
+    snprintf(tmpFile, sizeof(tmpFile), "%s.XXXXXX", filename);
+
+    fd = mkstemp(tmpFile);
+    if (fd < 0)
+    {
+        // e.g. the map directory is read only
+        return -errno;
+    }
+
+    if ((ftruncate(fd, head.size) < 0) ||
+        (pwrite(fd, &head, sizeof(head), 0) != (ssize_t)sizeof(head)) ||
+        (pwrite(fd, feature, featureSize, head.featureOffset) != (ssize_t)featureSize) ||
+        (pwrite(fd, indexCellStart, cellSize, head.cellOffset) != (ssize_t)cellSize) ||
+        (pwrite(fd, indexFeature, refSize, head.refOffset) != (ssize_t)refSize) ||
+        (fchmod(fd, 0644) < 0))
+    {
+        printf("Can't write dxf cache \"%s\"\n", tmpFile);
+        close(fd);
+        unlink(tmpFile);
+        return -EIO;
+    }
+    close(fd);
+
+    if (rename(tmpFile, filename) < 0)
+    {
+        printf("Can't rename dxf cache \"%s\"\n", tmpFile);
+        unlink(tmpFile);
+        return -EIO;
+    }
+
+    return 0;
 }
 
 //
@@ -430,6 +726,26 @@ int DxfMap::load(char *filename, double mapOffsetX, double mapOffsetY, double sc
     int    vertices;
     int    i;
     double x, y;
+    char   cacheFile[256];
+    dxf_map_cache_head key;
+
+    memset(&key, 0, sizeof(key));
+    key.mapOffsetX  = mapOffsetX;
+    key.mapOffsetY  = mapOffsetY;
+    key.scaleFactor = scaleFactor;
+    key.parseMax    = maxFeatureNum;
+
+    // fileSize stays 0 without a cache
+    if (cacheEnabled &&
+        (snprintf(cacheFile, sizeof(cacheFile), "%s%s", filename,
+                  DXF_MAP_CACHE_SUFFIX) < (int)sizeof(cacheFile)) &&
+        (hashFile(filename, &key.fileHash, &key.fileSize) == 0))
+    {
+        if (loadCache(cacheFile, &key) == 0)
+        {
+            return 0;
+        }
+    }
 
     if ((fp = fopen(filename, "r")) == NULL)
     {
@@ -511,6 +827,14 @@ int DxfMap::load(char *filename, double mapOffsetX, double mapOffsetY, double sc
         }
     }
 
+    // raycast() works without the index if there is no memory for it
+    buildIndex();
+
+    if (key.fileSize && (indexCellStart || (featureNum == 0)))
+    {
+        saveCache(cacheFile, &key);
+    }
+
     return 0;
 }
 
@@ -782,3 +1106,424 @@ int DxfMap::save(char *filename, int savefeatureNum, double scaleFactor)
 }
      
      
+
+//
+// dxf_map_index
+//
+
+void DxfMap::freeIndex(void)
+{
+    // the index of a cache points into the cache file
+    if (cacheMap)
+    {
+        munmap(cacheMap, cacheMapSize);
+        cacheMap     = NULL;
+        cacheMapSize = 0;
+    }
+    else
+    {
+        free(indexCellStart);
+        free(indexFeature);
+    }
+    free(indexStamp);
+
+    indexCellStart  = NULL;
+    indexFeature    = NULL;
+    indexStamp      = NULL;
+    indexFeatureNum = 0;
+    indexNumX       = 0;
+    indexNumY       = 0;
+    indexRay        = 0;
+}
+
+int DxfMap::buildIndex(void)
+{
+    double  w, h, dx, dy, yLow, yHigh, xa, xb, t0, t1, eps;
+    int     cells, refs, pass, i, c, ix, iy, ixMin, ixMax, iyMin, iyMax;
+    int     axisMax;
+
+    freeIndex();
+
+    if (featureNum <= 0)
+    {
+        return 0;
+    }
+
+    calcBounds();
+
+    // about four cells per feature, limited to DXF_MAP_INDEX_CELL_MAX cells
+    w       = xMax - xMin;
+    h       = yMax - yMin;
+    axisMax = (int)sqrt((double)DXF_MAP_INDEX_CELL_MAX) - 1;
+
+    indexCellSize = sqrt(w * h / (4.0 * (double)featureNum));
+    if (indexCellSize < ((w > h) ? w : h) / (double)axisMax)
+    {
+        indexCellSize = ((w > h) ? w : h) / (double)axisMax;
+    }
+    if (indexCellSize <= 0.0)
+    {
+        indexCellSize = 1.0;
+    }
+
+    indexNumX = (int)(w / indexCellSize) + 1;
+    indexNumY = (int)(h / indexCellSize) + 1;
+    cells     = indexNumX * indexNumY;
+    eps       = indexCellSize * 1e-6;
+
+    indexCellStart = (int *)calloc(cells + 1, sizeof(int));
+    indexStamp     = (int *)calloc(featureNum, sizeof(int));
+    if (!indexCellStart || !indexStamp)
+    {
+        freeIndex();
+        return -ENOMEM;
+    }
+
+    // count the cells of each line feature, then fill them
+    for (pass = 0; pass < 2; pass++)
+    {
+        for (i = 0; i < featureNum; i++)
+        {
+            if (feature[i].l <= 0.0)
+            {
+                continue;
+            }
+
+            dx = feature[i].x2 - feature[i].x;
+            dy = feature[i].y2 - feature[i].y;
+
+            iyMin = (int)floor(((dy > 0.0 ? feature[i].y : feature[i].y2) - eps - yMin) / indexCellSize);
+            iyMax = (int)floor(((dy > 0.0 ? feature[i].y2 : feature[i].y) + eps - yMin) / indexCellSize);
+            iyMin = (iyMin < 0) ? 0 : iyMin;
+            iyMax = (iyMax >= indexNumY) ? indexNumY - 1 : iyMax;
+
+            for (iy = iyMin; iy <= iyMax; iy++)
+            {
+                // part of the line within this row
+                yLow  = yMin + (double)iy * indexCellSize - eps;
+                yHigh = yLow + indexCellSize + 2.0 * eps;
+
+                if (fabs(dy) < eps)
+                {
+                    t0 = 0.0;
+                    t1 = 1.0;
+                }
+                else
+                {
+                    t0 = (yLow - feature[i].y) / dy;
+                    t1 = (yHigh - feature[i].y) / dy;
+                    if (t0 > t1)
+                    {
+                        xa = t0;
+                        t0 = t1;
+                        t1 = xa;
+                    }
+                    t0 = (t0 < 0.0) ? 0.0 : t0;
+                    t1 = (t1 > 1.0) ? 1.0 : t1;
+                }
+
+                xa = feature[i].x + dx * t0;
+                xb = feature[i].x + dx * t1;
+                if (xa > xb)
+                {
+                    t0 = xa;
+                    xa = xb;
+                    xb = t0;
+                }
+
+                ixMin = (int)floor((xa - eps - xMin) / indexCellSize);
+                ixMax = (int)floor((xb + eps - xMin) / indexCellSize);
+                ixMin = (ixMin < 0) ? 0 : ixMin;
+                ixMax = (ixMax >= indexNumX) ? indexNumX - 1 : ixMax;
+
+                for (ix = ixMin; ix <= ixMax; ix++)
+                {
+                    c = iy * indexNumX + ix;
+                    if (pass == 0)
+                    {
+                        indexCellStart[c + 1]++;
+                    }
+                    else
+                    {
+                        indexFeature[indexCellStart[c]++] = i;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0)
+        {
+            for (c = 0; c < cells; c++)
+            {
+                indexCellStart[c + 1] += indexCellStart[c];
+            }
+            refs = indexCellStart[cells];
+
+            indexFeature = (int *)malloc((refs > 0 ? refs : 1) * sizeof(int));
+            if (!indexFeature)
+            {
+                freeIndex();
+                return -ENOMEM;
+            }
+        }
+    }
+
+    // the fill pass moved each start to the start of the next cell
+    for (c = cells; c > 0; c--)
+    {
+        indexCellStart[c] = indexCellStart[c - 1];
+    }
+    indexCellStart[0] = 0;
+
+    indexFeatureNum = featureNum;
+    return 0;
+}
+
+// distance of the beam (x, y) + t * (dx, dy) to feature i if it is less
+// than distance
+double DxfMap::intersect(int i, double x, double y, double dx, double dy, double distance)
+{
+    double x1, y1, x2, y2, denominator, featureDistance, a;
+
+    x1 = feature[i].x;
+    y1 = feature[i].y;
+    x2 = feature[i].l * feature[i].cos;
+    y2 = feature[i].l * feature[i].sin;
+
+    denominator = (dx * y2) - (dy * x2);
+
+    if ((denominator > 0.0001) || (denominator < -0.0001))
+    {
+        featureDistance = ((x2 * y) + (x1 * y2) - (y1 * x2) - (x * y2)) / denominator;
+
+        if ((featureDistance < distance) && (featureDistance >= 0))
+        {
+            if ((x2 > -0.5) && (x2 < 0.5))
+            {
+                a = (y + (featureDistance * dy) - y1) / y2;
+            }
+            else
+            {
+                a = (x + (featureDistance * dx) - x1) / x2;
+            }
+
+            // the intersection has to be between the start and end point
+            if ((a >= 0.0) && (a <= 1.0))
+            {
+                return featureDistance;
+            }
+        }
+    }
+    return distance;
+}
+
+double DxfMap::raycastBeam(double x, double y, double dx, double dy, double maxRange)
+{
+    double  distance, tEnter, tExit, t0, t1, tMaxX, tMaxY, tDeltaX, tDeltaY, cellExit;
+    int     ix, iy, stepX, stepY, c, k, f;
+
+    distance = maxRange;
+
+    // new ray number, each feature is tested once per ray
+    indexRay++;
+    if (indexRay <= 0)
+    {
+        memset(indexStamp, 0, indexFeatureNum * sizeof(int));
+        indexRay = 1;
+    }
+
+    // clip the beam to the grid
+    tEnter = 0.0;
+    tExit  = maxRange;
+
+    if (dx != 0.0)
+    {
+        t0 = (xMin - x) / dx;
+        t1 = (xMin + indexNumX * indexCellSize - x) / dx;
+        tEnter = (t0 < t1) ? ((t0 > tEnter) ? t0 : tEnter) : ((t1 > tEnter) ? t1 : tEnter);
+        tExit  = (t0 < t1) ? ((t1 < tExit) ? t1 : tExit) : ((t0 < tExit) ? t0 : tExit);
+    }
+    else if ((x < xMin) || (x > xMin + indexNumX * indexCellSize))
+    {
+        return distance;
+    }
+
+    if (dy != 0.0)
+    {
+        t0 = (yMin - y) / dy;
+        t1 = (yMin + indexNumY * indexCellSize - y) / dy;
+        tEnter = (t0 < t1) ? ((t0 > tEnter) ? t0 : tEnter) : ((t1 > tEnter) ? t1 : tEnter);
+        tExit  = (t0 < t1) ? ((t1 < tExit) ? t1 : tExit) : ((t0 < tExit) ? t0 : tExit);
+    }
+    else if ((y < yMin) || (y > yMin + indexNumY * indexCellSize))
+    {
+        return distance;
+    }
+
+    if (tEnter > tExit)
+    {
+        return distance;
+    }
+
+    ix = (int)floor((x + dx * tEnter - xMin) / indexCellSize);
+    iy = (int)floor((y + dy * tEnter - yMin) / indexCellSize);
+    ix = (ix < 0) ? 0 : ((ix >= indexNumX) ? indexNumX - 1 : ix);
+    iy = (iy < 0) ? 0 : ((iy >= indexNumY) ? indexNumY - 1 : iy);
+
+    // cell traversal (DDA)
+    if (dx > 0.0)
+    {
+        stepX   = 1;
+        tMaxX   = (xMin + (ix + 1) * indexCellSize - x) / dx;
+        tDeltaX = indexCellSize / dx;
+    }
+    else if (dx < 0.0)
+    {
+        stepX   = -1;
+        tMaxX   = (xMin + ix * indexCellSize - x) / dx;
+        tDeltaX = -indexCellSize / dx;
+    }
+    else
+    {
+        stepX   = 0;
+        tMaxX   = HUGE_VAL;
+        tDeltaX = HUGE_VAL;
+    }
+
+    if (dy > 0.0)
+    {
+        stepY   = 1;
+        tMaxY   = (yMin + (iy + 1) * indexCellSize - y) / dy;
+        tDeltaY = indexCellSize / dy;
+    }
+    else if (dy < 0.0)
+    {
+        stepY   = -1;
+        tMaxY   = (yMin + iy * indexCellSize - y) / dy;
+        tDeltaY = -indexCellSize / dy;
+    }
+    else
+    {
+        stepY   = 0;
+        tMaxY   = HUGE_VAL;
+        tDeltaY = HUGE_VAL;
+    }
+
+    while (1)
+    {
+        c = iy * indexNumX + ix;
+
+        for (k = indexCellStart[c]; k < indexCellStart[c + 1]; k++)
+        {
+            f = indexFeature[k];
+            if (indexStamp[f] != indexRay)
+            {
+                indexStamp[f] = indexRay;
+                distance = intersect(f, x, y, dx, dy, distance);
+            }
+        }
+
+        // a hit within this cell can't be beaten by the following cells
+        cellExit = (tMaxX < tMaxY) ? tMaxX : tMaxY;
+        if ((distance <= cellExit) || (cellExit >= tExit))
+        {
+            break;
+        }
+
+        if (tMaxX < tMaxY)
+        {
+            ix    += stepX;
+            tMaxX += tDeltaX;
+            if ((ix < 0) || (ix >= indexNumX))
+            {
+                break;
+            }
+        }
+        else
+        {
+            iy    += stepY;
+            tMaxY += tDeltaY;
+            if ((iy < 0) || (iy >= indexNumY))
+            {
+                break;
+            }
+        }
+    }
+
+    return distance;
+}
+
+int DxfMap::raycast(double x, double y, double rho, const double *angle, int angleNum,
+                    double maxRange, double *distance)
+{
+    double  cosRho, sinRho, dx, dy;
+    int     i, j;
+
+    if ((angleNum <= 0) || !angle || !distance)
+    {
+        return -EINVAL;
+    }
+
+    if (indexFeatureNum != featureNum)
+    {
+        buildIndex();
+    }
+
+    // directions of the beam angles, reused while the angles are the same
+    if ((angleNum != rayNum) || memcmp(angle, rayAngle, angleNum * sizeof(double)))
+    {
+        if (angleNum != rayNum)
+        {
+            free(rayAngle);
+            free(rayCos);
+            free(raySin);
+            rayAngle = (double *)malloc(angleNum * sizeof(double));
+            rayCos   = (double *)malloc(angleNum * sizeof(double));
+            raySin   = (double *)malloc(angleNum * sizeof(double));
+            rayNum   = angleNum;
+
+            if (!rayAngle || !rayCos || !raySin)
+            {
+                free(rayAngle);
+                free(rayCos);
+                free(raySin);
+                rayAngle = NULL;
+                rayCos   = NULL;
+                raySin   = NULL;
+                rayNum   = 0;
+                return -ENOMEM;
+            }
+        }
+
+        memcpy(rayAngle, angle, angleNum * sizeof(double));
+        for (i = 0; i < angleNum; i++)
+        {
+            rayCos[i] = cos(angle[i]);
+            raySin[i] = sin(angle[i]);
+        }
+    }
+
+    cosRho = cos(rho);
+    sinRho = sin(rho);
+
+    for (i = 0; i < angleNum; i++)
+    {
+        dx = cosRho * rayCos[i] - sinRho * raySin[i];
+        dy = sinRho * rayCos[i] + cosRho * raySin[i];
+
+        if (indexCellStart)
+        {
+            distance[i] = raycastBeam(x, y, dx, dy, maxRange);
+        }
+        else
+        {
+            distance[i] = maxRange;
+            for (j = 0; j < featureNum; j++)
+            {
+                distance[i] = intersect(j, x, y, dx, dy, distance[i]);
+            }
+        }
+    }
+
+    return 0;
+}
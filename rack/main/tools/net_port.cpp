@@ -0,0 +1,1070 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include <main/net_port.h>
+
+#define NET_PORT_RECONNECT_MIN      100000000ll     // 100ms
+#define NET_PORT_RECONNECT_MAX     5000000000ll     // 5s
+#define NET_PORT_SEND_TIMEOUT           1000        // ms
+#define NET_REACTOR_EVENT_MAX             16
+
+static uint64_t getMonoNano(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000llu + ts.tv_nsec;
+}
+
+//
+// NetPort
+//
+
+NetPort::NetPort()
+{
+    fd             = -1;
+    type           = NET_PORT_TCP;
+    state          = NET_PORT_CLOSED;
+    error          = 0;
+    events         = 0;
+    registered     = 0;
+    module         = NULL;
+    buffer         = NULL;
+    bufferSize     = 0;
+    head           = 0;
+    tail           = 0;
+    frameEnd       = 0;
+    markFirst      = 0;
+    markNum        = 0;
+    reconnectMin   = NET_PORT_RECONNECT_MIN;
+    reconnectMax   = NET_PORT_RECONNECT_MAX;
+    reconnectDelay = NET_PORT_RECONNECT_MIN;
+    reconnectTime  = 0;
+    connectCount   = 0;
+    dropCount      = 0;
+    reactor        = NULL;
+    ownReactor     = NULL;
+
+    memset(&framing, 0, sizeof(framing));
+}
+
+NetPort::~NetPort()
+{
+    close();
+}
+
+int NetPort::open(const char *ip, int port, int type, const net_port_framing *framing,
+                  int bufferSize, int64_t connectTimeout_ns, RackModule *module)
+{
+    uint64_t    deadline;
+    char        name[40];
+    int         ret;
+
+    if (state != NET_PORT_CLOSED)
+    {
+        return -EBUSY;
+    }
+
+    if ((type != NET_PORT_TCP) && (type != NET_PORT_UDP))
+    {
+        return -EINVAL;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons((unsigned short)port);
+    addr.sin_addr.s_addr = INADDR_ANY;
+
+    if ((ip) && (ip[0] != 0))
+    {
+        if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1)
+        {
+            return -EINVAL;
+        }
+    }
+    else if (type == NET_PORT_TCP)
+    {
+        return -EINVAL;
+    }
+
+    if (framing)
+    {
+        memcpy(&this->framing, framing, sizeof(net_port_framing));
+    }
+    else
+    {
+        memset(&this->framing, 0, sizeof(net_port_framing));
+        this->framing.type = NET_PORT_FRAME_RAW;
+    }
+
+    if ((this->framing.frameMax <= 0) || (this->framing.frameMax > bufferSize / 2))
+    {
+        this->framing.frameMax = bufferSize / 2;
+    }
+    if ((this->framing.startLen > NET_PORT_PATTERN_MAX) ||
+        (this->framing.endLen   > NET_PORT_PATTERN_MAX) ||
+        ((this->framing.type == NET_PORT_FRAME_DELIMITER) && (this->framing.endLen < 1)) ||
+        ((this->framing.type == NET_PORT_FRAME_LENGTH) &&
+         (this->framing.lengthSize != 1) && (this->framing.lengthSize != 2) &&
+         (this->framing.lengthSize != 4)) ||
+        (this->framing.frameMax < 1))
+    {
+        return -EINVAL;
+    }
+
+    // the spare area behind the ring completes wrapped frames
+    this->buffer = (uint8_t *)malloc(bufferSize + this->framing.frameMax);
+    if (!this->buffer)
+    {
+        return -ENOMEM;
+    }
+
+    this->type       = type;
+    this->bufferSize = bufferSize;
+    this->module     = module;
+    head             = 0;
+    tail             = 0;
+    frameEnd         = 0;
+    markFirst        = 0;
+    markNum          = 0;
+    connectCount     = 0;
+    dropCount        = 0;
+    error            = 0;
+    reconnectDelay   = reconnectMin;
+
+    snprintf(name, sizeof(name), "net_%s_%d", ((ip) && (ip[0] != 0)) ? ip : "any", port);
+
+    ret = capture.init(name, module);
+    if (ret < 0)
+    {
+        goto open_error;
+    }
+
+    // replay, the sensor is not needed
+    if (ret == PORT_CAPTURE_REPLAY)
+    {
+        state = NET_PORT_CONNECTED;
+        connectCount++;
+        return 0;
+    }
+
+    if (!reactor)
+    {
+        ownReactor = new NetReactor();
+        if (!ownReactor)
+        {
+            ret = -ENOMEM;
+            goto open_error;
+        }
+
+        ret = ownReactor->open();
+        if (ret)
+        {
+            goto open_error;
+        }
+
+        ret = ownReactor->add(this);
+        if (ret)
+        {
+            goto open_error;
+        }
+    }
+
+    ret = connectSocket();
+    if (ret)
+    {
+        goto open_error;
+    }
+
+    // wait for the first tcp connection
+    deadline = getMonoNano() + connectTimeout_ns;
+
+    while (state == NET_PORT_CONNECTING)
+    {
+        int64_t timeout = (int64_t)(deadline - getMonoNano());
+
+        if (timeout <= 0)
+        {
+            ret = -ETIMEDOUT;
+            goto open_error;
+        }
+
+        ret = reactor->poll(timeout);
+        if (ret < 0)
+        {
+            goto open_error;
+        }
+    }
+
+    if (state != NET_PORT_CONNECTED)
+    {
+        ret = error ? error : -ECONNREFUSED;
+        goto open_error;
+    }
+
+    return 0;
+
+open_error:
+    close();
+    return ret;
+}
+
+int NetPort::close(void)
+{
+    capture.close();
+    closeSocket();
+    state = NET_PORT_CLOSED;
+
+    if (reactor)
+    {
+        reactor->remove(this);
+    }
+
+    if (ownReactor)
+    {
+        ownReactor->close();
+        delete ownReactor;
+        ownReactor = NULL;
+    }
+
+    if (buffer)
+    {
+        free(buffer);
+        buffer = NULL;
+    }
+    return 0;
+}
+
+int NetPort::setReconnect(int64_t reconnectMin_ns, int64_t reconnectMax_ns)
+{
+    if ((reconnectMin_ns <= 0) || (reconnectMax_ns < reconnectMin_ns))
+    {
+        return -EINVAL;
+    }
+
+    reconnectMin   = reconnectMin_ns;
+    reconnectMax   = reconnectMax_ns;
+    reconnectDelay = reconnectMin_ns;
+    return 0;
+}
+
+int NetPort::connectSocket(void)
+{
+    int ret, on = 1;
+
+    if (type == NET_PORT_TCP)
+    {
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    }
+    else
+    {
+        fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    }
+    if (fd < 0)
+    {
+        return -errno;
+    }
+
+    // kernel receive timestamps, not supported by all tcp stacks
+    setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+
+    if (type == NET_PORT_TCP)
+    {
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        ret = connect(fd, (struct sockaddr *)&addr, sizeof(addr));
+        if ((ret) && (errno != EINPROGRESS))
+        {
+            disconnect(-errno);
+            return 0;
+        }
+
+        state = NET_PORT_CONNECTING;
+        if (!ret)
+        {
+            return connectDone();
+        }
+    }
+    else
+    {
+        struct sockaddr_in local;
+
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+        memset(&local, 0, sizeof(local));
+        local.sin_family      = AF_INET;
+        local.sin_port        = addr.sin_port;
+        local.sin_addr.s_addr = INADDR_ANY;
+
+        ret = bind(fd, (struct sockaddr *)&local, sizeof(local));
+        if (ret)
+        {
+            ret = -errno;
+            closeSocket();
+            return ret;
+        }
+
+        state = NET_PORT_CONNECTED;
+        connectCount++;
+    }
+
+    return reactor->update(this);
+}
+
+int NetPort::connectDone(void)
+{
+    int       err = 0;
+    socklen_t len = sizeof(err);
+
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len))
+    {
+        err = errno;
+    }
+    if (err)
+    {
+        disconnect(-err);
+        return 0;
+    }
+
+    state          = NET_PORT_CONNECTED;
+    reconnectDelay = reconnectMin;
+    connectCount++;
+
+    return reactor->update(this);
+}
+
+void NetPort::closeSocket(void)
+{
+    if (fd >= 0)
+    {
+        // closing the socket also removes it from the epoll set
+        ::close(fd);
+        fd = -1;
+    }
+    registered = 0;
+    events     = 0;
+}
+
+void NetPort::disconnect(int error)
+{
+    closeSocket();
+
+    this->error = error;
+
+    // the stream starts again with the next connection
+    head      = 0;
+    tail      = 0;
+    frameEnd  = 0;
+    markFirst = 0;
+    markNum   = 0;
+
+    state          = NET_PORT_WAIT_RECONNECT;
+    reconnectTime  = getMonoNano() + reconnectDelay;
+    reconnectDelay = (2 * reconnectDelay < reconnectMax) ? 2 * reconnectDelay : reconnectMax;
+}
+
+int NetPort::recvData(void)
+{
+    struct iovec        iov[2];
+    struct msghdr       msg;
+    struct cmsghdr      *cmsg;
+    struct sockaddr_in  src;
+    char                control[CMSG_SPACE(sizeof(struct timespec))];
+    struct timespec     *ts, now;
+    rack_time_t         time;
+    int64_t             age;
+    int                 idx, freeLen, num = 0;
+    ssize_t             ret;
+
+    while (state == NET_PORT_CONNECTED)
+    {
+        freeLen = bufferSize - (int)(head - tail);
+        if (freeLen <= 0)
+        {
+            break;
+        }
+
+        idx             = head % bufferSize;
+        iov[0].iov_base = buffer + idx;
+        iov[0].iov_len  = (bufferSize - idx < freeLen) ? bufferSize - idx : freeLen;
+        iov[1].iov_base = buffer;
+        iov[1].iov_len  = freeLen - iov[0].iov_len;
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name       = &src;
+        msg.msg_namelen    = sizeof(src);
+        msg.msg_iov        = iov;
+        msg.msg_iovlen     = iov[1].iov_len ? 2 : 1;
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+
+        ret = recvmsg(fd, &msg, 0);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            disconnect(-errno);
+            break;
+        }
+
+        if (ret == 0)
+        {
+            if (type == NET_PORT_TCP)   // closed by peer
+            {
+                disconnect(-ECONNRESET);
+                break;
+            }
+            continue;
+        }
+
+        if (type == NET_PORT_UDP)
+        {
+            // foreign sender or datagram cut at the end of the free space
+            if (((addr.sin_addr.s_addr != INADDR_ANY) &&
+                 (src.sin_addr.s_addr != addr.sin_addr.s_addr)) ||
+                (msg.msg_flags & MSG_TRUNC))
+            {
+                dropCount += ret;
+                continue;
+            }
+        }
+
+        // receive time, kernel timestamp if there is one
+        time = module ? module->rackTime.get() : 0;
+
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPNS))
+            {
+                ts = (struct timespec *)CMSG_DATA(cmsg);
+                clock_gettime(CLOCK_REALTIME, &now);
+
+                age = (int64_t)(now.tv_sec - ts->tv_sec) * 1000000000ll +
+                      (now.tv_nsec - ts->tv_nsec);
+                if (age > 0)
+                {
+                    time -= (rack_time_t)(age / 1000000ll);
+                }
+            }
+        }
+
+        if (capture.getMode() == PORT_CAPTURE_RECORD)
+        {
+            iov[0].iov_len = ((size_t)ret < iov[0].iov_len) ? ret : iov[0].iov_len;
+            iov[1].iov_len = ret - iov[0].iov_len;
+            capture.write(PORT_CAPTURE_RX, iov, iov[1].iov_len ? 2 : 1, time);
+        }
+
+        addMark(time);
+        head += ret;
+        num++;
+    }
+
+    // stop reading while the ring is full
+    reactor->update(this);
+
+    return num;
+}
+
+void NetPort::addMark(rack_time_t time)
+{
+    int i;
+
+    if (markNum == NET_PORT_MARK_MAX)
+    {
+        markFirst = (markFirst + 1) % NET_PORT_MARK_MAX;
+        markNum--;
+    }
+
+    i           = (markFirst + markNum) % NET_PORT_MARK_MAX;
+    mark[i].pos  = head;
+    mark[i].time = time;
+    markNum++;
+}
+
+rack_time_t NetPort::getMarkTime(uint64_t pos, uint64_t *next)
+{
+    rack_time_t time = 0;
+    int         i, j;
+
+    *next = head;
+
+    if (markNum > 0)
+    {
+        time = mark[markFirst].time;
+    }
+
+    for (i = 0; i < markNum; i++)
+    {
+        j = (markFirst + i) % NET_PORT_MARK_MAX;
+
+        if (mark[j].pos > pos)
+        {
+            *next = mark[j].pos;
+            break;
+        }
+        time = mark[j].time;
+    }
+    return time;
+}
+
+int NetPort::getByte(uint64_t pos)
+{
+    return buffer[pos % bufferSize];
+}
+
+int64_t NetPort::findPattern(uint64_t pos, const uint8_t *pattern, int len)
+{
+    uint8_t  *p, *q;
+    int      idx, seg, i;
+
+    while (pos + len <= head)
+    {
+        idx = pos % bufferSize;
+        seg = bufferSize - idx;
+        if ((uint64_t)seg > head - pos)
+        {
+            seg = head - pos;
+        }
+
+        p = buffer + idx;
+        q = (uint8_t *)memchr(p, pattern[0], seg);
+        if (!q)
+        {
+            pos += seg;
+            continue;
+        }
+
+        pos += q - p;
+        if (pos + len > head)
+        {
+            break;
+        }
+
+        for (i = 1; i < len; i++)
+        {
+            if (getByte(pos + i) != pattern[i])
+            {
+                break;
+            }
+        }
+        if (i == len)
+        {
+            return pos;
+        }
+        pos++;
+    }
+    return -1;
+}
+
+uint8_t *NetPort::getContiguous(uint64_t pos, int len)
+{
+    int idx = pos % bufferSize;
+
+    if (idx + len > bufferSize)
+    {
+        memcpy(buffer + bufferSize, buffer, idx + len - bufferSize);
+    }
+    return buffer + idx;
+}
+
+void NetPort::drop(uint64_t pos)
+{
+    tail = pos;
+
+    // keep the mark that covers the tail
+    while ((markNum > 1) && (mark[(markFirst + 1) % NET_PORT_MARK_MAX].pos <= tail))
+    {
+        markFirst = (markFirst + 1) % NET_PORT_MARK_MAX;
+        markNum--;
+    }
+}
+
+int NetPort::extractFrame(net_port_frame *frame)
+{
+    uint64_t    next;
+    uint32_t    value;
+    int64_t     pos;
+    int         len, i;
+
+    while (head > tail)
+    {
+        // search the start pattern
+        if ((framing.type != NET_PORT_FRAME_RAW) && (framing.startLen > 0))
+        {
+            pos = findPattern(tail, framing.start, framing.startLen);
+            if (pos < 0)
+            {
+                // keep a start pattern that is not complete yet
+                if (head - tail >= (uint64_t)framing.startLen)
+                {
+                    dropCount += head - (framing.startLen - 1) - tail;
+                    drop(head - (framing.startLen - 1));
+                }
+                return -EAGAIN;
+            }
+            if ((uint64_t)pos > tail)
+            {
+                dropCount += pos - tail;
+                drop(pos);
+            }
+        }
+
+        switch (framing.type)
+        {
+            case NET_PORT_FRAME_LENGTH:
+                if (head - tail < (uint64_t)(framing.lengthOffset + framing.lengthSize))
+                {
+                    return -EAGAIN;
+                }
+
+                value = 0;
+                for (i = 0; i < framing.lengthSize; i++)
+                {
+                    if (framing.lengthBigEndian)
+                    {
+                        value = (value << 8) | getByte(tail + framing.lengthOffset + i);
+                    }
+                    else
+                    {
+                        value |= getByte(tail + framing.lengthOffset + i) << (8 * i);
+                    }
+                }
+
+                len = (int)value + framing.lengthAdd;
+                if ((value > (uint32_t)framing.frameMax) ||
+                    (len < framing.lengthOffset + framing.lengthSize) ||
+                    (len > framing.frameMax))
+                {
+                    // no valid frame, resynchronize behind this start
+                    dropCount++;
+                    drop(tail + 1);
+                    continue;
+                }
+                if (head - tail < (uint64_t)len)
+                {
+                    return -EAGAIN;
+                }
+                break;
+
+            case NET_PORT_FRAME_DELIMITER:
+                pos = findPattern(tail + framing.startLen, framing.end, framing.endLen);
+                if (pos < 0)
+                {
+                    if (head - tail <= (uint64_t)framing.frameMax)
+                    {
+                        return -EAGAIN;
+                    }
+                    len = framing.frameMax + 1;
+                }
+                else
+                {
+                    len = (int)(pos + framing.endLen - tail);
+                }
+
+                if (len > framing.frameMax)
+                {
+                    if (framing.startLen > 0)
+                    {
+                        dropCount++;
+                        drop(tail + 1);
+                    }
+                    else
+                    {
+                        dropCount += head - (framing.endLen - 1) - tail;
+                        drop(head - (framing.endLen - 1));
+                    }
+                    continue;
+                }
+                break;
+
+            default:
+                getMarkTime(tail, &next);
+                len = (int)(next - tail);
+                if (len > framing.frameMax)
+                {
+                    len = framing.frameMax;
+                }
+                break;
+        }
+
+        frame->data          = getContiguous(tail, len);
+        frame->len           = len;
+        frame->recordingTime = getMarkTime(tail, &next);
+        frameEnd             = tail + len;
+        return 0;
+    }
+    return -EAGAIN;
+}
+
+int NetPort::recvFrame(net_port_frame *frame, int64_t timeout_ns)
+{
+    uint64_t deadline = getMonoNano() + timeout_ns;
+    int64_t  timeout;
+    int      ret;
+
+    if (state == NET_PORT_CLOSED)
+    {
+        return -EBADF;
+    }
+
+    releaseFrame();
+
+    while (1)
+    {
+        ret = extractFrame(frame);
+        if (!ret)
+        {
+            return 0;
+        }
+
+        timeout = (int64_t)(deadline - getMonoNano());
+        if (timeout <= 0)
+        {
+            return -ETIMEDOUT;
+        }
+
+        if (capture.isReplay())
+        {
+            ret = replayData(timeout);
+        }
+        else
+        {
+            ret = reactor->poll(timeout);
+        }
+        if (ret < 0)
+        {
+            return ret;
+        }
+    }
+}
+
+int NetPort::replayData(int64_t timeout_ns)
+{
+    rack_time_t time;
+    int         idx, freeLen, len, ret;
+
+    freeLen = bufferSize - (int)(head - tail);
+    if (freeLen <= 0)
+    {
+        return 0;
+    }
+
+    idx = head % bufferSize;
+    len = (bufferSize - idx < freeLen) ? bufferSize - idx : freeLen;
+
+    ret = capture.read(buffer + idx, len, &time, timeout_ns);
+    if (ret < 0)
+    {
+        return ret;
+    }
+
+    addMark(time);
+    head += ret;
+
+    // a record that wraps around the ring end stays one datagram
+    if ((ret == len) && (freeLen > len) && (capture.remaining() > 0))
+    {
+        len = capture.remaining();
+        if (len > freeLen - ret)
+        {
+            len = freeLen - ret;
+        }
+
+        ret = capture.read(buffer, len, &time, PORT_CAPTURE_TIMEOUT_NONE);
+        if (ret > 0)
+        {
+            head += ret;
+        }
+    }
+    return 1;
+}
+
+void NetPort::releaseFrame(void)
+{
+    if (frameEnd > tail)
+    {
+        drop(frameEnd);
+
+        if ((reactor) && (state == NET_PORT_CONNECTED) && !(events & EPOLLIN))
+        {
+            reactor->update(this);
+        }
+    }
+}
+
+void NetPort::clean(void)
+{
+    frameEnd = head;
+    releaseFrame();
+}
+
+int NetPort::send(const void *data, int dataLen)
+{
+    struct pollfd   pfd;
+    const char      *p = (const char *)data;
+    int             len = 0;
+    ssize_t         ret;
+
+    if (state != NET_PORT_CONNECTED)
+    {
+        return -ENOTCONN;
+    }
+
+    // the replayed sensor does not get the commands
+    if (capture.isReplay())
+    {
+        return 0;
+    }
+
+    capture.write(PORT_CAPTURE_TX, data, dataLen, module ? module->rackTime.get() : 0);
+
+    if (type == NET_PORT_UDP)
+    {
+        ret = sendto(fd, data, dataLen, 0, (struct sockaddr *)&addr, sizeof(addr));
+        return (ret < 0) ? -errno : 0;
+    }
+
+    while (len < dataLen)
+    {
+        ret = ::send(fd, p + len, dataLen - len, MSG_NOSIGNAL);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                pfd.fd     = fd;
+                pfd.events = POLLOUT;
+                if (::poll(&pfd, 1, NET_PORT_SEND_TIMEOUT) == 1)
+                {
+                    continue;
+                }
+                return -ETIMEDOUT;
+            }
+
+            // the receiving side notices a broken connection
+            return -errno;
+        }
+        len += ret;
+    }
+    return 0;
+}
+
+//
+// NetReactor
+//
+
+NetReactor::NetReactor()
+{
+    epollFd = -1;
+    portNum = 0;
+}
+
+NetReactor::~NetReactor()
+{
+    close();
+}
+
+int NetReactor::open(void)
+{
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0)
+    {
+        return -errno;
+    }
+    return 0;
+}
+
+int NetReactor::close(void)
+{
+    while (portNum > 0)
+    {
+        remove(port[portNum - 1]);
+    }
+
+    if (epollFd >= 0)
+    {
+        ::close(epollFd);
+        epollFd = -1;
+    }
+    return 0;
+}
+
+int NetReactor::add(NetPort *netPort)
+{
+    if (portNum >= NET_REACTOR_PORT_MAX)
+    {
+        return -ENOSPC;
+    }
+
+    port[portNum++]  = netPort;
+    netPort->reactor = this;
+
+    return update(netPort);
+}
+
+int NetReactor::remove(NetPort *netPort)
+{
+    int i;
+
+    for (i = 0; i < portNum; i++)
+    {
+        if (port[i] == netPort)
+        {
+            if ((netPort->registered) && (netPort->fd >= 0))
+            {
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, netPort->fd, NULL);
+            }
+            netPort->registered = 0;
+            netPort->events     = 0;
+            netPort->reactor    = NULL;
+
+            port[i] = port[--portNum];
+            return 0;
+        }
+    }
+    return -ENOENT;
+}
+
+int NetReactor::update(NetPort *netPort)
+{
+    struct epoll_event ev;
+    uint32_t           events = 0;
+    int                ret;
+
+    if (netPort->fd < 0)
+    {
+        return 0;
+    }
+
+    if (netPort->state == NET_PORT_CONNECTING)
+    {
+        events = EPOLLOUT;
+    }
+    else if ((netPort->state == NET_PORT_CONNECTED) &&
+             (netPort->head - netPort->tail < (uint64_t)netPort->bufferSize))
+    {
+        events = EPOLLIN;
+    }
+
+    if ((netPort->registered) && (events == netPort->events))
+    {
+        return 0;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events   = events;
+    ev.data.ptr = netPort;
+
+    ret = epoll_ctl(epollFd, netPort->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                    netPort->fd, &ev);
+    if (ret)
+    {
+        return -errno;
+    }
+
+    netPort->registered = 1;
+    netPort->events     = events;
+    return 0;
+}
+
+int NetReactor::poll(int64_t timeout_ns)
+{
+    struct epoll_event  ev[NET_REACTOR_EVENT_MAX];
+    NetPort             *netPort;
+    uint64_t            now = getMonoNano();
+    int64_t             wait = timeout_ns;
+    int                 i, num, ret, timeout_ms;
+
+    // reconnect timers
+    for (i = 0; i < portNum; i++)
+    {
+        netPort = port[i];
+
+        if (netPort->state != NET_PORT_WAIT_RECONNECT)
+        {
+            continue;
+        }
+
+        if (netPort->reconnectTime <= now)
+        {
+            ret = netPort->connectSocket();
+            if (ret)
+            {
+                netPort->disconnect(ret);
+            }
+        }
+
+        if ((netPort->state == NET_PORT_WAIT_RECONNECT) &&
+            ((int64_t)(netPort->reconnectTime - now) < wait))
+        {
+            wait = netPort->reconnectTime - now;
+        }
+    }
+
+    if (wait < 0)
+    {
+        wait = 0;
+    }
+    timeout_ms = (wait / 1000000ll >= INT_MAX) ? INT_MAX : (int)((wait + 999999ll) / 1000000ll);
+
+    num = epoll_wait(epollFd, ev, NET_REACTOR_EVENT_MAX, timeout_ms);
+    if (num < 0)
+    {
+        return (errno == EINTR) ? 0 : -errno;
+    }
+
+    ret = 0;
+    for (i = 0; i < num; i++)
+    {
+        netPort = (NetPort *)ev[i].data.ptr;
+
+        if (netPort->state == NET_PORT_CONNECTING)
+        {
+            netPort->connectDone();
+        }
+        else if (netPort->state == NET_PORT_CONNECTED)
+        {
+            if (ev[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+            {
+                if (netPort->recvData() > 0)
+                {
+                    ret++;
+                }
+            }
+        }
+    }
+    return ret;
+}
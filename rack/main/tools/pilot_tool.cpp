@@ -0,0 +1,854 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+
+#include <main/pilot_tool.h>
+
+#define EDT_INF     1e20f
+
+//
+// Constructor and destructor
+//
+
+PilotCollisionGrid::PilotCollisionGrid()
+{
+    range       = 0;
+    cellSize    = 0;
+    cellNum     = 0;
+    cellDiag    = 0.0f;
+    pointMax    = 0;
+    cellStart   = NULL;
+    cellPoint   = NULL;
+    occSum      = NULL;
+    cellDist    = NULL;
+    outPoint    = NULL;
+    outPointNum = 0;
+    pointNum    = 0;
+    edtF        = NULL;
+    edtD        = NULL;
+    edtZ        = NULL;
+    edtV        = NULL;
+}
+
+PilotCollisionGrid::~PilotCollisionGrid()
+{
+    cleanup();
+}
+
+int PilotCollisionGrid::init(int range, int cellSize)
+{
+    int cells;
+
+    cleanup();
+
+    if ((range <= 0) || (cellSize <= 0) || (range < cellSize))
+    {
+        return -EINVAL;
+    }
+
+    this->range    = range;
+    this->cellSize = cellSize;
+    cellNum        = (2 * range + cellSize - 1) / cellSize;
+    cellDiag       = (float)cellSize * (float)M_SQRT2;
+    pointMax       = SCAN2D_POINT_MAX;
+    cells          = cellNum * cellNum;
+
+    cellStart = (int *)malloc((cells + 1) * sizeof(int));
+    cellPoint = (point_2d *)malloc(pointMax * sizeof(point_2d));
+    occSum    = (int *)malloc((cellNum + 1) * (cellNum + 1) * sizeof(int));
+    cellDist  = (float *)malloc(cells * sizeof(float));
+    outPoint  = (point_2d *)malloc(pointMax * sizeof(point_2d));
+    edtF      = (float *)malloc(cellNum * sizeof(float));
+    edtD      = (float *)malloc(cellNum * sizeof(float));
+    edtZ      = (float *)malloc((cellNum + 1) * sizeof(float));
+    edtV      = (int *)malloc(cellNum * sizeof(int));
+
+    if (!cellStart || !cellPoint || !occSum || !cellDist || !outPoint ||
+        !edtF || !edtD || !edtZ || !edtV)
+    {
+        cleanup();
+        return -ENOMEM;
+    }
+
+    memset(cellStart, 0, (cells + 1) * sizeof(int));
+    memset(occSum, 0, (cellNum + 1) * (cellNum + 1) * sizeof(int));
+    for (int i = 0; i < cells; i++)
+    {
+        cellDist[i] = EDT_INF;
+    }
+    return 0;
+}
+
+void PilotCollisionGrid::cleanup(void)
+{
+    free(cellStart);
+    free(cellPoint);
+    free(occSum);
+    free(cellDist);
+    free(outPoint);
+    free(edtF);
+    free(edtD);
+    free(edtZ);
+    free(edtV);
+
+    cellStart   = NULL;
+    cellPoint   = NULL;
+    occSum      = NULL;
+    cellDist    = NULL;
+    outPoint    = NULL;
+    edtF        = NULL;
+    edtD        = NULL;
+    edtZ        = NULL;
+    edtV        = NULL;
+    cellNum     = 0;
+    pointNum    = 0;
+    outPointNum = 0;
+}
+
+//
+// Grid construction
+//
+
+int PilotCollisionGrid::getCell(int x, int y, int *ix, int *iy)
+{
+    *ix = (int)floorf((float)(x + range) / (float)cellSize);
+    *iy = (int)floorf((float)(y + range) / (float)cellSize);
+
+    return ((*ix >= 0) && (*ix < cellNum) && (*iy >= 0) && (*iy < cellNum));
+}
+
+// one dimensional squared distance transform (Felzenszwalb and Huttenlocher)
+void PilotCollisionGrid::edt(float *f, int n)
+{
+    int     q, k = 0;
+    float   s;
+
+    edtV[0] = 0;
+    edtZ[0] = -HUGE_VALF;
+    edtZ[1] =  HUGE_VALF;
+
+    for (q = 1; q < n; q++)
+    {
+        s = ((f[q] + q * q) - (f[edtV[k]] + edtV[k] * edtV[k])) /
+            (2.0f * (q - edtV[k]));
+        while (s <= edtZ[k])
+        {
+            k--;
+            s = ((f[q] + q * q) - (f[edtV[k]] + edtV[k] * edtV[k])) /
+                (2.0f * (q - edtV[k]));
+        }
+
+        k++;
+        edtV[k]     = q;
+        edtZ[k]     = s;
+        edtZ[k + 1] = HUGE_VALF;
+    }
+
+    for (q = 0, k = 0; q < n; q++)
+    {
+        while (edtZ[k + 1] < q)
+        {
+            k++;
+        }
+        edtD[q] = (q - edtV[k]) * (q - edtV[k]) + f[edtV[k]];
+    }
+}
+
+int PilotCollisionGrid::build(scan2d_data *scan)
+{
+    int         i, j, ix, iy, cell, cells;
+    scan_point  *point;
+
+    if (!cellNum)
+    {
+        return -EINVAL;
+    }
+
+    cells       = cellNum * cellNum;
+    pointNum    = 0;
+    outPointNum = 0;
+
+    memset(cellStart, 0, (cells + 1) * sizeof(int));
+
+    // count the points of each cell
+    for (i = 0; i < scan->pointNum; i++)
+    {
+        point = &scan->point[i];
+
+        if (((point->type & SCAN_POINT_TYPE_INVALID) != 0) ||
+            ((point->type & SCAN_POINT_TYPE_MASK) == SCAN_POINT_TYPE_LANDMARK))
+        {
+            continue;
+        }
+
+        if (getCell(point->x, point->y, &ix, &iy))
+        {
+            cellStart[ix * cellNum + iy + 1]++;
+            pointNum++;
+        }
+        else if (outPointNum < pointMax)
+        {
+            outPoint[outPointNum].x = point->x;
+            outPoint[outPointNum].y = point->y;
+            outPointNum++;
+        }
+    }
+
+    if (pointNum > pointMax)
+    {
+        return -ENOSPC;
+    }
+
+    for (i = 0; i < cells; i++)
+    {
+        cellStart[i + 1] += cellStart[i];
+    }
+
+    // sort the points into their cells, cellStart is moved by one cell
+    for (i = 0; i < scan->pointNum; i++)
+    {
+        point = &scan->point[i];
+
+        if (((point->type & SCAN_POINT_TYPE_INVALID) != 0) ||
+            ((point->type & SCAN_POINT_TYPE_MASK) == SCAN_POINT_TYPE_LANDMARK))
+        {
+            continue;
+        }
+
+        if (getCell(point->x, point->y, &ix, &iy))
+        {
+            cell = ix * cellNum + iy;
+            cellPoint[cellStart[cell]].x = point->x;
+            cellPoint[cellStart[cell]].y = point->y;
+            cellStart[cell]++;
+        }
+    }
+
+    for (i = cells; i > 0; i--)
+    {
+        cellStart[i] = cellStart[i - 1];
+    }
+    cellStart[0] = 0;
+
+    // summed area table of the occupied cells
+    for (ix = 0; ix < cellNum; ix++)
+    {
+        for (iy = 0; iy < cellNum; iy++)
+        {
+            cell = ix * cellNum + iy;
+            occSum[(ix + 1) * (cellNum + 1) + iy + 1] =
+                    (cellStart[cell + 1] > cellStart[cell]) +
+                    occSum[ix * (cellNum + 1) + iy + 1] +
+                    occSum[(ix + 1) * (cellNum + 1) + iy] -
+                    occSum[ix * (cellNum + 1) + iy];
+        }
+    }
+
+    // distance transform, first along y, then along x
+    for (ix = 0; ix < cellNum; ix++)
+    {
+        for (iy = 0; iy < cellNum; iy++)
+        {
+            cell     = ix * cellNum + iy;
+            edtF[iy] = (cellStart[cell + 1] > cellStart[cell]) ? 0.0f : EDT_INF;
+        }
+
+        edt(edtF, cellNum);
+        memcpy(&cellDist[ix * cellNum], edtD, cellNum * sizeof(float));
+    }
+
+    for (iy = 0; iy < cellNum; iy++)
+    {
+        for (ix = 0; ix < cellNum; ix++)
+        {
+            edtF[ix] = cellDist[ix * cellNum + iy];
+        }
+
+        edt(edtF, cellNum);
+
+        for (ix = 0; ix < cellNum; ix++)
+        {
+            j = ix * cellNum + iy;
+            cellDist[j] = (edtD[ix] >= EDT_INF) ? EDT_INF :
+                          sqrtf(edtD[ix]) * (float)cellSize;
+        }
+    }
+
+    return 0;
+}
+
+//
+// Queries
+//
+
+// distance of (x, y) to the area outside of the grid
+int PilotCollisionGrid::getBorderDistance(int x, int y)
+{
+    int dist, d;
+
+    dist = range - abs(x);
+    d    = range - abs(y);
+    if (d < dist)
+    {
+        dist = d;
+    }
+    return (dist > 0) ? dist : 0;
+}
+
+int PilotCollisionGrid::getOccupied(int ix0, int iy0, int ix1, int iy1)
+{
+    int n = cellNum + 1;
+
+    if ((ix0 > ix1) || (iy0 > iy1))
+    {
+        return 0;
+    }
+
+    return occSum[(ix1 + 1) * n + iy1 + 1] - occSum[ix0 * n + iy1 + 1] -
+           occSum[(ix1 + 1) * n + iy0]     + occSum[ix0 * n + iy0];
+}
+
+int PilotCollisionGrid::getClearance(int x, int y, int maxDist)
+{
+    int     ix, iy, ix0, ix1, iy0, iy1, jx, jy, i, cell;
+    int     border, cells;
+    float   lowerBound, dx, dy, d2, min2;
+
+    if (!cellNum || ((pointNum == 0) && (outPointNum == 0)))
+    {
+        return PILOT_GRID_CLEARANCE_MAX;
+    }
+
+    border = getBorderDistance(x, y);
+
+    lowerBound = (float)PILOT_GRID_CLEARANCE_MAX;
+    if (getCell(x, y, &ix, &iy))
+    {
+        lowerBound = cellDist[ix * cellNum + iy] - cellDiag;
+    }
+    if ((outPointNum > 0) && (border < lowerBound))
+    {
+        lowerBound = border;
+    }
+    if (lowerBound >= maxDist)
+    {
+        return (int)lowerBound;
+    }
+
+    // exact distance to the points within maxDist
+    min2  = (float)maxDist * (float)maxDist;
+    cells = maxDist / cellSize + 1;
+
+    getCell(x, y, &ix, &iy);
+    ix0 = (ix - cells < 0) ? 0 : ix - cells;
+    iy0 = (iy - cells < 0) ? 0 : iy - cells;
+    ix1 = (ix + cells >= cellNum) ? cellNum - 1 : ix + cells;
+    iy1 = (iy + cells >= cellNum) ? cellNum - 1 : iy + cells;
+
+    for (jx = ix0; jx <= ix1; jx++)
+    {
+        for (jy = iy0; jy <= iy1; jy++)
+        {
+            cell = jx * cellNum + jy;
+            for (i = cellStart[cell]; i < cellStart[cell + 1]; i++)
+            {
+                dx = (float)(cellPoint[i].x - x);
+                dy = (float)(cellPoint[i].y - y);
+                d2 = dx * dx + dy * dy;
+                if (d2 < min2)
+                {
+                    min2 = d2;
+                }
+            }
+        }
+    }
+
+    if (border < maxDist)
+    {
+        for (i = 0; i < outPointNum; i++)
+        {
+            dx = (float)(outPoint[i].x - x);
+            dy = (float)(outPoint[i].y - y);
+            d2 = dx * dx + dy * dy;
+            if (d2 < min2)
+            {
+                min2 = d2;
+            }
+        }
+    }
+
+    return (int)sqrtf(min2);
+}
+
+int PilotCollisionGrid::testRect(int x, int y, int xSize, int ySize)
+{
+    int     xMin, xMax, yMin, yMax;
+    int     ix0, ix1, iy0, iy1, jx, jy, i, cell;
+    int     xMiddle, yMiddle, xDistance, yDistance;
+
+    if (!cellNum)
+    {
+        return 0;
+    }
+
+    // same rounding as the point loop of the pilots
+    xMiddle   = (2 * x + xSize) / 2;
+    yMiddle   = (2 * y + ySize) / 2;
+    xDistance = abs(xSize / 2);
+    yDistance = abs(ySize / 2);
+
+    xMin = xMiddle - xDistance;
+    xMax = xMiddle + xDistance;
+    yMin = yMiddle - yDistance;
+    yMax = yMiddle + yDistance;
+
+    // points outside of the grid
+    if ((xMin < -range) || (xMax >= range) || (yMin < -range) || (yMax >= range))
+    {
+        for (i = 0; i < outPointNum; i++)
+        {
+            if ((outPoint[i].x >= xMin) && (outPoint[i].x <= xMax) &&
+                (outPoint[i].y >= yMin) && (outPoint[i].y <= yMax))
+            {
+                return 1;
+            }
+        }
+    }
+
+    getCell(xMin, yMin, &ix0, &iy0);
+    getCell(xMax, yMax, &ix1, &iy1);
+
+    if ((ix1 < 0) || (iy1 < 0) || (ix0 >= cellNum) || (iy0 >= cellNum))
+    {
+        return 0;
+    }
+
+    ix0 = (ix0 < 0) ? 0 : ix0;
+    iy0 = (iy0 < 0) ? 0 : iy0;
+    ix1 = (ix1 >= cellNum) ? cellNum - 1 : ix1;
+    iy1 = (iy1 >= cellNum) ? cellNum - 1 : iy1;
+
+    // inner cells lie completely inside of the rectangle
+    if (getOccupied(ix0 + 1, iy0 + 1, ix1 - 1, iy1 - 1) > 0)
+    {
+        return 1;
+    }
+
+    // border cells, point by point
+    for (jx = ix0; jx <= ix1; jx++)
+    {
+        for (jy = iy0; jy <= iy1; jy++)
+        {
+            if ((jx != ix0) && (jx != ix1) && (jy != iy0) && (jy != iy1))
+            {
+                // skip the inner cells
+                jy = iy1 - 1;
+                continue;
+            }
+
+            cell = jx * cellNum + jy;
+            for (i = cellStart[cell]; i < cellStart[cell + 1]; i++)
+            {
+                if ((cellPoint[i].x >= xMin) && (cellPoint[i].x <= xMax) &&
+                    (cellPoint[i].y >= yMin) && (cellPoint[i].y <= yMax))
+                {
+                    return 1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+int PilotCollisionGrid::testArc(float curve, int length, int halfWidth, int *minClearance)
+{
+    float   s, step;
+    int     x, y, clearance, minClr;
+
+    minClr = PILOT_GRID_CLEARANCE_MAX;
+    s      = 0.0f;
+
+    while (1)
+    {
+        if (fabsf(curve) < 1e-7f)
+        {
+            x = (int)s;
+            y = 0;
+        }
+        else
+        {
+            x = (int)(sinf(s * curve) / curve);
+            y = (int)((1.0f - cosf(s * curve)) / curve);
+        }
+
+        // exact near the robot, the lower bound is enough for larger steps
+        clearance = getClearance(x, y, halfWidth + 4 * cellSize);
+
+        if (clearance <= halfWidth)
+        {
+            break;
+        }
+        if (clearance < minClr)
+        {
+            minClr = clearance;
+        }
+        if (s >= (float)length)
+        {
+            break;
+        }
+
+        // the robot can't reach an obstacle within this arc length
+        step = (float)(clearance - halfWidth);
+        if (step < PILOT_GRID_ARC_STEP_MIN)
+        {
+            step = PILOT_GRID_ARC_STEP_MIN;
+        }
+
+        s += step;
+        if (s > (float)length)
+        {
+            s = (float)length;
+        }
+    }
+
+    if (minClearance)
+    {
+        *minClearance = minClr;
+    }
+
+    return (clearance <= halfWidth) ? (int)s : length;
+}
+
+//
+// PilotDynamicWindow
+//
+
+PilotDynamicWindow::PilotDynamicWindow()
+{
+    candidateNum = 0;
+    candSpeed    = NULL;
+    candOmega    = NULL;
+    candBound    = NULL;
+    candScore    = NULL;
+    candFree     = NULL;
+    candOrder    = NULL;
+    arcNum       = 0;
+
+    memset(&param, 0, sizeof(param));
+}
+
+PilotDynamicWindow::~PilotDynamicWindow()
+{
+    cleanup();
+}
+
+int PilotDynamicWindow::init(void)
+{
+    cleanup();
+
+    candSpeed = (float *)malloc(PILOT_WINDOW_CANDIDATE_MAX * sizeof(float));
+    candOmega = (float *)malloc(PILOT_WINDOW_CANDIDATE_MAX * sizeof(float));
+    candBound = (float *)malloc(PILOT_WINDOW_CANDIDATE_MAX * sizeof(float));
+    candScore = (float *)malloc(PILOT_WINDOW_CANDIDATE_MAX * sizeof(float));
+    candFree  = (int *)malloc(PILOT_WINDOW_CANDIDATE_MAX * sizeof(int));
+    candOrder = (int *)malloc(PILOT_WINDOW_CANDIDATE_MAX * sizeof(int));
+
+    if (!candSpeed || !candOmega || !candBound || !candScore || !candFree || !candOrder)
+    {
+        cleanup();
+        return -ENOMEM;
+    }
+
+    param.speedNum        = PILOT_WINDOW_SPEED_NUM_DEFAULT;
+    param.omegaNum        = PILOT_WINDOW_OMEGA_NUM_DEFAULT;
+    param.arcMax          = PILOT_WINDOW_SPEED_NUM_DEFAULT * PILOT_WINDOW_OMEGA_NUM_DEFAULT;
+    param.lookahead       = 3000;
+    param.clearanceMax    = 1000;
+    param.omegaAcc        = 0.0f;
+    param.predictTime     = 1.0f;
+    param.weightClearance = 0.4f;
+    param.weightHeading   = 0.4f;
+    param.weightProgress  = 0.2f;
+    return 0;
+}
+
+void PilotDynamicWindow::cleanup(void)
+{
+    free(candSpeed);
+    free(candOmega);
+    free(candBound);
+    free(candScore);
+    free(candFree);
+    free(candOrder);
+
+    candSpeed    = NULL;
+    candOmega    = NULL;
+    candBound    = NULL;
+    candScore    = NULL;
+    candFree     = NULL;
+    candOrder    = NULL;
+    candidateNum = 0;
+}
+
+int PilotDynamicWindow::evaluate(PilotCollisionGrid *grid, chassis_param_data *chasParam,
+                                 int *speed, float *omega, int speedMax, float omegaMax,
+                                 float goalAngle, float cycleTime)
+{
+    float   vMin, vMax, wMin, wMax, v, w, acc, omegaAcc, curveMax;
+    float   wSum, wClearance, wHeading, wProgress, d, clearance, score, bestScore;
+    int     speedNum, omegaNum, halfWidth, sideMax, frontOffset, rotRadius;
+    int     length, free, minClr, dist, gap, best, i, j, k, n;
+
+    if (!candSpeed)
+    {
+        return -EINVAL;
+    }
+
+    wSum = param.weightClearance + param.weightHeading + param.weightProgress;
+    if ((wSum <= 0.0f) || (param.lookahead <= 0) || (param.clearanceMax <= 0))
+    {
+        return -EINVAL;
+    }
+    wClearance = param.weightClearance / wSum;
+    wHeading   = param.weightHeading / wSum;
+    wProgress  = param.weightProgress / wSum;
+
+    speedNum = (param.speedNum > 1) ? param.speedNum : 1;
+    omegaNum = (param.omegaNum > 1) ? param.omegaNum : 1;
+    if (speedNum * omegaNum > PILOT_WINDOW_CANDIDATE_MAX)
+    {
+        omegaNum = PILOT_WINDOW_CANDIDATE_MAX / speedNum;
+    }
+
+    sideMax     = (chasParam->boundaryLeft > chasParam->boundaryRight) ?
+                   chasParam->boundaryLeft : chasParam->boundaryRight;
+    halfWidth   = sideMax + chasParam->safetyMargin;
+    frontOffset = chasParam->boundaryFront + chasParam->safetyMargin - halfWidth;
+    if (frontOffset < 0)
+    {
+        frontOffset = 0;
+    }
+    i = (chasParam->boundaryFront > chasParam->boundaryBack) ?
+         chasParam->boundaryFront : chasParam->boundaryBack;
+    rotRadius = (int)sqrtf((float)i * (float)i + (float)sideMax * (float)sideMax) +
+                chasParam->safetyMargin;
+
+    if (speedMax > chasParam->vxMax)
+    {
+        speedMax = chasParam->vxMax;
+    }
+    if (omegaMax > chasParam->omegaMax)
+    {
+        omegaMax = chasParam->omegaMax;
+    }
+    if (speedMax < 1)
+    {
+        speedMax = 1;
+    }
+
+    acc = (chasParam->accMax > 0) ? (float)chasParam->accMax : (float)speedMax;
+
+    omegaAcc = param.omegaAcc;
+    if (omegaAcc <= 0.0f)
+    {
+        if (chasParam->minTurningRadius > 0)
+        {
+            omegaAcc = acc / (float)chasParam->minTurningRadius;
+        }
+        else
+        {
+            omegaAcc = acc / (float)((halfWidth > 0) ? halfWidth : 1);
+        }
+    }
+
+    curveMax = (chasParam->minTurningRadius > 0) ?
+               1.0f / (float)chasParam->minTurningRadius : HUGE_VALF;
+
+    // dynamic window, forward speeds only
+    vMin = (float)*speed - acc * cycleTime;
+    vMax = (float)*speed + acc * cycleTime;
+    if (vMin < 0.0f)
+    {
+        vMin = 0.0f;
+    }
+    if (vMax > (float)speedMax)
+    {
+        vMax = (float)speedMax;
+    }
+    if (vMin > vMax)
+    {
+        vMin = vMax;
+    }
+
+    wMin = *omega - omegaAcc * cycleTime;
+    wMax = *omega + omegaAcc * cycleTime;
+    if (wMin < -omegaMax)
+    {
+        wMin = -omegaMax;
+    }
+    if (wMax > omegaMax)
+    {
+        wMax = omegaMax;
+    }
+    if (wMin > wMax)
+    {
+        if (*omega > 0.0f)
+        {
+            wMin = wMax;
+        }
+        else
+        {
+            wMax = wMin;
+        }
+    }
+
+    // sample the window, the turning radius limits omega at low speeds
+    n = 0;
+    for (i = 0; i < speedNum; i++)
+    {
+        v = (speedNum > 1) ? vMin + (vMax - vMin) * (float)i / (float)(speedNum - 1) : vMax;
+
+        for (j = 0; j < omegaNum; j++)
+        {
+            w = (omegaNum > 1) ? wMin + (wMax - wMin) * (float)j / (float)(omegaNum - 1) :
+                                 0.5f * (wMin + wMax);
+
+            if (fabsf(w) > curveMax * v)
+            {
+                continue;
+            }
+            candSpeed[n] = v;
+            candOmega[n] = w;
+            n++;
+        }
+    }
+    candidateNum = n;
+
+    // heading and progress of all candidates, upper bound of the score
+    for (k = 0; k < n; k++)
+    {
+        d = goalAngle - candOmega[k] * param.predictTime;
+        d = d - 2.0f * (float)M_PI * rintf(d * (float)(0.5 / M_PI));
+
+        candBound[k] = wHeading * (1.0f - fabsf(d) * (float)M_1_PI) +
+                       wProgress * candSpeed[k] / (float)speedMax +
+                       wClearance;
+        candScore[k] = -1.0f;
+        candFree[k]  = 0;
+        candOrder[k] = k;
+    }
+
+    // best bound first (shell sort, stable enough for a deterministic result)
+    for (gap = n / 2; gap > 0; gap /= 2)
+    {
+        for (i = gap; i < n; i++)
+        {
+            k = candOrder[i];
+            for (j = i; (j >= gap) && (candBound[candOrder[j - gap]] < candBound[k]); j -= gap)
+            {
+                candOrder[j] = candOrder[j - gap];
+            }
+            candOrder[j] = k;
+        }
+    }
+
+    // arc tests until no remaining candidate can win or the budget is used
+    best      = -1;
+    bestScore = -1.0f;
+    arcNum    = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        k = candOrder[i];
+        if ((candBound[k] <= bestScore) || (arcNum >= param.arcMax))
+        {
+            break;
+        }
+
+        v = candSpeed[k];
+        w = candOmega[k];
+
+        if (v < 1.0f)
+        {
+            // turn on the spot or stand still
+            minClr = grid->getClearance(0, 0, rotRadius + param.clearanceMax);
+            if ((w != 0.0f) && (minClr <= rotRadius))
+            {
+                continue;
+            }
+            free   = param.lookahead;
+            length = param.lookahead;
+            minClr = minClr - rotRadius + halfWidth;
+        }
+        else
+        {
+            // half a circle is enough
+            length = param.lookahead;
+            if ((w != 0.0f) && ((float)length > (float)M_PI * v / fabsf(w)))
+            {
+                length = (int)((float)M_PI * v / fabsf(w));
+            }
+
+            free = grid->testArc(w / v, length, halfWidth, &minClr);
+            arcNum++;
+
+            // the robot has to stop within the free length after this cycle
+            if (free < length)
+            {
+                dist = free - frontOffset - (int)(v * cycleTime);
+                if ((dist <= 0) || (v * v > 2.0f * acc * (float)dist))
+                {
+                    continue;
+                }
+            }
+        }
+
+        candFree[k] = free;
+
+        clearance = (float)(minClr - halfWidth);
+        if (clearance > (float)param.clearanceMax)
+        {
+            clearance = (float)param.clearanceMax;
+        }
+        if (clearance < 0.0f)
+        {
+            clearance = 0.0f;
+        }
+        clearance = 0.5f * (float)free / (float)length +
+                    0.5f * clearance / (float)param.clearanceMax;
+
+        score = candBound[k] - wClearance * (1.0f - clearance);
+        candScore[k] = score;
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best      = k;
+        }
+    }
+
+    if (best < 0)
+    {
+        *speed = 0;
+        *omega = 0.0f;
+        return -EAGAIN;
+    }
+
+    *speed = (int)candSpeed[best];
+    *omega = candOmega[best];
+    return 0;
+}
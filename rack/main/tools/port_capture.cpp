@@ -0,0 +1,481 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/uio.h>
+
+#include <main/port_capture.h>
+
+#define PORT_CAPTURE_EOF_WAIT       1000000000ll    // 1s
+
+static uint64_t getMonoNano(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000llu + ts.tv_nsec;
+}
+
+static void sleepNano(int64_t time)
+{
+    struct timespec ts;
+
+    ts.tv_sec  = time / 1000000000ll;
+    ts.tv_nsec = time % 1000000000ll;
+    while (nanosleep(&ts, &ts) && (errno == EINTR));
+}
+
+PortCapture::PortCapture()
+{
+    file     = NULL;
+    mode     = PORT_CAPTURE_OFF;
+    modeReq  = PORT_CAPTURE_OFF;
+    speed    = 1.0f;
+    loop     = 0;
+    module   = NULL;
+    data     = NULL;
+    recValid = 0;
+    fileName[0] = 0;
+}
+
+PortCapture::~PortCapture()
+{
+    close();
+}
+
+int PortCapture::record(const char *fileName)
+{
+    if (mode != PORT_CAPTURE_OFF)
+    {
+        return -EBUSY;
+    }
+
+    snprintf(this->fileName, sizeof(this->fileName), "%s", fileName);
+    modeReq = PORT_CAPTURE_RECORD;
+    return 0;
+}
+
+int PortCapture::replay(const char *fileName, float speed, int loop)
+{
+    if (mode != PORT_CAPTURE_OFF)
+    {
+        return -EBUSY;
+    }
+    if (speed < 0.0f)
+    {
+        return -EINVAL;
+    }
+
+    snprintf(this->fileName, sizeof(this->fileName), "%s", fileName);
+    this->speed = speed;
+    this->loop  = loop;
+    modeReq     = PORT_CAPTURE_REPLAY;
+    return 0;
+}
+
+int PortCapture::init(const char *name, RackModule *module)
+{
+    const char  *dir, *env;
+    int         ret;
+
+    close();
+
+    this->module = module;
+    mode         = modeReq;
+
+    if (mode == PORT_CAPTURE_OFF)
+    {
+        if ((dir = getenv(PORT_CAPTURE_ENV_REPLAY)) != NULL)
+        {
+            mode  = PORT_CAPTURE_REPLAY;
+            speed = 1.0f;
+            loop  = 0;
+
+            if ((env = getenv(PORT_CAPTURE_ENV_SPEED)) != NULL)
+            {
+                speed = atof(env);
+                if (speed < 0.0f)
+                {
+                    speed = 0.0f;
+                }
+            }
+            if ((env = getenv(PORT_CAPTURE_ENV_LOOP)) != NULL)
+            {
+                loop = atoi(env);
+            }
+        }
+        else if ((dir = getenv(PORT_CAPTURE_ENV_RECORD)) != NULL)
+        {
+            mode = PORT_CAPTURE_RECORD;
+        }
+        else
+        {
+            return PORT_CAPTURE_OFF;
+        }
+
+        snprintf(fileName, sizeof(fileName), "%s/%s.cap", dir, name);
+    }
+
+    ret = openFile(name);
+    if (ret)
+    {
+        close();
+        return ret;
+    }
+
+    return mode;
+}
+
+int PortCapture::openFile(const char *name)
+{
+    port_capture_header head;
+    int                 ret;
+
+    if (mode == PORT_CAPTURE_RECORD)
+    {
+        file = fopen(fileName, "wb");
+        if (!file)
+        {
+            return -errno;
+        }
+
+        memset(&head, 0, sizeof(head));
+        head.magic   = PORT_CAPTURE_MAGIC;
+        head.version = PORT_CAPTURE_VERSION;
+        snprintf(head.name, sizeof(head.name), "%s", name);
+
+        if ((fwrite(&head, sizeof(head), 1, file) != 1) || fflush(file))
+        {
+            return -EIO;
+        }
+        return 0;
+    }
+
+    file = fopen(fileName, "rb");
+    if (!file)
+    {
+        return -errno;
+    }
+
+    if ((fread(&head, sizeof(head), 1, file) != 1) ||
+        (head.magic != PORT_CAPTURE_MAGIC) ||
+        (head.version != PORT_CAPTURE_VERSION))
+    {
+        return -EINVAL;
+    }
+
+    data = (uint8_t *)malloc(PORT_CAPTURE_RECORD_MAX);
+    if (!data)
+    {
+        return -ENOMEM;
+    }
+
+    dataStart = ftell(file);
+    eof       = 0;
+
+    memset(&stats, 0, sizeof(stats));
+    statsStart = 0;
+
+    // the replay starts now with the first record
+    ret = readRecord();
+    if (ret)
+    {
+        return (ret == -ENODATA) ? -EINVAL : ret;
+    }
+
+    firstTime          = rec.time;
+    firstRecordingTime = rec.recordingTime;
+    startTime          = getMonoNano();
+    timeOffset         = (module ? module->rackTime.get() : firstRecordingTime) -
+                         firstRecordingTime;
+    recDue             = startTime;
+    return 0;
+}
+
+int PortCapture::close(void)
+{
+    if ((mode == PORT_CAPTURE_REPLAY) && (file) && (!eof) && (stats.recordNum > 0))
+    {
+        printStats();
+    }
+
+    if (file)
+    {
+        fclose(file);
+        file = NULL;
+    }
+    if (data)
+    {
+        free(data);
+        data = NULL;
+    }
+
+    mode     = PORT_CAPTURE_OFF;
+    recValid = 0;
+    return 0;
+}
+
+void PortCapture::write(int dir, const void *data, int dataLen, rack_time_t recordingTime)
+{
+    struct iovec iov;
+
+    iov.iov_base = (void *)data;
+    iov.iov_len  = dataLen;
+
+    write(dir, &iov, 1, recordingTime);
+}
+
+void PortCapture::write(int dir, const struct iovec *iov, int iovNum, rack_time_t recordingTime)
+{
+    port_capture_record record;
+    int                 i;
+
+    if (mode != PORT_CAPTURE_RECORD)
+    {
+        return;
+    }
+
+    record.time          = getMonoNano();
+    record.recordingTime = recordingTime;
+    record.dir           = dir;
+    record.reserved      = 0;
+    record.len           = 0;
+
+    for (i = 0; i < iovNum; i++)
+    {
+        record.len += iov[i].iov_len;
+    }
+    if ((record.len == 0) || (record.len > PORT_CAPTURE_RECORD_MAX))
+    {
+        return;
+    }
+
+    // send and receive may be called by different tasks
+    flockfile(file);
+    fwrite(&record, sizeof(record), 1, file);
+    for (i = 0; i < iovNum; i++)
+    {
+        fwrite(iov[i].iov_base, iov[i].iov_len, 1, file);
+    }
+    fflush(file);
+    funlockfile(file);
+}
+
+int PortCapture::readRecord(void)
+{
+    if (fread(&rec, sizeof(rec), 1, file) != 1)
+    {
+        return -ENODATA;
+    }
+    if (rec.len > PORT_CAPTURE_RECORD_MAX)
+    {
+        return -EINVAL;
+    }
+    if ((rec.len > 0) && (fread(data, rec.len, 1, file) != 1))
+    {
+        return -ENODATA;
+    }
+
+    recPos   = 0;
+    recValid = 1;
+
+    if (speed > 0.0f)
+    {
+        recDue = startTime + (uint64_t)((double)(rec.time - firstTime) / speed);
+    }
+    else
+    {
+        recDue = getMonoNano();
+    }
+    return 0;
+}
+
+int PortCapture::read(void *data, int dataLen, rack_time_t *recordingTime, int64_t timeout_ns)
+{
+    uint64_t    now;
+    int64_t     wait;
+    int         ret, len;
+
+    if (mode != PORT_CAPTURE_REPLAY)
+    {
+        return -EBADF;
+    }
+
+    while (1)
+    {
+        if (!recValid)
+        {
+            ret = readRecord();
+            if (ret == -ENODATA)
+            {
+                if (loop)
+                {
+                    // start again, the timestamps keep increasing
+                    fseek(file, dataStart, SEEK_SET);
+                    stats.loopNum++;
+                    startTime  = getMonoNano();
+                    timeOffset = (module ? module->rackTime.get() : firstRecordingTime) -
+                                 firstRecordingTime;
+                    ret = readRecord();
+                }
+                if (ret)
+                {
+                    if (!eof)
+                    {
+                        eof = 1;
+                        printStats();
+                    }
+                    if ((speed > 0.0f) && (timeout_ns != PORT_CAPTURE_TIMEOUT_NONE))
+                    {
+                        sleepNano(((timeout_ns > 0) && (timeout_ns < PORT_CAPTURE_EOF_WAIT)) ?
+                                  timeout_ns : PORT_CAPTURE_EOF_WAIT);
+                    }
+                    return -ETIMEDOUT;
+                }
+            }
+            else if (ret)
+            {
+                return ret;
+            }
+        }
+
+        // only received data is replayed
+        if ((rec.dir != PORT_CAPTURE_RX) || (rec.len == 0))
+        {
+            recValid = 0;
+            continue;
+        }
+
+        now = getMonoNano();
+        if (recDue > now)
+        {
+            wait = recDue - now;
+
+            if (timeout_ns == PORT_CAPTURE_TIMEOUT_NONE)
+            {
+                return -ETIMEDOUT;
+            }
+            if ((timeout_ns > 0) && (wait > timeout_ns))
+            {
+                sleepNano(timeout_ns);
+                return -ETIMEDOUT;
+            }
+            sleepNano(wait);
+        }
+
+        if (!statsStart)
+        {
+            statsStart = recDue;
+        }
+
+        len = rec.len - recPos;
+        if (len > dataLen)
+        {
+            len = dataLen;
+        }
+
+        memcpy(data, this->data + recPos, len);
+        recPos += len;
+
+        if (recordingTime)
+        {
+            *recordingTime = rec.recordingTime + timeOffset;
+        }
+
+        if (recPos >= rec.len)
+        {
+            now = getMonoNano();
+
+            stats.recordNum++;
+            stats.byteNum  += rec.len;
+            stats.duration  = now - statsStart;
+            if (now > recDue)
+            {
+                stats.latencySum += now - recDue;
+                if (now - recDue > stats.latencyMax)
+                {
+                    stats.latencyMax = now - recDue;
+                }
+            }
+            recValid = 0;
+        }
+        return len;
+    }
+}
+
+int PortCapture::pending(void)
+{
+    if (mode != PORT_CAPTURE_REPLAY)
+    {
+        return 0;
+    }
+
+    while (!recValid || (rec.dir != PORT_CAPTURE_RX) || (rec.len == 0))
+    {
+        recValid = 0;
+        if (readRecord())
+        {
+            return 0;
+        }
+    }
+
+    if (recDue > getMonoNano())
+    {
+        return 0;
+    }
+    return rec.len - recPos;
+}
+
+int PortCapture::remaining(void)
+{
+    if ((mode != PORT_CAPTURE_REPLAY) || (!recValid))
+    {
+        return 0;
+    }
+    return rec.len - recPos;
+}
+
+void PortCapture::clean(void)
+{
+    recValid = 0;
+}
+
+void PortCapture::getStats(port_capture_stats *stats)
+{
+    memcpy(stats, &this->stats, sizeof(port_capture_stats));
+}
+
+void PortCapture::printStats(void)
+{
+    double duration = (double)stats.duration * 1e-9;
+
+    printf("PortCapture: replay of %s finished, %u records, %llu bytes in %.3f s",
+           fileName, stats.recordNum, (unsigned long long)stats.byteNum, duration);
+    if (duration > 0.0)
+    {
+        printf(", %.0f records/s, %.3f MB/s", stats.recordNum / duration,
+               stats.byteNum / duration / 1e6);
+    }
+    if (stats.recordNum > 0)
+    {
+        printf(", latency mean %.3f ms max %.3f ms",
+               (double)stats.latencySum / stats.recordNum * 1e-6,
+               (double)stats.latencyMax * 1e-6);
+    }
+    printf("\n");
+    fflush(stdout);
+}
@@ -19,11 +19,13 @@
 PositionTool::PositionTool()
 {
     gdos = NULL;
+    initConstants();
 }
 
 PositionTool::PositionTool(RackMailbox *p_mbx, int gdos_level)
 {
     gdos = new RackGdos(p_mbx, gdos_level);
+    initConstants();
 }
 
 PositionTool::~PositionTool()
@@ -706,3 +708,557 @@ void PositionTool::gkToWgs84(position_gk_data *posGk, position_wgs84_data *posWg
     posWgs84->altitude  = (int)rint(((xq / (cos(lat) * cos(lon))) - n) * 1000.0);
     posWgs84->heading   = posGk->heading;
 }
+
+//
+// array functions
+//
+
+void PositionTool::initConstants(void)
+{
+    double utmA = 6378137.0;                // Semi-major axis of ellipsoid in meters
+    double utmF = 1.0 / 298.257223563;      // flattening of ellipsoid
+    double utmB;
+    double tn, tn2, tn3, tn4, tn5;
+    double i;
+
+    // transverse mercator parameter
+    utmEs  = 2.0 * utmF - utmF * utmF;
+    utmEbs = (1.0 / (1.0 - utmEs)) - 1.0;
+    utmB   = utmA * (1.0 - utmF);
+
+    // true meridianal constants
+    tn  = (utmA - utmB) / (utmA + utmB);
+    tn2 = tn * tn;
+    tn3 = tn2 * tn;
+    tn4 = tn3 * tn;
+    tn5 = tn4 * tn;
+
+    utmAp = utmA * (1.0 - tn + 5.0 * (tn2 - tn3) / 4.0 + 81.0 * (tn4 - tn5) / 64.0 );
+    utmBp = 3.0 * utmA * (tn - tn2 + 7.0 * (tn3 - tn4) / 8.0 + 55.0 * tn5 / 64.0 ) / 2.0;
+    utmCp = 15.0 * utmA  * (tn2 - tn3 + 3.0 * (tn4 - tn5 ) / 4.0) / 16.0;
+    utmDp = 35.0 * utmA  * (tn3 - tn4 + 11.0 * tn5 / 16.0) / 48.0;
+    utmEp = 315.0 * utmA * (tn4 - tn5) / 512.0;
+
+    // Gauss-Krueger, Bessel ellipsoid
+    wgsEq    = (AWGS * AWGS - BWGS * BWGS) / (AWGS * AWGS);
+    besEq    = (ABES * ABES - BBES * BBES) / (ABES * ABES);
+    besEst   = sqrt(besEq / (1.0 - besEq));
+    besEq2   = (ABES * ABES - BBES * BBES) / (BBES * BBES);
+    besCbess = ABES / sqrt(1.0 - besEq);
+
+    gkAlpha  = (1.0 - (3.0 / 4.0) * besEq2  + (45.0 / 64.0) * pow(besEq2, 2) -
+               (175.0 / 256.0) * pow(besEq2, 3) + (11025.0 / 16384.0) * pow(besEq2, 4));
+    gkBeta   = (1.0 / 2.0) * ((3.0 / 4.0) * besEq2  - (15.0 / 16.0) * pow(besEq2, 2) +
+               (525.0 / 512.0) * pow(besEq2, 3) - (2205.0 / 2048.0) * pow(besEq2, 4));
+    gkGamma  = (1.0 / 4.0) * ((15.0 / 64.0) * pow(besEq2, 2) -
+               (105.0 / 256.0) * pow(besEq2, 3) + (2205.0 / 4096.0) * pow(besEq2, 4));
+    gkDelta  = (1.0 / 6.0) * ((35.0 / 512.0) * pow(besEq2, 3) +
+               (2205.0 / 4096.0) * pow(besEq2, 4));
+
+    // footpoint latitude
+    i        = (ABES - BBES) / (ABES + BBES);
+    gkGrd    = (ABES / (1.0 + i)) * (1.0 + 0.25 * i * i + (1.0 / 64.0) * i * i * i * i);
+    gkBf2    = (3.0 / 2.0) * (i - (9.0 / 16.0) * i * i * i);
+    gkBf4    = (21.0 / 16.0) * i * i;
+    gkBf6    = (151.0 / 96.0) * i * i * i;
+}
+
+// sin(2x), sin(4x), sin(6x) and sin(8x) from s = sin(x) and c = cos(x)
+static inline void multipleAngleSin(double s, double c, double *sin2, double *sin4,
+                                    double *sin6, double *sin8)
+{
+    double cos2, cos4;
+
+    *sin2 = 2.0 * s * c;
+    cos2  = c * c - s * s;
+    *sin4 = 2.0 * *sin2 * cos2;
+    cos4  = cos2 * cos2 - *sin2 * *sin2;
+    *sin6 = *sin4 * cos2 + cos4 * *sin2;
+    *sin8 = 2.0 * *sin4 * cos4;
+}
+
+void PositionTool::wgs84ToUtm(position_wgs84_data *posWgs84, position_utm_data *posUtm,
+                              int num)
+{
+    const double utmA         = 6378137.0;
+    const double utmScale     = 0.9996;
+    const double falseEasting = 500000;
+    int    i, zone, utmBand;
+    int    latDeg, lonDeg;
+    double lat, lon;
+    double dlam, dlam2, dlam3, dlam4;
+    double dlam5, dlam6, dlam7, dlam8;
+    double s, c, c2, c3, c5, c7;
+    double t, tan2, tan4, tan6;
+    double eta, eta2, eta3, eta4;
+    double sin2, sin4, sin6, sin8;
+    double sn, tmd;
+    double t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    double centralMeridian;
+    double falseNorthing;
+
+    for (i = 0; i < num; i++)
+    {
+        lat = posWgs84[i].latitude;
+        lon = posWgs84[i].longitude;
+        if (lon < 0)
+        {
+            lon += (2.0 * M_PI) + 1.0e-10;
+        }
+        latDeg = (int)(lat * 180.0 / M_PI);
+        lonDeg = (int)(lon * 180.0 / M_PI);
+
+        // zone calculation, see wgs84ToUtm()
+        if (posWgs84[i].longitude < M_PI)
+        {
+            zone = (int)(31 + ((posWgs84[i].longitude * 180.0 / M_PI) / 6.0));
+        }
+        else
+        {
+            zone = (int)(((posWgs84[i].longitude * 180.0 / M_PI) / 6.0) - 29);
+        }
+        if (zone > 60)
+        {
+            zone = 1;
+        }
+
+        if ((latDeg > 55) && (latDeg < 64) && (lonDeg > -1) && (lonDeg < 3))
+        {
+            zone = 31;
+        }
+        if ((latDeg > 55) && (latDeg < 64) && (lonDeg > 2) && (lonDeg < 12))
+        {
+            zone = 32;
+        }
+        if (latDeg > 71)
+        {
+            if ((lonDeg > -1) && (lonDeg < 9))
+            {
+                zone = 31;
+            }
+            else if ((lonDeg > 8) && (lonDeg < 21))
+            {
+                zone = 33;
+            }
+            else if ((lonDeg > 20) && (lonDeg < 33))
+            {
+                zone = 35;
+            }
+            else if ((lonDeg > 32) && (lonDeg < 42))
+            {
+                zone = 37;
+            }
+        }
+
+        if (zone >= 31)
+        {
+            centralMeridian = (6 * zone - 183) * M_PI / 180.0;
+        }
+        else
+        {
+            centralMeridian = (6 * zone + 177) * M_PI / 180.0;
+        }
+        if (centralMeridian > M_PI)
+        {
+            centralMeridian -= (2.0 * M_PI);
+        }
+
+        falseNorthing = (lat < 0) ? 10000000 : 0;
+
+        // band calculation, C ... X are numbered in a row
+        if (latDeg < -80)
+        {
+            posUtm[i].band = ((lonDeg >= -90) && (lonDeg < 0)) ? A : B;
+        }
+        else if (latDeg >= 84)
+        {
+            posUtm[i].band = ((lonDeg >= -90) && (lonDeg < 0)) ? Y : Z;
+        }
+        else
+        {
+            utmBand = ((latDeg + 80) / 8) + 2;
+            if (utmBand > X)
+            {
+                utmBand = X;
+            }
+            posUtm[i].band = (position_utm_band)utmBand;
+        }
+        posUtm[i].zone = zone;
+
+        // delta longitude
+        dlam = lon - centralMeridian;
+        if (dlam > M_PI)
+        {
+            dlam -= (2.0 * M_PI);
+        }
+        if (dlam < -M_PI)
+        {
+            dlam += (2 * M_PI);
+        }
+        if (fabs(dlam) < 2.e-10)
+        {
+            dlam = 0.0;
+        }
+
+        dlam2 = dlam * dlam;
+        dlam3 = dlam * dlam2;
+        dlam4 = dlam2 * dlam2;
+        dlam5 = dlam2 * dlam3;
+        dlam6 = dlam3 * dlam3;
+        dlam7 = dlam3 * dlam4;
+        dlam8 = dlam4 * dlam4;
+        s     = sin(lat);
+        c     = cos(lat);
+        c2    = c * c;
+        c3    = c2 * c;
+        c5    = c3 * c2;
+        c7    = c5 * c2;
+        t     = s / c;
+        tan2  = t * t;
+        tan4  = tan2 * tan2;
+        tan6  = tan4 * tan2;
+        eta   = utmEbs * c2;
+        eta2  = eta * eta;
+        eta3  = eta2 * eta;
+        eta4  = eta3 * eta;
+
+        // radius of curvature in prime vertical
+        sn  = utmA / sqrt(1.0 - utmEs * s * s);
+
+        multipleAngleSin(s, c, &sin2, &sin4, &sin6, &sin8);
+        tmd = utmAp * lat - utmBp * sin2 + utmCp * sin4 - utmDp * sin6 + utmEp * sin8;
+
+        // northing
+        t1 = tmd * utmScale;
+        t2 = sn * s * c * utmScale / 2.0;
+        t3 = sn * s * c3 * utmScale * (5.0 - tan2 + 9.0 * eta + 4.0 * eta2) / 24.0;
+        t4 = sn * s * c5 * utmScale * (61.0 - 58.0 * tan2 + tan4 + 270.0 * eta -
+                                       330.0 * tan2 * eta + 445.0 * eta2 + 324.0 * eta3 -
+                                       680.0 * tan2 * eta2 + 88.0 * eta4 - 600.0 * tan2 * eta3 -
+                                       192.0 * tan2 * eta4) / 720.0;
+        t5 = sn * s * c7 * utmScale * (1385.0 - 3111.0 * tan2 + 543.0 * tan4 - tan6) / 40320.0;
+
+        // easting
+        t6 = sn * c * utmScale;
+        t7 = sn * c3 * utmScale * ( 1.0 - tan2 + eta ) / 6.0;
+        t8 = sn * c5 * utmScale * ( 5.0 - 18.0 * tan2 + tan4 +
+                                   14.0 * eta - 58.0 * tan2 * eta + 13.0 * eta2 + 4.0 * eta3 -
+                                   64.0 * tan2 * eta2 - 24.0 * tan2 * eta3 ) / 120.0;
+        t9 = sn * c7 * utmScale * (61.0 - 479.0 * tan2 + 179.0 * tan4 - tan6 ) / 5040.0;
+
+        posUtm[i].northing = (falseNorthing + t1 + dlam2 * t2 + dlam4 * t3 + dlam6 * t4 +
+                              dlam8 * t5) * 1000.0;
+        posUtm[i].easting  = (falseEasting + dlam * t6 + dlam3 * t7 + dlam5 * t8 +
+                              dlam7 * t9) * 1000.0;
+        posUtm[i].altitude = posWgs84[i].altitude;
+        posUtm[i].heading  = posWgs84[i].heading;
+    }
+}
+
+void PositionTool::utmToWgs84(position_utm_data *posUtm, position_wgs84_data *posWgs84,
+                              int num)
+{
+    const double utmA         = 6378137.0;
+    const double utmScale     = 0.9996;
+    const double falseEasting = 500000;
+    int    i, j;
+    double a, s, c;
+    double de, de2, de3, de4;
+    double de5, de6, de7, de8;
+    double dlam, ftphi;
+    double eta, eta2, eta3, eta4;
+    double sn, sn3, sn5, sn7, sr, sr0;
+    double t, tan2, tan4, tan6;
+    double sin2, sin4, sin6, sin8;
+    double t10, t11, t12, t13;
+    double t14, t15, t16, t17;
+    double tmd;
+    double utmScale2, utmScale3, utmScale4;
+    double utmScale5, utmScale6, utmScale7, utmScale8;
+    double centralMeridian;
+    double falseNorthing;
+
+    utmScale2 = utmScale * utmScale;
+    utmScale3 = utmScale2 * utmScale;
+    utmScale4 = utmScale2 * utmScale2;
+    utmScale5 = utmScale3 * utmScale2;
+    utmScale6 = utmScale4 * utmScale2;
+    utmScale7 = utmScale4 * utmScale3;
+    utmScale8 = utmScale6 * utmScale2;
+    sr0       = utmA * (1.0 - utmEs);
+
+    for (i = 0; i < num; i++)
+    {
+        if (posUtm[i].zone >= 31)
+        {
+            centralMeridian = (6 * posUtm[i].zone - 183) * M_PI / 180.0;
+        }
+        else
+        {
+            centralMeridian = (6 * posUtm[i].zone + 177) * M_PI / 180.0;
+        }
+        falseNorthing = (posUtm[i].northing < 0) ? 10000000 : 0;
+
+        // footpoint latitude
+        tmd   = (posUtm[i].northing / 1000.0 - falseNorthing) / utmScale;
+        ftphi = tmd / sr0;
+
+        for (j = 0; j < 5 ; j++)
+        {
+            s     = sin(ftphi);
+            c     = cos(ftphi);
+            multipleAngleSin(s, c, &sin2, &sin4, &sin6, &sin8);
+            t10   = utmAp * ftphi - utmBp * sin2 + utmCp * sin4 - utmDp * sin6 - utmEp * sin8;
+            a     = sqrt(1.0 - utmEs * s * s);
+            sr    = sr0 / (a * a * a);
+            ftphi = ftphi + (tmd - t10) / sr;
+        }
+
+        // radius of curvature in the meridian
+        s   = sin(ftphi);
+        c   = cos(ftphi);
+        a   = sqrt(1.0 - utmEs * s * s);
+        sr  = sr0 / (a * a * a);
+        sn  = utmA / a;
+        sn3 = sn * sn * sn;
+        sn5 = sn3 * sn * sn;
+        sn7 = sn5 * sn * sn;
+
+        t    = s / c;
+        tan2 = t * t;
+        tan4 = tan2 * tan2;
+        tan6 = tan4 * tan2;
+        eta  = utmEbs * c * c;
+        eta2 = eta * eta;
+        eta3 = eta2 * eta;
+        eta4 = eta3 * eta;
+
+        de   = posUtm[i].easting / 1000.0 - falseEasting;
+        if (fabs(de) < 0.0001)
+        {
+            de = 0.0;
+        }
+        de2  = de * de;
+        de3  = de2 * de;
+        de4  = de2 * de2;
+        de5  = de3 * de2;
+        de6  = de4 * de2;
+        de7  = de4 * de3;
+        de8  = de4 * de4;
+
+        // latitude
+        t10 = t / (2.0 * sr * sn * utmScale2);
+        t11 = t * (5.0  + 3.0 * tan2 + eta - 4.0 * eta2 -
+                   9.0 * tan2 * eta) / (24.0 * sr * sn3 * utmScale4);
+        t12 = t * (61.0 + 90.0 * tan2 + 46.0 * eta + 45.0 * tan4 -
+                   252.0 * tan2 * eta  - 3.0 * eta2 + 100.0 * eta3 -
+                   66.0 * tan2 * eta2 - 90.0 * tan4 * eta +
+                   88.0 * eta4 + 225.0 * tan4 * eta2 + 84.0 * tan2 * eta3 -
+                   192.0 * tan2 * eta4) / ( 720.0 * sr * sn5 * utmScale6);
+        t13 = t * (1385.0 + 3633.0 * tan2 + 4095.0 * tan4 + 1575.0 * tan6) /
+                  (40320.0 * sr * sn7 * utmScale8);
+        posWgs84[i].latitude = ftphi - de2 * t10 + de4 * t11 - de6 * t12 + de8 * t13;
+
+        // longitude
+        t14 = 1.0 / (sn * c * utmScale);
+        t15 = (1.0 + 2.0 * tan2 + eta) / (6.0 * sn3 * c * utmScale3);
+        t16 = (5.0 + 6.0 * eta + 28.0 * tan2 - 3.0 * eta2 +
+               8.0 * tan2 * eta + 24.0 * tan4 - 4.0 * eta3 +
+               4.0 * tan2 * eta2 + 24.0 * tan2 * eta3) / (120.0 * sn5 * c * utmScale5);
+        t17 = (61.0 +  662.0 * tan2 + 1320.0 * tan4 + 720.0 * tan6) /
+              (5040.0 * sn7 * c * utmScale7);
+
+        dlam = de * t14 - de3 * t15 + de5 * t16 - de7 * t17;
+
+        posWgs84[i].longitude = centralMeridian + dlam;
+        if (posWgs84[i].longitude > (M_PI))
+        {
+            posWgs84[i].longitude -= (2.0 * M_PI);
+        }
+        posWgs84[i].altitude  = posUtm[i].altitude;
+        posWgs84[i].heading   = posUtm[i].heading;
+    }
+}
+
+void PositionTool::wgs84ToGk(position_wgs84_data *posWgs84, position_gk_data *posGk, int num)
+{
+    int     i;
+    double  altitude;
+    double  sinLat, cosLat;
+    double  sinLon, cosLon;
+    double  sinPhi, cosPhi;
+    double  xq, yq, zq;
+    double  xz, yz, zz;
+    double  phi, phiOld, lambda, h;
+    double  n, r, t, l, l2;
+    double  c2, c3, c5;
+    double  eta, eta2;
+    double  sin2, sin4, sin6, sin8;
+    double  a1, a2, a3, a4, a5;
+    double  strip, gb;
+
+    for (i = 0; i < num; i++)
+    {
+        sinLat   = sin(posWgs84[i].latitude);
+        cosLat   = cos(posWgs84[i].latitude);
+        sinLon   = sin(posWgs84[i].longitude);
+        cosLon   = cos(posWgs84[i].longitude);
+        altitude = (double)posWgs84[i].altitude / 1000.0;           // unit m
+
+        // geocentric cartesian coordinates in wgs84 ellipsoid
+        n  = AWGS / sqrt(1.0 - wgsEq * sinLat * sinLat);
+        xq = (n + altitude) * cosLat * cosLon;
+        yq = (n + altitude) * cosLat * sinLon;
+        zq = ((1.0 - wgsEq) * n + altitude) * sinLat;
+
+        // Helmert transformation
+        xz = HELM_DX + HELM_SC * (       1.0 * xq  + HELM_ROTZ * yq - HELM_ROTY * zq);
+        yz = HELM_DY + HELM_SC * (-HELM_ROTZ * xq  +         1 * yq + HELM_ROTX * zq);
+        zz = HELM_DZ + HELM_SC * ( HELM_ROTY * xq  - HELM_ROTX * yq +       1.0 * zq);
+
+        // elliptic coordinates in Potsdam-Date
+        lambda = atan2(yz, xz);
+        r      = sqrt(xz * xz + yz * yz);
+        phi    = atan(zz / r);
+        sinPhi = sin(phi);
+        n      = ABES / sqrt(1.0 - besEq * sinPhi * sinPhi);
+
+        do
+        {
+            phiOld = phi;
+            phi    = atan((zz + besEq * n * sinPhi) / r);
+            sinPhi = sin(phi);
+            n      = ABES / sqrt(1 - besEq * sinPhi * sinPhi);
+        }
+        while (fabs(phiOld - phi) > 10E-10);
+
+        cosPhi = cos(phi);
+        h      = (xz / (cos(lambda) * cosPhi)) - n;
+
+        // Gauss-Krueger coordinates
+        strip  = round((lambda * 180.0 / M_PI) / 3.0);
+        l      = lambda - 3.0 * strip * M_PI / 180.0;
+        l2     = l * l;
+        t      = sinPhi / cosPhi;
+        eta    = besEst * cosPhi;
+        eta2   = eta * eta;
+        c2     = cosPhi * cosPhi;
+        c3     = c2 * cosPhi;
+        c5     = c3 * c2;
+        a1     = n * cosPhi;
+        a2     = (1.0 /   2.0) * t * n * c2;
+        a3     = (1.0 /   6.0) * n * c3 * (1.0 - t * t + eta2);
+        a4     = (1.0 /  24.0) * n * sinPhi * c3 * (5.0 - t * t + 9.0 * eta2 +
+                 4.0 * eta2 * eta2);
+        a5     = (1.0 / 120.0) * n * c5 * (5.0 - 18.0 * t * t + t * t * t * t +
+                 14.0 * eta2 - 58.0 * eta2 * t * t + 13.0 * eta2 * eta2 -
+                 64.0 * eta2 * eta2 * t * t);
+
+        multipleAngleSin(sinPhi, cosPhi, &sin2, &sin4, &sin6, &sin8);
+        gb     = (gkAlpha * phi - gkBeta * sin2 + gkGamma * sin4 - gkDelta * sin6) * besCbess;
+
+        posGk[i].northing = (gb + a2 * l2 + a4 * l2 * l2) * 1000.0;
+        posGk[i].easting  = (1000000.0 * strip + 500000.0 +
+                             l * (a1 + a3 * l2 + a5 * l2 * l2)) * 1000.0;
+        posGk[i].altitude = (int)(h * 1000.0);
+        posGk[i].heading  = posWgs84[i].heading;
+    }
+}
+
+void PositionTool::gkToWgs84(position_gk_data *posGk, position_wgs84_data *posWgs84, int num)
+{
+    int     i;
+    double  northing, easting;
+    double  sinPhi, cosPhi;
+    double  sinLambda, cosLambda;
+    double  sinLat;
+    double  n, r;
+    double  xz, yz, zz;
+    double  xq, yq, zq;
+    double  lon, lat, latOld;
+    double  y, y2, l0;
+    double  sigma, bf;
+    double  s, c, t;
+    double  nf, mf, eta2;
+    double  sin2, sin4, sin6, sin8;
+    double  b1, b2, b3, b4, b5;
+    double  phi, lambda, h;
+
+    for (i = 0; i < num; i++)
+    {
+        // unit m
+        northing = posGk[i].northing / 1000.0;
+        easting  = posGk[i].easting / 1000.0;
+        h        = posGk[i].altitude / 1000.0;
+
+        // meridian of the closest strip in degree, the same as the search of gkToWgs84()
+        l0 = floor((easting - 500000.0) * 3.0e-6 + 0.5);
+        if (l0 < 0.0)
+        {
+            l0 = 0.0;
+        }
+        y  = easting - 500000.0 - 1000000.0 * l0 / 3.0;
+        y2 = y * y;
+        l0 = l0 * M_PI / 180.0;
+
+        // footpoint latitude
+        sigma = northing / gkGrd;
+        multipleAngleSin(sin(sigma), cos(sigma), &sin2, &sin4, &sin6, &sin8);
+        bf    = sigma + gkBf2 * sin2 + gkBf4 * sin4 + gkBf6 * sin6;
+
+        s     = sin(bf);
+        c     = cos(bf);
+        t     = s / c;
+        nf    = ABES / sqrt(1.0 - besEq * s * s);
+        // gkToWgs84() computes pow(.., 3/2) with the integer exponent 1
+        mf    = (ABES * (1.0 - besEq)) / (1.0 - besEq * s * s);
+        eta2  = besEst * besEst * c * c;
+
+        b1    =  1.0 / (nf * c);
+        b2    = -t / (2.0 * mf * nf);
+        b3    = -(1.0 + 2.0 * t * t + eta2) / (6.0 * nf * nf * nf * c);
+        b4    =  (t / (24.0 * mf * nf * nf * nf)) * (5.0 + 3.0 * t * t + eta2 -
+                                                     9.0 * eta2 * t * t - 4.0 * eta2 * eta2);
+        b5    =  (1.0 / (120.0 * nf * nf * nf * nf * nf * c)) * (28.0 * t * t + 24.0 * t * t * t * t +
+                                                     6.0 * eta2 + 8.0 * eta2 * t * t);
+
+        phi    = bf + b2 * y2 + b4 * y2 * y2;
+        lambda = y * (b1 + b3 * y2 + b5 * y2 * y2) + l0;
+
+        // geocentric cartesian coordinates in Potsdam-Date
+        sinPhi    = sin(phi);
+        cosPhi    = cos(phi);
+        sinLambda = sin(lambda);
+        cosLambda = cos(lambda);
+        n         = ABES / sqrt(1.0 - besEq * sinPhi * sinPhi);
+        xz        = (n + h) * cosPhi * cosLambda - HELM_DX;
+        yz        = (n + h) * cosPhi * sinLambda - HELM_DY;
+        zz        = ((1.0 - besEq) * n + h) * sinPhi - HELM_DZ;
+
+        // inverse helmert transformation
+        xq = (       1.0 * xz - HELM_ROTZ * yz + HELM_ROTY * zz) / HELM_SC;
+        yq = ( HELM_ROTZ * xz +       1.0 * yz - HELM_ROTX * zz) / HELM_SC;
+        zq = (-HELM_ROTY * xz + HELM_ROTX * yz +       1.0 * zz) / HELM_SC;
+
+        // elliptic coordinates in wgs84 ellipsoid
+        lon    = atan2(yq, xq);
+        r      = sqrt(xq * xq + yq * yq);
+        lat    = atan(zq / r);
+        sinLat = sin(lat);
+        n      = AWGS / sqrt(1.0 - wgsEq * sinLat * sinLat);
+
+        do
+        {
+            latOld = lat;
+            lat    = atan((zq + wgsEq * n * sinLat) / r);
+            sinLat = sin(lat);
+            n      = AWGS / sqrt(1.0 - wgsEq * sinLat * sinLat);
+        }
+        while (fabs(latOld - lat) > 10E-10);
+
+        posWgs84[i].latitude  = lat;
+        posWgs84[i].longitude = lon;
+        posWgs84[i].altitude  = (int)rint(((xq / (cos(lat) * cos(lon))) - n) * 1000.0);
+        posWgs84[i].heading   = posGk[i].heading;
+    }
+}
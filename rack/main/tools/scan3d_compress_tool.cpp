@@ -33,6 +33,7 @@
 //----- COMPR_S1_REDUCE_BYTES_222110
 //----- COMPR_S1_REDUCE_BYTES_RESORT
 //----- COMPR_S1_DELTA_RLE
+//----- COMPR_S1_RANGE_PRED
 //----- COMPR_S1_REMOVE_INVALID
 //----- COMPR_S2_NONE
 //----- COMPR_S2_LZSS
@@ -55,6 +56,9 @@
 
 #include <math.h>
 #include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
 
 
 Scan3dCompressTool::Scan3dCompressTool() {
@@ -75,7 +79,8 @@ Scan3dCompressTool::~Scan3dCompressTool() {
 //----- ----------------------------------------------------------------------------------------------------
 //----- main compression function
 //----- ----------------------------------------------------------------------------------------------------
-uint32_t Scan3dCompressTool::Compress(scan3d_data *s3d_in_out, uint32_t flags_s1, uint32_t flags_s2, uint32_t flags_s3) {
+uint32_t Scan3dCompressTool::Compress(scan3d_data *s3d_in_out, uint32_t flags_s1, uint32_t flags_s2, uint32_t flags_s3,
+                                      int threads) {
     // return if no compression needed
     if ((flags_s1 == COMPR_S1_NONE) && (flags_s2 == COMPR_S2_NONE)
         && (flags_s3 == COMPR_S3_NONE))
@@ -97,6 +102,10 @@ uint32_t Scan3dCompressTool::Compress(scan3d_data *s3d_in_out, uint32_t flags_s1
 
     input = s3d_buf;
 
+    //----- range prediction needs the complete range image grid
+    if ((flags_s1 & 0x000000FF) == COMPR_S1_RANGE_PRED)
+        flags_s1 &= ~COMPR_S1_REMOVE_INVALID;
+
     //----- prepare output stream
     compr_bitStream  outStream1;                     //----- output stream of step 1
     outStream1.data  = pOut;
@@ -141,6 +150,15 @@ uint32_t Scan3dCompressTool::Compress(scan3d_data *s3d_in_out, uint32_t flags_s1
         compr_step1_searchMinMaxValues(nPoints);
         compr_step1_delta_rle(&outStream1, s3d_in_out->pointNum);
         break;
+    case COMPR_S1_RANGE_PRED:
+        if (compr_step1_range_pred(&outStream1, nPoints, lenIn, (flags_s1>>8) & 0xFFFF, threads) > 0)
+            break;
+        //----- coded data does not fit into the input buffer, store points uncompressed
+        flags_s1 = COMPR_S1_NONE;
+        outStream1.aByte = 2; outStream1.aBit = 0;
+        compr_Tool.compr_writeByteStream(&outStream1, flags_s1, sizeof(flags_s1));
+        outStream1.aByte = 14;
+        // fall through
     case COMPR_S1_NONE:
         for (uint32_t i=0; i<nPoints; i++) {
             compr_Tool.compr_writeByteStream(&outStream1, input[i].x, 4);
@@ -465,6 +483,319 @@ uint32_t Scan3dCompressTool::compr_step1_remove_invalid(uint32_t nPoints) {
     return iOut;
 }
 
+//----- ----------------------------------------------------------------------------------------------------
+//----- range prediction (COMPR_S1_RANGE_PRED)
+//----- The points are expected in range image order (scanPointNum points per scanline).
+//----- x, y and z are predicted from the left, upper and upper left neighbour (MED predictor),
+//----- type, segment and intensity from the left neighbour. The residuals are zigzag and varint
+//----- coded field by field and every block is entropy coded with a static rANS coder.
+//----- Blocks of scanlines don't reference each other, so they can be (de)coded independently.
+//-----
+//----- header:   width (4), block lines (4), number of blocks (4)
+//----- block:    raw length (4), coded length (4, 0 = stored), [rANS table + rANS data] or raw data
+//----- ----------------------------------------------------------------------------------------------------
+
+static inline int32_t range_pred_med(int32_t a, int32_t b, int32_t c) {
+    int32_t mx = (a > b) ? a : b;
+    int32_t mn = (a > b) ? b : a;
+    if (c >= mx) return mn;
+    if (c <= mn) return mx;
+    return (int32_t)((uint32_t)a + (uint32_t)b - (uint32_t)c);
+}
+
+static inline uint8_t* range_pred_putVarint(uint8_t *p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+//----- reads one varint below pEnd, sets *err if it is truncated or longer than 5 bytes
+static inline uint32_t range_pred_getVarint(uint8_t **pp, uint8_t *pEnd, int *err) {
+    uint8_t  *p = *pp;
+    uint32_t v  = 0;
+    uint32_t sh = 0;
+    while ((p < pEnd) && (sh < 35)) {
+        v  |= (uint32_t)(*p & 0x7F) << sh;
+        sh += 7;
+        if (!(*p++ & 0x80)) {
+            *pp = p;
+            return v;
+        }
+    }
+    *pp  = p;
+    *err = 1;
+    return 0;
+}
+
+static inline uint32_t range_pred_zigzag(uint32_t r) {
+    return (r << 1) ^ (uint32_t)((int32_t)r >> 31);
+}
+
+static inline uint32_t range_pred_unzigzag(uint32_t z) {
+    return (z >> 1) ^ (uint32_t)-(int32_t)(z & 1);
+}
+
+static inline void range_pred_put32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >>  8);
+    p[3] = (uint8_t)v;
+}
+
+static inline uint32_t range_pred_get32(uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void *range_pred_run(void *arg) {
+    rangePredJob *job = (rangePredJob*)arg;
+    job->tool->compr_step1_range_pred_blocks(job);
+    return NULL;
+}
+
+//----- Codes nPoints points block by block, returns 0 if the result doesn't fit into maxSize bytes.
+//----- The blocks are split into groups of threads, the calling thread codes the first group
+//----- directly into the output stream, the other groups are appended after the join.
+uint32_t Scan3dCompressTool::compr_step1_range_pred(compr_bitStream *out, uint32_t nPoints, uint32_t maxSize, uint32_t blockLines,
+                                                    int threads) {
+    //----- the varint bytes of a block use the first 2/5 of buf1, the rANS coder the rest
+    uint32_t maxBlockBytes = (uint32_t)(COMPR_MAX_INPUT_SIZE / 5) * 2;
+    uint32_t width = (inputHeader->scanPointNum > 0) ? inputHeader->scanPointNum : nPoints;
+    if ((width > nPoints) || (width == 0)) width = (nPoints > 0) ? nPoints : 1;
+    if (blockLines == 0) blockLines = RANGE_PRED_BLOCK_LINES;
+    if (width * RANGE_PRED_MAX_POINT_BYTES > maxBlockBytes)
+        width = maxBlockBytes / RANGE_PRED_MAX_POINT_BYTES;
+    if (width * blockLines * RANGE_PRED_MAX_POINT_BYTES > maxBlockBytes)
+        blockLines = maxBlockBytes / (width * RANGE_PRED_MAX_POINT_BYTES);
+
+    uint32_t blockPoints = width * blockLines;
+    uint32_t blockNum    = (nPoints + blockPoints - 1) / blockPoints;
+    uint8_t  *p          = out->data + out->aByte;
+    uint8_t  *pEnd       = out->data + maxSize;
+    uint32_t groupBlocks, outSize, workSize;
+    int      i, ret;
+
+    rangePredJob job[SCAN3D_COMPRESS_THREAD_MAX];
+    pthread_t    thread[SCAN3D_COMPRESS_THREAD_MAX];
+    int          started[SCAN3D_COMPRESS_THREAD_MAX];
+
+    if (p + 12 > pEnd) return 0;
+    range_pred_put32(p,     width);
+    range_pred_put32(p + 4, blockLines);
+    range_pred_put32(p + 8, blockNum);
+    p += 12;
+
+    if (threads > SCAN3D_COMPRESS_THREAD_MAX) threads = SCAN3D_COMPRESS_THREAD_MAX;
+    if (threads > (int)blockNum) threads = (int)blockNum;
+    if (threads < 1) threads = 1;
+
+    //----- the additional threads code into their own buffers (all stored in the worst case)
+    groupBlocks = (blockNum + threads - 1) / threads;
+    outSize     = groupBlocks * (blockPoints * RANGE_PRED_MAX_POINT_BYTES + 8);
+    workSize    = blockPoints * RANGE_PRED_MAX_POINT_BYTES / 2 * 5 + 8;
+    for (i = 0; i < threads; i++) {
+        job[i].tool        = this;
+        job[i].nPoints     = nPoints;
+        job[i].width       = width;
+        job[i].blockPoints = blockPoints;
+        job[i].out         = NULL;
+        if (i == 0) continue;
+        job[i].out = (uint8_t*)malloc(outSize + workSize);
+        if (job[i].out == NULL) {
+            //----- no memory, code all blocks in the calling thread
+            while (--i > 0) free(job[i].out);
+            threads = 1;
+            break;
+        }
+        job[i].outSize  = outSize;
+        job[i].work     = job[i].out + outSize;
+        job[i].workSize = workSize;
+    }
+    job[0].out      = p;
+    job[0].outSize  = (uint32_t)(pEnd - p);
+    job[0].work     = pbuf1;
+    job[0].workSize = COMPR_MAX_INPUT_SIZE;
+
+    for (i = 0; i < threads; i++) {
+        job[i].blockFirst = blockNum * i / threads;
+        job[i].blockLast  = blockNum * (i + 1) / threads;
+        started[i]        = 0;
+    }
+    for (i = 1; i < threads; i++)
+        started[i] = !pthread_create(&thread[i], NULL, range_pred_run, &job[i]);
+
+    range_pred_run(&job[0]);
+
+    ret = job[0].ret;
+    p  += job[0].len;
+    for (i = 1; i < threads; i++) {
+        if (started[i]) pthread_join(thread[i], NULL);
+        else            range_pred_run(&job[i]);
+        if (ret == 0) {
+            if ((job[i].ret == 0) && (p + job[i].len <= pEnd)) {
+                memcpy(p, job[i].out, job[i].len);
+                p += job[i].len;
+            } else ret = -ENOSPC;
+        }
+        free(job[i].out);
+    }
+    if (ret) return 0;
+
+    out->aByte = (uint32_t)(p - out->data);
+    out->aBit  = 0;
+    return out->aByte;
+}
+
+//----- Codes the blocks of a job into job->out
+void Scan3dCompressTool::compr_step1_range_pred_blocks(rangePredJob *job) {
+    uint8_t  *p    = job->out;
+    uint8_t  *pEnd = job->out + job->outSize;
+    uint32_t b, first, n, rawLen, codedLen;
+
+    job->len = 0;
+    job->ret = -ENOSPC;
+    for (b = job->blockFirst; b < job->blockLast; b++) {
+        first  = b * job->blockPoints;
+        n      = ((job->nPoints - first) < job->blockPoints) ? (job->nPoints - first) : job->blockPoints;
+        rawLen = compr_step1_range_pred_block(job->work, first, n, job->width);
+        if (p + 8 > pEnd) return;
+        codedLen = compr_step1_rans(job->work, rawLen, p + 8, (uint32_t)(pEnd - p) - 8,
+                                    job->work + job->workSize);
+        range_pred_put32(p,     rawLen);
+        range_pred_put32(p + 4, codedLen);
+        p += 8;
+        if (codedLen == 0) {
+            //----- entropy coding doesn't pay off, store varint bytes
+            if (p + rawLen > pEnd) return;
+            memcpy(p, job->work, rawLen);
+            p += rawLen;
+        } else p += codedLen;
+    }
+    job->len = (uint32_t)(p - job->out);
+    job->ret = 0;
+}
+
+//----- Writes the zigzag/varint coded prediction residuals of one block, returns the number of bytes
+uint32_t Scan3dCompressTool::compr_step1_range_pred_block(uint8_t *out, uint32_t first, uint32_t n, uint32_t width) {
+    uint8_t  *p = out;
+    uint32_t f, k, col;
+    int32_t  v, pred;
+    int32_t  *a;
+
+    //----- x, y and z (int32 at offset 0, 1, 2 of scanPoint)
+    for (f = 0; f < 3; f++) {
+        col = 0;
+        for (k = 0; k < n; k++) {
+            a = &((int32_t*)&input[first + k])[f];
+            v = *a;
+            if (k >= width) {
+                pred = *(int32_t*)((uint8_t*)a - width * sizeof(scanPoint));
+                if (col > 0)
+                    pred = range_pred_med(*(int32_t*)((uint8_t*)a - sizeof(scanPoint)), pred,
+                                          *(int32_t*)((uint8_t*)a - (width + 1) * sizeof(scanPoint)));
+            } else
+                pred = (k > 0) ? *(int32_t*)((uint8_t*)a - sizeof(scanPoint)) : 0;
+            p = range_pred_putVarint(p, range_pred_zigzag((uint32_t)v - (uint32_t)pred));
+            if (++col == width) col = 0;
+        }
+    }
+    //----- type, segment and intensity
+    pred = 0;
+    for (k = 0; k < n; k++) {
+        v = input[first + k].t;
+        p = range_pred_putVarint(p, range_pred_zigzag((uint32_t)v - (uint32_t)pred));
+        pred = v;
+    }
+    pred = 0;
+    for (k = 0; k < n; k++) {
+        v = input[first + k].s;
+        p = range_pred_putVarint(p, range_pred_zigzag((uint32_t)v - (uint32_t)pred));
+        pred = v;
+    }
+    pred = 0;
+    for (k = 0; k < n; k++) {
+        v = input[first + k].i;
+        p = range_pred_putVarint(p, range_pred_zigzag((uint32_t)v - (uint32_t)pred));
+        pred = v;
+    }
+    return (uint32_t)(p - out);
+}
+
+//----- Static order-0 rANS coder. Writes the frequency table and the coded bytes to out,
+//----- returns 0 if the result is not smaller than the input or doesn't fit into maxSize bytes.
+//----- The bytes are coded backwards into the memory below workEnd (worst case 12 bit per byte).
+uint32_t Scan3dCompressTool::compr_step1_rans(uint8_t *in, uint32_t size, uint8_t *out, uint32_t maxSize, uint8_t *workEnd) {
+    uint32_t i, s, sum, max, symNum;
+    uint32_t count[256];
+    uint32_t rans_freq[256];
+    uint32_t rans_cum[257];
+
+    if (size == 0) return 0;
+
+    //----- count and normalise symbol frequencies to RANS_SCALE
+    memset(count, 0, sizeof(count));
+    for (i = 0; i < size; i++) count[in[i]]++;
+    sum    = 0;
+    symNum = 0;
+    for (s = 0; s < 256; s++) {
+        rans_freq[s] = 0;
+        if (count[s]) {
+            rans_freq[s] = (uint32_t)(((uint64_t)count[s] * RANS_SCALE) / size);
+            if (rans_freq[s] == 0) rans_freq[s] = 1;
+            sum += rans_freq[s];
+            symNum++;
+        }
+    }
+    while (sum != RANS_SCALE) {
+        max = 0;
+        for (s = 1; s < 256; s++)
+            if (rans_freq[s] > rans_freq[max]) max = s;
+        if (sum > RANS_SCALE) { rans_freq[max]--; sum--; }
+        else                  { rans_freq[max]++; sum++; }
+    }
+    rans_cum[0] = 0;
+    for (s = 0; s < 256; s++) rans_cum[s + 1] = rans_cum[s] + rans_freq[s];
+
+    //----- encode backwards
+    uint8_t  *pEnd = workEnd;
+    uint8_t  *p    = pEnd;
+    uint32_t x     = RANS_L;
+    uint32_t freq, xMax;
+    for (i = size; i > 0; i--) {
+        s    = in[i - 1];
+        freq = rans_freq[s];
+        xMax = ((RANS_L >> RANS_SCALE_BITS) << 8) * freq;
+        while (x >= xMax) {
+            *--p = (uint8_t)x;
+            x >>= 8;
+        }
+        x = ((x / freq) << RANS_SCALE_BITS) + (x % freq) + rans_cum[s];
+    }
+    p -= 4;
+    p[0] = (uint8_t)x;
+    p[1] = (uint8_t)(x >> 8);
+    p[2] = (uint8_t)(x >> 16);
+    p[3] = (uint8_t)(x >> 24);
+
+    //----- table: number of symbols (2), per symbol: symbol (1), frequency (2)
+    uint32_t codedLen = 2 + symNum * 3 + (uint32_t)(pEnd - p);
+    if ((codedLen >= size) || (codedLen > maxSize)) return 0;
+    uint8_t *t = out;
+    *t++ = (uint8_t)(symNum >> 8);
+    *t++ = (uint8_t)symNum;
+    for (s = 0; s < 256; s++) {
+        if (rans_freq[s]) {
+            *t++ = (uint8_t)s;
+            *t++ = (uint8_t)(rans_freq[s] >> 8);
+            *t++ = (uint8_t)rans_freq[s];
+        }
+    }
+    memcpy(t, p, pEnd - p);
+    return codedLen;
+}
+
 #ifdef COMPR_UNCOMPR
 //----- ----------------------------------------------------------------------------------------------------
 //----- main decompression function
@@ -508,6 +839,10 @@ uint32_t Scan3dCompressTool::Decompress(scan3d_data *s3d_in_out) {
     uint32_t lenIn      = compr_Tool.compr_readByteStream(&inStream1, sizeof(lenIn));
     uint32_t aLen       = 0;
     uint32_t nPoints    = lenOut/20;
+    if ((lenIn > sizeof(s3d_buf1)) || (nPoints > SCAN3D_POINT_MAX)) {
+        GDOS_ERROR("Invalid length of compressed data\n");
+        return 1;
+    }
     memcpy(pIn, pOut, lenIn);
     inStream1.data     = pIn;
 
@@ -537,6 +872,12 @@ uint32_t Scan3dCompressTool::Decompress(scan3d_data *s3d_in_out) {
     case COMPR_S1_DELTA_RLE:
         uncompr_step1_delta_rle(&inStream1, s3d_in_out->pointNum);
         break;
+    case COMPR_S1_RANGE_PRED:
+        if (uncompr_step1_range_pred(&inStream1, nPoints, lenIn) == 0) {
+            GDOS_ERROR("Corrupt range prediction data\n");
+            return 1;
+        }
+        break;
     case COMPR_S1_NONE:
         for (uint32_t i=0; i<lenOut/20; i++) {
             output[i].x = compr_Tool.compr_readByteStream(&inStream1, 4);
@@ -754,6 +1095,132 @@ uint32_t Scan3dCompressTool::uncompr_step1_remove_invalid(uint32_t nIn, uint32_t
     return nOut;
 }
 
+//----- Expand data that was compressed with compr_step1_range_pred(), size is the length of the
+//----- step 1 data. Returns 0 if a block is corrupt or doesn't fit into size bytes
+uint32_t Scan3dCompressTool::uncompr_step1_range_pred(compr_bitStream *in, uint32_t nPoints, uint32_t size) {
+    uint8_t  *p    = in->data + in->aByte;
+    uint8_t  *pEnd = in->data + size;
+    uint32_t width, blockLines, blockPoints, first, n, rawLen, codedLen;
+
+    if (size < in->aByte + 12) return 0;
+    width      = range_pred_get32(p);
+    blockLines = range_pred_get32(p + 4);
+    p += 12;
+    if ((width == 0) || (width > SCAN3D_POINT_MAX) || (blockLines == 0) ||
+        (blockLines > SCAN3D_POINT_MAX / width))
+        return 0;
+    blockPoints = width * blockLines;
+
+    for (first = 0; first < nPoints; first += blockPoints) {
+        n = ((nPoints - first) < blockPoints) ? (nPoints - first) : blockPoints;
+        if (pEnd - p < 8) return 0;
+        rawLen   = range_pred_get32(p);
+        codedLen = range_pred_get32(p + 4);
+        p += 8;
+        if (codedLen == 0) {
+            if ((uint32_t)(pEnd - p) < rawLen) return 0;
+            if (uncompr_step1_range_pred_block(p, rawLen, first, n, width) == 0) return 0;
+            p += rawLen;
+        } else {
+            if (((uint32_t)(pEnd - p) < codedLen) || (rawLen > COMPR_MAX_INPUT_SIZE)) return 0;
+            if (uncompr_step1_rans(p, codedLen, pbuf1, rawLen) == 0) return 0;
+            if (uncompr_step1_range_pred_block(pbuf1, rawLen, first, n, width) == 0) return 0;
+            p += codedLen;
+        }
+    }
+    in->aByte = (uint32_t)(p - in->data);
+    return nPoints*20;
+}
+
+//----- Reverses compr_step1_range_pred_block(), returns n or 0 if the size bytes are corrupt
+uint32_t Scan3dCompressTool::uncompr_step1_range_pred_block(uint8_t *in, uint32_t size, uint32_t first, uint32_t n, uint32_t width) {
+    uint8_t  *p    = in;
+    uint8_t  *pEnd = in + size;
+    uint32_t f, k, col;
+    int32_t  pred;
+    int32_t  *a;
+    int      err = 0;
+
+    //----- x, y and z
+    for (f = 0; f < 3; f++) {
+        col = 0;
+        for (k = 0; k < n; k++) {
+            a = &((int32_t*)&output[first + k])[f];
+            if (k >= width) {
+                pred = *(int32_t*)((uint8_t*)a - width * sizeof(scanPoint));
+                if (col > 0)
+                    pred = range_pred_med(*(int32_t*)((uint8_t*)a - sizeof(scanPoint)), pred,
+                                          *(int32_t*)((uint8_t*)a - (width + 1) * sizeof(scanPoint)));
+            } else
+                pred = (k > 0) ? *(int32_t*)((uint8_t*)a - sizeof(scanPoint)) : 0;
+            *a = (int32_t)((uint32_t)pred + range_pred_unzigzag(range_pred_getVarint(&p, pEnd, &err)));
+            if (++col == width) col = 0;
+        }
+    }
+    //----- type, segment and intensity
+    pred = 0;
+    for (k = 0; k < n; k++) {
+        pred = (int32_t)((uint32_t)pred + range_pred_unzigzag(range_pred_getVarint(&p, pEnd, &err)));
+        output[first + k].t = pred;
+    }
+    pred = 0;
+    for (k = 0; k < n; k++) {
+        pred = (int32_t)((uint32_t)pred + range_pred_unzigzag(range_pred_getVarint(&p, pEnd, &err)));
+        output[first + k].s = (int16_t)pred;
+    }
+    pred = 0;
+    for (k = 0; k < n; k++) {
+        pred = (int32_t)((uint32_t)pred + range_pred_unzigzag(range_pred_getVarint(&p, pEnd, &err)));
+        output[first + k].i = (int16_t)pred;
+    }
+    return (err || (p != pEnd)) ? 0 : n;
+}
+
+//----- Expand data that was coded with compr_step1_rans() from inSize to size bytes,
+//----- symbols are looked up in a table of RANS_SCALE slots. Returns 0 if the frequency
+//----- table is corrupt or the coded bytes don't fit into inSize bytes
+uint32_t Scan3dCompressTool::uncompr_step1_rans(uint8_t *in, uint32_t inSize, uint8_t *out, uint32_t size) {
+    uint32_t i, j, s, slot, freq, sum;
+    uint32_t symNum;
+    uint8_t  *p    = in + 2;
+    uint8_t  *pEnd = in + inSize;
+
+    if (inSize < 2) return 0;
+    symNum = ((uint32_t)in[0] << 8) | in[1];
+    if ((symNum == 0) || (symNum > 256) || (inSize < 2 + symNum * 3 + 4)) return 0;
+
+    memset(rans_freq, 0, sizeof(rans_freq));
+    sum = 0;
+    for (i = 0; i < symNum; i++) {
+        s    = p[0];
+        freq = ((uint32_t)p[1] << 8) | p[2];
+        if ((freq == 0) || rans_freq[s]) return 0;
+        rans_freq[s] = freq;
+        sum += freq;
+        p += 3;
+    }
+    if (sum != RANS_SCALE) return 0;
+    rans_cum[0] = 0;
+    for (s = 0; s < 256; s++) {
+        rans_cum[s + 1] = rans_cum[s] + rans_freq[s];
+        for (j = rans_cum[s]; j < rans_cum[s + 1]; j++) rans_cum2sym[j] = (uint8_t)s;
+    }
+
+    uint32_t x = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    p += 4;
+    for (i = 0; i < size; i++) {
+        slot   = x & (RANS_SCALE - 1);
+        s      = rans_cum2sym[slot];
+        out[i] = (uint8_t)s;
+        x = rans_freq[s] * (x >> RANS_SCALE_BITS) + slot - rans_cum[s];
+        while (x < RANS_L) {
+            if (p >= pEnd) return 0;
+            x = (x << 8) | *p++;
+        }
+    }
+    return size;
+}
+
 #endif
 /*
 //----- header of step 1
@@ -0,0 +1,308 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <main/serial_framer.h>
+
+SerialFramer::SerialFramer()
+{
+    port          = NULL;
+    format        = NULL;
+    buf           = NULL;
+    bufSize       = 0;
+    head          = 0;
+    tail          = 0;
+    frameLen      = 0;
+    chunkNum      = 0;
+    skipNum       = 0;
+    checkErrorNum = 0;
+}
+
+SerialFramer::~SerialFramer()
+{
+    cleanup();
+}
+
+int SerialFramer::init(SerialPort *port, serial_frame_format *format, int bufSize)
+{
+    if (!port || !format || (format->syncLen > SERIAL_FRAME_SYNC_MAX) ||
+        (format->maxLen <= 0) || (bufSize < 2 * format->maxLen))
+    {
+        return -EINVAL;
+    }
+
+    cleanup();
+
+    buf = (uint8_t *)malloc(bufSize);
+    if (!buf)
+    {
+        return -ENOMEM;
+    }
+
+    this->port    = port;
+    this->format  = format;
+    this->bufSize = bufSize;
+
+    head          = 0;
+    tail          = 0;
+    frameLen      = 0;
+    chunkNum      = 0;
+    skipNum       = 0;
+    checkErrorNum = 0;
+
+    return 0;
+}
+
+void SerialFramer::cleanup(void)
+{
+    if (buf)
+    {
+        free(buf);
+        buf = NULL;
+    }
+    port    = NULL;
+    format  = NULL;
+    bufSize = 0;
+}
+
+// compares the sync bytes that are received so far
+int SerialFramer::syncMatch(const uint8_t *data, int dataLen)
+{
+    int i;
+
+    for (i = 0; (i < format->syncLen) && (i < dataLen); i++)
+    {
+        if ((data[i] ^ format->sync[i]) & format->syncMask[i])
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// frame length, 0 if more bytes are needed, negative if the head is invalid
+int SerialFramer::getLength(const uint8_t *data, int dataLen)
+{
+    int field, end, i;
+
+    if (dataLen < format->syncLen)
+    {
+        return 0;
+    }
+
+    if (format->getLength)
+    {
+        return format->getLength(data, dataLen, format->arg);
+    }
+
+    if (format->lenOffset >= 0)
+    {
+        if (dataLen < format->lenOffset + format->lenSize)
+        {
+            return 0;
+        }
+
+        if (format->lenSize == 2)
+        {
+            if (format->lenBigEndian)
+            {
+                field = (data[format->lenOffset] << 8) | data[format->lenOffset + 1];
+            }
+            else
+            {
+                field = data[format->lenOffset] | (data[format->lenOffset + 1] << 8);
+            }
+        }
+        else
+        {
+            field = data[format->lenOffset];
+        }
+
+        return field * format->lenScale + format->lenAdd;
+    }
+
+    if (format->terminator >= 0)
+    {
+        end = (dataLen < format->maxLen) ? dataLen : format->maxLen;
+
+        for (i = format->syncLen; i < end; i++)
+        {
+            if (data[i] == format->terminator)
+            {
+                return i + 1;
+            }
+        }
+        return (dataLen >= format->maxLen) ? -1 : 0;
+    }
+
+    return format->frameLen;
+}
+
+// receive time of the chunk with the byte at pos
+rack_time_t SerialFramer::getTime(int pos)
+{
+    int i;
+
+    for (i = chunkNum - 1; i > 0; i--)
+    {
+        if (chunkPos[i] <= pos)
+        {
+            break;
+        }
+    }
+    return chunkNum ? chunkTime[i] : 0;
+}
+
+int SerialFramer::fill(void)
+{
+    rack_time_t time;
+    int         i, ret;
+
+    if (head == tail)
+    {
+        head     = 0;
+        tail     = 0;
+        chunkNum = 0;
+    }
+
+    // the unparsed bytes are moved to the start of the buffer
+    if ((tail == bufSize) || (head > bufSize / 2))
+    {
+        if (head == 0)
+        {
+            return -ENOBUFS;
+        }
+
+        memmove(buf, &buf[head], tail - head);
+
+        for (i = 0; i < chunkNum; i++)
+        {
+            chunkPos[i] = (chunkPos[i] > head) ? chunkPos[i] - head : 0;
+        }
+        tail -= head;
+        head  = 0;
+    }
+
+    // chunks in front of the unparsed bytes are not needed any more
+    for (i = 0; (i + 1 < chunkNum) && (chunkPos[i + 1] <= head); i++);
+
+    if ((i == 0) && (chunkNum == SERIAL_FRAMER_CHUNK_MAX))
+    {
+        i = 1;
+    }
+    if (i > 0)
+    {
+        memmove(chunkPos, &chunkPos[i], (chunkNum - i) * sizeof(chunkPos[0]));
+        memmove(chunkTime, &chunkTime[i], (chunkNum - i) * sizeof(chunkTime[0]));
+        chunkNum -= i;
+    }
+
+    ret = port->recvChunk(&buf[tail], bufSize - tail, &time);
+    if (ret <= 0)
+    {
+        return ret ? ret : -ETIMEDOUT;
+    }
+
+    chunkPos[chunkNum]  = tail;
+    chunkTime[chunkNum] = time;
+    chunkNum++;
+    tail += ret;
+
+    return 0;
+}
+
+int SerialFramer::readFrame(uint8_t **pp_frame, rack_time_t *startTime,
+                            rack_time_t *endTime)
+{
+    int skipped = 0;
+    int avail, len, ret;
+
+    if (!buf)
+    {
+        return -EINVAL;
+    }
+
+    // release the last frame
+    head    += frameLen;
+    frameLen = 0;
+
+    while (1)
+    {
+        while ((avail = tail - head) > 0)
+        {
+            len = syncMatch(&buf[head], avail) ? getLength(&buf[head], avail) : -1;
+
+            if ((len > format->maxLen) || ((len > 0) && (len < format->syncLen)))
+            {
+                len = -1;
+            }
+
+            if (len >= 0)
+            {
+                if ((len == 0) || (avail < len))
+                {
+                    break;          // more bytes needed
+                }
+
+                if (!format->check || !format->check(&buf[head], len, format->arg))
+                {
+                    frameLen  = len;
+                    *pp_frame = &buf[head];
+
+                    if (startTime)
+                    {
+                        *startTime = getTime(head);
+                    }
+                    if (endTime)
+                    {
+                        *endTime = getTime(head + len - 1);
+                    }
+                    return len;
+                }
+
+                checkErrorNum++;
+            }
+
+            // no frame at this position
+            head++;
+            skipNum++;
+            if (++skipped > format->maxSkip)
+            {
+                return -ETIME;
+            }
+        }
+
+        ret = fill();
+        if (ret)
+        {
+            return ret;
+        }
+    }
+}
+
+int SerialFramer::clean(void)
+{
+    head     = 0;
+    tail     = 0;
+    frameLen = 0;
+    chunkNum = 0;
+
+    if (!port)
+    {
+        return -EINVAL;
+    }
+    return port->clean();
+}
@@ -177,6 +177,29 @@ int SerialPort::recv(void *data, int dataLen, rack_time_t *timestamp,
     return recv(data, dataLen, timestamp);
 }
 
+int SerialPort::recvChunk(void *data, int maxLen, rack_time_t *timestamp)
+{
+    int ret;
+    rtser_event_t rx_event;
+
+    // waits for the first byte, the event has its timestamp
+    ret = rt_dev_ioctl(fd, RTSER_RTIOC_WAIT_EVENT, &rx_event);
+    if (ret)
+        return ret;
+
+    if (rx_event.rx_pending < maxLen)
+        maxLen = rx_event.rx_pending > 0 ? rx_event.rx_pending : 1;
+
+    ret = rt_dev_read(fd, data, maxLen);
+    if (ret < 0)
+        return ret;
+
+    if (timestamp)
+        *timestamp = module->rackTime.fromNano(rx_event.rxpend_timestamp);
+
+    return ret;
+}
+
 int SerialPort::waitEvent(struct rtser_event *event)
 {
     return rt_dev_ioctl(fd, RTSER_RTIOC_WAIT_EVENT, event);
@@ -34,6 +34,18 @@ public class PositionProxy extends RackDataProxy
         RackProxy.MSG_POS_OFFSET + 6;
     public static final byte MSG_POSITION_POS_TO_UTM =
         RackProxy.MSG_POS_OFFSET + 7;    
+    public static final byte MSG_POSITION_WGS84_TO_POS_ARRAY =
+        RackProxy.MSG_POS_OFFSET + 8;
+    public static final byte MSG_POSITION_POS_TO_WGS84_ARRAY =
+        RackProxy.MSG_POS_OFFSET + 9;
+    public static final byte MSG_POSITION_GK_TO_POS_ARRAY =
+        RackProxy.MSG_POS_OFFSET + 10;
+    public static final byte MSG_POSITION_POS_TO_GK_ARRAY =
+        RackProxy.MSG_POS_OFFSET + 11;
+    public static final byte MSG_POSITION_UTM_TO_POS_ARRAY =
+        RackProxy.MSG_POS_OFFSET + 12;
+    public static final byte MSG_POSITION_POS_TO_UTM_ARRAY =
+        RackProxy.MSG_POS_OFFSET + 13;
     
     public static final byte MSG_POSITION_POS =
         RackProxy.MSG_NEG_OFFSET - 2;
@@ -43,6 +55,14 @@ public class PositionProxy extends RackDataProxy
         RackProxy.MSG_NEG_OFFSET - 5;
     public static final byte MSG_POSITION_UTM =
         RackProxy.MSG_NEG_OFFSET - 7;    
+    public static final byte MSG_POSITION_POS_ARRAY =
+        RackProxy.MSG_NEG_OFFSET - 8;
+    public static final byte MSG_POSITION_WGS84_ARRAY =
+        RackProxy.MSG_NEG_OFFSET - 9;
+    public static final byte MSG_POSITION_GK_ARRAY =
+        RackProxy.MSG_NEG_OFFSET - 11;
+    public static final byte MSG_POSITION_UTM_ARRAY =
+        RackProxy.MSG_NEG_OFFSET - 13;
 
     
     public PositionProxy(int system, int instance , TimsMbx replyMbx)
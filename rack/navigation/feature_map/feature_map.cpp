@@ -0,0 +1,696 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#include <math.h>
+
+#include "feature_map.h"
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "mapFile", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "filename of the DXF map to load", { 0 } },
+
+    { ARGOPT_OPT, "mapScaleFactor", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "map scale factor", { 1000 } },
+
+    { ARGOPT_OPT, "mapOffsetX", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "mapOffsetX for DXF maps in GK coordinates", { 0 } },
+
+    { ARGOPT_OPT, "mapOffsetY", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "mapOffsetY for DXF maps in GK coordinates", { 0 } },
+
+    { ARGOPT_OPT, "featureMax", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "maximum number of map features, default 100000", { 100000 } },
+
+    { ARGOPT_OPT, "periodTime", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "period time of the map data in ms, default 1000", { 1000 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+
+int  FeatureMap::moduleOn(void)
+{
+    // get dynamic module parameter
+    dataBufferPeriodTime = getInt32Param("periodTime");
+
+    GDOS_PRINT("Using DXF map with %i features\n", dxfMap->featureNum);
+
+    return RackDataModule::moduleOn();  // has to be last command in moduleOn();
+}
+
+void FeatureMap::moduleOff(void)
+{
+    RackDataModule::moduleOff();        // has to be first command in moduleOff();
+}
+
+int  FeatureMap::moduleLoop(void)
+{
+    feature_map_data    *p_data;
+    int                 i;
+
+    // get datapointer from rackdatabuffer
+    p_data = (feature_map_data *)getDataBufferWorkSpace();
+
+    p_data->recordingTime = rackTime.get();
+    p_data->pos.x         = 0;
+    p_data->pos.y         = 0;
+    p_data->pos.z         = 0;
+    p_data->pos.phi       = 0.0f;
+    p_data->pos.psi       = 0.0f;
+    p_data->pos.rho       = 0.0f;
+    p_data->featureNum    = 0;
+
+    mapMtx.lock(RACK_INFINITE);
+
+    for (i = 0; (i < dxfMap->featureNum) && (p_data->featureNum < FEATURE_MAP_FEATURE_MAX); i++)
+    {
+        if (isLayerActive(dxfMap->feature[i].layer))
+        {
+            featureToPoint(&dxfMap->feature[i], &p_data->feature[p_data->featureNum]);
+            publishIndex[p_data->featureNum] = i;
+            p_data->featureNum++;
+        }
+    }
+    publishNum = p_data->featureNum;
+
+    mapMtx.unlock();
+
+    putDataBufferWorkSpace(sizeof(feature_map_data) +
+                           p_data->featureNum * sizeof(feature_map_data_point));
+
+    sleepDataBufferPeriodTime();
+    return 0;
+}
+
+int  FeatureMap::moduleCommand(RackMessage *msgInfo)
+{
+    feature_map_filename    *p_filename;
+    feature_map_feature     *p_feature;
+    feature_map_layer_data  *p_layer;
+    feature_map_query       *p_query;
+    feature_map_nearest_data    nearestData;
+    int32_t                 layerList[FEATURE_MAP_LAYER_MAX];
+    int32_t                 layerListNum;
+    double                  nearestX, nearestY, nearestDistance;
+    int                     i, index, ret;
+
+    switch (msgInfo->getType())
+    {
+        case MSG_FEATURE_MAP_LOAD_MAP:
+            p_filename = FeatureMapFilename::parse(msgInfo);
+            p_filename->filename[sizeof(p_filename->filename) - 1] = 0;
+
+            mapMtx.lock(RACK_INFINITE);
+            ret = loadMap(p_filename->filename);
+            mapMtx.unlock();
+
+            cmdMbx.sendMsgReply(ret ? MSG_ERROR : MSG_OK, msgInfo);
+            break;
+
+        case MSG_FEATURE_MAP_SAVE_MAP:
+            p_filename = FeatureMapFilename::parse(msgInfo);
+            p_filename->filename[sizeof(p_filename->filename) - 1] = 0;
+
+            mapMtx.lock(RACK_INFINITE);
+            ret = saveMap(p_filename->filename);
+            mapMtx.unlock();
+
+            cmdMbx.sendMsgReply(ret ? MSG_ERROR : MSG_OK, msgInfo);
+            break;
+
+        case MSG_FEATURE_MAP_ADD_LINE:
+            p_feature = FeatureMapFeature::parse(msgInfo);
+
+            mapMtx.lock(RACK_INFINITE);
+            ret = addFeature(&p_feature->mapFeature);
+            mapMtx.unlock();
+
+            cmdMbx.sendMsgReply(ret ? MSG_ERROR : MSG_OK, msgInfo);
+            break;
+
+        // an index out of range is no error, FeatureMapGui sends it
+        // if there is no feature next to the mouse
+        case MSG_FEATURE_MAP_DELETE_LINE:
+            p_feature = FeatureMapFeature::parse(msgInfo);
+
+            mapMtx.lock(RACK_INFINITE);
+            index = getMapIndex(p_feature->featureNumTemp);
+            if (index >= 0)
+            {
+                deleteFeature(index);
+            }
+            mapMtx.unlock();
+
+            cmdMbx.sendMsgReply(MSG_OK, msgInfo);
+            break;
+
+        case MSG_FEATURE_MAP_DISPLACE_LINE:
+            p_feature = FeatureMapFeature::parse(msgInfo);
+
+            ret = 0;
+            mapMtx.lock(RACK_INFINITE);
+            index = getMapIndex(p_feature->featureNumTemp);
+            if (index >= 0)
+            {
+                ret = displaceFeature(index, &p_feature->mapFeature);
+            }
+            mapMtx.unlock();
+
+            cmdMbx.sendMsgReply(ret ? MSG_ERROR : MSG_OK, msgInfo);
+            break;
+
+        // the newest map data, like getData(0)
+        case MSG_FEATURE_MAP_GIVE_MAP:
+            sendDataReply(0, msgInfo);
+            break;
+
+        case MSG_FEATURE_MAP_GET_LAYER:
+            mapMtx.lock(RACK_INFINITE);
+            layerListNum = getLayer(layerList);
+            mapMtx.unlock();
+
+            cmdMbx.sendDataMsgReply(MSG_FEATURE_MAP_LAYER, msgInfo, 2,
+                                    &layerListNum, sizeof(int32_t),
+                                    layerList, layerListNum * sizeof(int32_t));
+            break;
+
+        case MSG_FEATURE_MAP_SET_LAYER:
+            p_layer = FeatureMapLayerData::parse(msgInfo);
+
+            if ((p_layer->layerNum < 0) || (p_layer->layerNum > FEATURE_MAP_LAYER_MAX))
+            {
+                cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+                break;
+            }
+
+            mapMtx.lock(RACK_INFINITE);
+            layerNum = p_layer->layerNum;
+            for (i = 0; i < layerNum; i++)
+            {
+                layer[i] = p_layer->layer[i];
+            }
+            mapMtx.unlock();
+
+            cmdMbx.sendMsgReply(MSG_OK, msgInfo);
+            break;
+
+        case MSG_FEATURE_MAP_GET_NEAREST:
+            p_query = FeatureMapQuery::parse(msgInfo);
+
+            memset(&nearestData, 0, sizeof(nearestData));
+
+            mapMtx.lock(RACK_INFINITE);
+            nearestData.featureIndex = mapIndex->nearest(p_query->x, p_query->y,
+                                                         p_query->maxDistance, p_query->layer,
+                                                         &nearestX, &nearestY, &nearestDistance);
+            if (nearestData.featureIndex >= 0)
+            {
+                nearestData.x        = nearestX;
+                nearestData.y        = nearestY;
+                nearestData.distance = nearestDistance;
+                featureToPoint(&dxfMap->feature[nearestData.featureIndex],
+                               &nearestData.feature);
+            }
+            mapMtx.unlock();
+
+            cmdMbx.sendDataMsgReply(MSG_FEATURE_MAP_NEAREST, msgInfo, 1,
+                                    &nearestData, sizeof(nearestData));
+            break;
+
+        case MSG_FEATURE_MAP_GET_REGION:
+            p_query = FeatureMapQuery::parse(msgInfo);
+
+            mapMtx.lock(RACK_INFINITE);
+            regionMsg.data.matchNum = mapIndex->region(p_query->x, p_query->y,
+                                                       p_query->x2, p_query->y2, p_query->layer,
+                                                       regionIndex, FEATURE_MAP_FEATURE_MAX);
+            regionMsg.data.featureNum = (regionMsg.data.matchNum < FEATURE_MAP_FEATURE_MAX) ?
+                                         regionMsg.data.matchNum : FEATURE_MAP_FEATURE_MAX;
+            for (i = 0; i < regionMsg.data.featureNum; i++)
+            {
+                regionMsg.feature[i].featureIndex = regionIndex[i];
+                featureToPoint(&dxfMap->feature[regionIndex[i]], &regionMsg.feature[i].feature);
+            }
+            mapMtx.unlock();
+
+            cmdMbx.sendDataMsgReply(MSG_FEATURE_MAP_REGION, msgInfo, 1, &regionMsg,
+                                    FeatureMapRegionData::getDatalen(&regionMsg.data));
+            break;
+
+        case MSG_FEATURE_MAP_GET_INTERSECTION:
+            p_query = FeatureMapQuery::parse(msgInfo);
+
+            mapMtx.lock(RACK_INFINITE);
+            ret = mapIndex->intersect(p_query->x, p_query->y, p_query->x2, p_query->y2,
+                                      p_query->layer, intersectionMsg.intersection,
+                                      FEATURE_MAP_INTERSECTION_MAX);
+            mapMtx.unlock();
+
+            if (ret < 0)
+            {
+                GDOS_ERROR("Can't intersect the map, code = %d\n", ret);
+                cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+                break;
+            }
+            intersectionMsg.data.intersectionNum = ret;
+
+            cmdMbx.sendDataMsgReply(MSG_FEATURE_MAP_INTERSECTION, msgInfo, 1, &intersectionMsg,
+                                    FeatureMapIntersectionData::getDatalen(&intersectionMsg.data));
+            break;
+
+        default:
+            // not for me -> ask RackDataModule
+            return RackDataModule::moduleCommand(msgInfo);
+    }
+    return 0;
+}
+
+int FeatureMap::isLayerActive(int layerId)
+{
+    int i;
+
+    if (layerNum == 0)
+    {
+        return 1;
+    }
+
+    for (i = 0; i < layerNum; i++)
+    {
+        if (layer[i] == layerId)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int FeatureMap::getLayer(int32_t *layerList)
+{
+    int i, j, num = 0;
+
+    for (i = 0; i < dxfMap->featureNum; i++)
+    {
+        for (j = 0; j < num; j++)
+        {
+            if (layerList[j] == dxfMap->feature[i].layer)
+            {
+                break;
+            }
+        }
+
+        if ((j == num) && (num < FEATURE_MAP_LAYER_MAX))
+        {
+            layerList[num++] = dxfMap->feature[i].layer;
+        }
+    }
+    return num;
+}
+
+// map index of a feature of the last published data, -1 if out of range
+int FeatureMap::getMapIndex(int publishedIndex)
+{
+    if ((publishedIndex < 0) || (publishedIndex >= publishNum))
+    {
+        return -1;
+    }
+    return publishIndex[publishedIndex];
+}
+
+void FeatureMap::featureToPoint(dxf_map_feature *feature, feature_map_data_point *point)
+{
+    point->x     = feature->x;
+    point->y     = feature->y;
+    point->x2    = feature->x2;
+    point->y2    = feature->y2;
+    point->l     = feature->l;
+    point->rho   = feature->rho;
+    point->sin   = feature->sin;
+    point->cos   = feature->cos;
+    point->layer = feature->layer;
+    point->type  = FEATURE_MAP_TYPE_LINE_FEATURE;
+}
+
+// the length and orientation are computed like DxfMap::load() does
+void FeatureMap::pointToFeature(feature_map_data_point *point, dxf_map_feature *feature)
+{
+    double dx, dy;
+
+    feature->x     = point->x;
+    feature->y     = point->y;
+    feature->x2    = point->x2;
+    feature->y2    = point->y2;
+    feature->layer = point->layer;
+
+    dx          = feature->x2 - feature->x;
+    dy          = feature->y2 - feature->y;
+    feature->l  = sqrt(dx * dx + dy * dy);
+
+    if (feature->l > 0.0)
+    {
+        feature->rho = atan2(dy, dx);
+        feature->sin = sin(feature->rho);
+        feature->cos = cos(feature->rho);
+    }
+    else
+    {
+        feature->rho = 0.0;
+        feature->sin = 0.0;
+        feature->cos = 1.0;
+    }
+}
+
+int FeatureMap::addFeature(feature_map_data_point *point)
+{
+    int ret;
+
+    if (dxfMap->featureNum >= featureMax)
+    {
+        GDOS_ERROR("Can't add feature, the map is full (%i features)\n", featureMax);
+        return -ENOSPC;
+    }
+
+    pointToFeature(point, &dxfMap->feature[dxfMap->featureNum]);
+    dxfMap->featureNum++;
+
+    ret = mapIndex->insert(dxfMap->featureNum - 1);
+    if (ret)
+    {
+        GDOS_ERROR("Can't index feature, code = %d\n", ret);
+        dxfMap->featureNum--;
+        return ret;
+    }
+
+    // publishIndex stays valid, the new feature is the last one
+    return 0;
+}
+
+// the last feature takes the place of the deleted one
+int FeatureMap::deleteFeature(int index)
+{
+    int last = dxfMap->featureNum - 1;
+    int ret  = 0;
+
+    mapIndex->remove(index);
+
+    if (index != last)
+    {
+        mapIndex->remove(last);
+        memcpy(&dxfMap->feature[index], &dxfMap->feature[last], sizeof(dxf_map_feature));
+        dxfMap->featureNum--;
+        ret = mapIndex->insert(index);
+    }
+    else
+    {
+        dxfMap->featureNum--;
+    }
+
+    // the published numbers are invalid until the next message
+    publishNum = 0;
+
+    if (ret)
+    {
+        GDOS_ERROR("Can't index feature, code = %d\n", ret);
+    }
+    return ret;
+}
+
+int FeatureMap::displaceFeature(int index, feature_map_data_point *point)
+{
+    int ret;
+
+    mapIndex->remove(index);
+    pointToFeature(point, &dxfMap->feature[index]);
+
+    ret = mapIndex->insert(index);
+    if (ret)
+    {
+        GDOS_ERROR("Can't index feature, code = %d\n", ret);
+    }
+    return ret;
+}
+
+/*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+
+// the current map is kept if the file can't be loaded
+int FeatureMap::loadMap(char *filename)
+{
+    DxfMap  *newMap;
+    int     ret;
+
+    newMap = new DxfMap(featureMax);
+    if (!newMap || !newMap->feature)
+    {
+        delete newMap;
+        return -ENOMEM;
+    }
+
+    RackTask::disableRealtimeMode();
+    ret = newMap->load(filename, mapOffsetX, mapOffsetY, mapScaleFactor);
+    RackTask::enableRealtimeMode();
+    if (ret)
+    {
+        GDOS_ERROR("Can't load DXF map \"%s\", code = %d\n", filename, ret);
+        delete newMap;
+        return ret;
+    }
+
+    memcpy(dxfMap->feature, newMap->feature, newMap->featureNum * sizeof(dxf_map_feature));
+    dxfMap->featureNum = newMap->featureNum;
+    delete newMap;
+
+    publishNum = 0;
+
+    ret = mapIndex->build();
+    if (ret)
+    {
+        GDOS_ERROR("Can't build the map index, code = %d\n", ret);
+        return ret;
+    }
+
+    GDOS_PRINT("Loaded DXF map \"%s\" with %i features\n", filename, dxfMap->featureNum);
+    return 0;
+}
+
+// DxfMap::save() rescales the features, so a copy is saved
+int FeatureMap::saveMap(char *filename)
+{
+    DxfMap  *saveMap;
+    int     i, ret;
+
+    saveMap = new DxfMap(dxfMap->featureNum > 0 ? dxfMap->featureNum : 1);
+    if (!saveMap || !saveMap->feature)
+    {
+        delete saveMap;
+        return -ENOMEM;
+    }
+
+    for (i = 0; i < dxfMap->featureNum; i++)
+    {
+        memcpy(&saveMap->feature[i], &dxfMap->feature[i], sizeof(dxf_map_feature));
+        saveMap->feature[i].x  += mapOffsetX * mapScaleFactor;
+        saveMap->feature[i].y  += mapOffsetY * mapScaleFactor;
+        saveMap->feature[i].x2 += mapOffsetX * mapScaleFactor;
+        saveMap->feature[i].y2 += mapOffsetY * mapScaleFactor;
+    }
+    saveMap->featureNum = dxfMap->featureNum;
+
+    RackTask::disableRealtimeMode();
+    ret = saveMap->save(filename, saveMap->featureNum, mapScaleFactor);
+    RackTask::enableRealtimeMode();
+
+    delete saveMap;
+
+    if (ret)
+    {
+        GDOS_ERROR("Can't save DXF map \"%s\", code = %d\n", filename, ret);
+    }
+    return ret;
+}
+
+// init_flags (for init and cleanup)
+#define INIT_BIT_DATA_MODULE            0
+#define INIT_BIT_MAP_CREATED            1
+#define INIT_BIT_INDEX_CREATED          2
+#define INIT_BIT_MTX_CREATED            3
+
+int  FeatureMap::moduleInit(void)
+{
+    int ret;
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    // map
+    dxfMap = new DxfMap(featureMax);
+    if (!dxfMap || !dxfMap->feature)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MAP_CREATED);
+
+    // map index
+    mapIndex = new FeatureMapIndex(dxfMap, featureMax);
+    if (!mapIndex)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_INDEX_CREATED);
+
+    // create map mutex
+    ret = mapMtx.create();
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MTX_CREATED);
+
+    // the map is loaded once, an empty map can be filled by ADD_LINE
+    if (!mapFile || loadMap(mapFile))
+    {
+        GDOS_WARNING("Starting with an empty map\n");
+
+        ret = mapIndex->build();
+        if (ret)
+        {
+            goto init_error;
+        }
+    }
+
+    return 0;
+
+init_error:
+    moduleCleanup();
+    return ret;
+}
+
+void FeatureMap::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+
+    // destroy mutex
+    if (initBits.testAndClearBit(INIT_BIT_MTX_CREATED))
+    {
+        mapMtx.destroy();
+    }
+
+    // free map index
+    if (initBits.testAndClearBit(INIT_BIT_INDEX_CREATED))
+    {
+        delete mapIndex;
+    }
+
+    // free map
+    if (initBits.testAndClearBit(INIT_BIT_MAP_CREATED))
+    {
+        delete dxfMap;
+    }
+}
+
+FeatureMap::FeatureMap()
+      : RackDataModule( MODULE_CLASS_ID,
+                    5000000000llu,    // 5s datatask error sleep time
+                    16,               // command mailbox slots
+                    256,              // command mailbox data size per slot
+                    MBX_IN_KERNELSPACE | MBX_SLOT,  // command mailbox flags
+                    5,                // max buffer entries
+                    10)               // data buffer listener
+{
+    // get static module parameter
+    mapFile        = getStrArg("mapFile", argTab);
+    mapScaleFactor = (double)getIntArg("mapScaleFactor", argTab);
+    mapOffsetX     = (double)getIntArg("mapOffsetX", argTab);
+    mapOffsetY     = (double)getIntArg("mapOffsetY", argTab);
+    featureMax     = getIntArg("featureMax", argTab);
+
+    if (featureMax < 1)
+    {
+        featureMax = 1;
+    }
+
+    layerNum   = 0;
+    publishNum = 0;
+
+    dataBufferMaxDataSize = sizeof(feature_map_data_msg);
+}
+
+int  main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "FeatureMap");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    FeatureMap *pInst;
+
+    // create new FeatureMap
+    pInst = new FeatureMap();
+    if (!pInst)
+    {
+        printf("Can't create new FeatureMap -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // init
+    ret = pInst->moduleInit();
+    if (ret)
+        goto exit_error;
+
+    pInst->run();
+
+    return 0;
+
+exit_error:
+
+    delete (pInst);
+    return ret;
+}
@@ -0,0 +1,104 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __FEATURE_MAP_H__
+#define __FEATURE_MAP_H__
+
+#include <main/rack_data_module.h>
+#include <main/dxf_map.h>
+#include <navigation/feature_map_proxy.h>
+
+#include "feature_map_index.h"
+
+// define module class
+#define MODULE_CLASS_ID                 FEATURE_MAP
+
+typedef struct {
+    feature_map_data        data;
+    feature_map_data_point  feature[FEATURE_MAP_FEATURE_MAX];
+} __attribute__((packed)) feature_map_data_msg;
+
+typedef struct {
+    feature_map_region_data     data;
+    feature_map_region_feature  feature[FEATURE_MAP_FEATURE_MAX];
+} __attribute__((packed)) feature_map_region_msg;
+
+typedef struct {
+    feature_map_intersection_data   data;
+    feature_map_intersection        intersection[FEATURE_MAP_INTERSECTION_MAX];
+} __attribute__((packed)) feature_map_intersection_msg;
+
+/**
+ * Feature map module
+ *
+ * Loads a DXF map once and serves it to the FeatureMapProxy. The map of the
+ * active layers is published as feature_map_data, nearest feature, region and
+ * line intersection queries are answered from a uniform grid index that
+ * follows the added, deleted and displaced features.
+ *
+ * The features of the published data are numbered by their position in the
+ * last message, like FeatureMapGui uses them in featureNumTemp.
+ *
+ * @ingroup modules_feature_map
+ */
+class FeatureMap : public RackDataModule {
+    private:
+        char                *mapFile;
+        double              mapScaleFactor;
+        double              mapOffsetX;
+        double              mapOffsetY;
+        int                 featureMax;
+
+        DxfMap              *dxfMap;
+        FeatureMapIndex     *mapIndex;
+        RackMutex           mapMtx;
+
+        int                 layerNum;               // active layers, 0: all
+        int32_t             layer[FEATURE_MAP_LAYER_MAX];
+        int                 publishNum;             // features of the last message
+        int                 publishIndex[FEATURE_MAP_FEATURE_MAX];
+
+        int                 regionIndex[FEATURE_MAP_FEATURE_MAX];
+        feature_map_region_msg          regionMsg;
+        feature_map_intersection_msg    intersectionMsg;
+
+        int     loadMap(char *filename);
+        int     saveMap(char *filename);
+        int     addFeature(feature_map_data_point *point);
+        int     deleteFeature(int index);
+        int     displaceFeature(int index, feature_map_data_point *point);
+        int     isLayerActive(int layerId);
+        int     getLayer(int32_t *layerList);
+        int     getMapIndex(int publishedIndex);
+        void    featureToPoint(dxf_map_feature *feature, feature_map_data_point *point);
+        void    pointToFeature(feature_map_data_point *point, dxf_map_feature *feature);
+
+    protected:
+        // -> realtime context
+        int     moduleOn(void);
+        int     moduleLoop(void);
+        void    moduleOff(void);
+        int     moduleCommand(RackMessage *msgInfo);
+
+        // -> non realtime context
+        void    moduleCleanup(void);
+
+    public:
+        // constructor und destructor
+        FeatureMap();
+        ~FeatureMap() {};
+
+        // -> non realtime context
+        int  moduleInit(void);
+};
+
+#endif // __FEATURE_MAP_H__
@@ -0,0 +1,605 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "feature_map_index.h"
+
+FeatureMapIndex::FeatureMapIndex(DxfMap *map, int featureMax)
+{
+    this->map        = map;
+    this->featureMax = featureMax;
+
+    cellHead     = NULL;
+    cellList     = NULL;
+    cellListMax  = 0;
+    entryFeature = NULL;
+    entryNext    = NULL;
+    entryMax     = 0;
+    entryFree    = -1;
+    stamp        = NULL;
+    query        = 0;
+    numX         = 0;
+    numY         = 0;
+}
+
+FeatureMapIndex::~FeatureMapIndex()
+{
+    freeIndex();
+}
+
+void FeatureMapIndex::freeIndex(void)
+{
+    free(cellHead);
+    free(cellList);
+    free(entryFeature);
+    free(entryNext);
+    free(stamp);
+
+    cellHead     = NULL;
+    cellList     = NULL;
+    cellListMax  = 0;
+    entryFeature = NULL;
+    entryNext    = NULL;
+    entryMax     = 0;
+    entryFree    = -1;
+    stamp        = NULL;
+}
+
+int FeatureMapIndex::build(void)
+{
+    dxf_map_feature *f;
+    double          x0, y0, x1, y1, w, h, margin;
+    int             axisMax, cells, i, ret;
+
+    freeIndex();
+
+    // bounds of the map with a margin for new features
+    x0 = y0 = 0.0;
+    x1 = y1 = 1000.0;
+
+    for (i = 0; i < map->featureNum; i++)
+    {
+        f = &map->feature[i];
+        if (i == 0)
+        {
+            x0 = x1 = f->x;
+            y0 = y1 = f->y;
+        }
+        x0 = fmin(x0, fmin(f->x, f->x2));
+        x1 = fmax(x1, fmax(f->x, f->x2));
+        y0 = fmin(y0, fmin(f->y, f->y2));
+        y1 = fmax(y1, fmax(f->y, f->y2));
+    }
+
+    margin = 0.1 * fmax(x1 - x0, y1 - y0) + 1000.0;
+    xMin   = x0 - margin;
+    yMin   = y0 - margin;
+    w      = x1 - x0 + 2.0 * margin;
+    h      = y1 - y0 + 2.0 * margin;
+
+    // about four cells per feature, limited to DXF_MAP_INDEX_CELL_MAX cells
+    axisMax  = (int)sqrt((double)DXF_MAP_INDEX_CELL_MAX) - 1;
+    cellSize = sqrt(w * h / (4.0 * (double)(map->featureNum > 0 ? map->featureNum : 1)));
+    if (cellSize < fmax(w, h) / (double)axisMax)
+    {
+        cellSize = fmax(w, h) / (double)axisMax;
+    }
+
+    numX  = (int)(w / cellSize) + 1;
+    numY  = (int)(h / cellSize) + 1;
+    cells = numX * numY;
+
+    cellHead    = (int *)malloc(cells * sizeof(int));
+    cellListMax = numX + 2 * numY + 4;
+    cellList    = (int *)malloc(cellListMax * sizeof(int));
+    stamp       = (int *)calloc(featureMax, sizeof(int));
+    if (!cellHead || !cellList || !stamp)
+    {
+        freeIndex();
+        return -ENOMEM;
+    }
+    memset(cellHead, 0xff, cells * sizeof(int));
+    query = 0;
+
+    for (i = 0; i < map->featureNum; i++)
+    {
+        ret = insert(i);
+        if (ret)
+        {
+            freeIndex();
+            return ret;
+        }
+    }
+    return 0;
+}
+
+int FeatureMapIndex::newEntry(void)
+{
+    int *newFeature, *newNext;
+    int e, newMax;
+
+    if (entryFree < 0)
+    {
+        newMax     = (entryMax > 0) ? 2 * entryMax : 4 * featureMax + 64;
+        newFeature = (int *)realloc(entryFeature, newMax * sizeof(int));
+        if (newFeature)
+        {
+            entryFeature = newFeature;
+        }
+        newNext = (int *)realloc(entryNext, newMax * sizeof(int));
+        if (newNext)
+        {
+            entryNext = newNext;
+        }
+        if (!newFeature || !newNext)
+        {
+            return -ENOMEM;
+        }
+
+        for (e = entryMax; e < newMax - 1; e++)
+        {
+            entryNext[e] = e + 1;
+        }
+        entryNext[newMax - 1] = -1;
+        entryFree = entryMax;
+        entryMax  = newMax;
+    }
+
+    e         = entryFree;
+    entryFree = entryNext[e];
+    return e;
+}
+
+int FeatureMapIndex::isInside(dxf_map_feature *f)
+{
+    double xMax = xMin + (double)numX * cellSize;
+    double yMax = yMin + (double)numY * cellSize;
+
+    return (fmin(f->x, f->x2) >= xMin) && (fmax(f->x, f->x2) < xMax) &&
+           (fmin(f->y, f->y2) >= yMin) && (fmax(f->y, f->y2) < yMax);
+}
+
+// cells crossed by a line, row by row like DxfMap::buildIndex()
+int FeatureMapIndex::getCells(dxf_map_feature *f)
+{
+    double  dx, dy, yLow, yHigh, xa, xb, t0, t1, eps;
+    int     ix, iy, ixMin, ixMax, iyMin, iyMax, n, *newList;
+
+    dx  = f->x2 - f->x;
+    dy  = f->y2 - f->y;
+    eps = cellSize * 1e-6;
+    n   = 0;
+
+    iyMin = (int)floor((fmin(f->y, f->y2) - eps - yMin) / cellSize);
+    iyMax = (int)floor((fmax(f->y, f->y2) + eps - yMin) / cellSize);
+    iyMin = (iyMin < 0) ? 0 : iyMin;
+    iyMax = (iyMax >= numY) ? numY - 1 : iyMax;
+
+    for (iy = iyMin; iy <= iyMax; iy++)
+    {
+        // part of the line within this row
+        yLow  = yMin + (double)iy * cellSize - eps;
+        yHigh = yLow + cellSize + 2.0 * eps;
+
+        if (fabs(dy) < eps)
+        {
+            t0 = 0.0;
+            t1 = 1.0;
+        }
+        else
+        {
+            t0 = (yLow - f->y) / dy;
+            t1 = (yHigh - f->y) / dy;
+            if (t0 > t1)
+            {
+                xa = t0;
+                t0 = t1;
+                t1 = xa;
+            }
+            t0 = (t0 < 0.0) ? 0.0 : t0;
+            t1 = (t1 > 1.0) ? 1.0 : t1;
+        }
+
+        xa = fmin(f->x + dx * t0, f->x + dx * t1);
+        xb = fmax(f->x + dx * t0, f->x + dx * t1);
+
+        ixMin = (int)floor((xa - eps - xMin) / cellSize);
+        ixMax = (int)floor((xb + eps - xMin) / cellSize);
+        ixMin = (ixMin < 0) ? 0 : ixMin;
+        ixMax = (ixMax >= numX) ? numX - 1 : ixMax;
+
+        for (ix = ixMin; ix <= ixMax; ix++)
+        {
+            if (n >= cellListMax)
+            {
+                newList = (int *)realloc(cellList, 2 * cellListMax * sizeof(int));
+                if (!newList)
+                {
+                    return -ENOMEM;
+                }
+                cellList     = newList;
+                cellListMax *= 2;
+            }
+            cellList[n++] = iy * numX + ix;
+        }
+    }
+    return n;
+}
+
+int FeatureMapIndex::insert(int i)
+{
+    int c, e, n;
+
+    // the grid is rebuilt if the feature lies outside
+    if (!cellHead || !isInside(&map->feature[i]))
+    {
+        return build();
+    }
+
+    n = getCells(&map->feature[i]);
+    if (n < 0)
+    {
+        return n;
+    }
+
+    for (c = 0; c < n; c++)
+    {
+        e = newEntry();
+        if (e < 0)
+        {
+            return e;
+        }
+        entryFeature[e]       = i;
+        entryNext[e]          = cellHead[cellList[c]];
+        cellHead[cellList[c]] = e;
+    }
+    return 0;
+}
+
+void FeatureMapIndex::remove(int i)
+{
+    int c, e, n, *prev;
+
+    if (!cellHead)
+    {
+        return;
+    }
+
+    n = getCells(&map->feature[i]);
+    if (n < 0)
+    {
+        // the next insert() rebuilds the index
+        freeIndex();
+        return;
+    }
+
+    for (c = 0; c < n; c++)
+    {
+        prev = &cellHead[cellList[c]];
+        while (*prev >= 0)
+        {
+            e = *prev;
+            if (entryFeature[e] == i)
+            {
+                *prev        = entryNext[e];
+                entryNext[e] = entryFree;
+                entryFree    = e;
+            }
+            else
+            {
+                prev = &entryNext[e];
+            }
+        }
+    }
+}
+
+int FeatureMapIndex::nextQuery(void)
+{
+    if (query == INT_MAX)
+    {
+        memset(stamp, 0, featureMax * sizeof(int));
+        query = 0;
+    }
+    return ++query;
+}
+
+static double pointLineDistance(dxf_map_feature *f, double x, double y,
+                                double *px, double *py)
+{
+    double dx, dy, l2, t;
+
+    dx = f->x2 - f->x;
+    dy = f->y2 - f->y;
+    l2 = dx * dx + dy * dy;
+    t  = 0.0;
+
+    if (l2 > 0.0)
+    {
+        t = ((x - f->x) * dx + (y - f->y) * dy) / l2;
+        t = (t < 0.0) ? 0.0 : ((t > 1.0) ? 1.0 : t);
+    }
+
+    *px = f->x + t * dx;
+    *py = f->y + t * dy;
+    return sqrt((x - *px) * (x - *px) + (y - *py) * (y - *py));
+}
+
+int FeatureMapIndex::nearest(double x, double y, double maxDistance, int layer,
+                             double *px, double *py, double *distance)
+{
+    double  bestDistance, d, nx, ny;
+    int     best, q, r, cx, cy, ix, iy, e, i;
+
+    if (!cellHead || (map->featureNum <= 0))
+    {
+        return -1;
+    }
+
+    q  = nextQuery();
+    cx = (int)floor((x - xMin) / cellSize);
+    cy = (int)floor((y - yMin) / cellSize);
+    cx = (cx < 0) ? 0 : ((cx >= numX) ? numX - 1 : cx);
+    cy = (cy < 0) ? 0 : ((cy >= numY) ? numY - 1 : cy);
+
+    best         = -1;
+    bestDistance = (maxDistance > 0.0) ? maxDistance : HUGE_VAL;
+
+    // search rings of cells around the query cell, a feature outside of
+    // ring r is at least r cells away
+    for (r = 0; (r <= numX) || (r <= numY); r++)
+    {
+        for (iy = cy - r; iy <= cy + r; iy++)
+        {
+            if ((iy < 0) || (iy >= numY))
+            {
+                continue;
+            }
+
+            for (ix = cx - r; ix <= cx + r;
+                 ix += ((iy == cy - r) || (iy == cy + r) || (r == 0)) ? 1 : 2 * r)
+            {
+                if ((ix < 0) || (ix >= numX))
+                {
+                    continue;
+                }
+
+                for (e = cellHead[iy * numX + ix]; e >= 0; e = entryNext[e])
+                {
+                    i = entryFeature[e];
+                    if (stamp[i] == q)
+                    {
+                        continue;
+                    }
+                    stamp[i] = q;
+
+                    if ((layer >= 0) && (map->feature[i].layer != layer))
+                    {
+                        continue;
+                    }
+
+                    d = pointLineDistance(&map->feature[i], x, y, &nx, &ny);
+                    if ((d < bestDistance) || ((best < 0) && (d <= bestDistance)))
+                    {
+                        best         = i;
+                        bestDistance = d;
+                        *px          = nx;
+                        *py          = ny;
+                    }
+                }
+            }
+        }
+
+        if (bestDistance <= (double)r * cellSize)
+        {
+            break;
+        }
+    }
+
+    if (best >= 0)
+    {
+        *distance = bestDistance;
+    }
+    return best;
+}
+
+// Liang-Barsky test of a line against a rectangle
+static int lineInRect(dxf_map_feature *f, double x0, double y0, double x1, double y1)
+{
+    double p[4], q[4], t0, t1, t;
+    int    k;
+
+    p[0] = -(f->x2 - f->x);  q[0] = f->x - x0;
+    p[1] =  (f->x2 - f->x);  q[1] = x1 - f->x;
+    p[2] = -(f->y2 - f->y);  q[2] = f->y - y0;
+    p[3] =  (f->y2 - f->y);  q[3] = y1 - f->y;
+
+    t0 = 0.0;
+    t1 = 1.0;
+
+    for (k = 0; k < 4; k++)
+    {
+        if (p[k] == 0.0)
+        {
+            if (q[k] < 0.0)
+            {
+                return 0;
+            }
+            continue;
+        }
+
+        t = q[k] / p[k];
+        if (p[k] < 0.0)
+        {
+            t0 = (t > t0) ? t : t0;
+        }
+        else
+        {
+            t1 = (t < t1) ? t : t1;
+        }
+        if (t0 > t1)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int FeatureMapIndex::region(double x, double y, double x2, double y2, int layer,
+                            int *feature, int featureNum)
+{
+    double  x0, y0, x1, y1;
+    int     q, ix, iy, ixMin, ixMax, iyMin, iyMax, e, i, num;
+
+    if (!cellHead)
+    {
+        return 0;
+    }
+
+    x0 = fmin(x, x2);
+    x1 = fmax(x, x2);
+    y0 = fmin(y, y2);
+    y1 = fmax(y, y2);
+
+    ixMin = (int)floor((x0 - xMin) / cellSize);
+    ixMax = (int)floor((x1 - xMin) / cellSize);
+    iyMin = (int)floor((y0 - yMin) / cellSize);
+    iyMax = (int)floor((y1 - yMin) / cellSize);
+    if ((ixMax < 0) || (ixMin >= numX) || (iyMax < 0) || (iyMin >= numY))
+    {
+        return 0;
+    }
+    ixMin = (ixMin < 0) ? 0 : ixMin;
+    ixMax = (ixMax >= numX) ? numX - 1 : ixMax;
+    iyMin = (iyMin < 0) ? 0 : iyMin;
+    iyMax = (iyMax >= numY) ? numY - 1 : iyMax;
+
+    q   = nextQuery();
+    num = 0;
+
+    for (iy = iyMin; iy <= iyMax; iy++)
+    {
+        for (ix = ixMin; ix <= ixMax; ix++)
+        {
+            for (e = cellHead[iy * numX + ix]; e >= 0; e = entryNext[e])
+            {
+                i = entryFeature[e];
+                if (stamp[i] == q)
+                {
+                    continue;
+                }
+                stamp[i] = q;
+
+                if (((layer >= 0) && (map->feature[i].layer != layer)) ||
+                    !lineInRect(&map->feature[i], x0, y0, x1, y1))
+                {
+                    continue;
+                }
+
+                if (num < featureNum)
+                {
+                    feature[num] = i;
+                }
+                num++;
+            }
+        }
+    }
+    return num;
+}
+
+int FeatureMapIndex::intersect(double x, double y, double x2, double y2, int layer,
+                               feature_map_intersection *intersection, int intersectionNum)
+{
+    dxf_map_feature line, *f;
+    double          dx, dy, fx, fy, den, t, u, length;
+    int             q, n, c, e, i, k, num;
+
+    if (!cellHead || (intersectionNum <= 0))
+    {
+        return 0;
+    }
+
+    line.x  = x;
+    line.y  = y;
+    line.x2 = x2;
+    line.y2 = y2;
+
+    n = getCells(&line);
+    if (n < 0)
+    {
+        return n;
+    }
+
+    dx     = x2 - x;
+    dy     = y2 - y;
+    length = sqrt(dx * dx + dy * dy);
+    q      = nextQuery();
+    num    = 0;
+
+    for (c = 0; c < n; c++)
+    {
+        for (e = cellHead[cellList[c]]; e >= 0; e = entryNext[e])
+        {
+            i = entryFeature[e];
+            if (stamp[i] == q)
+            {
+                continue;
+            }
+            stamp[i] = q;
+
+            f = &map->feature[i];
+            if ((f->l <= 0.0) || ((layer >= 0) && (f->layer != layer)))
+            {
+                continue;
+            }
+
+            fx  = f->x2 - f->x;
+            fy  = f->y2 - f->y;
+            den = dx * fy - dy * fx;
+            if (den == 0.0)
+            {
+                continue;
+            }
+
+            t = ((f->x - x) * fy - (f->y - y) * fx) / den;
+            u = ((f->x - x) * dy - (f->y - y) * dx) / den;
+            if ((t < 0.0) || (t > 1.0) || (u < 0.0) || (u > 1.0))
+            {
+                continue;
+            }
+
+            // keep the intersectionNum nearest intersections, sorted
+            if ((num == intersectionNum) &&
+                (t * length >= intersection[num - 1].distance))
+            {
+                continue;
+            }
+
+            k = (num < intersectionNum) ? num++ : num - 1;
+            while ((k > 0) && (intersection[k - 1].distance > t * length))
+            {
+                intersection[k] = intersection[k - 1];
+                k--;
+            }
+            intersection[k].x            = x + t * dx;
+            intersection[k].y            = y + t * dy;
+            intersection[k].distance     = t * length;
+            intersection[k].featureIndex = i;
+            intersection[k].layer        = f->layer;
+        }
+    }
+    return num;
+}
@@ -0,0 +1,121 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __FEATURE_MAP_INDEX_H__
+#define __FEATURE_MAP_INDEX_H__
+
+#include <navigation/feature_map_proxy.h>
+#include <main/dxf_map.h>
+
+/**
+ * Uniform grid index over the features of a DxfMap.
+ *
+ * Unlike the static index of DxfMap::load() the cells hold linked lists,
+ * so single features can be inserted and removed without a rebuild. The
+ * grid is only rebuilt if a new feature lies outside of its bounds.
+ * A line feature is entered into each cell it crosses, a point feature
+ * into its cell.
+ *
+ * The index refers to the features by their position in the map. It has
+ * to be updated before (remove) or after (insert) the map is changed.
+ *
+ * @ingroup modules_feature_map
+ */
+class FeatureMapIndex
+{
+    private:
+        DxfMap  *map;
+        int     featureMax;
+
+        double  xMin;
+        double  yMin;
+        double  cellSize;
+        int     numX;
+        int     numY;
+        int     *cellHead;              // first entry of a cell, -1: empty
+        int     *cellList;              // cells of one line, see getCells()
+        int     cellListMax;
+
+        // entry pool, entries of a cell are linked by entryNext
+        int     *entryFeature;
+        int     *entryNext;
+        int     entryMax;
+        int     entryFree;              // first unused entry, -1: pool is full
+
+        int     *stamp;                 // last query that tested a feature
+        int     query;
+
+        void    freeIndex(void);
+        int     newEntry(void);
+        int     getCells(dxf_map_feature *f);
+        int     isInside(dxf_map_feature *f);
+        int     nextQuery(void);
+
+    public:
+
+        FeatureMapIndex(DxfMap *map, int featureMax);
+        ~FeatureMapIndex();
+
+        /**
+         * @brief Build the index of all map features
+         *
+         * @return 0 on success, otherwise negative error code
+         */
+        int     build(void);
+
+        /**
+         * @brief Insert the map feature @a i
+         *
+         * @return 0 on success, otherwise negative error code
+         */
+        int     insert(int i);
+
+        /** @brief Remove the map feature @a i */
+        void    remove(int i);
+
+        /**
+         * @brief Nearest feature of a layer
+         *
+         * @param maxDistance Search radius, 0 unlimited
+         * @param layer Layer id, -1 all layers
+         * @param px Returns the nearest point of the feature
+         * @param py Returns the nearest point of the feature
+         * @param distance Returns the distance to the feature
+         *
+         * @return index of the feature, -1 if there is no feature
+         */
+        int     nearest(double x, double y, double maxDistance, int layer,
+                        double *px, double *py, double *distance);
+
+        /**
+         * @brief Features of a layer within a rectangle
+         *
+         * Writes at most @a featureNum feature indices to @a feature.
+         *
+         * @return number of features within the rectangle
+         */
+        int     region(double x, double y, double x2, double y2, int layer,
+                       int *feature, int featureNum);
+
+        /**
+         * @brief Intersections of a line with the line features of a layer
+         *
+         * Writes the @a intersectionNum intersections next to (x, y) to
+         * @a intersection, sorted by their distance.
+         *
+         * @return number of intersections written
+         */
+        int     intersect(double x, double y, double x2, double y2, int layer,
+                          feature_map_intersection *intersection, int intersectionNum);
+};
+
+#endif // __FEATURE_MAP_INDEX_H__
@@ -29,13 +29,21 @@
 #define MSG_FEATURE_MAP_DISPLACE_LINE           (RACK_PROXY_MSG_POS_OFFSET + 6)
 #define MSG_FEATURE_MAP_GET_LAYER               (RACK_PROXY_MSG_POS_OFFSET + 7)
 #define MSG_FEATURE_MAP_SET_LAYER               (RACK_PROXY_MSG_POS_OFFSET + 8)
+#define MSG_FEATURE_MAP_GET_NEAREST             (RACK_PROXY_MSG_POS_OFFSET + 9)
+#define MSG_FEATURE_MAP_GET_REGION              (RACK_PROXY_MSG_POS_OFFSET + 10)
+#define MSG_FEATURE_MAP_GET_INTERSECTION        (RACK_PROXY_MSG_POS_OFFSET + 11)
 
 #define MSG_FEATURE_MAP_LAYER                   (RACK_PROXY_MSG_POS_OFFSET - 1)
+#define MSG_FEATURE_MAP_NEAREST                 (RACK_PROXY_MSG_NEG_OFFSET - 1)
+#define MSG_FEATURE_MAP_REGION                  (RACK_PROXY_MSG_NEG_OFFSET - 2)
+#define MSG_FEATURE_MAP_INTERSECTION            (RACK_PROXY_MSG_NEG_OFFSET - 3)
 
 //#define MSG_FEATURE_MAP_ADD_LINE_OK            (RACK_PROXY_MSG_NEG_OFFSET - 10)
 
-#define FEATURE_MAP_FEATURE_MAX 200         /**< maximum number of map features */
+#define FEATURE_MAP_FEATURE_MAX 1000        /**< maximum number of map features
+                                                 of a data or region message */
 #define FEATURE_MAP_LAYER_MAX   20
+#define FEATURE_MAP_INTERSECTION_MAX 64     /**< maximum number of intersections */
 
 #define FEATURE_MAP_TYPE_LINE_FEATURE   10
 
@@ -316,6 +324,281 @@ class FeatureMapLayerData
 };
 
 
+//######################################################################
+//# FeatureMap Query Data (static size - MESSAGE)
+//######################################################################
+
+/**
+ * feature map query data structure
+ *
+ * MSG_FEATURE_MAP_GET_NEAREST:      nearest feature to (x, y) within maxDistance,
+ * MSG_FEATURE_MAP_GET_REGION:       features within the rectangle (x, y) - (x2, y2),
+ * MSG_FEATURE_MAP_GET_INTERSECTION: intersections of the line (x, y) - (x2, y2).
+ */
+typedef struct {
+    double      x;                          /**< [mm] x-coordinate of the query point */
+    double      y;                          /**< [mm] y-coordinate of the query point */
+    double      x2;                         /**< [mm] x-coordinate of the second point */
+    double      y2;                         /**< [mm] y-coordinate of the second point */
+    double      maxDistance;                /**< [mm] search radius, 0 unlimited */
+    int32_t     layer;                      /**< layer id, -1 all layers */
+} __attribute__((packed)) feature_map_query;
+
+class FeatureMapQuery
+{
+    public:
+        static void le_to_cpu(feature_map_query *data)
+        {
+            data->x           = __le64_float_to_cpu(data->x);
+            data->y           = __le64_float_to_cpu(data->y);
+            data->x2          = __le64_float_to_cpu(data->x2);
+            data->y2          = __le64_float_to_cpu(data->y2);
+            data->maxDistance = __le64_float_to_cpu(data->maxDistance);
+            data->layer       = __le32_to_cpu(data->layer);
+        }
+
+        static void be_to_cpu(feature_map_query *data)
+        {
+            data->x           = __be64_float_to_cpu(data->x);
+            data->y           = __be64_float_to_cpu(data->y);
+            data->x2          = __be64_float_to_cpu(data->x2);
+            data->y2          = __be64_float_to_cpu(data->y2);
+            data->maxDistance = __be64_float_to_cpu(data->maxDistance);
+            data->layer       = __be32_to_cpu(data->layer);
+        }
+
+        static feature_map_query* parse(RackMessage *msgInfo)
+        {
+            if (!msgInfo->p_data)
+                return NULL;
+
+            feature_map_query *p_data = (feature_map_query *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+};
+
+/**
+ * feature map nearest feature data structure
+ */
+typedef struct {
+    int32_t                 featureIndex;   /**< index of the feature, -1 if there is no
+                                                 feature within maxDistance */
+    double                  distance;       /**< [mm] distance to the feature */
+    double                  x;              /**< [mm] x-coordinate of the nearest point */
+    double                  y;              /**< [mm] y-coordinate of the nearest point */
+    feature_map_data_point  feature;        /**< feature */
+} __attribute__((packed)) feature_map_nearest_data;
+
+class FeatureMapNearestData
+{
+    public:
+        static void le_to_cpu(feature_map_nearest_data *data)
+        {
+            data->featureIndex = __le32_to_cpu(data->featureIndex);
+            data->distance     = __le64_float_to_cpu(data->distance);
+            data->x            = __le64_float_to_cpu(data->x);
+            data->y            = __le64_float_to_cpu(data->y);
+            FeatureMapDataPoint::le_to_cpu(&data->feature);
+        }
+
+        static void be_to_cpu(feature_map_nearest_data *data)
+        {
+            data->featureIndex = __be32_to_cpu(data->featureIndex);
+            data->distance     = __be64_float_to_cpu(data->distance);
+            data->x            = __be64_float_to_cpu(data->x);
+            data->y            = __be64_float_to_cpu(data->y);
+            FeatureMapDataPoint::be_to_cpu(&data->feature);
+        }
+
+        static feature_map_nearest_data* parse(RackMessage *msgInfo)
+        {
+            if (!msgInfo->p_data)
+                return NULL;
+
+            feature_map_nearest_data *p_data = (feature_map_nearest_data *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+};
+
+//######################################################################
+//# FeatureMap Region Data (!!! VARIABLE SIZE !!! MESSAGE !!!)
+//######################################################################
+
+/**
+ * feature map region feature data structure
+ */
+typedef struct {
+    int32_t                 featureIndex;   /**< index of the feature */
+    feature_map_data_point  feature;        /**< feature */
+} __attribute__((packed)) feature_map_region_feature;
+
+/**
+ * feature map region data structure
+ */
+typedef struct {
+    int32_t                     matchNum;   /**< number of features within the region,
+                                                 may be more than featureNum */
+    int32_t                     featureNum; /**< number of following features,
+                                                 max FEATURE_MAP_FEATURE_MAX */
+    feature_map_region_feature  feature[0]; /**< list of features */
+} __attribute__((packed)) feature_map_region_data;
+
+class FeatureMapRegionData
+{
+    public:
+        static void le_to_cpu(feature_map_region_data *data)
+        {
+            int i;
+            data->matchNum   = __le32_to_cpu(data->matchNum);
+            data->featureNum = __le32_to_cpu(data->featureNum);
+            for (i = 0; i < data->featureNum; i++)
+            {
+                data->feature[i].featureIndex = __le32_to_cpu(data->feature[i].featureIndex);
+                FeatureMapDataPoint::le_to_cpu(&data->feature[i].feature);
+            }
+        }
+
+        static void be_to_cpu(feature_map_region_data *data)
+        {
+            int i;
+            data->matchNum   = __be32_to_cpu(data->matchNum);
+            data->featureNum = __be32_to_cpu(data->featureNum);
+            for (i = 0; i < data->featureNum; i++)
+            {
+                data->feature[i].featureIndex = __be32_to_cpu(data->feature[i].featureIndex);
+                FeatureMapDataPoint::be_to_cpu(&data->feature[i].feature);
+            }
+        }
+
+        static feature_map_region_data* parse(RackMessage *msgInfo)
+        {
+            if (!msgInfo->p_data)
+                return NULL;
+
+            feature_map_region_data *p_data = (feature_map_region_data *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+
+        static size_t getDatalen(feature_map_region_data *data)
+        {
+            return (sizeof(feature_map_region_data) +
+                    data->featureNum * sizeof(feature_map_region_feature));
+        }
+};
+
+//######################################################################
+//# FeatureMap Intersection Data (!!! VARIABLE SIZE !!! MESSAGE !!!)
+//######################################################################
+
+/**
+ * feature map intersection data structure
+ */
+typedef struct {
+    double      x;                          /**< [mm] x-coordinate of the intersection */
+    double      y;                          /**< [mm] y-coordinate of the intersection */
+    double      distance;                   /**< [mm] distance to the start of the line */
+    int32_t     featureIndex;               /**< index of the feature */
+    int32_t     layer;                      /**< layer id of the feature */
+} __attribute__((packed)) feature_map_intersection;
+
+/**
+ * feature map intersection list data structure, sorted by distance
+ */
+typedef struct {
+    int32_t                   intersectionNum;  /**< number of following intersections,
+                                                     max FEATURE_MAP_INTERSECTION_MAX */
+    feature_map_intersection  intersection[0];  /**< list of intersections */
+} __attribute__((packed)) feature_map_intersection_data;
+
+class FeatureMapIntersectionData
+{
+    public:
+        static void le_to_cpu(feature_map_intersection_data *data)
+        {
+            int i;
+            data->intersectionNum = __le32_to_cpu(data->intersectionNum);
+            for (i = 0; i < data->intersectionNum; i++)
+            {
+                data->intersection[i].x            = __le64_float_to_cpu(data->intersection[i].x);
+                data->intersection[i].y            = __le64_float_to_cpu(data->intersection[i].y);
+                data->intersection[i].distance     = __le64_float_to_cpu(data->intersection[i].distance);
+                data->intersection[i].featureIndex = __le32_to_cpu(data->intersection[i].featureIndex);
+                data->intersection[i].layer        = __le32_to_cpu(data->intersection[i].layer);
+            }
+        }
+
+        static void be_to_cpu(feature_map_intersection_data *data)
+        {
+            int i;
+            data->intersectionNum = __be32_to_cpu(data->intersectionNum);
+            for (i = 0; i < data->intersectionNum; i++)
+            {
+                data->intersection[i].x            = __be64_float_to_cpu(data->intersection[i].x);
+                data->intersection[i].y            = __be64_float_to_cpu(data->intersection[i].y);
+                data->intersection[i].distance     = __be64_float_to_cpu(data->intersection[i].distance);
+                data->intersection[i].featureIndex = __be32_to_cpu(data->intersection[i].featureIndex);
+                data->intersection[i].layer        = __be32_to_cpu(data->intersection[i].layer);
+            }
+        }
+
+        static feature_map_intersection_data* parse(RackMessage *msgInfo)
+        {
+            if (!msgInfo->p_data)
+                return NULL;
+
+            feature_map_intersection_data *p_data =
+                                (feature_map_intersection_data *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+
+        static size_t getDatalen(feature_map_intersection_data *data)
+        {
+            return (sizeof(feature_map_intersection_data) +
+                    data->intersectionNum * sizeof(feature_map_intersection));
+        }
+};
+
+
 //######################################################################
 //# FeatureMap Proxy Functions
 //######################################################################
@@ -358,9 +641,14 @@ class FeatureMapProxy : public RackDataProxy {
     int getData(feature_map_data *recv_data, ssize_t recv_datalen,
                 rack_time_t timeStamp, uint64_t reply_timeout_ns);
 
-/*
- * loadMap, addLine etc. implementieren
- */
+    int loadMap(feature_map_filename *recv_data, ssize_t recv_datalen,
+                uint64_t reply_timeout_ns);
+
+    int loadMap(feature_map_filename *recv_data, ssize_t recv_datalen)
+    {
+        return loadMap(recv_data, recv_datalen, dataTimeout);
+    }
+
     int addLine(feature_map_feature *recv_data, ssize_t recv_datalen,
                        uint64_t reply_timeout_ns);
 
@@ -409,6 +697,36 @@ class FeatureMapProxy : public RackDataProxy {
 
     int setLayer(feature_map_layer_data *recv_data, ssize_t recv_datalen,
                  uint64_t reply_timeout_ns);
+
+//
+// map queries, answered from the spatial index of the FeatureMap module
+//
+
+    int getNearest(feature_map_query *query, feature_map_nearest_data *recv_data)
+    {
+        return getNearest(query, recv_data, dataTimeout);
+    }
+
+    int getNearest(feature_map_query *query, feature_map_nearest_data *recv_data,
+                   uint64_t reply_timeout_ns);
+
+    int getRegion(feature_map_query *query, feature_map_region_data *recv_data,
+                  ssize_t recv_datalen)
+    {
+        return getRegion(query, recv_data, recv_datalen, dataTimeout);
+    }
+
+    int getRegion(feature_map_query *query, feature_map_region_data *recv_data,
+                  ssize_t recv_datalen, uint64_t reply_timeout_ns);
+
+    int getIntersection(feature_map_query *query, feature_map_intersection_data *recv_data,
+                        ssize_t recv_datalen)
+    {
+        return getIntersection(query, recv_data, recv_datalen, dataTimeout);
+    }
+
+    int getIntersection(feature_map_query *query, feature_map_intersection_data *recv_data,
+                        ssize_t recv_datalen, uint64_t reply_timeout_ns);
 };
 
 #endif // __FEATURE_MAP_PROXY_H__
@@ -0,0 +1,500 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#include "odometry_scan_match.h"
+#include <main/angle_tool.h>
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "scan2dSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the scan2d module", { 0 } },
+
+    { ARGOPT_REQ, "scan2dInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the scan2d module", { -1 } },
+
+    { ARGOPT_OPT, "pointMax", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum number of matched points per scan, default 1000", { 1000 } },
+
+    { ARGOPT_OPT, "maxIterations", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum number of ICP iterations, default 20", { 20 } },
+
+    { ARGOPT_OPT, "maxDistance", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Pairing distance of the first iteration in mm, default 500", { 500 } },
+
+    { ARGOPT_OPT, "minDistance", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Final pairing distance in mm, default 50", { 50 } },
+
+    { ARGOPT_OPT, "lineDistance", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum distance of neighbouring points of a line in mm, default 300", { 300 } },
+
+    { ARGOPT_OPT, "minMatch", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Minimum of paired points in percent, default 30", { 30 } },
+
+    { ARGOPT_OPT, "keyDistance", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Distance to the key scan for a new key scan in mm, default 200", { 200 } },
+
+    { ARGOPT_OPT, "keyAngle", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Angle to the key scan for a new key scan in deg, default 10", { 10 } },
+
+    { ARGOPT_OPT, "usePrior", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Initial guess, 0 = last motion, 1 = motion of the scan refPos, default 1", { 1 } },
+
+    { ARGOPT_OPT, "initPosX", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The x-coordinate of the initial position in mm, default 0", { 0 } },
+
+    { ARGOPT_OPT, "initPosY", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The y-coordinate of the initial position in mm, default 0", { 0 } },
+
+    { ARGOPT_OPT, "initPosRho", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The rho-coordinate of the initial position in deg, default 0", { 0 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+
+int  OdometryScanMatch::moduleOn(void)
+{
+    int ret;
+
+    // get dynamic module parameter
+    maxIterations = getInt32Param("maxIterations");
+    maxDistance   = (double)getInt32Param("maxDistance");
+    minDistance   = (double)getInt32Param("minDistance");
+    lineDistance  = (float)getInt32Param("lineDistance");
+    minMatch      = getInt32Param("minMatch");
+    keyDistance   = (double)getInt32Param("keyDistance");
+    keyAngle      = (double)getInt32Param("keyAngle") * M_PI / 180.0;
+    usePrior      = getInt32Param("usePrior");
+
+    positionX     = (double)getInt32Param("initPosX");
+    positionY     = (double)getInt32Param("initPosY");
+    positionRho   = (double)getInt32Param("initPosRho") * M_PI / 180.0;
+    keyValid      = 0;
+    resetPosition = 0;
+
+    GDOS_DBG_INFO("Turn on Scan2d(%d/%d)...\n", scan2dSys, scan2dInst);
+    ret = scan2d->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on Scan2d(%d/%d), code = %d \n", scan2dSys, scan2dInst, ret);
+        return ret;
+    }
+
+    dataMbx.clean();
+
+    GDOS_DBG_INFO("Requesting continuous data from Scan2d(%d/%d)...\n", scan2dSys, scan2dInst);
+    ret = scan2d->getContData(0, &dataMbx, &dataBufferPeriodTime);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get continuous data from Scan2d(%d/%d), "
+                   "code = %d \n", scan2dSys, scan2dInst, ret);
+        return ret;
+    }
+
+    return RackDataModule::moduleOn();    // has to be last command in moduleOn();
+}
+
+void OdometryScanMatch::moduleOff(void)
+{
+    RackDataModule::moduleOff();          // has to be first command in moduleOff();
+
+    scan2d->stopContData(&dataMbx);
+}
+
+int  OdometryScanMatch::moduleLoop(void)
+{
+    int             ret, pointNum, keyScan;
+    RackMessage     msgInfo;
+    scan2d_data     *scanData;
+    odometry_data   *p_odo;
+    double          tx, ty, trho, dx, dy, c, s;
+    double          guessX, guessY, guessRho;
+
+    p_odo = (odometry_data *)getDataBufferWorkSpace();
+
+    // get scan2d data, the scan is processed inside the mailbox buffer
+    ret = dataMbx.peekTimed(rackTime.toNano(2 * dataBufferPeriodTime), &msgInfo);
+    if (ret)
+    {
+        GDOS_ERROR("Can't receive scan2d data on DATA_MBX, code = %d \n", ret);
+        return ret;
+    }
+
+    if ((msgInfo.getType() != MSG_DATA) ||
+        (msgInfo.getSrc()  != scan2d->getDestAdr()))
+    {
+        GDOS_ERROR("Received unexpected message from %n to %n type %d on "
+                   "data mailbox\n", msgInfo.getSrc(), msgInfo.getDest(), msgInfo.getType());
+
+        dataMbx.peekEnd();
+        return -EINVAL;
+    }
+
+    scanData = Scan2dData::parse(&msgInfo);
+
+    if (scanData->pointNum > SCAN2D_POINT_MAX)
+    {
+        GDOS_ERROR("PointNum (%d) exceeds max array size (%d)\n", scanData->pointNum,
+                   SCAN2D_POINT_MAX);
+        dataMbx.peekEnd();
+        return -EINVAL;
+    }
+
+    if (resetPosition)
+    {
+        positionX     = 0.0;
+        positionY     = 0.0;
+        positionRho   = 0.0;
+        keyValid      = 0;
+        resetPosition = 0;
+    }
+
+    pointNum = getScanPoints(scanData);
+
+    if (!keyValid)
+    {
+        setKeyScan(scanData, pointNum);
+    }
+    else
+    {
+        // initial guess in the frame of the key scan
+        if (usePrior)
+        {
+            dx   = scanData->refPos.x - keyRefPos.x;
+            dy   = scanData->refPos.y - keyRefPos.y;
+            c    = cos(keyRefPos.rho);
+            s    = sin(keyRefPos.rho);
+            guessX   =  c * dx + s * dy;
+            guessY   = -s * dx + c * dy;
+            guessRho = normaliseAngleSym0((double)(scanData->refPos.rho - keyRefPos.rho));
+        }
+        else
+        {
+            guessX   = lastX;
+            guessY   = lastY;
+            guessRho = lastRho;
+        }
+
+        tx   = guessX;
+        ty   = guessY;
+        trho = guessRho;
+
+        ret = icp->match(scanX, scanY, pointNum, maxIterations, maxDistance, minDistance,
+                         &tx, &ty, &trho);
+
+        keyScan = 0;
+        if ((ret < 0) || (ret * 100 < minMatch * pointNum))
+        {
+            GDOS_DBG_INFO("Can't match scan %u (%d of %d points), using the guess\n",
+                          scanData->recordingTime, ret, pointNum);
+            tx   = guessX;
+            ty   = guessY;
+            trho = guessRho;
+            keyScan = 1;
+        }
+
+        trho = normaliseAngleSym0(trho);
+
+        // odometry position = key position + motion since the key scan
+        c           = cos(keyPosRho);
+        s           = sin(keyPosRho);
+        positionX   = keyPosX + c * tx - s * ty;
+        positionY   = keyPosY + s * tx + c * ty;
+        positionRho = normaliseAngle(keyPosRho + trho);
+
+        lastX   = tx;
+        lastY   = ty;
+        lastRho = trho;
+
+        if (keyScan || (tx * tx + ty * ty > keyDistance * keyDistance) ||
+            (fabs(trho) > keyAngle))
+        {
+            setKeyScan(scanData, pointNum);
+        }
+    }
+
+    p_odo->recordingTime = scanData->recordingTime;
+    p_odo->pos.x         = (int)rint(positionX);
+    p_odo->pos.y         = (int)rint(positionY);
+    p_odo->pos.z         = 0;
+    p_odo->pos.phi       = 0.0f;
+    p_odo->pos.psi       = 0.0f;
+    p_odo->pos.rho       = positionRho;
+
+    dataMbx.peekEnd();
+
+    GDOS_DBG_DETAIL("recordingTime %i x %i y %i rho %a\n",
+                    p_odo->recordingTime, p_odo->pos.x, p_odo->pos.y, p_odo->pos.rho);
+
+    putDataBufferWorkSpace(sizeof(odometry_data));
+
+    return 0;
+}
+
+int  OdometryScanMatch::moduleCommand(RackMessage *msgInfo)
+{
+    switch(msgInfo->getType())
+    {
+        // the data task resets the position with the next scan
+        case MSG_ODOMETRY_RESET:
+            resetPosition = 1;
+
+            cmdMbx.sendMsgReply(MSG_OK, msgInfo);
+            break;
+
+        default:
+            // not for me -> ask RackDataModule
+            return RackDataModule::moduleCommand(msgInfo);
+      }
+      return 0;
+}
+
+// valid points of the scan in scan order, reduced to pointMax points
+int OdometryScanMatch::getScanPoints(scan2d_data *scanData)
+{
+    scan_point  *point;
+    int         i, step, num = 0;
+
+    step = (scanData->pointNum + pointMax - 1) / pointMax;
+    step = (step < 1) ? 1 : step;
+
+    for (i = 0; (i < scanData->pointNum) && (num < pointMax); i += step)
+    {
+        point = &scanData->point[i];
+
+        if ((point->type & (SCAN_POINT_TYPE_INVALID | SCAN_POINT_TYPE_MAX_RANGE)) ||
+            ((point->x == 0) && (point->y == 0)))
+        {
+            continue;
+        }
+
+        scanX[num] = (float)point->x;
+        scanY[num] = (float)point->y;
+        num++;
+    }
+    return num;
+}
+
+void OdometryScanMatch::setKeyScan(scan2d_data *scanData, int pointNum)
+{
+    icp->setReference(scanX, scanY, pointNum, lineDistance);
+
+    keyPosX   = positionX;
+    keyPosY   = positionY;
+    keyPosRho = positionRho;
+    memcpy(&keyRefPos, &scanData->refPos, sizeof(position_3d));
+
+    lastX    = 0.0;
+    lastY    = 0.0;
+    lastRho  = 0.0;
+    keyValid = 1;
+}
+
+/*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+
+// init_flags (for init and cleanup)
+#define INIT_BIT_DATA_MODULE            0
+#define INIT_BIT_MBX_DATA               1
+#define INIT_BIT_MBX_WORK               2
+#define INIT_BIT_PROXY_SCAN2D           3
+#define INIT_BIT_ICP                    4
+#define INIT_BIT_SCAN_BUFFER            5
+
+int  OdometryScanMatch::moduleInit(void)
+{
+    int ret;
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    // work mailbox
+    ret = createMbx(&workMbx, 1, 128, MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_WORK);
+
+    // data mailbox
+    ret = createMbx(&dataMbx, 1, sizeof(scan2d_data_msg),
+                    MBX_IN_USERSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_DATA);
+
+    // create Scan2d Proxy
+    scan2d = new Scan2dProxy(&workMbx, scan2dSys, scan2dInst);
+    if (!scan2d)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_SCAN2D);
+
+    // scan matcher
+    icp = new Scan2dIcp(pointMax);
+    if (!icp || !icp->isValid())
+    {
+        delete icp;
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_ICP);
+
+    // points of the current scan
+    scanX = (float *)malloc(pointMax * sizeof(float));
+    scanY = (float *)malloc(pointMax * sizeof(float));
+    if (!scanX || !scanY)
+    {
+        free(scanX);
+        free(scanY);
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_SCAN_BUFFER);
+
+    return 0;
+
+init_error:
+    moduleCleanup();
+    return ret;
+}
+
+void OdometryScanMatch::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+
+    // free scan buffer
+    if (initBits.testAndClearBit(INIT_BIT_SCAN_BUFFER))
+    {
+        free(scanX);
+        free(scanY);
+    }
+
+    // free scan matcher
+    if (initBits.testAndClearBit(INIT_BIT_ICP))
+    {
+        delete icp;
+    }
+
+    // free proxy
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_SCAN2D))
+    {
+        delete scan2d;
+    }
+
+    // delete data mailbox
+    if (initBits.testAndClearBit(INIT_BIT_MBX_DATA))
+    {
+        destroyMbx(&dataMbx);
+    }
+
+    // delete work mailbox
+    if (initBits.testAndClearBit(INIT_BIT_MBX_WORK))
+    {
+        destroyMbx(&workMbx);
+    }
+}
+
+OdometryScanMatch::OdometryScanMatch()
+      : RackDataModule( MODULE_CLASS_ID,
+                    2000000000llu,    // 2s datatask error sleep time
+                    16,               // command mailbox slots
+                    48,               // command mailbox data size per slot
+                    MBX_IN_KERNELSPACE | MBX_SLOT,  // command mailbox flags
+                    1000,             // max buffer entries
+                    10)               // data buffer listener
+{
+    // get static module parameter
+    scan2dSys  = getIntArg("scan2dSys", argTab);
+    scan2dInst = getIntArg("scan2dInst", argTab);
+    pointMax   = getIntArg("pointMax", argTab);
+
+    if (pointMax < 3)
+    {
+        pointMax = 3;
+    }
+
+    dataBufferMaxDataSize = sizeof(odometry_data);
+}
+
+int  main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "OdometryScanMatch");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    // create new OdometryScanMatch
+    OdometryScanMatch *pInst;
+
+    pInst = new OdometryScanMatch();
+    if (!pInst)
+    {
+        printf("Can't create new OdometryScanMatch -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // init
+    ret = pInst->moduleInit();
+    if (ret)
+        goto exit_error;
+
+    pInst->run();
+
+    return 0;
+
+exit_error:
+
+    delete (pInst);
+    return ret;
+}
@@ -0,0 +1,100 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __ODOMETRY_SCAN_MATCH_H__
+#define __ODOMETRY_SCAN_MATCH_H__
+
+#include <main/rack_data_module.h>
+#include <navigation/odometry_proxy.h>
+#include <perception/scan2d_proxy.h>
+
+#include "scan2d_icp.h"
+
+// define module class
+#define MODULE_CLASS_ID                 ODOMETRY
+
+typedef struct {
+    scan2d_data     data;
+    scan_point      point[SCAN2D_POINT_MAX];
+} __attribute__((packed)) scan2d_data_msg;
+
+/**
+ * Odometry Scan Match
+ *
+ * Registers each scan of a Scan2d module to a key scan (Scan2dIcp) and
+ * publishes the resulting motion as odometry_data. A new key scan is taken
+ * after keyDistance or keyAngle, so a standing robot doesn't integrate the
+ * noise of each scan. The motion of the scan2d refPos is the initial guess,
+ * e.g. the wheel odometry of the scan. If a scan can't be matched the guess
+ * is used.
+ *
+ * The scans are reduced to pointMax points, so the time of a match is
+ * bounded and no memory is allocated after moduleInit.
+ *
+ * @ingroup modules_odometry
+ */
+class OdometryScanMatch : public RackDataModule {
+    private:
+        int                 scan2dSys;
+        int                 scan2dInst;
+        int                 pointMax;
+
+        int                 maxIterations;
+        double              maxDistance;
+        double              minDistance;
+        float               lineDistance;
+        int                 minMatch;
+        double              keyDistance;
+        double              keyAngle;
+        int                 usePrior;
+
+        Scan2dIcp           *icp;
+        float               *scanX;
+        float               *scanY;
+
+        int                 keyValid;
+        double              keyPosX, keyPosY, keyPosRho;    // odometry position of the key scan
+        position_3d         keyRefPos;                      // refPos of the key scan
+        double              lastX, lastY, lastRho;          // motion since the key scan
+        double              positionX, positionY, positionRho;
+        volatile int        resetPosition;
+
+        // mailboxes
+        RackMailbox         dataMbx;
+        RackMailbox         workMbx;
+
+        // proxies
+        Scan2dProxy*        scan2d;
+
+        int     getScanPoints(scan2d_data *scanData);
+        void    setKeyScan(scan2d_data *scanData, int pointNum);
+
+      protected:
+        // -> realtime context
+        int      moduleOn(void);
+        int      moduleLoop(void);
+        void     moduleOff(void);
+        int      moduleCommand(RackMessage *msgInfo);
+
+        // -> non realtime context
+        void     moduleCleanup(void);
+
+      public:
+        // constructor und destructor
+        OdometryScanMatch();
+        ~OdometryScanMatch() {};
+
+        // -> non realtime context
+        int  moduleInit(void);
+};
+
+#endif // __ODOMETRY_SCAN_MATCH_H__
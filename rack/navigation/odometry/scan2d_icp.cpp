@@ -0,0 +1,333 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+
+#include "scan2d_icp.h"
+
+Scan2dIcp::Scan2dIcp(int pointMax)
+{
+    this->pointMax = pointMax;
+
+    refX   = (float *)malloc(pointMax * sizeof(float));
+    refY   = (float *)malloc(pointMax * sizeof(float));
+    refNX  = (float *)malloc(pointMax * sizeof(float));
+    refNY  = (float *)malloc(pointMax * sizeof(float));
+    refDim = (char *)malloc(pointMax * sizeof(char));
+    refNum = 0;
+}
+
+Scan2dIcp::~Scan2dIcp()
+{
+    free(refX);
+    free(refY);
+    free(refNX);
+    free(refNY);
+    free(refDim);
+}
+
+// partial sort of [lo, hi), the k-th point in dimension dim is in place
+void Scan2dIcp::select(int lo, int hi, int k, int dim)
+{
+    float   *v = dim ? refY : refX;
+    float   pivot, t;
+    int     i, j;
+
+    hi--;
+    while (lo < hi)
+    {
+        pivot = v[(lo + hi) / 2];
+        i     = lo;
+        j     = hi;
+
+        while (i <= j)
+        {
+            while (v[i] < pivot)
+            {
+                i++;
+            }
+            while (v[j] > pivot)
+            {
+                j--;
+            }
+            if (i <= j)
+            {
+                t = refX[i]; refX[i] = refX[j]; refX[j] = t;
+                t = refY[i]; refY[i] = refY[j]; refY[j] = t;
+                t = refNX[i]; refNX[i] = refNX[j]; refNX[j] = t;
+                t = refNY[i]; refNY[i] = refNY[j]; refNY[j] = t;
+                i++;
+                j--;
+            }
+        }
+
+        if (k <= j)
+        {
+            hi = j;
+        }
+        else if (k >= i)
+        {
+            lo = i;
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+void Scan2dIcp::buildTree(int lo, int hi)
+{
+    float   xMin, xMax, yMin, yMax;
+    int     i, mid, dim;
+
+    if (hi - lo <= 0)
+    {
+        return;
+    }
+
+    // split the longer side
+    xMin = xMax = refX[lo];
+    yMin = yMax = refY[lo];
+    for (i = lo + 1; i < hi; i++)
+    {
+        xMin = (refX[i] < xMin) ? refX[i] : xMin;
+        xMax = (refX[i] > xMax) ? refX[i] : xMax;
+        yMin = (refY[i] < yMin) ? refY[i] : yMin;
+        yMax = (refY[i] > yMax) ? refY[i] : yMax;
+    }
+    dim = (yMax - yMin > xMax - xMin) ? 1 : 0;
+
+    mid = (lo + hi) / 2;
+    select(lo, hi, mid, dim);
+    refDim[mid] = dim;
+
+    buildTree(lo, mid);
+    buildTree(mid + 1, hi);
+}
+
+void Scan2dIcp::setReference(const float *x, const float *y, int num, float lineDistance)
+{
+    float   dx, dy, l, d2 = lineDistance * lineDistance;
+    int     i, a, b;
+
+    refNum = (num < pointMax) ? num : pointMax;
+
+    memcpy(refX, x, refNum * sizeof(float));
+    memcpy(refY, y, refNum * sizeof(float));
+
+    // normals of the lines through the neighbours, before the tree reorders
+    for (i = 0; i < refNum; i++)
+    {
+        a = i;
+        b = i;
+        if ((i > 0) &&
+            ((x[i] - x[i - 1]) * (x[i] - x[i - 1]) + (y[i] - y[i - 1]) * (y[i] - y[i - 1]) < d2))
+        {
+            a = i - 1;
+        }
+        if ((i < refNum - 1) &&
+            ((x[i + 1] - x[i]) * (x[i + 1] - x[i]) + (y[i + 1] - y[i]) * (y[i + 1] - y[i]) < d2))
+        {
+            b = i + 1;
+        }
+
+        dx = x[b] - x[a];
+        dy = y[b] - y[a];
+        l  = sqrtf(dx * dx + dy * dy);
+
+        refNX[i] = (l > 0.0f) ? -dy / l : 0.0f;
+        refNY[i] = (l > 0.0f) ?  dx / l : 0.0f;
+    }
+
+    buildTree(0, refNum);
+}
+
+void Scan2dIcp::search(int lo, int hi)
+{
+    float   dx, dy, d2, diff;
+    int     mid;
+
+    while (hi - lo > 0)
+    {
+        mid = (lo + hi) / 2;
+        dx  = refX[mid] - searchX;
+        dy  = refY[mid] - searchY;
+        d2  = dx * dx + dy * dy;
+
+        if (d2 < bestDist2)
+        {
+            bestDist2 = d2;
+            best      = mid;
+        }
+
+        diff = refDim[mid] ? (searchY - refY[mid]) : (searchX - refX[mid]);
+
+        // near side first, the far side only if the split is within reach
+        if (diff < 0.0f)
+        {
+            if (diff * diff < bestDist2)
+            {
+                search(mid + 1, hi);
+            }
+            hi = mid;
+        }
+        else
+        {
+            if (diff * diff < bestDist2)
+            {
+                search(lo, mid);
+            }
+            lo = mid + 1;
+        }
+    }
+}
+
+int Scan2dIcp::nearest(float x, float y, float maxDist2)
+{
+    searchX   = x;
+    searchY   = y;
+    bestDist2 = maxDist2;
+    best      = -1;
+
+    search(0, refNum);
+    return best;
+}
+
+// adds the rows of a residual to the normal equations
+static inline void addRow(double *a, double *b, double j0, double j1, double j2, double e)
+{
+    a[0] += j0 * j0;
+    a[1] += j0 * j1;
+    a[2] += j0 * j2;
+    a[4] += j1 * j1;
+    a[5] += j1 * j2;
+    a[8] += j2 * j2;
+    b[0] += j0 * e;
+    b[1] += j1 * e;
+    b[2] += j2 * e;
+}
+
+int Scan2dIcp::match(const float *x, const float *y, int num,
+                     int maxIterations, double maxDistance, double minDistance,
+                     double *tx, double *ty, double *trho)
+{
+    double  c, s, px, py, ex, ey, nx, ny, dist;
+    double  a[9], b[3], l[9], z[3], d[3], reg, t;
+    int     i, j, k, it, pairNum = 0;
+
+    if ((refNum < 3) || (num < 3))
+    {
+        return -EINVAL;
+    }
+
+    dist = maxDistance;
+
+    for (it = 0; it < maxIterations; it++)
+    {
+        c = cos(*trho);
+        s = sin(*trho);
+
+        memset(a, 0, sizeof(a));
+        memset(b, 0, sizeof(b));
+        pairNum = 0;
+
+        // linearised residuals of the increment (dx, dy, dRho)
+        for (i = 0; i < num; i++)
+        {
+            px = c * x[i] - s * y[i] + *tx;
+            py = s * x[i] + c * y[i] + *ty;
+
+            j = nearest((float)px, (float)py, (float)(dist * dist));
+            if (j < 0)
+            {
+                continue;
+            }
+            pairNum++;
+
+            ex = px - refX[j];
+            ey = py - refY[j];
+            nx = refNX[j];
+            ny = refNY[j];
+
+            if ((nx != 0.0) || (ny != 0.0))
+            {
+                addRow(a, b, nx, ny, ny * px - nx * py, nx * ex + ny * ey);
+            }
+            else
+            {
+                addRow(a, b, 1.0, 0.0, -py, ex);
+                addRow(a, b, 0.0, 1.0,  px, ey);
+            }
+        }
+
+        if (pairNum < 3)
+        {
+            return -EINVAL;
+        }
+
+        // a small regularisation keeps unconstrained directions
+        reg   = 1e-9 * (a[0] + a[4]) + 1e-12;
+        a[0] += reg;
+        a[4] += reg;
+        a[8] += reg * 1e-6;
+
+        // solve a * d = -b (cholesky of the symmetric 3x3 matrix)
+        l[0] = sqrt(a[0]);
+        l[3] = a[1] / l[0];
+        l[6] = a[2] / l[0];
+        t    = a[4] - l[3] * l[3];
+        if (t <= 0.0)
+        {
+            return -EINVAL;
+        }
+        l[4] = sqrt(t);
+        l[7] = (a[5] - l[6] * l[3]) / l[4];
+        t    = a[8] - l[6] * l[6] - l[7] * l[7];
+        if (t <= 0.0)
+        {
+            return -EINVAL;
+        }
+        l[8] = sqrt(t);
+
+        z[0] = -b[0] / l[0];
+        z[1] = (-b[1] - l[3] * z[0]) / l[4];
+        z[2] = (-b[2] - l[6] * z[0] - l[7] * z[1]) / l[8];
+        d[2] = z[2] / l[8];
+        d[1] = (z[1] - l[7] * d[2]) / l[4];
+        d[0] = (z[0] - l[3] * d[1] - l[6] * d[2]) / l[0];
+
+        // apply the increment to the transformation
+        c     = cos(d[2]);
+        s     = sin(d[2]);
+        t     = c * *tx - s * *ty + d[0];
+        *ty   = s * *tx + c * *ty + d[1];
+        *tx   = t;
+        *trho = *trho + d[2];
+
+        k = (fabs(d[0]) < 1.0) && (fabs(d[1]) < 1.0) && (fabs(d[2]) < 0.0005);
+        if (k && (dist <= minDistance))
+        {
+            break;
+        }
+
+        // shrink the pairing distance once the increment gets small
+        if (k || (fabs(d[0]) + fabs(d[1]) < 0.25 * dist))
+        {
+            dist = (dist * 0.5 > minDistance) ? dist * 0.5 : minDistance;
+        }
+    }
+    return pairNum;
+}
@@ -0,0 +1,114 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __SCAN2D_ICP_H__
+#define __SCAN2D_ICP_H__
+
+/**
+ * Point to line ICP of two 2d scans.
+ *
+ * Each reference point gets the normal of the line through its neighbours
+ * in scan order, a point is paired with the line of its nearest reference
+ * point. Unlike point to point pairs this doesn't stick to the sampling of
+ * a wall. Reference points without a neighbour are used as points.
+ *
+ * The points of the reference scan are stored in a k-d tree (median split,
+ * stored in place), so a nearest neighbour costs about log2(n) steps. All
+ * memory is allocated by the constructor, a match takes at most
+ * maxIterations * pointNum nearest neighbour searches.
+ *
+ * @ingroup modules_odometry
+ */
+class Scan2dIcp
+{
+    private:
+        int     pointMax;
+
+        // k-d tree of the reference scan, node of [lo, hi) is (lo + hi) / 2
+        float   *refX;
+        float   *refY;
+        float   *refNX;                 // normal, (0, 0) if there is none
+        float   *refNY;
+        char    *refDim;
+        int     refNum;
+
+        // nearest neighbour search
+        float   searchX;
+        float   searchY;
+        float   bestDist2;
+        int     best;
+
+        void    buildTree(int lo, int hi);
+        void    select(int lo, int hi, int k, int dim);
+        void    search(int lo, int hi);
+
+    public:
+
+        Scan2dIcp(int pointMax);
+        ~Scan2dIcp();
+
+        /** 1 if the memory could be allocated */
+        int     isValid(void)
+        {
+            return (refX && refY && refNX && refNY && refDim);
+        }
+
+        /**
+         * @brief Set the reference scan
+         *
+         * At most pointMax points are used. The points have to be in scan
+         * order, neighbours within @a lineDistance form a line.
+         */
+        void    setReference(const float *x, const float *y, int num, float lineDistance);
+
+        /** number of points of the reference scan */
+        int     getReferenceNum(void)
+        {
+            return refNum;
+        }
+
+        /**
+         * @brief Nearest point of the reference scan
+         *
+         * @return index of the point, -1 if no point is closer than
+         *         sqrt(maxDist2)
+         */
+        int     nearest(float x, float y, float maxDist2);
+
+        /**
+         * @brief Register a scan to the reference scan
+         *
+         * The transformation maps the points of the scan into the frame of
+         * the reference scan: p_ref = R(rho) * p + (x, y). The pairing
+         * distance is halved from @a maxDistance down to @a minDistance as
+         * the steps get small. A direction without constraints (e.g. along
+         * a corridor) keeps its initial guess.
+         *
+         * @param x Points of the scan
+         * @param y Points of the scan
+         * @param num Number of points
+         * @param maxIterations Maximum number of iterations
+         * @param maxDistance [mm] pairing distance of the first iteration
+         * @param minDistance [mm] final pairing distance
+         * @param tx [mm] initial guess, returns the transformation
+         * @param ty [mm] initial guess, returns the transformation
+         * @param trho [rad] initial guess, returns the transformation
+         *
+         * @return number of paired points of the last iteration, -EINVAL
+         *         if the scans can't be registered
+         */
+        int     match(const float *x, const float *y, int num,
+                      int maxIterations, double maxDistance, double minDistance,
+                      double *tx, double *ty, double *trho);
+};
+
+#endif // __SCAN2D_ICP_H__
@@ -14,6 +14,7 @@
  *
  */
  #include <navigation/odometry_proxy.h>
+#include <main/angle_tool.h>
 
 
 int OdometryProxy::getData(odometry_data *recv_data, ssize_t recv_datalen,
@@ -31,3 +32,99 @@ int OdometryProxy::getData(odometry_data *recv_data, ssize_t recv_datalen,
     recv_data = OdometryData::parse(&msgInfo);
     return 0;
 }
+
+int OdometryProxy::getMultiData(odometry_data *recv_data, rack_time_t *timeStamp,
+                                int timeNum, int interpol, uint64_t reply_timeout_ns)
+{
+    uint8_t         buffer[sizeof(rack_multi_data) + 2 * RACK_MULTI_DATA_TIME_MAX *
+                           (sizeof(uint32_t) + sizeof(odometry_data))];
+    RackMessage     msgInfo;
+    rack_multi_data *p_multi;
+    odometry_data   *odometryA, *odometryB, *odometry;
+    rack_time_t     time;
+    float           x;
+    int             i, j, n, num, le, ret;
+
+    n = interpol ? 2 : 1;
+
+    for (i = 0; i < timeNum; i += num)
+    {
+        num = (timeNum - i < RACK_MULTI_DATA_TIME_MAX) ?
+              (timeNum - i) : RACK_MULTI_DATA_TIME_MAX;
+
+        ret = RackDataProxy::getMultiData(buffer, sizeof(buffer), &timeStamp[i], num,
+                                          interpol ? RACK_MULTI_DATA_INTERPOL :
+                                                     RACK_MULTI_DATA_NEAREST,
+                                          reply_timeout_ns, &msgInfo);
+        if (ret)
+        {
+            return ret;
+        }
+
+        le      = msgInfo.isDataByteorderLe();
+        p_multi = RackMultiData::parse(&msgInfo);
+        if (!p_multi || (p_multi->entryNum != n * num))
+        {
+            return -EINVAL;
+        }
+
+        for (j = 0; j < num; j++)
+        {
+            if ((p_multi->entrySize[n * j] != sizeof(odometry_data)) ||
+                (p_multi->entrySize[n * j + n - 1] != sizeof(odometry_data)))
+            {
+                return -EINVAL;
+            }
+
+            odometryA = (odometry_data *)RackMultiData::getEntry(p_multi, n * j);
+            odometryB = (odometry_data *)RackMultiData::getEntry(p_multi, n * j + n - 1);
+            odometry  = &recv_data[i + j];
+            time      = timeStamp[i + j];
+
+            if (le)
+            {
+                OdometryData::le_to_cpu(odometryA);
+            }
+            else
+            {
+                OdometryData::be_to_cpu(odometryA);
+            }
+
+            if ((n == 1) || (time == 0) ||
+                (odometryA->recordingTime == time))
+            {
+                memcpy(odometry, odometryA, sizeof(odometry_data));
+                continue;
+            }
+
+            if (le)
+            {
+                OdometryData::le_to_cpu(odometryB);
+            }
+            else
+            {
+                OdometryData::be_to_cpu(odometryB);
+            }
+
+            if (odometryB->recordingTime == odometryA->recordingTime)
+            {
+                memcpy(odometry, odometryA, sizeof(odometry_data));
+                continue;
+            }
+
+            // like OdometryChassis::sendDataReply()
+            odometry->recordingTime = time;
+            x = (float)((int)time - (int)odometryA->recordingTime) / (float)((int)odometryB->recordingTime - (int)odometryA->recordingTime);
+
+            odometry->pos.x = odometryA->pos.x + (int)(x * (float)(odometryB->pos.x - odometryA->pos.x));
+            odometry->pos.y = odometryA->pos.y + (int)(x * (float)(odometryB->pos.y - odometryA->pos.y));
+            odometry->pos.z = odometryA->pos.z + (int)(x * (float)(odometryB->pos.z - odometryA->pos.z));
+
+            odometry->pos.phi = normaliseAngleSym0(odometryA->pos.phi + (x * normaliseAngleSym0((float)(odometryB->pos.phi - odometryA->pos.phi))));
+            odometry->pos.psi = normaliseAngleSym0(odometryA->pos.psi + (x * normaliseAngleSym0((float)(odometryB->pos.psi - odometryA->pos.psi))));
+            odometry->pos.rho = normaliseAngle(odometryA->pos.rho + (x * normaliseAngleSym0((float)(odometryB->pos.rho - odometryA->pos.rho))));
+        }
+    }
+
+    return 0;
+}
@@ -106,6 +106,25 @@ class OdometryProxy : public RackDataProxy {
     int getData(odometry_data *recv_data, ssize_t recv_datalen,
                 rack_time_t timeStamp, uint64_t reply_timeout_ns);
 
+    /**
+     * @brief Odometry data of several timestamps
+     *
+     * Gets the data of up to RACK_MULTI_DATA_TIME_MAX timestamps per
+     * request (MSG_GET_MULTI_DATA). With @a interpol the position is
+     * interpolated between the data before and after each timestamp,
+     * otherwise it is the data next to the timestamp.
+     *
+     * @param recv_data Gets @a timeNum odometry data
+     */
+    int getMultiData(odometry_data *recv_data, rack_time_t *timeStamp,
+                     int timeNum, int interpol)
+    {
+      return getMultiData(recv_data, timeStamp, timeNum, interpol, dataTimeout);
+    }
+
+    int getMultiData(odometry_data *recv_data, rack_time_t *timeStamp,
+                     int timeNum, int interpol, uint64_t reply_timeout_ns);
+
     int reset(void)
     {
       return reset(dataTimeout);
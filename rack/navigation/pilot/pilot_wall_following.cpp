@@ -51,7 +51,7 @@ arg_table_t argTab[] = {
       "Maximum omega, default 20 deg/s", { 20 } },
 
     { ARGOPT_OPT, "mode", ARGOPT_REQVAL, ARGOPT_VAL_INT,
-      "Wall following mode  (default 1)", { 1 } },
+      "Wall following mode, 0: wall following, 1: Braitenberg, 2: dynamic window (default 1)", { 1 } },
 
     { ARGOPT_OPT, "distance", ARGOPT_REQVAL, ARGOPT_VAL_INT,
       "distance  (default 1000)", { 1000 } },
@@ -205,6 +205,14 @@ int  PilotWallFollowing::moduleLoop(void)
         memcpy(&scan2dMsg.data, pS2dData, sizeof(scan2d_data) +
                pS2dData->pointNum * sizeof(scan_point));
 
+        // all collision tests of this cycle use the grid
+        ret = collisionGrid.build(&scan2dMsg.data);
+        if (ret)
+        {
+            GDOS_ERROR("Can't build collision grid, code = %d\n", ret);
+            return ret;
+        }
+
         GDOS_DBG_DETAIL("mode:%d  globalState:%i preState:%d subState:%d\n", mode, globalState, preState, subState);
 
         // switch pilot modes
@@ -219,6 +227,9 @@ int  PilotWallFollowing::moduleLoop(void)
                     case 1:
                         ret = modeWallFollowingBraitenberger(&globalState);
                         break;
+                    case 2:
+                        ret = modeDynamicWindowApproach(&globalState);
+                        break;
                     default:
                         mode = 0;
                 }
@@ -233,6 +244,9 @@ int  PilotWallFollowing::moduleLoop(void)
                     case 1:
                         ret = modeWallFollowingBraitenberger(&globalState);
                         break;
+                    case 2:
+                        ret = modeDynamicWindowApproach(&globalState);
+                        break;
                     default:
                         mode = 0;
                 }
@@ -247,6 +261,9 @@ int  PilotWallFollowing::moduleLoop(void)
                     case 1:
                         ret = modeWallFollowingBraitenberger(&globalState);
                         break;
+                    case 2:
+                        ret = modeDynamicWindowApproach(&globalState);
+                        break;
                     default:
                         mode = 0;
                 }
@@ -299,34 +316,11 @@ int  PilotWallFollowing::moduleCommand(RackMessage *msgInfo)
 }
 
 
+// scan has to be the scan of the collision grid. All obstacle points are
+// tested, the former point loop only tested every second point.
 int  PilotWallFollowing::testRec(int x, int y, int xSize, int ySize, scan2d_data *scan)
 {
-    int   test;
-    int   i;
-    int   xMiddle;
-    int   yMiddle;
-    int   xDistance;
-    int   yDistance;
-
-    xMiddle = (2 * x + xSize) / 2;
-    yMiddle = (2 * y + ySize) / 2;
-    xDistance = abs(xSize / 2);
-    yDistance = abs(ySize / 2);
-
-    test = 0;
-
-    for (i = 0; i < scan->pointNum; i += 2)
-    {
-        if (((scan->point[i].type & SCAN_POINT_TYPE_INVALID) == 0) &
-           ((scan->point[i].type & SCAN_POINT_TYPE_MASK) != SCAN_POINT_TYPE_LANDMARK))
-            if ((abs(scan->point[i].x - xMiddle) <= xDistance) && (abs(scan->point[i].y - yMiddle) <= yDistance))
-            {
-                test = 1;
-                break;
-            }
-    }
-
-    return test;
+    return collisionGrid.testRect(x, y, xSize, ySize);
 }
 
 
@@ -1766,6 +1760,76 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
 }
 
 
+// drives forward along the best trajectory of the dynamic window,
+// state 1 turns towards the side with more clearance until the way is free
+int  PilotWallFollowing::modeDynamicWindowApproach(int* state)
+{
+    int     ret;
+    int     speed, halfWidth;
+    float   goalAngle, cycleTime;
+
+    switch (*state)
+    {
+        case 0:
+            goalAngle = 0.0f;
+            break;
+
+        case 1:
+            goalAngle = (rightRot > leftRot) ? (float)M_PI_2 : -(float)M_PI_2;
+            break;
+
+        default:
+            *state   = 0;
+            subState = 0;
+            preState = 0;
+            return 0;
+    }
+
+    speed     = globalSpeed;
+    cycleTime = (float)dataBufferPeriodTime / 1000.0f;
+    halfWidth = (chasParData.boundaryLeft > chasParData.boundaryRight ?
+                 chasParData.boundaryLeft : chasParData.boundaryRight) +
+                chasParData.safetyMargin;
+
+    ret = dynamicWindow.evaluate(&collisionGrid, &chasParData, &speed, &omega,
+                                 maxSpeed, omegaMaxRad, goalAngle, cycleTime);
+    if (ret && (ret != -EAGAIN))
+    {
+        GDOS_ERROR("Can't evaluate dynamic window, code = %d\n", ret);
+        return ret;
+    }
+
+    GDOS_DBG_DETAIL("dynamic window: speed %d omega %a arcs %d\n",
+                    speed, omega, dynamicWindow.getArcNum());
+
+    if ((*state == 0) && (ret || (speed < chasParData.vxMin)))
+    {
+        // blocked, choose the side with more clearance
+        rightRot = collisionGrid.getClearance(0,  chasParData.boundaryRight + testDis, testDis);
+        leftRot  = collisionGrid.getClearance(0, -chasParData.boundaryLeft  - testDis, testDis);
+        *state   = 1;
+    }
+    else if ((*state == 1) &&
+             (collisionGrid.testArc(0.0f, testDis, halfWidth, NULL) >= testDis))
+    {
+        // the way ahead is free again
+        *state = 0;
+    }
+
+    preState = *state;
+
+    ret = chassis->move(speed, 0, omega);
+    if (ret)
+    {
+        GDOS_ERROR("Can't send chassis_move, code = %d\n", ret);
+        return ret;
+    }
+
+    globalSpeed = speed;
+    return 0;
+}
+
+
  /*******************************************************************************
  *   !!! NON REALTIME CONTEXT !!!
  *
@@ -1785,6 +1849,8 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
 #define INIT_BIT_PROXY_SCAN2D       3
 #define INIT_BIT_PROXY_POSITION     4
 #define INIT_BIT_PROXY_CHASSIS      5
+#define INIT_BIT_COLLISION_GRID     6
+#define INIT_BIT_DYNAMIC_WINDOW     7
 
 int  PilotWallFollowing::moduleInit(void)
 {
@@ -1853,6 +1919,24 @@ int  PilotWallFollowing::moduleInit(void)
     }
     initBits.setBit(INIT_BIT_PROXY_CHASSIS);
 
+    // collision grid
+    ret = collisionGrid.init(PILOT_GRID_RANGE_DEFAULT, PILOT_GRID_CELL_SIZE_DEFAULT);
+    if (ret)
+    {
+        GDOS_ERROR("Can't init collision grid, code = %d\n", ret);
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_COLLISION_GRID);
+
+    // dynamic window search of mode 2
+    ret = dynamicWindow.init();
+    if (ret)
+    {
+        GDOS_ERROR("Can't init dynamic window, code = %d\n", ret);
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_DYNAMIC_WINDOW);
+
     return 0;
 
 init_error:
@@ -1868,6 +1952,16 @@ void PilotWallFollowing::moduleCleanup(void)
         RackDataModule::moduleCleanup();
     }
 
+    if (initBits.testAndClearBit(INIT_BIT_DYNAMIC_WINDOW))
+    {
+        dynamicWindow.cleanup();
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_COLLISION_GRID))
+    {
+        collisionGrid.cleanup();
+    }
+
     //
     // free proxies
     //
@@ -100,6 +100,8 @@ class PilotWallFollowing : public RackDataModule {
         chassis_param_data  chasParDataTransBackward;
 
         scan2d_data_msg     scan2dMsg;
+        PilotCollisionGrid  collisionGrid;          // obstacles of scan2dMsg
+        PilotDynamicWindow  dynamicWindow;
 
       protected:
         // -> realtime context
@@ -487,6 +487,13 @@ int  Position::moduleCommand(RackMessage *msgInfo)
                                     sizeof(position_gk_data));
             break;
 
+        case MSG_POSITION_WGS84_TO_POS_ARRAY:
+        case MSG_POSITION_POS_TO_WGS84_ARRAY:
+        case MSG_POSITION_UTM_TO_POS_ARRAY:
+        case MSG_POSITION_POS_TO_UTM_ARRAY:
+        case MSG_POSITION_GK_TO_POS_ARRAY:
+        case MSG_POSITION_POS_TO_GK_ARRAY:
+            return arrayCommand(msgInfo);
 
         default:
             // not for me -> ask RackDataModule
@@ -653,6 +660,262 @@ void    Position::posToWgs84(position_data *posData, position_wgs84_data *posWgs
 }
 
 
+int     Position::arrayCommand(RackMessage *msgInfo)
+{
+    position_array_data         *pPosArray      = NULL;
+    position_wgs84_array_data   *pWgs84Array    = NULL;
+    position_utm_array_data     *pUtmArray      = NULL;
+    position_gk_array_data      *pGkArray       = NULL;
+    int32_t                     pointNum;
+    int                         i;
+
+    switch(msgInfo->getType())
+    {
+        case MSG_POSITION_WGS84_TO_POS_ARRAY:
+        case MSG_POSITION_UTM_TO_POS_ARRAY:
+        case MSG_POSITION_GK_TO_POS_ARRAY:
+            if (msgInfo->getType() == MSG_POSITION_WGS84_TO_POS_ARRAY)
+            {
+                pWgs84Array = PositionWgs84ArrayData::parse(msgInfo);
+                pointNum    = pWgs84Array ? pWgs84Array->pointNum : -1;
+            }
+            else if (msgInfo->getType() == MSG_POSITION_UTM_TO_POS_ARRAY)
+            {
+                pUtmArray   = PositionUtmArrayData::parse(msgInfo);
+                pointNum    = pUtmArray ? pUtmArray->pointNum : -1;
+            }
+            else
+            {
+                pGkArray    = PositionGkArrayData::parse(msgInfo);
+                pointNum    = pGkArray ? pGkArray->pointNum : -1;
+            }
+
+            if (pointNum < 0)
+            {
+                GDOS_WARNING("Invalid position array\n");
+                cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+                break;
+            }
+
+            if (pWgs84Array)
+            {
+                wgs84ToPos(pWgs84Array->point, arrayPos, pointNum);
+            }
+            else if (pUtmArray && (positionReference != POSITION_REFERENCE_UTM))
+            {
+                positionTool->utmToWgs84(pUtmArray->point, arrayWgs84, pointNum);
+                wgs84ToPos(arrayWgs84, arrayPos, pointNum);
+            }
+            else if (pGkArray && (positionReference != POSITION_REFERENCE_GK))
+            {
+                positionTool->gkToWgs84(pGkArray->point, arrayWgs84, pointNum);
+                wgs84ToPos(arrayWgs84, arrayPos, pointNum);
+            }
+            else if (pUtmArray)
+            {
+                for (i = 0; i < pointNum; i++)
+                {
+                    arrayPos[i].x   =  (int)rint(pUtmArray->point[i].northing - offsetNorthing * 1000.0);
+                    arrayPos[i].y   =  (int)rint(pUtmArray->point[i].easting - offsetEasting * 1000.0);
+                    arrayPos[i].z   = -pUtmArray->point[i].altitude;
+                    arrayPos[i].phi = 0.0f;
+                    arrayPos[i].psi = 0.0f;
+                    arrayPos[i].rho = pUtmArray->point[i].heading;
+                }
+            }
+            else
+            {
+                for (i = 0; i < pointNum; i++)
+                {
+                    arrayPos[i].x   =  (int)rint(pGkArray->point[i].northing - offsetNorthing * 1000.0);
+                    arrayPos[i].y   =  (int)rint(pGkArray->point[i].easting - offsetEasting * 1000.0);
+                    arrayPos[i].z   = -pGkArray->point[i].altitude;
+                    arrayPos[i].phi = 0.0f;
+                    arrayPos[i].psi = 0.0f;
+                    arrayPos[i].rho = pGkArray->point[i].heading;
+                }
+            }
+
+            GDOS_DBG_INFO("Array to POS: %d points\n", pointNum);
+            cmdMbx.sendDataMsgReply(MSG_POSITION_POS_ARRAY, msgInfo, 2,
+                                    &pointNum, sizeof(int32_t),
+                                    arrayPos, pointNum * sizeof(position_3d));
+            break;
+
+        case MSG_POSITION_POS_TO_WGS84_ARRAY:
+        case MSG_POSITION_POS_TO_UTM_ARRAY:
+        case MSG_POSITION_POS_TO_GK_ARRAY:
+            pPosArray = PositionArrayData::parse(msgInfo);
+            if (!pPosArray)
+            {
+                GDOS_WARNING("Invalid position array\n");
+                cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+                break;
+            }
+            pointNum = pPosArray->pointNum;
+
+            if (msgInfo->getType() == MSG_POSITION_POS_TO_WGS84_ARRAY)
+            {
+                posToWgs84(pPosArray->point, arrayWgs84, pointNum);
+
+                GDOS_DBG_INFO("POS to WGS84 array: %d points\n", pointNum);
+                cmdMbx.sendDataMsgReply(MSG_POSITION_WGS84_ARRAY, msgInfo, 2,
+                                        &pointNum, sizeof(int32_t),
+                                        arrayWgs84, pointNum * sizeof(position_wgs84_data));
+            }
+            else if (msgInfo->getType() == MSG_POSITION_POS_TO_UTM_ARRAY)
+            {
+                if (positionReference == POSITION_REFERENCE_UTM)
+                {
+                    for (i = 0; i < pointNum; i++)
+                    {
+                        arrayUtm[i].zone     =  utmZone;
+                        arrayUtm[i].band     =  utmBand;
+                        arrayUtm[i].northing =  pPosArray->point[i].x + (int64_t)offsetNorthing * 1000;
+                        arrayUtm[i].easting  =  pPosArray->point[i].y + (int64_t)offsetEasting * 1000;
+                        arrayUtm[i].altitude = -pPosArray->point[i].z;
+                        arrayUtm[i].heading  =  pPosArray->point[i].rho;
+                    }
+                }
+                else
+                {
+                    posToWgs84(pPosArray->point, arrayWgs84, pointNum);
+                    positionTool->wgs84ToUtm(arrayWgs84, arrayUtm, pointNum);
+                }
+
+                GDOS_DBG_INFO("POS to UTM array: %d points\n", pointNum);
+                cmdMbx.sendDataMsgReply(MSG_POSITION_UTM_ARRAY, msgInfo, 2,
+                                        &pointNum, sizeof(int32_t),
+                                        arrayUtm, pointNum * sizeof(position_utm_data));
+            }
+            else
+            {
+                if (positionReference == POSITION_REFERENCE_GK)
+                {
+                    for (i = 0; i < pointNum; i++)
+                    {
+                        arrayGk[i].northing  =  (double)pPosArray->point[i].x + offsetNorthing * 1000.0;
+                        arrayGk[i].easting   =  (double)pPosArray->point[i].y + offsetEasting * 1000.0;
+                        arrayGk[i].altitude  = -pPosArray->point[i].z;
+                        arrayGk[i].heading   =  pPosArray->point[i].rho;
+                    }
+                }
+                else
+                {
+                    posToWgs84(pPosArray->point, arrayWgs84, pointNum);
+                    positionTool->wgs84ToGk(arrayWgs84, arrayGk, pointNum);
+                }
+
+                GDOS_DBG_INFO("POS to GK array: %d points\n", pointNum);
+                cmdMbx.sendDataMsgReply(MSG_POSITION_GK_ARRAY, msgInfo, 2,
+                                        &pointNum, sizeof(int32_t),
+                                        arrayGk, pointNum * sizeof(position_gk_data));
+            }
+            break;
+
+        default:
+            return RackDataModule::moduleCommand(msgInfo);
+    }
+    return 0;
+}
+
+// array version of wgs84ToPos(), the auto offset is taken from the first point
+void    Position::wgs84ToPos(position_wgs84_data *posWgs84, position_3d *pos, int num)
+{
+    position_data   posData;
+    int             i;
+
+    if (num <= 0)
+    {
+        return;
+    }
+
+    // the first point sets the auto offset
+    wgs84ToPos(&posWgs84[0], &posData);
+    memcpy(&pos[0], &posData.pos, sizeof(position_3d));
+
+    switch (positionReference)
+    {
+        case POSITION_REFERENCE_GK:
+            positionTool->wgs84ToGk(&posWgs84[1], arrayGk, num - 1);
+
+            for (i = 1; i < num; i++)
+            {
+                pos[i].x   =  (int)rint(arrayGk[i - 1].northing - offsetNorthing * 1000.0);
+                pos[i].y   =  (int)rint(arrayGk[i - 1].easting - offsetEasting * 1000.0);
+                pos[i].z   = -arrayGk[i - 1].altitude;
+                pos[i].phi = 0.0f;
+                pos[i].psi = 0.0f;
+                pos[i].rho = arrayGk[i - 1].heading;
+            }
+            break;
+
+        case POSITION_REFERENCE_UTM:
+            positionTool->wgs84ToUtm(&posWgs84[1], arrayUtm, num - 1);
+
+            for (i = 1; i < num; i++)
+            {
+                pos[i].x   =  (int)rint(arrayUtm[i - 1].northing - offsetNorthing * 1000.0);
+                pos[i].y   =  (int)rint(arrayUtm[i - 1].easting - offsetEasting * 1000.0);
+                pos[i].z   = -arrayUtm[i - 1].altitude;
+                pos[i].phi = 0.0f;
+                pos[i].psi = 0.0f;
+                pos[i].rho = arrayUtm[i - 1].heading;
+            }
+            break;
+
+        default:
+            for (i = 1; i < num; i++)
+            {
+                wgs84ToPos(&posWgs84[i], &posData);
+                memcpy(&pos[i], &posData.pos, sizeof(position_3d));
+            }
+            break;
+    }
+}
+
+// array version of posToWgs84()
+void    Position::posToWgs84(position_3d *pos, position_wgs84_data *posWgs84, int num)
+{
+    position_data   posData;
+    int             i;
+
+    switch (positionReference)
+    {
+        case POSITION_REFERENCE_GK:
+            for (i = 0; i < num; i++)
+            {
+                arrayGk[i].northing =  (double)pos[i].x + offsetNorthing * 1000.0;
+                arrayGk[i].easting  =  (double)pos[i].y + offsetEasting * 1000.0;
+                arrayGk[i].altitude = -pos[i].z;
+                arrayGk[i].heading  =  pos[i].rho;
+            }
+            positionTool->gkToWgs84(arrayGk, posWgs84, num);
+            break;
+
+        case POSITION_REFERENCE_UTM:
+            for (i = 0; i < num; i++)
+            {
+                arrayUtm[i].zone     =  utmZone;
+                arrayUtm[i].band     =  utmBand;
+                arrayUtm[i].northing =  (double)pos[i].x + offsetNorthing * 1000.0;
+                arrayUtm[i].easting  =  (double)pos[i].y + offsetEasting * 1000.0;
+                arrayUtm[i].altitude = -pos[i].z;
+                arrayUtm[i].heading  =  pos[i].rho;
+            }
+            positionTool->utmToWgs84(arrayUtm, posWgs84, num);
+            break;
+
+        default:
+            for (i = 0; i < num; i++)
+            {
+                memcpy(&posData.pos, &pos[i], sizeof(position_3d));
+                posToWgs84(&posData, &posWgs84[i]);
+            }
+            break;
+    }
+}
+
 void    Position::getPosition(position_3d* odo, position_3d* pos)
 {
     position_3d odoDiff, relPos;
@@ -804,7 +1067,8 @@ Position::Position()
       : RackDataModule( MODULE_CLASS_ID,
                     2000000000llu,    // 2s datatask error sleep time
                     8,                // command mailbox slots
-                    240,              // command mailbox data size per slot
+                    sizeof(position_utm_array_data) +   // command mailbox data size per slot
+                    POSITION_ARRAY_POINT_MAX * sizeof(position_utm_data),
                     MBX_IN_KERNELSPACE | MBX_SLOT,  // command mailbox flags
                     1000,             // max buffer entries
                     10)               // data buffer listener
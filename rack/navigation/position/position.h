@@ -70,6 +70,12 @@ class Position : public RackDataModule {
         double              sinRefPosI, cosRefPosI;
         PositionTool        *positionTool;
 
+        // buffers of the array conversions
+        position_wgs84_data arrayWgs84[POSITION_ARRAY_POINT_MAX];
+        position_gk_data    arrayGk[POSITION_ARRAY_POINT_MAX];
+        position_utm_data   arrayUtm[POSITION_ARRAY_POINT_MAX];
+        position_3d         arrayPos[POSITION_ARRAY_POINT_MAX];
+
         // mailboxes
         RackMailbox         odometryMbx;
         RackMailbox         workMbx;
@@ -86,6 +92,9 @@ class Position : public RackDataModule {
 
         void    wgs84ToPos(position_wgs84_data *posWgs84Data, position_data *posData);
         void    posToWgs84(position_data *posData, position_wgs84_data *posWgs84Data);
+        void    wgs84ToPos(position_wgs84_data *posWgs84, position_3d *pos, int num);
+        void    posToWgs84(position_3d *pos, position_wgs84_data *posWgs84, int num);
+        int     arrayCommand(RackMessage *msgInfo);
         void    getPosition(position_3d* odo, position_3d* pos);
 
         // -> non realtime context
@@ -147,3 +147,165 @@ int PositionProxy::posToUtm(position_data *posData, position_utm_data *utmData,
     utmData = PositionUtmData::parse(&msgInfo);
     return 0;
 }
+
+int PositionProxy::wgs84ToPos(position_wgs84_array_data *wgs84Array, position_array_data *posArray,
+                              ssize_t recv_datalen, uint64_t reply_timeout_ns)
+{
+    RackMessage msgInfo;
+
+    if ((wgs84Array->pointNum < 0) || (wgs84Array->pointNum > POSITION_ARRAY_POINT_MAX))
+    {
+        return -EINVAL;
+    }
+
+    int ret = proxySendRecvDataCmd(MSG_POSITION_WGS84_TO_POS_ARRAY, (void *)wgs84Array,
+                              PositionWgs84ArrayData::getDatalen(wgs84Array), MSG_POSITION_POS_ARRAY,
+                              (void *)posArray, recv_datalen,
+                              reply_timeout_ns, &msgInfo);
+    if (ret)
+    {
+        return ret;
+    }
+
+    posArray = PositionArrayData::parse(&msgInfo);
+    if (!posArray)
+    {
+        return -EINVAL;
+    }
+    return 0;
+}
+
+int PositionProxy::posToWgs84(position_array_data *posArray, position_wgs84_array_data *wgs84Array,
+                              ssize_t recv_datalen, uint64_t reply_timeout_ns)
+{
+    RackMessage msgInfo;
+
+    if ((posArray->pointNum < 0) || (posArray->pointNum > POSITION_ARRAY_POINT_MAX))
+    {
+        return -EINVAL;
+    }
+
+    int ret = proxySendRecvDataCmd(MSG_POSITION_POS_TO_WGS84_ARRAY, (void *)posArray,
+                              PositionArrayData::getDatalen(posArray), MSG_POSITION_WGS84_ARRAY,
+                              (void *)wgs84Array, recv_datalen,
+                              reply_timeout_ns, &msgInfo);
+    if (ret)
+    {
+        return ret;
+    }
+
+    wgs84Array = PositionWgs84ArrayData::parse(&msgInfo);
+    if (!wgs84Array)
+    {
+        return -EINVAL;
+    }
+    return 0;
+}
+
+int PositionProxy::gkToPos(position_gk_array_data *gkArray, position_array_data *posArray,
+                           ssize_t recv_datalen, uint64_t reply_timeout_ns)
+{
+    RackMessage msgInfo;
+
+    if ((gkArray->pointNum < 0) || (gkArray->pointNum > POSITION_ARRAY_POINT_MAX))
+    {
+        return -EINVAL;
+    }
+
+    int ret = proxySendRecvDataCmd(MSG_POSITION_GK_TO_POS_ARRAY, (void *)gkArray,
+                              PositionGkArrayData::getDatalen(gkArray), MSG_POSITION_POS_ARRAY,
+                              (void *)posArray, recv_datalen,
+                              reply_timeout_ns, &msgInfo);
+    if (ret)
+    {
+        return ret;
+    }
+
+    posArray = PositionArrayData::parse(&msgInfo);
+    if (!posArray)
+    {
+        return -EINVAL;
+    }
+    return 0;
+}
+
+int PositionProxy::posToGk(position_array_data *posArray, position_gk_array_data *gkArray,
+                           ssize_t recv_datalen, uint64_t reply_timeout_ns)
+{
+    RackMessage msgInfo;
+
+    if ((posArray->pointNum < 0) || (posArray->pointNum > POSITION_ARRAY_POINT_MAX))
+    {
+        return -EINVAL;
+    }
+
+    int ret = proxySendRecvDataCmd(MSG_POSITION_POS_TO_GK_ARRAY, (void *)posArray,
+                              PositionArrayData::getDatalen(posArray), MSG_POSITION_GK_ARRAY,
+                              (void *)gkArray, recv_datalen,
+                              reply_timeout_ns, &msgInfo);
+    if (ret)
+    {
+        return ret;
+    }
+
+    gkArray = PositionGkArrayData::parse(&msgInfo);
+    if (!gkArray)
+    {
+        return -EINVAL;
+    }
+    return 0;
+}
+
+int PositionProxy::utmToPos(position_utm_array_data *utmArray, position_array_data *posArray,
+                            ssize_t recv_datalen, uint64_t reply_timeout_ns)
+{
+    RackMessage msgInfo;
+
+    if ((utmArray->pointNum < 0) || (utmArray->pointNum > POSITION_ARRAY_POINT_MAX))
+    {
+        return -EINVAL;
+    }
+
+    int ret = proxySendRecvDataCmd(MSG_POSITION_UTM_TO_POS_ARRAY, (void *)utmArray,
+                              PositionUtmArrayData::getDatalen(utmArray), MSG_POSITION_POS_ARRAY,
+                              (void *)posArray, recv_datalen,
+                              reply_timeout_ns, &msgInfo);
+    if (ret)
+    {
+        return ret;
+    }
+
+    posArray = PositionArrayData::parse(&msgInfo);
+    if (!posArray)
+    {
+        return -EINVAL;
+    }
+    return 0;
+}
+
+int PositionProxy::posToUtm(position_array_data *posArray, position_utm_array_data *utmArray,
+                            ssize_t recv_datalen, uint64_t reply_timeout_ns)
+{
+    RackMessage msgInfo;
+
+    if ((posArray->pointNum < 0) || (posArray->pointNum > POSITION_ARRAY_POINT_MAX))
+    {
+        return -EINVAL;
+    }
+
+    int ret = proxySendRecvDataCmd(MSG_POSITION_POS_TO_UTM_ARRAY, (void *)posArray,
+                              PositionArrayData::getDatalen(posArray), MSG_POSITION_UTM_ARRAY,
+                              (void *)utmArray, recv_datalen,
+                              reply_timeout_ns, &msgInfo);
+    if (ret)
+    {
+        return ret;
+    }
+
+    utmArray = PositionUtmArrayData::parse(&msgInfo);
+    if (!utmArray)
+    {
+        return -EINVAL;
+    }
+    return 0;
+}
@@ -31,11 +31,24 @@
 #define MSG_POSITION_POS_TO_GK           (RACK_PROXY_MSG_POS_OFFSET + 5)
 #define MSG_POSITION_UTM_TO_POS          (RACK_PROXY_MSG_POS_OFFSET + 6)
 #define MSG_POSITION_POS_TO_UTM          (RACK_PROXY_MSG_POS_OFFSET + 7)
+#define MSG_POSITION_WGS84_TO_POS_ARRAY  (RACK_PROXY_MSG_POS_OFFSET + 8)
+#define MSG_POSITION_POS_TO_WGS84_ARRAY  (RACK_PROXY_MSG_POS_OFFSET + 9)
+#define MSG_POSITION_GK_TO_POS_ARRAY     (RACK_PROXY_MSG_POS_OFFSET + 10)
+#define MSG_POSITION_POS_TO_GK_ARRAY     (RACK_PROXY_MSG_POS_OFFSET + 11)
+#define MSG_POSITION_UTM_TO_POS_ARRAY    (RACK_PROXY_MSG_POS_OFFSET + 12)
+#define MSG_POSITION_POS_TO_UTM_ARRAY    (RACK_PROXY_MSG_POS_OFFSET + 13)
 
 #define MSG_POSITION_POS                 (RACK_PROXY_MSG_NEG_OFFSET - 2)
 #define MSG_POSITION_WGS84               (RACK_PROXY_MSG_NEG_OFFSET - 3)
 #define MSG_POSITION_GK                  (RACK_PROXY_MSG_NEG_OFFSET - 5)
 #define MSG_POSITION_UTM                 (RACK_PROXY_MSG_NEG_OFFSET - 7)
+#define MSG_POSITION_POS_ARRAY           (RACK_PROXY_MSG_NEG_OFFSET - 8)
+#define MSG_POSITION_WGS84_ARRAY         (RACK_PROXY_MSG_NEG_OFFSET - 9)
+#define MSG_POSITION_GK_ARRAY            (RACK_PROXY_MSG_NEG_OFFSET - 11)
+#define MSG_POSITION_UTM_ARRAY           (RACK_PROXY_MSG_NEG_OFFSET - 13)
+
+/** maximum number of points of one array conversion message */
+#define POSITION_ARRAY_POINT_MAX         1024
 
 //######################################################################
 //# Position Data (static size - MESSAGE)
@@ -259,6 +272,318 @@ class PositionUtmData
         }
 };
 
+//######################################################################
+//# Position Array Data (dynamic size - MESSAGE)
+//######################################################################
+
+/**
+ * position array data structure, positions without timestamp
+ */
+typedef struct{
+    int32_t              pointNum;          /**< number of following points,
+                                               max POSITION_ARRAY_POINT_MAX */
+    position_3d          point[0];          /**< list of points */
+} __attribute__((packed)) position_array_data;
+
+class PositionArrayData
+{
+    public:
+        static void le_to_cpu(position_array_data *data)
+        {
+            int i;
+
+            data->pointNum = __le32_to_cpu(data->pointNum);
+            for (i = 0; i < data->pointNum; i++)
+            {
+                Position3D::le_to_cpu(&data->point[i]);
+            }
+        }
+
+        static void be_to_cpu(position_array_data *data)
+        {
+            int i;
+
+            data->pointNum = __be32_to_cpu(data->pointNum);
+            for (i = 0; i < data->pointNum; i++)
+            {
+                Position3D::be_to_cpu(&data->point[i]);
+            }
+        }
+
+        /** returns NULL if the message is shorter than its point list */
+        static position_array_data* parse(RackMessage *msgInfo)
+        {
+            int32_t pointNum;
+
+            if (!msgInfo->p_data || (msgInfo->datalen < sizeof(position_array_data)))
+                return NULL;
+
+            position_array_data *p_data = (position_array_data *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                pointNum = __le32_to_cpu(p_data->pointNum);
+            }
+            else // data in big endian
+            {
+                pointNum = __be32_to_cpu(p_data->pointNum);
+            }
+            if ((pointNum < 0) || (pointNum > POSITION_ARRAY_POINT_MAX) ||
+                (msgInfo->datalen < sizeof(position_array_data) + pointNum * sizeof(position_3d)))
+                return NULL;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+
+        static size_t getDatalen(position_array_data *data)
+        {
+            return (sizeof(position_array_data) + data->pointNum * sizeof(position_3d));
+        }
+};
+
+//######################################################################
+//# Position WGS84 Array Data (dynamic size - MESSAGE)
+//######################################################################
+
+/**
+ * position WGS84 array data structure
+ */
+typedef struct{
+    int32_t              pointNum;          /**< number of following points,
+                                               max POSITION_ARRAY_POINT_MAX */
+    position_wgs84_data  point[0];          /**< list of points */
+} __attribute__((packed)) position_wgs84_array_data;
+
+class PositionWgs84ArrayData
+{
+    public:
+        static void le_to_cpu(position_wgs84_array_data *data)
+        {
+            int i;
+
+            data->pointNum = __le32_to_cpu(data->pointNum);
+            for (i = 0; i < data->pointNum; i++)
+            {
+                PositionWgs84Data::le_to_cpu(&data->point[i]);
+            }
+        }
+
+        static void be_to_cpu(position_wgs84_array_data *data)
+        {
+            int i;
+
+            data->pointNum = __be32_to_cpu(data->pointNum);
+            for (i = 0; i < data->pointNum; i++)
+            {
+                PositionWgs84Data::be_to_cpu(&data->point[i]);
+            }
+        }
+
+        /** returns NULL if the message is shorter than its point list */
+        static position_wgs84_array_data* parse(RackMessage *msgInfo)
+        {
+            int32_t pointNum;
+
+            if (!msgInfo->p_data || (msgInfo->datalen < sizeof(position_wgs84_array_data)))
+                return NULL;
+
+            position_wgs84_array_data *p_data = (position_wgs84_array_data *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                pointNum = __le32_to_cpu(p_data->pointNum);
+            }
+            else // data in big endian
+            {
+                pointNum = __be32_to_cpu(p_data->pointNum);
+            }
+            if ((pointNum < 0) || (pointNum > POSITION_ARRAY_POINT_MAX) ||
+                (msgInfo->datalen < sizeof(position_wgs84_array_data) + pointNum * sizeof(position_wgs84_data)))
+                return NULL;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+
+        static size_t getDatalen(position_wgs84_array_data *data)
+        {
+            return (sizeof(position_wgs84_array_data) + data->pointNum * sizeof(position_wgs84_data));
+        }
+};
+
+//######################################################################
+//# Position GK Array Data (dynamic size - MESSAGE)
+//######################################################################
+
+/**
+ * position Gauss Krueger array data structure
+ */
+typedef struct{
+    int32_t              pointNum;          /**< number of following points,
+                                               max POSITION_ARRAY_POINT_MAX */
+    position_gk_data     point[0];          /**< list of points */
+} __attribute__((packed)) position_gk_array_data;
+
+class PositionGkArrayData
+{
+    public:
+        static void le_to_cpu(position_gk_array_data *data)
+        {
+            int i;
+
+            data->pointNum = __le32_to_cpu(data->pointNum);
+            for (i = 0; i < data->pointNum; i++)
+            {
+                PositionGkData::le_to_cpu(&data->point[i]);
+            }
+        }
+
+        static void be_to_cpu(position_gk_array_data *data)
+        {
+            int i;
+
+            data->pointNum = __be32_to_cpu(data->pointNum);
+            for (i = 0; i < data->pointNum; i++)
+            {
+                PositionGkData::be_to_cpu(&data->point[i]);
+            }
+        }
+
+        /** returns NULL if the message is shorter than its point list */
+        static position_gk_array_data* parse(RackMessage *msgInfo)
+        {
+            int32_t pointNum;
+
+            if (!msgInfo->p_data || (msgInfo->datalen < sizeof(position_gk_array_data)))
+                return NULL;
+
+            position_gk_array_data *p_data = (position_gk_array_data *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                pointNum = __le32_to_cpu(p_data->pointNum);
+            }
+            else // data in big endian
+            {
+                pointNum = __be32_to_cpu(p_data->pointNum);
+            }
+            if ((pointNum < 0) || (pointNum > POSITION_ARRAY_POINT_MAX) ||
+                (msgInfo->datalen < sizeof(position_gk_array_data) + pointNum * sizeof(position_gk_data)))
+                return NULL;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+
+        static size_t getDatalen(position_gk_array_data *data)
+        {
+            return (sizeof(position_gk_array_data) + data->pointNum * sizeof(position_gk_data));
+        }
+};
+
+//######################################################################
+//# Position UTM Array Data (dynamic size - MESSAGE)
+//######################################################################
+
+/**
+ * UTM array data structure
+ */
+typedef struct{
+    int32_t              pointNum;          /**< number of following points,
+                                               max POSITION_ARRAY_POINT_MAX */
+    position_utm_data    point[0];          /**< list of points */
+} __attribute__((packed)) position_utm_array_data;
+
+class PositionUtmArrayData
+{
+    public:
+        static void le_to_cpu(position_utm_array_data *data)
+        {
+            int i;
+
+            data->pointNum = __le32_to_cpu(data->pointNum);
+            for (i = 0; i < data->pointNum; i++)
+            {
+                PositionUtmData::le_to_cpu(&data->point[i]);
+            }
+        }
+
+        static void be_to_cpu(position_utm_array_data *data)
+        {
+            int i;
+
+            data->pointNum = __be32_to_cpu(data->pointNum);
+            for (i = 0; i < data->pointNum; i++)
+            {
+                PositionUtmData::be_to_cpu(&data->point[i]);
+            }
+        }
+
+        /** returns NULL if the message is shorter than its point list */
+        static position_utm_array_data* parse(RackMessage *msgInfo)
+        {
+            int32_t pointNum;
+
+            if (!msgInfo->p_data || (msgInfo->datalen < sizeof(position_utm_array_data)))
+                return NULL;
+
+            position_utm_array_data *p_data = (position_utm_array_data *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                pointNum = __le32_to_cpu(p_data->pointNum);
+            }
+            else // data in big endian
+            {
+                pointNum = __be32_to_cpu(p_data->pointNum);
+            }
+            if ((pointNum < 0) || (pointNum > POSITION_ARRAY_POINT_MAX) ||
+                (msgInfo->datalen < sizeof(position_utm_array_data) + pointNum * sizeof(position_utm_data)))
+                return NULL;
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+
+        static size_t getDatalen(position_utm_array_data *data)
+        {
+            return (sizeof(position_utm_array_data) + data->pointNum * sizeof(position_utm_data));
+        }
+};
+
 /**
  * The global position of the mobile robot.
  *
@@ -346,6 +671,67 @@ class PositionProxy : public RackDataProxy {
         {
             return posToUtm(posData, utmData, dataTimeout);
         }
+
+        //
+        // array conversions, one message for up to POSITION_ARRAY_POINT_MAX points
+        //
+        // The reply is received in @a recv_datalen bytes, the work mailbox
+        // of the proxy has to hold messages of this size.
+        //
+
+        int wgs84ToPos(position_wgs84_array_data *wgs84Array, position_array_data *posArray,
+                       ssize_t recv_datalen, uint64_t reply_timeout_ns);
+
+        int wgs84ToPos(position_wgs84_array_data *wgs84Array, position_array_data *posArray,
+                       ssize_t recv_datalen)
+        {
+            return wgs84ToPos(wgs84Array, posArray, recv_datalen, dataTimeout);
+        }
+
+        int posToWgs84(position_array_data *posArray, position_wgs84_array_data *wgs84Array,
+                       ssize_t recv_datalen, uint64_t reply_timeout_ns);
+
+        int posToWgs84(position_array_data *posArray, position_wgs84_array_data *wgs84Array,
+                       ssize_t recv_datalen)
+        {
+            return posToWgs84(posArray, wgs84Array, recv_datalen, dataTimeout);
+        }
+
+        int gkToPos(position_gk_array_data *gkArray, position_array_data *posArray,
+                    ssize_t recv_datalen, uint64_t reply_timeout_ns);
+
+        int gkToPos(position_gk_array_data *gkArray, position_array_data *posArray,
+                    ssize_t recv_datalen)
+        {
+            return gkToPos(gkArray, posArray, recv_datalen, dataTimeout);
+        }
+
+        int posToGk(position_array_data *posArray, position_gk_array_data *gkArray,
+                    ssize_t recv_datalen, uint64_t reply_timeout_ns);
+
+        int posToGk(position_array_data *posArray, position_gk_array_data *gkArray,
+                    ssize_t recv_datalen)
+        {
+            return posToGk(posArray, gkArray, recv_datalen, dataTimeout);
+        }
+
+        int utmToPos(position_utm_array_data *utmArray, position_array_data *posArray,
+                     ssize_t recv_datalen, uint64_t reply_timeout_ns);
+
+        int utmToPos(position_utm_array_data *utmArray, position_array_data *posArray,
+                     ssize_t recv_datalen)
+        {
+            return utmToPos(utmArray, posArray, recv_datalen, dataTimeout);
+        }
+
+        int posToUtm(position_array_data *posArray, position_utm_array_data *utmArray,
+                     ssize_t recv_datalen, uint64_t reply_timeout_ns);
+
+        int posToUtm(position_array_data *posArray, position_utm_array_data *utmArray,
+                     ssize_t recv_datalen)
+        {
+            return posToUtm(posArray, utmArray, recv_datalen, dataTimeout);
+        }
 };
 
 #endif // __POSITION_PROXY_H__
@@ -0,0 +1,756 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#include "obj_recog_scan2d.h"
+#include <main/argopts.h>
+#include <main/angle_tool.h>
+
+#include <math.h>
+#include <stdlib.h>
+
+// chi-square 99% gate for 2 degrees of freedom
+#define OBJ_RECOG_SCAN2D_GATE       9.21f
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "scan2dSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the scan2d module", { 0 } },
+
+    { ARGOPT_REQ, "scan2dInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the scan2d module", { -1 } },
+
+    { ARGOPT_OPT, "segDistMin", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Minimum distance of adjacent points to start a new segment in mm, default 300", { 300 } },
+
+    { ARGOPT_OPT, "segDistFactor", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Range dependent segment distance in 1/1000 of the range, default 30", { 30 } },
+
+    { ARGOPT_OPT, "segPointMin", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Minimum number of points of a segment, default 3", { 3 } },
+
+    { ARGOPT_OPT, "segDimMax", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum object dimension in mm (bigger segments are ignored), default 8000", { 8000 } },
+
+    { ARGOPT_OPT, "fitAngleStep", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Angle resolution of the bounding box fitting in deg, default 3", { 3 } },
+
+    { ARGOPT_OPT, "assocDistMax", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum distance of a segment to its predicted track in mm, default 1500", { 1500 } },
+
+    { ARGOPT_OPT, "trackHitMin", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of associated scans until a track is published, default 3", { 3 } },
+
+    { ARGOPT_OPT, "trackMissMax", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of scans without association until a track is deleted, default 5", { 5 } },
+
+    { ARGOPT_OPT, "accNoise", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Acceleration noise of the tracking filter in mm/s^2, default 2000", { 2000 } },
+
+    { ARGOPT_OPT, "measNoise", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Position noise of the segment boxes in mm, default 150", { 150 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+static int pair_compare(const void *a, const void *b)
+{
+    float costA = ((const obj_recog_scan2d_pair *)a)->cost;
+    float costB = ((const obj_recog_scan2d_pair *)b)->cost;
+
+    return (costA > costB) - (costA < costB);
+}
+
+static inline void kf_predict(obj_recog_scan2d_kf *kf, float dt, float q)
+{
+    float dt2 = dt * dt;
+
+    kf->pos += kf->vel * dt;
+    kf->p00 += dt * (2.0f * kf->p01 + dt * kf->p11) + 0.25f * q * dt2 * dt2;
+    kf->p01 += dt * kf->p11 + 0.5f * q * dt2 * dt;
+    kf->p11 += q * dt2;
+}
+
+static inline void kf_update(obj_recog_scan2d_kf *kf, float z, float r)
+{
+    float s  = kf->p00 + r;
+    float k0 = kf->p00 / s;
+    float k1 = kf->p01 / s;
+    float y  = z - kf->pos;
+
+    kf->pos += k0 * y;
+    kf->vel += k1 * y;
+    kf->p11 -= k1 * kf->p01;
+    kf->p01 -= k0 * kf->p01;
+    kf->p00 -= k0 * kf->p00;
+}
+
+static inline void kf_init(obj_recog_scan2d_kf *kf, float z, float r, float velVar)
+{
+    kf->pos = z;
+    kf->vel = 0.0f;
+    kf->p00 = r;
+    kf->p01 = 0.0f;
+    kf->p11 = velVar;
+}
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+int  ObjRecogScan2d::moduleOn(void)
+{
+    int i, ret;
+    float angle;
+
+    // get dynamic module parameter
+    segDistMin      = getInt32Param("segDistMin");
+    segDistFactor   = getInt32Param("segDistFactor");
+    segPointMin     = getInt32Param("segPointMin");
+    segDimMax       = getInt32Param("segDimMax");
+    fitAngleStep    = getInt32Param("fitAngleStep");
+    assocDistMax    = getInt32Param("assocDistMax");
+    trackHitMin     = getInt32Param("trackHitMin");
+    trackMissMax    = getInt32Param("trackMissMax");
+    accNoise        = getInt32Param("accNoise");
+    measNoise       = getInt32Param("measNoise");
+
+    if (segPointMin < 1)
+    {
+        segPointMin = 1;
+    }
+
+    // box orientations of the fitting, 0 .. 90 deg
+    if ((fitAngleStep < 1) || (fitAngleStep > OBJ_RECOG_SCAN2D_FIT_ANGLE_MAX))
+    {
+        GDOS_ERROR("Invalid fitAngleStep %d deg\n", fitAngleStep);
+        return -EINVAL;
+    }
+
+    fitAngleNum = OBJ_RECOG_SCAN2D_FIT_ANGLE_MAX / fitAngleStep;
+    for (i = 0; i < fitAngleNum; i++)
+    {
+        angle     = (float)(i * fitAngleStep) * M_PI / 180.0f;
+        fitCos[i] = cosf(angle);
+        fitSin[i] = sinf(angle);
+    }
+
+    segmentNum        = 0;
+    trackNum          = 0;
+    lastRecordingTime = 0;
+
+    GDOS_DBG_INFO("Turn on Scan2d(%d/%d)...\n", scan2dSys, scan2dInst);
+    ret = scan2d->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on Scan2d(%d/%d), code = %d \n", scan2dSys, scan2dInst, ret);
+        return ret;
+    }
+
+    dataMbx.clean();
+    GDOS_DBG_INFO("Requesting continuous data from Scan2d(%d/%d)...\n", scan2dSys, scan2dInst);
+    ret = scan2d->getContData(0, &dataMbx, &dataBufferPeriodTime);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get continuous data from Scan2d(%d/%d), "
+                   "code = %d \n", scan2dSys, scan2dInst, ret);
+        return ret;
+    }
+
+    return RackDataModule::moduleOn();  // has to be last command in moduleOn();
+}
+
+void ObjRecogScan2d::moduleOff(void)
+{
+    RackDataModule::moduleOff();        // has to be first command in moduleOff();
+
+    scan2d->stopContData(&dataMbx);
+}
+
+int  ObjRecogScan2d::moduleLoop(void)
+{
+    int             ret;
+    float           dt;
+    scan2d_data     *scan2dIn;
+    obj_recog_data  *objRecogOut;
+    RackMessage     msgInfo;
+
+    // get datapointer from rackdatabuffer
+    objRecogOut = (obj_recog_data *)getDataBufferWorkSpace();
+
+    // get scan2d data, the scan is processed inside the mailbox buffer
+    ret = dataMbx.peekTimed(rackTime.toNano(2 * dataBufferPeriodTime), &msgInfo);
+    if (ret)
+    {
+        GDOS_ERROR("Can't receive scan2d data on DATA_MBX, code = %d \n", ret);
+        return ret;
+    }
+
+    if ((msgInfo.getType() != MSG_DATA) ||
+        (msgInfo.getSrc()  != scan2d->getDestAdr()))
+    {
+        GDOS_ERROR("Received unexpected message from %n to %n type %d on "
+                   "data mailbox\n", msgInfo.getSrc(), msgInfo.getDest(), msgInfo.getType());
+
+        dataMbx.peekEnd();
+        return -EINVAL;
+    }
+
+    scan2dIn = Scan2dData::parse(&msgInfo);
+
+    if (scan2dIn->pointNum > SCAN2D_POINT_MAX)
+    {
+        GDOS_ERROR("PointNum (%d) exceeds max array size (%d)\n", scan2dIn->pointNum,
+                   SCAN2D_POINT_MAX);
+        dataMbx.peekEnd();
+        return -EINVAL;
+    }
+
+    // time since the last scan
+    if (lastRecordingTime && (trackNum > 0))
+    {
+        dt = (float)(int32_t)(scan2dIn->recordingTime - lastRecordingTime) / 1000.0f;
+        if (dt < 0.0f)
+        {
+            GDOS_WARNING("Scan2d recordingTime %u is older than last scan %u, "
+                         "reset tracks\n", scan2dIn->recordingTime, lastRecordingTime);
+            trackNum = 0;
+        }
+        else
+        {
+            predictTracks(dt);
+        }
+    }
+    lastRecordingTime = scan2dIn->recordingTime;
+
+    segmentScan(scan2dIn);
+    associateTracks();
+    updateTracks();
+
+    fillObjects(scan2dIn, objRecogOut);
+
+    GDOS_DBG_DETAIL("RecordingTime %u pointNum %d segmentNum %d trackNum %d objectNum %d\n",
+                    scan2dIn->recordingTime, scan2dIn->pointNum, segmentNum, trackNum,
+                    objRecogOut->objectNum);
+
+    dataMbx.peekEnd();
+
+    putDataBufferWorkSpace(ObjRecogData::getDatalen(objRecogOut));
+    return 0;
+}
+
+int  ObjRecogScan2d::moduleCommand(RackMessage *msgInfo)
+{
+    // not for me -> ask RackDataModule
+    return RackDataModule::moduleCommand(msgInfo);
+}
+
+// Splits the scan into segments of adjacent points. Points are transformed
+// into global coordinates, the scan itself is not changed.
+void ObjRecogScan2d::segmentScan(scan2d_data *scan2dData)
+{
+    int         i, last;
+    float       cosRho, sinRho;
+    float       x, y, dx, dy, range, distMax;
+    float       distFactor = (float)segDistFactor / 1000.0f;
+    scan_point  *point;
+    obj_recog_scan2d_segment *seg = NULL;
+
+    cosRho     = cosf(scan2dData->refPos.rho);
+    sinRho     = sinf(scan2dData->refPos.rho);
+    segmentNum = 0;
+    last       = -1;
+
+    for (i = 0; i < scan2dData->pointNum; i++)
+    {
+        point = &scan2dData->point[i];
+
+        if (point->type & (SCAN_POINT_TYPE_INVALID | SCAN_POINT_TYPE_MAX_RANGE))
+        {
+            continue;
+        }
+
+        x = (float)point->x;
+        y = (float)point->y;
+        pointX[i] = x * cosRho - y * sinRho + (float)scan2dData->refPos.x;
+        pointY[i] = x * sinRho + y * cosRho + (float)scan2dData->refPos.y;
+
+        // distance to the previous valid point
+        if (last >= 0)
+        {
+            dx      = pointX[i] - pointX[last];
+            dy      = pointY[i] - pointY[last];
+            range   = point->z > 0 ? (float)point->z : sqrtf(x * x + y * y);
+            distMax = (float)segDistMin + distFactor * range;
+
+            if (dx * dx + dy * dy <= distMax * distMax)
+            {
+                seg->pointLast = i;
+                seg->pointNum++;
+                last = i;
+                continue;
+            }
+
+            // close segment, drop it if it is too small
+            if (seg->pointNum < segPointMin)
+            {
+                segmentNum--;
+            }
+        }
+
+        // start new segment
+        if (segmentNum >= OBJ_RECOG_SCAN2D_SEGMENT_MAX)
+        {
+            GDOS_WARNING("Too many segments, max %d\n", OBJ_RECOG_SCAN2D_SEGMENT_MAX);
+            last = -1;
+            break;
+        }
+
+        seg = &segment[segmentNum];
+        seg->pointFirst = i;
+        seg->pointLast  = i;
+        seg->pointNum   = 1;
+        segmentNum++;
+        last = i;
+    }
+
+    if ((last >= 0) && (seg->pointNum < segPointMin))
+    {
+        segmentNum--;
+    }
+
+    // fit bounding boxes, drop oversized segments (walls)
+    i = 0;
+    while (i < segmentNum)
+    {
+        fitSegment(scan2dData, &segment[i]);
+
+        if ((segment[i].dimX > (float)segDimMax) ||
+            (segment[i].dimY > (float)segDimMax))
+        {
+            segment[i] = segment[segmentNum - 1];
+            segmentNum--;
+        }
+        else
+        {
+            segment[i].trackIndex = -1;
+            i++;
+        }
+    }
+}
+
+// Fits the bounding box with the minimal area to the segment points. The
+// box is searched over all orientations from 0 to 90 deg.
+void ObjRecogScan2d::fitSegment(scan2d_data *scan2dData, obj_recog_scan2d_segment *seg)
+{
+    int     i, k, kBest;
+    float   c1, c2, area, areaBest;
+    float   min1, max1, min2, max2;
+    float   min1Best = 0.0f, max1Best = 0.0f, min2Best = 0.0f, max2Best = 0.0f;
+
+    kBest    = 0;
+    areaBest = -1.0f;
+
+    for (k = 0; k < fitAngleNum; k++)
+    {
+        min1 = min2 =  1e30f;
+        max1 = max2 = -1e30f;
+
+        for (i = seg->pointFirst; i <= seg->pointLast; i++)
+        {
+            if (scan2dData->point[i].type &
+                (SCAN_POINT_TYPE_INVALID | SCAN_POINT_TYPE_MAX_RANGE))
+                continue;
+
+            c1 =  pointX[i] * fitCos[k] + pointY[i] * fitSin[k];
+            c2 = -pointX[i] * fitSin[k] + pointY[i] * fitCos[k];
+
+            if (c1 < min1) min1 = c1;
+            if (c1 > max1) max1 = c1;
+            if (c2 < min2) min2 = c2;
+            if (c2 > max2) max2 = c2;
+        }
+
+        area = (max1 - min1) * (max2 - min2);
+        if ((areaBest < 0.0f) || (area < areaBest))
+        {
+            areaBest = area;
+            kBest    = k;
+            min1Best = min1;
+            max1Best = max1;
+            min2Best = min2;
+            max2Best = max2;
+        }
+    }
+
+    c1 = 0.5f * (min1Best + max1Best);
+    c2 = 0.5f * (min2Best + max2Best);
+
+    seg->x    = c1 * fitCos[kBest] - c2 * fitSin[kBest];
+    seg->y    = c1 * fitSin[kBest] + c2 * fitCos[kBest];
+    seg->rho  = (float)(kBest * fitAngleStep) * M_PI / 180.0f;
+    seg->dimX = max1Best - min1Best;
+    seg->dimY = max2Best - min2Best;
+}
+
+void ObjRecogScan2d::predictTracks(float dt)
+{
+    int   i;
+    float q = (float)accNoise * (float)accNoise;
+
+    for (i = 0; i < trackNum; i++)
+    {
+        kf_predict(&track[i].kfX, dt, q);
+        kf_predict(&track[i].kfY, dt, q);
+    }
+}
+
+// Global nearest neighbour association. All gated track / segment pairs are
+// assigned in the order of their mahalanobis distance.
+void ObjRecogScan2d::associateTracks(void)
+{
+    int   i, j;
+    int   pairMax = sizeof(pair) / sizeof(pair[0]);
+    float r       = (float)measNoise * (float)measNoise;
+    float distMax = (float)assocDistMax * (float)assocDistMax;
+    float dx, dy, cost;
+    int   trackUsed[OBJ_RECOG_SCAN2D_TRACK_MAX];
+
+    pairNum = 0;
+
+    for (i = 0; i < trackNum; i++)
+    {
+        trackUsed[i] = 0;
+
+        for (j = 0; j < segmentNum; j++)
+        {
+            dx = segment[j].x - track[i].kfX.pos;
+            dy = segment[j].y - track[i].kfY.pos;
+
+            if (dx * dx + dy * dy > distMax)
+                continue;
+
+            cost = dx * dx / (track[i].kfX.p00 + r) +
+                   dy * dy / (track[i].kfY.p00 + r);
+
+            if (cost > OBJ_RECOG_SCAN2D_GATE)
+                continue;
+
+            if (pairNum >= pairMax)
+                break;
+
+            pair[pairNum].cost         = cost;
+            pair[pairNum].trackIndex   = i;
+            pair[pairNum].segmentIndex = j;
+            pairNum++;
+        }
+    }
+
+    qsort(pair, pairNum, sizeof(obj_recog_scan2d_pair), pair_compare);
+
+    for (i = 0; i < pairNum; i++)
+    {
+        if (trackUsed[pair[i].trackIndex] ||
+            (segment[pair[i].segmentIndex].trackIndex >= 0))
+            continue;
+
+        trackUsed[pair[i].trackIndex]               = 1;
+        segment[pair[i].segmentIndex].trackIndex    = pair[i].trackIndex;
+    }
+}
+
+// Updates the associated tracks and creates new tracks out of unassociated
+// segments. Object ids stay below 0x8000, so they fit the segment number of
+// a scan point (see Scan2dDynObjRecog).
+void ObjRecogScan2d::updateTracks(void)
+{
+    int   i, j;
+    float r      = (float)measNoise * (float)measNoise;
+    float velVar = (float)assocDistMax * (float)assocDistMax;
+    int   trackUpdated[OBJ_RECOG_SCAN2D_TRACK_MAX];
+    obj_recog_scan2d_track *trk;
+
+    for (i = 0; i < trackNum; i++)
+    {
+        trackUpdated[i] = 0;
+    }
+
+    for (j = 0; j < segmentNum; j++)
+    {
+        if (segment[j].trackIndex >= 0)
+        {
+            trk = &track[segment[j].trackIndex];
+
+            kf_update(&trk->kfX, segment[j].x, r);
+            kf_update(&trk->kfY, segment[j].y, r);
+
+            trk->rho  = segment[j].rho;
+            trk->dimX = segment[j].dimX;
+            trk->dimY = segment[j].dimY;
+            trk->hits++;
+            trk->misses = 0;
+            trackUpdated[segment[j].trackIndex] = 1;
+        }
+        else if (trackNum < OBJ_RECOG_SCAN2D_TRACK_MAX)
+        {
+            trk = &track[trackNum];
+
+            trk->objectId = nextObjectId;
+            nextObjectId  = (nextObjectId + 1) & 0x7fff;
+
+            kf_init(&trk->kfX, segment[j].x, r, velVar);
+            kf_init(&trk->kfY, segment[j].y, r, velVar);
+
+            trk->rho    = segment[j].rho;
+            trk->dimX   = segment[j].dimX;
+            trk->dimY   = segment[j].dimY;
+            trk->hits   = 1;
+            trk->misses = 0;
+
+            segment[j].trackIndex = trackNum;
+            trackUpdated[trackNum] = 1;
+            trackNum++;
+        }
+    }
+
+    // delete lost tracks
+    i = 0;
+    j = 0;
+    while (i < trackNum)
+    {
+        if (!trackUpdated[i])
+        {
+            track[i].misses++;
+        }
+
+        if (track[i].misses <= trackMissMax)
+        {
+            if (j != i)
+            {
+                track[j] = track[i];
+            }
+            j++;
+        }
+        i++;
+    }
+    trackNum = j;
+}
+
+// Writes the confirmed tracks relative to the scan reference position
+int ObjRecogScan2d::fillObjects(scan2d_data *scan2dData, obj_recog_data *objRecogData)
+{
+    int     i, n;
+    float   cosRho, sinRho, dx, dy, vx, vy;
+    obj_recog_object *obj;
+
+    cosRho = cosf(scan2dData->refPos.rho);
+    sinRho = sinf(scan2dData->refPos.rho);
+
+    objRecogData->recordingTime = scan2dData->recordingTime;
+    memcpy(&objRecogData->refPos, &scan2dData->refPos, sizeof(position_3d));
+    memset(&objRecogData->varRefPos, 0, sizeof(position_3d));
+
+    n = 0;
+    for (i = 0; i < trackNum; i++)
+    {
+        if (track[i].hits < trackHitMin)
+            continue;
+
+        obj = &objRecogData->object[n];
+        memset(obj, 0, sizeof(obj_recog_object));
+
+        dx = track[i].kfX.pos - (float)scan2dData->refPos.x;
+        dy = track[i].kfY.pos - (float)scan2dData->refPos.y;
+        vx = track[i].kfX.vel;
+        vy = track[i].kfY.vel;
+
+        obj->objectId  = track[i].objectId;
+        obj->pos.x     = (int32_t)( dx * cosRho + dy * sinRho);
+        obj->pos.y     = (int32_t)(-dx * sinRho + dy * cosRho);
+        obj->pos.rho   = normaliseAngleSym0(track[i].rho - scan2dData->refPos.rho);
+        obj->varPos.x  = (int32_t)sqrtf(track[i].kfX.p00);
+        obj->varPos.y  = (int32_t)sqrtf(track[i].kfY.p00);
+        obj->vel.x     = (int32_t)( vx * cosRho + vy * sinRho);
+        obj->vel.y     = (int32_t)(-vx * sinRho + vy * cosRho);
+        obj->varVel.x  = (int32_t)sqrtf(track[i].kfX.p11);
+        obj->varVel.y  = (int32_t)sqrtf(track[i].kfY.p11);
+        obj->dim.x     = (int32_t)track[i].dimX;
+        obj->dim.y     = (int32_t)track[i].dimY;
+        obj->prob      = 1.0f / (float)(1 + track[i].misses);
+
+        if ((track[i].dimX < 1000.0f) && (track[i].dimY < 1000.0f))
+        {
+            obj->type = OBJ_RECOG_OBJECT_TYPE_UNKNOWN_SMALL;
+        }
+        else
+        {
+            obj->type = OBJ_RECOG_OBJECT_TYPE_UNKNOWN_BIG;
+        }
+
+        n++;
+    }
+    objRecogData->objectNum = n;
+
+    return n;
+}
+
+/*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+// init_flags
+#define INIT_BIT_DATA_MODULE        0
+#define INIT_BIT_MBX_WORK           1
+#define INIT_BIT_MBX_DATA           2
+#define INIT_BIT_PROXY_SCAN2D       3
+
+int ObjRecogScan2d::moduleInit(void)
+{
+    int ret;
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    // work mailbox
+    ret = createMbx(&workMbx, 1, 128, MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_WORK);
+
+    // data mailbox
+    ret = createMbx(&dataMbx, 1, sizeof(scan2d_data_msg),
+                    MBX_IN_USERSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_DATA);
+
+    // create Scan2d Proxy
+    scan2d = new Scan2dProxy(&workMbx, scan2dSys, scan2dInst);
+    if (!scan2d)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_SCAN2D);
+
+    return 0;
+
+init_error:
+    // !!! call local cleanup function !!!
+    ObjRecogScan2d::moduleCleanup();
+    return ret;
+}
+
+void ObjRecogScan2d::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+
+    // free proxies
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_SCAN2D))
+    {
+        delete scan2d;
+    }
+
+    // delete mailboxes
+    if (initBits.testAndClearBit(INIT_BIT_MBX_DATA))
+    {
+        destroyMbx(&dataMbx);
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MBX_WORK))
+    {
+        destroyMbx(&workMbx);
+    }
+}
+
+ObjRecogScan2d::ObjRecogScan2d(void)
+      : RackDataModule( MODULE_CLASS_ID,
+                    5000000000llu,    // 5s datatask error sleep time
+                    16,               // command mailbox slots
+                    240,              // command mailbox data size per slot
+                    MBX_IN_KERNELSPACE | MBX_SLOT,  // command mailbox flags
+                    10,               // max buffer entries
+                    10)               // data buffer listener
+{
+    // get static module parameter
+    scan2dSys       = getIntArg("scan2dSys", argTab);
+    scan2dInst      = getIntArg("scan2dInst", argTab);
+
+    nextObjectId    = 0;
+
+    dataBufferMaxDataSize = sizeof(obj_recog_data_msg);
+}
+
+int  main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "ObjRecogScan2d");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    // create new ObjRecogScan2d
+    ObjRecogScan2d *pInst;
+
+    pInst = new ObjRecogScan2d();
+    if (!pInst)
+    {
+        printf("Can't create new ObjRecogScan2d -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // init
+    ret = pInst->moduleInit();
+    if (ret)
+        goto exit_error;
+
+    pInst->run();
+
+    return 0;
+
+exit_error:
+    delete (pInst);
+    return ret;
+}
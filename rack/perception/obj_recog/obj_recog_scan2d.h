@@ -0,0 +1,161 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __OBJ_RECOG_SCAN2D_H__
+#define __OBJ_RECOG_SCAN2D_H__
+
+#include <main/rack_data_module.h>
+#include <perception/scan2d_proxy.h>
+#include <perception/obj_recog_proxy.h>
+
+// define module class
+#define MODULE_CLASS_ID                 OBJ_RECOG
+
+#define OBJ_RECOG_SCAN2D_SEGMENT_MAX    1024
+#define OBJ_RECOG_SCAN2D_TRACK_MAX      OBJ_RECOG_OBJECT_MAX
+#define OBJ_RECOG_SCAN2D_FIT_ANGLE_MAX  90
+
+typedef struct {
+    scan2d_data         data;
+    scan_point          point[SCAN2D_POINT_MAX];
+} __attribute__((packed)) scan2d_data_msg;
+
+typedef struct {
+    obj_recog_data      data;
+    obj_recog_object    object[OBJ_RECOG_OBJECT_MAX];
+} __attribute__((packed)) obj_recog_data_msg;
+
+// scan segment with fitted bounding box (global coordinates)
+typedef struct {
+    int         pointFirst;
+    int         pointLast;
+    int         pointNum;
+    float       x;              // box center
+    float       y;
+    float       rho;            // box orientation
+    float       dimX;           // box dimension along rho
+    float       dimY;           // box dimension perpendicular to rho
+    int         trackIndex;     // associated track, -1 if none
+} obj_recog_scan2d_segment;
+
+// constant velocity kalman filter, x and y axis are decoupled
+typedef struct {
+    float       pos;
+    float       vel;
+    float       p00;            // covariance pos/pos
+    float       p01;            // covariance pos/vel
+    float       p11;            // covariance vel/vel
+} obj_recog_scan2d_kf;
+
+typedef struct {
+    int32_t             objectId;
+    obj_recog_scan2d_kf kfX;
+    obj_recog_scan2d_kf kfY;
+    float               rho;
+    float               dimX;
+    float               dimY;
+    int                 hits;
+    int                 misses;
+} obj_recog_scan2d_track;
+
+// association candidate
+typedef struct {
+    float       cost;
+    int16_t     trackIndex;
+    int16_t     segmentIndex;
+} obj_recog_scan2d_pair;
+
+/**
+ * Object Recognition Scan2d
+ *
+ * Extracts objects out of a 2d scan and tracks them. Scan points are
+ * segmented by the distance of adjacent points, every segment is fitted
+ * with a minimal area bounding box (L-shape) and associated with the
+ * predicted tracks by a gated global nearest neighbour search. The tracks
+ * are filtered by a constant velocity kalman filter in global coordinates
+ * (scan2d refPos), so the velocities are compensated for ego motion.
+ *
+ * The module only publishes the objects. Scan2dDynObjRecog marks the points
+ * of the dynamic objects in the scan and writes their object ids into the
+ * segment numbers.
+ *
+ * @ingroup modules_obj_recog
+ */
+class ObjRecogScan2d : public RackDataModule {
+    private:
+
+        // own vars
+        int             scan2dSys;
+        int             scan2dInst;
+
+        int             segDistMin;
+        int             segDistFactor;
+        int             segPointMin;
+        int             segDimMax;
+        int             fitAngleStep;
+        int             assocDistMax;
+        int             trackHitMin;
+        int             trackMissMax;
+        int             accNoise;
+        int             measNoise;
+
+        rack_time_t     lastRecordingTime;
+        int32_t         nextObjectId;
+
+        int             segmentNum;
+        int             trackNum;
+        int             pairNum;
+        int             fitAngleNum;
+
+        float           fitCos[OBJ_RECOG_SCAN2D_FIT_ANGLE_MAX];
+        float           fitSin[OBJ_RECOG_SCAN2D_FIT_ANGLE_MAX];
+        float           pointX[SCAN2D_POINT_MAX];
+        float           pointY[SCAN2D_POINT_MAX];
+
+        obj_recog_scan2d_segment    segment[OBJ_RECOG_SCAN2D_SEGMENT_MAX];
+        obj_recog_scan2d_track      track[OBJ_RECOG_SCAN2D_TRACK_MAX];
+        obj_recog_scan2d_pair       pair[OBJ_RECOG_SCAN2D_TRACK_MAX * 16];
+
+        // additional mailboxes
+        RackMailbox     workMbx;
+        RackMailbox     dataMbx;
+
+        // proxies
+        Scan2dProxy     *scan2d;
+
+        void  segmentScan(scan2d_data *scan2dData);
+        void  fitSegment(scan2d_data *scan2dData, obj_recog_scan2d_segment *seg);
+        void  predictTracks(float dt);
+        void  associateTracks(void);
+        void  updateTracks(void);
+        int   fillObjects(scan2d_data *scan2dData, obj_recog_data *objRecogData);
+
+    protected:
+        // -> realtime context
+        int  moduleOn(void);
+        void moduleOff(void);
+        int  moduleLoop(void);
+        int  moduleCommand(RackMessage *msgInfo);
+
+        // -> non realtime context
+        void moduleCleanup(void);
+
+    public:
+        // constructor und destructor
+        ObjRecogScan2d();
+        ~ObjRecogScan2d() {};
+
+        // -> non realtime context
+        int  moduleInit(void);
+};
+
+#endif // __OBJ_RECOG_SCAN2D_H__
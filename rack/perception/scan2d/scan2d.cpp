@@ -16,9 +16,6 @@
 #include "scan2d.h"
 #include <main/argopts.h>
 
-// filter flags:
-#define FILTER_REFLECTOR_90DEG   0x01
-
 
 typedef struct {
     ladar_data    data;
@@ -189,8 +186,7 @@ int  Scan2d::moduleLoop(void)
     scan2d_data*    data2D;
     ladar_data*     dataLadar;
     RackMessage     msgInfo;
-    double          x, y;
-    int             i, j, ret;
+    int             ret;
 
     // get datapointer from rackdatabuffer
     data2D = (scan2d_data *)getDataBufferWorkSpace();
@@ -224,6 +220,64 @@ int  Scan2d::moduleLoop(void)
         return -EINVAL;
     }
 
+    convertLadarData(dataLadar, data2D);
+
+    // add intensity to scanPoints
+    if(cameraInst >= 0)
+    {
+        ret = addScanIntensity(data2D);
+        if(ret)
+        {
+            GDOS_ERROR("Can't add scan intensity, code = %d\n", ret);
+            return ret;
+        }
+    }
+
+    if (positionInst >= 0)
+    {
+        //add position to scan2d data
+        ret = position->getData(&positionData, sizeof(positionData), data2D->recordingTime);
+        if (ret)
+        {
+            GDOS_ERROR("Can't get data from Position(%i/%i), code = %d\n", positionSys, positionInst, ret);
+            ladarMbx.peekEnd();
+            return ret;
+        }
+
+        data2D->refPos.x   = positionData.pos.x;
+        data2D->refPos.y   = positionData.pos.y;
+        data2D->refPos.z   = positionData.pos.z;
+        data2D->refPos.phi = positionData.pos.phi;
+        data2D->refPos.psi = positionData.pos.psi;
+        data2D->refPos.rho = positionData.pos.rho;
+    }
+    else
+    {
+        data2D->refPos.x   = 0;
+        data2D->refPos.y   = 0;
+        data2D->refPos.z   = 0;
+        data2D->refPos.phi = 0.f;
+        data2D->refPos.psi = 0.f;
+        data2D->refPos.rho = 0.f;
+    }
+
+    ladarMbx.peekEnd();
+
+    GDOS_DBG_DETAIL("RecordingTime %u pointNum %d\n",
+                    data2D->recordingTime, data2D->pointNum);
+
+    putDataBufferWorkSpace(Scan2dData::getDatalen(data2D));
+
+    return 0;
+}
+
+
+// ladar scan -> scan2d data, changes the distances of the ladar scan
+void  Scan2d::convertLadarData(ladar_data* dataLadar, scan2d_data* data2D)
+{
+    double          x, y;
+    int             i, j;
+
     data2D->recordingTime = dataLadar->recordingTime;
     data2D->duration      = dataLadar->duration;
     data2D->sectorNum     = 1;
@@ -306,57 +360,8 @@ int  Scan2d::moduleLoop(void)
 
     // filter invalid reflector points:
     filterReflector(data2D, reflectorFilterMode);
-
-    // add intensity to scanPoints
-    if(cameraInst >= 0)
-    {
-        ret = addScanIntensity(data2D);
-        if(ret)
-        {
-            GDOS_ERROR("Can't add scan intensity, code = %d\n", ret);
-            return ret;
-        }
-    }
-
-    if (positionInst >= 0)
-    {
-        //add position to scan2d data
-        ret = position->getData(&positionData, sizeof(positionData), data2D->recordingTime);
-        if (ret)
-        {
-            GDOS_ERROR("Can't get data from Position(%i/%i), code = %d\n", positionSys, positionInst, ret);
-            ladarMbx.peekEnd();
-            return ret;
-        }
-
-        data2D->refPos.x   = positionData.pos.x;
-        data2D->refPos.y   = positionData.pos.y;
-        data2D->refPos.z   = positionData.pos.z;
-        data2D->refPos.phi = positionData.pos.phi;
-        data2D->refPos.psi = positionData.pos.psi;
-        data2D->refPos.rho = positionData.pos.rho;
-    }
-    else
-    {
-        data2D->refPos.x   = 0;
-        data2D->refPos.y   = 0;
-        data2D->refPos.z   = 0;
-        data2D->refPos.phi = 0.f;
-        data2D->refPos.psi = 0.f;
-        data2D->refPos.rho = 0.f;
-    }
-
-    ladarMbx.peekEnd();
-
-    GDOS_DBG_DETAIL("RecordingTime %u pointNum %d\n",
-                    data2D->recordingTime, data2D->pointNum);
-
-    putDataBufferWorkSpace(Scan2dData::getDatalen(data2D));
-
-    return 0;
 }
 
-
 void  Scan2d::turnUpsideDown(ladar_data* dataLadar)
 {
     int         i;
@@ -721,6 +726,9 @@ Scan2d::Scan2d(void)
     dataBufferMaxDataSize = sizeof(scan2d_msg);
 }
 
+// RackBench links its own copy of the module without main()
+#ifndef RACK_BENCH
+
 int  main(int argc, char *argv[])
 {
     int ret;
@@ -758,6 +766,8 @@ exit_error:
     return ret;
 }
 
+#endif // RACK_BENCH
+
 int Scan2d::addScanIntensity(scan2d_data* data2D)
 {
     short   intensity;
@@ -29,6 +29,9 @@ typedef struct {
 
 #define MODULE_CLASS_ID             SCAN2D
 
+// filter flags:
+#define FILTER_REFLECTOR_90DEG   0x01
+
 
 
 /**
@@ -37,7 +40,7 @@ typedef struct {
  * @ingroup modules_scan2d
  */
 class Scan2d : public RackDataModule {
-    private:
+    protected:
 
         // own vars
         int          ladarSys;
@@ -77,6 +80,7 @@ class Scan2d : public RackDataModule {
         CameraProxy   *camera;
         PositionProxy *position;
 
+        void convertLadarData(ladar_data* dataLadar, scan2d_data* data2D);
         void turnUpsideDown(ladar_data* dataLadar);
         void filterMedian(ladar_data* dataLadar);
 
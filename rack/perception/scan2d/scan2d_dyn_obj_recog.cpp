@@ -160,7 +160,7 @@ int  Scan2dDynObjRecog::moduleCommand(RackMessage *msgInfo)
 void Scan2dDynObjRecog::classifyDynamic(scan2d_data *scan2dData, obj_recog_data *objRecogData, int vMin)
 {
     int                     i, j, k, kParent;
-    int                     vCurr;
+    int                     vCurr, segment;
     double                  rotMat[2][2];
     point_2d                boxCorners[4];
     int                     crossL, crossR;
@@ -178,6 +178,13 @@ void Scan2dDynObjRecog::classifyDynamic(scan2d_data *scan2dData, obj_recog_data
         // proceed if object is dynamic
         if (vCurr >= vMin)
         {
+            // the object id is the segment number if it fits into it
+            segment = objRecogData->object[i].objectId;
+            if ((segment < 0) || (segment > 0x7fff))
+            {
+                segment = -1;
+            }
+
             // calculate edge points of bounding box
 
         	// rotate unit vectors to orientation of box
@@ -267,13 +274,15 @@ void Scan2dDynObjRecog::classifyDynamic(scan2d_data *scan2dData, obj_recog_data
                 // pos is on an edge of the object if crossL/R counts are not of the same parity
                 if ((crossL % 2) != (crossR % 2))
                 {
-                    scan2dData->point[j].type |= SCAN_POINT_TYPE_DYN_OBSTACLE;
+                    scan2dData->point[j].type   |= SCAN_POINT_TYPE_DYN_OBSTACLE;
+                    scan2dData->point[j].segment = (int16_t)segment;
                 }
 
                 // pos is inside object if the number of crossings is odd
                 if ((crossR % 2) == 1)
                 {
-                    scan2dData->point[j].type |= SCAN_POINT_TYPE_DYN_OBSTACLE;
+                    scan2dData->point[j].type   |= SCAN_POINT_TYPE_DYN_OBSTACLE;
+                    scan2dData->point[j].segment = (int16_t)segment;
                 }
             }
         }
@@ -120,9 +120,8 @@ int  Scan2dSim::moduleLoop(void)
     odometry_data*  dataOdometry = NULL;
     RackMessage    msgInfo;
     double          angle, angleResolution, distance;
-    double          cosRho, sinRho, featureDistance, a;
-    double          x1, x2, x3, x4, y1, y2, y3, y4, denominator;
-    int             i, j, ret;
+    double          x1, y1;
+    int             i, ret;
 
     // get datapointer from rackdatabuffer
     data2D = (scan2d_data *)getDataBufferWorkSpace();
@@ -155,59 +154,26 @@ int  Scan2dSim::moduleLoop(void)
     data2D->sectorIndex   = 0;
     data2D->pointNum = (360 / angleRes) + 1;
 
-    angle           = -180.0 * M_PI / 180.0;
     angleResolution = (double)angleRes * M_PI / 180.0;
 
     for (i = 0; i < data2D->pointNum; i ++)
     {
-        distance = maxRange;   // initialization with maxRange
-        cosRho = cos(dataOdometry->pos.rho + angle);
-        sinRho = sin(dataOdometry->pos.rho + angle);
+        beamAngle[i] = -M_PI + (double)i * angleResolution;
+    }
 
-        // calculating the minimum distance to the intersections with all lines
-        for (j = 0; j < dxfMap.featureNum; j ++)
-        {
-            // calculating parameters of a line in the map
-            x1 = dxfMap.feature[j].x;
-            y1 = dxfMap.feature[j].y;
-
-            x2 = dxfMap.feature[j].l * dxfMap.feature[j].cos;
-            y2 = dxfMap.feature[j].l * dxfMap.feature[j].sin;
-
-            // calculating parameters of the laser beam line
-            x3 = dataOdometry->pos.x;
-            y3 = dataOdometry->pos.y;
-
-            // adding the orientation of the candidate sample
-            x4 = cosRho;
-            y4 = sinRho;
-
-            // calculating distance = b
-            denominator = (x4 * y2) - (y4 * x2);
-
-            if ( ( denominator > 0.0001 ) || ( denominator < -0.0001 ) )
-            {
-                featureDistance = ((x2 * y3) + (x1 * y2) - (y1 * x2) - (x3 * y2)) / denominator;   // intersection
-
-                if ( (featureDistance < distance) && (featureDistance >= 0) )    // considering the working range of the scanner
-                {
-                    if ( (x2 > -0.5 ) && (x2 < 0.5) )
-                    {
-                        a = ( y3 + (featureDistance * y4) - y1 ) / y2;
-                    }
-                    else
-                    {
-                        a = ( x3 + (featureDistance * x4) - x1 ) / x2;
-                    }
-
-                    // to determine if the intersection is out of the start or end point
-                    if ( (a >= 0.0) && (a <= 1.0) )
-                    {
-                        distance = featureDistance;
-                    }
-                }
-            }
-        }
+    // distances of all beams to the map lines
+    ret = dxfMap.raycast(dataOdometry->pos.x, dataOdometry->pos.y, dataOdometry->pos.rho,
+                         beamAngle, data2D->pointNum, maxRange, beamDistance);
+    if (ret)
+    {
+        GDOS_ERROR("Can't raycast DXF map, code = %d\n", ret);
+        return ret;
+    }
+
+    for (i = 0; i < data2D->pointNum; i ++)
+    {
+        angle    = beamAngle[i];
+        distance = beamDistance[i];
 
         x1 = distance * cos(angle);
         y1 = distance * sin(angle);
@@ -224,7 +190,6 @@ int  Scan2dSim::moduleLoop(void)
             data2D->point[i].type |= SCAN_POINT_TYPE_MAX_RANGE;
             data2D->point[i].type |= SCAN_POINT_TYPE_INVALID;
         }
-        angle += angleResolution;
     }
 
     GDOS_DBG_DETAIL("RecordingTime %u pointNum %d\n",
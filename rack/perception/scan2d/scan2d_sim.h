@@ -41,6 +41,8 @@ class Scan2dSim : public RackDataModule {
         char         *dxfMapFile;
         int          angleRes;
         int          mapScaleFactor;
+        double       beamAngle[SCAN2D_POINT_MAX];
+        double       beamDistance[SCAN2D_POINT_MAX];
 
         // additional mailboxes
         RackMailbox workMbx;
@@ -0,0 +1,1044 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#include "scan3d.h"
+#include <main/argopts.h>
+
+// sector states
+#define SECTOR_EMPTY                0
+#define SECTOR_FILLED               1
+#define SECTOR_PUBLISHED            2
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "ladarSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the ladar driver", { 0 } },
+
+    { ARGOPT_REQ, "ladarInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the ladar driver", { -1 } },
+
+    { ARGOPT_OPT, "servoDriveSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the servo drive", { 0 } },
+
+    { ARGOPT_OPT, "servoDriveInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the servo drive", { -1 } },
+
+    { ARGOPT_OPT, "ptzDriveSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the ptz drive", { 0 } },
+
+    { ARGOPT_OPT, "ptzDriveInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the ptz drive", { -1 } },
+
+    { ARGOPT_OPT, "ptzDriveAxis", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Ptz drive axis used for scanning (0: pan, 1: tilt), default 1", { 1 } },
+
+    { ARGOPT_OPT, "positionSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the position module", { 0 } },
+
+    { ARGOPT_OPT, "positionInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the position module", { -1 } },
+
+    { ARGOPT_OPT, "scanMode", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Scan mode (1: roll, 2: pitch, 3: yaw), default 2", { SCAN3D_PITCH } },
+
+    { ARGOPT_OPT, "scanNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of 2d scans (range image rows) per 3d scan, default 181", { 181 } },
+
+    { ARGOPT_OPT, "sectorNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of sectors per 3d scan, default 4", { 4 } },
+
+    { ARGOPT_OPT, "maxRange", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximal ladar range [mm], default 30000", { 30000 } },
+
+    { ARGOPT_OPT, "driveAngleMin", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Minimum drive angle of the 3d scan [deg], default -45", { -45 } },
+
+    { ARGOPT_OPT, "driveAngleMax", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum drive angle of the 3d scan [deg], default 45", { 45 } },
+
+    { ARGOPT_OPT, "driveVel", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Drive velocity while scanning [deg/s], default 30", { 30 } },
+
+    { ARGOPT_OPT, "sensorOffsetX", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Scanner X offset [mm], default 0", { 0 } },
+
+    { ARGOPT_OPT, "sensorOffsetY", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Scanner Y offset [mm], default 0", { 0 } },
+
+    { ARGOPT_OPT, "sensorOffsetZ", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Scanner Z offset [mm], default 0", { 0 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+
+int  Scan3d::moduleOn(void)
+{
+    int         ret;
+    rack_time_t ladarPeriodTime;
+
+    // get dynamic module parameter
+    scanMode        = getInt32Param("scanMode");
+    scanNum         = getInt32Param("scanNum");
+    sectorNum       = getInt32Param("sectorNum");
+    maxRange        = getInt32Param("maxRange");
+    driveAngleMin   = getInt32Param("driveAngleMin");
+    driveAngleMax   = getInt32Param("driveAngleMax");
+    driveVel        = getInt32Param("driveVel");
+    sensorOffsetX   = getInt32Param("sensorOffsetX");
+    sensorOffsetY   = getInt32Param("sensorOffsetY");
+    sensorOffsetZ   = getInt32Param("sensorOffsetZ");
+
+    if (((scanMode & 0xff) != SCAN3D_ROLL) &&
+        ((scanMode & 0xff) != SCAN3D_PITCH) &&
+        ((scanMode & 0xff) != SCAN3D_YAW))
+    {
+        GDOS_ERROR("Unsupported scan mode %x\n", scanMode);
+        return -EINVAL;
+    }
+
+    if ((scanNum <= 0) || (scanNum > SCAN3D_SCAN_MAX))
+    {
+        GDOS_ERROR("Invalid scanNum %d (max %d)\n", scanNum, SCAN3D_SCAN_MAX);
+        return -EINVAL;
+    }
+
+    if ((sectorNum <= 0) || (sectorNum > SCAN3D_SECTOR_NUM_MAX) ||
+        (sectorNum > scanNum))
+    {
+        GDOS_ERROR("Invalid sectorNum %d (max %d)\n", sectorNum,
+                   SCAN3D_SECTOR_NUM_MAX);
+        return -EINVAL;
+    }
+
+    if (driveAngleMax <= driveAngleMin)
+    {
+        GDOS_ERROR("Invalid drive angle range %d .. %d deg\n",
+                   driveAngleMin, driveAngleMax);
+        return -EINVAL;
+    }
+
+    sectorScanNum       = (scanNum + sectorNum - 1) / sectorNum;
+    driveAngleMinFloat  = (double)driveAngleMin * M_PI / 180.0;
+    driveAngleMaxFloat  = (double)driveAngleMax * M_PI / 180.0;
+    driveVelFloat       = (double)driveVel      * M_PI / 180.0;
+
+    scanPointNum        = 0;
+    beamNum             = 0;
+    driveHistoryIndex   = 0;
+    driveHistoryNum     = 0;
+
+    rangeImgMtx.lock(RACK_INFINITE);
+    rangeImgWrite       = 0;
+    rangeImgValid       = 0;
+    rangeImgMtx.unlock();
+
+    ret = ladar->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on Ladar(%d/%d), code = %d\n",
+                   ladarSys, ladarInst, ret);
+        return ret;
+    }
+
+    if (positionInst >= 0)
+    {
+        ret = position->on();
+        if (ret)
+        {
+            GDOS_ERROR("Can't turn on Position(%d/%d), code = %d\n",
+                       positionSys, positionInst, ret);
+            return ret;
+        }
+    }
+
+    dataMbx.clean();
+
+    ret = driveOn();
+    if (ret)
+    {
+        return ret;
+    }
+
+    ret = ladar->getContData(0, &dataMbx, &ladarPeriodTime);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get continuous data from Ladar(%d/%d), "
+                   "code = %d\n", ladarSys, ladarInst, ret);
+        return ret;
+    }
+
+    // one sector is published every sectorScanNum ladar scans
+    dataBufferPeriodTime = ladarPeriodTime * sectorScanNum;
+
+    // the first sweep moves the drive to its start position
+    driveDir = -1;
+    ret = driveMove(driveAngleMinFloat);
+    if (ret)
+    {
+        return ret;
+    }
+    sweepStart();
+
+    return RackDataModule::moduleOn();  // has to be last command in moduleOn();
+}
+
+void Scan3d::moduleOff(void)
+{
+    RackDataModule::moduleOff();        // has to be first command in moduleOff();
+
+    ladar->stopContData(&dataMbx);
+    driveStopContData();
+}
+
+int  Scan3d::moduleLoop(void)
+{
+    RackMessage     msgInfo;
+    ladar_data      *ladarData;
+    int             ret;
+
+    ret = dataMbx.peekTimed(1000000000llu, &msgInfo); // 1s
+    if (ret)
+    {
+        GDOS_ERROR("Can't receive data on DATA_MBX, code = %d\n", ret);
+        return ret;
+    }
+
+    if (msgInfo.getType() != MSG_DATA)
+    {
+        GDOS_ERROR("Received unexpected message from %n to %n type %d on "
+                   "data mailbox\n", msgInfo.getSrc(), msgInfo.getDest(),
+                   msgInfo.getType());
+        dataMbx.peekEnd();
+        return -EINVAL;
+    }
+
+    if (msgInfo.getSrc() == ladar->getDestAdr())
+    {
+        ladarData = LadarData::parse(&msgInfo);
+        ret       = sweepAddScan(ladarData);
+    }
+    else
+    {
+        ret = driveAddSample(&msgInfo);
+    }
+
+    dataMbx.peekEnd();
+    return ret;
+}
+
+int  Scan3d::moduleCommand(RackMessage *msgInfo)
+{
+    scan3d_range_img_msg *img;
+    int                  ret;
+
+    switch (msgInfo->getType())
+    {
+        case MSG_SCAN3D_GET_RANGE_IMAGE:
+            rangeImgMtx.lock(RACK_INFINITE);
+
+            if (!rangeImgValid)
+            {
+                rangeImgMtx.unlock();
+                cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+                break;
+            }
+
+            // the last complete image is sent directly out of the image buffer
+            img = &rangeImg[rangeImgWrite ^ 1];
+            ret = cmdMbx.sendDataMsgReply(MSG_SCAN3D_RANGE_IMAGE, msgInfo, 1, img,
+                                          sizeof(scan3d_range_img_data) +
+                                          img->data.scanNum * img->data.scanPointNum *
+                                          sizeof(scan3d_range_img_point));
+            rangeImgMtx.unlock();
+
+            if (ret)
+            {
+                GDOS_ERROR("Can't send range image, code = %d\n", ret);
+                return ret;
+            }
+            break;
+
+        default:
+            // not for me -> ask RackDataModule
+            return RackDataModule::moduleCommand(msgInfo);
+    }
+    return 0;
+}
+
+//
+// drive handling
+//
+
+int Scan3d::driveOn(void)
+{
+    int ret;
+
+    if (servoDriveInst >= 0)
+    {
+        ret = servoDrive->on();
+        if (ret)
+        {
+            GDOS_ERROR("Can't turn on ServoDrive(%d/%d), code = %d\n",
+                       servoDriveSys, servoDriveInst, ret);
+            return ret;
+        }
+
+        ret = servoDrive->getContData(0, &dataMbx, NULL);
+        if (ret)
+        {
+            GDOS_ERROR("Can't get continuous data from ServoDrive(%d/%d), "
+                       "code = %d\n", servoDriveSys, servoDriveInst, ret);
+            return ret;
+        }
+    }
+    else
+    {
+        ret = ptzDrive->on();
+        if (ret)
+        {
+            GDOS_ERROR("Can't turn on PtzDrive(%d/%d), code = %d\n",
+                       ptzDriveSys, ptzDriveInst, ret);
+            return ret;
+        }
+
+        ret = ptzDrive->getContData(0, &dataMbx, NULL);
+        if (ret)
+        {
+            GDOS_ERROR("Can't get continuous data from PtzDrive(%d/%d), "
+                       "code = %d\n", ptzDriveSys, ptzDriveInst, ret);
+            return ret;
+        }
+    }
+    return 0;
+}
+
+void Scan3d::driveStopContData(void)
+{
+    if (servoDriveInst >= 0)
+    {
+        servoDrive->stopContData(&dataMbx);
+    }
+    else
+    {
+        ptzDrive->stopContData(&dataMbx);
+    }
+}
+
+int Scan3d::driveMove(float target)
+{
+    ptz_drive_data          ptzData;
+    ptz_drive_move_pos_data ptzMove;
+    int                     ret;
+
+    driveTarget = target;
+
+    if (servoDriveInst >= 0)
+    {
+        ret = servoDrive->movePos(target, driveVelFloat, 0.0f, 0, 0);
+        if (ret)
+        {
+            GDOS_ERROR("Can't move ServoDrive(%d/%d), code = %d\n",
+                       servoDriveSys, servoDriveInst, ret);
+        }
+        return ret;
+    }
+
+    // the axis which is not used for scanning keeps its current position
+    ret = ptzDrive->getData(&ptzData, sizeof(ptzData), 0);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get data from PtzDrive(%d/%d), code = %d\n",
+                   ptzDriveSys, ptzDriveInst, ret);
+        return ret;
+    }
+
+    memset(&ptzMove, 0, sizeof(ptzMove));
+    ptzMove.posPan  = ptzData.posPan;
+    ptzMove.posTilt = ptzData.posTilt;
+    ptzMove.posZoom = ptzData.posZoom;
+
+    if (ptzDriveAxis == 0)
+    {
+        ptzMove.posPan = target;
+        ptzMove.velPan = driveVelFloat;
+    }
+    else
+    {
+        ptzMove.posTilt = target;
+        ptzMove.velTilt = driveVelFloat;
+    }
+
+    ret = ptzDrive->movePos(&ptzMove, sizeof(ptzMove));
+    if (ret)
+    {
+        GDOS_ERROR("Can't move PtzDrive(%d/%d), code = %d\n",
+                   ptzDriveSys, ptzDriveInst, ret);
+    }
+    return ret;
+}
+
+int Scan3d::driveAddSample(RackMessage *msgInfo)
+{
+    servo_drive_data    *servoData;
+    ptz_drive_data      *ptzData;
+    scan3d_drive_sample *sample;
+
+    sample = &driveHistory[driveHistoryIndex];
+
+    if ((servoDriveInst >= 0) &&
+        (msgInfo->getSrc() == servoDrive->getDestAdr()))
+    {
+        servoData             = ServoDriveData::parse(msgInfo);
+        sample->recordingTime = servoData->recordingTime;
+        sample->angle         = servoData->position;
+    }
+    else if ((ptzDriveInst >= 0) &&
+             (msgInfo->getSrc() == ptzDrive->getDestAdr()))
+    {
+        ptzData               = PtzDriveData::parse(msgInfo);
+        sample->recordingTime = ptzData->recordingTime;
+        sample->angle         = (ptzDriveAxis == 0) ? ptzData->posPan : ptzData->posTilt;
+    }
+    else
+    {
+        GDOS_ERROR("Received unexpected data message from %n\n",
+                   msgInfo->getSrc());
+        return -EINVAL;
+    }
+
+    driveHistoryIndex = (driveHistoryIndex + 1) % SCAN3D_DRIVE_HISTORY_MAX;
+    if (driveHistoryNum < SCAN3D_DRIVE_HISTORY_MAX)
+    {
+        driveHistoryNum++;
+    }
+    return 0;
+}
+
+// linear interpolation (or extrapolation beyond the newest sample)
+// of the drive angle at the given time
+float Scan3d::driveGetAngle(rack_time_t time)
+{
+    scan3d_drive_sample *s0, *s1;
+    int                 i, idx, dt;
+
+    idx = (driveHistoryIndex + SCAN3D_DRIVE_HISTORY_MAX - 1) % SCAN3D_DRIVE_HISTORY_MAX;
+    s1  = &driveHistory[idx];
+
+    if (driveHistoryNum < 2)
+    {
+        return s1->angle;
+    }
+
+    // search from newest to oldest sample
+    for (i = 1; i < driveHistoryNum; i++)
+    {
+        idx = (idx + SCAN3D_DRIVE_HISTORY_MAX - 1) % SCAN3D_DRIVE_HISTORY_MAX;
+        s0  = &driveHistory[idx];
+
+        if ((int)(time - s0->recordingTime) >= 0)
+        {
+            break;
+        }
+        s1 = s0;
+    }
+
+    if (i == driveHistoryNum)
+    {
+        // older than the oldest sample
+        return s1->angle;
+    }
+
+    dt = (int)(s1->recordingTime - s0->recordingTime);
+    if (dt <= 0)
+    {
+        return s1->angle;
+    }
+
+    return s0->angle + (s1->angle - s0->angle) *
+           (float)(int)(time - s0->recordingTime) / (float)dt;
+}
+
+//
+// sweep handling
+//
+
+void Scan3d::beamUpdate(ladar_data *ladarData)
+{
+    int i;
+
+    if ((beamNum        == ladarData->pointNum) &&
+        (beamAngleFirst == ladarData->point[0].angle) &&
+        (beamAngleLast  == ladarData->point[beamNum - 1].angle))
+    {
+        return;
+    }
+
+    beamNum        = ladarData->pointNum;
+    beamAngleFirst = ladarData->point[0].angle;
+    beamAngleLast  = ladarData->point[beamNum - 1].angle;
+
+    for (i = 0; i < beamNum; i++)
+    {
+        beamCos[i] = cosf(ladarData->point[i].angle);
+        beamSin[i] = sinf(ladarData->point[i].angle);
+    }
+}
+
+void Scan3d::sweepStart(void)
+{
+    scan3d_range_img_point  *img;
+    int                     i, n;
+
+    for (i = 0; i < sectorNum; i++)
+    {
+        sectorState[i] = SECTOR_EMPTY;
+    }
+    sweepStartTime = 0;
+
+    // invalidate all points which are not hit during the next sweep
+    n   = scanNum * scanPointNum;
+    img = rangeImg[rangeImgWrite].point;
+
+    for (i = 0; i < n; i++)
+    {
+        sweepPoint[i].x         = 0;
+        sweepPoint[i].y         = 0;
+        sweepPoint[i].z         = 0;
+        sweepPoint[i].type      = SCAN_POINT_TYPE_INVALID;
+        sweepPoint[i].segment   = 0;
+        sweepPoint[i].intensity = 0;
+
+        img[i].range            = 0;
+        img[i].type             = SCAN_POINT_TYPE_INVALID;
+    }
+}
+
+int Scan3d::sweepEnd(void)
+{
+    scan3d_range_img_data   *img;
+    int                     i, ret;
+
+    // publish remaining sectors in sweep direction
+    for (i = 0; i < sectorNum; i++)
+    {
+        ret = sectorPublish(driveDir > 0 ? i : sectorNum - 1 - i);
+        if (ret)
+        {
+            return ret;
+        }
+    }
+
+    img                 = &rangeImg[rangeImgWrite].data;
+    img->recordingTime  = sweepStartTime;
+    img->scanMode       = scanMode;
+    img->maxRange       = maxRange;
+    img->scanNum        = scanNum;
+    img->scanPointNum   = scanPointNum;
+
+    rangeImgMtx.lock(RACK_INFINITE);
+    rangeImgWrite ^= 1;
+    rangeImgValid  = 1;
+    rangeImgMtx.unlock();
+
+    // next sweep in opposite direction
+    driveDir = -driveDir;
+    ret = driveMove(driveDir > 0 ? driveAngleMaxFloat : driveAngleMinFloat);
+    if (ret)
+    {
+        return ret;
+    }
+
+    sweepStart();
+    return 0;
+}
+
+int Scan3d::sweepAddScan(ladar_data *ladarData)
+{
+    scan_point              *p;
+    scan3d_range_img_point  *img;
+    rack_time_t             t;
+    float                   angleStart, angleEnd, angleScan, phi, angleStep;
+    float                   lx, ly, sinPhi, cosPhi, rowPos;
+    int                     i, row, sector, distance, type, ret;
+
+    if (ladarData->pointNum <= 0)
+    {
+        return 0;
+    }
+
+    if (ladarData->pointNum > LADAR_DATA_MAX_POINT_NUM)
+    {
+        GDOS_ERROR("PointNum (%d) too great\n", ladarData->pointNum);
+        return -EINVAL;
+    }
+
+    if (driveHistoryNum == 0)
+    {
+        // no drive angle available yet
+        return 0;
+    }
+
+    // fix range image geometry with the first ladar scan
+    if (scanPointNum == 0)
+    {
+        if (scanNum * ladarData->pointNum > SCAN3D_POINT_MAX)
+        {
+            GDOS_ERROR("3d scan size %d x %d exceeds SCAN3D_POINT_MAX %d\n",
+                       scanNum, ladarData->pointNum, SCAN3D_POINT_MAX);
+            return -EOVERFLOW;
+        }
+        scanPointNum = ladarData->pointNum;
+        sweepStart();
+    }
+    else if (ladarData->pointNum != scanPointNum)
+    {
+        GDOS_ERROR("Ladar pointNum changed from %d to %d\n",
+                   scanPointNum, ladarData->pointNum);
+        return -EINVAL;
+    }
+
+    beamUpdate(ladarData);
+
+    // drive angles at scan start, scan center and scan end
+    t          = ladarData->recordingTime;
+    angleStart = driveGetAngle(t);
+    angleScan  = driveGetAngle(t + ladarData->duration / 2);
+    angleEnd   = driveGetAngle(t + ladarData->duration);
+
+    // range image row of this scan
+    rowPos = (angleScan - driveAngleMinFloat) /
+             (driveAngleMaxFloat - driveAngleMinFloat) * (float)(scanNum - 1);
+    row    = (int)rintf(rowPos);
+
+    if ((row < 0) || (row >= scanNum))
+    {
+        // drive is outside of the scanning range
+        return 0;
+    }
+
+    sector = row / sectorScanNum;
+
+    if (sweepStartTime == 0)
+    {
+        sweepStartTime = t;
+    }
+
+    if (sectorState[sector] == SECTOR_EMPTY)
+    {
+        sectorTimeStart[sector] = t;
+        sectorState[sector]     = SECTOR_FILLED;
+    }
+    sectorTimeEnd[sector] = t + ladarData->duration;
+
+    // build points directly at their range image position
+    p         = &sweepPoint[row * scanPointNum];
+    img       = &rangeImg[rangeImgWrite].point[row * scanPointNum];
+    angleStep = (scanPointNum > 1) ? (angleEnd - angleStart) / (float)(scanPointNum - 1) : 0.0f;
+
+    for (i = 0; i < scanPointNum; i++)
+    {
+        distance = ladarData->point[i].distance;
+        type     = SCAN_POINT_TYPE_UNKNOWN;
+
+        switch (ladarData->point[i].type)
+        {
+            case LADAR_POINT_TYPE_TRANSPARENT:
+            case LADAR_POINT_TYPE_RAIN:
+            case LADAR_POINT_TYPE_DIRT:
+            case LADAR_POINT_TYPE_INVALID:
+                type |= SCAN_POINT_TYPE_INVALID;
+                break;
+
+            case LADAR_POINT_TYPE_REFLECTOR:
+                type |= SCAN_POINT_TYPE_REFLECTOR;
+                break;
+        }
+
+        if (distance >= maxRange)
+        {
+            distance  = maxRange;
+            type     |= SCAN_POINT_TYPE_MAX_RANGE | SCAN_POINT_TYPE_INVALID;
+        }
+
+        phi    = angleStart + angleStep * (float)i;
+        sinPhi = sinf(phi);
+        cosPhi = cosf(phi);
+
+        lx = (float)distance * beamCos[i];
+        ly = (float)distance * beamSin[i];
+
+        switch (scanMode & 0xff)
+        {
+            case SCAN3D_ROLL:
+                p[i].x = (int)lx;
+                p[i].y = (int)(ly * cosPhi);
+                p[i].z = (int)(ly * sinPhi);
+                break;
+
+            case SCAN3D_PITCH:
+                p[i].x = (int)(lx * cosPhi);
+                p[i].y = (int)ly;
+                p[i].z = (int)(-lx * sinPhi);
+                break;
+
+            default: // SCAN3D_YAW, vertical scanning plane
+                p[i].x = (int)(lx * cosPhi);
+                p[i].y = (int)(lx * sinPhi);
+                p[i].z = (int)(-ly);
+                break;
+        }
+
+        p[i].x         += sensorOffsetX;
+        p[i].y         += sensorOffsetY;
+        p[i].z         += sensorOffsetZ;
+        p[i].type       = type;
+        p[i].segment    = 0;
+        p[i].intensity  = (int16_t)ladarData->point[i].intensity;
+
+        img[i].range    = (int16_t)(distance < 0x7fff ? distance : 0x7fff);
+        img[i].type     = (int16_t)type;
+    }
+
+    // publish all sectors which have been passed by the sweep
+    if (driveDir > 0)
+    {
+        for (i = 0; i < sector; i++)
+        {
+            ret = sectorPublish(i);
+            if (ret)
+            {
+                return ret;
+            }
+        }
+    }
+    else
+    {
+        for (i = sectorNum - 1; i > sector; i--)
+        {
+            ret = sectorPublish(i);
+            if (ret)
+            {
+                return ret;
+            }
+        }
+    }
+
+    // end of sweep
+    if (((driveDir > 0) && (angleScan >= driveTarget - 0.5f * (driveAngleMaxFloat - driveAngleMinFloat) / scanNum)) ||
+        ((driveDir < 0) && (angleScan <= driveTarget + 0.5f * (driveAngleMaxFloat - driveAngleMinFloat) / scanNum)))
+    {
+        return sweepEnd();
+    }
+
+    return 0;
+}
+
+int Scan3d::sectorPublish(int sector)
+{
+    scan3d_data *data;
+    int         rowStart, rowEnd, ret;
+
+    if (sectorState[sector] != SECTOR_FILLED)
+    {
+        return 0;
+    }
+    sectorState[sector] = SECTOR_PUBLISHED;
+
+    rowStart = sector * sectorScanNum;
+    rowEnd   = rowStart + sectorScanNum;
+    if (rowEnd > scanNum)
+    {
+        rowEnd = scanNum;
+    }
+
+    data = (scan3d_data *)getDataBufferWorkSpace();
+
+    data->recordingTime = sectorTimeStart[sector];
+    data->duration      = sectorTimeEnd[sector] - sectorTimeStart[sector];
+    data->maxRange      = maxRange;
+    data->scanNum       = rowEnd - rowStart;
+    data->scanPointNum  = scanPointNum;
+    data->scanMode      = scanMode;
+    data->scanHardware  = 0;
+    data->sectorNum     = sectorNum;
+    data->sectorIndex   = sector;
+    data->pointNum      = (rowEnd - rowStart) * scanPointNum;
+    data->compressed    = 0;
+
+    if (positionInst >= 0)
+    {
+        ret = position->getData(&positionData, sizeof(positionData),
+                                data->recordingTime);
+        if (ret)
+        {
+            GDOS_ERROR("Can't get data from Position(%i/%i), code = %d\n",
+                       positionSys, positionInst, ret);
+            return ret;
+        }
+        memcpy(&data->refPos, &positionData.pos, sizeof(position_3d));
+    }
+    else
+    {
+        memset(&data->refPos, 0, sizeof(position_3d));
+    }
+
+    // the sector is a contiguous block of the range image ordered sweep buffer
+    memcpy(data->point, &sweepPoint[rowStart * scanPointNum],
+           data->pointNum * sizeof(scan_point));
+
+    GDOS_DBG_DETAIL("Sector %d/%d recordingTime %u pointNum %d\n", sector,
+                    sectorNum, data->recordingTime, data->pointNum);
+
+    putDataBufferWorkSpace(Scan3dData::getDatalen(data));
+    return 0;
+}
+
+/*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+
+// init_flags
+#define INIT_BIT_DATA_MODULE        0
+#define INIT_BIT_MBX_WORK           1
+#define INIT_BIT_MBX_DATA           2
+#define INIT_BIT_MTX_CREATED        3
+#define INIT_BIT_PROXY_LADAR        4
+#define INIT_BIT_PROXY_SERVO_DRIVE  5
+#define INIT_BIT_PROXY_PTZ_DRIVE    6
+#define INIT_BIT_PROXY_POSITION     7
+
+int Scan3d::moduleInit(void)
+{
+    int ret;
+
+    if (((servoDriveInst < 0) && (ptzDriveInst < 0)) ||
+        ((servoDriveInst >= 0) && (ptzDriveInst >= 0)))
+    {
+        GDOS_ERROR("Exactly one servo drive or ptz drive has to be given\n");
+        return -EINVAL;
+    }
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    // work mailbox
+    ret = createMbx(&workMbx, 1, sizeof(position_data) + sizeof(ptz_drive_data),
+                    MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_WORK);
+
+    // data mailbox (ladar and drive data)
+    ret = createMbx(&dataMbx, 10, sizeof(scan3d_ladar_data_msg),
+                    MBX_IN_USERSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_DATA);
+
+    // range image mutex
+    ret = rangeImgMtx.create();
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MTX_CREATED);
+
+    // create Ladar Proxy
+    ladar = new LadarProxy(&workMbx, ladarSys, ladarInst);
+    if (!ladar)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_LADAR);
+
+    // create ServoDrive Proxy
+    if (servoDriveInst >= 0)
+    {
+        servoDrive = new ServoDriveProxy(&workMbx, servoDriveSys, servoDriveInst);
+        if (!servoDrive)
+        {
+            ret = -ENOMEM;
+            goto init_error;
+        }
+        initBits.setBit(INIT_BIT_PROXY_SERVO_DRIVE);
+    }
+
+    // create PtzDrive Proxy
+    if (ptzDriveInst >= 0)
+    {
+        ptzDrive = new PtzDriveProxy(&workMbx, ptzDriveSys, ptzDriveInst);
+        if (!ptzDrive)
+        {
+            ret = -ENOMEM;
+            goto init_error;
+        }
+        initBits.setBit(INIT_BIT_PROXY_PTZ_DRIVE);
+    }
+
+    // create Position Proxy
+    if (positionInst >= 0)
+    {
+        position = new PositionProxy(&workMbx, positionSys, positionInst);
+        if (!position)
+        {
+            ret = -ENOMEM;
+            goto init_error;
+        }
+        initBits.setBit(INIT_BIT_PROXY_POSITION);
+    }
+
+    return 0;
+
+init_error:
+    // !!! call local cleanup function !!!
+    Scan3d::moduleCleanup();
+    return ret;
+}
+
+void Scan3d::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+
+    // free proxies
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_POSITION))
+    {
+        delete position;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_PTZ_DRIVE))
+    {
+        delete ptzDrive;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_SERVO_DRIVE))
+    {
+        delete servoDrive;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_LADAR))
+    {
+        delete ladar;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MTX_CREATED))
+    {
+        rangeImgMtx.destroy();
+    }
+
+    // delete mailboxes
+    if (initBits.testAndClearBit(INIT_BIT_MBX_DATA))
+    {
+        destroyMbx(&dataMbx);
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MBX_WORK))
+    {
+        destroyMbx(&workMbx);
+    }
+}
+
+Scan3d::Scan3d(void)
+      : RackDataModule( MODULE_CLASS_ID,
+                    5000000000llu,    // 5s datatask error sleep time
+                    16,               // command mailbox slots
+                    240,              // command mailbox data size per slot
+                    MBX_IN_KERNELSPACE | MBX_SLOT,  // command mailbox flags
+                    4,                // max buffer entries
+                    10)               // data buffer listener
+{
+    // get static module parameter
+    ladarSys        = getIntArg("ladarSys", argTab);
+    ladarInst       = getIntArg("ladarInst", argTab);
+    servoDriveSys   = getIntArg("servoDriveSys", argTab);
+    servoDriveInst  = getIntArg("servoDriveInst", argTab);
+    ptzDriveSys     = getIntArg("ptzDriveSys", argTab);
+    ptzDriveInst    = getIntArg("ptzDriveInst", argTab);
+    ptzDriveAxis    = getIntArg("ptzDriveAxis", argTab);
+    positionSys     = getIntArg("positionSys", argTab);
+    positionInst    = getIntArg("positionInst", argTab);
+
+    dataBufferMaxDataSize = sizeof(scan3d_data_msg);
+}
+
+int  main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "Scan3d");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    // create new Scan3d
+
+    Scan3d *pInst;
+
+    pInst = new Scan3d();
+    if (!pInst)
+    {
+        printf("Can't create new Scan3d -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // init
+    ret = pInst->moduleInit();
+    if (ret)
+        goto exit_error;
+
+    pInst->run();
+
+    return 0;
+
+exit_error:
+    delete (pInst);
+    return ret;
+}
@@ -0,0 +1,164 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __SCAN3D_H__
+#define __SCAN3D_H__
+
+#include <main/rack_data_module.h>
+#include <perception/scan3d_proxy.h>
+#include <drivers/ladar_proxy.h>
+#include <drivers/servo_drive_proxy.h>
+#include <drivers/ptz_drive_proxy.h>
+#include <navigation/position_proxy.h>
+
+#define MODULE_CLASS_ID             SCAN3D
+
+#define SCAN3D_SECTOR_NUM_MAX       16
+#define SCAN3D_DRIVE_HISTORY_MAX    32
+
+// scan3d data message (use max message size)
+typedef struct {
+    scan3d_data     data;
+    scan_point      point[SCAN3D_POINT_MAX];
+} __attribute__((packed)) scan3d_data_msg;
+
+// scan3d range image message (use max message size)
+typedef struct {
+    scan3d_range_img_data   data;
+    scan3d_range_img_point  point[SCAN3D_POINT_MAX];
+} __attribute__((packed)) scan3d_range_img_msg;
+
+typedef struct {
+    ladar_data      data;
+    ladar_point     point[LADAR_DATA_MAX_POINT_NUM];
+} __attribute__((packed)) scan3d_ladar_data_msg;
+
+// drive angle sample
+typedef struct {
+    rack_time_t     recordingTime;
+    float           angle;
+} scan3d_drive_sample;
+
+/**
+ * Scan3d
+ *
+ * Assembles 3d scans out of a ladar stream and the angle stream of a
+ * ServoDrive or PtzDrive. The drive angle of every ladar point is time
+ * interpolated. Points are stored in range image order (one row per 2d scan)
+ * and every sector is published as soon as it is complete.
+ *
+ * @ingroup modules_scan3d
+ */
+class Scan3d : public RackDataModule {
+    private:
+
+        // own vars
+        int             ladarSys;
+        int             ladarInst;
+        int             servoDriveSys;
+        int             servoDriveInst;
+        int             ptzDriveSys;
+        int             ptzDriveInst;
+        int             ptzDriveAxis;
+        int             positionSys;
+        int             positionInst;
+
+        int             scanMode;
+        int             scanNum;
+        int             sectorNum;
+        int             maxRange;
+        int             driveAngleMin;
+        int             driveAngleMax;
+        int             driveVel;
+        int             sensorOffsetX;
+        int             sensorOffsetY;
+        int             sensorOffsetZ;
+
+        float           driveAngleMinFloat;
+        float           driveAngleMaxFloat;
+        float           driveVelFloat;
+        float           driveTarget;
+        int             driveDir;
+
+        // sweep state
+        int             scanPointNum;
+        int             sectorScanNum;
+        rack_time_t     sweepStartTime;
+        int             sectorState[SCAN3D_SECTOR_NUM_MAX];
+        rack_time_t     sectorTimeStart[SCAN3D_SECTOR_NUM_MAX];
+        rack_time_t     sectorTimeEnd[SCAN3D_SECTOR_NUM_MAX];
+
+        // drive angle history (ring buffer)
+        scan3d_drive_sample driveHistory[SCAN3D_DRIVE_HISTORY_MAX];
+        int             driveHistoryIndex;
+        int             driveHistoryNum;
+
+        // ladar beam direction cache
+        int             beamNum;
+        float           beamAngleFirst;
+        float           beamAngleLast;
+        float           beamCos[LADAR_DATA_MAX_POINT_NUM];
+        float           beamSin[LADAR_DATA_MAX_POINT_NUM];
+
+        // sweep buffer in range image order
+        scan_point      sweepPoint[SCAN3D_POINT_MAX];
+
+        // double buffered range image, filled together with the sweep buffer
+        scan3d_range_img_msg    rangeImg[2];
+        int                     rangeImgWrite;
+        int                     rangeImgValid;
+        RackMutex               rangeImgMtx;
+
+        position_data   positionData;
+
+        // additional mailboxes
+        RackMailbox     workMbx;
+        RackMailbox     dataMbx;
+
+        // proxies
+        LadarProxy      *ladar;
+        ServoDriveProxy *servoDrive;
+        PtzDriveProxy   *ptzDrive;
+        PositionProxy   *position;
+
+        int   driveOn(void);
+        void  driveStopContData(void);
+        int   driveMove(float target);
+        int   driveAddSample(RackMessage *msgInfo);
+        float driveGetAngle(rack_time_t time);
+
+        void  sweepStart(void);
+        int   sweepEnd(void);
+        int   sweepAddScan(ladar_data *ladarData);
+        int   sectorPublish(int sector);
+        void  beamUpdate(ladar_data *ladarData);
+
+    protected:
+        // -> realtime context
+        int  moduleOn(void);
+        void moduleOff(void);
+        int  moduleLoop(void);
+        int  moduleCommand(RackMessage *msgInfo);
+
+        // -> non realtime context
+        void moduleCleanup(void);
+
+    public:
+        // constructor und destructor
+        Scan3d();
+        ~Scan3d() {};
+
+        // -> non realtime context
+        int  moduleInit(void);
+};
+
+#endif // __SCAN3D_H__
@@ -0,0 +1,217 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+//
+// CameraToolBench converts a synthetic image with all color conversion and
+// demosaic functions of CameraTool and reports the throughput of every
+// instruction set and thread count.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <main/argopts.h>
+#include <main/camera_tool.h>
+#include <drivers/camera_proxy.h>
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "width", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Image width, default 1280", { 1280 } },
+
+    { ARGOPT_OPT, "height", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Image height, default 1024", { 1024 } },
+
+    { ARGOPT_OPT, "loops", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of runs per function, default 20", { 20 } },
+
+    { ARGOPT_OPT, "threads", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Max number of threads, default 4", { 4 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+#define BENCH_UYVY2RGB      0
+#define BENCH_UYVY2BGR      1
+#define BENCH_UYVY2GRAY     2
+#define BENCH_BGR2RGB       3
+#define BENCH_RGB2MONO8     4
+#define BENCH_BAYER_BIL     5
+#define BENCH_BAYER_EDGE    6
+#define BENCH_MONO122MONO8  7
+#define BENCH_NUM           8
+
+static const char *benchName[BENCH_NUM] = {
+    "UYVY2RGB", "UYVY2BGR", "UYVY2Gray", "BGR2RGB", "RGB2MONO8",
+    "Bayer2RGB bilinear", "Bayer2RGB edge", "Mono122Mono8"
+};
+
+static const char *simdName[] = { "none", "sse2", "avx2" };
+
+static double timeGet(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec * 1e-6;
+}
+
+//
+// synthetic image, smooth gradients with some noise and hard edges
+//
+
+static uint32_t noiseState = 12345;
+
+static int noiseGet(int amplitude)
+{
+    noiseState = noiseState * 1103515245 + 12345;
+    return (int)((noiseState >> 16) % (2 * amplitude + 1)) - amplitude;
+}
+
+static void imageCreate(uint8_t *image, int width, int height, int bytes)
+{
+    int x, y, i, value;
+
+    for (y = 0; y < height; y++)
+    {
+        for (x = 0; x < width; x++)
+        {
+            for (i = 0; i < bytes; i++)
+            {
+                value = (x * 255 / width + y * 255 / height) / 2 + 40 * i + noiseGet(4);
+
+                if (((x / 64) + (y / 64)) & 1)
+                {
+                    value = 255 - value;
+                }
+                if (value < 0)
+                {
+                    value = 0;
+                }
+                else if (value > 255)
+                {
+                    value = 255;
+                }
+                image[(y * width + x) * bytes + i] = (uint8_t)value;
+            }
+        }
+    }
+}
+
+static void benchRun(CameraTool *tool, int bench, uint8_t *out, uint8_t *in,
+                    int width, int height, int threads)
+{
+    switch (bench)
+    {
+    case BENCH_UYVY2RGB:
+        CameraTool::convertCharUYVY2RGB(out, in, width, height, threads);
+        break;
+    case BENCH_UYVY2BGR:
+        CameraTool::convertCharUYVY2BGR(out, in, width, height, threads);
+        break;
+    case BENCH_UYVY2GRAY:
+        CameraTool::convertCharUYVY2Gray(out, in, width, height, threads);
+        break;
+    case BENCH_BGR2RGB:
+        CameraTool::convertCharBGR2RGB(out, in, width, height, threads);
+        break;
+    case BENCH_RGB2MONO8:
+        CameraTool::convertCharRGB2MONO8(out, in, width, height, threads);
+        break;
+    case BENCH_BAYER_BIL:
+        CameraTool::convertCharBayer2RGB(out, in, width, height, COLORFILTER_RGGB,
+                                         CAMERA_TOOL_DEMOSAIC_BILINEAR, threads);
+        break;
+    case BENCH_BAYER_EDGE:
+        CameraTool::convertCharBayer2RGB(out, in, width, height, COLORFILTER_RGGB,
+                                         CAMERA_TOOL_DEMOSAIC_EDGE, threads);
+        break;
+    case BENCH_MONO122MONO8:
+        tool->convertCharMono122Mono8(out, in, width, height, 64, 4000, 2.2f, threads);
+        break;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    arg_descriptor_t argDesc[] = { { argTab }, { NULL } };
+    int     width, height, loops, threadsMax;
+    int     ret, bench, simd, simdMax, threads, loop;
+    double  t;
+
+    ret = argScan(argc, argv, argDesc, "CameraToolBench");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    width      = getIntArg("width", argTab);
+    height     = getIntArg("height", argTab);
+    loops      = getIntArg("loops", argTab);
+    threadsMax = getIntArg("threads", argTab);
+
+    if ((width < 16) || (height < 16) || (loops <= 0) || (threadsMax <= 0))
+    {
+        printf("Invalid image size or loop count\n");
+        return -EINVAL;
+    }
+
+    uint8_t     *in   = (uint8_t *)malloc(width * height * 3);
+    uint8_t     *out  = (uint8_t *)malloc(width * height * 3);
+    CameraTool  *tool = new CameraTool();
+
+    if (!in || !out || !tool)
+    {
+        printf("Can't allocate memory\n");
+        return -ENOMEM;
+    }
+
+    imageCreate(in, width, height, 3);
+
+    simdMax = CameraTool::setSimd(CAMERA_TOOL_SIMD_AVX2);
+
+    printf("%d x %d pixels, %d loops\n\n", width, height, loops);
+    printf("%-20s %-6s %8s %10s %10s\n", "function", "simd", "threads", "ms", "MPixel/s");
+
+    for (bench = 0; bench < BENCH_NUM; bench++)
+    {
+        for (simd = CAMERA_TOOL_SIMD_NONE; simd <= simdMax; simd++)
+        {
+            CameraTool::setSimd(simd);
+
+            for (threads = 1; threads <= threadsMax; threads *= 2)
+            {
+                // warm up
+                benchRun(tool, bench, out, in, width, height, threads);
+
+                t = timeGet();
+                for (loop = 0; loop < loops; loop++)
+                {
+                    benchRun(tool, bench, out, in, width, height, threads);
+                }
+                t = (timeGet() - t) / loops;
+
+                printf("%-20s %-6s %8d %10.2f %10.1f\n", benchName[bench], simdName[simd],
+                       threads, t * 1e3, width * height / t / 1e6);
+            }
+        }
+    }
+
+    delete tool;
+    free(out);
+    free(in);
+    return 0;
+}
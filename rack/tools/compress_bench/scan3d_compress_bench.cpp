@@ -0,0 +1,301 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+//
+// Scan3dCompressBench compresses a synthetic 3d scan with all step 1-3 flag
+// combinations of Scan3dCompressTool and reports compression ratio, compression
+// and decompression throughput and if the data was reconstructed losslessly.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/time.h>
+
+#include <main/argopts.h>
+#include <main/scan3d_compress_tool.h>
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "scanNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of scanlines of the synthetic scan, default 181", { 181 } },
+
+    { ARGOPT_OPT, "scanPointNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of points per scanline, default 361", { 361 } },
+
+    { ARGOPT_OPT, "maxRange", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum range of the synthetic scanner in mm, default 8000", { 8000 } },
+
+    { ARGOPT_OPT, "loops", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of runs per flag combination, default 10", { 10 } },
+
+    { ARGOPT_OPT, "blockLines", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Scanlines per block of COMPR_S1_RANGE_PRED, default 0 (tool default)", { 0 } },
+
+    { ARGOPT_OPT, "threads", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Threads of COMPR_S1_RANGE_PRED, default 1", { 1 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+typedef struct {
+    const char  *name;
+    uint32_t    flags;
+} bench_flags;
+
+static bench_flags step1Flags[] = {
+    { "S1_NONE",            COMPR_S1_NONE },
+    { "S1_REDUCE_BITS",     COMPR_S1_REDUCE_BITS },
+    { "S1_REDUCE_BYTES",    COMPR_S1_REDUCE_BYTES },
+    { "S1_REDUCE_222110",   COMPR_S1_REDUCE_BYTES_222110 },
+    { "S1_DELTA_RLE",       COMPR_S1_DELTA_RLE },
+    { "S1_RANGE_PRED",      COMPR_S1_RANGE_PRED },
+};
+
+static bench_flags step2Flags[] = {
+    { "S2_NONE",            COMPR_S2_NONE },
+    { "S2_MTF",             COMPR_S2_MTF },
+#ifdef COMPR_USE_LZSS
+    { "S2_LZSS",            COMPR_S2_LZSS },
+#endif
+#ifdef COMPR_USE_LZW
+    { "S2_LZW",             COMPR_S2_LZW },
+#endif
+#ifdef COMPR_USE_BWT
+    { "S2_BWT",             COMPR_S2_BWT },
+    { "S2_BWT_MTF",         COMPR_S2_BWT_MTF },
+#endif
+};
+
+static bench_flags step3Flags[] = {
+    { "S3_NONE",            COMPR_S3_NONE },
+    { "S3_HUFFMANN",        COMPR_S3_HUFFMANN },
+#ifdef COMPR_USE_ADHUFF
+    { "S3_AD_HUFFMANN",     COMPR_S3_AD_HUFFMANN },
+#endif
+};
+
+#define FLAGS_NUM(a)    (sizeof(a) / sizeof(a[0]))
+
+static double timeGet(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec * 1e-6;
+}
+
+//
+// synthetic roll scan of a 10m x 6m x 3m room with sensor noise
+//
+
+static uint32_t noiseState = 12345;
+
+static int noiseGet(int amplitude)
+{
+    noiseState = noiseState * 1103515245 + 12345;
+    return (int)((noiseState >> 16) % (2 * amplitude + 1)) - amplitude;
+}
+
+static float boxRange(float dx, float dy, float dz)
+{
+    const float boxMin[3] = { -3000.0f, -3000.0f, -1000.0f };
+    const float boxMax[3] = {  7000.0f,  3000.0f,  2000.0f };
+    float       dir[3]    = { dx, dy, dz };
+    float       range     = 1e9f;
+    float       t;
+    int         i;
+
+    for (i = 0; i < 3; i++)
+    {
+        if (dir[i] > 1e-6f)
+        {
+            t = boxMax[i] / dir[i];
+        }
+        else if (dir[i] < -1e-6f)
+        {
+            t = boxMin[i] / dir[i];
+        }
+        else
+        {
+            continue;
+        }
+        if (t < range)
+        {
+            range = t;
+        }
+    }
+    return range;
+}
+
+static void scanCreate(scan3d_data *data, int scanNum, int scanPointNum, int maxRange)
+{
+    int     i, j;
+    float   roll, angle, range;
+    float   dx, dy, dz;
+    scan_point *point;
+
+    memset(data, 0, sizeof(scan3d_data));
+    data->maxRange      = maxRange;
+    data->scanNum       = scanNum;
+    data->scanPointNum  = scanPointNum;
+    data->scanMode      = SCAN3D_ROLL;
+    data->sectorNum     = 1;
+    data->pointNum      = scanNum * scanPointNum;
+
+    for (i = 0; i < scanNum; i++)
+    {
+        roll = -M_PI / 2.0f + M_PI * i / (float)scanNum;
+
+        for (j = 0; j < scanPointNum; j++)
+        {
+            angle = -M_PI / 2.0f + M_PI * j / (float)(scanPointNum - 1);
+            point = &data->point[i * scanPointNum + j];
+
+            dx    = cos(angle);
+            dy    = sin(angle) * cos(roll);
+            dz    = sin(angle) * sin(roll);
+            range = boxRange(dx, dy, dz);
+
+            if (range > maxRange)
+            {
+                point->type = SCAN_POINT_TYPE_INVALID | SCAN_POINT_TYPE_MAX_RANGE;
+                continue;
+            }
+
+            range           += noiseGet(10);
+            point->x         = (int32_t)(range * dx);
+            point->y         = (int32_t)(range * dy);
+            point->z         = (int32_t)(range * dz);
+            point->type      = SCAN_POINT_TYPE_UNKNOWN;
+            point->segment   = 0;
+            point->intensity = (int16_t)(200 - range / 50 + noiseGet(3));
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    arg_descriptor_t argDesc[] = { { argTab }, { NULL } };
+    int     scanNum, scanPointNum, maxRange, loops, blockLines, threads;
+    int     ret, i, k, l, loop, lossless;
+    size_t  dataLen;
+    double  t, tCompr, tUncompr, ratio;
+    uint32_t flags1, comprLen = 0;
+
+    ret = argScan(argc, argv, argDesc, "Scan3dCompressBench");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    scanNum      = getIntArg("scanNum", argTab);
+    scanPointNum = getIntArg("scanPointNum", argTab);
+    maxRange     = getIntArg("maxRange", argTab);
+    loops        = getIntArg("loops", argTab);
+    blockLines   = getIntArg("blockLines", argTab);
+    threads      = getIntArg("threads", argTab);
+
+    if ((scanNum * scanPointNum > SCAN3D_POINT_MAX) || (scanNum * scanPointNum <= 0) ||
+        (loops <= 0))
+    {
+        printf("Invalid scan size, max %d points\n", SCAN3D_POINT_MAX);
+        return -EINVAL;
+    }
+
+    dataLen = sizeof(scan3d_data) + scanNum * scanPointNum * sizeof(scan_point);
+
+    scan3d_data        *orig  = (scan3d_data *)malloc(dataLen);
+    scan3d_data        *work  = (scan3d_data *)malloc(sizeof(scan3d_data) +
+                                                      SCAN3D_POINT_MAX * sizeof(scan_point));
+    Scan3dCompressTool *tool  = new Scan3dCompressTool();
+
+    if (!orig || !work || !tool)
+    {
+        printf("Can't allocate memory\n");
+        return -ENOMEM;
+    }
+
+    scanCreate(orig, scanNum, scanPointNum, maxRange);
+
+    printf("%d x %d points, %d bytes, %d loops\n\n", scanNum, scanPointNum,
+           (int)(dataLen - sizeof(scan3d_data)), loops);
+    printf("%-18s %-10s %-15s %8s %12s %12s %9s\n", "step 1", "step 2", "step 3",
+           "ratio", "compr MB/s", "uncomp MB/s", "lossless");
+
+    for (i = 0; i < (int)FLAGS_NUM(step1Flags); i++)
+    {
+        for (k = 0; k < (int)FLAGS_NUM(step2Flags); k++)
+        {
+            for (l = 0; l < (int)FLAGS_NUM(step3Flags); l++)
+            {
+                flags1 = step1Flags[i].flags;
+                if (flags1 == COMPR_S1_RANGE_PRED)
+                {
+                    flags1 = COMPR_S1_RANGE_PRED_PARAM(blockLines);
+                }
+
+                tCompr   = 0.0;
+                tUncompr = 0.0;
+                lossless = 1;
+
+                for (loop = 0; loop < loops; loop++)
+                {
+                    memcpy(work, orig, dataLen);
+
+                    t = timeGet();
+                    comprLen = tool->Compress(work, flags1, step2Flags[k].flags,
+                                              step3Flags[l].flags, threads);
+                    tCompr += timeGet() - t;
+
+                    if (comprLen == 0)
+                    {
+                        break;
+                    }
+#ifdef COMPR_UNCOMPR
+                    t = timeGet();
+                    tool->Decompress(work);
+                    tUncompr += timeGet() - t;
+
+                    if (memcmp(work->point, orig->point, dataLen - sizeof(scan3d_data)))
+                    {
+                        lossless = 0;
+                    }
+#endif
+                }
+
+                if (comprLen == 0)
+                {
+                    continue;
+                }
+
+                ratio = (double)(dataLen - sizeof(scan3d_data)) / (double)comprLen;
+
+                printf("%-18s %-10s %-15s %8.2f %12.1f %12.1f %9s\n",
+                       step1Flags[i].name, step2Flags[k].name, step3Flags[l].name,
+                       ratio,
+                       (dataLen - sizeof(scan3d_data)) * loops / tCompr / 1e6,
+                       tUncompr > 0.0 ?
+                       (dataLen - sizeof(scan3d_data)) * loops / tUncompr / 1e6 : 0.0,
+                       tUncompr > 0.0 ? (lossless ? "yes" : "no") : "-");
+            }
+        }
+    }
+
+    delete tool;
+    free(work);
+    free(orig);
+    return 0;
+}
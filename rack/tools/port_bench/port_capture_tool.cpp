@@ -0,0 +1,217 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+//
+// PortCaptureTool prints the content of a PortCapture file (see
+// main/port_capture.h) and writes fuzzed copies of it. A driver started with
+// RACK_REPLAY=<dir> and RACK_REPLAY_SPEED=0 parses the capture as fast as
+// possible and reports its throughput and latency at the end of the file.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <main/argopts.h>
+#include <main/port_capture.h>
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_REQ, "file", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Capture file", { 0 } },
+
+    { ARGOPT_OPT, "fuzz", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Write a fuzzed copy of the capture to this file", { 0 } },
+
+    { ARGOPT_OPT, "flipRate", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Fuzz: flipped bits per 10000 received bytes, default 10", { 10 } },
+
+    { ARGOPT_OPT, "cutRate", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Fuzz: shortened records per 1000 records, default 10", { 10 } },
+
+    { ARGOPT_OPT, "seed", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Fuzz: random seed, default 1", { 1 } },
+
+    { ARGOPT_OPT, "dump", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Print the first n records, default 0", { 0 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+static uint32_t randState;
+
+static uint32_t randGet(uint32_t range)
+{
+    randState = randState * 1103515245 + 12345;
+    return (randState >> 8) % range;
+}
+
+static void recordDump(port_capture_record *rec, uint8_t *data)
+{
+    uint32_t i;
+
+    printf("%14.6f ms  time %10u  %s %5u bytes ", (double)rec->time * 1e-6,
+           rec->recordingTime, (rec->dir == PORT_CAPTURE_RX) ? "rx" : "tx", rec->len);
+
+    for (i = 0; (i < rec->len) && (i < 16); i++)
+    {
+        printf(" %02x", data[i]);
+    }
+    printf("%s\n", (rec->len > 16) ? " ..." : "");
+}
+
+int main(int argc, char *argv[])
+{
+    arg_descriptor_t    argDesc[] = { { argTab }, { NULL } };
+    port_capture_header head;
+    port_capture_record rec;
+    FILE                *in, *out = NULL;
+    char                *fileName, *fuzzName;
+    uint8_t             *data;
+    int                 flipRate, cutRate, dump, ret;
+    uint32_t            num[2] = { 0, 0 }, lenMin = 0xffffffff, lenMax = 0, i, n;
+    uint64_t            bytes[2] = { 0, 0 }, timeFirst = 0, timeLast = 0;
+    uint32_t            flipNum = 0, cutNum = 0;
+    double              duration;
+
+    ret = argScan(argc, argv, argDesc, "PortCaptureTool");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    fileName  = getStrArg("file", argTab);
+    fuzzName  = getStrArg("fuzz", argTab);
+    flipRate  = getIntArg("flipRate", argTab);
+    cutRate   = getIntArg("cutRate", argTab);
+    randState = getIntArg("seed", argTab);
+    dump      = getIntArg("dump", argTab);
+
+    in = fopen(fileName, "rb");
+    if (!in)
+    {
+        printf("Can't open capture file %s\n", fileName);
+        return -ENOENT;
+    }
+
+    if ((fread(&head, sizeof(head), 1, in) != 1) ||
+        (head.magic != PORT_CAPTURE_MAGIC) ||
+        (head.version != PORT_CAPTURE_VERSION))
+    {
+        printf("%s is no capture file\n", fileName);
+        fclose(in);
+        return -EINVAL;
+    }
+
+    if (fuzzName)
+    {
+        out = fopen(fuzzName, "wb");
+        if (!out)
+        {
+            printf("Can't create fuzz file %s\n", fuzzName);
+            fclose(in);
+            return -EIO;
+        }
+        fwrite(&head, sizeof(head), 1, out);
+    }
+
+    data = (uint8_t *)malloc(PORT_CAPTURE_RECORD_MAX);
+    if (!data)
+    {
+        printf("Can't allocate memory\n");
+        return -ENOMEM;
+    }
+
+    head.name[sizeof(head.name) - 1] = 0;
+    printf("port %s\n", head.name);
+
+    while (fread(&rec, sizeof(rec), 1, in) == 1)
+    {
+        if ((rec.len > PORT_CAPTURE_RECORD_MAX) ||
+            ((rec.len > 0) && (fread(data, rec.len, 1, in) != 1)))
+        {
+            printf("capture file is truncated\n");
+            break;
+        }
+
+        if ((int)(num[0] + num[1]) < dump)
+        {
+            recordDump(&rec, data);
+        }
+
+        if (!timeFirst)
+        {
+            timeFirst = rec.time;
+        }
+        timeLast = rec.time;
+
+        n = (rec.dir == PORT_CAPTURE_RX) ? 0 : 1;
+        num[n]++;
+        bytes[n] += rec.len;
+
+        if (n == 0)
+        {
+            lenMin = (rec.len < lenMin) ? rec.len : lenMin;
+            lenMax = (rec.len > lenMax) ? rec.len : lenMax;
+        }
+
+        if (!out)
+        {
+            continue;
+        }
+
+        // only the received data is fuzzed
+        if ((n == 0) && (rec.len > 0))
+        {
+            n = (uint32_t)(((uint64_t)rec.len * flipRate + randGet(10000)) / 10000);
+            for (i = 0; i < n; i++)
+            {
+                data[randGet(rec.len)] ^= 1 << randGet(8);
+                flipNum++;
+            }
+
+            if ((rec.len > 1) && ((int)randGet(1000) < cutRate))
+            {
+                rec.len = 1 + randGet(rec.len - 1);
+                cutNum++;
+            }
+        }
+
+        fwrite(&rec, sizeof(rec), 1, out);
+        fwrite(data, rec.len, 1, out);
+    }
+
+    duration = (double)(timeLast - timeFirst) * 1e-9;
+
+    printf("rx %u records, %llu bytes, record size %u .. %u\n", num[0],
+           (unsigned long long)bytes[0], num[0] ? lenMin : 0, lenMax);
+    printf("tx %u records, %llu bytes\n", num[1], (unsigned long long)bytes[1]);
+    printf("duration %.3f s", duration);
+    if (duration > 0.0)
+    {
+        printf(", rx %.1f records/s, %.1f kB/s", num[0] / duration, bytes[0] / duration / 1e3);
+    }
+    printf("\n");
+
+    if (out)
+    {
+        printf("fuzzed copy %s, %u flipped bits, %u shortened records\n",
+               fuzzName, flipNum, cutNum);
+        fclose(out);
+    }
+
+    free(data);
+    fclose(in);
+    return 0;
+}
@@ -0,0 +1,430 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+
+#include "bench_data.h"
+
+double BenchRandom::gauss(double sigma)
+{
+    double u, v;
+
+    // Box-Muller
+    u = ((double)(next() >> 8) + 1.0) / 16777217.0;
+    v =  (double)(next() >> 8) / 16777216.0;
+
+    return sigma * sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+//
+// map
+//
+
+static void mapAddLine(DxfMap *map, double x, double y, double x2, double y2, int layer)
+{
+    dxf_map_feature *f;
+    double          dx, dy;
+
+    f        = &map->feature[map->featureNum];
+    f->x     = x;
+    f->y     = y;
+    f->x2    = x2;
+    f->y2    = y2;
+    f->layer = layer;
+
+    dx       = x2 - x;
+    dy       = y2 - y;
+    f->l     = sqrt(dx * dx + dy * dy);
+
+    if (f->l > 0.0)
+    {
+        f->rho = atan2(dy, dx);
+        f->sin = sin(f->rho);
+        f->cos = cos(f->rho);
+    }
+    else
+    {
+        f->rho = 0.0;
+        f->sin = 0.0;
+        f->cos = 1.0;
+    }
+
+    map->featureNum++;
+}
+
+// wall from (x, y) to (x2, y2) with a door of doorWidth in the middle
+static void mapAddWall(DxfMap *map, double x, double y, double x2, double y2,
+                       double doorWidth)
+{
+    double  l, ux, uy, a, b;
+
+    l  = sqrt((x2 - x) * (x2 - x) + (y2 - y) * (y2 - y));
+    ux = (x2 - x) / l;
+    uy = (y2 - y) / l;
+    a  = (l - doorWidth) / 2.0;
+    b  = (l + doorWidth) / 2.0;
+
+    mapAddLine(map, x, y, x + ux * a, y + uy * a, 0);
+    mapAddLine(map, x + ux * b, y + uy * b, x2, y2, 0);
+}
+
+int benchMapFeatureNum(int roomsX, int roomsY)
+{
+    // outer walls, two walls with doors, a pillar and a reflector per room
+    return 4 + roomsX * roomsY * (2 * 2 + 4 + 1);
+}
+
+int benchMapCreate(DxfMap *map, int roomsX, int roomsY, double roomSize,
+                   BenchRandom *rnd)
+{
+    double  x, y, w, px, py;
+    int     i, j, k;
+
+    map->featureNum = 0;
+
+    // outer walls
+    w    = roomsX * roomSize;
+    mapAddLine(map, 0.0, 0.0, w, 0.0, 0);
+    mapAddLine(map, w, 0.0, w, roomsY * roomSize, 0);
+    mapAddLine(map, w, roomsY * roomSize, 0.0, roomsY * roomSize, 0);
+    mapAddLine(map, 0.0, roomsY * roomSize, 0.0, 0.0, 0);
+
+    for (i = 0; i < roomsX; i++)
+    {
+        for (j = 0; j < roomsY; j++)
+        {
+            x = i * roomSize;
+            y = j * roomSize;
+
+            // inner walls with doors
+            if (i > 0)
+            {
+                mapAddWall(map, x, y, x, y + roomSize, 900.0);
+            }
+            if (j > 0)
+            {
+                mapAddWall(map, x, y, x + roomSize, y, 900.0);
+            }
+
+            // a pillar and a reflector post per room
+            px   = x + roomSize * (0.2 + 0.6 * rnd->range(0, 1000) / 1000.0);
+            py   = y + roomSize * (0.2 + 0.6 * rnd->range(0, 1000) / 1000.0);
+            mapAddLine(map, px, py, px + 300.0, py, 0);
+            mapAddLine(map, px + 300.0, py, px + 300.0, py + 300.0, 0);
+            mapAddLine(map, px + 300.0, py + 300.0, px, py + 300.0, 0);
+            mapAddLine(map, px, py + 300.0, px, py, 0);
+
+            k    = rnd->range(0, 3);
+            px   = x + ((k & 1) ? roomSize - 200.0 : 200.0);
+            py   = y + ((k & 2) ? roomSize - 200.0 : 200.0);
+            mapAddLine(map, px - 40.0, py, px + 40.0, py, 1);
+        }
+    }
+
+    map->xMin = 0.0;
+    map->yMin = 0.0;
+    map->xMax = roomsX * roomSize;
+    map->yMax = roomsY * roomSize;
+
+    return map->buildIndex();
+}
+
+//
+// ladar
+//
+
+int benchLadarCreate(ladar_data *data, int pointNum, double fieldOfView,
+                     int maxRange, DxfMap *map, double x, double y, double rho,
+                     BenchRandom *rnd)
+{
+    static double   angle[LADAR_DATA_MAX_POINT_NUM];
+    static double   distance[LADAR_DATA_MAX_POINT_NUM];
+    ladar_point     *p;
+    double          d, px, py, fx, fy;
+    int             i, k, ret;
+
+    if ((pointNum < 2) || (pointNum > LADAR_DATA_MAX_POINT_NUM))
+    {
+        return -EINVAL;
+    }
+
+    for (i = 0; i < pointNum; i++)
+    {
+        angle[i] = -fieldOfView / 2.0 + fieldOfView * i / (pointNum - 1);
+    }
+
+    ret = map->raycast(x, y, rho, angle, pointNum, (double)maxRange, distance);
+    if (ret)
+    {
+        return ret;
+    }
+
+    data->recordingTime = 0;
+    data->duration      = 100;
+    data->maxRange      = maxRange;
+    data->startAngle    = (float)angle[0];
+    data->endAngle      = (float)angle[pointNum - 1];
+    data->pointNum      = pointNum;
+
+    for (i = 0; i < pointNum; i++)
+    {
+        p            = &data->point[i];
+        p->angle     = (float)angle[i];
+        p->type      = LADAR_POINT_TYPE_UNKNOWN;
+        p->intensity = 200 + rnd->range(-20, 20);
+
+        d = distance[i];
+        if (d >= maxRange)
+        {
+            p->distance = maxRange;
+            continue;
+        }
+
+        // 10 mm range noise
+        d += rnd->gauss(10.0);
+        p->distance = (int32_t)(d < 1.0 ? 1.0 : d);
+
+        // reflector posts of layer 1
+        px = x + d * cos(rho + angle[i]);
+        py = y + d * sin(rho + angle[i]);
+        for (k = 0; k < map->featureNum; k++)
+        {
+            if (map->feature[k].layer != 1)
+            {
+                continue;
+            }
+            fx = (map->feature[k].x + map->feature[k].x2) / 2.0 - px;
+            fy = (map->feature[k].y + map->feature[k].y2) / 2.0 - py;
+            if (fx * fx + fy * fy < 100.0 * 100.0)
+            {
+                p->type      = LADAR_POINT_TYPE_REFLECTOR;
+                p->intensity = 1000 + rnd->range(-50, 50);
+                break;
+            }
+        }
+
+        // dropouts
+        switch (rnd->range(0, 199))
+        {
+            case 0:
+                p->type     = LADAR_POINT_TYPE_INVALID;
+                p->distance = 0;
+                break;
+            case 1:
+                p->type     = LADAR_POINT_TYPE_TRANSPARENT;
+                break;
+            case 2:
+                p->type     = LADAR_POINT_TYPE_RAIN;
+                p->distance = rnd->range(200, 2000);
+                break;
+        }
+    }
+
+    return 0;
+}
+
+//
+// camera
+//
+
+static int cameraDepth(int mode)
+{
+    switch (mode)
+    {
+        case CAMERA_MODE_MONO8:
+        case CAMERA_MODE_RAW8:
+        case CAMERA_MODE_SEGMENT:
+        case CAMERA_MODE_TYPE:
+        case CAMERA_MODE_EDGE:
+            return 8;
+
+        case CAMERA_MODE_MONO12:
+        case CAMERA_MODE_MONO16:
+        case CAMERA_MODE_RGB565:
+        case CAMERA_MODE_YUV422:
+        case CAMERA_MODE_RAW12:
+        case CAMERA_MODE_RAW16:
+        case CAMERA_MODE_RANGE:
+        case CAMERA_MODE_INTENSITY:
+        case CAMERA_MODE_TYPE_INTENSITY:
+        case CAMERA_MODE_RANGE_TYPE:
+        case CAMERA_MODE_ELEVATION:
+        case CAMERA_MODE_DISPARITY:
+            return 16;
+
+        case CAMERA_MODE_MONO24:
+        case CAMERA_MODE_RGB24:
+            return 24;
+
+        default:
+            return 0;
+    }
+}
+
+int benchCameraSize(int mode, int width, int height)
+{
+    return width * height * cameraDepth(mode) / 8;
+}
+
+// gray value of a pixel in [0, 1], gradient with a checkerboard of 64 pixels
+static double cameraValue(int x, int y, int width, int height, int channel)
+{
+    double v;
+
+    v = ((double)x / width + (double)y / height) / 2.0 + 0.15 * channel;
+    if (v > 1.0)
+    {
+        v -= 1.0;
+    }
+    if (((x / 64) + (y / 64)) & 1)
+    {
+        v = 1.0 - v;
+    }
+    return v;
+}
+
+static int cameraNoise(int value, int max, int amplitude, BenchRandom *rnd)
+{
+    value += rnd->range(-amplitude, amplitude);
+
+    if (value < 0)
+    {
+        return 0;
+    }
+    if (value > max)
+    {
+        return max;
+    }
+    return value;
+}
+
+// channel of a bayer pixel, 0 red, 1 green, 2 blue
+static int bayerChannel(int x, int y, int colorFilterId)
+{
+    static const int pattern[4][4] = {
+        { 0, 1, 1, 2 },         // COLORFILTER_RGGB
+        { 1, 2, 0, 1 },         // COLORFILTER_GBRG
+        { 1, 0, 2, 1 },         // COLORFILTER_GRBG
+        { 2, 1, 1, 0 },         // COLORFILTER_BGGR
+    };
+
+    return pattern[(colorFilterId - COLORFILTER_RGGB) & 3][((y & 1) << 1) | (x & 1)];
+}
+
+int benchCameraCreate(camera_data *data, int mode, int width, int height,
+                      int colorFilterId, BenchRandom *rnd)
+{
+    uint8_t     *out = data->byteStream;
+    uint16_t    *out16 = (uint16_t *)data->byteStream;
+    int         x, y, c, v, size;
+
+    size = benchCameraSize(mode, width, height);
+    if ((size <= 0) || (size > CAMERA_MAX_BYTES))
+    {
+        return -EINVAL;
+    }
+
+    data->recordingTime = 0;
+    data->width         = width;
+    data->height        = height;
+    data->depth         = cameraDepth(mode);
+    data->mode          = mode;
+    data->colorFilterId = colorFilterId;
+
+    for (y = 0; y < height; y++)
+    {
+        for (x = 0; x < width; x++)
+        {
+            switch (mode)
+            {
+                case CAMERA_MODE_MONO8:
+                case CAMERA_MODE_SEGMENT:
+                case CAMERA_MODE_TYPE:
+                case CAMERA_MODE_EDGE:
+                    *out++ = cameraNoise((int)(cameraValue(x, y, width, height, 0) * 255),
+                                         255, 4, rnd);
+                    break;
+
+                case CAMERA_MODE_RAW8:
+                    c      = bayerChannel(x, y, colorFilterId);
+                    *out++ = cameraNoise((int)(cameraValue(x, y, width, height, c) * 255),
+                                         255, 4, rnd);
+                    break;
+
+                case CAMERA_MODE_MONO12:
+                    v      = cameraNoise((int)(cameraValue(x, y, width, height, 0) * 4095),
+                                         4095, 16, rnd);
+                    *out++ = (uint8_t)(v >> 8);
+                    *out++ = (uint8_t)v;
+                    break;
+
+                case CAMERA_MODE_RAW12:
+                case CAMERA_MODE_RAW16:
+                    c        = bayerChannel(x, y, colorFilterId);
+                    v        = (mode == CAMERA_MODE_RAW12) ? 4095 : 65535;
+                    *out16++ = cameraNoise((int)(cameraValue(x, y, width, height, c) * v),
+                                           v, v / 256, rnd);
+                    break;
+
+                case CAMERA_MODE_RGB565:
+                    v        = (int)(cameraValue(x, y, width, height, 0) * 31);
+                    *out16++ = (uint16_t)((v << 11) | (v << 6) | v);
+                    break;
+
+                case CAMERA_MODE_YUV422:
+                    // U Y V Y, the chroma of two pixels is shared
+                    *out++ = 128 + rnd->range(-8, 8);
+                    *out++ = cameraNoise((int)(cameraValue(x, y, width, height, 0) * 255),
+                                         255, 4, rnd);
+                    break;
+
+                case CAMERA_MODE_MONO24:
+                case CAMERA_MODE_RGB24:
+                    for (c = 0; c < 3; c++)
+                    {
+                        *out++ = cameraNoise((int)(cameraValue(x, y, width, height, c) * 255),
+                                             255, 4, rnd);
+                    }
+                    break;
+
+                default:
+                    // mono16 and 3d images, 12 bit values like the range cameras
+                    *out16++ = cameraNoise((int)(cameraValue(x, y, width, height, 0) * 4095),
+                                           4095, 16, rnd);
+                    break;
+            }
+        }
+    }
+
+    return size;
+}
+
+//
+// position
+//
+
+void benchWgs84Create(position_wgs84_data *data, int num, BenchRandom *rnd)
+{
+    int i;
+
+    // within 50 km of Hannover
+    for (i = 0; i < num; i++)
+    {
+        data[i].latitude  = (52.37 + rnd->range(-450, 450) / 1000.0) * M_PI / 180.0;
+        data[i].longitude = ( 9.73 + rnd->range(-730, 730) / 1000.0) * M_PI / 180.0;
+        data[i].altitude  = rnd->range(40000, 120000);
+        data[i].heading   = (float)(rnd->range(-3141, 3141) / 1000.0);
+    }
+}
@@ -0,0 +1,107 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+#ifndef __BENCH_DATA_H__
+#define __BENCH_DATA_H__
+
+#include <stdio.h>
+
+#include <main/dxf_map.h>
+#include <drivers/ladar_proxy.h>
+#include <drivers/camera_proxy.h>
+#include <navigation/position_proxy.h>
+
+//
+// Synthetic sensor data of the RackBench. All generators are deterministic,
+// the same seed gives the same data on every machine.
+//
+
+/** random numbers of one generator */
+class BenchRandom
+{
+    private:
+        uint32_t state;
+
+    public:
+        BenchRandom(uint32_t seed)
+        {
+            state = seed ? seed : 1;
+        }
+
+        /** uniform in [0, 2^32) (xorshift32) */
+        uint32_t next(void)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+
+        /** uniform in [min, max] */
+        int range(int min, int max)
+        {
+            return min + (int)(next() % (uint32_t)(max - min + 1));
+        }
+
+        /** normal distribution, mean 0 */
+        double gauss(double sigma);
+};
+
+/**
+ * @brief Map of rooms and pillars
+ *
+ * A grid of @a roomsX * @a roomsY rooms of @a roomSize mm with a door in
+ * every wall, some pillars as point-like boxes and a few reflector posts
+ * (layer 1). @a map needs benchMapFeatureNum() features, the grid index
+ * is built.
+ *
+ * @return 0 on success, otherwise negative error code
+ */
+int     benchMapFeatureNum(int roomsX, int roomsY);
+
+int     benchMapCreate(DxfMap *map, int roomsX, int roomsY, double roomSize,
+                       BenchRandom *rnd);
+
+/**
+ * @brief Ladar scan of a map
+ *
+ * Raycasts the map from (x, y, rho) with @a pointNum beams over
+ * @a fieldOfView and adds range noise, dropouts (invalid, transparent, rain),
+ * max range points and reflector points close to layer 1 features.
+ *
+ * @return 0 on success, otherwise negative error code
+ */
+int     benchLadarCreate(ladar_data *data, int pointNum, double fieldOfView,
+                         int maxRange, DxfMap *map, double x, double y, double rho,
+                         BenchRandom *rnd);
+
+/** bytes of an image of @a mode, 0 if the mode isn't supported */
+int     benchCameraSize(int mode, int width, int height);
+
+/**
+ * @brief Camera image in a CAMERA_MODE_*
+ *
+ * Smooth gradients, hard edges and sensor noise. MONO12 is stored as two
+ * big endian bytes per pixel like the firewire driver delivers it, MONO16
+ * and the 3d modes as host order 16 bit values. RAW8/12/16 are Bayer images
+ * with @a colorFilterId. JPEG isn't generated.
+ *
+ * @return size of the byte stream, negative error code if the mode isn't
+ *         supported or the image doesn't fit into CAMERA_MAX_BYTES
+ */
+int     benchCameraCreate(camera_data *data, int mode, int width, int height,
+                          int colorFilterId, BenchRandom *rnd);
+
+/** positions within 50 km of Hannover */
+void    benchWgs84Create(position_wgs84_data *data, int num, BenchRandom *rnd);
+
+#endif // __BENCH_DATA_H__
@@ -0,0 +1,900 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+//
+// RackBench runs the data paths of RACK on synthetic sensor data and reports
+// the latency percentiles and the throughput of every case. It needs no
+// hardware and no TIMS router: the modules are created without mailboxes
+// and tasks, only their data buffer is set up (see BenchModule).
+//
+// Every case writes one JSON object per line:
+//
+// {"case":"scan2d.moduleLoop","param":"points=361 filter=0","loops":200,
+//  "items":361,"unit":"point","mean_us":..,"p50_us":..,"p90_us":..,
+//  "p99_us":..,"max_us":..,"items_per_s":..}
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+
+#include <main/argopts.h>
+#include <main/camera_tool.h>
+#include <main/compress_tool.h>
+#include <main/position_tool.h>
+#include <navigation/odometry_proxy.h>
+#include <perception/scan2d/scan2d.h>
+
+#include "bench_data.h"
+
+arg_table_t benchArgTab[] = {
+
+    { ARGOPT_OPT, "loops", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of measured runs per case, default 200", { 200 } },
+
+    { ARGOPT_OPT, "case", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Run only the cases starting with this name, default all", { 0 } },
+
+    { ARGOPT_OPT, "output", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "JSON output file, a table is printed to stdout, default JSON to stdout", { 0 } },
+
+    { ARGOPT_OPT, "width", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Width of the camera images, default 640", { 640 } },
+
+    { ARGOPT_OPT, "height", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Height of the camera images, default 480", { 480 } },
+
+    { ARGOPT_OPT, "seed", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Seed of the synthetic data, default 1", { 1 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+typedef struct {
+    ladar_data      data;
+    ladar_point     point[LADAR_DATA_MAX_POINT_NUM];
+} __attribute__((packed)) bench_ladar_msg;
+
+typedef struct {
+    scan2d_data     data;
+    scan_point      point[SCAN2D_POINT_MAX];
+} __attribute__((packed)) bench_scan2d_msg;
+
+typedef struct {
+    camera_data     data;
+    uint8_t         byteStream[CAMERA_MAX_BYTES];
+} __attribute__((packed)) bench_camera_msg;
+
+static int          loops;
+static char         *caseFilter;
+static FILE         *jsonFile;
+static FILE         *tableFile;
+static uint32_t     seed;
+
+//
+// measurement
+//
+
+static double       *sample;            // [us] of the measured runs
+static int          sampleNum;
+static uint64_t     sampleStart;
+
+static uint64_t benchTime(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000llu + (uint64_t)ts.tv_nsec;
+}
+
+static int benchSelected(const char *name)
+{
+    return (!caseFilter || !caseFilter[0] ||
+            (strncmp(name, caseFilter, strlen(caseFilter)) == 0));
+}
+
+// runs with a negative loop index warm up the caches and aren't measured
+static int benchWarmup(void)
+{
+    return loops / 10 + 1;
+}
+
+static inline void benchStart(void)
+{
+    sampleStart = benchTime();
+}
+
+static inline void benchStop(int loop)
+{
+    uint64_t t = benchTime();
+
+    if (loop >= 0)
+    {
+        sample[sampleNum++] = (double)(t - sampleStart) * 1e-3;
+    }
+}
+
+static int benchCompare(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+
+    return (da < db) ? -1 : (da > db);
+}
+
+// nearest rank percentile of the sorted samples
+static double benchPercentile(double p)
+{
+    int i = (int)ceil(p / 100.0 * sampleNum) - 1;
+
+    if (i < 0)
+    {
+        i = 0;
+    }
+    return sample[i];
+}
+
+static void benchReport(const char *name, const char *param, int items, const char *unit)
+{
+    double  mean = 0.0;
+    int     i;
+
+    if (!sampleNum)
+    {
+        return;
+    }
+
+    qsort(sample, sampleNum, sizeof(double), benchCompare);
+
+    for (i = 0; i < sampleNum; i++)
+    {
+        mean += sample[i];
+    }
+    mean /= sampleNum;
+
+    fprintf(jsonFile, "{\"case\":\"%s\",\"param\":\"%s\",\"loops\":%d,\"items\":%d,"
+            "\"unit\":\"%s\",\"mean_us\":%.3f,\"p50_us\":%.3f,\"p90_us\":%.3f,"
+            "\"p99_us\":%.3f,\"max_us\":%.3f,\"items_per_s\":%.1f}\n",
+            name, param, sampleNum, items, unit, mean, benchPercentile(50.0),
+            benchPercentile(90.0), benchPercentile(99.0), sample[sampleNum - 1],
+            items / mean * 1e6);
+    fflush(jsonFile);
+
+    if (tableFile)
+    {
+        fprintf(tableFile, "%-26s %-28s %10.1f %10.1f %10.1f %14.0f %s/s\n",
+                name, param, benchPercentile(50.0), benchPercentile(99.0),
+                sample[sampleNum - 1], items / mean * 1e6, unit);
+    }
+
+    sampleNum = 0;
+}
+
+//
+// modules without mailboxes and tasks
+//
+
+/**
+ * Creates the data buffer of a RackDataModule like RackDataModule::moduleInit()
+ * does, without the command mailbox and the tasks. putDataBufferWorkSpace()
+ * works as usual, there are no listeners.
+ */
+template <class T> class BenchModule : public T
+{
+    public:
+        BenchModule() : T()
+        {
+        }
+
+        // a plain RackDataModule
+        BenchModule(uint32_t entries, uint32_t dataSize)
+            : T(TEST, 1000000000llu, 1, 0, MBX_IN_KERNELSPACE | MBX_SLOT, entries, 1)
+        {
+            this->dataBufferMaxDataSize = dataSize;
+        }
+
+        int bufferCreate(void)
+        {
+            uint32_t i;
+
+            this->dataBuffer = new DataBufferEntry[this->dataBufferMaxEntries];
+            for (i = 0; i < this->dataBufferMaxEntries; i++)
+            {
+                this->dataBuffer[i].pData = calloc(1, this->dataBufferMaxDataSize);
+                if (!this->dataBuffer[i].pData)
+                {
+                    return -ENOMEM;
+                }
+            }
+            this->listener = new ListenerEntry[this->dataBufferMaxListener];
+
+            this->index           = 0;
+            this->globalDataCount = 0;
+            this->listenerNum     = 0;
+
+            if (this->bufferMtx.create() || this->listenerMtx.create())
+            {
+                return -ENOMEM;
+            }
+            return 0;
+        }
+
+        void bufferDestroy(void)
+        {
+            uint32_t i;
+
+            this->bufferMtx.destroy();
+            this->listenerMtx.destroy();
+
+            for (i = 0; i < this->dataBufferMaxEntries; i++)
+            {
+                free(this->dataBuffer[i].pData);
+            }
+            delete[] this->dataBuffer;
+            delete[] this->listener;
+
+            this->dataBuffer = NULL;
+            this->listener   = NULL;
+        }
+};
+
+class BenchDataModule : public BenchModule<RackDataModule>
+{
+    public:
+        BenchDataModule(uint32_t entries, uint32_t dataSize)
+            : BenchModule<RackDataModule>(entries, dataSize)
+        {
+        }
+
+        int getIndex(rack_time_t time)
+        {
+            return getDataBufferIndex(time);
+        }
+};
+
+class BenchScan2d : public BenchModule<Scan2d>
+{
+    public:
+        BenchScan2d(int filter)
+        {
+            ladarOffsetX        = 0;
+            ladarOffsetY        = 0;
+            ladarOffsetRhoFloat = 0.0f;
+            ladarUpsideDown     = 0;
+            maxRange            = 30000;
+            reduce              = 1;
+            angleMinFloat       = -M_PI;
+            angleMaxFloat       =  M_PI;
+            medianFilter        = filter;
+            reflectorFilterMode = filter ? FILTER_REFLECTOR_90DEG : 0;
+        }
+
+        // moduleLoop() without the ladar mailbox, camera and position
+        void loop(ladar_data *dataLadar)
+        {
+            scan2d_data *data2D = (scan2d_data *)getDataBufferWorkSpace();
+
+            convertLadarData(dataLadar, data2D);
+            putDataBufferWorkSpace(Scan2dData::getDatalen(data2D));
+        }
+
+        scan2d_data *getLast(void)
+        {
+            return (scan2d_data *)dataBuffer[index].pData;
+        }
+};
+
+//
+// cases
+//
+
+static bench_ladar_msg  ladarMsg;
+static bench_ladar_msg  ladarWork;
+static bench_camera_msg cameraMsg;
+static uint8_t          outBuf[CAMERA_MAX_BYTES];
+
+// Scan2d::moduleLoop() on scans of a map, without and with median and reflector filter
+static int benchScan2d(DxfMap *map)
+{
+    static const int    pointNum[]    = { 361, 1081, 2160 };
+    static const double fieldOfView[] = { 180.0, 270.0, 360.0 };
+    BenchRandom         rnd(seed);
+    BenchScan2d         *scan2d;
+    char                param[64];
+    int                 i, filter, loop, ret;
+
+    if (!benchSelected("scan2d.moduleLoop"))
+    {
+        return 0;
+    }
+
+    for (filter = 0; filter <= 1; filter++)
+    {
+        scan2d = new BenchScan2d(filter);
+        ret    = scan2d->bufferCreate();
+        if (ret)
+        {
+            delete scan2d;
+            return ret;
+        }
+
+        for (i = 0; i < 3; i++)
+        {
+            ret = benchLadarCreate(&ladarMsg.data, pointNum[i], fieldOfView[i] * M_PI / 180.0,
+                                   30000, map, 2500.0, 2500.0, 0.3, &rnd);
+            if (ret)
+            {
+                break;
+            }
+
+            for (loop = -benchWarmup(); loop < loops; loop++)
+            {
+                // the module gets each scan in a new mailbox message
+                memcpy(&ladarWork, &ladarMsg, sizeof(ladar_data) +
+                       pointNum[i] * sizeof(ladar_point));
+                ladarWork.data.recordingTime = loop;
+
+                benchStart();
+                scan2d->loop(&ladarWork.data);
+                benchStop(loop);
+            }
+
+            snprintf(param, sizeof(param), "points=%d filter=%d", pointNum[i], filter);
+            benchReport("scan2d.moduleLoop", param, pointNum[i], "point");
+        }
+
+        scan2d->bufferDestroy();
+        delete scan2d;
+
+        if (ret)
+        {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+// putDataBufferWorkSpace() and the time search of getData()
+static int benchDataBuffer(void)
+{
+    static const uint32_t   entries[]  = { 10, 1000 };
+    static const uint32_t   dataSize[] = { sizeof(odometry_data), sizeof(bench_scan2d_msg) };
+    BenchDataModule         *module;
+    rack_time_t             *p_time;
+    char                    param[64];
+    int                     i, j, loop, ret;
+    volatile int            index = 0;
+
+    if (!benchSelected("databuffer"))
+    {
+        return 0;
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        for (j = 0; j < 2; j++)
+        {
+            module = new BenchDataModule(entries[i], dataSize[j]);
+            ret    = module->bufferCreate();
+            if (ret)
+            {
+                delete module;
+                return ret;
+            }
+
+            snprintf(param, sizeof(param), "entries=%u size=%u", entries[i], dataSize[j]);
+
+            if (benchSelected("databuffer.put"))
+            {
+                for (loop = -benchWarmup(); loop < loops; loop++)
+                {
+                    benchStart();
+                    p_time  = (rack_time_t *)module->getDataBufferWorkSpace();
+                    *p_time = (rack_time_t)(loop * 10);
+                    module->putDataBufferWorkSpace(dataSize[j]);
+                    benchStop(loop);
+                }
+                benchReport("databuffer.put", param, 1, "msg");
+            }
+
+            // fill the buffer, 10 ms period, the oldest entry isn't searched
+            for (loop = 0; loop < (int)entries[i]; loop++)
+            {
+                p_time  = (rack_time_t *)module->getDataBufferWorkSpace();
+                *p_time = (rack_time_t)(1000 + loop * 10);
+                module->putDataBufferWorkSpace(dataSize[j]);
+            }
+
+            if (benchSelected("databuffer.getIndex"))
+            {
+                for (loop = -benchWarmup(); loop < loops; loop++)
+                {
+                    benchStart();
+                    index = module->getIndex(1010 + 7 * (loop + loops) %
+                                             ((entries[i] - 2) * 10));
+                    benchStop(loop);
+                }
+                benchReport("databuffer.getIndex", param, 1, "lookup");
+            }
+
+            module->bufferDestroy();
+            delete module;
+        }
+    }
+    return index < 0 ? index : 0;
+}
+
+// CompressTool on Scan2d data, compression and decompression
+static int benchCompress(DxfMap *map)
+{
+    static const struct {
+        const char  *name;
+        uint32_t    s2;
+        uint32_t    s3;
+    } flags[] = {
+        { "s2=none s3=huffmann",        COMPR_S2_NONE,      COMPR_S3_HUFFMANN },
+        { "s2=mtf s3=huffmann",         COMPR_S2_MTF,       COMPR_S3_HUFFMANN },
+        { "s2=lzss s3=huffmann",        COMPR_S2_LZSS,      COMPR_S3_HUFFMANN },
+        { "s2=lzw s3=none",             COMPR_S2_LZW,       COMPR_S3_NONE },
+        { "s2=bwt_mtf s3=huffmann",     COMPR_S2_BWT_MTF,   COMPR_S3_HUFFMANN },
+        { "s2=bwt_mtf s3=ad_huffmann",  COMPR_S2_BWT_MTF,   COMPR_S3_AD_HUFFMANN },
+    };
+    BenchRandom     rnd(seed);
+    BenchScan2d     *scan2d;
+    CompressTool    *tool;
+    uint8_t         *buf, *src;
+    char            param[96];
+    uint32_t        size, comprSize = 0;
+    int             i, loop, ret;
+
+    if (!benchSelected("compress"))
+    {
+        return 0;
+    }
+
+    // scan2d data as input
+    ret = benchLadarCreate(&ladarMsg.data, 1081, 270.0 * M_PI / 180.0, 30000, map,
+                           2500.0, 2500.0, 0.3, &rnd);
+    if (ret)
+    {
+        return ret;
+    }
+
+    scan2d = new BenchScan2d(0);
+    tool   = new CompressTool();
+    buf    = (uint8_t *)malloc(COMPR_MAX_INPUT_SIZE);
+    src    = (uint8_t *)malloc(COMPR_MAX_INPUT_SIZE);
+    if (!buf || !src || scan2d->bufferCreate())
+    {
+        ret = -ENOMEM;
+        goto exit;
+    }
+
+    scan2d->loop(&ladarMsg.data);
+    size = Scan2dData::getDatalen(scan2d->getLast());
+    memcpy(src, scan2d->getLast(), size);
+
+    for (i = 0; i < (int)(sizeof(flags) / sizeof(flags[0])); i++)
+    {
+        for (loop = -benchWarmup(); loop < loops; loop++)
+        {
+            memcpy(buf, src, size);
+
+            benchStart();
+            tool->compr_writeStatistics(1, size);
+            comprSize = tool->Compress(buf, flags[i].s2, flags[i].s3);
+            benchStop(loop);
+        }
+        snprintf(param, sizeof(param), "%s ratio=%.2f", flags[i].name,
+                 (double)size / comprSize);
+        benchReport("compress.compress", param, size, "byte");
+
+        for (loop = -benchWarmup(); loop < loops; loop++)
+        {
+            memcpy(buf, src, size);
+            tool->compr_writeStatistics(1, size);
+            tool->Compress(buf, flags[i].s2, flags[i].s3);
+
+            benchStart();
+            tool->Decompress(buf);
+            benchStop(loop);
+        }
+
+        if (memcmp(buf, src, size))
+        {
+            fprintf(stderr, "CompressTool %s isn't lossless\n", flags[i].name);
+            ret = -EINVAL;
+            goto exit;
+        }
+        benchReport("compress.decompress", flags[i].name, size, "byte");
+    }
+
+exit:
+    scan2d->bufferDestroy();
+    delete scan2d;
+    delete tool;
+    free(buf);
+    free(src);
+    return ret;
+}
+
+// CameraTool conversions of each camera mode they exist for
+#define CAMERA_CASE_UYVY2RGB        0
+#define CAMERA_CASE_UYVY2GRAY       1
+#define CAMERA_CASE_BGR2RGB         2
+#define CAMERA_CASE_RGB2MONO8       3
+#define CAMERA_CASE_BAYER_BIL       4
+#define CAMERA_CASE_BAYER_EDGE      5
+#define CAMERA_CASE_MONO122MONO8    6
+#define CAMERA_CASE_MONO122THERMAL  7
+#define CAMERA_CASE_MONO82THERMAL   8
+#define CAMERA_CASE_STRECH_MONO8    9
+#define CAMERA_CASE_STRECH_TO_MONO8 10
+#define CAMERA_CASE_LOWPASS16       11
+
+static int benchCameraRun(CameraTool *tool, int cameraCase, int width, int height)
+{
+    uint8_t *in = cameraMsg.data.byteStream;
+
+    switch (cameraCase)
+    {
+        case CAMERA_CASE_UYVY2RGB:
+            return CameraTool::convertCharUYVY2RGB(outBuf, in, width, height);
+        case CAMERA_CASE_UYVY2GRAY:
+            return CameraTool::convertCharUYVY2Gray(outBuf, in, width, height);
+        case CAMERA_CASE_BGR2RGB:
+            return CameraTool::convertCharBGR2RGB(outBuf, in, width, height);
+        case CAMERA_CASE_RGB2MONO8:
+            return CameraTool::convertCharRGB2MONO8(outBuf, in, width, height);
+        case CAMERA_CASE_BAYER_BIL:
+            return CameraTool::convertCharBayer2RGB(outBuf, in, width, height,
+                                                    cameraMsg.data.colorFilterId,
+                                                    CAMERA_TOOL_DEMOSAIC_BILINEAR);
+        case CAMERA_CASE_BAYER_EDGE:
+            return CameraTool::convertCharBayer2RGB(outBuf, in, width, height,
+                                                    cameraMsg.data.colorFilterId,
+                                                    CAMERA_TOOL_DEMOSAIC_EDGE);
+        case CAMERA_CASE_MONO122MONO8:
+            return tool->convertCharMono122Mono8(outBuf, in, width, height, 64, 4000, 2.2f);
+        case CAMERA_CASE_MONO122THERMAL:
+            return tool->convertCharMono122RGBThermalRed(outBuf, in, width, height);
+        case CAMERA_CASE_MONO82THERMAL:
+            return tool->convertCharMono82RGBThermalRed(outBuf, in, width, height);
+        case CAMERA_CASE_STRECH_MONO8:
+            return tool->histogramStrechMono8(outBuf, in, width, height, 5, 5);
+        case CAMERA_CASE_STRECH_TO_MONO8:
+            return tool->histogramStrechToMono8(outBuf, (unsigned short *)in, width, height,
+                                                5, 5, 0, 0, 0, 0);
+        case CAMERA_CASE_LOWPASS16:
+            return tool->lowPassFilter16Bit((short *)outBuf, (short *)in, width, height, 1);
+    }
+    return -EINVAL;
+}
+
+static int benchCamera(int width, int height)
+{
+    // modes without a CameraTool conversion (RGB565, RAW12/16, MONO24, the
+    // 3d modes) and JPEG (libjpeg is optional) aren't measured
+    static const struct {
+        const char  *name;
+        int         mode;
+        int         cameraCase;
+    } cases[] = {
+        { "camera.YUV422.toRGB",        CAMERA_MODE_YUV422, CAMERA_CASE_UYVY2RGB },
+        { "camera.YUV422.toGray",       CAMERA_MODE_YUV422, CAMERA_CASE_UYVY2GRAY },
+        { "camera.RGB24.BGRtoRGB",      CAMERA_MODE_RGB24,  CAMERA_CASE_BGR2RGB },
+        { "camera.RGB24.toMONO8",       CAMERA_MODE_RGB24,  CAMERA_CASE_RGB2MONO8 },
+        { "camera.RAW8.bilinear",       CAMERA_MODE_RAW8,   CAMERA_CASE_BAYER_BIL },
+        { "camera.RAW8.edge",           CAMERA_MODE_RAW8,   CAMERA_CASE_BAYER_EDGE },
+        { "camera.MONO12.toMONO8",      CAMERA_MODE_MONO12, CAMERA_CASE_MONO122MONO8 },
+        { "camera.MONO12.thermalRed",   CAMERA_MODE_MONO12, CAMERA_CASE_MONO122THERMAL },
+        { "camera.MONO8.thermalRed",    CAMERA_MODE_MONO8,  CAMERA_CASE_MONO82THERMAL },
+        { "camera.MONO8.histStrech",    CAMERA_MODE_MONO8,  CAMERA_CASE_STRECH_MONO8 },
+        { "camera.MONO16.histStrech",   CAMERA_MODE_MONO16, CAMERA_CASE_STRECH_TO_MONO8 },
+        { "camera.MONO16.lowPass",      CAMERA_MODE_MONO16, CAMERA_CASE_LOWPASS16 },
+    };
+    BenchRandom rnd(seed);
+    CameraTool  *tool;
+    char        param[64];
+    int         i, loop, ret = 0;
+
+    if (!benchSelected("camera"))
+    {
+        return 0;
+    }
+
+    tool = new CameraTool();
+
+    for (i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++)
+    {
+        if (!benchSelected(cases[i].name))
+        {
+            continue;
+        }
+
+        ret = benchCameraCreate(&cameraMsg.data, cases[i].mode, width, height,
+                                COLORFILTER_RGGB, &rnd);
+        if (ret < 0)
+        {
+            break;
+        }
+        ret = 0;
+
+        for (loop = -benchWarmup(); loop < loops; loop++)
+        {
+            benchStart();
+            benchCameraRun(tool, cases[i].cameraCase, width, height);
+            benchStop(loop);
+        }
+
+        snprintf(param, sizeof(param), "%dx%d simd=%d", width, height, CameraTool::getSimd());
+        benchReport(cases[i].name, param, width * height, "pixel");
+    }
+
+    delete tool;
+    return ret;
+}
+
+// PositionTool conversions of 1000 positions
+#define POSITION_NUM 1000
+
+static int benchPosition(void)
+{
+    static position_wgs84_data  wgs84[POSITION_NUM];
+    static position_wgs84_data  wgs84Out[POSITION_NUM];
+    static position_utm_data    utm[POSITION_NUM];
+    static position_gk_data     gk[POSITION_NUM];
+    BenchRandom                 rnd(seed);
+    PositionTool                *tool;
+    int                         loop, i;
+
+    if (!benchSelected("position"))
+    {
+        return 0;
+    }
+
+    tool = new PositionTool();
+    benchWgs84Create(wgs84, POSITION_NUM, &rnd);
+
+    tool->wgs84ToUtm(wgs84, utm, POSITION_NUM);
+    tool->wgs84ToGk(wgs84, gk, POSITION_NUM);
+
+    for (loop = -benchWarmup(); loop < loops; loop++)
+    {
+        benchStart();
+        tool->wgs84ToUtm(wgs84, utm, POSITION_NUM);
+        benchStop(loop);
+    }
+    benchReport("position.wgs84ToUtm", "array", POSITION_NUM, "position");
+
+    for (loop = -benchWarmup(); loop < loops; loop++)
+    {
+        benchStart();
+        tool->utmToWgs84(utm, wgs84Out, POSITION_NUM);
+        benchStop(loop);
+    }
+    benchReport("position.utmToWgs84", "array", POSITION_NUM, "position");
+
+    for (loop = -benchWarmup(); loop < loops; loop++)
+    {
+        benchStart();
+        tool->wgs84ToGk(wgs84, gk, POSITION_NUM);
+        benchStop(loop);
+    }
+    benchReport("position.wgs84ToGk", "array", POSITION_NUM, "position");
+
+    for (loop = -benchWarmup(); loop < loops; loop++)
+    {
+        benchStart();
+        tool->gkToWgs84(gk, wgs84Out, POSITION_NUM);
+        benchStop(loop);
+    }
+    benchReport("position.gkToWgs84", "array", POSITION_NUM, "position");
+
+    for (loop = -benchWarmup(); loop < loops; loop++)
+    {
+        benchStart();
+        for (i = 0; i < POSITION_NUM; i++)
+        {
+            tool->wgs84ToGk(&wgs84[i], &gk[i]);
+        }
+        benchStop(loop);
+    }
+    benchReport("position.wgs84ToGk", "single", POSITION_NUM, "position");
+
+    delete tool;
+    return 0;
+}
+
+// DxfMap load of a generated file, without and with cache, and raycast
+static int benchDxf(int roomsX, int roomsY)
+{
+    static const int    beamNum[] = { 361, 1081 };
+    static double       angle[1081];
+    static double       distance[1081];
+    BenchRandom         rnd(seed);
+    DxfMap              *map;
+    char                filename[] = "/tmp/rack_bench_XXXXXX";
+    char                cacheFile[64];
+    char                param[64];
+    int                 i, fd, loop, featureNum, ret;
+
+    if (!benchSelected("dxf"))
+    {
+        return 0;
+    }
+
+    fd = mkstemp(filename);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+    close(fd);
+    snprintf(cacheFile, sizeof(cacheFile), "%s%s", filename, DXF_MAP_CACHE_SUFFIX);
+
+    map = new DxfMap(benchMapFeatureNum(roomsX, roomsY));
+    ret = benchMapCreate(map, roomsX, roomsY, 5000.0, &rnd);
+    if (!ret)
+    {
+        // save() scales the features in place
+        ret = map->save(filename, map->featureNum);
+    }
+    featureNum = map->featureNum;
+
+    snprintf(param, sizeof(param), "rooms=%dx%d features=%d", roomsX, roomsY, featureNum);
+
+    map->setCache(0);
+    for (loop = -benchWarmup() / 10; !ret && (loop < loops / 10 + 1); loop++)
+    {
+        benchStart();
+        ret = map->load(filename);
+        benchStop(loop);
+    }
+    if (ret || (map->featureNum != featureNum))
+    {
+        ret = ret ? ret : -EINVAL;
+        goto exit;
+    }
+    benchReport("dxf.load", param, featureNum, "feature");
+
+    // the first load writes the cache
+    map->setCache(1);
+    ret = map->load(filename);
+    for (loop = -benchWarmup() / 10; !ret && (loop < loops / 10 + 1); loop++)
+    {
+        benchStart();
+        ret = map->load(filename);
+        benchStop(loop);
+    }
+    if (ret || (map->featureNum != featureNum))
+    {
+        ret = ret ? ret : -EINVAL;
+        goto exit;
+    }
+    benchReport("dxf.load_cache", param, featureNum, "feature");
+
+    for (i = 0; i < 2; i++)
+    {
+        for (loop = 0; loop < beamNum[i]; loop++)
+        {
+            angle[loop] = (-0.75 + 1.5 * loop / (beamNum[i] - 1)) * M_PI;
+        }
+
+        for (loop = -benchWarmup(); loop < loops; loop++)
+        {
+            // a new position in one of the rooms every run
+            double x = 500.0 + rnd.range(0, roomsX * 5000 - 1000);
+            double y = 500.0 + rnd.range(0, roomsY * 5000 - 1000);
+
+            benchStart();
+            map->raycast(x, y, loop * 0.1, angle, beamNum[i], 30000.0, distance);
+            benchStop(loop);
+        }
+        snprintf(param, sizeof(param), "rooms=%dx%d beams=%d", roomsX, roomsY, beamNum[i]);
+        benchReport("dxf.raycast", param, beamNum[i], "beam");
+    }
+
+exit:
+    unlink(filename);
+    unlink(cacheFile);
+    delete map;
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    arg_descriptor_t    argDesc[] = { { benchArgTab }, { NULL } };
+    DxfMap              *map;
+    BenchRandom         *rnd;
+    char                *output;
+    int                 width, height, ret;
+
+    ret = argScan(argc, argv, argDesc, "RackBench");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    loops       = getIntArg("loops", benchArgTab);
+    caseFilter  = getStrArg("case", benchArgTab);
+    output      = getStrArg("output", benchArgTab);
+    width       = getIntArg("width", benchArgTab);
+    height      = getIntArg("height", benchArgTab);
+    seed        = (uint32_t)getIntArg("seed", benchArgTab);
+
+    if ((loops <= 0) || (width < 16) || (height < 16) ||
+        (benchCameraSize(CAMERA_MODE_RGB24, width, height) > CAMERA_MAX_BYTES))
+    {
+        printf("Invalid loop count or image size\n");
+        return -EINVAL;
+    }
+
+    jsonFile  = stdout;
+    tableFile = NULL;
+    if (output && output[0])
+    {
+        jsonFile = fopen(output, "w");
+        if (!jsonFile)
+        {
+            printf("Can't open output file \"%s\"\n", output);
+            return -EIO;
+        }
+        tableFile = stdout;
+        fprintf(tableFile, "%-26s %-28s %10s %10s %10s %14s\n",
+                "case", "param", "p50 us", "p99 us", "max us", "throughput");
+    }
+
+    sample = (double *)malloc(loops * sizeof(double));
+    if (!sample)
+    {
+        return -ENOMEM;
+    }
+
+    // the map of the ladar scans, 4 x 4 rooms of 5 m
+    rnd = new BenchRandom(seed);
+    map = new DxfMap(benchMapFeatureNum(4, 4));
+    ret = benchMapCreate(map, 4, 4, 5000.0, rnd);
+
+    if (!ret)
+        ret = benchScan2d(map);
+    if (!ret)
+        ret = benchDataBuffer();
+    if (!ret)
+        ret = benchCompress(map);
+    if (!ret)
+        ret = benchCamera(width, height);
+    if (!ret)
+        ret = benchPosition();
+    if (!ret)
+        ret = benchDxf(4, 4);
+    if (!ret)
+        ret = benchDxf(40, 40);
+
+    if (ret)
+    {
+        printf("RackBench error, code = %d\n", ret);
+    }
+
+    delete map;
+    delete rnd;
+    free(sample);
+    if (jsonFile != stdout)
+    {
+        fclose(jsonFile);
+    }
+    return ret;
+}
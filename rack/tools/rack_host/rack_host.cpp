@@ -0,0 +1,292 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+//
+// RackHost runs several RACK modules in one process (see main/rack_host.h).
+// The modules are loaded from plugins (<ClassName>.so, built together with
+// the module programs if CONFIG_RACK_HOST is set). The configuration file
+// has one line per module with the plugin and the usual module arguments:
+//
+//   # tightly coupled scan chain
+//   LadarSim     -instance 0 -odometryInst 0 -mapFile map.dxf
+//   Scan2d       -instance 0 -ladarInst 0
+//   PilotLab     -instance 0 -chassisInst 0 -positionInst 0
+//
+// The modules are started in the order of the file and stopped in reverse
+// order on SIGINT or SIGTERM. Messages between the hosted modules are
+// delivered in-process, all other messages use TIMS as usual.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <dlfcn.h>
+#include <pthread.h>
+
+#include <main/argopts.h>
+#include <main/rack_host.h>
+#include <main/rack_module.h>
+
+#ifndef RACK_HOST_PLUGIN_DIR
+#define RACK_HOST_PLUGIN_DIR    "."
+#endif
+
+#define HOST_MODULE_MAX         32
+#define HOST_ARG_MAX            64
+#define HOST_LINE_MAX           1024
+
+typedef int (*module_main_t)(int argc, char *argv[]);
+
+typedef struct
+{
+    char            line[HOST_LINE_MAX];
+    char            *argv[HOST_ARG_MAX + 1];
+    int             argc;
+    void            *plugin;
+    module_main_t   moduleMain;
+    pthread_t       thread;
+    volatile int    exited;
+    int             ret;
+    RackModule      *p_mod;
+} host_module;
+
+static arg_table_t argTab[] = {
+
+    { ARGOPT_REQ, "config", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Configuration file, one module and its arguments per line", { 0 } },
+
+    { ARGOPT_OPT, "pluginDir", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Directory of the module plugins, default " RACK_HOST_PLUGIN_DIR,
+      { 0 } },
+
+    { ARGOPT_OPT, "localDelivery", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Deliver messages between the hosted modules in-process, default 1", { 1 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+static host_module  module[HOST_MODULE_MAX];
+static int          moduleNum = 0;
+
+static void* moduleThread(void *arg)
+{
+    host_module *p_host = (host_module *)arg;
+
+    p_host->ret = p_host->moduleMain(p_host->argc, p_host->argv);
+
+    RackHost::moduleExited(&p_host->exited);
+    return NULL;
+}
+
+static int readConfig(const char *fileName)
+{
+    FILE        *file;
+    host_module *p_host;
+    char        line[HOST_LINE_MAX];
+    char        *p_tok, *p_save;
+    int         lineNum = 0;
+
+    file = fopen(fileName, "r");
+    if (!file)
+    {
+        printf("RackHost: Can't open configuration file %s\n", fileName);
+        return -ENOENT;
+    }
+
+    while (fgets(line, sizeof(line), file))
+    {
+        lineNum++;
+
+        p_tok = line + strspn(line, " \t\r\n");
+        if ((*p_tok == 0) || (*p_tok == '#'))
+        {
+            continue;
+        }
+
+        if (moduleNum >= HOST_MODULE_MAX)
+        {
+            printf("RackHost: More than %d modules in %s\n", HOST_MODULE_MAX, fileName);
+            fclose(file);
+            return -E2BIG;
+        }
+
+        p_host = &module[moduleNum];
+        memset(p_host, 0, sizeof(host_module));
+        strncpy(p_host->line, p_tok, HOST_LINE_MAX - 1);
+
+        for (p_tok = strtok_r(p_host->line, " \t\r\n", &p_save); p_tok;
+             p_tok = strtok_r(NULL, " \t\r\n", &p_save))
+        {
+            if (p_host->argc >= HOST_ARG_MAX)
+            {
+                printf("RackHost: Too many arguments in line %d\n", lineNum);
+                fclose(file);
+                return -E2BIG;
+            }
+            p_host->argv[p_host->argc++] = p_tok;
+        }
+        p_host->argv[p_host->argc] = NULL;
+
+        moduleNum++;
+    }
+
+    fclose(file);
+    return 0;
+}
+
+static int loadPlugin(host_module *p_host, const char *pluginDir)
+{
+    char path[512];
+
+    // argv[0] is the class name or the path of the plugin
+    if (strchr(p_host->argv[0], '/'))
+    {
+        snprintf(path, sizeof(path), "%s", p_host->argv[0]);
+    }
+    else
+    {
+        snprintf(path, sizeof(path), "%s/%s.so", pluginDir, p_host->argv[0]);
+    }
+
+    // RTLD_LOCAL keeps argTab and main of each module apart
+    p_host->plugin = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!p_host->plugin)
+    {
+        printf("RackHost: Can't load %s (%s)\n", path, dlerror());
+        return -ENOENT;
+    }
+
+    p_host->moduleMain = (module_main_t)dlsym(p_host->plugin, "main");
+    if (!p_host->moduleMain)
+    {
+        printf("RackHost: %s has no main function\n", path);
+        return -ENOENT;
+    }
+
+    return 0;
+}
+
+static int startModule(host_module *p_host)
+{
+    int ret;
+
+    // the arguments of the previous module are still in the tables
+    RackHost::resetArgs();
+    optind = 0;
+
+    ret = pthread_create(&p_host->thread, NULL, moduleThread, p_host);
+    if (ret)
+    {
+        printf("RackHost: Can't create thread of %s, code = %d\n", p_host->argv[0], ret);
+        return -ret;
+    }
+
+    // start the next module only after this one has finished its init
+    p_host->p_mod = RackHost::waitRunning(&p_host->exited);
+    if (!p_host->p_mod)
+    {
+        pthread_join(p_host->thread, NULL);
+        printf("RackHost: %s exited, code = %d\n", p_host->argv[0], p_host->ret);
+        return p_host->ret ? p_host->ret : -EINVAL;
+    }
+
+    printf("RackHost: %s started\n", p_host->argv[0]);
+    return 0;
+}
+
+static void stopModule(host_module *p_host)
+{
+    RackHost::moduleStop(p_host->p_mod);
+    pthread_join(p_host->thread, NULL);
+
+    printf("RackHost: %s stopped\n", p_host->argv[0]);
+}
+
+int main(int argc, char *argv[])
+{
+    arg_descriptor_t    argDesc[] = { { argTab }, { NULL } };
+    char                *configFile, *pluginDir;
+    sigset_t            sigSet;
+    int                 i, sig, started = 0, ret;
+
+    ret = argScan(argc, argv, argDesc, "RackHost");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    configFile = getStrArg("config", argTab);
+    pluginDir  = getStrArg("pluginDir", argTab);
+    if (!pluginDir)
+    {
+        pluginDir = (char *)RACK_HOST_PLUGIN_DIR;
+    }
+
+    ret = readConfig(configFile);
+    if (ret)
+    {
+        return ret;
+    }
+    if (moduleNum == 0)
+    {
+        printf("RackHost: No module in %s\n", configFile);
+        return -EINVAL;
+    }
+
+    for (i = 0; i < moduleNum; i++)
+    {
+        ret = loadPlugin(&module[i], pluginDir);
+        if (ret)
+        {
+            return ret;
+        }
+    }
+
+    // all threads inherit the blocked signals, only the host waits for them
+    sigemptyset(&sigSet);
+    sigaddset(&sigSet, SIGINT);
+    sigaddset(&sigSet, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &sigSet, NULL);
+
+    RackHost::enable(getIntArg("localDelivery", argTab));
+
+    for (i = 0; i < moduleNum; i++)
+    {
+        ret = startModule(&module[i]);
+        if (ret)
+        {
+            break;
+        }
+        started++;
+    }
+
+    if (started == moduleNum)
+    {
+        printf("RackHost: %d modules running\n", moduleNum);
+        sigwait(&sigSet, &sig);
+        printf("RackHost: SIGTERM/SIGINT (%02d)\n", sig);
+    }
+
+    for (i = started - 1; i >= 0; i--)
+    {
+        stopModule(&module[i]);
+    }
+
+    printf("RackHost: Done\n");
+    return ret;
+}
@@ -0,0 +1,210 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+//
+// RackSimClock is the clock master of a lockstep simulation (see
+// main/rack_sim_clock.h). Start it first, then the modules with the same
+// clock name in RACK_SIM_CLOCK:
+//
+//   RackSimClock -tasks 8 -duration 3600 &
+//   export RACK_SIM_CLOCK=/rack_sim_clock
+//   ChassisSim ... & LadarSim ... & Scan2d ... & PilotLab ...
+//
+// The virtual time advances as soon as all tasks of the modules wait. It
+// starts at the system time, -speed paces the simulation relative to real
+// time (0 runs as fast as possible). After -duration seconds of virtual
+// time or on SIGINT the clock stops.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <main/argopts.h>
+#include <main/rack_sim_clock.h>
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "name", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Clock name, default " RACK_SIM_CLOCK_NAME_DEFAULT, { 0 } },
+
+    { ARGOPT_OPT, "tasks", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Tasks that have to be registered before the time advances, default 1", { 1 } },
+
+    { ARGOPT_OPT, "settle", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Time in us all tasks have to wait before the time advances, default 500", { 500 } },
+
+    { ARGOPT_OPT, "speed", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Speed in percent of real time, 0 = as fast as possible, default 0", { 0 } },
+
+    { ARGOPT_OPT, "duration", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Duration of the simulation in s, 0 = endless, default 0", { 0 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+static volatile int clockStop = 0;
+
+static void signalHandler(int sig)
+{
+    clockStop = 1;
+}
+
+static uint64_t getRealNano(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000llu + (uint64_t)ts.tv_nsec;
+}
+
+static void sleepNano(uint64_t ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec  = ns / 1000000000llu;
+    ts.tv_nsec = ns % 1000000000llu;
+    nanosleep(&ts, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    arg_descriptor_t    argDesc[] = { { argTab }, { NULL } };
+    struct timeval      now;
+    const char          *name;
+    int                 taskMin, speed, duration, taskNum, waitNum, msgNum, ret, warned = 0;
+    uint64_t            settle, simStart, simTime, realStart, realTime, due, stopTime = 0;
+    uint64_t            stepNum = 0, reportTime;
+
+    ret = argScan(argc, argv, argDesc, "RackSimClock");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    name     = getStrArg("name", argTab);
+    taskMin  = getIntArg("tasks", argTab);
+    settle   = (uint64_t)getIntArg("settle", argTab) * 1000llu;
+    speed    = getIntArg("speed", argTab);
+    duration = getIntArg("duration", argTab);
+
+    if (!name)
+    {
+        name = RACK_SIM_CLOCK_NAME_DEFAULT;
+    }
+
+    gettimeofday(&now, NULL);
+    simStart = (uint64_t)now.tv_sec * 1000000000llu + (uint64_t)now.tv_usec * 1000llu;
+
+    ret = RackSimClock::create(name, simStart);
+    if (ret)
+    {
+        printf("Can't create clock %s, code = %d\n", name, ret);
+        return ret;
+    }
+
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+
+    printf("clock %s started, waiting for %d tasks\n", name, taskMin);
+
+    realStart  = getRealNano();
+    reportTime = simStart + 10000000000llu;
+
+    while (!clockStop)
+    {
+        // the task number only delays the start of the simulation
+        ret = RackSimClock::advance(stepNum ? 1 : taskMin, settle);
+        if (ret == 1)
+        {
+            stepNum++;
+            warned   = 0;
+            stopTime = 0;
+            simTime  = RackSimClock::getNano();
+
+            // pacing relative to real time
+            if (speed > 0)
+            {
+                due      = realStart + (simTime - simStart) * 100llu / (uint64_t)speed;
+                realTime = getRealNano();
+                if (due > realTime)
+                {
+                    sleepNano(due - realTime);
+                }
+            }
+
+            if (simTime >= reportTime)
+            {
+                RackSimClock::getTaskNum(&taskNum, &waitNum);
+                realTime = getRealNano() - realStart;
+                printf("time %.1f s, real time %.1f s (x %.1f), %llu steps, %d tasks\n",
+                       (double)(simTime - simStart) * 1e-9, (double)realTime * 1e-9,
+                       (double)(simTime - simStart) / (double)(realTime ? realTime : 1),
+                       (unsigned long long)stepNum, taskNum);
+                reportTime += 10000000000llu;
+            }
+
+            if ((duration > 0) && (simTime - simStart >= (uint64_t)duration * 1000000000llu))
+            {
+                break;
+            }
+            continue;
+        }
+
+        if ((ret == -EDEADLK) && !warned)
+        {
+            printf("all tasks wait without timeout, the time stops\n");
+            warned = 1;
+        }
+        else if ((ret < 0) && (ret != -EDEADLK))
+        {
+            printf("Can't advance clock, code = %d\n", ret);
+            break;
+        }
+        else if ((ret == 0) && !warned)
+        {
+            // a message that is never received stops the time
+            realTime = getRealNano();
+            if (!stopTime)
+            {
+                stopTime = realTime;
+            }
+            else if (realTime - stopTime > 1000000000llu)
+            {
+                RackSimClock::getTaskNum(&taskNum, &waitNum);
+                msgNum = RackSimClock::getMsgNum();
+                if ((waitNum == taskNum) && (msgNum > 0))
+                {
+                    printf("%d messages are not received, the time stops\n", msgNum);
+                    warned = 1;
+                }
+            }
+        }
+
+        // a task is running
+        sleepNano(settle / 10 + 1000);
+    }
+
+    RackSimClock::destroy(name);
+
+    realTime = getRealNano() - realStart;
+    printf("clock %s stopped after %.1f s virtual time, %.1f s real time, %llu steps\n", name,
+           (double)(RackSimClock::getNano() - simStart) * 1e-9, (double)realTime * 1e-9,
+           (unsigned long long)stepNum);
+    return 0;
+}
@@ -0,0 +1,449 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+//
+// RackTraceCollector merges the trace files of all processes (see
+// main/rack_trace.h) into one Chrome trace that can be opened with
+// chrome://tracing or ui.perfetto.dev:
+//
+//   export RACK_TRACE=/tmp/trace
+//   LadarSickLms100 ... & Scan2d ... & PilotWallFollowing ... & ChassisPioneer ...
+//   RackTraceCollector -dir /tmp/trace -output trace.json
+//
+// Each process is shown with its program name, each task as a thread. A
+// message is a flow arrow from its send to its receive, a receive is a
+// slice up to the next event of the task. The latency of each hop (sender
+// and receiver mailbox) is printed, the files may be read while the
+// modules are running.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+
+#include <main/argopts.h>
+#include <main/rack_trace.h>
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "dir", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Directory of the trace files, default $" RACK_TRACE_ENV, { 0 } },
+
+    { ARGOPT_OPT, "output", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Chrome trace file, default rack_trace.json", { 0 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+typedef struct
+{
+    rack_trace_event    e;
+    int32_t             pid;
+} collector_event;
+
+typedef struct
+{
+    uint32_t            src;
+    uint32_t            dest;
+    int                 num;
+    double              sum;
+    double              max;
+} collector_hop;
+
+static collector_event  *eventList  = NULL;
+static int              eventNum    = 0;
+static int              eventMax    = 0;
+
+static collector_hop    *hopList    = NULL;
+static int              hopNum      = 0;
+static int              hopMax      = 0;
+
+static const char *kindName[] = { "", "send", "recv", "put", "call", "call" };
+
+static int readFile(const char *path, FILE *out, int *procNum)
+{
+    rack_trace_head     head;
+    rack_trace_event    *p_ring, *p_event;
+    size_t              ringSize;
+    uint32_t            seq;
+    FILE                *fp;
+    int                 i, num;
+
+    fp = fopen(path, "rb");
+    if (!fp)
+    {
+        printf("Can't open \"%s\" (%s)\n", path, strerror(errno));
+        return -errno;
+    }
+
+    if ((fread(&head, sizeof(head), 1, fp) != 1) ||
+        (head.magic != RACK_TRACE_MAGIC) || (head.version != RACK_TRACE_VERSION) ||
+        (head.eventNum == 0) || (head.eventNum & (head.eventNum - 1)))
+    {
+        printf("\"%s\" is no trace file\n", path);
+        fclose(fp);
+        return -EINVAL;
+    }
+
+    ringSize = head.eventNum * sizeof(rack_trace_event);
+    p_ring   = (rack_trace_event *)malloc(ringSize);
+    if (!p_ring)
+    {
+        fclose(fp);
+        return -ENOMEM;
+    }
+
+    if (fread(p_ring, ringSize, 1, fp) != 1)
+    {
+        printf("\"%s\" is too short\n", path);
+        free(p_ring);
+        fclose(fp);
+        return -EINVAL;
+    }
+    fclose(fp);
+
+    if (eventNum + (int)head.eventNum > eventMax)
+    {
+        eventMax  = eventNum + head.eventNum;
+        eventList = (collector_event *)realloc(eventList, eventMax * sizeof(collector_event));
+        if (!eventList)
+        {
+            free(p_ring);
+            return -ENOMEM;
+        }
+    }
+
+    // events that were written while the file was read have the wrong position
+    num = 0;
+    for (i = 0; i < (int)head.eventNum; i++)
+    {
+        p_event = &p_ring[i];
+        seq     = p_event->seq;
+        if ((seq == 0) || (((seq - 1) & (head.eventNum - 1)) != (uint32_t)i) ||
+            (p_event->kind < RACK_TRACE_SEND) || (p_event->kind > RACK_TRACE_CALL_END))
+        {
+            continue;
+        }
+
+        eventList[eventNum].e   = *p_event;
+        eventList[eventNum].pid = head.pid;
+        eventNum++;
+        num++;
+    }
+    free(p_ring);
+
+    head.name[sizeof(head.name) - 1] = 0;
+    fprintf(out, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+                 "\"args\":{\"name\":\"%s %d\"}}",
+            *procNum ? ",\n" : "", head.pid, head.name, head.pid);
+    (*procNum)++;
+
+    printf("%s: %s, %d events\n", path, head.name, num);
+    return 0;
+}
+
+static int compareTime(const void *a, const void *b)
+{
+    const collector_event *p_a = (const collector_event *)a;
+    const collector_event *p_b = (const collector_event *)b;
+
+    if (p_a->e.time != p_b->e.time)
+    {
+        return (p_a->e.time < p_b->e.time) ? -1 : 1;
+    }
+    return p_a->e.kind - p_b->e.kind;
+}
+
+typedef struct
+{
+    uint32_t            span;
+    int                 index;
+} collector_span;
+
+static collector_span   *spanList   = NULL;
+static int              spanNum     = 0;
+
+static int compareSpan(const void *a, const void *b)
+{
+    const collector_span *p_a = (const collector_span *)a;
+    const collector_span *p_b = (const collector_span *)b;
+
+    if (p_a->span != p_b->span)
+    {
+        return (p_a->span < p_b->span) ? -1 : 1;
+    }
+    return 0;
+}
+
+// index of the send events by span
+static int buildSpanList(void)
+{
+    int i;
+
+    spanList = (collector_span *)malloc((eventNum + 1) * sizeof(collector_span));
+    if (!spanList)
+    {
+        return -ENOMEM;
+    }
+
+    for (i = 0; i < eventNum; i++)
+    {
+        if (eventList[i].e.kind == RACK_TRACE_SEND)
+        {
+            spanList[spanNum].span  = eventList[i].e.span_id;
+            spanList[spanNum].index = i;
+            spanNum++;
+        }
+    }
+
+    qsort(spanList, spanNum, sizeof(collector_span), compareSpan);
+    return 0;
+}
+
+static collector_event *findSend(uint32_t span)
+{
+    collector_span key, *p_span;
+
+    key.span  = span;
+    key.index = 0;
+
+    p_span = (collector_span *)bsearch(&key, spanList, spanNum, sizeof(collector_span),
+                                       compareSpan);
+    return p_span ? &eventList[p_span->index] : NULL;
+}
+
+static void addHop(uint32_t src, uint32_t dest, double latency)
+{
+    int i;
+
+    for (i = 0; i < hopNum; i++)
+    {
+        if ((hopList[i].src == src) && (hopList[i].dest == dest))
+        {
+            break;
+        }
+    }
+
+    if (i == hopNum)
+    {
+        if (hopNum == hopMax)
+        {
+            hopMax  = hopMax ? 2 * hopMax : 64;
+            hopList = (collector_hop *)realloc(hopList, hopMax * sizeof(collector_hop));
+            if (!hopList)
+            {
+                hopNum = 0;
+                return;
+            }
+        }
+        memset(&hopList[i], 0, sizeof(collector_hop));
+        hopList[i].src  = src;
+        hopList[i].dest = dest;
+        hopNum++;
+    }
+
+    hopList[i].num++;
+    hopList[i].sum += latency;
+    if (latency > hopList[i].max)
+    {
+        hopList[i].max = latency;
+    }
+}
+
+// time of the next event of the same task
+static uint64_t nextTime(int i)
+{
+    int j;
+
+    for (j = i + 1; j < eventNum; j++)
+    {
+        if ((eventList[j].pid == eventList[i].pid) &&
+            (eventList[j].e.tid == eventList[i].e.tid))
+        {
+            return eventList[j].e.time;
+        }
+    }
+    return eventList[i].e.time;
+}
+
+static void writeEvents(FILE *out)
+{
+    collector_event     *p_event, *p_send;
+    uint64_t            start;
+    double              ts, dur, latency;
+    int                 i;
+
+    start = eventNum ? eventList[0].e.time : 0;
+
+    for (i = 0; i < eventNum; i++)
+    {
+        p_event = &eventList[i];
+        ts      = (double)(p_event->e.time - start) * 1e-3;
+
+        fprintf(out, ",\n");
+
+        switch (p_event->e.kind)
+        {
+            case RACK_TRACE_SEND:
+                fprintf(out, "{\"name\":\"send %d to %08x\",\"cat\":\"msg\",\"ph\":\"X\","
+                             "\"ts\":%.3f,\"dur\":0.001,\"pid\":%d,\"tid\":%u,"
+                             "\"args\":{\"trace\":\"%08x\",\"span\":\"%08x\",\"len\":%d}},\n",
+                        p_event->e.type, p_event->e.dest, ts, p_event->pid, p_event->e.tid,
+                        p_event->e.trace_id, p_event->e.span_id, p_event->e.value);
+                fprintf(out, "{\"name\":\"msg\",\"cat\":\"flow\",\"ph\":\"s\",\"id\":%u,"
+                             "\"ts\":%.3f,\"pid\":%d,\"tid\":%u}",
+                        p_event->e.span_id, ts, p_event->pid, p_event->e.tid);
+                break;
+
+            case RACK_TRACE_RECV:
+                dur     = (double)(nextTime(i) - p_event->e.time) * 1e-3;
+                p_send  = findSend(p_event->e.span_id);
+                latency = -1.0;
+                if (p_send)
+                {
+                    latency = (double)(p_event->e.time - p_send->e.time) * 1e-3;
+                    addHop(p_event->e.src, p_event->e.dest, latency);
+                }
+                fprintf(out, "{\"name\":\"recv %d from %08x\",\"cat\":\"msg\",\"ph\":\"X\","
+                             "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u,"
+                             "\"args\":{\"trace\":\"%08x\",\"span\":\"%08x\",\"len\":%d,"
+                             "\"latency_us\":%.3f}},\n",
+                        p_event->e.type, p_event->e.src, ts, dur > 0.001 ? dur : 0.001,
+                        p_event->pid, p_event->e.tid, p_event->e.trace_id,
+                        p_event->e.span_id, p_event->e.value, latency);
+                fprintf(out, "{\"name\":\"msg\",\"cat\":\"flow\",\"ph\":\"f\",\"bp\":\"e\","
+                             "\"id\":%u,\"ts\":%.3f,\"pid\":%d,\"tid\":%u}",
+                        p_event->e.span_id, ts, p_event->pid, p_event->e.tid);
+                break;
+
+            case RACK_TRACE_PUT:
+                fprintf(out, "{\"name\":\"put %08x\",\"cat\":\"data\",\"ph\":\"X\","
+                             "\"ts\":%.3f,\"dur\":0.001,\"pid\":%d,\"tid\":%u,"
+                             "\"args\":{\"trace\":\"%08x\",\"recordingTime\":%d}}",
+                        p_event->e.src, ts, p_event->pid, p_event->e.tid,
+                        p_event->e.trace_id, p_event->e.value);
+                break;
+
+            default:
+                fprintf(out, "{\"name\":\"%s %d to %08x\",\"cat\":\"proxy\",\"ph\":\"%s\","
+                             "\"ts\":%.3f,\"pid\":%d,\"tid\":%u,"
+                             "\"args\":{\"trace\":\"%08x\"}}",
+                        kindName[p_event->e.kind], p_event->e.type, p_event->e.dest,
+                        (p_event->e.kind == RACK_TRACE_CALL_BEGIN) ? "B" : "E", ts,
+                        p_event->pid, p_event->e.tid, p_event->e.trace_id);
+                break;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    arg_descriptor_t    argDesc[] = { { argTab }, { NULL } };
+    const char          *dir, *output;
+    char                path[512];
+    struct dirent       *p_dirent;
+    DIR                 *p_dir;
+    FILE                *out;
+    int                 i, procNum = 0, ret;
+
+    ret = argScan(argc, argv, argDesc, "RackTraceCollector");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    dir    = getStrArg("dir", argTab);
+    output = getStrArg("output", argTab);
+
+    if (!dir)
+    {
+        dir = getenv(RACK_TRACE_ENV);
+    }
+    if (!dir)
+    {
+        dir = ".";
+    }
+    if (!output)
+    {
+        output = "rack_trace.json";
+    }
+
+    p_dir = opendir(dir);
+    if (!p_dir)
+    {
+        printf("Can't open directory \"%s\" (%s)\n", dir, strerror(errno));
+        return -errno;
+    }
+
+    out = fopen(output, "w");
+    if (!out)
+    {
+        printf("Can't create \"%s\" (%s)\n", output, strerror(errno));
+        closedir(p_dir);
+        return -errno;
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    while ((p_dirent = readdir(p_dir)) != NULL)
+    {
+        if (strncmp(p_dirent->d_name, RACK_TRACE_FILE_PREFIX,
+                    strlen(RACK_TRACE_FILE_PREFIX)))
+        {
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s", dir, p_dirent->d_name);
+        ret = readFile(path, out, &procNum);
+        if (ret == -ENOMEM)
+        {
+            printf("Can't allocate event list\n");
+            break;
+        }
+    }
+    closedir(p_dir);
+
+    qsort(eventList, eventNum, sizeof(collector_event), compareTime);
+
+    if (buildSpanList())
+    {
+        printf("Can't allocate span list\n");
+        fclose(out);
+        free(eventList);
+        return -ENOMEM;
+    }
+
+    writeEvents(out);
+    fprintf(out, "\n]}\n");
+    fclose(out);
+
+    printf("%d events of %d processes written to \"%s\"\n", eventNum, procNum, output);
+
+    if (hopNum)
+    {
+        printf("\n    src  ->     dest |   msgs |  mean us |   max us\n");
+        for (i = 0; i < hopNum; i++)
+        {
+            printf("%08x -> %08x | %6d | %8.1f | %8.1f\n", hopList[i].src, hopList[i].dest,
+                   hopList[i].num, hopList[i].sum / hopList[i].num, hopList[i].max);
+        }
+    }
+
+    free(eventList);
+    free(spanList);
+    free(hopList);
+    return 0;
+}